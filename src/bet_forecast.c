@@ -0,0 +1,1090 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*     Copyright (C) 2007 Dominique Parisot                                   */
+/*          zionly@free.org                                                   */
+/*          2008-2020 Pierre Biava (grisbi@pierre.biava.name)                 */
+/*          https://www.grisbi.org/                                           */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file bet_forecast.c
+ * compute the forecast of an account without any widget :
+ * the events of the period are collected in an array, sorted by date
+ * and the balance after each event is calculated in one pass.
+ * the estimate array and the graph of the module display the result
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+#include <string.h>
+
+/*START_INCLUDE*/
+#include "bet_forecast.h"
+#include "bet_data.h"
+#include "gsb_currency.h"
+#include "gsb_data_account.h"
+#include "gsb_data_currency_link.h"
+#include "gsb_data_partial_balance.h"
+#include "gsb_data_scheduled.h"
+#include "gsb_data_transaction.h"
+#include "gsb_scheduler.h"
+#include "structures.h"
+#include "utils_dates.h"
+#include "utils_str.h"
+#include "erreur.h"
+/*END_INCLUDE*/
+
+/*START_STATIC*/
+/*END_STATIC*/
+
+/*START_EXTERN*/
+/*END_EXTERN*/
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
+/**
+ * order of the events : by date, the balances first, then by origin
+ * (transactions, scheduled, futures, historical, accounts) and by amount
+ *
+ * \param event_a
+ * \param event_b
+ *
+ * \return -1, 0 or 1 as strcmp
+ **/
+static gint bet_forecast_event_cmp (gconstpointer event_a,
+									gconstpointer event_b)
+{
+	const BetForecastEvent *a = event_a;
+	const BetForecastEvent *b = event_b;
+	gint result;
+
+	result = g_date_compare (&a->date, &b->date);
+	if (result)
+		return result;
+
+	if (a->origin != b->origin)
+	{
+		if (a->origin == SPP_ORIGIN_SOLDE)
+			return -1;
+		if (b->origin == SPP_ORIGIN_SOLDE)
+			return 1;
+
+		return a->origin - b->origin;
+	}
+
+	result = gsb_real_cmp (a->amount, b->amount);
+	if (result)
+		return result;
+
+	return (a->sequence < b->sequence) ? -1 : (a->sequence > b->sequence);
+}
+
+/**
+ * free the label of an event
+ *
+ * \param event
+ *
+ * \return
+ **/
+static void bet_forecast_event_clear (gpointer event)
+{
+	g_free (((BetForecastEvent *) event)->label);
+}
+
+/**
+ * return the first historical event of the division
+ *
+ * \param forecast
+ * \param div_number
+ * \param sub_div_nb
+ * \param month			the month to search, G_DATE_BAD_MONTH for all the months
+ *
+ * \return the event or NULL
+ **/
+static BetForecastEvent *bet_forecast_get_hist_event (BetForecast *forecast,
+													  gint div_number,
+													  gint sub_div_nb,
+													  GDateMonth month)
+{
+	GSList *tmp_list;
+
+	tmp_list = g_hash_table_lookup (forecast->hist_divisions, GINT_TO_POINTER (div_number));
+	while (tmp_list)
+	{
+		BetForecastEvent *event;
+
+		event = &g_array_index (forecast->events, BetForecastEvent, GPOINTER_TO_UINT (tmp_list->data));
+		tmp_list = tmp_list->next;
+
+		if (event->sub_number != 0 && event->sub_number != sub_div_nb)
+			continue;
+
+		if (month == G_DATE_BAD_MONTH || g_date_get_month (&event->date) == month)
+			return event;
+	}
+
+	return NULL;
+}
+
+/**
+ * Cette fonction recalcule le montant des données historiques du mois courant
+ * en fonction de la consommation du mois.
+ *
+ * \param forecast
+ * \param div_number
+ * \param sub_div_nb
+ * \param amount		montant de l'opération
+ *
+ * \return
+ **/
+static void bet_forecast_adjust_hist_amount (BetForecast *forecast,
+											 gint div_number,
+											 gint sub_div_nb,
+											 GsbReal amount)
+{
+	BetForecastEvent *event;
+	GDate *date_today;
+	GsbReal number;
+
+	date_today = gdate_today ();
+	event = bet_forecast_get_hist_event (forecast, div_number, sub_div_nb, g_date_get_month (date_today));
+	g_date_free (date_today);
+
+	if (event == NULL || event->amount.mantissa == 0)
+		return;
+
+	number = gsb_real_sub (event->amount, amount);
+	if (bet_data_get_div_type (div_number) == 1 ? number.mantissa < 0 : number.mantissa > 0)
+	{
+		event->amount = number;
+		event->hist_state = BET_FORECAST_HIST_AVAILABLE;
+	}
+	else
+	{
+		event->amount = null_real;
+		event->hist_state = BET_FORECAST_HIST_EXCEEDED;
+	}
+}
+
+/**
+ * remove the transaction or the scheduled transaction replaced by the transfer
+ * of a deferred debit account : same payee and date near the debit date
+ *
+ * \param forecast		sorted by date
+ * \param transfert
+ * \param origin		SPP_ORIGIN_TRANSACTION ou SPP_ORIGIN_SCHEDULED
+ *
+ * \return TRUE if an event was removed
+ **/
+static gboolean bet_forecast_replace_event_by_transfert (BetForecast *forecast,
+														 TransfertData *transfert,
+														 gint origin)
+{
+	GDate date_debut_comparaison;
+	GDate date_fin_comparaison;
+	guint low = 0;
+	guint high;
+	guint i;
+
+	date_debut_comparaison = *transfert->date_debit;
+	g_date_subtract_days (&date_debut_comparaison, etat.import_files_nb_days);
+	date_fin_comparaison = *transfert->date_debit;
+	g_date_add_days (&date_fin_comparaison, etat.import_files_nb_days);
+
+	/* first event of the period */
+	high = forecast->events->len;
+	while (low < high)
+	{
+		guint middle = low + (high - low) / 2;
+
+		if (g_date_compare (&g_array_index (forecast->events, BetForecastEvent, middle).date,
+							&date_debut_comparaison) < 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	for (i = low; i < forecast->events->len; i++)
+	{
+		BetForecastEvent *event;
+		gint payee_number;
+
+		event = &g_array_index (forecast->events, BetForecastEvent, i);
+		if (g_date_compare (&event->date, &date_fin_comparaison) > 0)
+			break;
+
+		if (event->removed || event->origin != origin)
+			continue;
+
+		if (origin == SPP_ORIGIN_TRANSACTION)
+			payee_number = gsb_data_transaction_get_party_number (event->number);
+		else
+			payee_number = gsb_data_scheduled_get_party_number (event->number);
+
+		if (transfert->main_payee_number == payee_number)
+		{
+			event->removed = TRUE;
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/**
+ * remplace l'opération de même tiers par le transfert du compte à débit différé
+ *
+ * \param forecast		sorted by date
+ *
+ * \return TRUE if an event was removed
+ **/
+static gboolean bet_forecast_replace_events_by_transferts (BetForecast *forecast)
+{
+	GHashTableIter iter;
+	gpointer key, value;
+	gboolean removed = FALSE;
+
+	g_hash_table_iter_init (&iter, bet_data_transfert_get_list ());
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		TransfertData *transfert = (TransfertData *) value;
+
+		if (forecast->account_number != transfert->account_number || !transfert->replace_transaction)
+			continue;
+
+		if (bet_forecast_replace_event_by_transfert (forecast, transfert, SPP_ORIGIN_TRANSACTION)
+			|| bet_forecast_replace_event_by_transfert (forecast, transfert, SPP_ORIGIN_SCHEDULED))
+			removed = TRUE;
+	}
+
+	return removed;
+}
+
+/**
+ * set the index of the historical events of each division
+ *
+ * \param forecast
+ *
+ * \return
+ **/
+static void bet_forecast_index_hist_divisions (BetForecast *forecast)
+{
+	guint i;
+
+	g_hash_table_remove_all (forecast->hist_divisions);
+
+	/* from the end so the lists are in the order of the events */
+	for (i = forecast->events->len; i > 0; i--)
+	{
+		BetForecastEvent *event;
+		GSList *tmp_list;
+
+		event = &g_array_index (forecast->events, BetForecastEvent, i - 1);
+		if (event->origin != SPP_ORIGIN_HISTORICAL)
+			continue;
+
+		tmp_list = g_hash_table_lookup (forecast->hist_divisions, GINT_TO_POINTER (event->number));
+		g_hash_table_steal (forecast->hist_divisions, GINT_TO_POINTER (event->number));
+		tmp_list = g_slist_prepend (tmp_list, GUINT_TO_POINTER (i - 1));
+		g_hash_table_insert (forecast->hist_divisions, GINT_TO_POINTER (event->number), tmp_list);
+	}
+}
+
+/**
+ * check if the event is a transfer between two accounts of the consolidated
+ * forecast, which doesn't change the total balance
+ *
+ * \param event
+ * \param accounts		set of the accounts of the consolidated forecast
+ *
+ * \return TRUE if the event is a transfer between the accounts
+ **/
+static gboolean bet_forecast_is_internal_transfer (BetForecastEvent *event,
+												   GHashTable *accounts)
+{
+	switch (event->origin)
+	{
+		case SPP_ORIGIN_TRANSACTION:
+		{
+			gint contra_number;
+
+			contra_number = gsb_data_transaction_get_contra_transaction_number (event->number);
+			if (contra_number <= 0)
+				return FALSE;
+
+			return g_hash_table_contains (accounts,
+										  GINT_TO_POINTER (gsb_data_transaction_get_account_number (contra_number)));
+		}
+		case SPP_ORIGIN_SCHEDULED:
+		{
+			gint account_number;
+
+			if (!gsb_data_scheduled_is_transfer (event->number))
+				return FALSE;
+
+			account_number = gsb_data_scheduled_get_account_number (event->number);
+			if (account_number == event->account_number)
+				account_number = gsb_data_scheduled_get_account_number_transfer (event->number);
+
+			return g_hash_table_contains (accounts, GINT_TO_POINTER (account_number));
+		}
+		case SPP_ORIGIN_FUTURE:
+		{
+			FuturData *scheduled = (FuturData *) event->data;
+
+			return (scheduled->is_transfert
+					&& g_hash_table_contains (accounts, GINT_TO_POINTER (scheduled->account_number))
+					&& g_hash_table_contains (accounts, GINT_TO_POINTER (scheduled->account_transfert)));
+		}
+		case SPP_ORIGIN_ACCOUNT:
+		{
+			TransfertData *transfert = (TransfertData *) event->data;
+
+			/* the balance of the deferred debit account is already in the total */
+			return (transfert->type == 0
+					&& g_hash_table_contains (accounts, GINT_TO_POINTER (transfert->replace_account)));
+		}
+	}
+
+	return FALSE;
+}
+
+/**
+ * convert an amount in the currency of the consolidated forecast with the link
+ * between the currencies. Without link the exchange rate is asked to the user
+ * as gsb_data_transaction_get_adjusted_amount_for_currency () does, once for
+ * each currency
+ *
+ * \param forecast			the consolidated forecast
+ * \param exchanges			the exchange rates already asked by currency
+ * \param currency_number	the currency of the amount
+ * \param amount
+ *
+ * \return the amount in the currency of the forecast
+ **/
+static GsbReal bet_forecast_convert_amount (BetForecast *forecast,
+											GHashTable *exchanges,
+											gint currency_number,
+											GsbReal amount)
+{
+	GsbReal *exchange;
+
+	if (currency_number == forecast->currency_number || amount.mantissa == 0)
+		return amount;
+
+	if (gsb_data_currency_link_convert (currency_number, forecast->currency_number, &amount))
+		return amount;
+
+	exchange = g_hash_table_lookup (exchanges, GINT_TO_POINTER (currency_number));
+	if (exchange == NULL)
+	{
+		gsb_currency_exchange_dialog (currency_number, forecast->currency_number, 0, null_real, null_real, TRUE);
+		exchange = g_malloc (sizeof (GsbReal));
+		*exchange = gsb_currency_get_current_exchange ();
+		g_hash_table_insert (exchanges, GINT_TO_POINTER (currency_number), exchange);
+	}
+
+	return gsb_real_div (amount, *exchange);
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * create a new empty forecast for an account
+ *
+ * \param account_number
+ *
+ * \return a new BetForecast to free with bet_forecast_free ()
+ **/
+BetForecast *bet_forecast_new (gint account_number)
+{
+	BetForecast *forecast;
+
+	forecast = g_malloc0 (sizeof (BetForecast));
+	forecast->account_number = account_number;
+	if (account_number > 0)
+		forecast->currency_number = gsb_data_account_get_currency (account_number);
+	forecast->events = g_array_new (FALSE, FALSE, sizeof (BetForecastEvent));
+	g_array_set_clear_func (forecast->events, bet_forecast_event_clear);
+	forecast->hist_divisions = g_hash_table_new_full (g_direct_hash,
+													  g_direct_equal,
+													  NULL,
+													  (GDestroyNotify) g_slist_free);
+
+	return forecast;
+}
+
+/**
+ * create the consolidated forecast of the accounts of a partial balance
+ * in its currency. The transfers between these accounts are removed
+ * since they don't change the total. The historical data are not used :
+ * they are selected in the page of one account
+ *
+ * \param partial_balance_number
+ * \param date_min
+ * \param date_max
+ *
+ * \return a new computed BetForecast to free with bet_forecast_free ()
+ **/
+BetForecast *bet_forecast_new_for_partial_balance (gint partial_balance_number,
+												   const GDate *date_min,
+												   const GDate *date_max)
+{
+	BetForecast *forecast;
+	GHashTable *accounts;
+	GHashTable *exchanges;
+	GHashTableIter iter;
+	gpointer key;
+	GDate *first_day_current_month;
+	GDate date_init;
+	GsbReal initial_balance = null_real;
+	const gchar *liste_cptes;
+
+	forecast = bet_forecast_new (0);
+	forecast->partial_balance_number = partial_balance_number;
+	forecast->currency_number = gsb_data_partial_balance_get_currency (partial_balance_number);
+
+	/* set of the accounts, an account may be twice in the list */
+	accounts = g_hash_table_new (g_direct_hash, g_direct_equal);
+	liste_cptes = gsb_data_partial_balance_get_liste_cptes (partial_balance_number);
+	if (liste_cptes)
+	{
+		gchar **tab;
+		gint i;
+
+		tab = g_strsplit (liste_cptes, ";", 0);
+		for (i = 0; tab[i]; i++)
+		{
+			if (strlen (tab[i]))
+				g_hash_table_add (accounts, GINT_TO_POINTER (utils_str_atoi (tab[i])));
+		}
+		g_strfreev (tab);
+	}
+
+	exchanges = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+
+	/* the same periods as the estimate array of an account */
+	first_day_current_month = gsb_date_get_first_day_of_current_month ();
+	date_init = *date_min;
+	g_date_subtract_days (&date_init, 1);
+
+	g_hash_table_iter_init (&iter, accounts);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+	{
+		BetForecast *account_forecast;
+		gint account_number;
+		guint i;
+
+		account_number = GPOINTER_TO_INT (key);
+		account_forecast = bet_forecast_new (account_number);
+
+		bet_forecast_add_futures (account_forecast, first_day_current_month, date_max);
+		bet_forecast_add_transferts (account_forecast, first_day_current_month, date_max);
+		bet_forecast_add_transactions (account_forecast, date_min, date_max);
+		bet_forecast_add_scheduled (account_forecast, date_min, date_max);
+		bet_forecast_compute (account_forecast);
+
+		/* the transactions are added with their value date, so is the initial balance */
+		initial_balance = gsb_real_add (initial_balance,
+										bet_forecast_convert_amount (forecast,
+																	 exchanges,
+																	 account_forecast->currency_number,
+																	 gsb_data_account_get_balance_at_date
+																	 (account_number, &date_init)));
+
+		for (i = 0; i < account_forecast->events->len; i++)
+		{
+			BetForecastEvent *event;
+			BetForecastEvent *new_event;
+
+			event = &g_array_index (account_forecast->events, BetForecastEvent, i);
+			if (bet_forecast_is_internal_transfer (event, accounts))
+				continue;
+
+			new_event = bet_forecast_add_event (forecast,
+												&event->date,
+												event->origin,
+												event->number,
+												event->sub_number,
+												bet_forecast_convert_amount (forecast,
+																			 exchanges,
+																			 account_forecast->currency_number,
+																			 event->amount));
+			new_event->account_number = account_number;
+			new_event->data = event->data;
+		}
+		bet_forecast_free (account_forecast);
+	}
+	g_hash_table_destroy (accounts);
+	g_hash_table_destroy (exchanges);
+	g_date_free (first_day_current_month);
+
+	bet_forecast_add_event (forecast, &date_init, SPP_ORIGIN_SOLDE, BET_FORECAST_BALANCE_START, 0, initial_balance);
+	bet_forecast_add_balances_of_months (forecast, date_min, date_max);
+
+	bet_forecast_compute (forecast);
+
+	return forecast;
+}
+
+/**
+ * free a forecast
+ *
+ * \param forecast
+ *
+ * \return
+ **/
+void bet_forecast_free (BetForecast *forecast)
+{
+	if (forecast == NULL)
+		return;
+
+	g_array_free (forecast->events, TRUE);
+	g_hash_table_destroy (forecast->hist_divisions);
+	g_free (forecast);
+}
+
+/**
+ * add an event to the forecast
+ *
+ * \param forecast
+ * \param date
+ * \param origin		SPP_ORIGIN_xxx
+ * \param number
+ * \param sub_number
+ * \param amount		in the currency of the account
+ *
+ * \return the new event, valid until another event is added
+ **/
+BetForecastEvent *bet_forecast_add_event (BetForecast *forecast,
+										  const GDate *date,
+										  gint origin,
+										  gint number,
+										  gint sub_number,
+										  GsbReal amount)
+{
+	BetForecastEvent event = {{0}};
+
+	event.date = *date;
+	event.account_number = forecast->account_number;
+	event.origin = origin;
+	event.number = number;
+	event.sub_number = sub_number;
+	event.amount = amount;
+	event.sequence = forecast->sequence++;
+
+	g_array_append_val (forecast->events, event);
+	forecast->computed = FALSE;
+
+	if (origin == SPP_ORIGIN_HISTORICAL)
+	{
+		GSList *tmp_list;
+
+		/* keep the order of creation in the list of the division */
+		tmp_list = g_hash_table_lookup (forecast->hist_divisions, GINT_TO_POINTER (number));
+		g_hash_table_steal (forecast->hist_divisions, GINT_TO_POINTER (number));
+		tmp_list = g_slist_append (tmp_list, GUINT_TO_POINTER (forecast->events->len - 1));
+		g_hash_table_insert (forecast->hist_divisions, GINT_TO_POINTER (number), tmp_list);
+	}
+
+	return &g_array_index (forecast->events, BetForecastEvent, forecast->events->len - 1);
+}
+
+/**
+ * add the balance at the beginning of each month of the period
+ *
+ * \param forecast
+ * \param date_min
+ * \param date_max
+ *
+ * \return
+ **/
+void bet_forecast_add_balances_of_months (BetForecast *forecast,
+										  const GDate *date_min,
+										  const GDate *date_max)
+{
+	GDate date;
+
+	date = *date_min;
+	g_date_add_months (&date, 1);
+	g_date_set_day (&date, 1);
+
+	while (g_date_compare (&date, date_max) < 0)
+	{
+		bet_forecast_add_event (forecast, &date, SPP_ORIGIN_SOLDE, BET_FORECAST_BALANCE_MONTH, 0, null_real);
+		g_date_add_months (&date, 1);
+	}
+}
+
+/**
+ * add the future data of the account, the obsolete ones are removed
+ *
+ * \param forecast
+ * \param date_min
+ * \param date_max
+ *
+ * \return
+ **/
+void bet_forecast_add_futures (BetForecast *forecast,
+							   const GDate *date_min,
+							   const GDate *date_max)
+{
+	GHashTable *future_list;
+	GHashTableIter iter;
+	gpointer key, value;
+	GDate *date_tomorrow;
+	gint account_number;
+
+	account_number = forecast->account_number;
+	future_list = bet_data_future_get_list ();
+
+	/* remove first the lines before tomorrow */
+	date_tomorrow = gsb_date_tomorrow ();
+	g_hash_table_iter_init (&iter, future_list);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		FuturData *scheduled = (FuturData *) value;
+
+		if (account_number != scheduled->account_number
+			&& (scheduled->is_transfert == 0 || account_number != scheduled->account_transfert))
+			continue;
+
+		if (g_date_compare (scheduled->date, date_tomorrow) < 0)
+		{
+			bet_data_future_remove_line (account_number, scheduled->number, FALSE);
+			g_hash_table_iter_init (&iter, future_list);
+		}
+	}
+	g_date_free (date_tomorrow);
+
+	g_hash_table_iter_init (&iter, future_list);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		FuturData *scheduled = (FuturData *) value;
+		BetForecastEvent *event;
+		GsbReal amount;
+
+		if (account_number == scheduled->account_number)
+			amount = scheduled->amount;
+		else if (scheduled->is_transfert && account_number == scheduled->account_transfert)
+			amount = gsb_real_opposite (scheduled->amount);
+		else
+			continue;
+
+		if (g_date_compare (scheduled->date, date_max) > 0 || g_date_compare (scheduled->date, date_min) < 0)
+			continue;
+
+		event = bet_forecast_add_event (forecast,
+										scheduled->date,
+										SPP_ORIGIN_FUTURE,
+										scheduled->number,
+										scheduled->mother_row,
+										amount);
+		event->data = scheduled;
+	}
+}
+
+/**
+ * add a retained historical amount at the end of each month of the period
+ * from the current month
+ *
+ * \param forecast
+ * \param date_min
+ * \param date_max
+ * \param div_number
+ * \param sub_div_nb
+ * \param amount
+ * \param label			description of the line
+ *
+ * \return
+ **/
+void bet_forecast_add_historical (BetForecast *forecast,
+								  const GDate *date_min,
+								  const GDate *date_max,
+								  gint div_number,
+								  gint sub_div_nb,
+								  GsbReal amount,
+								  const gchar *label)
+{
+	GDate *date;
+	GDate *date_jour;
+
+	date_jour = gdate_today ();
+	date = gsb_date_get_last_day_of_month (date_min);
+
+	while (date != NULL && g_date_valid (date))
+	{
+		GDate *date_tmp;
+
+		if (g_date_compare (date, date_max) > 0)
+			break;
+
+		if (g_date_compare (date, date_min) >= 0
+			&& (g_date_get_year (date) != g_date_get_year (date_jour)
+				|| g_date_get_month (date) >= g_date_get_month (date_jour)))
+		{
+			BetForecastEvent *event;
+
+			event = bet_forecast_add_event (forecast, date, SPP_ORIGIN_HISTORICAL, div_number, sub_div_nb, amount);
+			event->label = g_strdup (label);
+		}
+
+		g_date_add_months (date, 1);
+		date_tmp = date;
+		date = gsb_date_get_last_day_of_month (date_tmp);
+		g_date_free (date_tmp);
+	}
+
+	if (date)
+		g_date_free (date);
+	g_date_free (date_jour);
+}
+
+/**
+ * add each occurrence of the scheduled transactions of the account in the period,
+ * except those replaced by historical data which must be added before
+ *
+ * \param forecast
+ * \param date_min
+ * \param date_max
+ *
+ * \return
+ **/
+void bet_forecast_add_scheduled (BetForecast *forecast,
+								 const GDate *date_min,
+								 const GDate *date_max)
+{
+	GSList *tmp_list;
+	gint currency_number;
+	gint floating_point;
+
+	currency_number = gsb_data_account_get_currency (forecast->account_number);
+	floating_point = gsb_data_account_get_currency_floating_point (forecast->account_number);
+
+	tmp_list = gsb_data_scheduled_get_scheduled_list ();
+	while (tmp_list)
+	{
+		GDate *date;
+		GsbReal amount;
+		gint scheduled_number;
+		gint account_number;
+		gint div_number;
+
+		scheduled_number = gsb_data_scheduled_get_scheduled_number (tmp_list->data);
+		tmp_list = tmp_list->next;
+
+		/* ignore splitted transactions */
+		if (gsb_data_scheduled_get_split_of_scheduled (scheduled_number))
+			continue;
+
+		account_number = gsb_data_scheduled_get_account_number (scheduled_number);
+
+		/* ignore scheduled operations of other account */
+		if (account_number == forecast->account_number)
+			amount = gsb_data_scheduled_get_adjusted_amount_for_currency (scheduled_number,
+																		  currency_number,
+																		  floating_point);
+		else if (gsb_data_scheduled_is_transfer (scheduled_number)
+				 && gsb_data_scheduled_get_account_number_transfer (scheduled_number) == forecast->account_number)
+			amount = gsb_real_opposite (gsb_data_scheduled_get_adjusted_amount_for_currency (scheduled_number,
+																							 currency_number,
+																							 floating_point));
+		else
+			continue;
+
+		/* ignores transactions replaced with historical data */
+		div_number = bet_data_get_div_number (scheduled_number, FALSE);
+		if (div_number > 0
+			&& bet_data_search_div_hist (account_number, div_number, 0)
+			&& bet_forecast_get_hist_event (forecast,
+											div_number,
+											bet_data_get_sub_div_nb (scheduled_number, FALSE),
+											G_DATE_BAD_MONTH))
+			continue;
+
+		/* calculate each instance of the scheduled operation in the period */
+		date = gsb_date_copy (gsb_data_scheduled_get_date (scheduled_number));
+		while (date != NULL && g_date_valid (date))
+		{
+			GDate *tmp_date;
+
+			if (g_date_compare (date, date_max) > 0)
+				break;
+
+			if (g_date_compare (date, date_min) >= 0)
+				bet_forecast_add_event (forecast, date, SPP_ORIGIN_SCHEDULED, scheduled_number, 0, amount);
+
+			tmp_date = date;
+			date = gsb_scheduler_get_next_date (scheduled_number, tmp_date);
+			g_date_free (tmp_date);
+		}
+		if (date)
+			g_date_free (date);
+	}
+}
+
+/**
+ * add the transactions of the account in the period. The transactions of the
+ * current month adjust the historical data which must be added before
+ *
+ * \param forecast
+ * \param date_min
+ * \param date_max
+ *
+ * \return
+ **/
+void bet_forecast_add_transactions (BetForecast *forecast,
+									const GDate *date_min,
+									const GDate *date_max)
+{
+	GDate *date_jour_1;
+	const GDate *date_comp;
+	GSList *tmp_list;
+	gint currency_number;
+	gint floating_point;
+
+	currency_number = gsb_data_account_get_currency (forecast->account_number);
+	floating_point = gsb_data_account_get_currency_floating_point (forecast->account_number);
+
+	/* init dates */
+	date_jour_1 = gdate_today ();
+	if (g_date_get_day (date_min) > 1)
+		g_date_set_day (date_jour_1, 1);
+	if (g_date_compare (date_jour_1, date_min) < 0)
+		date_comp = date_jour_1;
+	else
+		date_comp = date_min;
+
+	tmp_list = gsb_data_transaction_get_transactions_list ();
+	while (tmp_list)
+	{
+		const GDate *date;
+		gint transaction_number;
+		gint div_number;
+
+		transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
+		tmp_list = tmp_list->next;
+
+		if (gsb_data_transaction_get_account_number (transaction_number) != forecast->account_number)
+			continue;
+
+		/* ignore transaction which are out of the period */
+		date = gsb_data_transaction_get_value_date_or_date (transaction_number);
+		if (g_date_compare (date, date_max) > 0 || g_date_compare (date, date_comp) < 0)
+			continue;
+
+		/* ignore splitted transactions */
+		if (gsb_data_transaction_get_split_of_transaction (transaction_number))
+			continue;
+
+		/* the transactions of the month are deducted from the historical data */
+		div_number = bet_data_get_div_number (transaction_number, TRUE);
+		if (div_number > 0
+			&& g_date_get_month (date) == g_date_get_month (date_jour_1)
+			&& bet_data_search_div_hist (forecast->account_number, div_number, 0))
+			bet_forecast_adjust_hist_amount (forecast,
+											 div_number,
+											 bet_data_get_sub_div_nb (transaction_number, TRUE),
+											 gsb_data_transaction_get_amount (transaction_number));
+
+		if (g_date_compare (date, date_min) < 0)
+			continue;
+
+		bet_forecast_add_event (forecast,
+								date,
+								SPP_ORIGIN_TRANSACTION,
+								transaction_number,
+								0,
+								gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
+																					   currency_number,
+																					   floating_point));
+	}
+	g_date_free (date_jour_1);
+}
+
+/**
+ * add the balances of the deferred debit accounts debited on the account
+ *
+ * \param forecast
+ * \param date_min
+ * \param date_max
+ *
+ * \return
+ **/
+void bet_forecast_add_transferts (BetForecast *forecast,
+								  const GDate *date_min,
+								  const GDate *date_max)
+{
+	GHashTableIter iter;
+	gpointer key, value;
+	gint currency_number;
+
+	currency_number = gsb_data_account_get_currency (forecast->account_number);
+
+	g_hash_table_iter_init (&iter, bet_data_transfert_get_list ());
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		BetForecastEvent *event;
+		GDate *date_bascule;
+		GDate *date_debit;
+		GsbReal amount;
+		gint replace_currency;
+		TransfertData *transfert = (TransfertData *) value;
+
+		if (forecast->account_number != transfert->account_number)
+			continue;
+
+		/* set date_bascule */
+		if (transfert->card_choice_bascule_day)
+			date_bascule = gsb_date_get_first_banking_day_after_date (transfert->date_bascule);
+		else
+			date_bascule = gsb_date_copy (transfert->date_bascule);
+
+		bet_data_transfert_update_date_if_necessary (transfert, date_bascule, FALSE);
+		g_date_free (date_bascule);
+
+		if (g_date_compare (transfert->date_debit, date_max) > 0
+			|| g_date_compare (transfert->date_debit, date_min) < 0)
+			continue;
+
+		if (transfert->type == 0)
+		{
+			amount = gsb_data_account_get_current_balance (transfert->replace_account);
+			replace_currency = gsb_data_account_get_currency (transfert->replace_account);
+		}
+		else
+		{
+			amount = gsb_data_partial_balance_get_current_amount (transfert->replace_account);
+			replace_currency = gsb_data_partial_balance_get_currency (transfert->replace_account);
+		}
+
+		if (replace_currency != currency_number
+			&& amount.mantissa != 0
+			&& !gsb_data_currency_link_convert (replace_currency, currency_number, &amount))
+			amount = null_real;
+
+		/* set date debit */
+		if (transfert->main_choice_debit_day == 2)
+			date_debit = gsb_date_get_first_banking_day_before_date (transfert->date_debit);
+		else
+			date_debit = gsb_date_copy (transfert->date_debit);
+
+		event = bet_forecast_add_event (forecast, date_debit, SPP_ORIGIN_ACCOUNT, transfert->number, 0, amount);
+		event->data = transfert;
+		g_date_free (date_debit);
+	}
+}
+
+/**
+ * sort the events, remove the transactions replaced by a transfer
+ * and calculate the balance after each event
+ *
+ * \param forecast
+ *
+ * \return
+ **/
+void bet_forecast_compute (BetForecast *forecast)
+{
+	GsbReal balance = null_real;
+	guint i;
+
+	if (forecast->computed)
+		return;
+
+	g_array_sort (forecast->events, bet_forecast_event_cmp);
+
+	if (bet_forecast_replace_events_by_transferts (forecast))
+	{
+		guint j = 0;
+
+		for (i = 0; i < forecast->events->len; i++)
+		{
+			BetForecastEvent *event;
+
+			event = &g_array_index (forecast->events, BetForecastEvent, i);
+			if (event->removed)
+			{
+				g_free (event->label);
+				continue;
+			}
+			if (i != j)
+				g_array_index (forecast->events, BetForecastEvent, j) = *event;
+			j++;
+		}
+		/* the labels of the events removed are already freed */
+		g_array_set_clear_func (forecast->events, NULL);
+		g_array_set_size (forecast->events, j);
+		g_array_set_clear_func (forecast->events, bet_forecast_event_clear);
+	}
+	bet_forecast_index_hist_divisions (forecast);
+
+	for (i = 0; i < forecast->events->len; i++)
+	{
+		BetForecastEvent *event;
+
+		event = &g_array_index (forecast->events, BetForecastEvent, i);
+		balance = gsb_real_add (balance, event->amount);
+		event->balance = balance;
+	}
+
+	forecast->computed = TRUE;
+}
+
+/**
+ * return the balance of the account at the end of a day
+ *
+ * \param forecast
+ * \param date
+ *
+ * \return the balance after the last event of the day or before,
+ * null_real if there is no event before the date
+ **/
+GsbReal bet_forecast_get_balance_at_date (BetForecast *forecast,
+										  const GDate *date)
+{
+	guint low = 0;
+	guint high;
+
+	bet_forecast_compute (forecast);
+
+	/* first event after the date */
+	high = forecast->events->len;
+	while (low < high)
+	{
+		guint middle = low + (high - low) / 2;
+
+		if (g_date_compare (&g_array_index (forecast->events, BetForecastEvent, middle).date, date) <= 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	if (low == 0)
+		return null_real;
+
+	return g_array_index (forecast->events, BetForecastEvent, low - 1).balance;
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
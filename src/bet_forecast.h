@@ -0,0 +1,94 @@
+#ifndef _BALANCE_ESTIMATE_FORECAST_H
+#define _BALANCE_ESTIMATE_FORECAST_H
+
+#include <glib.h>
+
+/* START_INCLUDE_H */
+#include "gsb_real.h"
+/* END_INCLUDE_H */
+
+/* number of the balance events (origin SPP_ORIGIN_SOLDE) */
+#define BET_FORECAST_BALANCE_START		0				/* balance at the beginning of the period */
+#define BET_FORECAST_BALANCE_MONTH		1				/* balance at the first day of a month */
+
+typedef struct _BetForecast					BetForecast;
+typedef struct _BetForecastEvent			BetForecastEvent;
+
+/* an event is a line of the forecast: a transaction, an occurrence of a scheduled
+ * transaction, a future data, a transfer of a deferred debit account,
+ * a month of historical data or a balance */
+struct _BetForecastEvent
+{
+	GDate			date;
+	gint			account_number;				/* account of the event */
+	gint			origin;						/* SPP_ORIGIN_xxx */
+	gint			number;						/* transaction, scheduled, future, transfert or division number */
+	gint			sub_number;					/* mother_row of a future data, sub division of historical data */
+	GsbReal			amount;						/* amount in the currency of the forecast */
+	GsbReal			balance;					/* balance after the event */
+	gint			hist_state;					/* BetForecastHistState for the historical data */
+	gchar *			label;						/* description of the historical data */
+	gpointer		data;						/* FuturData or TransfertData of the event */
+	guint			sequence;					/* order of creation */
+	gboolean		removed;					/* replaced by the transfer of a deferred debit account */
+};
+
+/* the historical data of the current month are adjusted with the transactions of the month */
+typedef enum _BetForecastHistState
+{
+	BET_FORECAST_HIST_NOT_ADJUSTED,
+	BET_FORECAST_HIST_AVAILABLE,				/* still available or yet to receive */
+	BET_FORECAST_HIST_EXCEEDED					/* budget exceeded */
+} BetForecastHistState;
+
+struct _BetForecast
+{
+	gint			account_number;				/* 0 for a consolidated forecast */
+	gint			partial_balance_number;		/* accounts of a consolidated forecast */
+	gint			currency_number;
+	GArray *		events;						/* BetForecastEvent sorted by date once computed */
+	GHashTable *	hist_divisions;				/* division -> GSList of the index of its historical events */
+	guint			sequence;
+	gboolean		computed;
+};
+
+/* START_DECLARATION */
+BetForecast *		bet_forecast_new						(gint account_number);
+BetForecast *		bet_forecast_new_for_partial_balance	(gint partial_balance_number,
+															 const GDate *date_min,
+															 const GDate *date_max);
+void				bet_forecast_free						(BetForecast *forecast);
+BetForecastEvent *	bet_forecast_add_event					(BetForecast *forecast,
+															 const GDate *date,
+															 gint origin,
+															 gint number,
+															 gint sub_number,
+															 GsbReal amount);
+void				bet_forecast_add_balances_of_months		(BetForecast *forecast,
+															 const GDate *date_min,
+															 const GDate *date_max);
+void				bet_forecast_add_futures				(BetForecast *forecast,
+															 const GDate *date_min,
+															 const GDate *date_max);
+void				bet_forecast_add_historical				(BetForecast *forecast,
+															 const GDate *date_min,
+															 const GDate *date_max,
+															 gint div_number,
+															 gint sub_div_nb,
+															 GsbReal amount,
+															 const gchar *label);
+void				bet_forecast_add_scheduled				(BetForecast *forecast,
+															 const GDate *date_min,
+															 const GDate *date_max);
+void				bet_forecast_add_transactions			(BetForecast *forecast,
+															 const GDate *date_min,
+															 const GDate *date_max);
+void				bet_forecast_add_transferts				(BetForecast *forecast,
+															 const GDate *date_min,
+															 const GDate *date_max);
+void				bet_forecast_compute					(BetForecast *forecast);
+GsbReal				bet_forecast_get_balance_at_date		(BetForecast *forecast,
+															 const GDate *date);
+/* END_DECLARATION */
+
+#endif /*_BALANCE_ESTIMATE_FORECAST_H*/
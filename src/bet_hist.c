@@ -42,6 +42,7 @@
 #include "gsb_data_fyear.h"
 #include "gsb_data_transaction.h"
 #include "gsb_file.h"
+#include "gsb_file_cache.h"
 #include "gsb_fyear.h"
 #include "gsb_real.h"
 #include "gsb_rgba.h"
@@ -698,8 +699,10 @@ void bet_historical_populate_data ( gint account_number )
                                     (GDestroyNotify) g_free,
                                     (GDestroyNotify) struct_free_bet_transaction_current_fyear );
 
-    /* search transactions of the account  */
-    tmp_list = gsb_data_transaction_get_complete_transactions_list ( );
+    /* search transactions of the account, the archives kept in the cache
+     * are loaded only if they have transactions from date_min */
+    gsb_file_cache_load_account_archives ( account_number, g_date_get_julian ( date_min ) );
+    tmp_list = gsb_data_transaction_get_loaded_transactions_list ( );
     while ( tmp_list )
     {
         gint transaction_number;
@@ -1082,7 +1085,7 @@ void bet_historical_set_fyear_from_combobox ( GtkWidget *combo_box, gint fyear )
  *
  *
  * */
-void bet_historical_refresh_data ( GtkTreeModel *tab_model,
+void bet_historical_refresh_data ( BetForecast *forecast,
                         GDate *date_min,
                         GDate *date_max )
 {
@@ -1114,7 +1117,7 @@ void bet_historical_refresh_data ( GtkTreeModel *tab_model,
                         -1 );
             if ( valeur == 1 )
             {
-                bet_array_list_add_new_hist_line ( tab_model,
+                bet_array_list_add_new_hist_line ( forecast,
                         GTK_TREE_MODEL ( model ), &iter,
                         date_min, date_max );
             }
@@ -1131,7 +1134,7 @@ void bet_historical_refresh_data ( GtkTreeModel *tab_model,
 
                     if ( valeur == 1 )
                     {
-                        bet_array_list_add_new_hist_line ( tab_model,
+                        bet_array_list_add_new_hist_line ( forecast,
                                 GTK_TREE_MODEL ( model ), &fils_iter,
                                 date_min, date_max );
                     }
@@ -4,6 +4,7 @@
 #include <gtk/gtk.h>
 
 /* START_INCLUDE_H */
+#include "bet_forecast.h"
 /* END_INCLUDE_H */
 
 /* START_DECLARATION */
@@ -18,7 +19,7 @@ GDate *			bet_historical_get_start_date_current_fyear 		(void);
 void 			bet_historical_g_signal_block_tree_view 			(void);
 void 			bet_historical_g_signal_unblock_tree_view 			(void);
 void 			bet_historical_populate_data 						(gint account_number);
-void 			bet_historical_refresh_data 						(GtkTreeModel *tab_model,
+void 			bet_historical_refresh_data 						(BetForecast *forecast,
 																	 GDate *date_min,
 																	 GDate *date_max);
 void 			bet_historical_set_fyear_from_combobox 				(GtkWidget *combo_box,
@@ -31,6 +31,7 @@
 
 /*START_INCLUDE*/
 #include "bet_tab.h"
+#include "bet_forecast.h"
 #include "bet_future.h"
 #include "bet_graph.h"
 #include "bet_hist.h"
@@ -79,6 +80,9 @@ static gint 				bet_array_col_width_init[BET_ARRAY_COLUMNS] = {15, 45, 12, 12, 1
 static gint 				bet_array_current_tree_view_width = 0;
 static GtkWidget *			bet_array_toolbar;								/* toolbar */
 static GtkTreeViewColumn *	bet_array_tree_view_columns[BET_ARRAY_COLUMNS];	/* tableau des colonnes */
+
+static void bet_array_list_partial_balance_menu (GtkWidget *button,
+												 gpointer null);
 /*END_STATIC*/
 
 /*START_EXTERN*/
@@ -87,147 +91,6 @@ static GtkTreeViewColumn *	bet_array_tree_view_columns[BET_ARRAY_COLUMNS];	/* ta
 /******************************************************************************/
 /* Private functions                                                          */
 /******************************************************************************/
-/**
- * Cette fonction recalcule le montant des données historiques en fonction de la
- * consommation mensuelle précédente. affiche le nouveau montant si même signe ou 0
- * et un message pour budget dépassé.
- *
- * \param
- * \param
- * \param
- * \param
- *
- * \return
- **/
-static void bet_array_adjust_hist_amount (gint div_number,
-										  gint sub_div_nb,
-										  GsbReal amount,
-                        				  GtkTreeModel *model)
-{
-    GtkTreeIter iter;
-
-    if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (model), &iter))
-    {
-        gchar* str_date;
-        gchar *str_desc;
-        gchar* str_debit = NULL;
-        gchar* str_credit = NULL;
-        gchar *str_amount;
-        gchar *div_name;
-        GDate *date;
-        GDate *date_today;
-        GsbReal number;
-        gint sign = 1;
-        gint tmp_div_number;
-        gint tmp_sub_div_nb;
-        gint currency_number;
-
-        do
-        {
-            gtk_tree_model_get (GTK_TREE_MODEL (model),
-								&iter,
-                        		SPP_ESTIMATE_TREE_DIVISION_COLUMN, &tmp_div_number,
-                        		SPP_ESTIMATE_TREE_SUB_DIV_COLUMN, &tmp_sub_div_nb,
-                        		SPP_ESTIMATE_TREE_DATE_COLUMN, &str_date,
-                        		SPP_ESTIMATE_TREE_DESC_COLUMN, &str_desc,
-                        		SPP_ESTIMATE_TREE_AMOUNT_COLUMN, &str_amount,
-                        		-1);
-
-            if (tmp_div_number == 0 || tmp_div_number != div_number)
-			{
-				g_free (str_date);
-				g_free (str_desc);
-				g_free (str_amount);
-                continue;
-			}
-            if (tmp_sub_div_nb == 0 || tmp_sub_div_nb == sub_div_nb)
-            {
-                div_name = bet_data_get_div_name (tmp_div_number, tmp_sub_div_nb, FALSE);
-
-                currency_number = bet_data_get_selected_currency ();
-                date = gsb_parse_date_string (str_date);
-                date_today = gdate_today ();
-                if (g_date_get_month (date) - g_date_get_month (date_today) == 0)
-                {
-                    number = utils_real_get_from_string (str_amount);
-                    if (number.mantissa != 0)
-                    {
-                        sign = bet_data_get_div_type (div_number);
-                        number = gsb_real_sub (number, amount);
-
-                        g_free (str_amount);
-                        g_free (str_desc);
-                        if (sign == 1)
-                        {
-                            if (number.mantissa < 0)
-                            {
-                                str_amount = utils_real_get_string (number);
-                                str_debit = utils_real_get_string_with_currency (
-                                            gsb_real_abs (number),
-                                            currency_number,
-                                            TRUE);
-                                str_desc = g_strconcat (div_name, _(" (still available)"), NULL);
-                            }
-                            else
-                            {
-                                str_debit = utils_real_get_string_with_currency (
-                                            null_real,
-                                            currency_number,
-                                            TRUE);
-                                str_amount = g_strdup ("0.00");
-                                str_desc = g_strconcat (div_name, _(" (budget exceeded)"), NULL);
-                            }
-                        }
-                        else
-                        {
-                            if (number.mantissa > 0)
-                            {
-                                str_amount = utils_real_get_string (number);
-                                str_credit = utils_real_get_string_with_currency (
-                                            gsb_real_abs (number),
-                                            currency_number,
-                                            TRUE);
-                                str_desc = g_strconcat (div_name, _(" (yet to receive)"), NULL);
-                            }
-                            else
-                            {
-                                str_credit = utils_real_get_string_with_currency (
-                                            null_real,
-                                            currency_number,
-                                            TRUE);
-                                str_amount = g_strdup ("0.00");
-                                str_desc = g_strconcat (div_name, _(" (budget exceeded)"), NULL);
-                            }
-                        }
-
-                        gtk_tree_store_set (GTK_TREE_STORE (model), &iter,
-                                            SPP_ESTIMATE_TREE_DESC_COLUMN, str_desc,
-                                            SPP_ESTIMATE_TREE_DEBIT_COLUMN, str_debit,
-                                            SPP_ESTIMATE_TREE_CREDIT_COLUMN, str_credit,
-                                            SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
-                                            -1);
-
-						g_free (str_credit);
-						g_free (str_debit);
-                    }
-                    g_free (str_desc);
-                    g_free (str_date);
-                    g_free (div_name);
-                    g_free (str_amount);
-					g_date_free (date);
-					g_date_free (date_today);
-                    break;
-                }
-                g_free (div_name);
-            }
-            g_free (str_date);
-            g_free (str_desc);
-            g_free (str_amount);
-        }
-        while (gtk_tree_model_iter_next (GTK_TREE_MODEL (model), &iter));
-    }
-}
-
 /**
  * fonction callback bouton to automatically change start date
  *
@@ -263,100 +126,6 @@ static void bet_array_auto_inc_month_toggle (GtkToggleButton *togglebutton,
     }
 }
 
-/**
- * This function is called by the Tree Model to sort two lines by date.
- *
- * \param
- * \param
- * \param
- * \param
- *
- * \return	0 for equal, less than zero if date_a is less than rhs,
- *			greater than zero if date_a is greater than rhs
- **/
-static gint bet_array_date_sort_function (GtkTreeModel *model,
-										  GtkTreeIter *itera,
-										  GtkTreeIter *iterb,
-										  gpointer null)
-{
-    GValue date_value_a = G_VALUE_INIT;
-    GValue date_value_b = G_VALUE_INIT;
-    GDate* date_a;
-    GDate* date_b;
-    gint result;
-
-    if (itera == NULL)
-        return -1;
-    if (iterb == NULL)
-        return -1;
-
-    /* get first date to compare */
-    gtk_tree_model_get_value (model, itera, SPP_ESTIMATE_TREE_SORT_DATE_COLUMN, &date_value_a);
-    date_a = g_value_get_boxed (&date_value_a);
-    if (date_a == NULL)
-        return -1;
-
-    /* get second date to compare */
-    gtk_tree_model_get_value (model, iterb, SPP_ESTIMATE_TREE_SORT_DATE_COLUMN, &date_value_b);
-    date_b = g_value_get_boxed (&date_value_b);
-    if (date_b == NULL)
-        return -1;
-
-    result = g_date_compare (date_b, date_a);
-    if (result == 0)
-    {
-        gint origine_a;
-        gint origine_b;
-        gchar *str_amount_a;
-        gchar *str_amount_b;
-		gchar *str_description_a;
- 		gchar *str_description_b;
-
-        gtk_tree_model_get (GTK_TREE_MODEL (model),
-							itera,
-							SPP_ESTIMATE_TREE_ORIGIN_DATA, &origine_a,
-							SPP_ESTIMATE_TREE_AMOUNT_COLUMN, &str_amount_a,
-							SPP_ESTIMATE_TREE_DESC_COLUMN, &str_description_a,
-							-1);
-
-		gtk_tree_model_get (GTK_TREE_MODEL (model),
-							iterb,
-							SPP_ESTIMATE_TREE_ORIGIN_DATA, &origine_b,
-							SPP_ESTIMATE_TREE_AMOUNT_COLUMN, &str_amount_b,
-							SPP_ESTIMATE_TREE_DESC_COLUMN, &str_description_b,
-							-1);
-		//~ printf ("date_a = %s amount_a = %s str_description_a = %s origine_a = %d\ndate_b = %s amount_b = %s str_description_b =%s origine_b = %d\n",
-				//~ gsb_format_gdate (date_a), str_amount_a, str_description_a,origine_a,
-				//~ gsb_format_gdate (date_b), str_amount_b, str_description_b, origine_b);
-
-        if (origine_a == SPP_ORIGIN_SOLDE)
-        {
-            result = 1;
-        }
-		else if (origine_a == origine_b)
-		{
-			GsbReal amount_a = null_real;
-			GsbReal amount_b = null_real;
-
-			amount_a = utils_real_get_from_string (str_amount_a);
-			amount_b = utils_real_get_from_string (str_amount_b);
-			result = - (gsb_real_cmp (amount_a, amount_b));
-		}
-		else
-			result = (origine_b -origine_a);
-
-		g_free (str_amount_a);
-		g_free (str_amount_b);
-		g_free (str_description_a);
-		g_free (str_description_b);
-    }
-
-    g_value_unset (&date_value_b);
-    g_value_unset (&date_value_a);
-
-    return result;
-}
-
 /**
  *
  *
@@ -1532,110 +1301,6 @@ static void bet_array_list_size_allocate (GtkWidget *tree_view,
     }
 }
 
-/**
- *
- *
- * \param
- * \param
- * \param
- *
- * \return
- **/
-static gboolean bet_array_shows_balance_at_beginning_of_month (GtkTreeModel *tab_model,
-                        						 			   GDate *date_min,
-                        									   GDate *date_max)
-{
-    GDate *date;
-    gchar *str_amount;
-
-    date = gsb_date_copy (date_min);
-    g_date_add_months (date, 1);
-    g_date_set_day (date, 1);
-
-    str_amount = utils_real_get_string (null_real);
-
-    while (g_date_compare (date, date_max) < 0)
-    {
-        GtkTreeIter tab_iter;
-        GValue date_value = G_VALUE_INIT;
-        gchar *str_date;
-        gchar *str_description;
-
-        g_value_init (&date_value, G_TYPE_DATE);
-        g_value_set_boxed (&date_value, date);
-
-        str_date = gsb_format_gdate (date);
-        str_description = g_strconcat (_("Balance at "), str_date, NULL);
-
-        /* add a line in the estimate array */
-        gtk_tree_store_append (GTK_TREE_STORE (tab_model), &tab_iter, NULL);
-        gtk_tree_store_set_value (GTK_TREE_STORE (tab_model),
-								  &tab_iter,
-								  SPP_ESTIMATE_TREE_SORT_DATE_COLUMN, &date_value);
-
-        gtk_tree_store_set (GTK_TREE_STORE (tab_model),
-							&tab_iter,
-                        	SPP_ESTIMATE_TREE_ORIGIN_DATA, SPP_ORIGIN_SOLDE,
-                        	SPP_ESTIMATE_TREE_DATE_COLUMN, str_date,
-                        	SPP_ESTIMATE_TREE_DESC_COLUMN, str_description,
-                        	SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
-                        	SPP_ESTIMATE_TREE_BALANCE_COLOR, NULL,
-                        	SPP_ESTIMATE_TREE_BACKGROUND_COLOR, gsb_rgba_get_couleur ("background_bet_solde"),
-                        	-1);
-
-        g_value_unset (&date_value);
-        g_free (str_date);
-        g_free (str_description);
-
-        g_date_add_months (date, 1);
-    }
-    g_free (str_amount);
-    g_date_free (date);
-
-    return FALSE;
-}
-
-/**
- * Cette fonction permet de sauter les opérations planifiées qui sont
- * remplacées par des données historiques
- *
- * \param
- * \param
- * \param
- *
- * \return TRUE si l'opération doit être ignorée
- **/
-static gboolean bet_array_sort_scheduled_transactions (gint div_number,
-                        						 	   gint sub_div_nb,
-                        							   GtkTreeModel *model)
-{
-    GtkTreeIter iter;
-
-    if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (model), &iter))
-    {
-        gint tmp_div_number;
-        gint tmp_sub_div_nb;
-
-        do
-        {
-            gtk_tree_model_get (GTK_TREE_MODEL (model),
-								&iter,
-                        		SPP_ESTIMATE_TREE_DIVISION_COLUMN, &tmp_div_number,
-                        		SPP_ESTIMATE_TREE_SUB_DIV_COLUMN, &tmp_sub_div_nb,
-                        		-1);
-
-            if (tmp_div_number == 0 || tmp_div_number != div_number)
-                continue;
-
-            if (tmp_sub_div_nb == 0 || tmp_sub_div_nb == sub_div_nb)
-                return TRUE;
-        }
-        while (gtk_tree_model_iter_next (GTK_TREE_MODEL (model), &iter));
-    }
-
-    return FALSE;
-}
-
 /**
  *
  *
@@ -1708,111 +1373,6 @@ static gboolean bet_array_entry_key_press (GtkWidget *entry,
     return FALSE;
 }
 
-/**
- * Remplace une opération planifiée ou non en fonction du paramètre origin_data
- * par la ligne de solde de carte à débit différé
- *
- * \param model             du treeview
- * \param struct transfert  contenant les données de remplacement
- * \param origin_data       SPP_ORIGIN_TRANSACTION ou SPP_ORIGIN_SCHEDULED
- *
- * \return FALSE
- **/
-static gboolean bet_array_list_replace_line_by_transfert (GtkTreeModel *tab_model,
-														  TransfertData *transfert,
-														  gint origin_data)
-{
-    GtkTreeIter iter;
-
-    if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (tab_model), &iter))
-    {
-        gchar *str_date = NULL;
-        GDate *date_debut_comparaison;
-        GDate *date_fin_comparaison;
-        GDate *date;
-		gint tmp_payee_number = 0;
-        gint transaction_number;
-        gint origine;
-        gboolean trouve = FALSE;
-
-        date_debut_comparaison = g_date_new_dmy (g_date_get_day (transfert->date_debit),
-                    g_date_get_month (transfert->date_debit),
-                    g_date_get_year (transfert->date_debit));
-        g_date_subtract_days (date_debut_comparaison,
-                    etat.import_files_nb_days);
-
-        date_fin_comparaison = g_date_new_dmy (g_date_get_day (transfert->date_debit),
-                    g_date_get_month (transfert->date_debit),
-                    g_date_get_year (transfert->date_debit));
-        g_date_add_days (date_fin_comparaison,
-                    etat.import_files_nb_days);
-
-        do
-        {
-            gtk_tree_model_get (GTK_TREE_MODEL (tab_model),
-                        &iter,
-                        SPP_ESTIMATE_TREE_ORIGIN_DATA, &origine,
-                        SPP_ESTIMATE_TREE_DIVISION_COLUMN, &transaction_number,
-                        SPP_ESTIMATE_TREE_DATE_COLUMN, &str_date,
-                        -1);
-
-            date = gsb_parse_date_string (str_date);
-            g_free (str_date);
-
-            if (!date)
-            {
-                continue;
-            }
-
-            if (g_date_compare (date, date_debut_comparaison) < 0)
-            {
-                g_date_free (date);
-                continue;
-            }
-
-            if (g_date_compare (date, date_fin_comparaison) > 0)
-            {
-                g_date_free (date);
-                break;
-            }
-
-            if (origine != origin_data)
-            {
-                g_date_free (date);
-                continue;
-            }
-
-			/* On cherche une opération par tiers */
-			if (origin_data == SPP_ORIGIN_TRANSACTION)
-				tmp_payee_number = gsb_data_transaction_get_party_number (transaction_number);
-			else
-				tmp_payee_number = gsb_data_scheduled_get_party_number (transaction_number);
-
-			if (transfert->main_payee_number == tmp_payee_number)
-			{
-				gtk_tree_store_remove (GTK_TREE_STORE (tab_model), &iter);
-
-				g_date_free (date);
-				trouve = TRUE;
-				break;
-			}
-			else
-			{
-				g_date_free (date);
-				continue;
-			}
-        }
-        while (gtk_tree_model_iter_next (GTK_TREE_MODEL (tab_model), &iter));
-
-        g_date_free (date_debut_comparaison);
-        g_date_free (date_fin_comparaison);
-
-        return trouve;
-    }
-
-    return FALSE;
-}
-
 /**
  *
  *
@@ -1856,39 +1416,29 @@ static void bet_array_list_execute_balance_deferred_debit_account (GtkWidget *me
 }
 
 /**
- * remplace l'opération planifiée de même date et de même catégorie ou IB
+ * create the model of the estimate array
  *
- * \param modèle du tableau
  * \param
  *
- * \return
+ * \return a new GtkTreeStore
  **/
-static void bet_array_list_replace_transactions_by_transfert (GtkTreeModel *tab_model,
-                        									  gint account_number)
+static GtkTreeStore *bet_array_list_new_model (void)
 {
-    GHashTable *transfert_list;
-    GHashTableIter iter;
-    gpointer key, value;
-
-    transfert_list = bet_data_transfert_get_list ();
-    g_hash_table_iter_init (&iter, transfert_list);
-    while (g_hash_table_iter_next (&iter, &key, &value))
-    {
-        TransfertData *transfert = (TransfertData *) value;
-
-        if (account_number != transfert->account_number)
-            continue;
-
-        if ( transfert->replace_transaction)
-        {
-            gboolean trouve = FALSE;
-
-            trouve = bet_array_list_replace_line_by_transfert (tab_model, transfert, SPP_ORIGIN_TRANSACTION);
-
-            if (trouve == FALSE)
-                bet_array_list_replace_line_by_transfert (tab_model, transfert, SPP_ORIGIN_SCHEDULED);
-        }
-    }
+    return gtk_tree_store_new (SPP_ESTIMATE_TREE_NUM_COLUMNS,
+                    G_TYPE_BOOLEAN,     /* SPP_ESTIMATE_TREE_SELECT_COLUMN */
+                    G_TYPE_INT,         /* SPP_ESTIMATE_TREE_ORIGIN_DATA */
+                    G_TYPE_INT,         /* SPP_ESTIMATE_TREE_DIVISION_COLUMN */
+                    G_TYPE_INT,         /* SPP_ESTIMATE_TREE_SUB_DIV_COLUMN */
+                    G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_DATE_COLUMN */
+                    G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_DESC_COLUMN */
+                    G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_DEBIT_COLUMN */
+                    G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_CREDIT_COLUMN */
+                    G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_BALANCE_COLUMN */
+                    G_TYPE_DATE,        /* SPP_ESTIMATE_TREE_SORT_DATE_COLUMN */
+                    G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_AMOUNT_COLUMN */
+                    G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_BALANCE_COLOR */
+                    GDK_TYPE_RGBA,      /* SPP_ESTIMATE_TREE_BACKGROUND_COLOR */
+                    G_TYPE_STRING);    /* SPP_ESTIMATE_TREE_COLOR_STRING */
 }
 
 /**
@@ -1918,34 +1468,12 @@ static GtkWidget *bet_array_create_tree_view (GtkWidget *container)
 	gtk_widget_set_name (tree_view, "colorized_tree_view");
 
     /* create the model */
-    tree_model = gtk_tree_store_new (SPP_ESTIMATE_TREE_NUM_COLUMNS,
-                    G_TYPE_BOOLEAN,     /* SPP_ESTIMATE_TREE_SELECT_COLUMN */
-                    G_TYPE_INT,         /* SPP_ESTIMATE_TREE_ORIGIN_DATA */
-                    G_TYPE_INT,         /* SPP_ESTIMATE_TREE_DIVISION_COLUMN */
-                    G_TYPE_INT,         /* SPP_ESTIMATE_TREE_SUB_DIV_COLUMN */
-                    G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_DATE_COLUMN */
-                    G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_DESC_COLUMN */
-                    G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_DEBIT_COLUMN */
-                    G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_CREDIT_COLUMN */
-                    G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_BALANCE_COLUMN */
-                    G_TYPE_DATE,        /* SPP_ESTIMATE_TREE_SORT_DATE_COLUMN */
-                    G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_AMOUNT_COLUMN */
-                    G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_BALANCE_COLOR */
-                    GDK_TYPE_RGBA,      /* SPP_ESTIMATE_TREE_BACKGROUND_COLOR */
-                    G_TYPE_STRING);    /* SPP_ESTIMATE_TREE_COLOR_STRING */
+    tree_model = bet_array_list_new_model ();
 
     gtk_tree_view_set_model (GTK_TREE_VIEW (tree_view), GTK_TREE_MODEL (tree_model));
     g_object_unref (G_OBJECT (tree_model));
 
-    /* sort by date */
-    gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (tree_model),
-                        SPP_ESTIMATE_TREE_SORT_DATE_COLUMN,
-                        (GtkTreeIterCompareFunc) bet_array_date_sort_function,
-                        NULL,
-                        NULL);
-    gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (tree_model),
-                        SPP_ESTIMATE_TREE_SORT_DATE_COLUMN,
-                        GTK_SORT_DESCENDING);
+    /* the lines are added already sorted by bet_forecast_compute () */
 
     scrolled_window = gtk_scrolled_window_new (NULL, NULL);
     gtk_widget_show (scrolled_window);
@@ -2110,6 +1638,16 @@ static GtkWidget *bet_array_list_create_toolbar (GtkWidget *parent,
 					  G_CALLBACK (bet_array_list_execute_balance_deferred_debit_account),
 					  tree_view);
     gtk_toolbar_insert (GTK_TOOLBAR (toolbar), item, -1);
+
+	/* consolidated forecast of a partial balance */
+    item = utils_buttons_tool_button_new_from_image_label ("gtk-open-24.png", _("Partial balances"));
+    gtk_widget_set_tooltip_text (GTK_WIDGET (item),
+								 _("Show the estimate of a partial balance which contains the account"));
+    g_signal_connect (G_OBJECT (item),
+					  "clicked",
+					  G_CALLBACK (bet_array_list_partial_balance_menu),
+					  NULL);
+    gtk_toolbar_insert (GTK_TOOLBAR (toolbar), item, -1);
 #ifdef HAVE_GOFFICE
     /* graph button */
     item = bet_graph_button_menu_new (toolbar,
@@ -2123,575 +1661,379 @@ static GtkWidget *bet_array_list_create_toolbar (GtkWidget *parent,
 }
 
 /**
- * Ajoute la ligne future au tableau des résultats
+ * add a line of the forecast in the estimate array
  *
- * \param
- * \param
- * \param
+ * \param tab_model
+ * \param forecast		the forecast of an account or of a partial balance
+ * \param event
  *
  * \return
  **/
-static gboolean bet_array_refresh_futur_data (GtkTreeModel *tab_model,
-                        					  GDate *date_min,
-                        					  GDate *date_max)
+static void bet_array_list_append_event (GtkTreeModel *tab_model,
+										 BetForecast *forecast,
+										 BetForecastEvent *event)
 {
-    GHashTable *future_list;
-    GHashTableIter iter;
-    gpointer key, value;
+    GtkTreeIter iter;
+    GValue date_value = G_VALUE_INIT;
+    const gchar *color_str = NULL;
+    gchar *str_date;
+    gchar *str_description = NULL;
+    gchar *str_debit = NULL;
+    gchar *str_credit = NULL;
+    gchar *str_amount;
+    gchar *str_balance;
+    GdkRGBA *background = NULL;
+    GsbReal amount;
     gint account_number;
+    gint currency_number;
 
-    /* devel_debug (NULL); */
-
-    account_number = gsb_gui_navigation_get_current_account ();
-    future_list = bet_data_future_get_list ();
-	if (g_hash_table_size (future_list) == 0)
-		return FALSE;
+    /* amount shown in the debit or credit column, may be in another currency */
+    account_number = event->account_number;
+    amount = event->amount;
+    currency_number = forecast->currency_number;
+    str_date = gsb_format_gdate (&event->date);
 
-    g_hash_table_iter_init (&iter, future_list);
-    while (g_hash_table_iter_next (&iter, &key, &value))
+    switch (event->origin)
     {
-        FuturData *scheduled = (FuturData *) value;
-        GtkTreeIter tab_iter;
-        GValue date_value = G_VALUE_INIT;
-        gchar *str_debit = NULL;
-        gchar *str_credit = NULL;
-        gchar *str_date;
-        gchar *str_description;
-        gchar *str_amount;
-        GDate *date_tomorrow;
-        GsbReal amount;
-        gboolean inverse_amount = FALSE;
-        gint currency_number;
-
-        if (account_number != scheduled->account_number)
+        case SPP_ORIGIN_TRANSACTION:
         {
-            if (scheduled->is_transfert == 0
-             || (scheduled->is_transfert && account_number != scheduled->account_transfert))
-                continue;
+            gint transfer_number;
+
+            transfer_number = gsb_data_transaction_get_contra_transaction_number (event->number);
+            if (transfer_number > 0)
+                str_description = g_strdup_printf (_("Transfer between account: %s\n"
+                                                     "and account: %s"),
+                                                   gsb_data_account_get_name (account_number),
+                                                   gsb_data_account_get_name (gsb_data_transaction_get_account_number
+                                                                              (transfer_number)));
             else
-                inverse_amount = TRUE;
-        }
+                str_description = bet_array_list_get_description (account_number,
+                                                                  SPP_ORIGIN_TRANSACTION,
+                                                                  GINT_TO_POINTER (event->number));
 
-        date_tomorrow = gsb_date_tomorrow ();
-        if (g_date_compare (scheduled->date, date_tomorrow) < 0)
-        {
-            bet_data_future_remove_line (account_number, scheduled->number, FALSE);
-            g_hash_table_iter_init (&iter, future_list);
-            g_date_free (date_tomorrow);
-            if (g_hash_table_size (future_list) == 0)
-                return FALSE;
-            continue;
+            amount = gsb_data_transaction_get_amount (event->number);
+            currency_number = gsb_data_transaction_get_currency_number (event->number);
+            break;
         }
-        else
-            g_date_free (date_tomorrow);
-
-        if (g_date_compare (scheduled->date, date_max) > 0)
-            continue;
-        if (g_date_compare (scheduled->date, date_min) < 0)
-            continue;
+        case SPP_ORIGIN_SCHEDULED:
+        {
+            gint scheduled_account;
 
-        str_description = bet_array_list_get_description (account_number, SPP_ORIGIN_FUTURE, value);
+            scheduled_account = gsb_data_scheduled_get_account_number (event->number);
+            if (gsb_data_scheduled_is_transfer (event->number))
+                str_description = g_strdup_printf (_("Transfer between account: %s\n"
+                                                     "and account: %s"),
+                                                   gsb_data_account_get_name (account_number),
+                                                   gsb_data_account_get_name (scheduled_account == account_number
+                                                                              ? gsb_data_scheduled_get_account_number_transfer
+                                                                              (event->number)
+                                                                              : scheduled_account));
+            else
+                str_description = bet_array_list_get_description (account_number,
+                                                                  SPP_ORIGIN_SCHEDULED,
+                                                                  GINT_TO_POINTER (event->number));
 
-        if (inverse_amount)
-            amount = gsb_real_opposite (scheduled->amount);
-        else
-            amount = scheduled->amount;
+            /* the amount of a transfer to the account is already in its currency */
+            if (scheduled_account == account_number)
+            {
+                amount = gsb_data_scheduled_get_amount (event->number);
+                currency_number = gsb_data_scheduled_get_currency_number (event->number);
+            }
+            break;
+        }
+        case SPP_ORIGIN_FUTURE:
+            str_description = bet_array_list_get_description (account_number, SPP_ORIGIN_FUTURE, event->data);
+            break;
+        case SPP_ORIGIN_HISTORICAL:
+            currency_number = bet_data_get_selected_currency ();
+            if (event->hist_state == BET_FORECAST_HIST_NOT_ADJUSTED)
+                str_description = g_strdup (event->label);
+            else
+            {
+                gchar *div_name;
+                gint sign;
+
+                div_name = bet_data_get_div_name (event->number, event->sub_number, NULL);
+                sign = bet_data_get_div_type (event->number);
+                if (event->hist_state == BET_FORECAST_HIST_EXCEEDED)
+                    str_description = g_strconcat (div_name, _(" (budget exceeded)"), NULL);
+                else if (sign == 1)
+                    str_description = g_strconcat (div_name, _(" (still available)"), NULL);
+                else
+                    str_description = g_strconcat (div_name, _(" (yet to receive)"), NULL);
+                g_free (div_name);
 
-        currency_number = gsb_data_account_get_currency (account_number);
-        str_amount = utils_real_get_string (amount);
+                /* the rest of a budget is in the debit column */
+                if (sign == 1)
+                    str_debit = utils_real_get_string_with_currency (gsb_real_abs (amount), currency_number, TRUE);
+                else
+                    str_credit = utils_real_get_string_with_currency (gsb_real_abs (amount), currency_number, TRUE);
+            }
+            break;
+        case SPP_ORIGIN_ACCOUNT:
+        {
+            TransfertData *transfert = (TransfertData *) event->data;
 
+            str_description = bet_array_list_get_description (transfert->replace_account,
+                                                              SPP_ORIGIN_ACCOUNT,
+                                                              transfert);
+            if (transfert->type == 0)
+                amount = gsb_data_account_get_current_balance (transfert->replace_account);
+            else
+                amount = gsb_data_partial_balance_get_current_amount (transfert->replace_account);
+            currency_number = gsb_data_account_get_currency (transfert->replace_account);
+            break;
+        }
+        case SPP_ORIGIN_SOLDE:
+            if (event->number == BET_FORECAST_BALANCE_START)
+            {
+                GDate date;
+
+                /* the line is the day before the period but shows its first day */
+                date = event->date;
+                g_date_add_days (&date, 1);
+                g_free (str_date);
+                str_date = gsb_format_gdate (&date);
+                str_description = g_strdup (_("balance beginning of period"));
+            }
+            else
+                str_description = g_strconcat (_("Balance at "), str_date, NULL);
+
+            background = gsb_rgba_get_couleur ("background_bet_solde");
+            break;
+    }
+
+    if (event->origin != SPP_ORIGIN_SOLDE && str_debit == NULL && str_credit == NULL)
+    {
         if (amount.mantissa < 0)
-            str_debit = utils_real_get_string_with_currency (gsb_real_opposite (amount),
-															 currency_number,
-															 TRUE);
+            str_debit = utils_real_get_string_with_currency (gsb_real_abs (amount), currency_number, TRUE);
         else
             str_credit = utils_real_get_string_with_currency (amount, currency_number, TRUE);
+    }
 
-        str_date = gsb_format_gdate (scheduled->date);
-
-        g_value_init (&date_value, G_TYPE_DATE);
-        g_value_set_boxed (&date_value, scheduled->date);
-
-        /* add a line in the estimate array */
-        gtk_tree_store_append (GTK_TREE_STORE (tab_model), &tab_iter, NULL);
-        gtk_tree_store_set_value (GTK_TREE_STORE (tab_model),
-								  &tab_iter,
-								  SPP_ESTIMATE_TREE_SORT_DATE_COLUMN, &date_value);
-        gtk_tree_store_set (GTK_TREE_STORE (tab_model),
-							&tab_iter,
-                        	SPP_ESTIMATE_TREE_ORIGIN_DATA, SPP_ORIGIN_FUTURE,
-                        	SPP_ESTIMATE_TREE_DIVISION_COLUMN, scheduled->number,
-                        	SPP_ESTIMATE_TREE_SUB_DIV_COLUMN, scheduled->mother_row,
-                        	SPP_ESTIMATE_TREE_DATE_COLUMN, str_date,
-                        	SPP_ESTIMATE_TREE_DESC_COLUMN, str_description,
-                        	SPP_ESTIMATE_TREE_DEBIT_COLUMN, str_debit,
-                        	SPP_ESTIMATE_TREE_CREDIT_COLUMN, str_credit,
-                        	SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
-                        	-1);
+    str_amount = utils_real_get_string (event->amount);
+    str_balance = utils_real_get_string_with_currency (event->balance, forecast->currency_number, TRUE);
+    if (event->balance.mantissa < 0)
+        color_str = "red";
 
-        g_value_unset (&date_value);
-        g_free (str_date);
-        g_free (str_description);
-        g_free (str_amount);
-        g_free (str_debit);
-        g_free (str_credit);
-    }
+    g_value_init (&date_value, G_TYPE_DATE);
+    g_value_set_boxed (&date_value, &event->date);
+
+    /* add a line in the estimate array */
+    gtk_tree_store_append (GTK_TREE_STORE (tab_model), &iter, NULL);
+    gtk_tree_store_set_value (GTK_TREE_STORE (tab_model),
+                              &iter,
+                              SPP_ESTIMATE_TREE_SORT_DATE_COLUMN, &date_value);
+    gtk_tree_store_set (GTK_TREE_STORE (tab_model),
+                        &iter,
+                        SPP_ESTIMATE_TREE_ORIGIN_DATA, event->origin,
+                        SPP_ESTIMATE_TREE_DIVISION_COLUMN, event->number,
+                        SPP_ESTIMATE_TREE_SUB_DIV_COLUMN, event->sub_number,
+                        SPP_ESTIMATE_TREE_DATE_COLUMN, str_date,
+                        SPP_ESTIMATE_TREE_DESC_COLUMN, str_description,
+                        SPP_ESTIMATE_TREE_DEBIT_COLUMN, str_debit,
+                        SPP_ESTIMATE_TREE_CREDIT_COLUMN, str_credit,
+                        SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
+                        SPP_ESTIMATE_TREE_BALANCE_COLUMN, str_balance,
+                        SPP_ESTIMATE_TREE_BALANCE_COLOR, color_str,
+                        SPP_ESTIMATE_TREE_BACKGROUND_COLOR, background,
+                        -1);
 
-    return TRUE;
+    g_value_unset (&date_value);
+    g_free (str_date);
+    g_free (str_description);
+    g_free (str_debit);
+    g_free (str_credit);
+    g_free (str_amount);
+    g_free (str_balance);
 }
 
 /**
+ * check if an account is in a partial balance
  *
+ * \param partial_number
+ * \param account_number
  *
- * \param
- * \param
- * \param
- * \param
- *
- * \return
+ * \return TRUE if the account is in the partial balance
  **/
-static void bet_array_refresh_scheduled_data (GtkTreeModel *tab_model,
-                        					  gint selected_account,
-                        					  GDate *date_min,
-                        					  GDate *date_max)
+static gboolean bet_array_partial_balance_has_account (gint partial_number,
+													   gint account_number)
 {
-    GtkTreeIter iter;
-    GSList* tmp_list;
-
-    /* devel_debug (NULL); */
-    tmp_list = gsb_data_scheduled_get_scheduled_list ();
-
-    while (tmp_list)
-    {
-        gchar *str_amount;
-        gchar *str_debit = NULL;
-        gchar *str_credit = NULL;
-        gchar *str_description = NULL;
-        gchar *str_date;
-        gint scheduled_number;
-        gint account_number;
-        gint transfer_account_number;
-        gint div_number;
-        gint sub_div_nb;
-        gint currency_number;
-        GDate *date;
-        GValue date_value = G_VALUE_INIT;
-        GsbReal amount;
-
-        scheduled_number = gsb_data_scheduled_get_scheduled_number (tmp_list->data);
-
-        tmp_list = tmp_list->next;
-
-         /* ignore splitted transactions */
-        if (gsb_data_scheduled_get_split_of_scheduled (scheduled_number) == TRUE)
-            continue;
-
-        /* ignores transactions replaced with historical data */
-        account_number = gsb_data_scheduled_get_account_number (scheduled_number);
-
-        div_number = bet_data_get_div_number (scheduled_number, FALSE);
-        sub_div_nb = bet_data_get_sub_div_nb (scheduled_number, FALSE);
-
-        if (div_number > 0
-         &&
-         bet_data_search_div_hist (account_number, div_number, 0)
-         &&
-         bet_array_sort_scheduled_transactions (div_number, sub_div_nb, tab_model))
-            continue;
-
-        /* ignore scheduled operations of other account */
-        if (gsb_data_scheduled_is_transfer (scheduled_number))
-        {
-            transfer_account_number = gsb_data_scheduled_get_account_number_transfer (
-                        scheduled_number);
-            if (transfer_account_number == selected_account)
-            {
-                gint floating_point;
+	const gchar *liste_cptes;
+	gchar **tab;
+	gboolean found = FALSE;
+	gint i;
 
-                currency_number = gsb_data_account_get_currency (selected_account);
-                floating_point = gsb_data_account_get_currency_floating_point (selected_account);
-                str_description = g_strdup_printf (_("Transfer between account: %s\n"
-													 "and account: %s"),
-												   gsb_data_account_get_name (transfer_account_number),
-												   gsb_data_account_get_name (account_number));
-
-                amount = gsb_real_opposite (gsb_data_scheduled_get_adjusted_amount_for_currency
-											(scheduled_number, currency_number, floating_point));
-                str_amount = utils_real_get_string (amount);
-            }
-            else if (account_number == selected_account)
-            {
-                currency_number = gsb_data_scheduled_get_currency_number (scheduled_number);
-                str_description = g_strdup_printf (_("Transfer between account: %s\n"
-													 "and account: %s"),
-												   gsb_data_account_get_name (account_number),
-												   gsb_data_account_get_name (transfer_account_number));
-
-                amount = gsb_data_scheduled_get_amount (scheduled_number);
-                str_amount = bet_data_get_str_amount_in_account_currency (amount,
-																		  account_number,
-                        												  scheduled_number,
-                        												  SPP_ORIGIN_SCHEDULED);
-            }
-            else
-                continue;
-        }
-        else if (account_number == selected_account)
-        {
-            currency_number = gsb_data_scheduled_get_currency_number (scheduled_number);
-            str_description = bet_array_list_get_description (account_number,
-															  SPP_ORIGIN_SCHEDULED,
-															  GINT_TO_POINTER (scheduled_number));
-
-            amount = gsb_data_scheduled_get_amount (scheduled_number);
-            str_amount = bet_data_get_str_amount_in_account_currency (amount,
-                        											  account_number,
-                       											 	  scheduled_number,
-                        											  SPP_ORIGIN_SCHEDULED);
-        }
-        else
-            continue;
-
-        if (amount.mantissa < 0)
-            str_debit = utils_real_get_string_with_currency (gsb_real_abs (amount), currency_number, TRUE);
-        else
-            str_credit = utils_real_get_string_with_currency (amount, currency_number, TRUE);
-
-        /* calculate each instance of the scheduled operation
-         * in the range from date_min (today) to date_max */
-        date = gsb_date_copy (gsb_data_scheduled_get_date (scheduled_number));
-
-        while (date != NULL && g_date_valid (date))
-        {
-			GDate *tmp_date = NULL;
-
-            if (g_date_compare (date, date_max) > 0)
-			{
-				g_date_free (date);
-                break;
-			}
-            if (g_date_compare (date, date_min) < 0)
-            {
-				tmp_date = date;
-                date = gsb_scheduler_get_next_date (scheduled_number, tmp_date);
-				g_date_free (tmp_date);
-                continue;
-            }
-            if (date == NULL || g_date_valid (date) == FALSE)
-			{
-				if (date)
-					g_date_free (date);
-                return;
-			}
-
-            str_date = gsb_format_gdate (date);
+	liste_cptes = gsb_data_partial_balance_get_liste_cptes (partial_number);
+	if (liste_cptes == NULL)
+		return FALSE;
 
-            g_value_init (&date_value, G_TYPE_DATE);
-            g_value_set_boxed (&date_value, date);
+	tab = g_strsplit (liste_cptes, ";", 0);
+	for (i = 0; tab[i] && !found; i++)
+	{
+		if (strlen (tab[i]) && utils_str_atoi (tab[i]) == account_number)
+			found = TRUE;
+	}
+	g_strfreev (tab);
 
-            /* add a line in the estimate array */
-            gtk_tree_store_append (GTK_TREE_STORE (tab_model), &iter, NULL);
-            gtk_tree_store_set_value (GTK_TREE_STORE (tab_model),
-									  &iter,
-                        			  SPP_ESTIMATE_TREE_SORT_DATE_COLUMN, &date_value);
-            gtk_tree_store_set (GTK_TREE_STORE (tab_model),
-								&iter,
-                        		SPP_ESTIMATE_TREE_ORIGIN_DATA, SPP_ORIGIN_SCHEDULED,
-                        		SPP_ESTIMATE_TREE_DIVISION_COLUMN, scheduled_number,
-                        		SPP_ESTIMATE_TREE_SUB_DIV_COLUMN, 0,
-                        		SPP_ESTIMATE_TREE_DATE_COLUMN, str_date,
-                        		SPP_ESTIMATE_TREE_DESC_COLUMN, str_description,
-                        		SPP_ESTIMATE_TREE_DEBIT_COLUMN, str_debit,
-                        		SPP_ESTIMATE_TREE_CREDIT_COLUMN, str_credit,
-                        		SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
-                        		-1);
-
-            g_value_unset (&date_value);
-            g_free (str_date);
-			tmp_date = date;
-			date = gsb_scheduler_get_next_date (scheduled_number, tmp_date);
-			g_date_free (tmp_date);
-        }
-        g_free (str_amount);
-        g_free (str_credit);
-        g_free (str_debit);
-		g_free (str_description);
-    }
+	return found;
 }
 
 /**
+ * show in a dialog the consolidated forecast of a partial balance
+ * for the period of the estimate array of the current account
  *
- *
- * \param
- * \param
- * \param
- * \param
+ * \param menu_item
+ * \param partial_number_ptr	the number of the partial balance
  *
  * \return
  **/
-static void bet_array_refresh_transactions_data (GtkTreeModel *tab_model,
-                        						 gint selected_account,
-                        						 GDate *date_min,
-                        						 GDate *date_max)
+static void bet_array_show_partial_balance_estimate (GtkWidget *menu_item,
+													 gpointer partial_number_ptr)
 {
-    GDate *date_jour_1;
-    GDate *date_comp;
-    GSList *tmp_list;
-
-    /* devel_debug (NULL); */
-    /* init dates */
-    date_jour_1 = gdate_today ();
-    if (g_date_get_day (date_min) > 1)
-        g_date_set_day (date_jour_1, 1);
-    if (g_date_compare (date_jour_1, date_min) < 0)
-        date_comp = date_jour_1;
-    else
-        date_comp = date_min;
-
-    /* search transactions of the account which are in the period */
-    tmp_list = gsb_data_transaction_get_transactions_list ();
-
-    while (tmp_list)
-    {
-        GtkTreeIter iter;
-        gchar* str_amount;
-        gchar* str_debit = NULL;
-        gchar* str_credit = NULL;
-        gchar* str_description;
-        gchar* str_date;
-        gint transaction_number;
-        gint transfer_number;
-        gint account_number;
-        gint transfer_account_number;
-        gint div_number;
-        gint sub_div_nb;
-        gint currency_number;
-        const GDate *date;
-        GValue date_value = G_VALUE_INIT;
-        GsbReal amount;
-
-        transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
-        tmp_list = tmp_list->next;
-
-        account_number =  gsb_data_transaction_get_account_number (transaction_number);
-        if (account_number != selected_account)
-            continue;
-
-        date = gsb_data_transaction_get_value_date_or_date (transaction_number);
-
-        /* ignore transaction which are after date_max */
-        if (g_date_compare (date, date_max) > 0)
-            continue;
+    GtkWidget *dialog;
+    GtkWidget *content_area;
+    GtkWidget *scrolled_window;
+    GtkWidget *tree_view;
+    GtkTreeStore *tree_model;
+    GDate *date_min;
+    GDate *date_max;
+    gchar *str_date_min;
+    gchar *str_date_max;
+    gchar *title;
+    BetForecast *forecast;
+    gint account_number;
+    gint partial_number;
+    guint i;
+    const gchar *titles[] = {N_("Date"), N_("Description"), N_("Debit"), N_("Credit"), N_("Balance")};
+    const gint columns[] = {SPP_ESTIMATE_TREE_DATE_COLUMN,
+                            SPP_ESTIMATE_TREE_DESC_COLUMN,
+                            SPP_ESTIMATE_TREE_DEBIT_COLUMN,
+                            SPP_ESTIMATE_TREE_CREDIT_COLUMN,
+                            SPP_ESTIMATE_TREE_BALANCE_COLUMN};
+    const gfloat xalign[] = {0.5, 0.0, 1.0, 1.0, 1.0};
 
-        /* ignore splitted transactions */
-        if (gsb_data_transaction_get_split_of_transaction (transaction_number) == TRUE)
-            continue;
+    devel_debug (NULL);
+    partial_number = GPOINTER_TO_INT (partial_number_ptr);
+    account_number = gsb_gui_navigation_get_current_account ();
 
-        /* Ignore transactions that are before date_comp */
-        if (g_date_compare (date, date_comp) < 0)
-            continue;
+    /* the same period as the estimate array of the account */
+    date_min = gsb_data_account_get_bet_start_date (account_number);
+    date_max = bet_data_array_get_date_max (account_number);
 
-        /* ignores transactions replaced with historical data */
-        amount = gsb_data_transaction_get_amount (transaction_number);
+    forecast = bet_forecast_new_for_partial_balance (partial_number, date_min, date_max);
 
-        div_number = bet_data_get_div_number (transaction_number, TRUE);
-        sub_div_nb = bet_data_get_sub_div_nb (transaction_number, TRUE);
-        if (div_number > 0
-         &&
-         bet_data_search_div_hist (account_number, div_number, 0))
-        {
-            if (g_date_get_month (date) == g_date_get_month (date_jour_1))
-                bet_array_adjust_hist_amount (div_number, sub_div_nb, amount, tab_model);
-        }
+    tree_model = bet_array_list_new_model ();
+    for (i = 0; i < forecast->events->len; i++)
+        bet_array_list_append_event (GTK_TREE_MODEL (tree_model),
+                                     forecast,
+                                     &g_array_index (forecast->events, BetForecastEvent, i));
+    bet_forecast_free (forecast);
 
-        /* ignore transaction which are before date_min */
-        if (g_date_compare (date, date_min) < 0)
-            continue;
+    str_date_min = gsb_format_gdate (date_min);
+    str_date_max = gsb_format_gdate (date_max);
+    title = g_strdup_printf (_("Balance estimate of the partial balance \"%s\" from %s to %s"),
+							 gsb_data_partial_balance_get_name (partial_number),
+							 str_date_min, str_date_max);
+    g_free (str_date_min);
+    g_free (str_date_max);
+    g_date_free (date_min);
+    g_date_free (date_max);
 
-        str_date = gsb_format_gdate (date);
-        g_value_init (&date_value, G_TYPE_DATE);
-        g_value_set_boxed (&date_value, date);
+    dialog = gtk_dialog_new_with_buttons (title,
+										  GTK_WINDOW (grisbi_app_get_active_window (NULL)),
+										  GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+										  "gtk-close", GTK_RESPONSE_CLOSE,
+										  NULL);
+    g_free (title);
+    gtk_window_set_position (GTK_WINDOW (dialog), GTK_WIN_POS_CENTER_ON_PARENT);
+    gtk_window_set_default_size (GTK_WINDOW (dialog), 800, 500);
 
-        str_amount = bet_data_get_str_amount_in_account_currency (amount,
-																  account_number,
-                        										  transaction_number,
-                        										  SPP_ORIGIN_TRANSACTION);
+    content_area = gtk_dialog_get_content_area (GTK_DIALOG (dialog));
+    gtk_container_set_border_width (GTK_CONTAINER (content_area), BOX_BORDER_WIDTH);
 
-        currency_number = gsb_data_transaction_get_currency_number (transaction_number);
-        if (amount.mantissa < 0)
-            str_debit = utils_real_get_string_with_currency (gsb_real_abs (amount), currency_number, TRUE);
-        else
-            str_credit = utils_real_get_string_with_currency (amount, currency_number, TRUE);
+    tree_view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (tree_model));
+    g_object_unref (G_OBJECT (tree_model));
 
-        transfer_number = gsb_data_transaction_get_contra_transaction_number (transaction_number);
-        if (transfer_number > 0)
-        {
-            transfer_account_number = gsb_data_transaction_get_account_number (transfer_number);
-            str_description = g_strdup_printf (_("Transfer between account: %s\n"
-												 "and account: %s"),
-											   gsb_data_account_get_name (account_number),
-											   gsb_data_account_get_name (transfer_account_number));
-        }
-        else
-        {
-            str_description = bet_array_list_get_description (account_number,
-															  SPP_ORIGIN_TRANSACTION,
-															  GINT_TO_POINTER (transaction_number));
-        }
+    for (i = 0; i < BET_ARRAY_COLUMNS; i++)
+    {
+        GtkCellRenderer *cell;
+        GtkTreeViewColumn *column;
+
+        cell = gtk_cell_renderer_text_new ();
+        g_object_set (G_OBJECT (cell), "xalign", xalign[i], NULL);
+        column = gtk_tree_view_column_new_with_attributes (_(titles[i]), cell,
+                                                           "text", columns[i],
+                                                           "cell-background-rgba", SPP_ESTIMATE_TREE_BACKGROUND_COLOR,
+                                                           NULL);
+        if (columns[i] == SPP_ESTIMATE_TREE_BALANCE_COLUMN)
+            gtk_tree_view_column_add_attribute (column, cell, "foreground", SPP_ESTIMATE_TREE_BALANCE_COLOR);
+        gtk_tree_view_column_set_alignment (column, xalign[i]);
+        gtk_tree_view_column_set_resizable (column, TRUE);
+        gtk_tree_view_column_set_expand (column, columns[i] == SPP_ESTIMATE_TREE_DESC_COLUMN);
+        gtk_tree_view_append_column (GTK_TREE_VIEW (tree_view), column);
+    }
 
-        /* add a line in the estimate array */
-        gtk_tree_store_append (GTK_TREE_STORE (tab_model), &iter, NULL);
-        gtk_tree_store_set_value (GTK_TREE_STORE (tab_model),
-								  &iter,
-								  SPP_ESTIMATE_TREE_SORT_DATE_COLUMN, &date_value);
-        gtk_tree_store_set (GTK_TREE_STORE (tab_model),
-							&iter,
-                        	SPP_ESTIMATE_TREE_ORIGIN_DATA, SPP_ORIGIN_TRANSACTION,
-                        	SPP_ESTIMATE_TREE_DIVISION_COLUMN, transaction_number,
-                        	SPP_ESTIMATE_TREE_SUB_DIV_COLUMN, 0,
-                        	SPP_ESTIMATE_TREE_DATE_COLUMN, str_date,
-                        	SPP_ESTIMATE_TREE_DESC_COLUMN, str_description,
-                        	SPP_ESTIMATE_TREE_DEBIT_COLUMN, str_debit,
-                        	SPP_ESTIMATE_TREE_CREDIT_COLUMN, str_credit,
-                        	SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
-                        	-1);
+    scrolled_window = gtk_scrolled_window_new (NULL, NULL);
+    gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scrolled_window),
+                        GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+    gtk_container_add (GTK_CONTAINER (scrolled_window), tree_view);
+    gtk_box_pack_start (GTK_BOX (content_area), scrolled_window, TRUE, TRUE, 0);
 
-        g_value_unset (&date_value);
-        g_free (str_date);
-        g_free (str_amount);
-        g_free (str_description);
-        g_free (str_debit);
-        g_free (str_credit);
-    }
-	g_date_free (date_jour_1);
+    gtk_widget_show_all (dialog);
+    gtk_dialog_run (GTK_DIALOG (dialog));
+    gtk_widget_destroy (dialog);
 }
 
 /**
+ * show the menu of the partial balances which contain the current account
  *
- *
- * \param
- * \param
- * \param
+ * \param button
+ * \param null
  *
  * \return
  **/
-static gboolean bet_array_refresh_transfert_data (GtkTreeModel *tab_model,
-                        						  GDate *date_min,
-                        						  GDate *date_max)
+static void bet_array_list_partial_balance_menu (GtkWidget *button,
+												 gpointer null)
 {
-    GHashTable *transfert_list;
-    GHashTableIter iter;
-    gpointer key, value;
+    GtkWidget *menu;
+    GtkWidget *menu_item;
+    GSList *tmp_list;
     gint account_number;
+    gint nbre_items = 0;
 
-    /* devel_debug (NULL); */
     account_number = gsb_gui_navigation_get_current_account ();
-    transfert_list = bet_data_transfert_get_list ();
-	if (g_hash_table_size (transfert_list) == 0)
-		return FALSE;
+    menu = gtk_menu_new ();
 
-	g_hash_table_iter_init (&iter, transfert_list);
-    while (g_hash_table_iter_next (&iter, &key, &value))
+    tmp_list = gsb_data_partial_balance_get_list ();
+    while (tmp_list)
     {
-        GtkTreeIter tab_iter;
-		GDate *date_bascule;
-		GDate *date_debit;
-        GValue date_value = G_VALUE_INIT;
-        gchar *str_debit = NULL;
-        gchar *str_credit = NULL;
-        gchar *str_date;
-        gint currency_number;
-        gint replace_currency;
-        gchar *str_description;
-        gchar *str_amount;
-        GsbReal amount;
-        TransfertData *transfert = (TransfertData *) value;
-
-        if (account_number != transfert->account_number)
-            continue;
+        gint partial_number;
 
-		/* set date_bascule */
-		if (transfert->card_choice_bascule_day)
-			date_bascule = gsb_date_get_first_banking_day_after_date (transfert->date_bascule);
-		else
-			date_bascule = gsb_date_copy (transfert->date_bascule);
-
-		bet_data_transfert_update_date_if_necessary (transfert, date_bascule, FALSE);
-		g_date_free (date_bascule);
-
-		/* set date debit */
-		if (transfert->main_choice_debit_day == 2)
-			date_debit = gsb_date_get_first_banking_day_before_date (transfert->date_debit);
-		else
-			date_debit = gsb_date_copy (transfert->date_debit);
-
-		if (g_date_compare (transfert->date_debit, date_max) > 0)
-		{
-			g_date_free (date_debit);
-			continue;
-		}
-		if (g_date_compare (transfert->date_debit, date_min) < 0)
-		{
-			g_date_free (date_debit);
-			continue;
-		}
-
-        str_description = bet_array_list_get_description (transfert->replace_account,
-														  SPP_ORIGIN_ACCOUNT,
-														  value);
-
-        if (transfert->type == 0)
-        {
-            amount = gsb_data_account_get_current_balance (transfert->replace_account);
-            replace_currency = gsb_data_account_get_currency (transfert->replace_account);
-        }
-        else
-        {
-            amount = gsb_data_partial_balance_get_current_amount (transfert->replace_account);
-            replace_currency = gsb_data_partial_balance_get_currency (transfert->replace_account);
-        }
-
-        str_amount = bet_data_get_str_amount_in_account_currency (amount,
-                        account_number,
-                        replace_currency,
-                        SPP_ORIGIN_ACCOUNT);
-
-        currency_number = gsb_data_account_get_currency (transfert->replace_account);
-        if (amount.mantissa < 0)
-            str_debit = utils_real_get_string_with_currency (gsb_real_abs (amount), currency_number, TRUE);
-        else
-            str_credit = utils_real_get_string_with_currency (amount, currency_number, TRUE);
-
-        str_date = gsb_format_gdate (date_debit);
+        partial_number = gsb_data_partial_balance_get_number (tmp_list->data);
+        tmp_list = tmp_list->next;
 
-        g_value_init (&date_value, G_TYPE_DATE);
-        g_value_set_boxed (&date_value, date_debit);
+        if (!bet_array_partial_balance_has_account (partial_number, account_number))
+            continue;
 
-        /* add a line in the estimate array */
-        gtk_tree_store_append (GTK_TREE_STORE (tab_model), &tab_iter, NULL);
-        gtk_tree_store_set_value (GTK_TREE_STORE (tab_model), &tab_iter,
-                        SPP_ESTIMATE_TREE_SORT_DATE_COLUMN,
-                        &date_value);
-        gtk_tree_store_set (GTK_TREE_STORE (tab_model), &tab_iter,
-                        SPP_ESTIMATE_TREE_ORIGIN_DATA, SPP_ORIGIN_ACCOUNT,
-                        SPP_ESTIMATE_TREE_DIVISION_COLUMN, transfert->number,
-                        SPP_ESTIMATE_TREE_DATE_COLUMN, str_date,
-                        SPP_ESTIMATE_TREE_DESC_COLUMN, str_description,
-                        SPP_ESTIMATE_TREE_DEBIT_COLUMN, str_debit,
-                        SPP_ESTIMATE_TREE_CREDIT_COLUMN, str_credit,
-                        SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
-                        -1);
+        menu_item = gtk_menu_item_new_with_label (gsb_data_partial_balance_get_name (partial_number));
+        g_signal_connect (G_OBJECT (menu_item),
+						  "activate",
+						  G_CALLBACK (bet_array_show_partial_balance_estimate),
+						  GINT_TO_POINTER (partial_number));
+        gtk_menu_shell_append (GTK_MENU_SHELL (menu), menu_item);
+        nbre_items++;
+    }
 
-        g_value_unset (&date_value);
-		g_date_free (date_debit);
-        g_free (str_date);
-        g_free (str_description);
-        g_free (str_amount);
-        g_free (str_debit);
-        g_free (str_credit);
+    if (nbre_items == 0)
+    {
+        menu_item = gtk_menu_item_new_with_label (_("No partial balance contains this account"));
+        gtk_widget_set_sensitive (menu_item, FALSE);
+        gtk_menu_shell_append (GTK_MENU_SHELL (menu), menu_item);
     }
 
-    return FALSE;
+    gtk_widget_show_all (menu);
+	gtk_menu_popup_at_pointer (GTK_MENU (menu), NULL);
 }
 
 /**
@@ -2712,27 +2054,20 @@ static void bet_array_refresh_estimate_tab (gint account_number)
     GtkTreeIter iter;
     GtkTreeModel *tree_model;
     GtkTreePath *path = NULL;
-    const gchar *color_str = NULL;
     gchar *str_date_min;
     gchar *str_date_max;
-    gchar *str_current_balance;
-    gchar *str_amount;
     gchar *title;
-    gchar *tmp_str;
 	GDate *first_day_current_month;
     GDate *date_init;
     GDate *date_min;
     GDate *date_max;
     GsbReal current_balance;
-    BetRange *tmp_range;
-    GValue date_value = G_VALUE_INIT;
-    gint currency_number;
+    BetForecast *forecast;
+    guint i;
 
     devel_debug (NULL);
     account_page = grisbi_win_get_account_page ();
 
-    tmp_range = struct_initialise_bet_range ();
-
     /* calculate date_min, date_max and first_day_current_month with user choice */
     date_min = gsb_data_account_get_bet_start_date (account_number);
     date_max = bet_data_array_get_date_max (account_number);
@@ -2747,9 +2082,6 @@ static void bet_array_refresh_estimate_tab (gint account_number)
     date_init = gsb_date_copy (date_min);
     g_date_subtract_days (date_init, 1);
 
-    g_value_init (&date_value, G_TYPE_DATE);
-    g_value_set_boxed (&date_value, date_init);
-
     str_date_max = gsb_format_gdate (date_max);
 
     /* current balance may be in the future if there are transactions
@@ -2757,18 +2089,6 @@ static void bet_array_refresh_estimate_tab (gint account_number)
      * of today */
     current_balance = gsb_data_account_calculate_current_day_balance (account_number, date_min);
 
-    currency_number = gsb_data_account_get_currency (account_number);
-
-    str_amount = utils_real_get_string (current_balance);
-    str_current_balance = utils_real_get_string_with_currency (current_balance, currency_number, TRUE);
-
-    if (current_balance.mantissa < 0)
-        color_str = "red";
-    else
-    {
-        color_str = NULL;
-    }
-
     /* set the titles of tabs module budget */
     title = g_strdup_printf (_("Balance estimate of the account \"%s\" from %s to %s"),
 							 gsb_data_account_get_name (account_number),
@@ -2777,6 +2097,8 @@ static void bet_array_refresh_estimate_tab (gint account_number)
     widget = GTK_WIDGET (g_object_get_data (G_OBJECT (account_page), "bet_array_title"));
     gtk_label_set_label (GTK_LABEL (widget), title);
     g_free (title);
+    g_free (str_date_min);
+    g_free (str_date_max);
 
     tree_view = g_object_get_data (G_OBJECT (account_page), "bet_estimate_treeview");
     if (gtk_tree_selection_get_selected (gtk_tree_view_get_selection (GTK_TREE_VIEW (tree_view)),
@@ -2788,72 +2110,49 @@ static void bet_array_refresh_estimate_tab (gint account_number)
 	else
 		path = gtk_tree_path_new_first ();
 
-    /* clear the model */
-    gtk_tree_store_clear (GTK_TREE_STORE (tree_model));
-
-    tmp_str = g_strdup (_("balance beginning of period"));
-    gtk_tree_store_append (GTK_TREE_STORE (tree_model), &iter, NULL);
-    gtk_tree_store_set_value (GTK_TREE_STORE (tree_model),
-							  &iter,
-                        	  SPP_ESTIMATE_TREE_SORT_DATE_COLUMN, &date_value);
-    gtk_tree_store_set (GTK_TREE_STORE(tree_model),
-					    &iter,
-                        SPP_ESTIMATE_TREE_ORIGIN_DATA, SPP_ORIGIN_SOLDE,
-                        SPP_ESTIMATE_TREE_DATE_COLUMN, str_date_min,
-                        SPP_ESTIMATE_TREE_DESC_COLUMN, tmp_str,
-                        SPP_ESTIMATE_TREE_BALANCE_COLUMN, str_current_balance,
-                        SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
-                        SPP_ESTIMATE_TREE_BALANCE_COLOR, color_str,
-                        SPP_ESTIMATE_TREE_BACKGROUND_COLOR, gsb_rgba_get_couleur ("background_bet_solde"),
-                        -1);
-
-    g_value_unset (&date_value);
-    g_free (str_date_min);
-    g_free (str_date_max);
-    g_free (tmp_str);
-    g_free (str_current_balance);
-    g_free (str_amount);
+    /* calculate the forecast */
+    forecast = bet_forecast_new (account_number);
+    bet_forecast_add_event (forecast,
+                            date_init,
+                            SPP_ORIGIN_SOLDE,
+                            BET_FORECAST_BALANCE_START,
+                            0,
+                            current_balance);
 
     /* search data from the past */
-    bet_historical_refresh_data (tree_model, first_day_current_month, date_max);
+    bet_historical_refresh_data (forecast, first_day_current_month, date_max);
 
     /* search data from the futur */
-    bet_array_refresh_futur_data (tree_model, first_day_current_month, date_max);
+    bet_forecast_add_futures (forecast, first_day_current_month, date_max);
 
     /* search data from a transfer */
-    bet_array_refresh_transfert_data (tree_model, first_day_current_month, date_max);
+    bet_forecast_add_transferts (forecast, first_day_current_month, date_max);
 
     /* search transactions of the account which are in the period */
-    bet_array_refresh_transactions_data (tree_model,
-										 account_number,
-                        				 date_min,
-                        				 date_max);
+    bet_forecast_add_transactions (forecast, date_min, date_max);
 
     /* for each schedulded operation */
-    bet_array_refresh_scheduled_data (tree_model,
-									  account_number,
-                        			  date_min,
-                        			  date_max);
-
-    bet_array_list_replace_transactions_by_transfert (tree_model, account_number);
+    bet_forecast_add_scheduled (forecast, date_min, date_max);
 
     /* shows the balance at beginning of month */
-    bet_array_shows_balance_at_beginning_of_month (tree_model, date_min, date_max);
+    bet_forecast_add_balances_of_months (forecast, date_min, date_max);
+
+    bet_forecast_compute (forecast);
 
     g_date_free (date_min);
     g_date_free (date_init);
     g_date_free (date_max);
 	g_date_free (first_day_current_month);
 
-    /* Calculate the balance column */
-    tmp_range->first_pass = TRUE;
-    tmp_range->current_balance = current_balance;
+    /* fill the model */
+    gtk_tree_store_clear (GTK_TREE_STORE (tree_model));
+    for (i = 0; i < forecast->events->len; i++)
+        bet_array_list_append_event (tree_model,
+                                     forecast,
+                                     &g_array_index (forecast->events, BetForecastEvent, i));
 
-    gtk_tree_model_foreach (GTK_TREE_MODEL (tree_model),
-							bet_array_update_average_column,
-							tmp_range);
+    bet_forecast_free (forecast);
 
-	struct_free_bet_range (tmp_range);
     bet_array_list_set_background_color (tree_view);
     bet_array_list_select_path (tree_view, path);
     gtk_tree_path_free (path);
@@ -3229,40 +2528,31 @@ void bet_array_init_largeur_col_treeview (const gchar* description)
 }
 
 /**
- * Add a new line with historical data
+ * Add the lines of a historical data to the forecast
  *
- * \param
+ * \param forecast
+ * \param model of the historical data
+ * \param iter of the historical data
+ * \param date_min
+ * \param date_max
  *
  * \return
  **/
-void bet_array_list_add_new_hist_line (GtkTreeModel *tab_model,
+void bet_array_list_add_new_hist_line (BetForecast *forecast,
                         GtkTreeModel *model,
                         GtkTreeIter *iter,
                         GDate *date_min,
                         GDate *date_max)
 {
-    GtkTreeIter tab_iter;
-    GDate *date, *date_tmp;
-    GDate *date_jour;
-    GValue date_value = G_VALUE_INIT;
-    gchar *str_date;
     gchar *str_description;
-    gchar *str_value;
-    gchar *str_debit = NULL;
-    gchar *str_credit = NULL;
     gchar *str_amount;
     gint div_number;
     gint sub_div_nb;
-    GsbReal amount;
 
     /* devel_debug (NULL); */
-    date_jour = gdate_today ();
-    date = gsb_date_get_last_day_of_month (date_min);
-
     /* initialise les données de la ligne insérée */
     gtk_tree_model_get (GTK_TREE_MODEL (model), iter,
                         SPP_HISTORICAL_DESC_COLUMN, &str_description,
-                        SPP_HISTORICAL_RETAINED_COLUMN, &str_value,
                         SPP_HISTORICAL_RETAINED_AMOUNT, &str_amount,
                         SPP_HISTORICAL_DIV_NUMBER, &div_number,
                         SPP_HISTORICAL_SUB_DIV_NUMBER, &sub_div_nb,
@@ -3274,69 +2564,15 @@ void bet_array_list_add_new_hist_line (GtkTreeModel *tab_model,
         str_description = bet_data_get_div_name (div_number, sub_div_nb, NULL);
     }
 
-    amount = utils_real_get_from_string (str_amount);
-
-    if (amount.mantissa < 0)
-        str_debit = utils_real_get_string_with_currency (gsb_real_opposite (amount),
-                        bet_data_get_selected_currency (), TRUE);
-    else
-        str_credit = str_value;
-
-    while (date != NULL && g_date_valid (date))
-    {
-        if (g_date_compare (date, date_max) > 0)
-            break;
-
-        if (g_date_compare (date, date_min) < 0
-         ||
-         (g_date_get_year (date) == g_date_get_year (date_jour)
-         &&
-         g_date_get_month (date) < g_date_get_month (date_jour)))
-        {
-            g_date_add_months (date, 1);
-            continue;
-        }
-
-        if (g_date_valid (date) == FALSE)
-            return;
-
-        str_date = gsb_format_gdate (date);
-
-        g_value_init (&date_value, G_TYPE_DATE);
-        g_value_set_boxed (&date_value, date);
-
-        /* add a line in the estimate array */
-        gtk_tree_store_append (GTK_TREE_STORE (tab_model), &tab_iter, NULL);
-        gtk_tree_store_set_value (GTK_TREE_STORE (tab_model), &tab_iter,
-                        SPP_ESTIMATE_TREE_SORT_DATE_COLUMN,
-                        &date_value);
-        gtk_tree_store_set (GTK_TREE_STORE (tab_model), &tab_iter,
-                        SPP_ESTIMATE_TREE_ORIGIN_DATA, SPP_ORIGIN_HISTORICAL,
-                        SPP_ESTIMATE_TREE_DIVISION_COLUMN, div_number,
-                        SPP_ESTIMATE_TREE_SUB_DIV_COLUMN, sub_div_nb,
-                        SPP_ESTIMATE_TREE_DATE_COLUMN, str_date,
-                        SPP_ESTIMATE_TREE_DESC_COLUMN, str_description,
-                        SPP_ESTIMATE_TREE_DEBIT_COLUMN, str_debit,
-                        SPP_ESTIMATE_TREE_CREDIT_COLUMN, str_credit,
-                        SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
-                        -1);
+    bet_forecast_add_historical (forecast,
+                                 date_min,
+                                 date_max,
+                                 div_number,
+                                 sub_div_nb,
+                                 utils_real_get_from_string (str_amount),
+                                 str_description);
 
-        g_value_unset (&date_value);
-        g_free (str_date);
-        g_date_add_months (date, 1);
-
-        date_tmp = date;
-        date = gsb_date_get_last_day_of_month (date_tmp);
-        g_date_free (date_tmp);
-    }
-
-    if (date)
-        g_date_free (date);
-    if (date_jour)
-        g_date_free (date_jour);
     g_free (str_description);
-    g_free (str_debit);
-    g_free (str_value);
     g_free (str_amount);
 }
 
@@ -24,6 +24,7 @@
 
 /* START_INCLUDE_H */
 #include "bet_data.h"
+#include "bet_forecast.h"
 /* END_INCLUDE_H */
 
 /* START_DECLARATION */
@@ -31,7 +32,7 @@ GtkWidget *	bet_array_create_page (void);
 void 		bet_array_create_transaction_from_transfert 	(TransfertData *transfert);
 gchar *		bet_array_get_largeur_col_treeview_to_string	(void);
 void		bet_array_init_largeur_col_treeview				(const gchar* description);
-void 		bet_array_list_add_new_hist_line 				(GtkTreeModel *tab_model,
+void 		bet_array_list_add_new_hist_line 				(BetForecast *forecast,
 															 GtkTreeModel *model,
 															 GtkTreeIter *iter,
 															 GDate *date_min,
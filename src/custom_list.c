@@ -40,6 +40,7 @@
 /*START_INCLUDE*/
 #include "custom_list.h"
 #include "gsb_data_transaction.h"
+#include "gsb_transactions_list.h"
 #include "transaction_list.h"
 #include "transaction_model.h"
 #include "erreur.h"
@@ -47,6 +48,8 @@
 
 /*START_STATIC*/
 static void custom_list_finalize (GObject *object);
+static void custom_list_free_cached_cells (CustomList *custom_list,
+					   CustomRecord *record);
 static GType custom_list_get_column_type (GtkTreeModel *tree_model,
 					  gint          index);
 static GtkTreeModelFlags custom_list_get_flags (GtkTreeModel *tree_model);
@@ -228,6 +231,8 @@ static void custom_list_init (CustomList *custom_list)
     custom_list->sort_order = GTK_SORT_ASCENDING;
 
     custom_list->stamp = g_random_int();  /* Random int to check whether an iter belongs to our model */
+
+    custom_list->cells_cache = g_queue_new ();
 }
 
 
@@ -282,6 +287,9 @@ void custom_list_finalize (GObject *object)
     }
     g_free (custom_list -> rows);
     g_free (custom_list -> visibles_rows);
+    g_queue_free (custom_list -> cells_cache);
+    if (custom_list -> account_rows)
+	g_hash_table_destroy (custom_list -> account_rows);
 
     /* must chain up - finalize parent */
     G_OBJECT_CLASS(custom_list_parent_class)->finalize (object);
@@ -483,7 +491,7 @@ static void custom_list_get_value (GtkTreeModel *tree_model,
 	case CUSTOM_MODEL_COL_4:
 	case CUSTOM_MODEL_COL_5:
 	case CUSTOM_MODEL_COL_6:
-	    g_value_set_string(value, record->visible_col[column]);
+	    g_value_set_string(value, custom_list_get_cell_text (CUSTOM_LIST (tree_model), record, column));
 	    break;
 	case CUSTOM_MODEL_BACKGROUND:
 	    g_value_set_boxed(value, (gpointer) record->row_bg);
@@ -526,6 +534,156 @@ static void custom_list_get_value (GtkTreeModel *tree_model,
     }
 }
 
+/**
+ * free the cells of the record which were rendered on demand
+ * and remove the record from the cells cache
+ *
+ * \param custom_list
+ * \param record
+ *
+ * \return
+ * */
+static void custom_list_free_cached_cells (CustomList *custom_list,
+					   CustomRecord *record)
+{
+    gint column;
+
+    for (column = 0 ; column < CUSTOM_MODEL_VISIBLE_COLUMNS ; column++)
+    {
+	if (record -> cells_cached & (1 << column))
+	{
+	    g_free (record -> visible_col[column]);
+	    record -> visible_col[column] = NULL;
+	}
+    }
+    record -> cells_filled &= ~record -> cells_cached;
+    record -> cells_cached = 0;
+
+    custom_list_forget_record (custom_list, record);
+}
+
+
+/**
+ * return the text of a visible column of the record
+ * if the record is filled on demand and the cell is not up to date,
+ * the text is made now and the record is set as the most recently used
+ * of the cells cache ; when the cache is full, the cells of the least
+ * recently used record are freed
+ *
+ * the returned string belongs to the record, it mustn't be freed
+ * and it can be freed the next time this function is called
+ *
+ * \param custom_list
+ * \param record
+ * \param column	0 to CUSTOM_MODEL_VISIBLE_COLUMNS
+ *
+ * \return the text of the cell, can be NULL
+ * */
+const gchar *custom_list_get_cell_text (CustomList *custom_list,
+					CustomRecord *record,
+					gint column)
+{
+    gint element_number;
+    gint transaction_number;
+
+    if (!record -> lazy_cells
+	||
+	record -> cells_filled & (1 << column))
+	return record -> visible_col[column];
+
+    element_number = gsb_transactions_list_get_element_tab_affichage_ope (record -> line_in_transaction,
+									    column);
+    transaction_number = gsb_data_transaction_get_transaction_number (record -> transaction_pointer);
+
+    g_free (record -> visible_col[column]);
+    record -> visible_col[column] = gsb_transactions_list_grep_cell_content (transaction_number,
+									      element_number);
+    record -> cells_filled |= 1 << column;
+    record -> cells_cached |= 1 << column;
+
+    /* the record becomes the most recently used */
+    if (record -> cache_link)
+    {
+	g_queue_unlink (custom_list -> cells_cache, record -> cache_link);
+	g_queue_push_tail_link (custom_list -> cells_cache, record -> cache_link);
+    }
+    else
+    {
+	g_queue_push_tail (custom_list -> cells_cache, record);
+	record -> cache_link = custom_list -> cells_cache -> tail;
+    }
+
+    if (g_queue_get_length (custom_list -> cells_cache) > CUSTOM_LIST_CELLS_CACHE_SIZE)
+	custom_list_free_cached_cells (custom_list,
+				       g_queue_peek_head (custom_list -> cells_cache));
+
+    return record -> visible_col[column];
+}
+
+
+/**
+ * set the text of a visible column of the record
+ * that text is kept until it is changed or invalidated, the cells cache
+ * never frees it
+ *
+ * \param record
+ * \param column	0 to CUSTOM_MODEL_VISIBLE_COLUMNS
+ * \param text		a newly allocated string or NULL, will belong to the record
+ *
+ * \return
+ * */
+void custom_list_set_cell_text (CustomRecord *record,
+				gint column,
+				gchar *text)
+{
+    if (record -> visible_col[column] != text)
+	g_free (record -> visible_col[column]);
+
+    record -> visible_col[column] = text;
+    record -> cells_filled |= 1 << column;
+    record -> cells_cached &= ~(1 << column);
+}
+
+
+/**
+ * free the text of a visible column of the record,
+ * it will be made again the next time the view asks for it
+ *
+ * \param record
+ * \param column	0 to CUSTOM_MODEL_VISIBLE_COLUMNS
+ *
+ * \return
+ * */
+void custom_list_invalidate_cell (CustomRecord *record,
+				  gint column)
+{
+    g_free (record -> visible_col[column]);
+    record -> visible_col[column] = NULL;
+    record -> cells_filled &= ~(1 << column);
+    record -> cells_cached &= ~(1 << column);
+}
+
+
+/**
+ * remove the record from the cells cache,
+ * must be called before freeing a record
+ *
+ * \param custom_list
+ * \param record
+ *
+ * \return
+ * */
+void custom_list_forget_record (CustomList *custom_list,
+				CustomRecord *record)
+{
+    if (!record -> cache_link)
+	return;
+
+    g_queue_delete_link (custom_list -> cells_cache, record -> cache_link);
+    record -> cache_link = NULL;
+}
+
+
 /**
  * Sets the data in the cell specified by iter and column.
  * The type of value must be convertible to the type of the column.
@@ -569,7 +727,7 @@ void custom_list_set_value (GtkTreeModel *tree_model,
 	case CUSTOM_MODEL_COL_4:
 	case CUSTOM_MODEL_COL_5:
 	case CUSTOM_MODEL_COL_6:
-	    record -> visible_col[column] = g_value_dup_string(value);
+	    custom_list_set_cell_text (record, column, g_value_dup_string(value));
 	    break;
 	case CUSTOM_MODEL_BACKGROUND:
 	    record -> row_bg = g_value_get_boxed(value);
@@ -16,6 +16,9 @@
 #define IS_TRANSACTION 0
 #define IS_ARCHIVE 1
 
+/* max number of records which keep the cells rendered on demand */
+#define CUSTOM_LIST_CELLS_CACHE_SIZE 4096
+
 
 typedef struct _CustomRecord     CustomRecord;
 typedef struct _CustomList       CustomList;
@@ -27,6 +30,15 @@ struct _CustomRecord
     /* first the 7 visibles columns */
     gchar *visible_col[7];
 
+    /* if lazy_cells is TRUE, the visibles columns are filled only when
+     * the view asks for them (see custom_list_get_cell_text)
+     * cells_filled contains a bit for each column up to date in visible_col,
+     * cells_cached a bit for each column which can be freed by the cache */
+    gboolean lazy_cells;
+    guint cells_filled;
+    guint cells_cached;
+    GList *cache_link;			/* link of the record in the cells cache of the model */
+
     GdkRGBA *row_bg;			/* bg color */
     GdkRGBA *row_bg_save;		/* save bg */
     gchar *amount_color;		/* amout color */
@@ -34,6 +46,7 @@ struct _CustomRecord
 
     gpointer transaction_pointer;	/* transaction struct address */
     gint what_is_line;			/* IS_TRANSACTION /IS_ARCHIVE */
+    gint account_number;		/* account of the row when it was set in the account rows, -1 for the white line */
     gchar *font;			/* font */
     gint line_in_transaction;		/* line in transaction (0,1, 2 or 3) */
     gboolean line_visible;		/* is line visible (TRUE/FALSE, this value shouldn't be changed by gsb_list_model_set */
@@ -117,6 +130,16 @@ struct _CustomList
     gboolean		user_sort_reconcile;	/* TRUE when the sorting function is the user defined for reconciliation */
 
     gint		stamp;			/* Random integer to check whether an iter belongs to our model */
+
+    /* the mother rows of each account, in the order of the rows array,
+     * key is the account number, value a GPtrArray of CustomRecord,
+     * so filtering an account checks only its rows
+     * NULL if not made yet */
+    GHashTable	*account_rows;
+
+    /* the records which have some cells rendered on demand,
+     * the least recently used first */
+    GQueue		*cells_cache;
 };
 
 
@@ -132,11 +155,21 @@ struct _CustomListClass
 /* END_INCLUDE_H */
 
 /* START_DECLARATION */
-GType 			custom_list_get_type 	(void);
-CustomList *	custom_list_new 		(void);
-void 			custom_list_set_value 	(GtkTreeModel *tree_model,
-										 GtkTreeIter  *iter,
-										 gint          column,
-										 GValue       *value);
+void			custom_list_forget_record		(CustomList *custom_list,
+												 CustomRecord *record);
+const gchar *	custom_list_get_cell_text		(CustomList *custom_list,
+												 CustomRecord *record,
+												 gint column);
+GType 			custom_list_get_type 			(void);
+void			custom_list_invalidate_cell		(CustomRecord *record,
+												 gint column);
+CustomList *	custom_list_new 				(void);
+void			custom_list_set_cell_text		(CustomRecord *record,
+												 gint column,
+												 gchar *text);
+void 			custom_list_set_value 			(GtkTreeModel *tree_model,
+												 GtkTreeIter  *iter,
+												 gint          column,
+												 GValue       *value);
 /* END_DECLARATION */
 #endif
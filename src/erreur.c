@@ -222,7 +222,7 @@ void debug_traitement_sigsegv ( gint signal_nb )
 
 		grisbi_win_status_bar_message ( _("Save file") );
 
-		gsb_file_save_save_file (nom_fichier_comptes, FALSE, 0);
+		gsb_file_save_save_file (nom_fichier_comptes, FALSE, 0, NULL);
 
 		grisbi_win_status_bar_clear();
 
@@ -34,10 +34,12 @@
 #include "etats_calculs.h"
 #include "etats_affiche.h"
 #include "etats_config.h"
+#include "etats_gtktable.h"
 #include "grisbi_app.h"
 #include "gsb_data_account.h"
 #include "gsb_data_budget.h"
 #include "gsb_data_category.h"
+#include "gsb_data_currency.h"
 #include "gsb_data_fyear.h"
 #include "gsb_data_payee.h"
 #include "gsb_data_payment.h"
@@ -46,14 +48,237 @@
 #include "gsb_data_report.h"
 #include "gsb_data_report_text_comparison.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file_save.h"
 #include "navigation.h"
 #include "gsb_real.h"
+#include "gsb_trace.h"
 #include "utils_dates.h"
 #include "utils_str.h"
 #include "structures.h"
 #include "erreur.h"
 /*END_INCLUDE*/
 
+/* nombre de champs utilisables dans les tests de texte */
+#define ETATS_TEXT_FIELDS 11
+
+/* champs copiés en plus des champs de texte pour le classement des opés */
+#define ETATS_FIELD_CATEG_FULL	11			/* catégorie : sous-catégorie */
+#define ETATS_FIELD_ACCOUNT		12			/* nom du compte */
+#define ETATS_FIELD_CONTRA		13			/* nom du compte de contrepartie d'un virement */
+#define ETATS_FIELD_PAYMENT		14			/* nom du moyen de paiement */
+#define ETATS_FIELDS			15
+
+/* nombre maximum de parties, donc de threads, pour le calcul d'un état */
+#define ETATS_MAX_PARTS			8
+
+/* fonction qui renvoie le texte d'un champ de l'opé pour les tests de texte */
+typedef const gchar *(*EtatsTextAccessor) (gint transaction_number);
+
+/* fonction appelée dans le thread principal pendant le calcul, fraction entre 0 et 1 */
+typedef void (*EtatsCalculProgress) (gdouble fraction,
+									 gpointer data);
+
+/* ligne de test de texte compilée */
+typedef struct _EtatsTextFilter	EtatsTextFilter;
+
+struct _EtatsTextFilter
+{
+	gint		link_to_last;
+	gint		field;
+	gboolean	use_number;			/* TRUE si on compare le no de chq, de pc ou de rappr */
+
+	/* test sur le texte */
+	gint		text_operator;
+	const gchar *text;
+	gsize		text_len;
+
+	/* test sur le no */
+	gint		link_first_to_second;
+	gint		first_comparison;
+	gint		first_number;
+	gint		second_comparison;
+	gint		second_number;
+};
+
+/* ligne de test de montant compilée */
+typedef struct _EtatsAmountFilter	EtatsAmountFilter;
+
+struct _EtatsAmountFilter
+{
+	gint		link_to_last;
+	gint		link_first_to_second;
+	gint		first_comparison;
+	GsbReal		first_amount;
+	gint		second_comparison;
+	GsbReal		second_amount;
+};
+
+/* sélection compilée des opérations d'un état, construite une fois par calcul */
+typedef struct _EtatsSelection	EtatsSelection;
+
+struct _EtatsSelection
+{
+	gint		report_number;
+	gint		ignore_archives;
+
+	/* comptes de l'état : numéro de compte -> GPtrArray des opés candidates */
+	GHashTable *accounts;
+	gboolean	search_last_numbers;	/* TRUE si "le plus grand" est utilisé */
+
+	/* opés ventilées et filles */
+	gboolean	reject_split;
+	gboolean	reject_children;
+
+	/* tests de texte et de montant compilés : NULL si non utilisés */
+	GArray	   *text_filters;
+	GArray	   *amount_filters;
+	GHashTable *div_names[5];			/* noms de catégorie et d'IB pour les tests de texte et le classement */
+	gboolean	only_non_null;
+
+	/* R, P, T : TRUE si l'état de pointage est accepté */
+	gboolean	marked_accepted[4];
+
+	/* virements */
+	gint		transfer_choice;
+	gboolean	reject_non_transfer;
+	GHashTable *report_accounts;		/* NULL si tous les comptes sont utilisés */
+	GHashTable *transfer_accounts;
+
+	/* catégories, IB, tiers, moyens de paiement : NULL si non utilisés */
+	GHashTable *categories;
+	GHashTable *budgets;
+	GHashTable *payees;
+	GHashTable *payment_names;
+	GHashTable *payment_cache;
+
+	/* exercices */
+	gboolean	use_financial_year;
+	gint		financial_year_type;
+	gint		no_exercice_recherche;
+	GHashTable *financial_years;
+
+	/* plage de dates en jours juliens, 0 si pas de borne */
+	gboolean	use_dates;
+	gboolean	use_value_date;
+	gboolean	reject_all;
+	guint32		first_julian;
+	guint32		last_julian;
+};
+
+/* copie d'une opé candidate, faite dans le thread principal et seulement lue par les threads */
+typedef struct _EtatsCalculOpe	EtatsCalculOpe;
+
+struct _EtatsCalculOpe
+{
+	gpointer	transaction;			/* l'opé elle-même, n'est pas lue par les threads */
+	gint		transaction_number;
+	gint		account_number;
+	gint		party_number;
+	gint		category_number;
+	gint		sub_category_number;
+	gint		budgetary_number;
+	gint		sub_budgetary_number;
+	gint		contra_number;
+	gint		contra_account_number;
+	gint		contra_account_kind;
+	gint		payment_number;
+	gint		reconcile_number;
+	gint		financial_year_number;
+	gint		marked;
+
+	gboolean	is_split;
+	gboolean	is_child;
+	gboolean	payment_accepted;		/* le moyen de paiement fait partie de l'état */
+	gboolean	category_is_debit;		/* la catégorie est une catégorie de dépense */
+
+	/* dates en jours juliens, 0 si pas de date */
+	guint32		julian;
+	guint32		value_julian;
+
+	/* montant de l'opé et montant dans la devise du compte */
+	GsbReal		amount;
+	GsbReal		account_amount;
+
+	/* montants dans les devises de l'état, calculés seulement pour les opés sélectionnées */
+	GsbReal		categ_amount;
+	GsbReal		ib_amount;
+	GsbReal		payee_amount;
+	GsbReal		general_amount;
+};
+
+/* calcul d'un état : sélection et classement des opés, avant leur mise en page */
+typedef struct _EtatsCalcul	EtatsCalcul;
+
+/* partie de la copie des opés, calculée par un thread */
+typedef struct _EtatsCalculPart	EtatsCalculPart;
+
+struct _EtatsCalculPart
+{
+	EtatsCalcul *calcul;
+	guint		first;					/* première opé de la partie */
+	guint		last;					/* opé qui suit la dernière opé de la partie */
+
+	/* résultat de la partie */
+	GSList	   *selected;				/* opés sélectionnées, dans l'ordre de la copie */
+	GSList	   *liste_ope[2];			/* revenus (ou toutes les opés) et dépenses classés */
+	GsbReal		total_partie[2];
+	GsbReal		total_general;
+};
+
+struct _EtatsCalcul
+{
+	gint			report_number;
+	EtatsSelection *selection;
+
+	/* copie des opés candidates */
+	EtatsCalculOpe *opes;
+	guint			nbre_candidates;
+	guint			fields_used;			/* champs de texte à copier, 1 bit par champ */
+	const gchar	  **fields[ETATS_FIELDS];	/* textes des opés, NULL si le champ n'est pas copié */
+	GStringChunk   *strings;
+
+	/* paramètres de l'état lus avant le calcul */
+	gint		   *sorting_types;
+	guint			nbre_sorting_types;
+	gint			sorting_report;
+	gboolean		category_used;
+	gboolean		sub_category_used;
+	gboolean		budget_used;
+	gboolean		sub_budget_used;
+	gboolean		group_reports;
+	gboolean		payee_used;
+	gboolean		account_show_amount;
+	gboolean		split_credit_debit;
+	gboolean		split_by_category;		/* le classement racine est la catégorie */
+	gboolean		partie_in_categ_currency;
+	gint			devise_categ;
+	gint			devise_ib;
+	gint			devise_tiers;
+	gint			devise_generale;
+	gint			exponent_categ;			/* nombre de décimales des devises pour les totaux */
+	gint			exponent_generale;
+
+	/* parties de la copie et suivi des threads */
+	EtatsCalculPart parts[ETATS_MAX_PARTS];
+	guint			nbre_parts;
+	void			(*part_func) (EtatsCalculPart *part);
+	gint			nbre_running;
+	GCancellable   *cancellable;
+	EtatsCalculProgress progress_func;
+	gpointer		progress_data;
+	gint			progress_done;			/* opés traitées dans l'étape en cours, mis à jour par les threads */
+	guint			progress_total;
+	gdouble			progress_start;
+	gdouble			progress_span;
+
+	/* résultat du calcul */
+	guint			nbre_opes;
+	GSList		   *liste_ope_revenus;
+	GSList		   *liste_ope_depenses;
+	GsbReal			total_partie[2];
+	GsbReal			total_general;
+};
+
 /*START_STATIC*/
 static gint dernier_chq;     	/* quand on a choisi le plus grand, contient le dernier no de chq dans les comptes choisis */
 static gint dernier_pc;     	/* quand on a choisi le plus grand, contient le dernier no de pc dans les comptes choisis */
@@ -172,256 +397,202 @@ static gint etats_dialog_warning_report_too_big (gint report_number,
     return result;
 }
 
+/**
+ * renvoie le texte copié d'un champ d'une opé
+ *
+ * \param calcul
+ * \param ope
+ * \param field
+ *
+ * \return le texte, NULL si l'opé n'a pas ce texte ou si le champ n'a pas été copié
+ **/
+static const gchar *etats_calculs_ope_get_text (EtatsCalcul *calcul,
+											   const EtatsCalculOpe *ope,
+											   gint field)
+{
+	if (!calcul->fields[field])
+		return NULL;
+
+	return calcul->fields[field][ope - calcul->opes];
+}
+
+/**
+ * compare 2 dates en jours juliens
+ *
+ * \param julian_1
+ * \param julian_2
+ *
+ * \return
+ **/
+static gint etats_calculs_compare_julians (guint32 julian_1,
+										   guint32 julian_2)
+{
+	return (julian_1 > julian_2) - (julian_1 < julian_2);
+}
+
 /**
  * cette fonction est appelée quand l'opé a été classé dans sa categ, ib, compte ou tiers
  * et qu'elle doit être affichée ; on classe en fonction de la demande de la conf (date, no, tiers ...)
  * si les 2 opés sont équivalentes à ce niveau, on classe par no d'opé
+ * ne lit que la copie des opés, peut être appelée dans un thread
  *
- * \param
- * \param
+ * \param ope_1
+ * \param ope_2
+ * \param calcul
  *
  * \return
  **/
-static gint classement_ope_perso_etat (gpointer transaction_1,
-									   gpointer transaction_2)
+static gint classement_ope_perso_etat (const EtatsCalculOpe *ope_1,
+									   const EtatsCalculOpe *ope_2,
+									   EtatsCalcul *calcul)
 {
     gint return_value;
-    gint current_report_number;
-    gint transaction_number_1;
-    gint transaction_number_2;
 
-    transaction_number_1 = gsb_data_transaction_get_transaction_number (transaction_1);
-    transaction_number_2 = gsb_data_transaction_get_transaction_number (transaction_2);
-
-    current_report_number = gsb_gui_navigation_get_current_report ();
-
-    switch (gsb_data_report_get_sorting_report (current_report_number))
+    switch (calcul->sorting_report)
     {
 		case 0:
 			/* date  */
-			return_value = g_date_compare (gsb_data_transaction_get_date (transaction_number_1),
-										   gsb_data_transaction_get_date (transaction_number_2));
+			return_value = etats_calculs_compare_julians (ope_1->julian, ope_2->julian);
 			break;
 
 		case 1:
 			/* value date  */
-			if (gsb_data_transaction_get_value_date (transaction_number_1))
+			if (ope_1->value_julian)
 			{
-				if (gsb_data_transaction_get_value_date (transaction_number_2))
-					return_value = g_date_compare (gsb_data_transaction_get_value_date (transaction_number_1),
-												   gsb_data_transaction_get_value_date (transaction_number_2));
+				if (ope_2->value_julian)
+					return_value = etats_calculs_compare_julians (ope_1->value_julian, ope_2->value_julian);
 				else
 					return_value = -1;
 			}
 			else
 			{
-				if (gsb_data_transaction_get_value_date (transaction_number_2))
+				if (ope_2->value_julian)
 					return_value = 1;
 				else
-					return_value = g_date_compare (gsb_data_transaction_get_date (transaction_number_1),
-												   gsb_data_transaction_get_date (transaction_number_2));
+					return_value = etats_calculs_compare_julians (ope_1->julian, ope_2->julian);
 			}
 
 			break;
 		case 2:
 			/* no opé  */
-			return_value = transaction_number_1 - transaction_number_2;
+			return_value = ope_1->transaction_number - ope_2->transaction_number;
 			break;
 
 		case 3:
 			/* tiers  */
-			if (!gsb_data_transaction_get_party_number (transaction_number_1)
-				|| !gsb_data_transaction_get_party_number (transaction_number_2))
-				return_value = gsb_data_transaction_get_party_number (transaction_number_2) -
-								gsb_data_transaction_get_party_number (transaction_number_1);
+			if (!ope_1->party_number || !ope_2->party_number)
+				return_value = ope_2->party_number - ope_1->party_number;
 			else
-				return_value = my_strcasecmp (gsb_data_payee_get_name (gsb_data_transaction_get_party_number
-																	   (transaction_number_1), TRUE),
-											  gsb_data_payee_get_name (gsb_data_transaction_get_party_number
-																	   (transaction_number_2), TRUE));
+				return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, 0),
+											  etats_calculs_ope_get_text (calcul, ope_2, 0));
 			break;
 
 		case 4:
 			/* categ  */
-			if (!gsb_data_transaction_get_category_number (transaction_number_1)
-				|| !gsb_data_transaction_get_category_number (transaction_number_2))
-				return_value = gsb_data_transaction_get_category_number (transaction_number_2) -
-								gsb_data_transaction_get_category_number (transaction_number_1);
-			else
-			{
-				if (gsb_data_transaction_get_category_number (transaction_number_1) ==
-					gsb_data_transaction_get_category_number (transaction_number_2)
-					&&
-					(!gsb_data_transaction_get_sub_category_number (transaction_number_1)
-					 || !gsb_data_transaction_get_sub_category_number (transaction_number_2)))
-					return_value = gsb_data_transaction_get_sub_category_number (transaction_number_2)-
-										gsb_data_transaction_get_sub_category_number (transaction_number_1);
+			if (!ope_1->category_number || !ope_2->category_number)
+				return_value = ope_2->category_number - ope_1->category_number;
+			else if (ope_1->category_number == ope_2->category_number
+					 && (!ope_1->sub_category_number || !ope_2->sub_category_number))
+				return_value = ope_2->sub_category_number - ope_1->sub_category_number;
 			else
-				return_value = my_strcasecmp (gsb_data_category_get_name (gsb_data_transaction_get_category_number
-																		  (transaction_number_1),
-																		  gsb_data_transaction_get_sub_category_number
-																		  (transaction_number_1),
-																		  NULL),
-											  gsb_data_category_get_name (gsb_data_transaction_get_category_number
-																		  (transaction_number_2),
-																		  gsb_data_transaction_get_sub_category_number
-																		  (transaction_number_2),
-																		  NULL));
-			}
+				return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, ETATS_FIELD_CATEG_FULL),
+											  etats_calculs_ope_get_text (calcul, ope_2, ETATS_FIELD_CATEG_FULL));
 			break;
 
 		case 5:
 			/* ib  */
-			if (!gsb_data_transaction_get_budgetary_number (transaction_number_1)
-				|| !gsb_data_transaction_get_budgetary_number (transaction_number_2))
-				return_value = gsb_data_transaction_get_budgetary_number (transaction_number_2) -
-								gsb_data_transaction_get_budgetary_number (transaction_number_1);
-			else
-			{
-				if (gsb_data_transaction_get_budgetary_number (transaction_number_1) ==
-					gsb_data_transaction_get_budgetary_number (transaction_number_2)
-					&& (!gsb_data_transaction_get_sub_budgetary_number (transaction_number_1)
-						|| !gsb_data_transaction_get_sub_budgetary_number (transaction_number_2)))
-					return_value = gsb_data_transaction_get_sub_budgetary_number (transaction_number_2) -
-										gsb_data_transaction_get_sub_budgetary_number (transaction_number_1);
+			if (!ope_1->budgetary_number || !ope_2->budgetary_number)
+				return_value = ope_2->budgetary_number - ope_1->budgetary_number;
+			else if (ope_1->budgetary_number == ope_2->budgetary_number
+					 && (!ope_1->sub_budgetary_number || !ope_2->sub_budgetary_number))
+				return_value = ope_2->sub_budgetary_number - ope_1->sub_budgetary_number;
 			else
-				return_value = my_strcasecmp (gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number
-																		(transaction_number_1),
-																		gsb_data_transaction_get_sub_budgetary_number
-																		(transaction_number_1),
-																		NULL),
-											  gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number
-																		(transaction_number_2),
-																		gsb_data_transaction_get_sub_budgetary_number
-																		(transaction_number_2),
-																		NULL));
-			}
+				return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, 5),
+											  etats_calculs_ope_get_text (calcul, ope_2, 5));
 			break;
 
 		case 6:
 			/* note si une des 2 opés n'a pas de notes, elle va en 2ème */
-			if (gsb_data_transaction_get_notes (transaction_number_1)
-				&& gsb_data_transaction_get_notes (transaction_number_2))
-			return_value = my_strcasecmp (gsb_data_transaction_get_notes (transaction_number_1),
-										  gsb_data_transaction_get_notes (transaction_number_2));
-			else
-				return_value = GPOINTER_TO_INT (gsb_data_transaction_get_notes (transaction_number_2)) -
-								GPOINTER_TO_INT (gsb_data_transaction_get_notes (transaction_number_1));
+			return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, 6),
+										  etats_calculs_ope_get_text (calcul, ope_2, 6));
 			break;
 
 		case 7:
 			/* type ope  */
-			if (!gsb_data_transaction_get_method_of_payment_number (transaction_number_1)
-				|| !gsb_data_transaction_get_method_of_payment_number (transaction_number_2))
-				return_value = gsb_data_transaction_get_method_of_payment_number (transaction_number_2) -
-								gsb_data_transaction_get_method_of_payment_number (transaction_number_1);
+			/* les opés peuvent provenir de 2 comptes différents, on compare les noms des 2 types */
+			if (!ope_1->payment_number || !ope_2->payment_number)
+				return_value = ope_2->payment_number - ope_1->payment_number;
 			else
-			{
-				/* les opés peuvent provenir de 2 comptes différents, il faut donc trouver les 2 types dans les */
-				/* listes différentes */
-				return_value = my_strcasecmp (gsb_data_payment_get_name (gsb_data_transaction_get_method_of_payment_number
-																		 (transaction_number_1)),
-											  gsb_data_payment_get_name (gsb_data_transaction_get_method_of_payment_number
-																		 (transaction_number_2)));
-			}
+				return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, ETATS_FIELD_PAYMENT),
+											  etats_calculs_ope_get_text (calcul, ope_2, ETATS_FIELD_PAYMENT));
 			break;
 
 		case 8:
 			/* no chq  */
-			if (gsb_data_transaction_get_method_of_payment_content (transaction_number_1)
-				&& gsb_data_transaction_get_method_of_payment_content (transaction_number_2))
-			return_value = my_strcasecmp (gsb_data_transaction_get_method_of_payment_content (transaction_number_1),
-										  gsb_data_transaction_get_method_of_payment_content (transaction_number_2));
-			else
-				return_value = GPOINTER_TO_INT (gsb_data_transaction_get_method_of_payment_content
-												(transaction_number_2)) -
-								GPOINTER_TO_INT (gsb_data_transaction_get_method_of_payment_content
-												 (transaction_number_1));
+			return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, 9),
+										  etats_calculs_ope_get_text (calcul, ope_2, 9));
 			break;
 
 		case 9:
 			/* pc  */
-			if (gsb_data_transaction_get_voucher (transaction_number_1)
-				&& gsb_data_transaction_get_voucher (transaction_number_2))
-				return_value = my_strcasecmp (gsb_data_transaction_get_voucher (transaction_number_1),
-											  gsb_data_transaction_get_voucher (transaction_number_2));
-			else
-				return_value = GPOINTER_TO_INT (gsb_data_transaction_get_voucher (transaction_number_2)) -
-								GPOINTER_TO_INT (gsb_data_transaction_get_voucher (transaction_number_1));
+			return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, 8),
+										  etats_calculs_ope_get_text (calcul, ope_2, 8));
 			break;
 
 		case 10:
 			/* ibg  */
-			if (gsb_data_transaction_get_bank_references (transaction_number_1)
-				&& gsb_data_transaction_get_bank_references (transaction_number_2))
-				return_value = my_strcasecmp (gsb_data_transaction_get_bank_references (transaction_number_1),
-											  gsb_data_transaction_get_bank_references (transaction_number_2));
-			else
-				return_value = GPOINTER_TO_INT (gsb_data_transaction_get_bank_references (transaction_number_2)) -
-								GPOINTER_TO_INT (gsb_data_transaction_get_bank_references (transaction_number_1));
+			return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, 7),
+										  etats_calculs_ope_get_text (calcul, ope_2, 7));
 			break;
 
 		case 11:
 			/* no rappr  */
-			if (!gsb_data_transaction_get_reconcile_number (transaction_number_1)
-				||
-				!gsb_data_transaction_get_reconcile_number (transaction_number_2))
-				return_value = gsb_data_transaction_get_reconcile_number (transaction_number_2) -
-								gsb_data_transaction_get_reconcile_number (transaction_number_1);
+			if (!ope_1->reconcile_number || !ope_2->reconcile_number)
+				return_value = ope_2->reconcile_number - ope_1->reconcile_number;
 			else
-				return_value = my_strcasecmp (gsb_data_reconcile_get_name(gsb_data_transaction_get_reconcile_number
-																		  (transaction_number_1)),
-											  gsb_data_reconcile_get_name (gsb_data_transaction_get_reconcile_number
-																		   (transaction_number_2)));
+				return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, 10),
+											  etats_calculs_ope_get_text (calcul, ope_2, 10));
 			break;
 
 		default :
 			return_value = 0;
     }
 
-
     if (!return_value)
-	    return_value = transaction_number_1 - transaction_number_2;
+	    return_value = ope_1->transaction_number - ope_2->transaction_number;
 
     return (return_value);
 }
 
 /**
  * Fonction de classement de la liste en fonction du choix du type de classement
+ * ne lit que la copie des opés, peut être appelée dans un thread
  *
- * \param
- * \param
+ * \param ope_1
+ * \param ope_2
+ * \param calcul
  *
  * \return
  **/
-static gint classement_liste_opes_etat (gpointer transaction_1,
-										gpointer transaction_2)
+static gint classement_liste_opes_etat (const EtatsCalculOpe *ope_1,
+										const EtatsCalculOpe *ope_2,
+										EtatsCalcul *calcul)
 {
-    GSList *pointeur;
-    gint current_report_number;
+	guint i = 0;
     gint return_value;
-    gint transaction_number_1;
-    gint transaction_number_2;
-
-    transaction_number_1 = gsb_data_transaction_get_transaction_number (transaction_1);
-    transaction_number_2 = gsb_data_transaction_get_transaction_number (transaction_2);
-
-    current_report_number = gsb_gui_navigation_get_current_report ();
-
-    pointeur = gsb_data_report_get_sorting_type_list (current_report_number);
 
 classement_suivant:
 
-    /* si pointeur est null, on a fait le tour du classement, les opés sont identiques */
+    /* si on a fait le tour du classement, les opés sont identiques */
     /* si elles sont affichées, on classe suivant classement demandé puis par no d'opé si identiques */
     /* sinon on repart en mettant -1 */
 
-    if (!pointeur)
+    if (i >= calcul->nbre_sorting_types)
     {
-		return (classement_ope_perso_etat (transaction_1, transaction_2));
+		return (classement_ope_perso_etat (ope_1, ope_2, calcul));
     }
 
-	switch (GPOINTER_TO_INT (pointeur->data))
+	switch (calcul->sorting_types[i])
     {
 		/* classement des catégories */
 		case 1:
@@ -436,36 +607,26 @@ classement_suivant:
 			 * cad on va tester l'opé 1 sur categ, pas de categ, ventil, virement
 			 * et pour chacun on teste l'opé 2 sur categ, pas de categ, ventil, virement
 			 * */
-			if (gsb_data_report_get_category_used (current_report_number))
+			if (calcul->category_used)
 			{
-				gint category_number_1;
-				gint category_number_2;
-
-				category_number_1 = gsb_data_transaction_get_category_number (transaction_number_1);
-				category_number_2 = gsb_data_transaction_get_category_number (transaction_number_2);
-
 				/* Si les catégories sont nulles, on doit départager
 				 * entre virements, pas de categ ou opé ventilée on
 				 * met en 1er les opés sans categ, ensuite les
 				 * ventilations et enfin les virements */
-				if (category_number_1)
+				if (ope_1->category_number)
 				{
-					if (category_number_2)
+					if (ope_2->category_number)
 					{
 						/* 2 categories, return sorted */
-						const gchar *category_name_1;
-						const gchar *category_name_2;
-
-						if (category_number_1 == category_number_2)
+						if (ope_1->category_number == ope_2->category_number)
 						{
 							/* the 2 categories are the same, go to sub categ */
-							pointeur = pointeur->next;
+							i++;
 							goto classement_suivant;
 						}
 
-						category_name_1 = gsb_data_category_get_name (category_number_1, 0, NULL);
-						category_name_2 = gsb_data_category_get_name (category_number_2, 0, NULL);
-						return_value = my_strcasecmp (category_name_1, category_name_2);
+						return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, 2),
+													  etats_calculs_ope_get_text (calcul, ope_2, 2));
 
 						if (return_value)
 						{
@@ -474,7 +635,7 @@ classement_suivant:
 						else
 						{
 							/* the categories have the same name, go to sub categ */
-							pointeur = pointeur->next;
+							i++;
 							goto classement_suivant;
 						}
 					}
@@ -483,20 +644,19 @@ classement_suivant:
 				}
 
 				/* come here if transaction_1 has no category, so can be transfer or split */
-				if (gsb_data_transaction_get_split_of_transaction (transaction_number_1))
+				if (ope_1->is_split)
 				{
-					if (category_number_2)
+					if (ope_2->category_number)
 						/* transaction_2 has a category => go before transaction_1 */
 						return 1;
-					if (gsb_data_transaction_get_contra_transaction_number (transaction_number_2) > 0)
+					if (ope_2->contra_number > 0)
 						/* transaction_2 is a transfer, and transaction_1 a split, so split first please */
 						return -1;
-					if (gsb_data_transaction_get_split_of_transaction (transaction_number_2))
+					if (ope_2->is_split)
 					{
 						/* ok, the 2 transactions are split, so cannot separate them with category and
 						 * sub category, so go to 2 times after that sort */
-						pointeur = pointeur->next;
-						pointeur = pointeur->next;
+						i += 2;
 						goto classement_suivant;
 					}
 					/* category_number_2 is 0, so go go before the transaction_1 (without categ come before split or transfer) */
@@ -504,31 +664,26 @@ classement_suivant:
 				}
 
 				/* come here if transaction_1 has no category and is not a split */
-				if (gsb_data_transaction_get_contra_transaction_number (transaction_number_1) > 0)
+				if (ope_1->contra_number > 0)
 				{
-					if (category_number_2)
+					if (ope_2->category_number)
 						/* transaction_2 has a category => go before transaction_1 */
 						return 1;
-					if (gsb_data_transaction_get_split_of_transaction (transaction_number_2))
+					if (ope_2->is_split)
 						/* transaction_2 is a split, and transaction_1 a transfer, so split first please */
 						return 1;
-					if (gsb_data_transaction_get_contra_transaction_number (transaction_number_2) > 0)
+					if (ope_2->contra_number > 0)
 					{
-						/* the 2 transactions are transfer, we return a strcmp on their name */
-						return_value = my_strcasecmp (gsb_data_account_get_name
-													  (gsb_data_transaction_get_contra_transaction_number
-													   (transaction_number_1)),
-													  gsb_data_account_get_name
-													  (gsb_data_transaction_get_contra_transaction_number
-													   (transaction_number_2)));
+						/* the 2 transactions are transfer, we return a strcmp on the name of their contra account */
+						return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, ETATS_FIELD_CONTRA),
+													  etats_calculs_ope_get_text (calcul, ope_2, ETATS_FIELD_CONTRA));
 
 						if (return_value)
 							return return_value;
 						else
 						{
 							/* transfer to the same name of accout, go to the next sort after the sub categ */
-							pointeur = pointeur->next;
-							pointeur = pointeur->next;
+							i += 2;
 							goto classement_suivant;
 						}
 					}
@@ -538,23 +693,20 @@ classement_suivant:
 
 				/* come here if transaction_1 has no categ, no transfer and no split,
 				 * return according to transaction_2 */
-				if (category_number_2)
+				if (ope_2->category_number)
 					return 1;
-				if (gsb_data_transaction_get_split_of_transaction (transaction_number_2)
-					|| gsb_data_transaction_get_contra_transaction_number (transaction_number_2) > 0)
+				if (ope_2->is_split || ope_2->contra_number > 0)
 					return -1;
 
 				/* transaction_2 has too no categ, no transfer and no split,
 				 * so jumb sub categ and go to the next sort */
-				pointeur = pointeur->next;
-				pointeur = pointeur->next;
+				i += 2;
 				goto classement_suivant;
 			}
 			else
 			{
 				/* don't use category, go to the next sort */
-				pointeur = pointeur->next;
-				pointeur = pointeur->next;
+				i += 2;
 				goto classement_suivant;
 			}
 			break;
@@ -562,24 +714,11 @@ classement_suivant:
 		/* classement des sous catégories */
 		case 2:
 			/* normaly can come here only if it's a real category, so don't check here */
-			if (gsb_data_report_get_category_used (current_report_number)
-				&& gsb_data_report_get_category_show_sub_category (current_report_number))
+			if (calcul->category_used && calcul->sub_category_used)
 			{
 				/* we sort by sub-categ, alphabetic order, and first with sub-categ, no sub-categ come after */
-				const gchar *categ_name_1;
-				const gchar *categ_name_2;
-
-				categ_name_1 = gsb_data_category_get_name (gsb_data_transaction_get_category_number
-														   (transaction_number_1),
-														   gsb_data_transaction_get_sub_category_number
-														   (transaction_number_1),
-														   NULL);
-				categ_name_2 = gsb_data_category_get_name (gsb_data_transaction_get_category_number
-														   (transaction_number_2),
-														   gsb_data_transaction_get_sub_category_number
-														   (transaction_number_2),
-														   NULL);
-				return_value = my_strcasecmp (categ_name_1, categ_name_2);
+				return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, ETATS_FIELD_CATEG_FULL),
+											  etats_calculs_ope_get_text (calcul, ope_2, ETATS_FIELD_CATEG_FULL));
 
 				if (return_value)
 				{
@@ -588,35 +727,25 @@ classement_suivant:
 				else
 				{
 					/* the sub-categs have the same name, go to next sort */
-					pointeur = pointeur->next;
+					i++;
 					goto classement_suivant;
 				}
 			}
 			else
 			{
 				/* don't use sub_categ */
-				pointeur = pointeur->next;
+				i++;
 				goto classement_suivant;
 			}
 			break;
 
 		/* classement des ib */
 		case 3:
-			if (gsb_data_report_get_budget_used (current_report_number))
+			if (calcul->budget_used)
 			{
 				/* we sort by budget, alphabetic order, and first with budgets, no budgets come after */
-				const gchar *budget_name_1;
-				const gchar *budget_name_2;
-
-				budget_name_1 = gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number
-														  (transaction_number_1),
-														  0,
-														  NULL);
-				budget_name_2 = gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number
-														  (transaction_number_2),
-														  0,
-														  NULL);
-				return_value = my_strcasecmp (budget_name_1, budget_name_2);
+				return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, 4),
+											  etats_calculs_ope_get_text (calcul, ope_2, 4));
 
 				if (return_value)
 				{
@@ -625,15 +754,14 @@ classement_suivant:
 				else
 				{
 					/* the budgets have the same name, go to sub budget */
-					pointeur = pointeur->next;
+					i++;
 					goto classement_suivant;
 				}
 			}
 			else
 			{
 				/* don't use budgets */
-				pointeur = pointeur->next;
-				pointeur = pointeur->next;
+				i += 2;
 				goto classement_suivant;
 			}
 
@@ -641,24 +769,11 @@ classement_suivant:
 
 		/* classement des sous ib */
 		case 4:
-			if (gsb_data_report_get_budget_used (current_report_number)
-				&& gsb_data_report_get_budget_show_sub_budget (current_report_number))
+			if (calcul->budget_used && calcul->sub_budget_used)
 			{
 				/* we sort by sub-budget, alphabetic order, and first with sub-budgets, no sub-budgets come after */
-				const gchar *budget_name_1;
-				const gchar *budget_name_2;
-
-				budget_name_1 = gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number
-														  (transaction_number_1),
-														  gsb_data_transaction_get_sub_budgetary_number
-														  (transaction_number_1),
-														  NULL);
-				budget_name_2 = gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number
-														  (transaction_number_2),
-														  gsb_data_transaction_get_sub_budgetary_number
-														  (transaction_number_2),
-														  NULL);
-				return_value = my_strcasecmp (budget_name_1, budget_name_2);
+				return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, 5),
+											  etats_calculs_ope_get_text (calcul, ope_2, 5));
 
 				if (return_value)
 				{
@@ -667,32 +782,26 @@ classement_suivant:
 				else
 				{
 					/* the sub-budgets have the same name, go to next sort */
-					pointeur = pointeur->next;
+					i++;
 					goto classement_suivant;
 				}
 			}
 			else
 			{
 				/* don't use sub-budget */
-				pointeur = pointeur->next;
+				i++;
 				goto classement_suivant;
 			}
 			break;
 
 		/* classement des comptes */
 		case 5:
-			if (gsb_data_report_get_account_group_reports (current_report_number))
+			if (calcul->group_reports)
 			{
 				/* sort by account, alphabetic order
 				 * TODO : perhaps ask in parameters for alphabetic or different order ?*/
-				gchar *account_name_1;
-				gchar *account_name_2;
-
-				account_name_1 = gsb_data_account_get_name (gsb_data_transaction_get_account_number
-															(transaction_number_1));
-				account_name_2 = gsb_data_account_get_name (gsb_data_transaction_get_account_number
-															(transaction_number_2));
-				return_value = my_strcasecmp (account_name_1, account_name_2);
+				return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, ETATS_FIELD_ACCOUNT),
+											  etats_calculs_ope_get_text (calcul, ope_2, ETATS_FIELD_ACCOUNT));
 
 				if (return_value)
 				{
@@ -701,31 +810,25 @@ classement_suivant:
 				else
 				{
 					/* the accounts have the same name, go to next sort */
-					pointeur = pointeur->next;
+					i++;
 					goto classement_suivant;
 				}
 			}
 			else
 			{
 				/* don't use account sort, go to next sort */
-				pointeur = pointeur->next;
+				i++;
 				goto classement_suivant;
 			}
 			break;
 
 			/* classement des tiers */
 		case 6:
-			if (gsb_data_report_get_payee_used (current_report_number))
+			if (calcul->payee_used)
 			{
 				/* sort by party, alphabetic order */
-				const gchar *party_name_1;
-				const gchar *party_name_2;
-
-				party_name_1 = gsb_data_payee_get_name (gsb_data_transaction_get_party_number
-														(transaction_number_1), TRUE);
-				party_name_2 = gsb_data_payee_get_name (gsb_data_transaction_get_party_number
-														(transaction_number_2), TRUE);
-				return_value = my_strcasecmp (party_name_1, party_name_2);
+				return_value = my_strcasecmp (etats_calculs_ope_get_text (calcul, ope_1, 0),
+											  etats_calculs_ope_get_text (calcul, ope_2, 0));
 
 				if (return_value)
 				{
@@ -734,14 +837,14 @@ classement_suivant:
 				else
 				{
 					/* the payees have the same name, go to next sort */
-					pointeur = pointeur->next;
+					i++;
 					goto classement_suivant;
 				}
 			}
 			else
 			{
 				/* don't use payee sort, go to next sort */
-				pointeur = pointeur->next;
+				i++;
 				goto classement_suivant;
 			}
 			break;
@@ -895,323 +998,2096 @@ static gint compare_montants_etat (GsbReal montant_ope,
 }
 
 /**
- * récupère le texte pour faire le test sur les textes
+ * accesseurs des champs utilisés par les tests de texte,
+ * dans l'ordre des champs de la configuration des états
+ * les noms de catégorie et d'IB sont alloués, ils passent par
+ * etats_calculs_filter_get_div_name ()
  *
- * \param
- * \param gint		N° du champ recherché
+ * \param transaction_number
  *
- * \return
+ * \return le texte du champ ou NULL
  **/
-static const gchar *recupere_texte_test_etat (gint transaction_number,
-											  gint champ)
+static const gchar *etats_calculs_get_payee_name (gint transaction_number)
 {
-    const gchar *texte;
+	return gsb_data_payee_get_name (gsb_data_transaction_get_party_number (transaction_number), TRUE);
+}
 
-    switch (champ)
-    {
-		case 0:
-			/* tiers  */
-			texte = gsb_data_payee_get_name (gsb_data_transaction_get_party_number (transaction_number), TRUE);
-			break;
+static const gchar *etats_calculs_get_payee_description (gint transaction_number)
+{
+	return gsb_data_payee_get_description (gsb_data_transaction_get_party_number (transaction_number));
+}
 
-		case 1:
-			/* info du tiers */
-			texte = gsb_data_payee_get_description (gsb_data_transaction_get_party_number (transaction_number));
-			break;
+static const gchar *etats_calculs_get_reconcile_name (gint transaction_number)
+{
+	return gsb_data_reconcile_get_name (gsb_data_transaction_get_reconcile_number (transaction_number));
+}
+
+static const EtatsTextAccessor etats_text_accessors[ETATS_TEXT_FIELDS] =
+{
+	etats_calculs_get_payee_name,								/* tiers */
+	etats_calculs_get_payee_description,						/* info du tiers */
+	NULL,														/* categ */
+	NULL,														/* ss-categ */
+	NULL,														/* ib */
+	NULL,														/* ss-ib */
+	gsb_data_transaction_get_notes,								/* notes */
+	gsb_data_transaction_get_bank_references,					/* ref bancaires */
+	gsb_data_transaction_get_voucher,							/* pc */
+	gsb_data_transaction_get_method_of_payment_content,			/* chq */
+	etats_calculs_get_reconcile_name							/* no rappr */
+};
+
+/**
+ * renvoie le nom de catégorie ou d'IB d'une opé pour les tests de texte et le classement
+ * les noms sont alloués une seule fois par div/sous-div et gardés dans la sélection
+ *
+ * \param selection
+ * \param field			2 categ, 3 ss-categ, 4 ib, 5 ss-ib, ETATS_FIELD_CATEG_FULL categ : ss-categ
+ * \param transaction_number
+ *
+ * \return le nom, NULL si pas de catégorie ou d'IB
+ **/
+static const gchar *etats_calculs_filter_get_div_name (EtatsSelection *selection,
+													   gint field,
+													   gint transaction_number)
+{
+	GHashTable *sub_div_names;
+	gchar *name;
+	gint div_number;
+	gint sub_div_number;
+	gint index;
+
+	if (field == 2 || field == 3 || field == ETATS_FIELD_CATEG_FULL)
+	{
+		div_number = gsb_data_transaction_get_category_number (transaction_number);
+		sub_div_number = field != 2 ? gsb_data_transaction_get_sub_category_number (transaction_number) : 0;
+	}
+	else
+	{
+		div_number = gsb_data_transaction_get_budgetary_number (transaction_number);
+		sub_div_number = field == 5 ? gsb_data_transaction_get_sub_budgetary_number (transaction_number) : 0;
+	}
+
+	index = field == ETATS_FIELD_CATEG_FULL ? 4 : field - 2;
+	if (!selection->div_names[index])
+		selection->div_names[index] = g_hash_table_new_full (g_direct_hash,
+															 g_direct_equal,
+															 NULL,
+															 (GDestroyNotify) g_hash_table_destroy);
+
+	sub_div_names = g_hash_table_lookup (selection->div_names[index], GINT_TO_POINTER (div_number));
+	if (!sub_div_names)
+	{
+		sub_div_names = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+		g_hash_table_insert (selection->div_names[index], GINT_TO_POINTER (div_number), sub_div_names);
+	}
+	else if (g_hash_table_lookup_extended (sub_div_names, GINT_TO_POINTER (sub_div_number), NULL, (gpointer *) &name))
+		return name;
 
+	switch (field)
+	{
 		case 2:
 			/* categ */
-			texte = gsb_data_category_get_name (gsb_data_transaction_get_category_number (transaction_number),
-												0,
-												NULL);
+			name = gsb_data_category_get_name (div_number, 0, NULL);
 			break;
 
 		case 3:
 			/* ss-categ */
-			texte = gsb_data_category_get_sub_category_name (gsb_data_transaction_get_category_number
-															 (transaction_number),
-															 gsb_data_transaction_get_sub_category_number
-															 (transaction_number),
-															 NULL);
+			name = gsb_data_category_get_sub_category_name (div_number, sub_div_number, NULL);
 			break;
 
 		case 4:
 			/* ib */
-			texte = gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number (transaction_number),
-											  0,
-											  NULL);
+			name = gsb_data_budget_get_name (div_number, 0, NULL);
 			break;
 
 		case 5:
 			/* ss-ib */
-			texte = gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number (transaction_number),
-											  gsb_data_transaction_get_sub_budgetary_number (transaction_number),
-											  NULL);
-			break;
-
-		case 6:
-			/* notes  */
-			texte = gsb_data_transaction_get_notes (transaction_number);
-			break;
-
-		case 7:
-			/* ref bancaires  */
-			texte = gsb_data_transaction_get_bank_references (transaction_number);
-			break;
-
-		case 8:
-			/* pc */
-			texte = gsb_data_transaction_get_voucher (transaction_number);
-			break;
-
-		case 9:
-			/* chq  */
-			texte = gsb_data_transaction_get_method_of_payment_content (transaction_number);
-			break;
-
-		case 10:
-			/* no rappr */
-			texte = gsb_data_reconcile_get_name (gsb_data_transaction_get_reconcile_number (transaction_number));
+			name = gsb_data_budget_get_name (div_number, sub_div_number, NULL);
 			break;
 
 		default:
-			texte = NULL;
-    }
+			/* categ : ss-categ */
+			name = gsb_data_category_get_name (div_number, sub_div_number, NULL);
+	}
+	g_hash_table_insert (sub_div_names, GINT_TO_POINTER (sub_div_number), name);
 
-    return (texte);
+	return name;
 }
 
 /**
- * vérifie si l'opé passe le test du chq
+ * fait le lien entre le résultat d'une ligne de test et celui des lignes précédentes
  *
- * \param
- * \param
+ * \param garde_ope		résultat des lignes précédentes
+ * \param ope_dans_test	résultat de la ligne
+ * \param link			-1 1ère ligne, 0 et, 1 ou, 2 sauf
  *
- * \return
+ * \return le nouveau résultat
  **/
-static gint verifie_chq_test_etat (gint text_comparison_number,
-								   const gchar *no_chq)
-{
-	gint tmp_comparison;
-    gint ope_dans_test;
-    gint ope_dans_premier_test = 0;
-    gint ope_dans_second_test = 0;
-
-	tmp_comparison = gsb_data_report_text_comparison_get_first_comparison (text_comparison_number);
-    /* si on cherche le plus grand, on met la valeur recherchée à la place de montant_1 */
-    if (tmp_comparison != 6)
-		ope_dans_premier_test = compare_cheques_etat (utils_str_atoi (no_chq),
-													  gsb_data_report_text_comparison_get_first_amount
-													  (text_comparison_number),
-													  tmp_comparison);
-    else
-    {
-		gint reconcile_number;
-
-		switch (gsb_data_report_text_comparison_get_field (text_comparison_number))
-		{
-			case 8:
-			/* pc */
-			ope_dans_premier_test = compare_cheques_etat (utils_str_atoi (no_chq),
-														  dernier_pc,
-														  tmp_comparison);
-			break;
+static gint etats_calculs_filter_link (gint garde_ope,
+									   gint ope_dans_test,
+									   gint link)
+{
+	switch (link)
+	{
+		case -1:
+			/* 1ère ligne  */
+			return ope_dans_test;
 
-			case 9:
-			/* chq */
-			ope_dans_premier_test = compare_cheques_etat (utils_str_atoi (no_chq),
-														  dernier_chq,
-														  tmp_comparison);
-			break;
+		case 0:
+			/* et  */
+			return garde_ope && ope_dans_test;
 
-			case 10:
-			/* rappr */
-			/* no_chq contains the reconcile_number */
-			reconcile_number = gsb_data_reconcile_get_number_by_name (no_chq);
+		case 1:
+			/* ou  */
+			return garde_ope || ope_dans_test;
 
-			if (reconcile_number)
-				ope_dans_premier_test = compare_cheques_etat (reconcile_number,
-															  dernier_no_rappr,
-															  tmp_comparison);
-			break;
-		}
-    }
+		case 2:
+			/* sauf  */
+			return garde_ope && (!ope_dans_test);
+	}
 
-    if (gsb_data_report_text_comparison_get_link_first_to_second_part (text_comparison_number) != 3)
-    {
-		tmp_comparison = gsb_data_report_text_comparison_get_second_comparison (text_comparison_number);
-		if (tmp_comparison != 6)
-			ope_dans_second_test = compare_cheques_etat (utils_str_atoi (no_chq),
-														 gsb_data_report_text_comparison_get_second_amount
-														 (text_comparison_number),
-														 tmp_comparison);
-		else
-		{
-			switch (gsb_data_report_text_comparison_get_field (text_comparison_number))
-			{
-				case 8:
-					/* pc */
-					ope_dans_second_test = compare_cheques_etat (utils_str_atoi (no_chq),
-																 dernier_pc,
-																 tmp_comparison);
-					break;
-
-				case 9:
-					/* chq */
-					ope_dans_second_test = compare_cheques_etat (utils_str_atoi (no_chq),
-																 dernier_chq,
-																 tmp_comparison);
-					break;
-
-				case 10:
-					/* rappr */
-					ope_dans_second_test = compare_cheques_etat (utils_str_atoi (no_chq),
-																 dernier_no_rappr,
-																 tmp_comparison);
-					break;
-			}
-		}
-    }
+	return garde_ope;
+}
 
-    switch (gsb_data_report_text_comparison_get_link_first_to_second_part (text_comparison_number))
-    {
+/**
+ * fait le lien entre les 2 parties d'une ligne de test
+ *
+ * \param ope_dans_premier_test
+ * \param ope_dans_second_test
+ * \param link			0 et, 1 ou, 2 sauf, 3 aucun
+ *
+ * \return le résultat de la ligne
+ **/
+static gint etats_calculs_filter_link_parts (gint ope_dans_premier_test,
+											 gint ope_dans_second_test,
+											 gint link)
+{
+	switch (link)
+	{
 		case 0:
 			/* et  */
-			ope_dans_test = ope_dans_premier_test && ope_dans_second_test;
-			break;
+			return ope_dans_premier_test && ope_dans_second_test;
 
 		case 1:
 			/*  ou */
-			ope_dans_test = ope_dans_premier_test || ope_dans_second_test;
-			break;
+			return ope_dans_premier_test || ope_dans_second_test;
 
 		case 2:
 			/* sauf  */
-			ope_dans_test = ope_dans_premier_test && (!ope_dans_second_test);
-			break;
+			return ope_dans_premier_test && (!ope_dans_second_test);
 
 		case 3:
 			/* aucun  */
-			ope_dans_test = ope_dans_premier_test;
-			break;
+			return ope_dans_premier_test;
+	}
 
-		default:
-			ope_dans_test = 0;
-    }
+	return 0;
+}
+
+/**
+ * compile la liste des tests de texte de l'état
+ *
+ * \param report_number
+ *
+ * \return un GArray d'EtatsTextFilter à libérer
+ **/
+static GArray *etats_calculs_filter_new_text (gint report_number)
+{
+	GArray *filters;
+	GSList *comparison_list;
+
+	filters = g_array_new (FALSE, TRUE, sizeof (EtatsTextFilter));
+	comparison_list = gsb_data_report_get_text_comparison_list (report_number);
+	while (comparison_list)
+	{
+		EtatsTextFilter filter;
+		gint text_comparison_number;
+
+		text_comparison_number = GPOINTER_TO_INT (comparison_list->data);
 
-	return (ope_dans_test);
+		filter.link_to_last = gsb_data_report_text_comparison_get_link_to_last_text_comparison (text_comparison_number);
+		filter.field = gsb_data_report_text_comparison_get_field (text_comparison_number);
+
+		/* si c'est un chq ou une pc et que use_txt = TRUE, on utilise leur no */
+		filter.use_number = (filter.field == 8 || filter.field == 9 || filter.field == 10)
+			&& !gsb_data_report_text_comparison_get_use_text (text_comparison_number);
+
+		filter.text_operator = gsb_data_report_text_comparison_get_operator (text_comparison_number);
+		filter.text = gsb_data_report_text_comparison_get_text (text_comparison_number);
+		filter.text_len = filter.text ? strlen (filter.text) : 0;
+
+		filter.link_first_to_second = gsb_data_report_text_comparison_get_link_first_to_second_part
+			(text_comparison_number);
+		filter.first_comparison = gsb_data_report_text_comparison_get_first_comparison (text_comparison_number);
+		filter.first_number = gsb_data_report_text_comparison_get_first_amount (text_comparison_number);
+		filter.second_comparison = gsb_data_report_text_comparison_get_second_comparison (text_comparison_number);
+		filter.second_number = gsb_data_report_text_comparison_get_second_amount (text_comparison_number);
+
+		g_array_append_val (filters, filter);
+		comparison_list = comparison_list->next;
+	}
+
+	return filters;
 }
 
 /**
- * vérifie si l'opé passe le test du texte
+ * compile la liste des tests de montant de l'état
  *
- * \param
- * \param
+ * \param report_number
  *
- * \return
+ * \return un GArray d'EtatsAmountFilter à libérer
  **/
-static gint verifie_texte_test_etat (gint text_comparison_number,
-									 const gchar *texte_ope)
+static GArray *etats_calculs_filter_new_amount (gint report_number)
 {
-	const gchar *tmp_str;
-    gint ope_dans_test;
+	GArray *filters;
+	GSList *comparison_list;
+
+	filters = g_array_new (FALSE, TRUE, sizeof (EtatsAmountFilter));
+	comparison_list = gsb_data_report_get_amount_comparison_list (report_number);
+	while (comparison_list)
+	{
+		EtatsAmountFilter filter;
+		gint amount_comparison_number;
+
+		amount_comparison_number = GPOINTER_TO_INT (comparison_list->data);
+
+		filter.link_to_last = gsb_data_report_amount_comparison_get_link_to_last_amount_comparison
+			(amount_comparison_number);
+		filter.link_first_to_second = gsb_data_report_amount_comparison_get_link_first_to_second_part
+			(amount_comparison_number);
+		filter.first_comparison = gsb_data_report_amount_comparison_get_first_comparison (amount_comparison_number);
+		filter.first_amount = gsb_data_report_amount_comparison_get_first_amount (amount_comparison_number);
+		filter.second_comparison = gsb_data_report_amount_comparison_get_second_comparison (amount_comparison_number);
+		filter.second_amount = gsb_data_report_amount_comparison_get_second_amount (amount_comparison_number);
+
+		g_array_append_val (filters, filter);
+		comparison_list = comparison_list->next;
+	}
 
-    ope_dans_test = 0;
+	return filters;
+}
 
-	tmp_str = gsb_data_report_text_comparison_get_text (text_comparison_number);
-    switch (gsb_data_report_text_comparison_get_operator (text_comparison_number))
-    {
+/**
+ * vérifie si l'opé passe une partie du test du chq
+ *
+ * \param filter
+ * \param comparison	comparateur de la partie du test
+ * \param number		no de la partie du test
+ * \param no_ope		no de l'opé
+ * \param reconcile_number	no du relevé de l'opé
+ * \param first_part	TRUE pour la première partie du test
+ *
+ * \return 1 si l'opé passe le test, sinon 0
+ **/
+static gint etats_calculs_filter_check_number (const EtatsTextFilter *filter,
+											   gint comparison,
+											   gint number,
+											   gint no_ope,
+											   gint reconcile_number,
+											   gboolean first_part)
+{
+	/* si on cherche le plus grand, on compare avec le plus grand no des comptes choisis */
+	if (comparison != 6)
+		return compare_cheques_etat (no_ope, number, comparison);
+
+	switch (filter->field)
+	{
+		case 8:
+			/* pc */
+			return compare_cheques_etat (no_ope, dernier_pc, comparison);
+
+		case 9:
+			/* chq */
+			return compare_cheques_etat (no_ope, dernier_chq, comparison);
+
+		case 10:
+			/* rappr : la première partie compare le numéro du relevé et non son nom */
+			if (first_part)
+				no_ope = reconcile_number;
+			return compare_cheques_etat (no_ope, dernier_no_rappr, comparison);
+	}
+
+	return 0;
+}
+
+/**
+ * vérifie si le texte de l'opé passe une ligne de test de texte
+ *
+ * \param filter
+ * \param texte_ope		texte du champ de l'opé, peut être NULL
+ *
+ * \return 1 si l'opé passe le test, sinon 0
+ **/
+static gint etats_calculs_filter_check_text (const EtatsTextFilter *filter,
+											 const gchar *texte_ope)
+{
+	gsize len;
+
+	switch (filter->text_operator)
+	{
 		case 0:
 			/* contient  */
-			if (texte_ope && tmp_str)
-			{
-				if (g_strstr_len (texte_ope, -1, tmp_str))
-					ope_dans_test = 1;
-			}
-			break;
+			return texte_ope && filter->text && strstr (texte_ope, filter->text);
 
 		case 1:
 			/* ne contient pas  */
-			if (texte_ope && tmp_str)
-			{
-				if (!g_strstr_len (texte_ope, -1, tmp_str))
-					ope_dans_test = 1;
-			}
-			else
-				ope_dans_test = 1;
-			break;
+			return !texte_ope || !filter->text || !strstr (texte_ope, filter->text);
 
 		case 2:
 			/* commence par  */
-			if (texte_ope && tmp_str)
-			{
-				if (g_str_has_prefix (texte_ope, tmp_str))
-					ope_dans_test = 1;
-			}
-			break;
+			return texte_ope && filter->text && !strncmp (texte_ope, filter->text, filter->text_len);
 
 		case 3:
 			/* se termine par  */
-			if (texte_ope && tmp_str)
-			{
-				if (g_str_has_suffix (texte_ope, tmp_str))
-					ope_dans_test = 1;
-			}
-			break;
+			if (!texte_ope || !filter->text)
+				return 0;
+			len = strlen (texte_ope);
+			return len >= filter->text_len
+				&& !memcmp (texte_ope + len - filter->text_len, filter->text, filter->text_len);
 
 		case 4:
 			/* vide  */
-			if (!texte_ope)
-				ope_dans_test = 1;
-			break;
+			return !texte_ope;
 
 		case 5:
 			/* non vide  */
-			if (texte_ope)
-				ope_dans_test = 1;
-			break;
-    }
+			return texte_ope != NULL;
+	}
 
-    return (ope_dans_test);
+	return 0;
 }
 
 /**
+ * vérifie si l'opé passe les tests de texte compilés de l'état
+ * les textes sont lus dans la copie des opés, peut être appelée dans un thread
  *
+ * \param calcul
+ * \param ope
  *
- * \param
- * \param
- * \param
- *
- * \return
+ * \return TRUE si l'opé est gardée
  **/
-static void etape_finale_affichage_etat (GSList *ope_selectionnees,
-										 struct EtatAffichage *affichage,
-										 gchar *filename)
+static gboolean etats_calculs_filter_text (EtatsCalcul *calcul,
+										   const EtatsCalculOpe *ope)
 {
-    GSList *liste_ope_revenus;
-	GSList *liste_ope_depenses;
-	GSList *pointeur_opes;
-	GSList *pointeur_sort_list;
-    const gchar *decalage_base;
-	const gchar *decalage_categ;
-	const gchar *decalage_sous_categ;
-	const gchar *decalage_ib;
-    const gchar *decalage_sous_ib;
-    const gchar *decalage_compte;
-    const gchar *decalage_tiers;
-    gint i;
-    gint ligne;
-    gint current_report_number;
-	gint categ_used = 0;
-	gint sous_categ_used = 0;
-	gint group_reports = 0;
-	gint ib_used = 0;
+	GArray *filters = calcul->selection->text_filters;
+	gint numbers[ETATS_TEXT_FIELDS];
+	guint parsed = 0;
+	gint garde_ope = 0;
+	guint i;
+
+	for (i = 0; i < filters->len; i++)
+	{
+		const EtatsTextFilter *filter;
+		const gchar *texte = NULL;
+		gint ope_dans_test;
+
+		filter = &g_array_index (filters, EtatsTextFilter, i);
+
+		/* on commence par récupérer le texte du champs recherché */
+		if (filter->field >= 0 && filter->field < ETATS_TEXT_FIELDS)
+			texte = etats_calculs_ope_get_text (calcul, ope, filter->field);
+
+		if (filter->use_number)
+		{
+			if (texte)
+			{
+				gint ope_dans_premier_test;
+				gint ope_dans_second_test = 0;
+
+				if (!(parsed & (1 << filter->field)))
+				{
+					numbers[filter->field] = utils_str_atoi (texte);
+					parsed |= 1 << filter->field;
+				}
+
+				ope_dans_premier_test = etats_calculs_filter_check_number (filter,
+																		   filter->first_comparison,
+																		   filter->first_number,
+																		   numbers[filter->field],
+																		   ope->reconcile_number,
+																		   TRUE);
+				if (filter->link_first_to_second != 3)
+					ope_dans_second_test = etats_calculs_filter_check_number (filter,
+																			  filter->second_comparison,
+																			  filter->second_number,
+																			  numbers[filter->field],
+																			  ope->reconcile_number,
+																			  FALSE);
+
+				ope_dans_test = etats_calculs_filter_link_parts (ope_dans_premier_test,
+																 ope_dans_second_test,
+																 filter->link_first_to_second);
+			}
+			else
+				ope_dans_test = 0;
+		}
+		else
+			ope_dans_test = etats_calculs_filter_check_text (filter, texte);
+
+		/* il faut qu'on fasse le lien avec la ligne précédente */
+		garde_ope = etats_calculs_filter_link (garde_ope, ope_dans_test, filter->link_to_last);
+	}
+
+	return garde_ope;
+}
+
+/**
+ * vérifie si l'opé passe les tests de montant compilés de l'état
+ *
+ * \param filters		GArray d'EtatsAmountFilter
+ * \param ope
+ *
+ * \return TRUE si l'opé est gardée
+ **/
+static gboolean etats_calculs_filter_amount (GArray *filters,
+											 const EtatsCalculOpe *ope)
+{
+	gint garde_ope = 0;
+	guint i;
+
+	for (i = 0; i < filters->len; i++)
+	{
+		const EtatsAmountFilter *filter;
+		gint ope_dans_premier_test;
+		gint ope_dans_second_test = 0;
+		gint ope_dans_test;
+
+		filter = &g_array_index (filters, EtatsAmountFilter, i);
+
+		/* on vérifie maintenant en fonction de la ligne de test si on garde cette opé */
+		ope_dans_premier_test = compare_montants_etat (ope->account_amount,
+													   filter->first_amount,
+													   filter->first_comparison);
+		if (filter->link_first_to_second != 3)
+			ope_dans_second_test = compare_montants_etat (ope->account_amount,
+														  filter->second_amount,
+														  filter->second_comparison);
+
+		ope_dans_test = etats_calculs_filter_link_parts (ope_dans_premier_test,
+														 ope_dans_second_test,
+														 filter->link_first_to_second);
+
+		/* il faut qu'on fasse le lien avec la ligne précédente */
+		garde_ope = etats_calculs_filter_link (garde_ope, ope_dans_test, filter->link_to_last);
+	}
+
+	return garde_ope;
+}
+
+/**
+ * construit une table de numéros à partir d'une liste de GINT_TO_POINTER
+ *
+ * \param list		liste de numéros
+ *
+ * \return une GHashTable à libérer
+ **/
+static GHashTable *etats_calculs_selection_new_set (GSList *list)
+{
+	GHashTable *set;
+
+	set = g_hash_table_new (g_direct_hash, g_direct_equal);
+	while (list)
+	{
+		g_hash_table_add (set, list->data);
+		list = list->next;
+	}
+
+	return set;
+}
+
+/**
+ * construit la table div -> table des sous-div d'une liste de CategBudgetSel
+ * comme gsb_data_report_check_categ_budget_in_report (), seule la première
+ * structure trouvée pour une division est prise en compte
+ *
+ * \param list_struct_report	liste des CategBudgetSel de l'état
+ *
+ * \return une GHashTable à libérer
+ **/
+static GHashTable *etats_calculs_selection_new_categ_budget (GSList *list_struct_report)
+{
+	GHashTable *divs;
+
+	divs = g_hash_table_new_full (g_direct_hash,
+								  g_direct_equal,
+								  NULL,
+								  (GDestroyNotify) g_hash_table_destroy);
+	while (list_struct_report)
+	{
+		CategBudgetSel *categ_budget_struct;
+
+		categ_budget_struct = list_struct_report->data;
+		if (!g_hash_table_contains (divs, GINT_TO_POINTER (categ_budget_struct->div_number)))
+			g_hash_table_insert (divs,
+								 GINT_TO_POINTER (categ_budget_struct->div_number),
+								 etats_calculs_selection_new_set (categ_budget_struct->sub_div_numbers));
+
+		list_struct_report = list_struct_report->next;
+	}
+
+	return divs;
+}
+
+/**
+ * vérifie qu'une div/sous-div fait partie de la table construite par
+ * etats_calculs_selection_new_categ_budget ()
+ *
+ * \param divs
+ * \param div_number
+ * \param sub_div_number
+ *
+ * \return TRUE si la div/sous-div est sélectionnée
+ **/
+static gboolean etats_calculs_selection_check_categ_budget (GHashTable *divs,
+															gint div_number,
+															gint sub_div_number)
+{
+	GHashTable *sub_divs;
+
+	sub_divs = g_hash_table_lookup (divs, GINT_TO_POINTER (div_number));
+	if (!sub_divs)
+		return FALSE;
+
+	return g_hash_table_contains (sub_divs, GINT_TO_POINTER (sub_div_number));
+}
+
+/**
+ * calcule les bornes de la plage de dates de l'état en jours juliens
+ *
+ * \param selection
+ *
+ * \return
+ **/
+static void etats_calculs_selection_set_dates (EtatsSelection *selection)
+{
+	GDate *date_jour;
+	GDate *date_tmp;
+	const GDate *date_start;
+	const GDate *date_end;
+	gint report_number;
+
+	report_number = selection->report_number;
+	selection->use_dates = TRUE;
+	selection->use_value_date = gsb_data_report_get_date_select_value (report_number);
+	date_jour = gdate_today ();
+	date_tmp = g_date_new ();
+
+	switch (gsb_data_report_get_date_type (report_number))
+	{
+		case 1:
+			/* plage perso */
+			date_start = gsb_data_report_get_personal_date_start (report_number);
+			date_end = gsb_data_report_get_personal_date_end (report_number);
+			if (date_start && date_end)
+			{
+				selection->first_julian = g_date_get_julian (date_start);
+				selection->last_julian = g_date_get_julian (date_end);
+			}
+			else
+				selection->reject_all = TRUE;
+			break;
+
+		case 2:
+			/* cumul à ce jour, toujours sur la date de l'opé */
+			selection->use_value_date = FALSE;
+			selection->last_julian = g_date_get_julian (date_jour);
+			break;
+
+		case 3:
+		case 5:
+		case 7:
+			/* mois en cours, cumul mensuel, mois précédent */
+			if (gsb_data_report_get_date_type (report_number) == 7)
+				g_date_subtract_months (date_jour, 1);
+
+			g_date_set_dmy (date_tmp, 1, g_date_get_month (date_jour), g_date_get_year (date_jour));
+			selection->first_julian = g_date_get_julian (date_tmp);
+			if (gsb_data_report_get_date_type (report_number) == 5)
+				selection->last_julian = g_date_get_julian (date_jour);
+			else
+				selection->last_julian = selection->first_julian
+					+ g_date_get_days_in_month (g_date_get_month (date_jour), g_date_get_year (date_jour)) - 1;
+			break;
+
+		case 4:
+		case 6:
+		case 8:
+			/* année en cours, cumul annuel, année précédente */
+			if (gsb_data_report_get_date_type (report_number) == 8)
+				g_date_subtract_years (date_jour, 1);
+
+			g_date_set_dmy (date_tmp, 1, G_DATE_JANUARY, g_date_get_year (date_jour));
+			selection->first_julian = g_date_get_julian (date_tmp);
+			if (gsb_data_report_get_date_type (report_number) == 6)
+				selection->last_julian = g_date_get_julian (date_jour);
+			else
+			{
+				g_date_set_dmy (date_tmp, 31, G_DATE_DECEMBER, g_date_get_year (date_jour));
+				selection->last_julian = g_date_get_julian (date_tmp);
+			}
+			break;
+
+		case 9:
+		case 10:
+		case 11:
+		case 12:
+			/* 30 derniers jours, 3, 6 et 12 derniers mois */
+			g_date_set_julian (date_tmp, g_date_get_julian (date_jour));
+			if (gsb_data_report_get_date_type (report_number) == 9)
+				g_date_subtract_days (date_tmp, 30);
+			else if (gsb_data_report_get_date_type (report_number) == 10)
+				g_date_subtract_months (date_tmp, 3);
+			else if (gsb_data_report_get_date_type (report_number) == 11)
+				g_date_subtract_months (date_tmp, 6);
+			else
+				g_date_subtract_months (date_tmp, 12);
+
+			selection->first_julian = g_date_get_julian (date_tmp);
+			selection->last_julian = g_date_get_julian (date_jour);
+			break;
+
+		default:
+			/* toutes */
+			selection->use_dates = FALSE;
+	}
+
+	g_date_free (date_tmp);
+	g_date_free (date_jour);
+}
+
+/**
+ * compile les filtres de l'état en tables de recherche
+ *
+ * \param report_number
+ *
+ * \return la sélection à libérer avec etats_calculs_selection_free ()
+ **/
+static EtatsSelection *etats_calculs_selection_new (gint report_number)
+{
+	EtatsSelection *selection;
+	GSList *tmp_list;
+	gint show_m;
+
+	selection = g_malloc0 (sizeof (EtatsSelection));
+	selection->report_number = report_number;
+
+	/* on récupère ignore_archives qui s'il vaut 1 ne retient que la liste courte des opérations */
+	selection->ignore_archives = gsb_data_report_get_ignore_archives (report_number);
+
+	/* les comptes concernés */
+	selection->accounts = g_hash_table_new_full (g_direct_hash,
+												 g_direct_equal,
+												 NULL,
+												 (GDestroyNotify) g_ptr_array_unref);
+	if (gsb_data_report_get_account_use_chosen (report_number))
+		selection->report_accounts = etats_calculs_selection_new_set (gsb_data_report_get_account_numbers_list
+																	  (report_number));
+
+	tmp_list = gsb_data_account_get_list_accounts ();
+	while (tmp_list)
+	{
+		gint i;
+
+		i = gsb_data_account_get_no_account (tmp_list->data);
+		if (!selection->report_accounts
+			|| g_hash_table_contains (selection->report_accounts, GINT_TO_POINTER (i)))
+			g_hash_table_insert (selection->accounts, GINT_TO_POINTER (i), g_ptr_array_new ());
+
+		tmp_list = tmp_list->next;
+	}
+
+	/* si on a utilisé "le plus grand" dans la recherche de texte, il faudra */
+	/* rechercher les plus grands no de chq, de rappr et de pc dans les comptes choisis */
+	tmp_list = gsb_data_report_get_text_comparison_list (report_number);
+	while (tmp_list)
+	{
+		gint text_comparison_number;
+
+		text_comparison_number = GPOINTER_TO_INT (tmp_list->data);
+		if (gsb_data_report_text_comparison_get_first_comparison (text_comparison_number) == 6
+			|| gsb_data_report_text_comparison_get_second_comparison (text_comparison_number) == 6)
+		{
+			selection->search_last_numbers = TRUE;
+			break;
+		}
+		tmp_list = tmp_list->next;
+	}
+
+	/* opés ventilées : on garde la mère si on ne détaille pas les ventilations, les filles sinon */
+	selection->reject_split = gsb_data_report_get_category_detail_used (report_number)
+		|| !gsb_data_report_get_not_detail_split (report_number);
+	selection->reject_children = !gsb_data_report_get_category_detail_used (report_number)
+		&& gsb_data_report_get_not_detail_split (report_number);
+
+	if (gsb_data_report_get_text_comparison_used (report_number))
+		selection->text_filters = etats_calculs_filter_new_text (report_number);
+	if (gsb_data_report_get_amount_comparison_used (report_number))
+		selection->amount_filters = etats_calculs_filter_new_amount (report_number);
+	selection->only_non_null = gsb_data_report_get_amount_comparison_only_report_non_null (report_number);
+
+	/* on vérifie les R */
+	show_m = gsb_data_report_get_show_m (report_number);
+	selection->marked_accepted[OPERATION_NORMALE] = (show_m != 2);
+	selection->marked_accepted[OPERATION_POINTEE] = (show_m != 2 || gsb_data_report_get_show_p (report_number));
+	selection->marked_accepted[OPERATION_TELEPOINTEE] = (show_m != 2 || gsb_data_report_get_show_t (report_number));
+	selection->marked_accepted[OPERATION_RAPPROCHEE] = (show_m == 0
+														|| (show_m == 2 && gsb_data_report_get_show_r (report_number)));
+
+	/* les virements */
+	selection->transfer_choice = gsb_data_report_get_transfer_choice (report_number);
+	selection->reject_non_transfer = selection->transfer_choice
+		&& gsb_data_report_get_transfer_reports_only (report_number);
+	if (selection->transfer_choice < 0 || selection->transfer_choice > 2)
+		selection->transfer_accounts = etats_calculs_selection_new_set (gsb_data_report_get_transfer_account_numbers_list
+																		(report_number));
+
+	/* catégories, IB et tiers */
+	if (gsb_data_report_get_category_detail_used (report_number))
+		selection->categories = etats_calculs_selection_new_categ_budget (gsb_data_report_get_category_struct_list
+																		  (report_number));
+	if (gsb_data_report_get_budget_detail_used (report_number))
+		selection->budgets = etats_calculs_selection_new_categ_budget (gsb_data_report_get_budget_struct_list
+																	   (report_number));
+	if (gsb_data_report_get_payee_detail_used (report_number))
+		selection->payees = etats_calculs_selection_new_set (gsb_data_report_get_payee_numbers_list (report_number));
+
+	/* les moyens de paiement sont comparés par leur nom, les noms vides ne correspondent jamais */
+	if (gsb_data_report_get_method_of_payment_used (report_number))
+	{
+		selection->payment_names = g_hash_table_new (g_str_hash, g_str_equal);
+		selection->payment_cache = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+		tmp_list = gsb_data_report_get_method_of_payment_list (report_number);
+		while (tmp_list)
+		{
+			if (tmp_list->data && strlen (tmp_list->data))
+				g_hash_table_add (selection->payment_names, tmp_list->data);
+
+			tmp_list = tmp_list->next;
+		}
+	}
+
+	/* si on utilise l'exercice courant ou précédent, on cherche ici le numéro de l'exercice correspondant */
+	selection->use_financial_year = gsb_data_report_get_use_financial_year (report_number);
+	if (selection->use_financial_year)
+	{
+		GDate *date_jour;
+		gint fyear_number;
+
+		/* get the current financial year */
+		date_jour = gdate_today ();
+		fyear_number = gsb_data_fyear_get_from_date (date_jour);
+		g_date_free (date_jour);
+
+		selection->financial_year_type = gsb_data_report_get_financial_year_type (report_number);
+		switch (selection->financial_year_type)
+		{
+			case 1:
+				/* want the current financial year */
+				selection->no_exercice_recherche = fyear_number;
+				break;
+			case 2:
+				/* want the last financial year */
+				selection->no_exercice_recherche = gsb_data_fyear_get_previous_financial_year (fyear_number);
+				break;
+			case 3:
+				selection->financial_years = etats_calculs_selection_new_set (gsb_data_report_get_financial_year_list
+																			  (report_number));
+				break;
+		}
+	}
+	else
+		etats_calculs_selection_set_dates (selection);
+
+	return selection;
+}
+
+/**
+ * libère la sélection compilée
+ *
+ * \param selection
+ *
+ * \return
+ **/
+static void etats_calculs_selection_free (EtatsSelection *selection)
+{
+	gint i;
+
+	g_hash_table_destroy (selection->accounts);
+
+	if (selection->text_filters)
+		g_array_free (selection->text_filters, TRUE);
+	if (selection->amount_filters)
+		g_array_free (selection->amount_filters, TRUE);
+	for (i = 0; i < 5; i++)
+		if (selection->div_names[i])
+			g_hash_table_destroy (selection->div_names[i]);
+
+	if (selection->report_accounts)
+		g_hash_table_destroy (selection->report_accounts);
+	if (selection->transfer_accounts)
+		g_hash_table_destroy (selection->transfer_accounts);
+	if (selection->categories)
+		g_hash_table_destroy (selection->categories);
+	if (selection->budgets)
+		g_hash_table_destroy (selection->budgets);
+	if (selection->payees)
+		g_hash_table_destroy (selection->payees);
+	if (selection->payment_names)
+		g_hash_table_destroy (selection->payment_names);
+	if (selection->payment_cache)
+		g_hash_table_destroy (selection->payment_cache);
+	if (selection->financial_years)
+		g_hash_table_destroy (selection->financial_years);
+
+	g_free (selection);
+}
+
+/**
+ * met à jour les plus grands no de chq, de pc et de rappr avec ceux de l'opé
+ *
+ * \param transaction_number
+ *
+ * \return
+ **/
+static void etats_calculs_update_last_numbers (gint transaction_number)
+{
+	const gchar *tmp_str;
+	gint tmp_number;
+
+	/* commence par le cheque, il faut que le type opé soit à incrémentation auto */
+	/* et le no le plus grand */
+	if ((tmp_str = gsb_data_transaction_get_method_of_payment_content (transaction_number)))
+	{
+		gint payment_number;
+
+		payment_number = gsb_data_transaction_get_method_of_payment_number (transaction_number);
+		if (gsb_data_payment_get_show_entry (payment_number)
+			&& gsb_data_payment_get_automatic_numbering (payment_number))
+		{
+			tmp_number = utils_str_atoi (tmp_str);
+			if (tmp_number > dernier_chq)
+				dernier_chq = tmp_number;
+		}
+	}
+
+	/* on récupère maintenant la plus grande pc */
+	if ((tmp_str = gsb_data_transaction_get_voucher (transaction_number)))
+	{
+		tmp_number = utils_str_atoi (tmp_str);
+		if (tmp_number > dernier_pc)
+			dernier_pc = tmp_number;
+	}
+
+	/* on récupère maintenant le dernier relevé */
+	tmp_number = gsb_data_transaction_get_reconcile_number (transaction_number);
+	if (tmp_number > dernier_no_rappr)
+		dernier_no_rappr = tmp_number;
+}
+
+/**
+ * vérifie si le moyen de paiement de l'opé fait partie de l'état
+ * le résultat est gardé par numéro de moyen de paiement
+ *
+ * \param selection
+ * \param payment_number
+ *
+ * \return TRUE si le moyen de paiement est sélectionné
+ **/
+static gboolean etats_calculs_selection_check_payment (EtatsSelection *selection,
+													   gint payment_number)
+{
+	gpointer found;
+
+	if (!payment_number)
+		return FALSE;
+
+	found = g_hash_table_lookup (selection->payment_cache, GINT_TO_POINTER (payment_number));
+	if (!found)
+	{
+		const gchar *name;
+
+		name = gsb_data_payment_get_name (payment_number);
+		if (name && strlen (name) && g_hash_table_contains (selection->payment_names, name))
+			found = GINT_TO_POINTER (1);
+		else
+			found = GINT_TO_POINTER (2);
+
+		g_hash_table_insert (selection->payment_cache, GINT_TO_POINTER (payment_number), found);
+	}
+
+	return GPOINTER_TO_INT (found) == 1;
+}
+
+/**
+ * vérifie si l'opé passe tous les filtres de l'état
+ * ne lit que la sélection compilée et la copie de l'opé, peut être appelée dans un thread
+ *
+ * \param calcul
+ * \param ope
+ *
+ * \return TRUE si l'opé est sélectionnée
+ **/
+static gboolean etats_calculs_selection_accept (EtatsCalcul *calcul,
+												const EtatsCalculOpe *ope)
+{
+	EtatsSelection *selection;
+
+	selection = calcul->selection;
+
+	/* si c'est une opé ventilée, dépend de la conf */
+	if (selection->reject_split && ope->is_split)
+		return FALSE;
+
+	if (selection->reject_children && ope->is_child)
+		return FALSE;
+
+	/* on vérifie ensuite si un texte est recherché */
+	if (selection->text_filters && !etats_calculs_filter_text (calcul, ope))
+		return FALSE;
+
+	/* on vérifie les R */
+	if (ope->marked >= OPERATION_NORMALE
+		&& ope->marked <= OPERATION_RAPPROCHEE
+		&& !selection->marked_accepted[ope->marked])
+		return FALSE;
+
+	/* vérification du montant nul */
+	if (selection->only_non_null && !ope->amount.mantissa)
+		return FALSE;
+
+	/* vérification des montants */
+	if (selection->amount_filters && !etats_calculs_filter_amount (selection->amount_filters, ope))
+		return FALSE;
+
+	/* on vérifie les virements */
+	if (ope->contra_number > 0)
+	{
+		switch (selection->transfer_choice)
+		{
+			case 0:
+				return FALSE;
+
+			case 1:
+				/* on inclue l'opé que si le compte de virement */
+				/* est un compte de passif ou d'actif */
+				if (ope->contra_account_kind != GSB_TYPE_LIABILITIES
+					&& ope->contra_account_kind != GSB_TYPE_ASSET)
+					return FALSE;
+				break;
+
+			case 2:
+				/* on inclut l'opé que si le compte de virement n'est pas présent dans l'état */
+				/* si on ne détaille pas les comptes, on ne cherche pas, l'opé est refusée */
+				if (!selection->report_accounts
+					|| g_hash_table_contains (selection->report_accounts,
+											  GINT_TO_POINTER (ope->contra_account_number)))
+					return FALSE;
+				break;
+
+			default:
+				/* on inclut l'opé que si le compte de virement est dans la liste */
+				if (!selection->transfer_accounts
+					|| !g_hash_table_contains (selection->transfer_accounts,
+											   GINT_TO_POINTER (ope->contra_account_number)))
+					return FALSE;
+		}
+	}
+	else if (selection->reject_non_transfer)
+		/* l'opé n'est pas un virement, si on doit exclure les non virement, c'est ici */
+		return FALSE;
+
+	/* check the categ only if it's not a split or transfer */
+	if (selection->categories
+		&& ope->contra_number == 0
+		&& !ope->is_split
+		&& !etats_calculs_selection_check_categ_budget (selection->categories,
+														ope->category_number,
+														ope->sub_category_number))
+		return FALSE;
+
+	/* check the buget */
+	if (selection->budgets
+		&& !etats_calculs_selection_check_categ_budget (selection->budgets,
+														ope->budgetary_number,
+														ope->sub_budgetary_number))
+		return FALSE;
+
+	/* vérification du tiers */
+	if (selection->payees
+		&& !g_hash_table_contains (selection->payees, GINT_TO_POINTER (ope->party_number)))
+		return FALSE;
+
+	/* vérification du type d'opération, le moyen de paiement a été vérifié lors de la copie */
+	if (selection->payment_names && !ope->payment_accepted)
+		return FALSE;
+
+	/* vérifie l'exercice */
+	if (selection->use_financial_year)
+	{
+		switch (selection->financial_year_type)
+		{
+			case 1:
+			case 2:
+				if (!ope->financial_year_number || ope->financial_year_number != selection->no_exercice_recherche)
+					return FALSE;
+				break;
+
+			case 3:
+				if (!ope->financial_year_number
+					|| !g_hash_table_contains (selection->financial_years,
+											   GINT_TO_POINTER (ope->financial_year_number)))
+					return FALSE;
+				break;
+		}
+	}
+
+	/* vérifie la plage de date */
+	else if (selection->use_dates)
+	{
+		guint32 julian;
+
+		if (selection->reject_all)
+			return FALSE;
+
+		/* on récupère la date ou la date de valeur */
+		if (selection->use_value_date && ope->value_julian)
+			julian = ope->value_julian;
+		else
+			julian = ope->julian;
+
+		if (!julian)
+			return FALSE;
+
+		if ((selection->first_julian && julian < selection->first_julian)
+			|| (selection->last_julian && julian > selection->last_julian))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * renvoie le texte d'un champ d'une opé à copier
+ * les textes sont gardés dans le GStringChunk du calcul
+ *
+ * \param calcul
+ * \param field
+ * \param transaction_number
+ *
+ * \return le texte, NULL si l'opé n'a pas ce texte
+ **/
+static const gchar *etats_calculs_ope_copy_text (EtatsCalcul *calcul,
+												 gint field,
+												 gint transaction_number)
+{
+	const gchar *text;
+
+	/* les noms de catégorie et d'IB sont déjà gardés par la sélection */
+	if ((field >= 2 && field <= 5) || field == ETATS_FIELD_CATEG_FULL)
+		return etats_calculs_filter_get_div_name (calcul->selection, field, transaction_number);
+
+	switch (field)
+	{
+		case ETATS_FIELD_ACCOUNT:
+			text = gsb_data_account_get_name (gsb_data_transaction_get_account_number (transaction_number));
+			break;
+
+		case ETATS_FIELD_CONTRA:
+			text = gsb_data_account_get_name (gsb_data_transaction_get_contra_transaction_account
+											  (transaction_number));
+			break;
+
+		case ETATS_FIELD_PAYMENT:
+			text = gsb_data_payment_get_name (gsb_data_transaction_get_method_of_payment_number
+											  (transaction_number));
+			break;
+
+		default:
+			text = etats_text_accessors[field] (transaction_number);
+	}
+
+	if (!text)
+		return NULL;
+
+	return g_string_chunk_insert_const (calcul->strings, text);
+}
+
+/**
+ * copie une opé candidate dans le calcul
+ * seuls les textes utilisés par les tests de texte et le classement sont copiés
+ *
+ * \param calcul
+ * \param index			place de l'opé dans la copie
+ * \param transaction	l'opé
+ *
+ * \return
+ **/
+static void etats_calculs_ope_copy (EtatsCalcul *calcul,
+									guint index,
+									gpointer transaction)
+{
+	EtatsCalculOpe *ope;
+	EtatsSelection *selection;
+	const GDate *date;
+	gint transaction_number;
+	gint field;
+
+	selection = calcul->selection;
+	transaction_number = gsb_data_transaction_get_transaction_number (transaction);
+
+	ope = &calcul->opes[index];
+	ope->transaction = transaction;
+	ope->transaction_number = transaction_number;
+	ope->account_number = gsb_data_transaction_get_account_number (transaction_number);
+	ope->party_number = gsb_data_transaction_get_party_number (transaction_number);
+	ope->category_number = gsb_data_transaction_get_category_number (transaction_number);
+	ope->sub_category_number = gsb_data_transaction_get_sub_category_number (transaction_number);
+	ope->budgetary_number = gsb_data_transaction_get_budgetary_number (transaction_number);
+	ope->sub_budgetary_number = gsb_data_transaction_get_sub_budgetary_number (transaction_number);
+	ope->payment_number = gsb_data_transaction_get_method_of_payment_number (transaction_number);
+	ope->reconcile_number = gsb_data_transaction_get_reconcile_number (transaction_number);
+	ope->financial_year_number = gsb_data_transaction_get_financial_year_number (transaction_number);
+	ope->marked = gsb_data_transaction_get_marked_transaction (transaction_number);
+	ope->is_split = gsb_data_transaction_get_split_of_transaction (transaction_number);
+	ope->is_child = gsb_data_transaction_get_mother_transaction_number (transaction_number) != 0;
+	ope->amount = gsb_data_transaction_get_amount (transaction_number);
+
+	ope->contra_number = gsb_data_transaction_get_contra_transaction_number (transaction_number);
+	if (ope->contra_number > 0)
+	{
+		ope->contra_account_number = gsb_data_transaction_get_contra_transaction_account (transaction_number);
+		ope->contra_account_kind = gsb_data_account_get_kind (ope->contra_account_number);
+	}
+
+	date = gsb_data_transaction_get_date (transaction_number);
+	if (date && g_date_valid (date))
+		ope->julian = g_date_get_julian (date);
+	date = gsb_data_transaction_get_value_date (transaction_number);
+	if (date && g_date_valid (date))
+		ope->value_julian = g_date_get_julian (date);
+
+	/* le moyen de paiement est comparé par son nom, le résultat est gardé par la sélection */
+	if (selection->payment_names)
+		ope->payment_accepted = etats_calculs_selection_check_payment (selection, ope->payment_number);
+
+	if (calcul->split_by_category && ope->category_number)
+		ope->category_is_debit = gsb_data_category_get_type (ope->category_number) != 0;
+
+	/* les tests de montant se font dans la devise du compte */
+	if (selection->amount_filters)
+		ope->account_amount = gsb_data_transaction_get_adjusted_amount (transaction_number, -1);
+
+	for (field = 0; field < ETATS_FIELDS; field++)
+		if (calcul->fields[field])
+			calcul->fields[field][index] = etats_calculs_ope_copy_text (calcul, field, transaction_number);
+}
+
+/**
+ * copie les opés candidates de l'état, dans le thread principal
+ * on ne fait qu'un seul passage sur la liste des opés pour les répartir par compte,
+ * puis on copie les opés compte par compte, dans l'ordre de la liste des comptes
+ *
+ * \param calcul
+ *
+ * \return
+ **/
+static void etats_calculs_calcul_copy (EtatsCalcul *calcul)
+{
+	EtatsSelection *selection;
+    GSList *list_tmp_transactions;
+    GSList *tmp_list;
+	guint index = 0;
+	gint field;
+
+	selection = calcul->selection;
+	if (selection->search_last_numbers)
+	{
+		dernier_chq = 0;
+		dernier_pc = 0;
+		dernier_no_rappr = 0;
+	}
+
+	/* on répartit les opés des comptes de l'état, dans l'ordre de la liste des opés */
+	if (selection->ignore_archives)
+		list_tmp_transactions = gsb_data_transaction_get_transactions_list ();
+	else
+		list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
+
+	while (list_tmp_transactions)
+	{
+		GPtrArray *account_transactions;
+		gint transaction_number_tmp;
+
+		transaction_number_tmp = gsb_data_transaction_get_transaction_number (list_tmp_transactions->data);
+		account_transactions = g_hash_table_lookup (selection->accounts,
+													GINT_TO_POINTER (gsb_data_transaction_get_account_number
+																	 (transaction_number_tmp)));
+		if (account_transactions)
+		{
+			g_ptr_array_add (account_transactions, list_tmp_transactions->data);
+			calcul->nbre_candidates++;
+
+			/* si on a utilisé "le plus grand" dans la recherche de texte, c'est ici qu'on recherche */
+			/* les plus grands no de chq, de rappr et de pc dans les comptes choisis */
+			if (selection->search_last_numbers)
+				etats_calculs_update_last_numbers (transaction_number_tmp);
+		}
+		list_tmp_transactions = list_tmp_transactions->next;
+	}
+
+	calcul->opes = g_new0 (EtatsCalculOpe, calcul->nbre_candidates);
+	calcul->strings = g_string_chunk_new (4096);
+	for (field = 0; field < ETATS_FIELDS; field++)
+		if (calcul->fields_used & (1 << field))
+			calcul->fields[field] = g_new0 (const gchar *, calcul->nbre_candidates);
+
+	/* on copie les opés compte par compte, dans l'ordre de la liste des comptes */
+	tmp_list = gsb_data_account_get_list_accounts ();
+	while (tmp_list)
+	{
+		GPtrArray *account_transactions;
+		guint i;
+
+		account_transactions = g_hash_table_lookup (selection->accounts,
+													GINT_TO_POINTER (gsb_data_account_get_no_account
+																	 (tmp_list->data)));
+		for (i = 0; account_transactions && i < account_transactions->len; i++)
+			etats_calculs_ope_copy (calcul, index++, g_ptr_array_index (account_transactions, i));
+
+		tmp_list = tmp_list->next;
+	}
+}
+
+/**
+ * partage la copie des opés en parties contiguës
+ *
+ * \param calcul
+ * \param nbre_parts
+ *
+ * \return
+ **/
+static void etats_calculs_calcul_set_parts (EtatsCalcul *calcul,
+											guint nbre_parts)
+{
+	guint i;
+
+	calcul->nbre_parts = nbre_parts;
+	for (i = 0; i < nbre_parts; i++)
+	{
+		EtatsCalculPart *part;
+
+		part = &calcul->parts[i];
+		part->calcul = calcul;
+		part->first = (guint) ((guint64) calcul->nbre_candidates * i / nbre_parts);
+		part->last = (guint) ((guint64) calcul->nbre_candidates * (i + 1) / nbre_parts);
+		part->total_partie[0] = null_real;
+		part->total_partie[1] = null_real;
+		part->total_general = null_real;
+	}
+}
+
+/**
+ * met à jour l'avancement de l'étape en cours, toutes les 1024 opés
+ *
+ * \param calcul
+ * \param nbre_done		opés traitées par la partie
+ *
+ * \return FALSE si le calcul a été annulé
+ **/
+static gboolean etats_calculs_part_step (EtatsCalcul *calcul,
+										 guint nbre_done)
+{
+	if ((nbre_done & 0x3ff) != 0x3ff)
+		return TRUE;
+
+	g_atomic_int_add (&calcul->progress_done, 0x400);
+
+	return !g_cancellable_is_cancelled (calcul->cancellable);
+}
+
+/**
+ * sélectionne les opés d'une partie de la copie
+ * peut être appelée dans un thread
+ *
+ * \param part
+ *
+ * \return
+ **/
+static void etats_calculs_part_select (EtatsCalculPart *part)
+{
+	EtatsCalcul *calcul;
+	guint i;
+
+	calcul = part->calcul;
+	for (i = part->first; i < part->last; i++)
+	{
+		if (!etats_calculs_part_step (calcul, i - part->first))
+			return;
+
+		if (etats_calculs_selection_accept (calcul, &calcul->opes[i]))
+			part->selected = g_slist_prepend (part->selected, &calcul->opes[i]);
+	}
+	part->selected = g_slist_reverse (part->selected);
+}
+
+/**
+ * sépare si besoin les opés sélectionnées d'une partie en revenus et dépenses,
+ * calcule les totaux de la partie puis classe ces listes dans l'ordre demandé par l'état
+ * peut être appelée dans un thread
+ *
+ * \param part
+ *
+ * \return
+ **/
+static void etats_calculs_part_classe (EtatsCalculPart *part)
+{
+	EtatsCalcul *calcul;
+	GArray *general_mantissas;
+	GArray *partie_mantissas[2];
+	GSList *pointeur_opes;
+	guint nbre_done = 0;
+	gint partie_exponent;
+	gint i;
+
+	calcul = part->calcul;
+
+	/* les montants des totaux sont additionnés à la fin par gsb_real_sum_mantissas () */
+	if (calcul->partie_in_categ_currency)
+		partie_exponent = calcul->exponent_categ;
+	else
+		partie_exponent = calcul->exponent_generale;
+	general_mantissas = g_array_new (FALSE, FALSE, sizeof (gint64));
+	for (i = 0; i < 2; i++)
+		partie_mantissas[i] = g_array_new (FALSE, FALSE, sizeof (gint64));
+
+	pointeur_opes = part->selected;
+	while (pointeur_opes)
+	{
+		EtatsCalculOpe *ope;
+		gint depense = 0;
+
+		if (!etats_calculs_part_step (calcul, nbre_done++))
+			break;
+
+		ope = pointeur_opes->data;
+
+		/* si le classement racine est la catégorie, on sépare par catégorie de revenu ou de dépense */
+		/* s'il n'y a pas de catég, c'est un virement ou une ventilation, on sépare par montant */
+		if (calcul->split_credit_debit)
+		{
+			if (calcul->split_by_category && ope->category_number)
+				depense = ope->category_is_debit;
+			else
+				depense = ope->amount.mantissa < 0;
+		}
+		part->liste_ope[depense] = g_slist_prepend (part->liste_ope[depense], ope);
+
+		/* totaux de la partie, ajoutés à ceux des autres parties à la fin du calcul */
+		gsb_real_append_mantissa (general_mantissas, ope->general_amount, calcul->exponent_generale);
+		if (calcul->partie_in_categ_currency)
+			gsb_real_append_mantissa (partie_mantissas[depense], ope->categ_amount, partie_exponent);
+		else
+			gsb_real_append_mantissa (partie_mantissas[depense], ope->general_amount, partie_exponent);
+
+		pointeur_opes = pointeur_opes->next;
+	}
+
+	part->total_general = gsb_real_sum_mantissas ((gint64 *) general_mantissas->data,
+												  general_mantissas->len,
+												  calcul->exponent_generale);
+	g_array_free (general_mantissas, TRUE);
+	for (i = 0; i < 2; i++)
+	{
+		part->total_partie[i] = gsb_real_sum_mantissas ((gint64 *) partie_mantissas[i]->data,
+														partie_mantissas[i]->len,
+														partie_exponent);
+		g_array_free (partie_mantissas[i], TRUE);
+	}
+
+	if (pointeur_opes)
+		return;
+
+	/* on va maintenant classer ces 2 listes dans l'ordre adéquat */
+	for (i = 0; i < 2; i++)
+		part->liste_ope[i] = g_slist_sort_with_data (g_slist_reverse (part->liste_ope[i]),
+													 (GCompareDataFunc) classement_liste_opes_etat,
+													 calcul);
+}
+
+/**
+ * fonction des threads du calcul : calcule une partie de la copie
+ *
+ * \param task
+ * \param source_object
+ * \param task_data		la partie
+ * \param cancellable
+ *
+ * \return
+ **/
+static void etats_calculs_part_thread (GTask *task,
+									   gpointer source_object,
+									   gpointer task_data,
+									   GCancellable *cancellable)
+{
+	EtatsCalculPart *part;
+
+	part = task_data;
+	part->calcul->part_func (part);
+	g_task_return_boolean (task, TRUE);
+}
+
+/**
+ * appelée dans le thread principal à la fin du thread d'une partie
+ *
+ * \param source_object
+ * \param result
+ * \param user_data		le calcul
+ *
+ * \return
+ **/
+static void etats_calculs_part_thread_done (GObject *source_object,
+											GAsyncResult *result,
+											gpointer user_data)
+{
+	EtatsCalcul *calcul;
+
+	calcul = user_data;
+	g_task_propagate_boolean (G_TASK (result), NULL);
+	calcul->nbre_running--;
+}
+
+/**
+ * transmet l'avancement de l'étape en cours à la fonction de progression
+ *
+ * \param calcul
+ *
+ * \return G_SOURCE_CONTINUE
+ **/
+static gboolean etats_calculs_progress_update (EtatsCalcul *calcul)
+{
+	gdouble fraction;
+
+	fraction = calcul->progress_start;
+	if (calcul->progress_total)
+		fraction += calcul->progress_span * MIN (1.0, (gdouble) g_atomic_int_get (&calcul->progress_done)
+												 / calcul->progress_total);
+
+	calcul->progress_func (fraction, calcul->progress_data);
+
+	return G_SOURCE_CONTINUE;
+}
+
+/**
+ * lance une étape du calcul sur toutes les parties de la copie
+ * s'il y a une fonction de progression, chaque partie est calculée par un thread
+ * et on fait tourner la boucle principale jusqu'à la fin des threads,
+ * sinon les parties sont calculées ici
+ *
+ * \param calcul
+ * \param part_func		fonction qui calcule une partie
+ * \param total			nombre d'opés traitées par l'étape
+ * \param start			avancement au début de l'étape
+ * \param span			part de l'étape dans l'avancement du calcul
+ *
+ * \return
+ **/
+static void etats_calculs_calcul_run_parts (EtatsCalcul *calcul,
+											void (*part_func) (EtatsCalculPart *part),
+											guint total,
+											gdouble start,
+											gdouble span)
+{
+	guint timeout_id;
+	guint i;
+
+	calcul->part_func = part_func;
+	if (!calcul->progress_func)
+	{
+		for (i = 0; i < calcul->nbre_parts; i++)
+			part_func (&calcul->parts[i]);
+
+		return;
+	}
+
+	calcul->progress_done = 0;
+	calcul->progress_total = total;
+	calcul->progress_start = start;
+	calcul->progress_span = span;
+	timeout_id = g_timeout_add (100, (GSourceFunc) etats_calculs_progress_update, calcul);
+
+	calcul->nbre_running = calcul->nbre_parts;
+	for (i = 0; i < calcul->nbre_parts; i++)
+	{
+		GTask *task;
+
+		task = g_task_new (NULL, calcul->cancellable, etats_calculs_part_thread_done, calcul);
+		g_task_set_task_data (task, &calcul->parts[i], NULL);
+		g_task_run_in_thread (task, etats_calculs_part_thread);
+		g_object_unref (task);
+	}
+
+	while (calcul->nbre_running)
+		g_main_context_iteration (NULL, TRUE);
+
+	g_source_remove (timeout_id);
+}
+
+/**
+ * calcule dans le thread principal les montants des opés sélectionnées
+ * dans les devises de l'état : le change peut demander un taux à l'utilisateur
+ *
+ * \param calcul
+ *
+ * \return
+ **/
+static void etats_calculs_calcul_convert (EtatsCalcul *calcul)
+{
+	guint i;
+
+	for (i = 0; i < calcul->nbre_parts; i++)
+	{
+		GSList *pointeur_opes;
+
+		pointeur_opes = calcul->parts[i].selected;
+		while (pointeur_opes)
+		{
+			EtatsCalculOpe *ope;
+			gint transaction_number;
+
+			ope = pointeur_opes->data;
+			transaction_number = ope->transaction_number;
+			calcul->nbre_opes++;
+
+			ope->general_amount = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
+																						 calcul->devise_generale,
+																						 -1);
+			if (calcul->category_used || calcul->partie_in_categ_currency)
+			{
+				if (calcul->devise_categ == calcul->devise_generale)
+					ope->categ_amount = ope->general_amount;
+				else
+					ope->categ_amount = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
+																							   calcul->devise_categ,
+																							   -1);
+			}
+			if (calcul->budget_used)
+			{
+				if (calcul->devise_ib == calcul->devise_generale)
+					ope->ib_amount = ope->general_amount;
+				else
+					ope->ib_amount = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
+																							calcul->devise_ib,
+																							-1);
+			}
+			if (calcul->payee_used)
+			{
+				if (calcul->devise_tiers == calcul->devise_generale)
+					ope->payee_amount = ope->general_amount;
+				else
+					ope->payee_amount = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
+																							   calcul->devise_tiers,
+																							   -1);
+			}
+			if (calcul->account_show_amount && !calcul->selection->amount_filters)
+				ope->account_amount = gsb_data_transaction_get_adjusted_amount (transaction_number, -1);
+
+			pointeur_opes = pointeur_opes->next;
+		}
+	}
+}
+
+/**
+ * fusionne 2 listes d'opés classées, à égalité les opés de la 1ère liste passent en premier
+ *
+ * \param list_1
+ * \param list_2
+ * \param calcul
+ *
+ * \return la liste fusionnée
+ **/
+static GSList *etats_calculs_merge_lists (GSList *list_1,
+										  GSList *list_2,
+										  EtatsCalcul *calcul)
+{
+	GSList head;
+	GSList *tail;
+
+	head.next = NULL;
+	tail = &head;
+	while (list_1 && list_2)
+	{
+		if (classement_liste_opes_etat (list_1->data, list_2->data, calcul) <= 0)
+		{
+			tail->next = list_1;
+			list_1 = list_1->next;
+		}
+		else
+		{
+			tail->next = list_2;
+			list_2 = list_2->next;
+		}
+		tail = tail->next;
+	}
+	tail->next = list_1 ? list_1 : list_2;
+
+	return head.next;
+}
+
+/**
+ * retire d'une liste les opés supprimées pendant que la boucle principale tournait
+ *
+ * \param list
+ *
+ * \return la liste
+ **/
+static GSList *etats_calculs_remove_deleted (GSList *list)
+{
+	GSList *tmp_list;
+
+	tmp_list = list;
+	while (tmp_list)
+	{
+		GSList *next;
+		EtatsCalculOpe *ope;
+
+		next = tmp_list->next;
+		ope = tmp_list->data;
+		if (gsb_data_transaction_get_pointer_of_transaction (ope->transaction_number) != ope->transaction)
+			list = g_slist_delete_link (list, tmp_list);
+
+		tmp_list = next;
+	}
+
+	return list;
+}
+
+/**
+ * fusionne dans le thread principal les listes classées et les totaux des parties
+ *
+ * \param calcul
+ *
+ * \return
+ **/
+static void etats_calculs_calcul_merge (EtatsCalcul *calcul)
+{
+	guint i;
+
+	calcul->total_partie[0] = null_real;
+	calcul->total_partie[1] = null_real;
+	calcul->total_general = null_real;
+	for (i = 0; i < calcul->nbre_parts; i++)
+	{
+		EtatsCalculPart *part;
+
+		part = &calcul->parts[i];
+		calcul->liste_ope_revenus = etats_calculs_merge_lists (calcul->liste_ope_revenus, part->liste_ope[0], calcul);
+		calcul->liste_ope_depenses = etats_calculs_merge_lists (calcul->liste_ope_depenses, part->liste_ope[1], calcul);
+		part->liste_ope[0] = NULL;
+		part->liste_ope[1] = NULL;
+
+		calcul->total_partie[0] = gsb_real_add (calcul->total_partie[0], part->total_partie[0]);
+		calcul->total_partie[1] = gsb_real_add (calcul->total_partie[1], part->total_partie[1]);
+		calcul->total_general = gsb_real_add (calcul->total_general, part->total_general);
+	}
+
+	/* la boucle principale a tourné pendant le calcul dans les threads */
+	if (calcul->progress_func)
+	{
+		calcul->liste_ope_revenus = etats_calculs_remove_deleted (calcul->liste_ope_revenus);
+		calcul->liste_ope_depenses = etats_calculs_remove_deleted (calcul->liste_ope_depenses);
+	}
+}
+
+/**
+ * montre l'avancement du calcul dans la barre de progression
+ *
+ * \param fraction
+ * \param progress_bar
+ *
+ * \return
+ **/
+static void etats_calculs_progress_bar_set (gdouble fraction,
+											GtkWidget *progress_bar)
+{
+	gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (progress_bar), fraction);
+}
+
+/**
+ * crée la boîte de dialogue qui montre l'avancement du calcul et permet de l'annuler
+ *
+ * \param calcul
+ *
+ * \return la boîte de dialogue, à détruire à la fin du calcul
+ **/
+static GtkWidget *etats_calculs_progress_dialog_new (EtatsCalcul *calcul)
+{
+	GtkWidget *dialog;
+	GtkWidget *content_area;
+	GtkWidget *progress_bar;
+
+	dialog = gtk_dialog_new_with_buttons (_("Computing the report"),
+										  GTK_WINDOW (grisbi_app_get_active_window (NULL)),
+										  GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+										  _("Cancel"), GTK_RESPONSE_CANCEL,
+										  NULL);
+	gtk_window_set_default_size (GTK_WINDOW (dialog), 350, -1);
+
+	content_area = gtk_dialog_get_content_area (GTK_DIALOG (dialog));
+	gtk_container_set_border_width (GTK_CONTAINER (content_area), BOX_BORDER_WIDTH);
+
+	progress_bar = gtk_progress_bar_new ();
+	gtk_box_pack_start (GTK_BOX (content_area), progress_bar, FALSE, FALSE, MARGIN_BOX);
+
+	calcul->cancellable = g_cancellable_new ();
+	calcul->progress_func = (EtatsCalculProgress) etats_calculs_progress_bar_set;
+	calcul->progress_data = progress_bar;
+	g_signal_connect_swapped (G_OBJECT (dialog),
+							  "response",
+							  G_CALLBACK (g_cancellable_cancel),
+							  calcul->cancellable);
+
+	gtk_widget_show_all (dialog);
+
+	return dialog;
+}
+
+/**
+ * calcule l'état à partir de la copie des opés : sélection, séparation en revenus et dépenses,
+ * totaux et classement
+ * la copie est faite dans le thread principal, les threads ne lisent que la copie ;
+ * entre la sélection et le classement, les montants des opés sélectionnées sont
+ * calculés dans les devises de l'état dans le thread principal
+ *
+ * \param calcul
+ *
+ * \return FALSE si le calcul a été annulé
+ **/
+static gboolean etats_calculs_calcul_compute (EtatsCalcul *calcul)
+{
+	GtkWidget *dialog = NULL;
+	guint nbre_parts = 1;
+	gint64 trace_start;
+
+	trace_start = gsb_trace_begin ();
+	etats_calculs_calcul_copy (calcul);
+
+	/* pour les gros états, le calcul est partagé entre plusieurs threads */
+	if (calcul->nbre_candidates >= ETATS_THREAD_MIN_OPES)
+	{
+		nbre_parts = CLAMP (g_get_num_processors (), 1, ETATS_MAX_PARTS);
+		dialog = etats_calculs_progress_dialog_new (calcul);
+	}
+	etats_calculs_calcul_set_parts (calcul, nbre_parts);
+
+	/* la sélection compte pour 80 % de l'avancement */
+	etats_calculs_calcul_run_parts (calcul, etats_calculs_part_select, calcul->nbre_candidates, 0.0, 0.8);
+	if (!g_cancellable_is_cancelled (calcul->cancellable))
+	{
+		etats_calculs_calcul_convert (calcul);
+		etats_calculs_calcul_run_parts (calcul, etats_calculs_part_classe, calcul->nbre_opes, 0.8, 0.2);
+	}
+
+	if (dialog)
+		gtk_widget_destroy (dialog);
+
+	if (g_cancellable_is_cancelled (calcul->cancellable))
+		return FALSE;
+
+	etats_calculs_calcul_merge (calcul);
+	gsb_trace_count ("report_transactions", calcul->nbre_candidates);
+	gsb_trace_end ("report_selection", trace_start);
+
+	return TRUE;
+}
+
+/**
+ * indique qu'un champ de texte doit être copié
+ *
+ * \param calcul
+ * \param field
+ *
+ * \return
+ **/
+static void etats_calculs_calcul_use_field (EtatsCalcul *calcul,
+											gint field)
+{
+	calcul->fields_used |= 1 << field;
+}
+
+/**
+ * crée le calcul d'un état : compile la sélection et lit les paramètres de l'état
+ * pour que les threads n'aient pas à appeler gsb_data_report
+ *
+ * \param report_number
+ * \param classement	TRUE si les opés sélectionnées seront classées
+ *
+ * \return le calcul à libérer avec etats_calculs_calcul_free ()
+ **/
+static EtatsCalcul *etats_calculs_calcul_new (gint report_number,
+											  gboolean classement)
+{
+	EtatsCalcul *calcul;
+	EtatsSelection *selection;
+	GSList *tmp_list;
+	guint i;
+
+	calcul = g_malloc0 (sizeof (EtatsCalcul));
+	calcul->report_number = report_number;
+	calcul->selection = selection = etats_calculs_selection_new (report_number);
+
+	/* textes utilisés par les tests de texte */
+	for (i = 0; selection->text_filters && i < selection->text_filters->len; i++)
+	{
+		gint field;
+
+		field = g_array_index (selection->text_filters, EtatsTextFilter, i).field;
+		if (field >= 0 && field < ETATS_TEXT_FIELDS)
+			etats_calculs_calcul_use_field (calcul, field);
+	}
+
+	if (!classement)
+		return calcul;
+
+	/* paramètres du classement */
+	tmp_list = gsb_data_report_get_sorting_type_list (report_number);
+	calcul->nbre_sorting_types = g_slist_length (tmp_list);
+	calcul->sorting_types = g_new0 (gint, calcul->nbre_sorting_types);
+	for (i = 0; tmp_list; i++, tmp_list = tmp_list->next)
+		calcul->sorting_types[i] = GPOINTER_TO_INT (tmp_list->data);
+
+	calcul->sorting_report = gsb_data_report_get_sorting_report (report_number);
+	calcul->category_used = gsb_data_report_get_category_used (report_number);
+	calcul->sub_category_used = gsb_data_report_get_category_show_sub_category (report_number);
+	calcul->budget_used = gsb_data_report_get_budget_used (report_number);
+	calcul->sub_budget_used = gsb_data_report_get_budget_show_sub_budget (report_number);
+	calcul->group_reports = gsb_data_report_get_account_group_reports (report_number);
+	calcul->payee_used = gsb_data_report_get_payee_used (report_number);
+	calcul->account_show_amount = gsb_data_report_get_account_show_amount (report_number);
+	calcul->split_credit_debit = gsb_data_report_get_split_credit_debit (report_number);
+	calcul->split_by_category = calcul->nbre_sorting_types && calcul->sorting_types[0] == 1;
+
+	/* le total d'une partie est dans la devise des catégories si on sépare par période ou par exercice */
+	calcul->partie_in_categ_currency = gsb_data_report_get_period_split (report_number)
+		|| gsb_data_report_get_financial_year_split (report_number);
+
+	calcul->devise_categ = gsb_data_report_get_category_currency (report_number);
+	calcul->devise_ib = gsb_data_report_get_budget_currency (report_number);
+	calcul->devise_tiers = gsb_data_report_get_payee_currency (report_number);
+	calcul->devise_generale = gsb_data_report_get_currency_general (report_number);
+	calcul->exponent_categ = gsb_data_currency_get_floating_point (calcul->devise_categ);
+	calcul->exponent_generale = gsb_data_currency_get_floating_point (calcul->devise_generale);
+
+	/* textes utilisés par le classement */
+	for (i = 0; i < calcul->nbre_sorting_types; i++)
+	{
+		switch (calcul->sorting_types[i])
+		{
+			case 1:
+				if (calcul->category_used)
+				{
+					etats_calculs_calcul_use_field (calcul, 2);
+					etats_calculs_calcul_use_field (calcul, ETATS_FIELD_CONTRA);
+				}
+				break;
+
+			case 2:
+				if (calcul->category_used && calcul->sub_category_used)
+					etats_calculs_calcul_use_field (calcul, ETATS_FIELD_CATEG_FULL);
+				break;
+
+			case 3:
+				if (calcul->budget_used)
+					etats_calculs_calcul_use_field (calcul, 4);
+				break;
+
+			case 4:
+				if (calcul->budget_used && calcul->sub_budget_used)
+					etats_calculs_calcul_use_field (calcul, 5);
+				break;
+
+			case 5:
+				if (calcul->group_reports)
+					etats_calculs_calcul_use_field (calcul, ETATS_FIELD_ACCOUNT);
+				break;
+
+			case 6:
+				if (calcul->payee_used)
+					etats_calculs_calcul_use_field (calcul, 0);
+				break;
+		}
+	}
+
+	switch (calcul->sorting_report)
+	{
+		case 3:
+			/* tiers */
+			etats_calculs_calcul_use_field (calcul, 0);
+			break;
+
+		case 4:
+			/* categ : ss-categ */
+			etats_calculs_calcul_use_field (calcul, ETATS_FIELD_CATEG_FULL);
+			break;
+
+		case 5:
+			/* ib : ss-ib */
+			etats_calculs_calcul_use_field (calcul, 5);
+			break;
+
+		case 6:
+			/* notes */
+			etats_calculs_calcul_use_field (calcul, 6);
+			break;
+
+		case 7:
+			/* moyen de paiement */
+			etats_calculs_calcul_use_field (calcul, ETATS_FIELD_PAYMENT);
+			break;
+
+		case 8:
+			/* chq */
+			etats_calculs_calcul_use_field (calcul, 9);
+			break;
+
+		case 9:
+			/* pc */
+			etats_calculs_calcul_use_field (calcul, 8);
+			break;
+
+		case 10:
+			/* ref bancaires */
+			etats_calculs_calcul_use_field (calcul, 7);
+			break;
+
+		case 11:
+			/* rappr */
+			etats_calculs_calcul_use_field (calcul, 10);
+			break;
+	}
+
+	return calcul;
+}
+
+/**
+ * libère le calcul d'un état, la copie des opés et les listes d'opés
+ *
+ * \param calcul
+ *
+ * \return
+ **/
+static void etats_calculs_calcul_free (EtatsCalcul *calcul)
+{
+	guint i;
+
+	etats_calculs_selection_free (calcul->selection);
+
+	for (i = 0; i < calcul->nbre_parts; i++)
+	{
+		g_slist_free (calcul->parts[i].selected);
+		g_slist_free (calcul->parts[i].liste_ope[0]);
+		g_slist_free (calcul->parts[i].liste_ope[1]);
+	}
+	g_slist_free (calcul->liste_ope_revenus);
+	g_slist_free (calcul->liste_ope_depenses);
+
+	for (i = 0; i < ETATS_FIELDS; i++)
+		g_free (calcul->fields[i]);
+	if (calcul->strings)
+		g_string_chunk_free (calcul->strings);
+	g_free (calcul->opes);
+	g_free (calcul->sorting_types);
+
+	if (calcul->cancellable)
+		g_object_unref (calcul->cancellable);
+
+	g_free (calcul);
+}
+
+/**
+ * retourne la définition de l'état, à partir de sa sauvegarde dans le fichier,
+ * suivie du jour courant dont dépendent les dates relatives (mois en cours,
+ * 30 derniers jours, exercice courant...)
+ * sert à savoir si l'état affiché peut être repris du cache
+ *
+ * \param report_number
+ *
+ * \return la définition à libérer, NULL si l'état ne peut pas être gardé
+ * (état de recherche ou pas l'état courant)
+ **/
+static gchar *etats_calculs_get_definition (gint report_number)
+{
+	GsbFileSaveWriter *writer;
+	GDate *today;
+	gchar *definition;
+	gchar *tmp_str;
+	gulong length;
+
+	/* gsb_file_save_report_part () ne sait sauver que l'état courant */
+	if (report_number != gsb_gui_navigation_get_current_report ()
+		|| gsb_data_report_get_search_report (report_number))
+		return NULL;
+
+	writer = gsb_file_save_writer_new (NULL, FALSE);
+	gsb_file_save_report_part (writer, TRUE);
+	tmp_str = gsb_file_save_writer_free_to_memory (writer, &length);
+	if (!tmp_str || !length)
+	{
+		g_free (tmp_str);
+		return NULL;
+	}
+
+	today = gdate_today ();
+	definition = g_strdup_printf ("%s\n%u", tmp_str, g_date_get_julian (today));
+	g_date_free (today);
+	g_free (tmp_str);
+
+	return definition;
+}
+
+/**
+ * classe les opés de l'état par groupe et affiche l'état
+ * les montants des opés et les totaux ont été calculés avec le classement
+ *
+ * \param calcul			calcul de l'état, NULL pour un état vide
+ * \param affichage
+ * \param filename
+ *
+ * \return
+ **/
+static void etape_finale_affichage_etat (EtatsCalcul *calcul,
+										 struct EtatAffichage *affichage,
+										 gchar *filename)
+{
+	GSList *liste_ope_revenus = NULL;
+	GSList *liste_ope_depenses = NULL;
+	GSList *pointeur_opes;
+	GSList *pointeur_sort_list;
+    const gchar *decalage_base;
+	const gchar *decalage_categ;
+	const gchar *decalage_sous_categ;
+	const gchar *decalage_ib;
+    const gchar *decalage_sous_ib;
+    const gchar *decalage_compte;
+    const gchar *decalage_tiers;
+    gint i;
+    gint ligne;
+    gint current_report_number;
+	gint categ_used = 0;
+	gint sous_categ_used = 0;
+	gint group_reports = 0;
+	gint ib_used = 0;
 	gint sous_ib_used = 0;
 	gint payee_used = 0;
     GsbReal total_general;
-    GsbReal total_partie;
 
 	current_report_number = gsb_gui_navigation_get_current_report ();
+	if (calcul)
+	{
+		liste_ope_revenus = calcul->liste_ope_revenus;
+		liste_ope_depenses = calcul->liste_ope_depenses;
+	}
 
 	/* initialisations variables permanentes */
 	categ_used = gsb_data_report_get_category_used (current_report_number);
@@ -1221,76 +3097,9 @@ static void etape_finale_affichage_etat (GSList *ope_selectionnees,
 	group_reports = gsb_data_report_get_account_group_reports (current_report_number);
 	payee_used = gsb_data_report_get_payee_used (current_report_number);
 
-    /* soit on sépare en revenus et dépenses, soit non */
-    liste_ope_revenus = NULL;
-    liste_ope_depenses = NULL;
-    pointeur_opes = ope_selectionnees;
+    /* les opés sont déjà séparées en revenus et dépenses et classées */
     pointeur_sort_list = gsb_data_report_get_sorting_type_list (current_report_number);
 
-    if (gsb_data_report_get_split_credit_debit (current_report_number))
-    {
-		/* on commence par séparer la liste revenus et de dépenses */
-		/* si le classement racine est la catégorie, on sépare par catégorie de revenu ou de dépense */
-		/* si c'est un autre, on sépare par montant positif ou négatif */
-		while (pointeur_opes)
-		{
-			gint transaction_number;
-
-			transaction_number = gsb_data_transaction_get_transaction_number (pointeur_opes->data);
-
-			if (GPOINTER_TO_INT (pointeur_sort_list->data) == 1)
-			{
-				/* le classement racine est la catégorie */
-				/* s'il n'y a pas de catég, c'est un virement ou une ventilation */
-				/* dans ce cas, on classe en fonction du montant */
-				gint category_number;
-
-				if ((category_number = gsb_data_transaction_get_category_number (transaction_number)))
-				{
-					if (gsb_data_category_get_type (category_number))
-						liste_ope_depenses = g_slist_append (liste_ope_depenses,
-															 gsb_data_transaction_get_pointer_of_transaction
-															 (transaction_number));
-					else
-						liste_ope_revenus = g_slist_append (liste_ope_revenus,
-															gsb_data_transaction_get_pointer_of_transaction
-															(transaction_number));
-				}
-				else
-				{
-					if (gsb_data_transaction_get_amount (transaction_number).mantissa < 0)
-						liste_ope_depenses = g_slist_append (liste_ope_depenses,
-															 gsb_data_transaction_get_pointer_of_transaction
-															 (transaction_number));
-					else
-					liste_ope_revenus = g_slist_append (liste_ope_revenus,
-														gsb_data_transaction_get_pointer_of_transaction
-														(transaction_number));
-				}
-			}
-			else
-			{
-				/* le classement racine n'est pas la catég, on sépare en fonction du montant */
-				if (gsb_data_transaction_get_amount (transaction_number).mantissa < 0)
-					liste_ope_depenses = g_slist_append (liste_ope_depenses,
-														 gsb_data_transaction_get_pointer_of_transaction
-														 (transaction_number));
-				else
-					liste_ope_revenus = g_slist_append (liste_ope_revenus,
-														gsb_data_transaction_get_pointer_of_transaction
-														(transaction_number));
-			}
-			pointeur_opes = pointeur_opes->next;
-		}
-    }
-    else
-		/* on ne veut pas séparer en revenus et dépenses, on garde juste la liste d'opé telle quelle */
-		liste_ope_revenus = ope_selectionnees;
-
-	/* on va maintenant classer ces 2 listes dans l'ordre adéquat */
-    liste_ope_depenses = g_slist_sort (liste_ope_depenses, (GCompareFunc) classement_liste_opes_etat);
-    liste_ope_revenus = g_slist_sort (liste_ope_revenus, (GCompareFunc) classement_liste_opes_etat);
-
     /* calcul du décalage pour chaque classement */
     /* c'est une chaine vide qu'on ajoute devant le nom du classement (tiers, ib ...) */
     /* on met 2 espaces par décalage */
@@ -1420,14 +3229,14 @@ pas_decalage:
     nom_compte_en_cours = NULL;
     nom_tiers_en_cours = NULL;
 
-    if (!etat_affiche_initialise (ope_selectionnees, filename))
+    if (!etat_affiche_initialise (liste_ope_revenus ? liste_ope_revenus : liste_ope_depenses, filename))
     {
 		return;
     }
 
     /* on commence à remplir le tableau */
     /* on met le titre */
-    total_general = null_real;
+    total_general = calcul ? calcul->total_general : null_real;
     nb_ope_general_etat = 0;
     ligne = etat_affiche_affiche_titre (0);
 
@@ -1465,7 +3274,6 @@ pas_decalage:
 		montant_tiers_etat = null_real;
 		montant_periode_etat = null_real;
 		montant_exo_etat = null_real;
-		total_partie = null_real;
 		date_debut_periode = NULL;
 		exo_en_cours_etat = -1;
 
@@ -1540,10 +3348,11 @@ pas_decalage:
 		/* on commence la boucle qui fait le tour de chaque opé */
 		while (pointeur_opes)
 		{
+			EtatsCalculOpe *ope;
 			gint transaction_number;
-			GsbReal montant;
 
-			transaction_number = gsb_data_transaction_get_transaction_number (pointeur_opes->data);
+			ope = pointeur_opes->data;
+			transaction_number = ope->transaction_number;
 
 			pointeur_sort_list = gsb_data_report_get_sorting_type_list (current_report_number);
 
@@ -1598,11 +3407,8 @@ pas_decalage:
 			/* calcule le montant de la categ */
 			if (categ_used)
 			{
-				montant = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
-																				 devise_categ_etat,
-																				 -1);
-				montant_categ_etat = gsb_real_add (montant_categ_etat, montant);
-				montant_sous_categ_etat = gsb_real_add (montant_sous_categ_etat, montant);
+				montant_categ_etat = gsb_real_add (montant_categ_etat, ope->categ_amount);
+				montant_sous_categ_etat = gsb_real_add (montant_sous_categ_etat, ope->categ_amount);
 				nb_ope_categ_etat++;
 				nb_ope_sous_categ_etat++;
 			}
@@ -1610,11 +3416,8 @@ pas_decalage:
 			/* calcule le montant de l'ib */
 			if (ib_used)
 			{
-				montant = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
-																				 devise_ib_etat,
-																				 -1);
-				montant_ib_etat = gsb_real_add (montant_ib_etat, montant);
-				montant_sous_ib_etat = gsb_real_add (montant_sous_ib_etat, montant);
+				montant_ib_etat = gsb_real_add (montant_ib_etat, ope->ib_amount);
+				montant_sous_ib_etat = gsb_real_add (montant_sous_ib_etat, ope->ib_amount);
 				nb_ope_ib_etat++;
 				nb_ope_sous_ib_etat++;
 			}
@@ -1622,10 +3425,7 @@ pas_decalage:
 			/* calcule le montant du tiers */
 			if (payee_used)
 			{
-				montant = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
-																				 devise_tiers_etat,
-																				 -1);
-				montant_tiers_etat = gsb_real_add (montant_tiers_etat, montant);
+				montant_tiers_etat = gsb_real_add (montant_tiers_etat, ope->payee_amount);
 				nb_ope_tiers_etat++;
 			}
 
@@ -1638,38 +3438,26 @@ pas_decalage:
 					devise_compte_en_cours_etat = gsb_data_account_get_currency (gsb_data_transaction_get_account_number
 																				 (transaction_number));
 
-				montant = gsb_data_transaction_get_adjusted_amount (transaction_number, -1);
-				montant_compte_etat = gsb_real_add (montant_compte_etat, montant);
+				montant_compte_etat = gsb_real_add (montant_compte_etat, ope->account_amount);
 				nb_ope_compte_etat++;
 			}
 
-			/* calcule les montants totaux */
-			montant = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
-																			 devise_generale_etat,
-																			 -1);
-			total_general = gsb_real_add (total_general, montant);
+			/* les montants totaux ont été calculés avec le classement */
 			nb_ope_general_etat++;
 
 			/* calcule le montant de la periode */
 			if (gsb_data_report_get_period_split (current_report_number))
 			{
-				montant = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
-																				 devise_categ_etat,
-																				 -1);
-				montant_periode_etat = gsb_real_add (montant_periode_etat, montant);
+				montant_periode_etat = gsb_real_add (montant_periode_etat, ope->categ_amount);
 				nb_ope_periode_etat++;
 			}
 			/* calcule le montant de l'exo */
 			if (gsb_data_report_get_financial_year_split (current_report_number))
 			{
-				montant = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
-																				 devise_categ_etat,
-																				 -1);
-				montant_exo_etat = gsb_real_add (montant_exo_etat, montant);
+				montant_exo_etat = gsb_real_add (montant_exo_etat, ope->categ_amount);
 				nb_ope_exo_etat++;
 			}
 
-			total_partie = gsb_real_add (total_partie, montant);
 			nb_ope_partie_etat++;
 			changement_de_groupe_etat = 0;
 
@@ -1724,7 +3512,7 @@ pas_decalage:
 		/* on affiche le total de la partie en cours */
 		/* si les revenus et dépenses ne sont pas mélangés */
 		if (gsb_data_report_get_split_credit_debit (current_report_number))
-			ligne = etat_affiche_affiche_total_partiel (total_partie, ligne, i);
+			ligne = etat_affiche_affiche_total_partiel (calcul->total_partie[i], ligne, i);
     }
 
 	/* on affiche maintenant le total général */
@@ -1751,7 +3539,8 @@ gboolean affichage_etat (gint report_number,
 					 struct EtatAffichage *affichage,
 					 gchar *filename)
 {
-    GSList *liste_opes_selectionnees;
+	EtatsCalcul *calcul;
+	gchar *definition = NULL;
 	guint nbre_opes;
 
 	devel_debug (NULL);
@@ -1767,10 +3556,29 @@ gboolean affichage_etat (gint report_number,
     if (!affichage)
 		affichage = &gtktable_affichage;
 
-    /*   selection des opérations */
-    /* on va mettre l'adresse des opés sélectionnées dans une liste */
-    liste_opes_selectionnees = recupere_opes_etat (report_number);
-	nbre_opes = g_slist_length (liste_opes_selectionnees);
+	/* l'état affiché à l'écran est repris s'il n'a pas changé et si les données n'ont pas été modifiées */
+	if (affichage == &gtktable_affichage)
+	{
+		definition = etats_calculs_get_definition (report_number);
+		if (definition && etats_gtktable_cache_show (report_number, definition))
+		{
+			g_free (definition);
+			grisbi_win_status_bar_stop_wait (FALSE);
+			return TRUE;
+		}
+	}
+
+    /* sélection et classement des opérations, annulés par l'utilisateur pour les gros états */
+	calcul = etats_calculs_calcul_new (report_number, TRUE);
+	if (!etats_calculs_calcul_compute (calcul))
+	{
+		etats_calculs_calcul_free (calcul);
+		g_free (definition);
+		grisbi_win_status_bar_stop_wait (FALSE);
+		return FALSE;
+	}
+
+	nbre_opes = calcul->nbre_opes;
 	if (nbre_opes > ETATS_MAX_OPES)
 	{
 		gint result;
@@ -1778,11 +3586,12 @@ gboolean affichage_etat (gint report_number,
 		result = etats_dialog_warning_report_too_big (report_number, nbre_opes);
 		if (result != GTK_RESPONSE_OK)		/*on continue */
 		{
+			etats_calculs_calcul_free (calcul);
+			g_free (definition);
 			result = etats_config_personnalisation_etat ();
 			if (result == GTK_RESPONSE_CANCEL)
 			{
 				gsb_gui_navigation_select_reports_page ();
-				g_slist_free (liste_opes_selectionnees);
 				grisbi_win_status_bar_stop_wait (FALSE);
 				return FALSE;
 			}
@@ -1791,11 +3600,17 @@ gboolean affichage_etat (gint report_number,
 		}
 	}
 
-	/* à ce niveau, on a récupéré toutes les opés qui entreront dans */
-    /* l'état ; reste plus qu'à les classer et les afficher */
-    /* on classe la liste et l'affiche en fonction du choix du type de classement */
+	/* à ce niveau, on a récupéré et classé toutes les opés qui entreront dans */
+    /* l'état ; reste plus qu'à les afficher */
     etat_affichage_output = affichage;
-    etape_finale_affichage_etat (liste_opes_selectionnees, affichage, filename);
+    etape_finale_affichage_etat (calcul, affichage, filename);
+	etats_calculs_calcul_free (calcul);
+
+	if (definition)
+	{
+		etats_gtktable_cache_add (report_number, definition);
+		g_free (definition);
+	}
     grisbi_win_status_bar_stop_wait (FALSE);
 
 	return TRUE;
@@ -1830,635 +3645,35 @@ void affichage_empty_report (gint report_number)
  * adresses de ces opérations
  * elle est appelée pour l'affichage d'un état ou pour la récupération des tiers d'un état
  *
+ * les filtres de l'état sont compilés une fois, puis la liste des opérations n'est
+ * parcourue qu'une seule fois pour répartir les opés par compte ; la sélection
+ * est faite ici, sans thread
+ *
  * \param report_number		numéro du rapport
  *
  * \return
  **/
 GSList *recupere_opes_etat (gint report_number)
 {
-    GSList *transactions_report_list;
-    gint no_exercice_recherche;
-    GSList *tmp_list;
-    gint ignore_archives;
-
-    transactions_report_list = NULL;
-
-    /* on récupère ignore_archives qui s'il vaut 1 ne retient que la liste courte des opérations */
-    ignore_archives = gsb_data_report_get_ignore_archives (report_number);
-
-    /* si on utilise l'exercice courant ou précédent, on cherche ici le numéro de l'exercice correspondant */
-    no_exercice_recherche = 0;
-
-	if (gsb_data_report_get_use_financial_year (report_number))
-    {
-        gint fyear_number;
-        gint last_fyear_number;
-
-        /* get the current financial year */
-        fyear_number = gsb_data_fyear_get_from_date (gdate_today ());
-
-        switch (gsb_data_report_get_financial_year_type (report_number))
-        {
-            case 1:
-				/* want the current financial year */
-				if (fyear_number)
-					no_exercice_recherche = fyear_number;
-				break;
-            case 2:
-				/* want the last financial year */
-				last_fyear_number = gsb_data_fyear_get_previous_financial_year (fyear_number);
-				if (last_fyear_number)
-					no_exercice_recherche = last_fyear_number;
-				break;
-        }
-    }
-
-    /* si on a utilisé "le plus grand" dans la recherche de texte, c'est ici qu'on recherche */
-    /* les plus grands no de chq, de rappr et de pc dans les comptes choisis */
-    /* commence par rechercher si on a utilisé "le plus grand" */
-    tmp_list = gsb_data_report_get_text_comparison_list (report_number);
-    while (tmp_list)
-    {
-		gint text_comparison_number;
-
-		text_comparison_number = GPOINTER_TO_INT (tmp_list->data);
-		if (gsb_data_report_text_comparison_get_first_comparison (text_comparison_number) == 6
-			|| gsb_data_report_text_comparison_get_second_comparison (text_comparison_number) == 6)
-		{
-			/* on utilise "le plus grand" qque part, donc on va remplir les 3 variables */
-			GSList *accounts_list;
-
-			dernier_chq = 0;
-			dernier_pc = 0;
-			dernier_no_rappr = 0;
-
-			accounts_list = gsb_data_account_get_list_accounts ();
-			while (accounts_list)
-			{
-				gint i;
-
-				i = gsb_data_account_get_no_account (accounts_list->data);
-
-				/* on commence par vérifier que le compte fait partie de l'état */
-				if (!gsb_data_report_get_account_use_chosen (report_number)
-					 || g_slist_index (gsb_data_report_get_account_numbers_list (report_number),
-									   GINT_TO_POINTER (i)) != -1)
-				{
-					GSList *list_tmp_transactions;
-
-					/* on fait le tour de la liste des opés en recherchant le plus grand dans les 3 variables */
-					if (ignore_archives)
-						list_tmp_transactions = gsb_data_transaction_get_transactions_list ();
-					else
-						list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
-
-					while (list_tmp_transactions)
-					{
-						gint transaction_number_tmp;
-
-						transaction_number_tmp = gsb_data_transaction_get_transaction_number (list_tmp_transactions->data);
-						if (gsb_data_transaction_get_account_number (transaction_number_tmp) == i)
-						{
-							const gchar *tmp_str;
-							gint tmp_number;
-
-							/* commence par le cheque, il faut que le type opé soit à incrémentation auto */
-							/* et le no le plus grand */
-							/* on ne recherche le type d'opé que si l'opé a un contenu du type et que celui ci */
-							/* est > que dernier_chq */
-							if ((tmp_str = gsb_data_transaction_get_method_of_payment_content (transaction_number_tmp)))
-							{
-								gint payment_number;
-
-								payment_number = gsb_data_transaction_get_method_of_payment_number (transaction_number_tmp);
-								if (gsb_data_payment_get_show_entry (payment_number)
-									&& gsb_data_payment_get_automatic_numbering (payment_number))
-								{
-									tmp_number = utils_str_atoi (tmp_str);
-									if (tmp_number > dernier_chq)
-										dernier_chq = tmp_number;
-								}
-							}
-
-							/* on récupère maintenant la plus grande pc */
-							if ((tmp_str = gsb_data_transaction_get_voucher (transaction_number_tmp)))
-							{
-								tmp_number = utils_str_atoi (tmp_str);
-								if (tmp_number > dernier_pc)
-									dernier_pc = tmp_number;
-							}
-
-							/* on récupère maintenant le dernier relevé */
-							tmp_number = gsb_data_transaction_get_reconcile_number (transaction_number_tmp);
-							if (tmp_number > dernier_no_rappr)
-								dernier_no_rappr = tmp_number;
-						}
-						list_tmp_transactions = list_tmp_transactions->next;
-					}
-				}
-				accounts_list = accounts_list->next;
-			}
-			tmp_list = NULL;
-		}
-		else
-			tmp_list = tmp_list->next;
-    }
-
-    /* on traite les comptes concernés */
-    tmp_list = gsb_data_account_get_list_accounts ();
-    while (tmp_list)
-    {
-		gint i;
-
-		i = gsb_data_account_get_no_account (tmp_list->data);
-		if (!gsb_data_report_get_account_use_chosen (report_number)
-			 || g_slist_index (gsb_data_report_get_account_numbers_list (report_number),
-							   GINT_TO_POINTER (i)) != -1)
-		{
-			/* le compte est bon, passe à la suite de la sélection */
-			/* on va faire le tour de toutes les opés du compte */
-			GSList *list_tmp_transactions;
-
-			if (ignore_archives)
-				list_tmp_transactions = gsb_data_transaction_get_transactions_list ();
-			else
-				list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
-
-			while (list_tmp_transactions)
-			{
-				gint transaction_number_tmp;
-
-				transaction_number_tmp = gsb_data_transaction_get_transaction_number (list_tmp_transactions->data);
-				if (gsb_data_transaction_get_account_number (transaction_number_tmp) == i)
-				{
-					/* si c'est une opé ventilée, dépend de la conf */
-					if (gsb_data_transaction_get_split_of_transaction (transaction_number_tmp))
-					{
-						if (gsb_data_report_get_category_detail_used (report_number))
-							goto operation_refusee;
-
-						if (!gsb_data_report_get_not_detail_split (report_number))
-							goto operation_refusee;
-
-					}
-
-					if (gsb_data_transaction_get_mother_transaction_number (transaction_number_tmp))
-					{
-						if (!gsb_data_report_get_category_detail_used (report_number))
-						{
-							if (gsb_data_report_get_not_detail_split (report_number))
-								goto operation_refusee;
-						}
-
-					}
-
-					/* on vérifie ensuite si un texte est recherché */
-					if (gsb_data_report_get_text_comparison_used (report_number))
-					{
-						gint garde_ope;
-						GSList *comparison_list;
-
-						comparison_list = gsb_data_report_get_text_comparison_list (report_number);
-						garde_ope = 0;
-						while (comparison_list)
-						{
-							const gchar *texte;
-							gint ope_dans_test;
-							gint text_comparison_number;
-
-							text_comparison_number = GPOINTER_TO_INT (comparison_list->data);
-
-							/* on commence par récupérer le texte du champs recherché */
-							texte = recupere_texte_test_etat (transaction_number_tmp,
-															  gsb_data_report_text_comparison_get_field
-															  (text_comparison_number));
-
-							/* à ce niveau, texte est soit null, soit contient le texte dans lequel on effectue la recherche */
-							/* on vérifie maintenant en fontion de l'opérateur */
-							/* si c'est un chq ou une pc et que use_txt = TRUE, on utilise leur no */
-							if ((gsb_data_report_text_comparison_get_field (text_comparison_number) == 8
-								 || gsb_data_report_text_comparison_get_field (text_comparison_number) == 9
-								 || gsb_data_report_text_comparison_get_field (text_comparison_number) == 10)
-								&& !gsb_data_report_text_comparison_get_use_text (text_comparison_number))
-							{
-								if (texte)
-									ope_dans_test = verifie_chq_test_etat (text_comparison_number, texte);
-								else
-									ope_dans_test = 0;
-							}
-							else
-								ope_dans_test = verifie_texte_test_etat (text_comparison_number, texte);
-
-							/* à ce niveau, ope_dans_test=1 si l'opé a passé ce test */
-							/* il faut qu'on fasse le lien avec la ligne précédente */
-							switch (gsb_data_report_text_comparison_get_link_to_last_text_comparison (text_comparison_number))
-							{
-								case -1:
-									/* 1ère ligne  */
-									garde_ope = ope_dans_test;
-									break;
-
-								case 0:
-									/* et  */
-									garde_ope = garde_ope && ope_dans_test;
-									break;
-
-								case 1:
-									/* ou  */
-									garde_ope = garde_ope || ope_dans_test;
-									break;
-
-								case 2:
-									/* sauf  */
-									garde_ope = garde_ope && (!ope_dans_test);
-									break;
-							}
-							comparison_list = comparison_list->next;
-						}
-
-						/* on ne garde l'opération que si garde_ope = 1 */
-						if (!garde_ope)
-							goto operation_refusee;
-					}
-
-					/* on vérifie les R */
-					if (gsb_data_report_get_show_m (report_number))
-					{
-						if (gsb_data_report_get_show_m (report_number) == 1
-							&& gsb_data_transaction_get_marked_transaction (transaction_number_tmp) == OPERATION_RAPPROCHEE)
-						{
-							goto operation_refusee;
-						}
-						if (gsb_data_report_get_show_m (report_number) == 2)
-						{
-							if (!gsb_data_transaction_get_marked_transaction (transaction_number_tmp))
-								goto operation_refusee;
-
-							if (gsb_data_report_get_show_p (report_number) == 0
-								&& gsb_data_transaction_get_marked_transaction (transaction_number_tmp) == OPERATION_POINTEE)
-								goto operation_refusee;
-
-							if (gsb_data_report_get_show_r (report_number) == 0
-								&& gsb_data_transaction_get_marked_transaction (transaction_number_tmp) == OPERATION_RAPPROCHEE)
-								goto operation_refusee;
-
-							if (gsb_data_report_get_show_t (report_number) == 0
-								&&
-								gsb_data_transaction_get_marked_transaction (transaction_number_tmp) == OPERATION_TELEPOINTEE)
-								goto operation_refusee;
-						}
-					}
-
-					/* vérification du montant nul */
-					if (gsb_data_report_get_amount_comparison_only_report_non_null (report_number)
-						&& !gsb_data_transaction_get_amount (transaction_number_tmp).mantissa)
-						goto operation_refusee;
-
-					/* vérification des montants */
-					if (gsb_data_report_get_amount_comparison_used (report_number))
-					{
-						gint garde_ope;
-						GSList *comparison_list;
-
-						comparison_list = gsb_data_report_get_amount_comparison_list (report_number);
-						garde_ope = 0;
-						while (comparison_list)
-						{
-							GsbReal montant;
-							gint ope_dans_premier_test;
-							gint ope_dans_second_test;
-							gint ope_dans_test;
-							gint amount_comparison_number;
-
-							amount_comparison_number = GPOINTER_TO_INT (comparison_list->data);
-							montant = gsb_data_transaction_get_adjusted_amount (transaction_number_tmp, -1);
-
-							/* on vérifie maintenant en fonction de la ligne de test si on garde cette opé */
-							ope_dans_premier_test = compare_montants_etat (montant,
-																		   gsb_data_report_amount_comparison_get_first_amount
-																		   (amount_comparison_number),
-																		   gsb_data_report_amount_comparison_get_first_comparison
-																		   (amount_comparison_number));
-
-							if (gsb_data_report_amount_comparison_get_link_first_to_second_part (amount_comparison_number) != 3)
-								ope_dans_second_test = compare_montants_etat (montant,
-																			  gsb_data_report_amount_comparison_get_second_amount
-																			  (amount_comparison_number),
-																			  gsb_data_report_amount_comparison_get_second_comparison
-																			  (amount_comparison_number));
-							else
-							/* pour éviter les warning lors de la compil */
-								ope_dans_second_test = 0;
-
-							switch (gsb_data_report_amount_comparison_get_link_first_to_second_part (amount_comparison_number))
-							{
-								case 0:
-									/* et  */
-									ope_dans_test = ope_dans_premier_test && ope_dans_second_test;
-									break;
-
-								case 1:
-									/*  ou */
-									ope_dans_test = ope_dans_premier_test || ope_dans_second_test;
-									break;
-
-								case 2:
-									/* sauf  */
-									ope_dans_test = ope_dans_premier_test && (!ope_dans_second_test);
-									break;
-
-								case 3:
-									/* aucun  */
-									ope_dans_test = ope_dans_premier_test;
-									break;
-
-								default:
-									ope_dans_test = 0;
-							}
-
-							/* à ce niveau, ope_dans_test=1 si l'opé a passé ce test */
-							/* il faut qu'on fasse le lien avec la ligne précédente */
-							switch (gsb_data_report_amount_comparison_get_link_to_last_amount_comparison (amount_comparison_number))
-							{
-								case -1:
-									/* 1ère ligne  */
-									garde_ope = ope_dans_test;
-									break;
-
-								case 0:
-									/* et  */
-									garde_ope = garde_ope && ope_dans_test;
-									break;
-
-								case 1:
-									/* ou  */
-									garde_ope = garde_ope || ope_dans_test;
-									break;
-
-								case 2:
-									/* sauf  */
-									garde_ope = garde_ope && (!ope_dans_test);
-									break;
-								}
-								comparison_list = comparison_list->next;
-						}
-
-						/* on ne garde l'opération que si garde_ope = 1 */
-						if (!garde_ope)
-							goto operation_refusee;
-					}
+	EtatsCalcul *calcul;
+    GSList *transactions_report_list = NULL;
+	GSList *tmp_list;
 
-					/* on vérifie les virements */
-					if (gsb_data_transaction_get_contra_transaction_number (transaction_number_tmp) > 0)
-					{
-						if (!gsb_data_report_get_transfer_choice (report_number))
-							goto operation_refusee;
-
-						if (gsb_data_report_get_transfer_choice (report_number)== 1)
-						{
-							/* on inclue l'opé que si le compte de virement */
-							/* est un compte de passif ou d'actif */
-							if (gsb_data_account_get_kind (gsb_data_transaction_get_contra_transaction_account
-														   (transaction_number_tmp)) != GSB_TYPE_LIABILITIES
-								&&
-								gsb_data_account_get_kind (gsb_data_transaction_get_contra_transaction_account
-														   (transaction_number_tmp)) != GSB_TYPE_ASSET)
-							goto operation_refusee;
-
-						}
-						else
-						{
-							if (gsb_data_report_get_transfer_choice (report_number)== 2)
-							{
-								/* on inclut l'opé que si le compte de virement n'est pas présent dans l'état */
-								/* si on ne détaille pas les comptes, on ne cherche pas, l'opé est refusée */
-								if (gsb_data_report_get_account_use_chosen (report_number))
-								{
-									if (g_slist_index (gsb_data_report_get_account_numbers_list (report_number),
-													   GINT_TO_POINTER (gsb_data_transaction_get_contra_transaction_account
-																		(transaction_number_tmp))) != -1)
-									goto operation_refusee;
-								}
-								else
-									goto operation_refusee;
-							}
-							else
-							{
-								/* on inclut l'opé que si le compte de virement est dans la liste */
-								if (g_slist_index (gsb_data_report_get_transfer_account_numbers_list (report_number),
-												   GINT_TO_POINTER (gsb_data_transaction_get_contra_transaction_account
-																	(transaction_number_tmp))) == -1)
-									goto operation_refusee;
-							}
-						}
-					}
-					else
-					{
-						/* l'opé n'est pas un virement, si on doit exclure les non virement, c'est ici */
-						if (gsb_data_report_get_transfer_choice (report_number)
-							&& gsb_data_report_get_transfer_reports_only (report_number))
-							goto operation_refusee;
-					}
-
-					/* check the categ only if it's not a split or transfer */
-					if (!gsb_data_transaction_get_split_of_transaction (transaction_number_tmp)
-						&& gsb_data_transaction_get_contra_transaction_number (transaction_number_tmp) == 0
-						&& gsb_data_report_get_category_detail_used (report_number) /* it's a normal categ (or not categ) */
-						&& !gsb_data_report_check_categ_budget_in_report (gsb_data_report_get_category_struct_list (report_number),
-																		  gsb_data_transaction_get_category_number
-																		  (transaction_number_tmp),
-																		  gsb_data_transaction_get_sub_category_number
-																		  (transaction_number_tmp)))
-						goto operation_refusee;
-
-					/* check the buget */
-					if ((gsb_data_report_get_budget_detail_used (report_number)
-						 &&
-						 !gsb_data_report_check_categ_budget_in_report (gsb_data_report_get_budget_struct_list (report_number),
-																		gsb_data_transaction_get_budgetary_number
-																		(transaction_number_tmp),
-																		gsb_data_transaction_get_sub_budgetary_number
-																		(transaction_number_tmp))))
-						goto operation_refusee;
-
-					/* vérification du tiers */
-					if (gsb_data_report_get_payee_detail_used (report_number)
-						&&
-						g_slist_index (gsb_data_report_get_payee_numbers_list (report_number),
-									   GINT_TO_POINTER (gsb_data_transaction_get_party_number
-														(transaction_number_tmp))) == -1)
-						goto operation_refusee;
-
-					/* vérification du type d'opération */
-					if (gsb_data_report_get_method_of_payment_used (report_number))
-					{
-						gint payment_number;
-
-						payment_number = gsb_data_transaction_get_method_of_payment_number (transaction_number_tmp);
-						if (!payment_number)
-							goto operation_refusee;
-
-						if (!g_slist_find_custom (gsb_data_report_get_method_of_payment_list (report_number),
-												  gsb_data_payment_get_name (payment_number),
-												  (GCompareFunc) cherche_string_equivalente_dans_slist))
-							goto operation_refusee;
-					}
+	calcul = etats_calculs_calcul_new (report_number, FALSE);
+	etats_calculs_calcul_copy (calcul);
+	etats_calculs_calcul_set_parts (calcul, 1);
+	etats_calculs_part_select (&calcul->parts[0]);
 
-					/* vérifie la plage de date */
-					if (gsb_data_report_get_use_financial_year (report_number))
-					{
-						/* on utilise l'exercice */
-						if (((gsb_data_report_get_financial_year_type (report_number) == 1
-							  || gsb_data_report_get_financial_year_type (report_number) == 2)
-							 && (gsb_data_transaction_get_financial_year_number (transaction_number_tmp)!= no_exercice_recherche
-								 ||
-								 !gsb_data_transaction_get_financial_year_number (transaction_number_tmp)))
-							|| (gsb_data_report_get_financial_year_type (report_number) == 3
-								&& (g_slist_index (gsb_data_report_get_financial_year_list (report_number),
-												   GINT_TO_POINTER (gsb_data_transaction_get_financial_year_number
-																	(transaction_number_tmp))) == -1
-									||
-									!gsb_data_transaction_get_financial_year_number (transaction_number_tmp))))
-							goto operation_refusee;
-					}
-					else
-					{
-						/* on utilise une plage de dates */
-						GDate *date_jour;
-						GDate *date_tmp;
-						const GDate *date_transaction;
-
-						date_jour = gdate_today ();
-
-						/* on récupère la date ou la date de valeur */
-						if (gsb_data_report_get_date_select_value (report_number))
-							date_transaction = gsb_data_transaction_get_value_date_or_date (transaction_number_tmp);
-						else
-							date_transaction = gsb_data_transaction_get_date (transaction_number_tmp);
-
-						switch (gsb_data_report_get_date_type (report_number))
-						{
-							case 0:
-							/* toutes */
-							break;
-
-							case 1:
-							/* plage perso */
-							if (!gsb_data_report_get_personal_date_start (report_number)
-								|| !gsb_data_report_get_personal_date_end (report_number)
-								|| g_date_compare (gsb_data_report_get_personal_date_start (report_number), date_transaction) > 0
-								|| g_date_compare (gsb_data_report_get_personal_date_end (report_number), date_transaction) < 0)
-								goto operation_refusee;
-							break;
-
-							case 2:
-							/* cumul à ce jour */
-							if (g_date_compare (date_jour,
-												gsb_data_transaction_get_date (transaction_number_tmp)) < 0)
-								goto operation_refusee;
-							break;
-
-							case 3:
-							/* mois en cours */
-							if (g_date_get_month (date_jour) != g_date_get_month (date_transaction)
-								|| g_date_get_year (date_jour) != g_date_get_year (date_transaction))
-								goto operation_refusee;
-							break;
-
-							case 4:
-							/* année en cours */
-							if (g_date_get_year (date_jour) != g_date_get_year (date_transaction))
-								goto operation_refusee;
-							break;
-
-							case 5:
-							/* cumul mensuel */
-							if (g_date_get_month (date_jour) != g_date_get_month (date_transaction)
-								|| g_date_get_year (date_jour) != g_date_get_year (date_transaction)
-								|| g_date_compare (date_jour, date_transaction) < 0)
-								goto operation_refusee;
-							break;
-
-							case 6:
-							/* cumul annuel */
-							if (g_date_get_year (date_jour) != g_date_get_year (date_transaction)
-								|| g_date_compare (date_jour, date_transaction) < 0)
-								goto operation_refusee;
-							break;
-
-							case 7:
-							/* mois précédent */
-							g_date_subtract_months (date_jour, 1);
-							if (g_date_get_month (date_jour) != g_date_get_month (date_transaction)
-								|| g_date_get_year (date_jour) != g_date_get_year (date_transaction))
-								goto operation_refusee;
-							break;
-
-							case 8:
-							/* année précédente */
-							g_date_subtract_years (date_jour, 1);
-							if (g_date_get_year (date_jour) != g_date_get_year (date_transaction))
-								goto operation_refusee;
-							break;
-
-							case 9:
-							/* 30 derniers jours */
-							date_tmp = g_date_new_dmy (g_date_get_day (date_jour),
-													   g_date_get_month (date_jour),
-													   g_date_get_year (date_jour));
-							g_date_subtract_days (date_tmp, 30);
-							if (g_date_compare (date_tmp, date_transaction) > 0
-								|| g_date_compare (date_jour, date_transaction) < 0)
-								goto operation_refusee;
-							break;
-
-							case 10:
-							/* 3 derniers mois */
-							date_tmp = g_date_new_dmy (g_date_get_day (date_jour),
-													   g_date_get_month (date_jour),
-													   g_date_get_year (date_jour));
-							g_date_subtract_months (date_tmp, 3);
-							if (g_date_compare (date_tmp, date_transaction) > 0
-								|| g_date_compare (date_jour, date_transaction) < 0)
-								goto operation_refusee;
-							break;
-
-							case 11:
-							/* 6 derniers mois */
-							date_tmp = g_date_new_dmy (g_date_get_day (date_jour),
-													   g_date_get_month (date_jour),
-													   g_date_get_year (date_jour));
-							g_date_subtract_months (date_tmp, 6);
-							if (g_date_compare (date_tmp, date_transaction) > 0
-								||
-								g_date_compare (date_jour, date_transaction) < 0)
-								goto operation_refusee;
-							break;
-
-							case 12:
-							/* 12 derniers mois */
-							date_tmp = g_date_new_dmy (g_date_get_day (date_jour),
-													   g_date_get_month (date_jour),
-													   g_date_get_year (date_jour));
-							g_date_subtract_months (date_tmp, 12);
-							if (g_date_compare (date_tmp, date_transaction) > 0
-								|| g_date_compare (date_jour, date_transaction) < 0)
-								goto operation_refusee;
-							break;
-						}
-					}
-					transactions_report_list = g_slist_append (transactions_report_list,
-															   gsb_data_transaction_get_pointer_of_transaction
-															   (transaction_number_tmp));
-				}
-operation_refusee:
-				list_tmp_transactions = list_tmp_transactions->next;
-			}
-		}
+	tmp_list = calcul->parts[0].selected;
+	while (tmp_list)
+	{
+		transactions_report_list = g_slist_prepend (transactions_report_list,
+													((EtatsCalculOpe *) tmp_list->data)->transaction);
 		tmp_list = tmp_list->next;
-    }
+	}
+	etats_calculs_calcul_free (calcul);
 
-    return (transactions_report_list);
+    return (g_slist_reverse (transactions_report_list));
 }
 /**
  * compare deux chaines avec la fonction strcmp () Quid de l'UTF8 ?
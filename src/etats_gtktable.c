@@ -31,6 +31,7 @@
 #endif
 
 #include "include.h"
+#include <string.h>
 
 
 /*START_INCLUDE*/
@@ -49,6 +50,20 @@
 #include "erreur.h"
 /*END_INCLUDE*/
 
+/* number of rendered reports kept in memory */
+#define GTKTABLE_CACHE_MAX 8
+
+/* a rendered report, kept while its definition and the data don't change */
+typedef struct _GtktableCache	GtktableCache;
+
+struct _GtktableCache
+{
+    gint		report_number;
+    gchar		*definition;			/* the definition of the report and the day it was rendered */
+    guint		modification_stamp;		/* run.file_modification_stamp when rendered */
+    GtkWidget	*table;					/* a reference on the GtkGrid of the report */
+};
+
 /*START_STATIC*/
 static void gtktable_attach_hsep ( int x, int x2, int y, int y2);
 static void gtktable_attach_label ( gchar * text, gdouble properties, int x, int x2, int y, int y2,
@@ -57,10 +72,15 @@ static void gtktable_attach_vsep ( int x, int x2, int y, int y2);
 static void gtktable_click_sur_ope_etat ( gint transaction_number );
 static gint gtktable_finish ( void );
 static gint gtktable_initialise ( GSList * opes_selectionnees, gchar * filename );
+static void gtktable_cache_free ( GtktableCache *cache );
+static void gtktable_detach_table ( void );
 /*END_STATIC*/
 
 GtkWidget *table_etat = NULL;
 
+/* the rendered reports, the most recent first */
+static GSList *gtktable_cache_list = NULL;
+
 struct EtatAffichage gtktable_affichage = {
     gtktable_initialise,
     gtktable_finish,
@@ -242,12 +262,7 @@ gint gtktable_initialise ( GSList * opes_selectionnees, gchar * filename )
     /* on peut maintenant créer la table */
     /* pas besoin d'indiquer la hauteur, elle grandit automatiquement */
 
-    if (table_etat && GTK_IS_GRID (table_etat))
-        gtk_widget_destroy (table_etat);
-
-    /* regarder la liberation de mémoire */
-    if ( scrolled_window_etat && gtk_bin_get_child ( GTK_BIN ( scrolled_window_etat ) ) )
-        gtk_widget_destroy ( gtk_bin_get_child ( GTK_BIN ( scrolled_window_etat ) ) );
+    gtktable_detach_table ();
 
     /* just update screen so that the user does not see the previous report anymore
      * while we are processing the new report */
@@ -327,8 +342,57 @@ void gtktable_click_sur_ope_etat ( gint transaction_number )
 }
 
 
+/**
+ * remove the report shown from the scrolled window
+ * the table is destroyed, except if it's kept in the cache
+ *
+ * \param
+ *
+ * \return
+ **/
+void gtktable_detach_table ( void )
+{
+    GSList *tmp_list;
+    gboolean cached = FALSE;
+
+    for ( tmp_list = gtktable_cache_list ; tmp_list ; tmp_list = tmp_list -> next )
+        if ( ( ( GtktableCache * ) tmp_list -> data ) -> table == table_etat )
+            cached = TRUE;
+
+    if ( cached )
+    {
+        if ( gtk_widget_get_parent ( table_etat ) )
+            gtk_container_remove ( GTK_CONTAINER ( gtk_widget_get_parent ( table_etat ) ), table_etat );
+    }
+    else if (table_etat && GTK_IS_GRID (table_etat))
+        gtk_widget_destroy (table_etat);
+
+    table_etat = NULL;
+
+    /* regarder la liberation de mémoire */
+    if ( scrolled_window_etat && gtk_bin_get_child ( GTK_BIN ( scrolled_window_etat ) ) )
+        gtk_widget_destroy ( gtk_bin_get_child ( GTK_BIN ( scrolled_window_etat ) ) );
+}
+
+
+/**
+ * free a rendered report of the cache
+ *
+ * \param cache
+ *
+ * \return
+ **/
+void gtktable_cache_free ( GtktableCache *cache )
+{
+    g_object_unref ( cache -> table );
+    g_free ( cache -> definition );
+    g_free ( cache );
+}
+
+
 /**
  *	Set table_etat = NULL
+ *	and forget the rendered reports, they belong to the file closed
  *
  * \param
  *
@@ -340,6 +404,119 @@ void etats_gtktable_free_table_etat (void)
 	{
 		table_etat = NULL;
 	}
+
+	g_slist_free_full ( gtktable_cache_list, ( GDestroyNotify ) gtktable_cache_free );
+	gtktable_cache_list = NULL;
+}
+
+
+/**
+ * keep the report just rendered in the cache
+ *
+ * \param report_number
+ * \param definition the definition of the report, copied
+ *
+ * \return
+ **/
+void etats_gtktable_cache_add ( gint report_number,
+                        const gchar *definition )
+{
+    GtktableCache *cache;
+    GSList *tmp_list;
+
+    if ( !table_etat )
+        return;
+
+    /* forget the previous rendering of that report */
+    etats_gtktable_cache_remove ( report_number );
+
+    cache = g_malloc0 ( sizeof ( GtktableCache ) );
+    cache -> report_number = report_number;
+    cache -> definition = g_strdup ( definition );
+    cache -> modification_stamp = run.file_modification_stamp;
+    cache -> table = g_object_ref ( table_etat );
+    gtktable_cache_list = g_slist_prepend ( gtktable_cache_list, cache );
+
+    /* keep only the last reports */
+    tmp_list = g_slist_nth ( gtktable_cache_list, GTKTABLE_CACHE_MAX - 1 );
+    if ( tmp_list && tmp_list -> next )
+    {
+        g_slist_free_full ( tmp_list -> next, ( GDestroyNotify ) gtktable_cache_free );
+        tmp_list -> next = NULL;
+    }
+}
+
+
+/**
+ * forget the rendering of a report, if it is in the cache
+ *
+ * \param report_number
+ *
+ * \return
+ **/
+void etats_gtktable_cache_remove ( gint report_number )
+{
+    GSList *tmp_list;
+
+    for ( tmp_list = gtktable_cache_list ; tmp_list ; tmp_list = tmp_list -> next )
+    {
+        GtktableCache *cache = tmp_list -> data;
+
+        if ( cache -> report_number == report_number )
+        {
+            /* if that table is shown, the scrolled window keeps it until another report is shown */
+            gtktable_cache_free ( cache );
+            gtktable_cache_list = g_slist_delete_link ( gtktable_cache_list, tmp_list );
+            return;
+        }
+    }
+}
+
+
+/**
+ * show the report from the cache if it was rendered with the same
+ * definition and if the data didn't change since
+ *
+ * \param report_number
+ * \param definition the definition of the report
+ *
+ * \return TRUE if the report is shown, FALSE if it must be computed
+ **/
+gboolean etats_gtktable_cache_show ( gint report_number,
+                        const gchar *definition )
+{
+    GSList *tmp_list;
+
+    for ( tmp_list = gtktable_cache_list ; tmp_list ; tmp_list = tmp_list -> next )
+    {
+        GtktableCache *cache = tmp_list -> data;
+
+        if ( cache -> report_number != report_number )
+            continue;
+
+        if ( strcmp ( cache -> definition, definition ) != 0
+             ||
+             cache -> modification_stamp != run.file_modification_stamp )
+        {
+            etats_gtktable_cache_remove ( report_number );
+            return FALSE;
+        }
+
+        if ( cache -> table != table_etat )
+        {
+            gtktable_detach_table ();
+            table_etat = cache -> table;
+            gtktable_finish ();
+        }
+
+        /* the most recent first */
+        gtktable_cache_list = g_slist_remove_link ( gtktable_cache_list, tmp_list );
+        gtktable_cache_list = g_slist_concat ( tmp_list, gtktable_cache_list );
+
+        return TRUE;
+    }
+
+    return FALSE;
 }
 
 /* Local Variables: */
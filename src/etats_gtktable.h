@@ -1,10 +1,18 @@
 #ifndef _ETATS_GTKTABLE_H
 #define _ETATS_GTKTABLE_H (1)
+
+#include <glib.h>
+
 /* START_INCLUDE_H */
 /* END_INCLUDE_H */
 
 
 /* START_DECLARATION */
-void	etats_gtktable_free_table_etat (void);
+void		etats_gtktable_cache_add		(gint report_number,
+                                 const gchar *definition);
+void		etats_gtktable_cache_remove	(gint report_number);
+gboolean	etats_gtktable_cache_show		(gint report_number,
+                                 const gchar *definition);
+void		etats_gtktable_free_table_etat	(void);
 /* END_DECLARATION */
 #endif
@@ -49,6 +49,7 @@
 #include "gsb_data_payment.h"
 #include "gsb_data_reconcile.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file_cache.h"
 #include "gsb_file_util.h"
 #include "gsb_real.h"
 #include "structures.h"
@@ -1058,8 +1059,9 @@ gboolean gsb_csv_export_archive (const gchar *filename, gint archive_number)
     if (g_csv_with_title_line)
 	gsb_csv_export_title_line (csv_file, FALSE);
 
-    /* set all the transactions for that archive */
-    pTransactionList = gsb_data_transaction_get_complete_transactions_list ();
+    /* set all the transactions for that archive, loaded if it is kept in the cache of the file */
+    gsb_file_cache_load_archive (archive_number);
+    pTransactionList = gsb_data_transaction_get_loaded_transactions_list ();
     while (pTransactionList)
     {
 	gint pTransaction = gsb_data_transaction_get_transaction_number (pTransactionList->data);
@@ -48,6 +48,7 @@
 #include "gsb_locale.h"
 #include "gsb_rgba.h"
 #include "gsb_select_icon.h"
+#include "gsb_trace.h"
 #include "help.h"
 #include "import.h"
 #include "menu.h"
@@ -68,6 +69,7 @@
 /*START_STATIC*/
 static GtkCssProvider *	css_provider = NULL;    /* css provider */
 static gchar *			css_data = NULL;		/* fichier css sous forme de string */
+static GrisbiAppConf *	headless_conf = NULL;	/* conf installée pour les benchmarks sans application */
 gboolean				darkmode = FALSE;		/* use to set darkmode from command_line */
 
 static GrisbiWin *grisbi_app_create_window (GrisbiApp *app,
@@ -788,6 +790,13 @@ static const GOptionEntry options[] =
 		N_("DEBUG")
     },
 
+    /* trace of the long operations */
+    {
+        "trace", '\0', 0, G_OPTION_ARG_FILENAME, NULL,
+        N_("Measure the long operations, write the trace in FILE or print a summary if FILE is \"summary\""),
+		N_("FILE")
+    },
+
 	/* New instance */
 /*	{
 		"standalone", 's', 0, G_OPTION_ARG_NONE, NULL,
@@ -849,6 +858,7 @@ static gboolean grisbi_app_cmdline (GApplication *application,
 	GrisbiAppPrivate *priv;
 	GVariantDict *v_options;
 	gchar *tmp_str = NULL;
+	const gchar *trace_output = NULL;
 	const gchar **remaining_args;
 
 	priv = grisbi_app_get_instance_private (GRISBI_APP (application));
@@ -863,6 +873,10 @@ static gboolean grisbi_app_cmdline (GApplication *application,
 	g_variant_dict_lookup (v_options, "debug", "s", &tmp_str);
 	g_variant_dict_lookup (v_options, "d", "s", &tmp_str);
 
+	/* the trace begins before the loading of the files */
+	if (g_variant_dict_lookup (v_options, "trace", "^&ay", &trace_output))
+		gsb_trace_init (trace_output);
+
     /* Parse filenames */
 	if (g_variant_dict_lookup (v_options, G_OPTION_REMAINING, "^a&ay", &remaining_args))
 	{
@@ -1319,6 +1333,9 @@ static void grisbi_app_shutdown (GApplication *application)
         debug_finish_log ();
 	}
 
+	/* write the trace of the session */
+	gsb_trace_finish ();
+
     G_APPLICATION_CLASS (grisbi_app_parent_class)->shutdown (application);
 }
 
@@ -1480,6 +1497,9 @@ gpointer grisbi_app_get_a_conf (void)
 	GrisbiAppPrivate *priv;
 
 	app = g_application_get_default ();
+	if (app == NULL && headless_conf)
+		return headless_conf;
+
 	priv = grisbi_app_get_instance_private (GRISBI_APP (app));
 
 	return priv->a_conf;
@@ -1499,11 +1519,42 @@ GrisbiWin *grisbi_app_get_active_window (GrisbiApp *app)
     if (app == NULL)
         app = GRISBI_APP (g_application_get_default ());
 
+	/* pas de fenêtre quand grisbi est utilisé sans application (benchmarks) */
+	if (app == NULL && headless_conf)
+		return NULL;
+
     win = GRISBI_WIN (gtk_application_get_active_window (GTK_APPLICATION (app)));
 
     return win;
 }
 
+/**
+ * retourne TRUE si grisbi est utilisé sans application ni fenêtre,
+ * après un appel à grisbi_app_set_headless_conf ()
+ *
+ * \param
+ *
+ * \return TRUE sans application
+ */
+gboolean grisbi_app_is_headless (void)
+{
+	return headless_conf != NULL && g_application_get_default () == NULL;
+}
+
+/**
+ * installe la configuration retournée par grisbi_app_get_a_conf () quand
+ * il n'y a pas d'application, pour les benchmarks sans affichage.
+ * Sans cet appel, grisbi a toujours besoin de son application
+ *
+ * \param a_conf configuration gardée par l'appelant
+ *
+ * \return
+ */
+void grisbi_app_set_headless_conf (gpointer a_conf)
+{
+	headless_conf = (GrisbiAppConf *) a_conf;
+}
+
 /**
  *
  *
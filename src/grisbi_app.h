@@ -41,7 +41,9 @@ GMenu *				grisbi_app_get_menu_edit				(void);
 GAction *			grisbi_app_get_prefs_action				(void);
 gchar **			grisbi_app_get_recent_files_array		(void);
 gboolean			grisbi_app_is_duplicated_file			(const gchar *filename);
+gboolean			grisbi_app_is_headless					(void);
 void 				grisbi_app_set_css_data			 		(const gchar *new_css_data);
+void				grisbi_app_set_headless_conf			(gpointer a_conf);
 void				grisbi_app_set_recent_files_array 		(gchar **recent_array);
 void				grisbi_app_update_recent_files_menu 	(void);
 void				grisbi_app_window_style_updated			(GtkWidget *win,
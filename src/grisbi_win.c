@@ -69,6 +69,9 @@
 
 
 /*START_STATIC*/
+/* structures w_etat et w_run installées pour les benchmarks sans fenêtre */
+static GrisbiWinEtat *	headless_w_etat = NULL;
+static GrisbiWinRun *	headless_w_run = NULL;
 /*END_STATIC*/
 
 /*START_EXTERN*/
@@ -956,6 +959,8 @@ gboolean grisbi_win_file_is_loading (void)
 	GrisbiWinRun *w_run;
 
 	win = grisbi_app_get_active_window (NULL);
+	if (win == NULL && headless_w_run)
+		return headless_w_run->file_is_loading;
 
 	priv = grisbi_win_get_instance_private (GRISBI_WIN (win));
 	w_run = priv->w_run;
@@ -1029,6 +1034,9 @@ gpointer grisbi_win_get_w_etat (void)
     GrisbiWinPrivate *priv;
 
     win = grisbi_app_get_active_window (NULL);
+	if (win == NULL && headless_w_etat)
+		return headless_w_etat;
+
     priv = grisbi_win_get_instance_private (GRISBI_WIN (win));
 
 	return priv->w_etat;
@@ -1047,11 +1055,31 @@ gpointer grisbi_win_get_w_run (void)
     GrisbiWinPrivate *priv;
 
     win = grisbi_app_get_active_window (NULL);
+	if (win == NULL && headless_w_run)
+		return headless_w_run;
+
     priv = grisbi_win_get_instance_private (GRISBI_WIN (win));
 
 	return priv->w_run;
 }
 
+/**
+ * installe les structures w_etat et w_run retournées quand grisbi n'a pas
+ * de fenêtre, pour les benchmarks sans affichage.
+ * Sans cet appel, grisbi a toujours besoin de sa fenêtre
+ *
+ * \param w_etat structure GrisbiWinEtat gardée par l'appelant
+ * \param w_run structure GrisbiWinRun gardée par l'appelant
+ *
+ * \return
+ **/
+void grisbi_win_set_headless_structures (gpointer w_etat,
+										 gpointer w_run)
+{
+	headless_w_etat = (GrisbiWinEtat *) w_etat;
+	headless_w_run = (GrisbiWinRun *) w_run;
+}
+
 /* GET WIDGET */
 /**
  * retourne account_page
@@ -2216,9 +2244,14 @@ void grisbi_win_status_bar_clear (void)
 void grisbi_win_status_bar_message (gchar *message)
 {
 	GrisbiAppConf *a_conf;
+	GrisbiWin *win;
 	GrisbiWinPrivate *priv;
 
-	priv = grisbi_win_get_instance_private (GRISBI_WIN (grisbi_app_get_active_window (NULL)));
+	win = grisbi_app_get_active_window (NULL);
+	if (win == NULL && grisbi_app_is_headless ())
+		return;
+
+	priv = grisbi_win_get_instance_private (win);
 	a_conf = grisbi_app_get_a_conf ();
     if (a_conf->low_definition_screen || !priv->statusbar || !GTK_IS_STATUSBAR (priv->statusbar))
         return;
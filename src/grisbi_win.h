@@ -65,6 +65,8 @@ void            grisbi_win_set_filename                     (GrisbiWin *win,
 gboolean 		grisbi_win_set_form_expander_visible 		(gboolean visible,
 															 gboolean transactions_list);
 gboolean 		grisbi_win_set_form_organization			(gpointer FormOrganization);
+void			grisbi_win_set_headless_structures			(gpointer w_etat,
+															 gpointer w_run);
 void 			grisbi_win_set_prefs_dialog 				(GrisbiWin *win,
 															 GtkWidget *prefs_dialog);
 void            grisbi_win_set_size_and_position            (GtkWindow *win);
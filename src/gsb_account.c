@@ -41,6 +41,7 @@
 #include "gsb_data_scheduled.h"
 #include "gsb_data_transaction.h"
 #include "gsb_file.h"
+#include "gsb_file_cache.h"
 #include "gsb_form_scheduler.h"
 #include "gsb_real.h"
 #include "gsb_scheduler_list.h"
@@ -208,8 +209,10 @@ gboolean gsb_account_delete ( void )
             gsb_data_scheduled_remove_scheduled (scheduled_number);
     }
 
-    /* remove all the transactions of that account */
-    list_tmp = gsb_data_transaction_get_complete_transactions_list ();
+    /* remove all the transactions of that account, with those of the archives
+     * kept in the cache of the file */
+    gsb_file_cache_load_account_archives ( deleted_account, 0 );
+    list_tmp = gsb_data_transaction_get_loaded_transactions_list ();
     while (list_tmp)
     {
         gint transaction_number;
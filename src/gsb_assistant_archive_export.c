@@ -414,7 +414,7 @@ static gboolean gsb_assistant_archive_switch ( GtkWidget *assistant,
             }
 		    success = gsb_file_util_test_overwrite (export_name)
 			&&
-			gsb_file_save_save_file ( export_name, a_conf->compress_backup, archive_number);
+			gsb_file_save_save_file ( export_name, a_conf->compress_backup, archive_number, NULL);
 		    break;
 
 		case 1:
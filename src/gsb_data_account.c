@@ -50,7 +50,9 @@
 #include "gsb_data_transaction.h"
 #include "gsb_dirs.h"
 #include "gsb_file.h"
+#include "gsb_file_cache.h"
 #include "gsb_select_icon.h"
+#include "gsb_trace.h"
 #include "gsb_transactions_list.h"
 #include "navigation.h"
 #include "structures.h"
@@ -63,6 +65,17 @@
 /*END_INCLUDE*/
 
 typedef struct	_AccountStruct 	AccountStruct;	/* struct_account describe an account */
+typedef struct	_BalanceIndexEntry	BalanceIndexEntry;	/* transaction of the balance index of an account */
+
+/* entry of the index of the transactions of an account, sorted by value date */
+struct _BalanceIndexEntry {
+    gint			transaction_number;
+    guint32			julian;						/* value date or date of the transaction */
+    gboolean		is_child;					/* the children of split are not counted */
+    gint			marked_transaction;			/* marked state counted in the marked balance */
+    GsbReal			amount;						/* amount in the currency of the account */
+    GsbReal			balance;					/* initial balance + amounts up to this transaction */
+};
 
 struct _AccountStruct {
     /** @name general stuff */
@@ -92,6 +105,11 @@ struct _AccountStruct {
 
     /** @name remaining of the balances */
     gboolean		balances_are_dirty;
+    GArray *		balance_index;				/* BalanceIndexEntry sorted by date, NULL if not built */
+    GHashTable *	balance_index_changed;		/* transactions to read again in the index, NULL to read all */
+    guint32			balance_index_today;		/* day of the current balance calculated with the index */
+    GsbReal			balance_index_start;		/* initial balance + archives not loaded */
+    gint			nb_pointed;					/* number of P transactions in the current balance */
     GsbReal			current_balance;
     GsbReal			init_balance;
     GsbReal			marked_balance;
@@ -188,6 +206,10 @@ static void _gsb_data_account_free (AccountStruct* account)
         g_slist_free(account->sort_list) ;
     if (account->bet_start_date)
         g_date_free (account->bet_start_date);
+    if (account->balance_index)
+        g_array_free (account->balance_index, TRUE);
+    if (account->balance_index_changed)
+        g_hash_table_destroy (account->balance_index_changed);
     if (G_IS_OBJECT (account->pixbuf))
         g_object_unref (account->pixbuf);
     if (account_buffer == account)
@@ -270,6 +292,459 @@ static AccountStruct *gsb_data_account_get_structure (gint no)
 	return NULL;
 }
 
+/**
+ * compare 2 entries of the balance index by date then by number
+ *
+ * \param entry_1
+ * \param entry_2
+ *
+ * \return -1, 0 or 1 as strcmp
+ **/
+static gint gsb_data_account_balance_index_cmp (const BalanceIndexEntry *entry_1,
+												const BalanceIndexEntry *entry_2)
+{
+	if (entry_1->julian != entry_2->julian)
+		return entry_1->julian < entry_2->julian ? -1 : 1;
+
+	if (entry_1->transaction_number != entry_2->transaction_number)
+		return entry_1->transaction_number < entry_2->transaction_number ? -1 : 1;
+
+	return 0;
+}
+
+/**
+ * return the last day counted in the current balance
+ *
+ * \param
+ *
+ * \return the julian day of today, G_MAXUINT32 if the scheduled transactions are counted
+ **/
+static guint32 gsb_data_account_balance_index_get_today (void)
+{
+    GDate *date_jour;
+	guint32 today;
+	GrisbiAppConf *a_conf;
+
+	/* on regarde si on tient compte ou pas des échéances pour les soldes */
+	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
+	if (a_conf->balances_with_scheduled)
+		return G_MAXUINT32;
+
+    date_jour = gdate_today ();
+	today = g_date_get_julian (date_jour);
+    g_date_free (date_jour);
+
+	return today;
+}
+
+/**
+ * flag the balance index of the account to be read again entirely
+ *
+ * \param account
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_index_invalidate (AccountStruct *account)
+{
+	account->balances_are_dirty = TRUE;
+	if (account->balance_index_changed)
+	{
+		g_hash_table_destroy (account->balance_index_changed);
+		account->balance_index_changed = NULL;
+	}
+}
+
+/**
+ * fill an entry of the balance index with the date, the amount
+ * and the marked state of the transaction
+ *
+ * \param entry
+ * \param transaction_number
+ * \param floating_point
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_index_read_entry (BalanceIndexEntry *entry,
+													   gint transaction_number,
+													   gint floating_point)
+{
+	const GDate *date;
+
+	entry->transaction_number = transaction_number;
+	date = gsb_data_transaction_get_value_date_or_date (transaction_number);
+	if (date && g_date_valid (date))
+		entry->julian = g_date_get_julian (date);
+	else
+		entry->julian = 0;
+
+	entry->is_child = gsb_data_transaction_get_mother_transaction_number (transaction_number) != 0;
+	entry->marked_transaction = gsb_data_transaction_get_marked_transaction (transaction_number);
+	if (entry->is_child)
+		entry->amount = null_real;
+	else
+		entry->amount = gsb_data_transaction_get_adjusted_amount (transaction_number, floating_point);
+}
+
+/**
+ * search the position of a transaction in the balance index
+ *
+ * \param balance_index
+ * \param julian the value date of the transaction
+ * \param transaction_number G_MAXINT to get the position after all the transactions of the day
+ *
+ * \return the number of entries before the transaction
+ **/
+static guint gsb_data_account_balance_index_search (GArray *balance_index,
+													guint32 julian,
+													gint transaction_number)
+{
+	BalanceIndexEntry key = {0};
+	guint low;
+	guint high;
+
+	key.julian = julian;
+	key.transaction_number = transaction_number;
+
+	low = 0;
+	high = balance_index->len;
+	while (low < high)
+	{
+		guint middle;
+
+		middle = low + (high - low) / 2;
+		if (gsb_data_account_balance_index_cmp (&g_array_index (balance_index, BalanceIndexEntry, middle), &key) < 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
+/**
+ * add or remove an entry of the balance index from the marked balance
+ *
+ * \param entry
+ * \param today the last day of the current balance
+ * \param remove TRUE to remove the entry
+ * \param marked_balance the marked balance to change
+ * \param nb_pointed the number of P transactions to change
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_index_count_marked (const BalanceIndexEntry *entry,
+														 guint32 today,
+														 gboolean remove,
+														 GsbReal *marked_balance,
+														 gint *nb_pointed)
+{
+	if (entry->is_child || entry->julian > today || !entry->marked_transaction)
+		return;
+
+	if (entry->amount.mantissa == error_real.mantissa)
+		*marked_balance = error_real;
+	else if (remove)
+		*marked_balance = gsb_real_sub (*marked_balance, entry->amount);
+	else
+		*marked_balance = gsb_real_add (*marked_balance, entry->amount);
+
+	if (entry->marked_transaction == OPERATION_POINTEE)
+		*nb_pointed += remove ? -1 : 1;
+}
+
+/**
+ * create the balance index of all the accounts which don't have it yet
+ * with only one pass on the complete transactions list
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_index_fill (void)
+{
+    GHashTable *accounts_to_fill;
+    GSList *tmp_list;
+
+	accounts_to_fill = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    tmp_list = list_accounts;
+    while (tmp_list)
+    {
+		AccountStruct *account;
+
+		account = tmp_list->data;
+		if (!account->balance_index)
+		{
+			account->balance_index = g_array_new (FALSE, FALSE, sizeof (BalanceIndexEntry));
+			gsb_data_account_balance_index_invalidate (account);
+			g_hash_table_insert (accounts_to_fill, GINT_TO_POINTER (account->account_number), account);
+		}
+		tmp_list = tmp_list->next;
+    }
+
+	/* the archives kept in the cache of the file are counted with their summary */
+	if (g_hash_table_size (accounts_to_fill))
+	{
+		tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
+		while (tmp_list)
+		{
+			AccountStruct *account;
+			gint transaction_number;
+
+			transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
+			account = g_hash_table_lookup (accounts_to_fill,
+										   GINT_TO_POINTER (gsb_data_transaction_get_account_number (transaction_number)));
+			if (account)
+			{
+				BalanceIndexEntry entry = {0};
+
+				entry.transaction_number = transaction_number;
+				g_array_append_val (account->balance_index, entry);
+			}
+			tmp_list = tmp_list->next;
+		}
+	}
+
+	g_hash_table_destroy (accounts_to_fill);
+}
+
+/**
+ * read again the dates and the amounts of all the transactions of the balance index,
+ * sort it and calculate the running balances, the current and the marked balances
+ * the values calculated have the same exponent of the currency account
+ *
+ * \param account
+ * \param today the last day of the current balance
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_index_build (AccountStruct *account,
+												  guint32 today)
+{
+	GArray *marked_mantissas;
+	GsbFileCacheArchiveSummary archives;
+    GsbReal running_balance;
+    GsbReal current_balance;
+    GsbReal marked_balance;
+    guint i;
+    gint floating_point;
+	gint nb_pointed;
+
+	/* the archives kept in the cache of the file are counted with their summary,
+	 * only those which have transactions after today are loaded */
+	gsb_file_cache_load_account_archives (account->account_number, today + 1);
+	gsb_file_cache_get_account_archives_summary (account->account_number, &archives);
+
+	if (!account->balance_index)
+		gsb_data_account_balance_index_fill ();
+
+    floating_point = gsb_data_currency_get_floating_point (account->currency);
+
+	for (i = 0; i < account->balance_index->len; i++)
+	{
+		BalanceIndexEntry *entry;
+
+		entry = &g_array_index (account->balance_index, BalanceIndexEntry, i);
+		gsb_data_account_balance_index_read_entry (entry, entry->transaction_number, floating_point);
+	}
+	g_array_sort (account->balance_index, (GCompareFunc) gsb_data_account_balance_index_cmp);
+
+	/* the transactions of the archives not loaded are before today */
+    running_balance = gsb_real_add (gsb_real_adjust_exponent (account->init_balance, floating_point),
+									gsb_real_adjust_exponent (archives.balance, floating_point));
+	account->balance_index_start = running_balance;
+    current_balance = running_balance;
+	marked_mantissas = g_array_sized_new (FALSE, FALSE, sizeof (gint64), account->balance_index->len + 1);
+	gsb_real_append_mantissa (marked_mantissas, archives.marked_balance, floating_point);
+	nb_pointed = archives.nb_pointed;
+
+	for (i = 0; i < account->balance_index->len; i++)
+	{
+		BalanceIndexEntry *entry;
+
+		entry = &g_array_index (account->balance_index, BalanceIndexEntry, i);
+		if (entry->is_child)
+		{
+			entry->balance = running_balance;
+			continue;
+		}
+
+		running_balance = gsb_real_add (running_balance, entry->amount);
+		entry->balance = running_balance;
+
+		if (entry->julian > today)
+			continue;
+
+		/* the index is sorted by date, the current balance is the last running balance before today */
+		current_balance = running_balance;
+
+		if (entry->marked_transaction)
+		{
+			gsb_real_append_mantissa (marked_mantissas, entry->amount, floating_point);
+			if (entry->marked_transaction == OPERATION_POINTEE)
+				nb_pointed++;
+		}
+	}
+	marked_balance = gsb_real_sum_mantissas ((gint64 *) marked_mantissas->data, marked_mantissas->len, floating_point);
+	g_array_free (marked_mantissas, TRUE);
+
+    account->current_balance = current_balance;
+    account->marked_balance = gsb_real_add (gsb_real_adjust_exponent (account->init_balance, floating_point),
+											marked_balance);
+	account->nb_pointed = nb_pointed;
+	account->has_pointed = nb_pointed > 0;
+	account->balance_index_today = today;
+	if (account->balance_index_changed)
+	{
+		g_hash_table_destroy (account->balance_index_changed);
+		account->balance_index_changed = NULL;
+	}
+	account->balances_are_dirty = FALSE;
+
+	gsb_trace_count ("account_balances_transactions", account->balance_index->len);
+}
+
+/**
+ * move in the balance index only the transactions changed since the last calculation,
+ * then calculate again the running balances after the first one moved
+ * the current and the marked balances are changed only with the old and new values
+ * of these transactions
+ *
+ * \param account
+ * \param today the last day of the current balance
+ *
+ * \return FALSE if the index must be read again entirely
+ **/
+static gboolean gsb_data_account_balance_index_apply_changes (AccountStruct *account,
+															  guint32 today)
+{
+	GHashTableIter iter;
+	gpointer key;
+    GsbReal running_balance;
+    GsbReal marked_balance;
+	guint first_changed;
+	guint i;
+	guint j;
+	gint floating_point;
+	gint nb_pointed;
+
+	if (!account->balance_index
+		|| !account->balance_index_changed
+		|| account->balance_index_today != today)
+		return FALSE;
+
+	/* with a lot of changes, sorting all the index is faster */
+	if (g_hash_table_size (account->balance_index_changed) > account->balance_index->len / 4)
+		return FALSE;
+
+    floating_point = gsb_data_currency_get_floating_point (account->currency);
+	marked_balance = account->marked_balance;
+	nb_pointed = account->nb_pointed;
+
+	/* remove the old entries of the changed transactions */
+	first_changed = account->balance_index->len;
+	for (i = 0, j = 0; i < account->balance_index->len; i++)
+	{
+		BalanceIndexEntry *entry;
+
+		entry = &g_array_index (account->balance_index, BalanceIndexEntry, i);
+		if (g_hash_table_contains (account->balance_index_changed, GINT_TO_POINTER (entry->transaction_number)))
+		{
+			gsb_data_account_balance_index_count_marked (entry, today, TRUE, &marked_balance, &nb_pointed);
+			first_changed = MIN (first_changed, j);
+			continue;
+		}
+
+		if (i != j)
+			g_array_index (account->balance_index, BalanceIndexEntry, j) = *entry;
+		j++;
+	}
+	g_array_set_size (account->balance_index, j);
+
+	/* insert them again at their new place if they are still in the account */
+	g_hash_table_iter_init (&iter, account->balance_index_changed);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+	{
+		BalanceIndexEntry entry = {0};
+		guint position;
+
+		if (gsb_data_transaction_get_account_number (GPOINTER_TO_INT (key)) != account->account_number)
+			continue;
+
+		gsb_data_account_balance_index_read_entry (&entry, GPOINTER_TO_INT (key), floating_point);
+		gsb_data_account_balance_index_count_marked (&entry, today, FALSE, &marked_balance, &nb_pointed);
+		position = gsb_data_account_balance_index_search (account->balance_index,
+														  entry.julian,
+														  entry.transaction_number);
+		g_array_insert_val (account->balance_index, position, entry);
+		first_changed = MIN (first_changed, position);
+	}
+
+	if (first_changed)
+		running_balance = g_array_index (account->balance_index, BalanceIndexEntry, first_changed - 1).balance;
+	else
+		running_balance = account->balance_index_start;
+
+	for (i = first_changed; i < account->balance_index->len; i++)
+	{
+		BalanceIndexEntry *entry;
+
+		entry = &g_array_index (account->balance_index, BalanceIndexEntry, i);
+		if (!entry->is_child)
+			running_balance = gsb_real_add (running_balance, entry->amount);
+		entry->balance = running_balance;
+	}
+
+	/* the current balance is the last running balance before today */
+	i = gsb_data_account_balance_index_search (account->balance_index, today, G_MAXINT);
+	if (i)
+		account->current_balance = g_array_index (account->balance_index, BalanceIndexEntry, i - 1).balance;
+	else
+		account->current_balance = account->balance_index_start;
+
+	gsb_trace_count ("account_balances_transactions", account->balance_index->len - first_changed);
+
+	/* the marked balance can't be corrected when an amount was wrong */
+	if (marked_balance.mantissa == error_real.mantissa)
+		return FALSE;
+
+	account->marked_balance = marked_balance;
+	account->nb_pointed = nb_pointed;
+	account->has_pointed = nb_pointed > 0;
+	g_hash_table_destroy (account->balance_index_changed);
+	account->balance_index_changed = NULL;
+	account->balances_are_dirty = FALSE;
+
+	return TRUE;
+}
+
+/**
+ * bring up to date the balance index and the balances of the account,
+ * only with the transactions changed since the last calculation when it's possible
+ *
+ * \param account
+ *
+ * \return
+ **/
+static void gsb_data_account_balance_index_update (AccountStruct *account)
+{
+	guint32 today;
+	gint64 trace_start;
+
+	today = gsb_data_account_balance_index_get_today ();
+	if (account->balance_index
+		&& !account->balances_are_dirty
+		&& account->balance_index_today == today)
+		return;
+
+	trace_start = gsb_trace_begin ();
+
+	if (!gsb_data_account_balance_index_apply_changes (account, today))
+		gsb_data_account_balance_index_build (account, today);
+
+	gsb_trace_end ("account_balances", trace_start);
+}
+
 /**
  * find and return the last number of account
  *
@@ -636,6 +1111,14 @@ gint gsb_data_account_set_account_number (gint account_number,
 
     account->account_number = new_no;
 
+	/* the transactions are moved after, so the index will be made again */
+	if (account->balance_index)
+	{
+		g_array_free (account->balance_index, TRUE);
+		account->balance_index = NULL;
+	}
+	gsb_data_account_balance_index_invalidate (account);
+
     return new_no;
 }
 
@@ -997,7 +1480,7 @@ gboolean gsb_data_account_set_init_balance (gint account_number,
         return FALSE;
 
     account->init_balance = balance;
-    account->balances_are_dirty = TRUE;
+	gsb_data_account_balance_index_invalidate (account);
 
     return TRUE;
 }
@@ -1097,15 +1580,36 @@ gboolean gsb_data_account_set_balances_are_dirty (gint account_number)
     if (!account)
         return FALSE;
 
-    account->balances_are_dirty = TRUE;
+    gsb_data_account_balance_index_invalidate (account);
 
     return TRUE;
 }
 
+/**
+ * flag the balances of all the accounts dirty to force recompute,
+ * to call when the amounts change in the currency of the accounts
+ * (exchange rates, archives loaded...)
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_data_account_set_all_balances_are_dirty (void)
+{
+    GSList *tmp_list;
+
+    tmp_list = list_accounts;
+    while (tmp_list)
+    {
+		gsb_data_account_balance_index_invalidate (tmp_list->data);
+		tmp_list = tmp_list->next;
+    }
+}
+
 /**
  * calculate and fill in the account the current and marked balance of that account
- * it's faster than calling gsb_data_account_privatecalculate_current_balance and
- * gsb_data_account_private_calculate_marked_balance because throw the list only one time
+ * the transactions of the account are read from its balance index, which is
+ * made for all the accounts with only one pass on the transactions list
  * called especially to init that values
  * the value calculated will have the same exponent of the currency account
  *
@@ -1116,15 +1620,6 @@ gboolean gsb_data_account_set_balances_are_dirty (gint account_number)
 GsbReal gsb_data_account_calculate_current_and_marked_balances (gint account_number)
 {
     AccountStruct *account;
-    GDate *date_jour;
-    GSList *tmp_list;
-    GsbReal current_balance;
-	GsbReal current_balance_later = null_real;
-    GsbReal marked_balance;
-	GsbReal marked_balance_later = null_real;
-    gint floating_point;
-	gboolean has_pointed = FALSE;
-	GrisbiAppConf *a_conf;
 
     /* devel_debug_int (account_number); */
     account = gsb_data_account_get_structure (account_number);
@@ -1132,72 +1627,110 @@ GsbReal gsb_data_account_calculate_current_and_marked_balances (gint account_num
     if (!account)
         return null_real;
 
-    floating_point = gsb_data_currency_get_floating_point (account->currency);
-    current_balance = gsb_real_adjust_exponent (account->init_balance, floating_point);
-    marked_balance = gsb_real_adjust_exponent (account->init_balance, floating_point);
+    gsb_data_account_balance_index_update (account);
 
-    date_jour = gdate_today ();
+    return account->current_balance;
+}
 
-	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
+/**
+ * add a transaction to the changes of the balance index of the account,
+ * it will be moved in the index the next time the balances are calculated
+ * called when a transaction is created, deleted, moved to another account
+ * or when its date or its amount change
+ *
+ * \param account_number
+ * \param transaction_number
+ *
+ * \return TRUE, ok ; FALSE, problem
+ **/
+gboolean gsb_data_account_balance_index_update_transaction (gint account_number,
+															gint transaction_number)
+{
+	AccountStruct *account;
 
-	tmp_list = gsb_data_transaction_get_complete_transactions_list ();
-    while (tmp_list)
-    {
-		gint transaction_number;
-		gint res = 0;
+	account = gsb_data_account_get_structure (account_number);
+	if (!account)
+		return FALSE;
 
-		transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
+	/* if the index is not made, the transaction will be found when making it */
+	if (!account->balance_index)
+	{
+		gsb_data_account_balance_index_invalidate (account);
+		return TRUE;
+	}
 
-		/* on regarde si on tient compte ou pas des échéances pour les soldes */
-		if (a_conf->balances_with_scheduled)
-			res = 0;
-		else
-		{
-			const GDate *date;
+	/* the index will be read again entirely */
+	if (account->balances_are_dirty && !account->balance_index_changed)
+		return TRUE;
 
-			date = gsb_data_transaction_get_value_date_or_date (transaction_number);
-			res = g_date_compare (date_jour, date);
-		}
+	if (!account->balance_index_changed)
+		account->balance_index_changed = g_hash_table_new (g_direct_hash, g_direct_equal);
+	g_hash_table_add (account->balance_index_changed, GINT_TO_POINTER (transaction_number));
+	account->balances_are_dirty = TRUE;
 
-		if (gsb_data_transaction_get_account_number (transaction_number) == account_number
-			 && !gsb_data_transaction_get_mother_transaction_number (transaction_number)
-			 && res >= 0)
-		{
-			gint marked_transaction;
-			GsbReal adjusted_amout;
-			GsbReal tmp_balance;
+	return TRUE;
+}
 
-			adjusted_amout = gsb_data_transaction_get_adjusted_amount (transaction_number, floating_point);
-			tmp_balance = gsb_real_add (current_balance, adjusted_amout);
-			if(tmp_balance.mantissa != error_real.mantissa)
-			{
-				current_balance = tmp_balance;
-			}
-			else
-			{
-				current_balance_later = gsb_real_add (current_balance_later, adjusted_amout);
-			}
-			marked_transaction = gsb_data_transaction_get_marked_transaction (transaction_number);
-			if (marked_transaction)
-			{
-				tmp_balance = gsb_real_add (marked_balance, adjusted_amout);
-				if(tmp_balance.mantissa != error_real.mantissa)
-					marked_balance = tmp_balance;
-				else
-					marked_balance_later = gsb_real_add (marked_balance_later, adjusted_amout);
-				if (marked_transaction == OPERATION_POINTEE)
-					has_pointed = TRUE;
-			}
-		}
-		tmp_list = tmp_list->next;
-    }
+/**
+ * update the marked balance of the account when a transaction is marked or unmarked
+ * without calculating again all the balances
+ *
+ * \param account_number
+ * \param transaction_number
+ * \param new_marked the new marked state of the transaction
+ *
+ * \return TRUE, ok ; FALSE, problem
+ **/
+gboolean gsb_data_account_update_marked_balance (gint account_number,
+												 gint transaction_number,
+												 gint new_marked)
+{
+	AccountStruct *account;
+	BalanceIndexEntry *entry;
+	const GDate *date;
+	GsbReal marked_balance;
+	guint position;
+	gint nb_pointed;
 
-    g_date_free (date_jour);
-    account->current_balance = gsb_real_add (current_balance, current_balance_later);
-    account->marked_balance = gsb_real_add (marked_balance, marked_balance_later);
-	account->has_pointed = has_pointed;
+	account = gsb_data_account_get_structure (account_number);
+	if (!account)
+		return FALSE;
 
-    return account->current_balance;
+	/* the transaction will be read again with the other changes */
+	if (account->balances_are_dirty || !account->balance_index)
+		return gsb_data_account_balance_index_update_transaction (account_number, transaction_number);
+
+	/* the index is up to date, the transaction is at the place of its date */
+	date = gsb_data_transaction_get_value_date_or_date (transaction_number);
+	position = gsb_data_account_balance_index_search (account->balance_index,
+													  date && g_date_valid (date) ? g_date_get_julian (date) : 0,
+													  transaction_number);
+	if (position >= account->balance_index->len)
+		return gsb_data_account_balance_index_update_transaction (account_number, transaction_number);
+
+	entry = &g_array_index (account->balance_index, BalanceIndexEntry, position);
+	if (entry->transaction_number != transaction_number)
+		return gsb_data_account_balance_index_update_transaction (account_number, transaction_number);
+
+	marked_balance = account->marked_balance;
+	nb_pointed = account->nb_pointed;
+	gsb_data_account_balance_index_count_marked (entry, account->balance_index_today, TRUE,
+												 &marked_balance, &nb_pointed);
+	entry->marked_transaction = new_marked;
+	gsb_data_account_balance_index_count_marked (entry, account->balance_index_today, FALSE,
+												 &marked_balance, &nb_pointed);
+
+	if (marked_balance.mantissa == error_real.mantissa)
+	{
+		gsb_data_account_balance_index_invalidate (account);
+		return TRUE;
+	}
+
+	account->marked_balance = marked_balance;
+	account->nb_pointed = nb_pointed;
+	account->has_pointed = nb_pointed > 0;
+
+	return TRUE;
 }
 
 /**
@@ -1258,8 +1791,9 @@ GsbReal gsb_data_account_get_marked_balance (gint account_number)
 GsbReal gsb_data_account_calculate_waiting_marked_balance (gint account_number)
 {
     AccountStruct *account;
+	GsbFileCacheArchiveSummary archives;
     GSList *tmp_list;
-    GsbReal marked_balance = null_real;
+    GsbReal marked_balance;
     gint floating_point;
 
     account = gsb_data_account_get_structure (account_number);
@@ -1267,7 +1801,12 @@ GsbReal gsb_data_account_calculate_waiting_marked_balance (gint account_number)
 		return null_real;
 
     floating_point = gsb_data_currency_get_floating_point (account->currency);
-    tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+
+	/* the archives kept in the cache of the file are counted with their summary */
+	gsb_file_cache_get_account_archives_summary (account_number, &archives);
+	marked_balance = gsb_real_adjust_exponent (archives.waiting_marked_balance, floating_point);
+
+    tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
     while (tmp_list)
     {
 		gint transaction_number;
@@ -1517,7 +2056,15 @@ gboolean gsb_data_account_set_currency (gint account_number,
     if (!account)
 		return FALSE;
 
+	/* the summaries of the archives kept in the cache of the file are in the old currency */
+	if (account->currency != currency)
+		gsb_file_cache_load_account_archives (account_number, 0);
+
     account->currency = currency;
+	gsb_data_account_balance_index_invalidate (account);
+
+    /* the counters of the metatrees depend on the currency of the account */
+    gsb_data_transaction_invalidate_counters ();
 
     return TRUE;
 }
@@ -2701,64 +3248,45 @@ void gsb_data_account_colorize_current_balance (gint account_number)
 /**
  * Calculates the balance at the date today for the bet module.
  * Excludes future transactions.
+ * the running balance of the index is read before the day, so the transactions
+ * are counted with their value date as for the current balance
  *
- * \param
- * \param
+ * \param account_number
+ * \param day the first day not counted, today if NULL
  *
- * \return
+ * \return the balance, error_real if an amount or a sum is error_real
  **/
 GsbReal gsb_data_account_calculate_current_day_balance (gint account_number,
 														GDate *day)
 {
     AccountStruct *account;
     GDate *date_jour;
-    GSList *tmp_list;
-    GsbReal current_balance;
-	GsbReal current_balance_later = null_real;
-    gint floating_point;
+    guint32 julian;
+    guint position;
 
     account = gsb_data_account_get_structure (account_number);
     if (!account)
         return null_real;
 
-    floating_point = gsb_data_currency_get_floating_point (account->currency);
-    current_balance = gsb_real_adjust_exponent (account->init_balance, floating_point);
     if (day == NULL)
         date_jour = gdate_today ();
     else
         date_jour = gsb_date_copy (day);
 
-    tmp_list = gsb_data_transaction_get_complete_transactions_list ();
-    while (tmp_list)
-    {
-        gint transaction_number;
-        gint res = 0;
-        GsbReal adjusted_amout;
-        GsbReal tmp_balance;
-
-        transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
-
-        /* on ne tient pas compte des échéances futures pour le solde */
-        res = g_date_compare (date_jour,
-							  gsb_data_transaction_get_date (transaction_number));
-        if (gsb_data_transaction_get_account_number (transaction_number) == account_number
-             && !gsb_data_transaction_get_mother_transaction_number (transaction_number)
-             && res > 0)
-        {
-            adjusted_amout = gsb_data_transaction_get_adjusted_amount (transaction_number, floating_point);
-            tmp_balance = gsb_real_add (current_balance, adjusted_amout);
+    julian = g_date_get_julian (date_jour);
+    g_date_free (date_jour);
 
-            if(tmp_balance.mantissa != error_real.mantissa)
-                current_balance = tmp_balance;
-            else
-                current_balance_later = gsb_real_add (current_balance_later, adjusted_amout);
-        }
-        tmp_list = tmp_list->next;
-    }
+    /* the archives kept in the cache of the file are loaded if they have transactions from the day */
+    gsb_file_cache_load_account_archives (account_number, julian);
 
-    g_date_free (date_jour);
+    gsb_data_account_balance_index_update (account);
+
+    /* on ne tient pas compte des échéances futures pour le solde */
+    position = gsb_data_account_balance_index_search (account->balance_index, julian, 0);
+    if (position == 0)
+        return account->balance_index_start;
 
-    return gsb_real_add (current_balance, current_balance_later);
+    return g_array_index (account->balance_index, BalanceIndexEntry, position - 1).balance;
 }
 
 /**
@@ -3600,63 +4128,38 @@ gboolean gsb_data_account_exists (gint account_number)
 
 /**
  * calcule le solde d'un compte à une date donnée
+ * le solde courant de l'index est la somme des montants jusqu'à la date,
+ * il vaut error_real dès qu'un de ces montants ou une de ces sommes vaut error_real
  *
  * \param account_number    numéro du compte concerné
  * \param date              date de calcul du solde
  *
- * \return GsbReal         le solde du compte
+ * \return GsbReal         le solde du compte, error_real en cas de dépassement
  **/
 GsbReal gsb_data_account_get_balance_at_date (gint account_number,
 											  GDate *date)
 {
     AccountStruct *account;
-    GSList *tmp_list;
-    gint floating_point;
-    GsbReal current_balance;
+    guint32 julian;
+    guint position;
 
     account = gsb_data_account_get_structure (account_number);
     if (!account)
         return null_real;
 
-    floating_point = gsb_data_currency_get_floating_point (account->currency);
-    current_balance = gsb_real_adjust_exponent (account->init_balance, floating_point);
-    tmp_list = gsb_data_transaction_get_complete_transactions_list ();
-    while (tmp_list)
-    {
-        gint transaction_number;
+    julian = g_date_get_julian (date);
 
-        transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
+    /* the archives kept in the cache of the file are loaded if they have transactions after the date */
+    gsb_file_cache_load_account_archives (account_number, julian + 1);
 
-        if (gsb_data_transaction_get_account_number (transaction_number) != account_number)
-        {
-            tmp_list = tmp_list->next;
-            continue;
-        }
+    gsb_data_account_balance_index_update (account);
 
-        if (g_date_compare (gsb_data_transaction_get_value_date_or_date (transaction_number),
-         date) > 0)
-        {
-            tmp_list = tmp_list->next;
-            continue;
-        }
-
-        if (gsb_data_transaction_get_mother_transaction_number (transaction_number) == 0)
-        {
-            GsbReal adjusted_amout;
-            GsbReal tmp_balance;
-
-            adjusted_amout = gsb_data_transaction_get_adjusted_amount (transaction_number, floating_point);
-            tmp_balance = gsb_real_add (current_balance, adjusted_amout);
-
-            if (tmp_balance.mantissa == error_real.mantissa)
-                return error_real;
-            else
-                current_balance = tmp_balance;
-        }
-        tmp_list = tmp_list->next;
-    }
+    /* the running balance of the last transaction with a date <= date */
+    position = gsb_data_account_balance_index_search (account->balance_index, julian, G_MAXINT);
+    if (position == 0)
+        return account->balance_index_start;
 
-    return current_balance;
+    return g_array_index (account->balance_index, BalanceIndexEntry, position - 1).balance;
 }
 
 /**
@@ -3779,8 +4282,9 @@ gboolean gsb_data_account_renum_account_number_0 (const gchar *filename)
 	/* on fait une sauvegarde du fichier */
 	gsb_file_copy_old_file (filename);
 
-	/* on traite les opérations */
-	tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+	/* on traite les opérations, avec celles des archives du compte gardées dans le cache */
+	gsb_file_cache_load_account_archives (0, 0);
+	tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
 	while (tmp_list)
 	{
 		gint transaction_number;
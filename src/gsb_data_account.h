@@ -36,6 +36,8 @@ enum _BetTypeOnglets
 };
 
 /* START_DECLARATION */
+gboolean		gsb_data_account_balance_index_update_transaction		(gint account_number,
+																		 gint transaction_number);
 gboolean 		gsb_data_account_bet_update_initial_date_if_necessary 	(gint account_number);
 GsbReal 		gsb_data_account_calculate_current_and_marked_balances 	(gint account_number);
 GsbReal 		gsb_data_account_calculate_current_day_balance 			(gint account_number,
@@ -120,6 +122,7 @@ gboolean		gsb_data_account_renum_account_number_0					(const gchar *filename);
 gboolean 		gsb_data_account_reorder 								(GSList *new_order);
 gboolean 		gsb_data_account_set_account_icon_pixbuf 				(gint account_number,
 																		 GdkPixbuf *pixbuf);
+void			gsb_data_account_set_all_balances_are_dirty				(void);
 void			gsb_data_account_set_all_limits_of_balance				(void);
 gint 			gsb_data_account_set_account_number 					(gint account_number,
 																		 gint new_no);
@@ -229,6 +232,9 @@ gboolean 		gsb_data_account_sort_list_add 							(gint account_number,
 gboolean 		gsb_data_account_sort_list_free 						(gint account_number);
 gboolean 		gsb_data_account_sort_list_remove 						(gint account_number,
 																		 gint payment_number);
+gboolean		gsb_data_account_update_marked_balance					(gint account_number,
+																		 gint transaction_number,
+																		 gint new_marked);
 /* END_DECLARATION */
 
 
@@ -37,6 +37,7 @@
 #include "gsb_data_archive.h"
 #include "dialog.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file_cache.h"
 #include "utils_dates.h"
 #include "utils_str.h"
 /*END_INCLUDE*/
@@ -275,8 +276,9 @@ gboolean gsb_data_archive_remove ( gint archive_number )
     if (!archive)
 	return FALSE;
 
-    /* remove the archive from the transactions */
-    tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+    /* remove the archive from the transactions, loaded if it is kept in the cache of the file */
+    gsb_file_cache_load_archive ( archive_number );
+    tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
     while (tmp_list)
     {
 	gint transaction_number;
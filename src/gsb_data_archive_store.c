@@ -44,6 +44,7 @@
 #include "gsb_data_account.h"
 #include "gsb_data_currency.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file_cache.h"
 #include "gsb_real.h"
 #include "transaction_list.h"
 #include "erreur.h"
@@ -147,8 +148,10 @@ gint gsb_data_archive_store_get_number ( gpointer archive_ptr )
 void gsb_data_archive_store_create_list ( void )
 {
     GSList *tmp_list;
+    GSList *summaries;
 
-    tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+    /* the archives kept in the cache of the file are not loaded, see below */
+    tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
     while (tmp_list)
     {
     gint transaction_number;
@@ -198,6 +201,35 @@ void gsb_data_archive_store_create_list ( void )
     }
     tmp_list = tmp_list -> next;
     }
+
+    /* the archives kept in the cache of the file give their balance and their number
+     * of transactions by account, they will be loaded only when they are shown */
+    summaries = gsb_file_cache_get_archives_summaries ();
+    tmp_list = summaries;
+    while (tmp_list)
+    {
+    GsbFileCacheArchiveSummary *summary;
+    struct_store_archive *archive_store;
+
+    summary = tmp_list -> data;
+    archive_store = gsb_data_archive_store_find_struct ( summary -> archive_number,
+                        summary -> account_number );
+    if (!archive_store)
+    {
+        archive_store = gsb_data_archive_store_get_structure ( gsb_data_archive_store_new () );
+        archive_store -> archive_number = summary -> archive_number;
+        archive_store -> account_number = summary -> account_number;
+        archive_store -> balance = null_real;
+    }
+    archive_store -> balance = gsb_real_add ( archive_store -> balance,
+                        gsb_real_adjust_exponent ( summary -> balance,
+                        gsb_data_currency_get_floating_point (
+                        gsb_data_account_get_currency ( summary -> account_number ) ) ) );
+    archive_store -> nb_transactions += summary -> nb_transactions;
+
+    tmp_list = tmp_list -> next;
+    }
+    g_slist_free_full ( summaries, g_free );
 }
 
 /**
@@ -39,9 +39,11 @@
 #include "grisbi_win.h"
 #include "meta_budgetary.h"
 #include "imputation_budgetaire.h"
+#include "gsb_data_currency.h"
 #include "gsb_data_form.h"
 #include "gsb_data_scheduled.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file_cache.h"
 #include "gsb_form_widget.h"
 #include "gsb_real.h"
 #include "utils_str.h"
@@ -61,6 +63,7 @@ struct _BudgetStruct
     gint budget_type;		/**< 0:credit / 1:debit  */
 
     GSList *sub_budget_list;
+    GHashTable *sub_budget_names_index;		/**< index of the sub-budgets by name */
 
     /** @name gui budget list content (not saved) */
     gint budget_nb_transactions;
@@ -92,10 +95,29 @@ static void _gsb_data_budget_free ( BudgetStruct* budget );
 static void _gsb_data_sub_budget_free ( SubBudgetStruct* sub_budget );
 static GSList *gsb_data_budget_append_sub_budget_to_list ( GSList *list_budget,
                         GSList *sub_budget_list );
+static void gsb_data_budget_check_counters ( void );
+static void gsb_data_budget_compute_counters ( void );
+static void gsb_data_budget_count_amount ( BudgetStruct *budget,
+                        SubBudgetStruct *sub_budget,
+                        gint step,
+                        GsbReal amount );
+static void gsb_data_budget_count_archives_totals ( GSList *archives_totals );
+static void gsb_data_budget_count_balance ( GsbReal *balance,
+                        GsbReal amount );
+static void gsb_data_budget_count_transaction ( gint transaction_number,
+                        gint budget_id,
+                        gint sub_budget_id,
+                        gboolean add );
+static gboolean gsb_data_budget_counters_are_valid ( void );
+static void gsb_data_budget_get_counters ( GArray *numbers,
+                        GArray *balances );
 static gint gsb_data_budget_get_pointer_from_name_in_glist ( BudgetStruct *budget,
                         const gchar *name );
 static gint gsb_data_budget_get_pointer_from_sub_name_in_glist ( SubBudgetStruct *sub_budget,
                         const gchar *name );
+static BudgetStruct *gsb_data_budget_get_structure_by_name ( const gchar *name );
+static SubBudgetStruct *gsb_data_budget_get_sub_budget_structure_by_name ( BudgetStruct *budget,
+                        const gchar *name );
 static gpointer gsb_data_budget_get_structure_in_list ( gint no_budget,
                         GSList *list );
 static gint gsb_data_budget_max_number ( void );
@@ -104,6 +126,7 @@ static gint gsb_data_budget_new ( const gchar *name );
 static gint gsb_data_budget_new_sub_budget ( gint budget_number,
                         const gchar *name );
 static void gsb_data_budget_reset_counters ( void );
+static void gsb_data_budget_sum_balances ( void );
 static gint gsb_data_sub_budget_compare ( SubBudgetStruct * a, SubBudgetStruct * b );
 /*END_STATIC*/
 
@@ -117,10 +140,25 @@ static GSList *budget_list = NULL;
 static BudgetStruct *budget_buffer;
 static SubBudgetStruct *sub_budget_buffer;
 
+/** index of the budgets by name, see utils_str_name_index_new */
+static GHashTable *budget_names_index = NULL;
+
 /** a empty budget for the list of budgets
  * the number of the empty budget is 0 */
 static BudgetStruct *empty_budget = NULL;
 
+/** TRUE when the counters are computed, they are then maintained transaction
+ * by transaction ; with the currency and the archives setting used to compute them */
+static gboolean counters_valid = FALSE;
+static gint counters_currency = 0;
+static gboolean counters_with_archives = FALSE;
+
+/** while the counters are computed again, the amounts of each balance are kept
+ * in a GArray of mantissas with the exponent of the currency of the tree,
+ * they are summed by gsb_real_sum_mantissas at the end ; NULL the rest of the time */
+static GHashTable *counters_mantissas = NULL;
+static gint counters_exponent = 0;
+
 
 /**
  * set the budgets global variables to NULL, usually when we init all the global variables
@@ -136,9 +174,18 @@ gboolean gsb_data_budget_init_variables (gboolean cleanup)
         g_slist_free_full ( budget_list, (GDestroyNotify) _gsb_data_budget_free );
     }
 
+    if ( budget_names_index )
+    {
+        g_hash_table_destroy ( budget_names_index );
+        budget_names_index = NULL;
+    }
+
+    counters_valid = FALSE;
+
 	if (cleanup)
 	{
         budget_list = NULL;
+        budget_names_index = utils_str_name_index_new ();
 		/* recreate the empty budget */
 		_gsb_data_budget_free ( empty_budget );
 		empty_budget = g_malloc0 ( sizeof ( BudgetStruct ));
@@ -163,6 +210,8 @@ static void _gsb_data_budget_free ( BudgetStruct* budget )
     /* free memory used by sub-bugdgets */
     if ( budget -> sub_budget_list)
         g_slist_free_full ( budget -> sub_budget_list, (GDestroyNotify) _gsb_data_sub_budget_free );
+    if ( budget -> sub_budget_names_index )
+        g_hash_table_destroy ( budget -> sub_budget_names_index );
     g_free ( budget -> budget_name);
     g_free ( budget );
 
@@ -524,9 +573,16 @@ gboolean gsb_data_budget_remove ( gint no_budget )
     if (!budget)
 	return FALSE;
 
+    if ( budget_names_index )
+        utils_str_name_index_remove ( budget_names_index, budget -> budget_name, budget );
+
     budget_list = g_slist_remove ( budget_list,
 				   budget );
 
+    /* the transactions still counted in that budget cannot be removed from the counters anymore */
+    if ( budget -> budget_nb_transactions )
+        counters_valid = FALSE;
+
     _gsb_data_budget_free (budget);
 
 	combofix = gsb_form_widget_get_widget (TRANSACTION_FORM_BUDGET);
@@ -562,9 +618,17 @@ gboolean gsb_data_budget_sub_budget_remove ( gint no_budget,
 	!sub_budget)
 	return FALSE;
 
+    if ( budget -> sub_budget_names_index )
+        utils_str_name_index_remove ( budget -> sub_budget_names_index,
+                        sub_budget -> sub_budget_name,
+                        sub_budget );
+
     budget -> sub_budget_list = g_slist_remove ( budget -> sub_budget_list,
 						 sub_budget );
 
+    if ( sub_budget -> sub_budget_nb_transactions )
+        counters_valid = FALSE;
+
     _gsb_data_sub_budget_free (sub_budget);
 
 	combofix = gsb_form_widget_get_widget (TRANSACTION_FORM_BUDGET);
@@ -630,6 +694,10 @@ gint gsb_data_budget_new_sub_budget_with_number ( gint number,
     budget -> sub_budget_list = g_slist_append ( budget -> sub_budget_list,
 						 sub_budget );
 
+    /* the sub-budget has no name yet, it will be indexed when it gets one */
+    if ( !budget -> sub_budget_names_index )
+        budget -> sub_budget_names_index = utils_str_name_index_new ();
+
     sub_budget_buffer = sub_budget;
 
     return sub_budget -> sub_budget_number;
@@ -651,7 +719,7 @@ gint gsb_data_budget_get_number_by_name ( const gchar *name,
                         gboolean create,
                         gint budget_type )
 {
-    GSList *list_tmp;
+    BudgetStruct *budget;
     gint budget_number = 0;
 
     if (!name)
@@ -660,15 +728,10 @@ gint gsb_data_budget_get_number_by_name ( const gchar *name,
     if (!strlen (name))
 	return FALSE;
 
-    list_tmp = g_slist_find_custom ( budget_list,
-				     name,
-				     (GCompareFunc) gsb_data_budget_get_pointer_from_name_in_glist );
+    budget = gsb_data_budget_get_structure_by_name ( name );
 
-    if ( list_tmp )
+    if ( budget )
     {
-	BudgetStruct *budget;
-
-	budget = list_tmp -> data;
 	budget_number = budget -> budget_number;
     }
     else
@@ -699,8 +762,8 @@ gint gsb_data_budget_get_sub_budget_number_by_name ( gint budget_number,
                         const gchar *name,
                         gboolean create )
 {
-    GSList *list_tmp;
     BudgetStruct *budget;
+    SubBudgetStruct *sub_budget;
     gint sub_budget_number = 0;
 
     if (!name || !strlen (name))
@@ -711,15 +774,10 @@ gint gsb_data_budget_get_sub_budget_number_by_name ( gint budget_number,
     if (!budget)
 	return FALSE;
 
-    list_tmp = g_slist_find_custom ( budget -> sub_budget_list,
-				     name,
-				     (GCompareFunc) gsb_data_budget_get_pointer_from_sub_name_in_glist );
+    sub_budget = gsb_data_budget_get_sub_budget_structure_by_name ( budget, name );
 
-    if ( list_tmp )
+    if ( sub_budget )
     {
-        SubBudgetStruct *sub_budget;
-
-        sub_budget = list_tmp -> data;
         sub_budget_number = sub_budget -> sub_budget_number;
     }
     else
@@ -768,6 +826,62 @@ gint gsb_data_budget_get_pointer_from_sub_name_in_glist ( SubBudgetStruct *sub_b
 }
 
 
+/**
+ * find a budget by its name, case insensitive, with the index of the names
+ * if several budgets have that name, the first in the list is returned
+ *
+ * \param name the name we are looking for
+ *
+ * \return the struct of the budget or NULL if not found
+ * */
+BudgetStruct *gsb_data_budget_get_structure_by_name ( const gchar *name )
+{
+    GSList *list_tmp;
+
+    if ( name && budget_names_index )
+    {
+        list_tmp = utils_str_name_index_lookup ( budget_names_index, name );
+        if ( !list_tmp || !list_tmp -> next )
+            return list_tmp ? list_tmp -> data : NULL;
+    }
+
+    list_tmp = g_slist_find_custom ( budget_list,
+				     name,
+				     (GCompareFunc) gsb_data_budget_get_pointer_from_name_in_glist );
+
+    return list_tmp ? list_tmp -> data : NULL;
+}
+
+
+/**
+ * find a sub-budget by its name, case insensitive, with the index of the names
+ * if several sub-budgets have that name, the first in the list is returned
+ *
+ * \param budget the struct of the budget
+ * \param name the name we are looking for
+ *
+ * \return the struct of the sub-budget or NULL if not found
+ * */
+SubBudgetStruct *gsb_data_budget_get_sub_budget_structure_by_name ( BudgetStruct *budget,
+                        const gchar *name )
+{
+    GSList *list_tmp;
+
+    if ( name && budget -> sub_budget_names_index )
+    {
+        list_tmp = utils_str_name_index_lookup ( budget -> sub_budget_names_index, name );
+        if ( !list_tmp || !list_tmp -> next )
+            return list_tmp ? list_tmp -> data : NULL;
+    }
+
+    list_tmp = g_slist_find_custom ( budget -> sub_budget_list,
+				     name,
+				     (GCompareFunc) gsb_data_budget_get_pointer_from_sub_name_in_glist );
+
+    return list_tmp ? list_tmp -> data : NULL;
+}
+
+
 /**
  * return the name of the budget
  * and the full name (ie budget : sub-budget if no_sub_budget is given)
@@ -835,7 +949,11 @@ gboolean gsb_data_budget_set_name ( gint no_budget,
     /* we free the last name */
 
     if ( budget -> budget_name )
+    {
+        if ( budget_names_index )
+            utils_str_name_index_remove ( budget_names_index, budget -> budget_name, budget );
         g_free (budget -> budget_name);
+    }
 
     /* and copy the new one */
     if ( name )
@@ -843,6 +961,8 @@ gboolean gsb_data_budget_set_name ( gint no_budget,
         GtkWidget *combofix;
 
         budget -> budget_name = my_strdup (name);
+        if ( budget_names_index )
+            utils_str_name_index_add ( budget_names_index, budget -> budget_name, budget );
         combofix = gsb_form_widget_get_widget ( TRANSACTION_FORM_BUDGET );
         if ( combofix )
             gsb_budget_update_combofix ( TRUE );
@@ -893,22 +1013,34 @@ gboolean gsb_data_budget_set_sub_budget_name ( gint no_budget,
                         gint no_sub_budget,
                         const gchar *name )
 {
+    BudgetStruct *budget;
     SubBudgetStruct *sub_budget;
 
+    budget = gsb_data_budget_get_structure ( no_budget );
     sub_budget = gsb_data_budget_get_sub_budget_structure ( no_budget,
 							    no_sub_budget );
 
-    if (!sub_budget)
+    if (!budget || !sub_budget)
 	return FALSE;
 
     /* we free the last name */
 
     if ( sub_budget -> sub_budget_name )
+    {
+        utils_str_name_index_remove ( budget -> sub_budget_names_index,
+                        sub_budget -> sub_budget_name,
+                        sub_budget );
 	g_free (sub_budget -> sub_budget_name);
+    }
 
     /* and copy the new one */
     if ( name )
+    {
 	sub_budget -> sub_budget_name = my_strdup (name);
+        utils_str_name_index_add ( budget -> sub_budget_names_index,
+                        sub_budget -> sub_budget_name,
+                        sub_budget );
+    }
     else
 	sub_budget -> sub_budget_name = NULL;
     return TRUE;
@@ -1233,160 +1365,486 @@ void gsb_data_budget_reset_counters ( void )
 }
 
 /**
- * update the counters of the budgets
+ * tell if the counters of the budgets are up to date, ie they were
+ * computed since the file was loaded, with the current currency of the tree
+ * and the current setting for the archives
+ *
+ * \param
+ *
+ * \return TRUE if the counters can be maintained transaction by transaction
+ * */
+gboolean gsb_data_budget_counters_are_valid ( void )
+{
+    GrisbiWinEtat *w_etat;
+
+    if ( !counters_valid )
+        return FALSE;
+
+    w_etat = grisbi_win_get_w_etat ();
+
+    return ( counters_currency == budgetary_line_tree_currency ()
+             &&
+             counters_with_archives == w_etat->metatree_add_archive_in_totals );
+}
+
+
+
+/**
+ * forget the counters of the budgets, they will be computed again
+ * by the next gsb_data_budget_update_counters
  *
  * \param
  *
  * \return
  * */
-void gsb_data_budget_update_counters ( void )
+void gsb_data_budget_invalidate_counters ( void )
+{
+    counters_valid = FALSE;
+}
+
+
+
+/**
+ * compute again the counters of the budgets from all the transactions,
+ * the archives kept in the cache of the file are counted with their totals
+ *
+ * \param
+ *
+ * \return
+ * */
+void gsb_data_budget_compute_counters ( void )
 {
     GSList *list_tmp_transactions;
+    GSList *archives_totals = NULL;
 	GrisbiWinEtat *w_etat;
 
 	w_etat = grisbi_win_get_w_etat ();
 
     gsb_data_budget_reset_counters ();
+    counters_exponent = gsb_data_currency_get_floating_point ( budgetary_line_tree_currency () );
+    counters_mantissas = g_hash_table_new_full ( g_direct_hash, g_direct_equal,
+                        NULL, (GDestroyNotify) g_array_unref );
 
     if ( w_etat->metatree_add_archive_in_totals )
-        list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
+    {
+        archives_totals = gsb_file_cache_get_archives_totals ( METATREE_BUDGET, budgetary_line_tree_currency () );
+        list_tmp_transactions = gsb_data_transaction_get_loaded_transactions_list ();
+    }
     else
         list_tmp_transactions = gsb_data_transaction_get_transactions_list ();
 
     while ( list_tmp_transactions )
     {
-	gint transaction_number_tmp = gsb_data_transaction_get_transaction_number ( list_tmp_transactions -> data);
+    gint transaction_number_tmp;
+    transaction_number_tmp = gsb_data_transaction_get_transaction_number (
+                        list_tmp_transactions -> data );
 
-	gsb_data_budget_add_transaction_to_budget ( transaction_number_tmp,
-						    gsb_data_transaction_get_budgetary_number ( transaction_number_tmp ),
-						    gsb_data_transaction_get_sub_budgetary_number ( transaction_number_tmp ) );
+    gsb_data_budget_count_transaction ( transaction_number_tmp,
+                        gsb_data_transaction_get_budgetary_number ( transaction_number_tmp ),
+                        gsb_data_transaction_get_sub_budgetary_number (
+                        transaction_number_tmp ),
+                        TRUE );
 
-	list_tmp_transactions = list_tmp_transactions -> next;
+    list_tmp_transactions = list_tmp_transactions -> next;
     }
+    gsb_data_budget_count_archives_totals ( archives_totals );
+    g_slist_free_full ( archives_totals, g_free );
+    gsb_data_budget_sum_balances ();
+
+    counters_valid = TRUE;
+    counters_currency = budgetary_line_tree_currency ();
+    counters_with_archives = w_etat->metatree_add_archive_in_totals;
 }
 
 
+
 /**
- * Add the given transaction to a budget in the counters if no budget
- * is specified, add it to the blank budget.
+ * append the counters of all the budgets and sub-budgets to the arrays,
+ * always in the same order
  *
- * \param transaction_number	Transaction we want to work with.
- * \param budget_id		Budget to add transaction into total.
- * \param sub_budget_id		Sub-budget to add transaction into total.
- */
-void gsb_data_budget_add_transaction_to_budget ( gint transaction_number,
-                        gint budget_id,
-                        gint sub_budget_id )
+ * \param numbers a GArray of gint for the numbers of transactions
+ * \param balances a GArray of GsbReal for the balances
+ *
+ * \return
+ * */
+void gsb_data_budget_get_counters ( GArray *numbers,
+                        GArray *balances )
 {
-    BudgetStruct *budget;
-    SubBudgetStruct *sub_budget;
+    GSList *list_tmp;
+
+    g_array_append_val ( numbers, empty_budget -> budget_nb_transactions );
+    g_array_append_val ( balances, empty_budget -> budget_balance );
+
+    list_tmp = budget_list;
+
+    while ( list_tmp )
+    {
+	BudgetStruct *budget;
+	GSList *sub_list_tmp;
 
-    /* if the transaction is a transfer or a split transaction, don't take it */
-    if (gsb_data_transaction_get_split_of_transaction (transaction_number)
-		||
-		gsb_data_transaction_get_contra_transaction_number (transaction_number) > 0)
+	budget = list_tmp -> data;
+	g_array_append_val ( numbers, budget -> budget_nb_transactions );
+	g_array_append_val ( balances, budget -> budget_balance );
+	g_array_append_val ( numbers, budget -> budget_nb_direct_transactions );
+	g_array_append_val ( balances, budget -> budget_direct_balance );
+
+	sub_list_tmp = budget -> sub_budget_list;
+
+	while ( sub_list_tmp )
 	{
-		return;
+	    SubBudgetStruct *sub_budget;
+
+	    sub_budget = sub_list_tmp -> data;
+	    g_array_append_val ( numbers, sub_budget -> sub_budget_nb_transactions );
+	    g_array_append_val ( balances, sub_budget -> sub_budget_balance );
+
+	    sub_list_tmp = sub_list_tmp -> next;
 	}
+	list_tmp = list_tmp -> next;
+    }
+}
 
-	budget = gsb_data_budget_get_structure (  budget_id );
-    sub_budget = gsb_data_budget_get_sub_budget_structure ( budget_id ,
-							    sub_budget_id );
 
-    /* should not happen, this is if the transaction has a budget which doesn't exist
-     * we show a debug warning and get without budget */
-    if (!budget)
+
+/**
+ * debug only : compare the counters maintained transaction by transaction
+ * with a full count, show a warning if they differ
+ * at the end, the counters are the ones of the full count
+ *
+ * \param
+ *
+ * \return
+ * */
+void gsb_data_budget_check_counters ( void )
+{
+    GArray *numbers;
+    GArray *balances;
+    GArray *computed_numbers;
+    GArray *computed_balances;
+    guint i;
+    gint nb_errors = 0;
+
+    numbers = g_array_new ( FALSE, FALSE, sizeof ( gint ));
+    balances = g_array_new ( FALSE, FALSE, sizeof ( GsbReal ));
+    computed_numbers = g_array_new ( FALSE, FALSE, sizeof ( gint ));
+    computed_balances = g_array_new ( FALSE, FALSE, sizeof ( GsbReal ));
+
+    gsb_data_budget_get_counters ( numbers, balances );
+    gsb_data_budget_compute_counters ();
+    gsb_data_budget_get_counters ( computed_numbers, computed_balances );
+
+    for ( i = 0 ; i < numbers -> len ; i++ )
+    {
+        if ( g_array_index ( numbers, gint, i ) != g_array_index ( computed_numbers, gint, i )
+             ||
+             gsb_real_cmp ( g_array_index ( balances, GsbReal, i ),
+                        g_array_index ( computed_balances, GsbReal, i )))
+            nb_errors++;
+    }
+
+    if ( nb_errors )
     {
         gchar *tmpstr;
 
-        tmpstr = g_strdup_printf ( "The transaction %d has a budget %d and sub-budget %d but they don't exist.",
-                       transaction_number,
-                       budget_id,
-                       sub_budget_id );
+        tmpstr = g_strdup_printf ( "%d counters of the budgets were wrong, they are computed again.",
+                       nb_errors );
         warning_debug (tmpstr);
         g_free (tmpstr);
-        budget = empty_budget;
     }
 
-    /* now budget is on the budget structure or on empty_budget */
-    if ( budget )
+    g_array_free ( numbers, TRUE );
+    g_array_free ( balances, TRUE );
+    g_array_free ( computed_numbers, TRUE );
+    g_array_free ( computed_balances, TRUE );
+}
+
+
+
+/**
+ * update the counters of the budgets
+ * the counters are computed from all the transactions only the first time,
+ * after that they are maintained by the transactions themselves
+ * (see gsb_data_budget_add_transaction_to_budget) so that function is fast
+ *
+ * \param
+ *
+ * \return
+ * */
+void gsb_data_budget_update_counters ( void )
+{
+    if ( !gsb_data_budget_counters_are_valid () )
+        gsb_data_budget_compute_counters ();
+    else if ( debug_get_debug_mode () )
+        gsb_data_budget_check_counters ();
+}
+
+
+
+/**
+ * add an amount to a balance of the counters, or keep it to be summed
+ * with the other amounts of that balance when the counters are computed again
+ *
+ * \param balance the balance of a budget or a sub-budget
+ * \param amount
+ *
+ * \return
+ * */
+void gsb_data_budget_count_balance ( GsbReal *balance,
+                        GsbReal amount )
+{
+    GArray *mantissas;
+
+    if ( !counters_mantissas )
+    {
+        *balance = gsb_real_add ( *balance, amount );
+        return;
+    }
+
+    mantissas = g_hash_table_lookup ( counters_mantissas, balance );
+    if ( !mantissas )
+    {
+        mantissas = g_array_new ( FALSE, FALSE, sizeof ( gint64 ));
+        g_hash_table_insert ( counters_mantissas, balance, mantissas );
+    }
+    gsb_real_append_mantissa ( mantissas, amount, counters_exponent );
+}
+
+
+
+/**
+ * add the amounts kept while the counters are computed again to their balances
+ *
+ * \param
+ *
+ * \return
+ * */
+void gsb_data_budget_sum_balances ( void )
+{
+    GHashTableIter iter;
+    gpointer key;
+    gpointer value;
+
+    g_hash_table_iter_init ( &iter, counters_mantissas );
+    while ( g_hash_table_iter_next ( &iter, &key, &value ))
     {
-	budget -> budget_nb_transactions ++;
-    budget -> budget_balance = gsb_real_add ( budget -> budget_balance,
-                        gsb_data_transaction_get_adjusted_amount_for_currency (
-                        transaction_number, budgetary_line_tree_currency (), -1));
+        GsbReal *balance = key;
+        GArray *mantissas = value;
+
+        *balance = gsb_real_add ( *balance,
+                        gsb_real_sum_mantissas ( ( gint64 * ) mantissas -> data,
+                        mantissas -> len,
+                        counters_exponent ));
     }
+    g_hash_table_destroy ( counters_mantissas );
+    counters_mantissas = NULL;
+}
+
+
+
+/**
+ * add or remove some transactions to/from the counters of a budget
+ *
+ * \param budget the budget or the blank budget
+ * \param sub_budget the sub-budget or NULL
+ * \param step the number of transactions to add, negative to remove them
+ * \param amount the amount to add
+ *
+ * \return
+ * */
+void gsb_data_budget_count_amount ( BudgetStruct *budget,
+                        SubBudgetStruct *sub_budget,
+                        gint step,
+                        GsbReal amount )
+{
+    budget -> budget_nb_transactions += step;
+    gsb_data_budget_count_balance ( &budget -> budget_balance, amount );
+    if ( !budget -> budget_nb_transactions ) /* Cope with float errors */
+        budget -> budget_balance = null_real;
 
-    /* if we are on empty_budget, no sub-budget */
+    /* if we were on empty budget, no sub-budget */
     if (budget == empty_budget)
 	return;
 
     if ( sub_budget )
     {
-	sub_budget -> sub_budget_nb_transactions ++;
-    sub_budget -> sub_budget_balance = gsb_real_add (sub_budget -> sub_budget_balance,
-                        gsb_data_transaction_get_adjusted_amount_for_currency (
-                        transaction_number, budgetary_line_tree_currency (), -1));
+	sub_budget -> sub_budget_nb_transactions += step;
+	gsb_data_budget_count_balance ( &sub_budget -> sub_budget_balance, amount );
+	if ( !sub_budget -> sub_budget_nb_transactions ) /* Cope with float errors */
+	    sub_budget -> sub_budget_balance = null_real;
     }
     else
     {
-	budget -> budget_nb_direct_transactions ++;
-    budget -> budget_direct_balance = gsb_real_add (budget -> budget_direct_balance,
-                            gsb_data_transaction_get_adjusted_amount_for_currency (
-                            transaction_number, budgetary_line_tree_currency (), -1));
+	budget -> budget_nb_direct_transactions += step;
+	gsb_data_budget_count_balance ( &budget -> budget_direct_balance, amount );
+	if ( !budget -> budget_nb_direct_transactions ) /* Cope with float errors */
+	    budget -> budget_direct_balance = null_real;
     }
 }
 
+
+
 /**
- * remove the given transaction to its budget in the counters
- * if the transaction has no budget, remove it to the blank budget
+ * add the totals of the archives kept in the cache of the file to the counters,
+ * the totals are in the currency of the tree
+ *
+ * \param archives_totals a list of GsbFileCacheArchiveTotal
+ *
+ * \return
+ * */
+void gsb_data_budget_count_archives_totals ( GSList *archives_totals )
+{
+    GSList *tmp_list;
+
+    for ( tmp_list = archives_totals; tmp_list; tmp_list = tmp_list -> next )
+    {
+	GsbFileCacheArchiveTotal *total;
+	BudgetStruct *budget;
+
+	total = tmp_list -> data;
+	if ( !total -> nb_counted )
+	    continue;
+
+	budget = gsb_data_budget_get_structure ( total -> div_number );
+	if ( !budget )
+	    budget = empty_budget;
+
+	gsb_data_budget_count_amount ( budget,
+                        gsb_data_budget_get_sub_budget_structure ( total -> div_number,
+                        total -> sub_div_number ),
+                        total -> nb_counted,
+                        total -> amount );
+    }
+}
+
+
+
+/**
+ * add or remove the given transaction to/from the counters of a budget
+ * if no budget is specified, use the blank budget.
+ * the transfers and the split transactions are not counted
  *
  * \param transaction_number the transaction we want to work with
+ * \param budget_id
+ * \param sub_budget_id
+ * \param add TRUE to add the transaction, FALSE to remove it
  *
  * \return
  * */
-void gsb_data_budget_remove_transaction_from_budget ( gint transaction_number )
+void gsb_data_budget_count_transaction ( gint transaction_number,
+                        gint budget_id,
+                        gint sub_budget_id,
+                        gboolean add )
 {
     BudgetStruct *budget;
     SubBudgetStruct *sub_budget;
+    GsbReal amount;
+    gint step;
 
-    budget = gsb_data_budget_get_structure ( gsb_data_transaction_get_budgetary_number (transaction_number));
-    sub_budget = gsb_data_budget_get_sub_budget_structure ( gsb_data_transaction_get_budgetary_number (transaction_number),
-							    gsb_data_transaction_get_sub_budgetary_number (transaction_number));
+    if ( !gsb_data_budget_transaction_is_counted ( transaction_number ) )
+	return;
 
-    if ( budget )
-    {
-	budget -> budget_nb_transactions --;
-	budget -> budget_balance = gsb_real_sub ( budget -> budget_balance,
-						  gsb_data_transaction_get_adjusted_amount_for_currency ( transaction_number,
-													  budgetary_line_tree_currency (), -1));
-	if ( !budget -> budget_nb_transactions ) /* Cope with float errors */
-	    budget -> budget_balance = null_real;
-    }
+    budget = gsb_data_budget_get_structure ( budget_id );
+    sub_budget = gsb_data_budget_get_sub_budget_structure ( budget_id,
+								  sub_budget_id );
 
-    if ( sub_budget )
+    /* should not happen, this is if the transaction has a budget which doesn't exist
+     * we show a debug warning and get without budget */
+    if (!budget)
     {
-	sub_budget -> sub_budget_nb_transactions --;
-	sub_budget -> sub_budget_balance = gsb_real_sub ( sub_budget -> sub_budget_balance,
-							  gsb_data_transaction_get_adjusted_amount_for_currency ( transaction_number,
-														  budgetary_line_tree_currency (), -1));
-	if ( !sub_budget -> sub_budget_nb_transactions ) /* Cope with float errors */
-	    sub_budget -> sub_budget_balance = null_real;
+        gchar *tmpstr;
+
+        tmpstr = g_strdup_printf ( "The transaction %d has a budget %d and sub-budget %d but they don't exist.",
+                       transaction_number,
+                       budget_id,
+                       sub_budget_id );
+        warning_debug (tmpstr);
+        g_free (tmpstr);
+        budget = empty_budget;
     }
+
+    amount = gsb_data_transaction_get_adjusted_amount_for_currency ( transaction_number,
+                        budgetary_line_tree_currency (), -1);
+    if ( add )
+        step = 1;
     else
     {
-	if ( budget )
-	{
-	    budget -> budget_nb_direct_transactions --;
-	    budget -> budget_direct_balance = gsb_real_sub ( budget -> budget_direct_balance,
-							     gsb_data_transaction_get_adjusted_amount_for_currency ( transaction_number,
-														     budgetary_line_tree_currency (), -1));
-	}
+        step = -1;
+        amount = gsb_real_opposite ( amount );
     }
+
+    gsb_data_budget_count_amount ( budget, sub_budget, step, amount );
+}
+
+
+
+/**
+ * Add the given transaction to a budget in the counters if no
+ * budget is specified, add it to the blank budget.
+ * called when a transaction is created or changed, do nothing
+ * if the counters are not computed yet
+ *
+ * \param transaction_number the transaction we want to work with
+ * \param budget_id
+ * \param sub_budget_id
+ *
+ * \return
+ * */
+void gsb_data_budget_add_transaction_to_budget ( gint transaction_number,
+						     gint budget_id,
+						     gint sub_budget_id )
+{
+    if ( !gsb_data_budget_counters_are_valid () )
+        return;
+
+    gsb_data_budget_count_transaction ( transaction_number,
+                        budget_id,
+                        sub_budget_id,
+                        TRUE );
+}
+
+
+/**
+ * remove the given transaction to its budget in the counters
+ * if the transaction has no budget, remove it to the blank budget
+ * called when a transaction is deleted or before it's changed, do nothing
+ * if the counters are not computed yet
+ *
+ * \param transaction_number the transaction we want to work with
+ *
+ * \return
+ * */
+void gsb_data_budget_remove_transaction_from_budget ( gint transaction_number )
+{
+    if ( !gsb_data_budget_counters_are_valid () )
+        return;
+
+    gsb_data_budget_count_transaction ( transaction_number,
+                        gsb_data_transaction_get_budgetary_number ( transaction_number ),
+                        gsb_data_transaction_get_sub_budgetary_number ( transaction_number ),
+                        FALSE );
 }
 
 
 
+/**
+ * tell if a transaction is counted in the counters of its budget,
+ * the transfers and the split transactions are not counted
+ *
+ * \param transaction_number
+ *
+ * \return TRUE if the transaction is counted
+ * */
+gboolean gsb_data_budget_transaction_is_counted ( gint transaction_number )
+{
+    if ( gsb_data_transaction_get_split_of_transaction ( transaction_number )
+	 ||
+	 gsb_data_transaction_get_contra_transaction_number ( transaction_number ) > 0 )
+	return FALSE;
+
+    return TRUE;
+}
+
+
 
 /**
  * Find if two sub budgets are the same
@@ -1611,17 +2069,13 @@ gint gsb_data_budget_test_create_budget ( gint no_budget,
                         const gchar *name,
                         gint budget_type )
 {
-    GSList *list_tmp;
     gint budget_number = 0;
     BudgetStruct *budget;
 
-    list_tmp = g_slist_find_custom ( budget_list,
-                        name,
-                        (GCompareFunc) gsb_data_budget_get_pointer_from_name_in_glist );
+    budget = gsb_data_budget_get_structure_by_name ( name );
 
-    if ( list_tmp )
+    if ( budget )
     {
-        budget = list_tmp->data;
         return budget->budget_number;
     }
     else
@@ -1659,7 +2113,6 @@ gboolean gsb_data_budget_test_create_sub_budget ( gint no_budget,
                         gint no_sub_budget,
                         const gchar *name )
 {
-    GSList *list_tmp;
     BudgetStruct *budget;
     SubBudgetStruct *sub_budget;
 
@@ -1667,11 +2120,7 @@ gboolean gsb_data_budget_test_create_sub_budget ( gint no_budget,
     if (NULL == budget)
         return FALSE;
 
-    list_tmp = g_slist_find_custom ( budget->sub_budget_list,
-                        name,
-                        (GCompareFunc) gsb_data_budget_get_pointer_from_sub_name_in_glist );
-
-    if ( list_tmp )
+    if ( gsb_data_budget_get_sub_budget_structure_by_name ( budget, name ) )
         return TRUE;
     else
     {
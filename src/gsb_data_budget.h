@@ -42,6 +42,7 @@ gpointer 	gsb_data_budget_get_sub_budget_structure 		(gint no_budget,
 															 gint no_sub_budget);
 gint 		gsb_data_budget_get_type 						(gint no_budget);
 gboolean 	gsb_data_budget_init_variables 					(gboolean cleanup);
+void 		gsb_data_budget_invalidate_counters 			(void);
 gint 		gsb_data_budget_new_sub_budget_with_number 		(gint number,
 															 gint budget_number);
 gint 		gsb_data_budget_new_with_number 				(gint number);
@@ -65,6 +66,7 @@ gint 		gsb_data_budget_test_create_budget 				(gint no_budget,
 gboolean 	gsb_data_budget_test_create_sub_budget 			(gint no_budget,
 															 gint no_sub_budget,
 															 const gchar *name);
+gboolean	gsb_data_budget_transaction_is_counted			(gint transaction_number);
 void 		gsb_data_budget_update_counters 				(void);
 gchar * 	gsb_debug_duplicate_budget_check 				(void);
 gboolean 	gsb_debug_duplicate_budget_fix 					(void);
@@ -39,10 +39,12 @@
 #include "meta_categories.h"
 #include "gsb_category.h"
 #include "gsb_data_account.h"
+#include "gsb_data_currency.h"
 #include "gsb_data_scheduled.h"
 #include "gsb_data_form.h"
 #include "gsb_data_mix.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file_cache.h"
 #include "gsb_form_widget.h"
 #include "gsb_real.h"
 #include "utils_str.h"
@@ -61,6 +63,7 @@ struct _CategoryStruct
     gint category_type;		/**< 0:credit / 1:debit / 2:special (transfert, split...) */
 
     GSList *sub_category_list;
+    GHashTable *sub_category_names_index;	/**< index of the sub-categories by name */
 
     /** @name gui category list content (not saved) */
     gint category_nb_transactions;
@@ -93,10 +96,29 @@ static void _gsb_data_category_free ( CategoryStruct *category );
 static void _gsb_data_sub_category_free ( SubCategoryStruct *sub_category );
 static GSList *gsb_data_category_append_sub_category_to_list ( GSList *list_category,
 							GSList *sub_category_list );
+static void gsb_data_category_check_counters ( void );
+static void gsb_data_category_compute_counters ( void );
+static void gsb_data_category_count_amount ( CategoryStruct *category,
+                        SubCategoryStruct *sub_category,
+                        gint step,
+                        GsbReal amount );
+static void gsb_data_category_count_archives_totals ( GSList *archives_totals );
+static void gsb_data_category_count_balance ( GsbReal *balance,
+                        GsbReal amount );
+static void gsb_data_category_count_transaction ( gint transaction_number,
+                        gint category_id,
+                        gint sub_category_id,
+                        gboolean add );
+static gboolean gsb_data_category_counters_are_valid ( void );
+static void gsb_data_category_get_counters ( GArray *numbers,
+                        GArray *balances );
 static gint gsb_data_category_get_pointer_from_name_in_glist ( CategoryStruct *category,
 							const gchar *name );
 static gint gsb_data_category_get_pointer_from_sub_name_in_glist ( SubCategoryStruct *sub_category,
 							    const gchar *name );
+static CategoryStruct *gsb_data_category_get_structure_by_name ( const gchar *name );
+static SubCategoryStruct *gsb_data_category_get_sub_category_structure_by_name ( CategoryStruct *category,
+                        const gchar *name );
 static gpointer gsb_data_category_get_structure_in_list ( gint no_category,
                         GSList *list );
 static gint gsb_data_category_max_number ( void );
@@ -105,6 +127,7 @@ static gint gsb_data_category_new ( const gchar *name );
 static gint gsb_data_category_new_sub_category ( gint category_number,
                         const gchar *name );
 static void gsb_data_category_reset_counters ( void );
+static void gsb_data_category_sum_balances ( void );
 static gint gsb_data_sub_category_compare ( SubCategoryStruct * a, SubCategoryStruct * b );
 /*END_STATIC*/
 
@@ -119,10 +142,25 @@ static GSList *category_list = NULL;
 static CategoryStruct *category_buffer;
 static SubCategoryStruct *sub_category_buffer;
 
+/** index of the categories by name, see utils_str_name_index_new */
+static GHashTable *category_names_index = NULL;
+
 /** a empty category for the list of categories
  * the number of the empty category is 0 */
 static CategoryStruct *empty_category = NULL;
 
+/** TRUE when the counters are computed, they are then maintained transaction
+ * by transaction ; with the currency and the archives setting used to compute them */
+static gboolean counters_valid = FALSE;
+static gint counters_currency = 0;
+static gboolean counters_with_archives = FALSE;
+
+/** while the counters are computed again, the amounts of each balance are kept
+ * in a GArray of mantissas with the exponent of the currency of the tree,
+ * they are summed by gsb_real_sum_mantissas at the end ; NULL the rest of the time */
+static GHashTable *counters_mantissas = NULL;
+static gint counters_exponent = 0;
+
 
 
 /**
@@ -150,9 +188,18 @@ gboolean gsb_data_category_init_variables (gboolean cleanup)
 	    g_slist_free (category_list);
     }
 
+    if ( category_names_index )
+    {
+        g_hash_table_destroy ( category_names_index );
+        category_names_index = NULL;
+    }
+
+    counters_valid = FALSE;
+
 	if (cleanup)
 	{
 		category_list = NULL;
+		category_names_index = utils_str_name_index_new ();
 
 		category_buffer = NULL;
 		sub_category_buffer = NULL;
@@ -503,9 +550,16 @@ gboolean gsb_data_category_remove ( gint no_category )
     if (!category)
 	return FALSE;
 
+    if ( category_names_index )
+        utils_str_name_index_remove ( category_names_index, category -> category_name, category );
+
     category_list = g_slist_remove ( category_list,
 				     category );
 
+    /* the transactions still counted in that category cannot be removed from the counters anymore */
+    if ( category -> category_nb_transactions )
+        counters_valid = FALSE;
+
     _gsb_data_category_free (category);
 
 	combofix = gsb_form_widget_get_widget (TRANSACTION_FORM_CATEGORY);
@@ -535,6 +589,8 @@ void _gsb_data_category_free ( CategoryStruct *category )
         }
         g_slist_free ( category -> sub_category_list );
     }
+    if ( category -> sub_category_names_index )
+        g_hash_table_destroy ( category -> sub_category_names_index );
     if ( category -> category_name )
         g_free ( category -> category_name );
     g_free ( category );
@@ -583,9 +639,17 @@ gboolean gsb_data_category_sub_category_remove ( gint no_category,
 	!sub_category)
 	return FALSE;
 
+    if ( category -> sub_category_names_index )
+        utils_str_name_index_remove ( category -> sub_category_names_index,
+                        sub_category -> sub_category_name,
+                        sub_category );
+
     category -> sub_category_list = g_slist_remove ( category -> sub_category_list,
 						     sub_category );
 
+    if ( sub_category -> sub_category_nb_transactions )
+        counters_valid = FALSE;
+
     _gsb_data_sub_category_free (sub_category);
 
 	combofix = gsb_form_widget_get_widget (TRANSACTION_FORM_CATEGORY);
@@ -659,6 +723,12 @@ gint gsb_data_category_new_sub_category_with_number_and_name ( gint number,
                             sub_category,
                             gsb_sub_category_cmp);
 
+    if ( !category -> sub_category_names_index )
+        category -> sub_category_names_index = utils_str_name_index_new ();
+    utils_str_name_index_add ( category -> sub_category_names_index,
+                        sub_category -> sub_category_name,
+                        sub_category );
+
     sub_category_buffer = sub_category;
 
     return sub_category -> sub_category_number;
@@ -739,18 +809,13 @@ gint gsb_data_category_get_number_by_name ( const gchar *name,
                         gboolean create,
 					    gint category_type )
 {
-    GSList *list_tmp;
+    CategoryStruct *category;
     gint category_number = 0;
 
-    list_tmp = g_slist_find_custom ( category_list,
-				     name,
-				     (GCompareFunc) gsb_data_category_get_pointer_from_name_in_glist );
+    category = gsb_data_category_get_structure_by_name ( name );
 
-    if ( list_tmp )
+    if ( category )
     {
-	CategoryStruct *category;
-
-	category = list_tmp -> data;
 	category_number = category -> category_number;
     }
     else
@@ -781,8 +846,8 @@ gint gsb_data_category_get_sub_category_number_by_name ( gint category_number,
 							 const gchar *name,
 							 gboolean create )
 {
-    GSList *list_tmp;
     CategoryStruct *category;
+    SubCategoryStruct *sub_category;
     gint sub_category_number = 0;
 
     category = gsb_data_category_get_structure ( category_number );
@@ -790,15 +855,10 @@ gint gsb_data_category_get_sub_category_number_by_name ( gint category_number,
     if (!category)
 	return 0;
 
-    list_tmp = g_slist_find_custom ( category -> sub_category_list,
-				     name,
-				     (GCompareFunc) gsb_data_category_get_pointer_from_sub_name_in_glist );
+    sub_category = gsb_data_category_get_sub_category_structure_by_name ( category, name );
 
-    if ( list_tmp )
+    if ( sub_category )
     {
-	SubCategoryStruct *sub_category;
-
-	sub_category = list_tmp -> data;
 	sub_category_number = sub_category -> sub_category_number;
     }
     else
@@ -852,6 +912,60 @@ gint gsb_data_category_get_pointer_from_sub_name_in_glist ( SubCategoryStruct *s
 }
 
 
+/**
+ * find a category by its name, case insensitive, with the index of the names
+ * if several categories have that name, the first in the list is returned
+ *
+ * \param name the name we are looking for
+ *
+ * \return the struct of the category or NULL if not found
+ * */
+CategoryStruct *gsb_data_category_get_structure_by_name ( const gchar *name )
+{
+    GSList *list_tmp;
+
+    if ( name && category_names_index )
+    {
+        list_tmp = utils_str_name_index_lookup ( category_names_index, name );
+        if ( !list_tmp || !list_tmp -> next )
+            return list_tmp ? list_tmp -> data : NULL;
+    }
+
+    list_tmp = g_slist_find_custom ( category_list,
+				     name,
+				     (GCompareFunc) gsb_data_category_get_pointer_from_name_in_glist );
+
+    return list_tmp ? list_tmp -> data : NULL;
+}
+
+
+/**
+ * find a sub-category by its name, case insensitive, with the index of the names
+ * if several sub-categories have that name, the first in the list is returned
+ *
+ * \param category the struct of the category
+ * \param name the name we are looking for
+ *
+ * \return the struct of the sub-category or NULL if not found
+ * */
+SubCategoryStruct *gsb_data_category_get_sub_category_structure_by_name ( CategoryStruct *category,
+                        const gchar *name )
+{
+    GSList *list_tmp;
+
+    if ( !name || !category -> sub_category_names_index )
+        return NULL;
+
+    list_tmp = utils_str_name_index_lookup ( category -> sub_category_names_index, name );
+    if ( list_tmp && list_tmp -> next )
+        list_tmp = g_slist_find_custom ( category -> sub_category_list,
+                        name,
+                        (GCompareFunc) gsb_data_category_get_pointer_from_sub_name_in_glist );
+
+    return list_tmp ? list_tmp -> data : NULL;
+}
+
+
 /**
  * return the name of the category
  * and the full name (ie category : sub-category if no_sub_category is given)
@@ -925,7 +1039,11 @@ gboolean gsb_data_category_set_name ( gint no_category,
 
     /* we free the last name */
     if ( category -> category_name )
+    {
+        if ( category_names_index )
+            utils_str_name_index_remove ( category_names_index, category -> category_name, category );
         g_free ( category -> category_name );
+    }
 
     /* and copy the new one */
     if ( name )
@@ -933,6 +1051,8 @@ gboolean gsb_data_category_set_name ( gint no_category,
         GtkWidget *combofix;
 
         category -> category_name = my_strdup ( name );
+        if ( category_names_index )
+            utils_str_name_index_add ( category_names_index, category -> category_name, category );
         combofix = gsb_form_widget_get_widget ( TRANSACTION_FORM_CATEGORY);
         if ( combofix )
             gsb_category_update_combofix ( TRUE );
@@ -983,18 +1103,25 @@ gboolean gsb_data_category_set_sub_category_name ( gint no_category,
 						   gint no_sub_category,
 						   const gchar *name )
 {
+    CategoryStruct *category;
     SubCategoryStruct *sub_category;
 
+    category = gsb_data_category_get_structure ( no_category );
     sub_category = gsb_data_category_get_sub_category_structure ( no_category,
 								  no_sub_category );
 
-    if ( !sub_category )
+    if ( !category || !sub_category )
         return FALSE;
 
     /* we free the last name */
 
     if ( sub_category -> sub_category_name )
+    {
+        utils_str_name_index_remove ( category -> sub_category_names_index,
+                        sub_category -> sub_category_name,
+                        sub_category );
 	g_free (sub_category -> sub_category_name);
+    }
 
     /* and copy the new one */
     if ( name )
@@ -1002,6 +1129,9 @@ gboolean gsb_data_category_set_sub_category_name ( gint no_category,
         GtkWidget *combofix;
 
         sub_category -> sub_category_name = my_strdup ( name );
+        utils_str_name_index_add ( category -> sub_category_names_index,
+                        sub_category -> sub_category_name,
+                        sub_category );
         combofix = gsb_form_widget_get_widget ( TRANSACTION_FORM_CATEGORY);
         if ( combofix )
             gsb_category_update_combofix ( TRUE );
@@ -1399,23 +1529,71 @@ void gsb_data_category_reset_counters ( void )
 
 
 /**
- * update the counters of the categories
+ * tell if the counters of the categories are up to date, ie they were
+ * computed since the file was loaded, with the current currency of the tree
+ * and the current setting for the archives
+ *
+ * \param
+ *
+ * \return TRUE if the counters can be maintained transaction by transaction
+ * */
+gboolean gsb_data_category_counters_are_valid ( void )
+{
+    GrisbiWinEtat *w_etat;
+
+    if ( !counters_valid )
+        return FALSE;
+
+    w_etat = grisbi_win_get_w_etat ();
+
+    return ( counters_currency == category_tree_currency ()
+             &&
+             counters_with_archives == w_etat->metatree_add_archive_in_totals );
+}
+
+
+
+/**
+ * forget the counters of the categories, they will be computed again
+ * by the next gsb_data_category_update_counters
  *
  * \param
  *
  * \return
  * */
-void gsb_data_category_update_counters ( void )
+void gsb_data_category_invalidate_counters ( void )
+{
+    counters_valid = FALSE;
+}
+
+
+
+/**
+ * compute again the counters of the categories from all the transactions,
+ * the archives kept in the cache of the file are counted with their totals
+ *
+ * \param
+ *
+ * \return
+ * */
+void gsb_data_category_compute_counters ( void )
 {
     GSList *list_tmp_transactions;
+    GSList *archives_totals = NULL;
 	GrisbiWinEtat *w_etat;
 
 	w_etat = grisbi_win_get_w_etat ();
 
     gsb_data_category_reset_counters ();
+    counters_exponent = gsb_data_currency_get_floating_point ( category_tree_currency () );
+    counters_mantissas = g_hash_table_new_full ( g_direct_hash, g_direct_equal,
+                        NULL, (GDestroyNotify) g_array_unref );
 
     if ( w_etat->metatree_add_archive_in_totals )
-        list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
+    {
+        archives_totals = gsb_file_cache_get_archives_totals ( METATREE_CATEGORY, category_tree_currency () );
+        list_tmp_transactions = gsb_data_transaction_get_loaded_transactions_list ();
+    }
     else
         list_tmp_transactions = gsb_data_transaction_get_transactions_list ();
 
@@ -1425,36 +1603,308 @@ void gsb_data_category_update_counters ( void )
     transaction_number_tmp = gsb_data_transaction_get_transaction_number (
                         list_tmp_transactions -> data );
 
-    gsb_data_category_add_transaction_to_category ( transaction_number_tmp,
+    gsb_data_category_count_transaction ( transaction_number_tmp,
                         gsb_data_transaction_get_category_number ( transaction_number_tmp ),
                         gsb_data_transaction_get_sub_category_number (
-                        transaction_number_tmp ) );
+                        transaction_number_tmp ),
+                        TRUE );
 
     list_tmp_transactions = list_tmp_transactions -> next;
     }
+    gsb_data_category_count_archives_totals ( archives_totals );
+    g_slist_free_full ( archives_totals, g_free );
+    gsb_data_category_sum_balances ();
+
+    counters_valid = TRUE;
+    counters_currency = category_tree_currency ();
+    counters_with_archives = w_etat->metatree_add_archive_in_totals;
 }
 
 
 
 /**
- * Add the given transaction to a category in the counters if no
- * category is specified, add it to the blank category.
+ * append the counters of all the categories and sub-categories to the arrays,
+ * always in the same order
+ *
+ * \param numbers a GArray of gint for the numbers of transactions
+ * \param balances a GArray of GsbReal for the balances
+ *
+ * \return
+ * */
+void gsb_data_category_get_counters ( GArray *numbers,
+                        GArray *balances )
+{
+    GSList *list_tmp;
+
+    g_array_append_val ( numbers, empty_category -> category_nb_transactions );
+    g_array_append_val ( balances, empty_category -> category_balance );
+
+    list_tmp = category_list;
+
+    while ( list_tmp )
+    {
+	CategoryStruct *category;
+	GSList *sub_list_tmp;
+
+	category = list_tmp -> data;
+	g_array_append_val ( numbers, category -> category_nb_transactions );
+	g_array_append_val ( balances, category -> category_balance );
+	g_array_append_val ( numbers, category -> category_nb_direct_transactions );
+	g_array_append_val ( balances, category -> category_direct_balance );
+
+	sub_list_tmp = category -> sub_category_list;
+
+	while ( sub_list_tmp )
+	{
+	    SubCategoryStruct *sub_category;
+
+	    sub_category = sub_list_tmp -> data;
+	    g_array_append_val ( numbers, sub_category -> sub_category_nb_transactions );
+	    g_array_append_val ( balances, sub_category -> sub_category_balance );
+
+	    sub_list_tmp = sub_list_tmp -> next;
+	}
+	list_tmp = list_tmp -> next;
+    }
+}
+
+
+
+/**
+ * debug only : compare the counters maintained transaction by transaction
+ * with a full count, show a warning if they differ
+ * at the end, the counters are the ones of the full count
+ *
+ * \param
+ *
+ * \return
+ * */
+void gsb_data_category_check_counters ( void )
+{
+    GArray *numbers;
+    GArray *balances;
+    GArray *computed_numbers;
+    GArray *computed_balances;
+    guint i;
+    gint nb_errors = 0;
+
+    numbers = g_array_new ( FALSE, FALSE, sizeof ( gint ));
+    balances = g_array_new ( FALSE, FALSE, sizeof ( GsbReal ));
+    computed_numbers = g_array_new ( FALSE, FALSE, sizeof ( gint ));
+    computed_balances = g_array_new ( FALSE, FALSE, sizeof ( GsbReal ));
+
+    gsb_data_category_get_counters ( numbers, balances );
+    gsb_data_category_compute_counters ();
+    gsb_data_category_get_counters ( computed_numbers, computed_balances );
+
+    for ( i = 0 ; i < numbers -> len ; i++ )
+    {
+        if ( g_array_index ( numbers, gint, i ) != g_array_index ( computed_numbers, gint, i )
+             ||
+             gsb_real_cmp ( g_array_index ( balances, GsbReal, i ),
+                        g_array_index ( computed_balances, GsbReal, i )))
+            nb_errors++;
+    }
+
+    if ( nb_errors )
+    {
+        gchar *tmpstr;
+
+        tmpstr = g_strdup_printf ( "%d counters of the categories were wrong, they are computed again.",
+                       nb_errors );
+        warning_debug (tmpstr);
+        g_free (tmpstr);
+    }
+
+    g_array_free ( numbers, TRUE );
+    g_array_free ( balances, TRUE );
+    g_array_free ( computed_numbers, TRUE );
+    g_array_free ( computed_balances, TRUE );
+}
+
+
+
+/**
+ * update the counters of the categories
+ * the counters are computed from all the transactions only the first time,
+ * after that they are maintained by the transactions themselves
+ * (see gsb_data_category_add_transaction_to_category) so that function is fast
+ *
+ * \param
+ *
+ * \return
+ * */
+void gsb_data_category_update_counters ( void )
+{
+    if ( !gsb_data_category_counters_are_valid () )
+        gsb_data_category_compute_counters ();
+    else if ( debug_get_debug_mode () )
+        gsb_data_category_check_counters ();
+}
+
+
+
+/**
+ * add an amount to a balance of the counters, or keep it to be summed
+ * with the other amounts of that balance when the counters are computed again
+ *
+ * \param balance the balance of a category or a sub-category
+ * \param amount
+ *
+ * \return
+ * */
+void gsb_data_category_count_balance ( GsbReal *balance,
+                        GsbReal amount )
+{
+    GArray *mantissas;
+
+    if ( !counters_mantissas )
+    {
+        *balance = gsb_real_add ( *balance, amount );
+        return;
+    }
+
+    mantissas = g_hash_table_lookup ( counters_mantissas, balance );
+    if ( !mantissas )
+    {
+        mantissas = g_array_new ( FALSE, FALSE, sizeof ( gint64 ));
+        g_hash_table_insert ( counters_mantissas, balance, mantissas );
+    }
+    gsb_real_append_mantissa ( mantissas, amount, counters_exponent );
+}
+
+
+
+/**
+ * add the amounts kept while the counters are computed again to their balances
+ *
+ * \param
+ *
+ * \return
+ * */
+void gsb_data_category_sum_balances ( void )
+{
+    GHashTableIter iter;
+    gpointer key;
+    gpointer value;
+
+    g_hash_table_iter_init ( &iter, counters_mantissas );
+    while ( g_hash_table_iter_next ( &iter, &key, &value ))
+    {
+        GsbReal *balance = key;
+        GArray *mantissas = value;
+
+        *balance = gsb_real_add ( *balance,
+                        gsb_real_sum_mantissas ( ( gint64 * ) mantissas -> data,
+                        mantissas -> len,
+                        counters_exponent ));
+    }
+    g_hash_table_destroy ( counters_mantissas );
+    counters_mantissas = NULL;
+}
+
+
+
+/**
+ * add or remove some transactions to/from the counters of a category
+ *
+ * \param category the category or the blank category
+ * \param sub_category the sub-category or NULL
+ * \param step the number of transactions to add, negative to remove them
+ * \param amount the amount to add
+ *
+ * \return
+ * */
+void gsb_data_category_count_amount ( CategoryStruct *category,
+                        SubCategoryStruct *sub_category,
+                        gint step,
+                        GsbReal amount )
+{
+    category -> category_nb_transactions += step;
+    gsb_data_category_count_balance ( &category -> category_balance, amount );
+    if ( !category -> category_nb_transactions ) /* Cope with float errors */
+        category -> category_balance = null_real;
+
+    /* if we were on empty category, no sub-category */
+    if (category == empty_category)
+	return;
+
+    if ( sub_category )
+    {
+	sub_category -> sub_category_nb_transactions += step;
+	gsb_data_category_count_balance ( &sub_category -> sub_category_balance, amount );
+	if ( !sub_category -> sub_category_nb_transactions ) /* Cope with float errors */
+	    sub_category -> sub_category_balance = null_real;
+    }
+    else
+    {
+	category -> category_nb_direct_transactions += step;
+	gsb_data_category_count_balance ( &category -> category_direct_balance, amount );
+	if ( !category -> category_nb_direct_transactions ) /* Cope with float errors */
+	    category -> category_direct_balance = null_real;
+    }
+}
+
+
+
+/**
+ * add the totals of the archives kept in the cache of the file to the counters,
+ * the totals are in the currency of the tree
+ *
+ * \param archives_totals a list of GsbFileCacheArchiveTotal
+ *
+ * \return
+ * */
+void gsb_data_category_count_archives_totals ( GSList *archives_totals )
+{
+    GSList *tmp_list;
+
+    for ( tmp_list = archives_totals; tmp_list; tmp_list = tmp_list -> next )
+    {
+	GsbFileCacheArchiveTotal *total;
+	CategoryStruct *category;
+
+	total = tmp_list -> data;
+	if ( !total -> nb_counted )
+	    continue;
+
+	category = gsb_data_category_get_structure ( total -> div_number );
+	if ( !category )
+	    category = empty_category;
+
+	gsb_data_category_count_amount ( category,
+                        gsb_data_category_get_sub_category_structure ( total -> div_number,
+                        total -> sub_div_number ),
+                        total -> nb_counted,
+                        total -> amount );
+    }
+}
+
+
+
+/**
+ * add or remove the given transaction to/from the counters of a category
+ * if no category is specified, use the blank category.
+ * the transfers and the split transactions are not counted
  *
  * \param transaction_number the transaction we want to work with
+ * \param category_id
+ * \param sub_category_id
+ * \param add TRUE to add the transaction, FALSE to remove it
  *
  * \return
  * */
-void gsb_data_category_add_transaction_to_category ( gint transaction_number,
-						     gint category_id,
-						     gint sub_category_id )
+void gsb_data_category_count_transaction ( gint transaction_number,
+                        gint category_id,
+                        gint sub_category_id,
+                        gboolean add )
 {
     CategoryStruct *category;
     SubCategoryStruct *sub_category;
+    GsbReal amount;
+    gint step;
 
-    /* if the transaction is a transfer or a split transaction, don't take it */
-    if (gsb_data_transaction_get_split_of_transaction (transaction_number)
-	||
-	gsb_data_transaction_get_contra_transaction_number (transaction_number) > 0)
+    if ( !gsb_data_category_transaction_is_counted ( transaction_number ) )
 	return;
 
     category = gsb_data_category_get_structure ( category_id );
@@ -1476,44 +1926,52 @@ void gsb_data_category_add_transaction_to_category ( gint transaction_number,
         category = empty_category;
     }
 
-    /* ok, now category is on the structure or on empty_category */
-    if ( category )
+    amount = gsb_data_transaction_get_adjusted_amount_for_currency ( transaction_number,
+                        category_tree_currency (), -1);
+    if ( add )
+        step = 1;
+    else
     {
-	category -> category_nb_transactions ++;
-    if ( ! gsb_data_transaction_get_split_of_transaction ( transaction_number ) )
-        category -> category_balance = gsb_real_add ( category -> category_balance,
-                        gsb_data_transaction_get_adjusted_amount_for_currency (
-                        transaction_number, category_tree_currency (), -1));
+        step = -1;
+        amount = gsb_real_opposite ( amount );
     }
 
-    /* if we were on empty category, no sub-category */
-    if (category == empty_category)
-	return;
+    gsb_data_category_count_amount ( category, sub_category, step, amount );
+}
 
-    if ( sub_category )
-    {
-	sub_category -> sub_category_nb_transactions ++;
-    if ( ! gsb_data_transaction_get_split_of_transaction ( transaction_number ) )
-        sub_category -> sub_category_balance = gsb_real_add (
-                        sub_category -> sub_category_balance,
-                        gsb_data_transaction_get_adjusted_amount_for_currency (
-                        transaction_number, category_tree_currency (), -1));
-    }
-    else
-    {
-	category -> category_nb_direct_transactions ++;
-    if ( ! gsb_data_transaction_get_split_of_transaction ( transaction_number ) )
-        category -> category_direct_balance = gsb_real_add (
-                        category -> category_direct_balance,
-                        gsb_data_transaction_get_adjusted_amount_for_currency (
-                        transaction_number, category_tree_currency (), -1));
-    }
+
+
+/**
+ * Add the given transaction to a category in the counters if no
+ * category is specified, add it to the blank category.
+ * called when a transaction is created or changed, do nothing
+ * if the counters are not computed yet
+ *
+ * \param transaction_number the transaction we want to work with
+ * \param category_id
+ * \param sub_category_id
+ *
+ * \return
+ * */
+void gsb_data_category_add_transaction_to_category ( gint transaction_number,
+						     gint category_id,
+						     gint sub_category_id )
+{
+    if ( !gsb_data_category_counters_are_valid () )
+        return;
+
+    gsb_data_category_count_transaction ( transaction_number,
+                        category_id,
+                        sub_category_id,
+                        TRUE );
 }
 
 
 /**
  * remove the given transaction to its category in the counters
  * if the transaction has no category, remove it to the blank category
+ * called when a transaction is deleted or before it's changed, do nothing
+ * if the counters are not computed yet
  *
  * \param transaction_number the transaction we want to work with
  *
@@ -1521,42 +1979,33 @@ void gsb_data_category_add_transaction_to_category ( gint transaction_number,
  * */
 void gsb_data_category_remove_transaction_from_category ( gint transaction_number )
 {
-    CategoryStruct *category;
-    SubCategoryStruct *sub_category;
+    if ( !gsb_data_category_counters_are_valid () )
+        return;
 
-    category = gsb_data_category_get_structure ( gsb_data_transaction_get_category_number (transaction_number));
-    sub_category = gsb_data_category_get_sub_category_structure ( gsb_data_transaction_get_category_number (transaction_number),
-								  gsb_data_transaction_get_sub_category_number (transaction_number));
+    gsb_data_category_count_transaction ( transaction_number,
+                        gsb_data_transaction_get_category_number ( transaction_number ),
+                        gsb_data_transaction_get_sub_category_number ( transaction_number ),
+                        FALSE );
+}
 
-    if ( category )
-    {
-	category -> category_nb_transactions --;
-	category -> category_balance = gsb_real_sub ( category -> category_balance,
-						      gsb_data_transaction_get_adjusted_amount_for_currency ( transaction_number,
-													      category_tree_currency (), -1));
-	if ( !category -> category_nb_transactions ) /* Cope with float errors */
-	    category -> category_balance = null_real;
-    }
 
-    if ( sub_category )
-    {
-	sub_category -> sub_category_nb_transactions --;
-	sub_category -> sub_category_balance = gsb_real_sub ( sub_category -> sub_category_balance,
-							      gsb_data_transaction_get_adjusted_amount_for_currency ( transaction_number,
-														      category_tree_currency (), -1));
-	if ( !sub_category -> sub_category_nb_transactions ) /* Cope with float errors */
-	    sub_category -> sub_category_balance = null_real;
-    }
-    else
-    {
-	if ( category )
-	{
-	    category -> category_nb_direct_transactions --;
-	    category -> category_direct_balance = gsb_real_sub ( category -> category_direct_balance,
-								 gsb_data_transaction_get_adjusted_amount_for_currency ( transaction_number,
-															 category_tree_currency (), -1));
-	}
-    }
+
+/**
+ * tell if a transaction is counted in the counters of its category,
+ * the transfers and the split transactions are not counted
+ *
+ * \param transaction_number
+ *
+ * \return TRUE if the transaction is counted
+ * */
+gboolean gsb_data_category_transaction_is_counted ( gint transaction_number )
+{
+    if ( gsb_data_transaction_get_split_of_transaction ( transaction_number )
+	 ||
+	 gsb_data_transaction_get_contra_transaction_number ( transaction_number ) > 0 )
+	return FALSE;
+
+    return TRUE;
 }
 
 
@@ -1690,17 +2139,13 @@ gint gsb_data_category_test_create_category ( gint no_category,
                         const gchar *name,
                         gint category_type )
 {
-    GSList *list_tmp;
     gint category_number = 0;
     CategoryStruct *category;
 
-    list_tmp = g_slist_find_custom ( category_list,
-                        name,
-                        (GCompareFunc) gsb_data_category_get_pointer_from_name_in_glist );
+    category = gsb_data_category_get_structure_by_name ( name );
 
-    if ( list_tmp )
+    if ( category )
     {
-        category = list_tmp -> data;
         return category -> category_number;
     }
     else
@@ -1735,7 +2180,6 @@ gboolean gsb_data_category_test_create_sub_category ( gint no_category,
                         gint no_sub_category,
                         const gchar *name )
 {
-    GSList *list_tmp;
     CategoryStruct *category;
     SubCategoryStruct *sub_category;
 
@@ -1743,11 +2187,7 @@ gboolean gsb_data_category_test_create_sub_category ( gint no_category,
     if ( !category )
         return FALSE;
 
-    list_tmp = g_slist_find_custom ( category -> sub_category_list,
-                        name,
-                        (GCompareFunc) gsb_data_category_get_pointer_from_sub_name_in_glist );
-
-    if ( list_tmp )
+    if ( gsb_data_category_get_sub_category_structure_by_name ( category, name ) )
         return TRUE;
     else
     {
@@ -57,6 +57,7 @@ gpointer 	gsb_data_category_get_sub_category_structure 		(gint no_category,
 																 gint no_sub_category);
 gint 		gsb_data_category_get_type 							(gint no_category);
 gboolean 	gsb_data_category_init_variables 					(gboolean cleanup);
+void 		gsb_data_category_invalidate_counters 				(void);
 gint 		gsb_data_category_new_sub_category_with_number_and_name 		(gint number,
 																 gint category_number,
                                                                  const gchar *name);
@@ -81,6 +82,7 @@ gint 		gsb_data_category_test_create_category 				(gint no_category,
 gboolean 	gsb_data_category_test_create_sub_category			(gint no_category,
 																 gint no_sub_category,
 																 const gchar *name);
+gboolean	gsb_data_category_transaction_is_counted			(gint transaction_number);
 void 		gsb_data_category_update_counters 					(void);
 gchar * 	gsb_debug_duplicate_categ_check 					(void);
 gboolean 	gsb_debug_duplicate_categ_fix 						(void);
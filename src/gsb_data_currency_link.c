@@ -35,6 +35,7 @@
 
 /*START_INCLUDE*/
 #include "gsb_data_currency_link.h"
+#include "gsb_data_transaction.h"
 #include "utils_dates.h"
 #include "dialog.h"
 #include "gsb_real.h"
@@ -65,11 +66,28 @@ struct _CurrencyLink
 
 };
 
+
+/**
+ * \struct
+ * the conversion from a currency to another one, given by the valid links
+ */
+typedef struct	_CurrencyLinkRate	CurrencyLinkRate;
+
+struct _CurrencyLinkRate
+{
+    gint currency_link_number;  /* 0 if there is no link between the 2 currencies */
+    gboolean multiply;          /* TRUE if the amount is multiplied by the rate, FALSE if divided */
+    GsbReal change_rate;        /* the rate of the link with its smallest exponent */
+};
+
 /*START_STATIC*/
 static void _g_data_currency_link_free ( CurrencyLink *currency_link );
 static gboolean gsb_data_currency_link_check_for_invalid ( gint currency_link_number );
 static gpointer gsb_data_currency_link_get_structure ( gint currency_link_number );
 static gint gsb_data_currency_link_max_number ( void );
+static CurrencyLinkRate *gsb_data_currency_link_get_rate ( gint currency_1,
+                        gint currency_2 );
+static void gsb_data_currency_link_rates_changed ( void );
 /*END_STATIC*/
 
 /*START_EXTERN*/
@@ -81,6 +99,12 @@ static GSList *currency_link_list = NULL;
 /** a pointer to the last currency_link used (to increase the speed) */
 static CurrencyLink *currency_link_buffer;
 
+/** the table of the conversions between the currencies,
+ * currency_link_rates_size * currency_link_rates_size items indexed by the numbers
+ * of the 2 currencies, built from currency_link_list when needed, NULL if not built */
+static CurrencyLinkRate *currency_link_rates = NULL;
+static gint currency_link_rates_size = 0;
+
 
 /**
  * set the currency_links global variables to NULL, usually when we init all the global variables
@@ -105,10 +129,114 @@ gboolean gsb_data_currency_link_init_variables ( void )
     }
     currency_link_list = NULL;
     currency_link_buffer = NULL;
+    gsb_data_currency_link_rates_changed ();
     return FALSE;
 }
 
 
+/**
+ * forget the table of the conversions between the currencies,
+ * to call when a link changes ; it will be built again when needed
+ *
+ * \param
+ *
+ * \return
+ * */
+void gsb_data_currency_link_rates_changed ( void )
+{
+    g_free ( currency_link_rates );
+    currency_link_rates = NULL;
+    currency_link_rates_size = 0;
+}
+
+
+/**
+ * return the conversion between 2 currencies,
+ * build the table of the conversions if needed
+ *
+ * \param currency_1 the currency of the amount to convert
+ * \param currency_2 the currency wanted
+ *
+ * \return the conversion, NULL if there is no link between the 2 currencies
+ * */
+CurrencyLinkRate *gsb_data_currency_link_get_rate ( gint currency_1,
+                        gint currency_2 )
+{
+    CurrencyLinkRate *rate;
+
+    if ( !currency_link_rates )
+    {
+        GSList *tmp_list;
+        gint max_currency = 0;
+
+        tmp_list = currency_link_list;
+        while ( tmp_list )
+        {
+            CurrencyLink *currency_link;
+
+            currency_link = tmp_list -> data;
+            max_currency = MAX ( max_currency, currency_link -> first_currency );
+            max_currency = MAX ( max_currency, currency_link -> second_currency );
+            tmp_list = tmp_list -> next;
+        }
+
+        currency_link_rates_size = max_currency + 1;
+        currency_link_rates = g_malloc0 ( currency_link_rates_size * currency_link_rates_size
+                        * sizeof ( CurrencyLinkRate ) );
+
+        /* as gsb_data_currency_link_search, the first valid link of the list is used */
+        tmp_list = currency_link_list;
+        while ( tmp_list )
+        {
+            CurrencyLink *currency_link;
+            GsbReal change_rate;
+            gint first;
+            gint second;
+
+            currency_link = tmp_list -> data;
+            tmp_list = tmp_list -> next;
+
+            first = currency_link -> first_currency;
+            second = currency_link -> second_currency;
+            if ( currency_link -> invalid_link || first <= 0 || second <= 0 || first == second )
+                continue;
+
+            rate = &currency_link_rates[first * currency_link_rates_size + second];
+            if ( rate -> currency_link_number )
+                continue;
+
+            /* the rate is reduced once here instead of in each gsb_real_mul/div */
+            change_rate = currency_link -> change_rate;
+            while ( change_rate.exponent > 0 && change_rate.mantissa % 10 == 0 )
+            {
+                change_rate.mantissa /= 10;
+                change_rate.exponent--;
+            }
+
+            rate -> currency_link_number = currency_link -> currency_link_number;
+            rate -> multiply = TRUE;
+            rate -> change_rate = change_rate;
+
+            rate = &currency_link_rates[second * currency_link_rates_size + first];
+            rate -> currency_link_number = currency_link -> currency_link_number;
+            rate -> multiply = FALSE;
+            rate -> change_rate = change_rate;
+        }
+    }
+
+    if ( currency_1 <= 0 || currency_2 <= 0
+     ||
+     currency_1 >= currency_link_rates_size || currency_2 >= currency_link_rates_size )
+        return NULL;
+
+    rate = &currency_link_rates[currency_1 * currency_link_rates_size + currency_2];
+    if ( !rate -> currency_link_number )
+        return NULL;
+
+    return rate;
+}
+
+
 /**
  * find and return the structure of the currency_link asked
  *
@@ -276,6 +404,10 @@ gboolean gsb_data_currency_link_remove ( gint currency_link_number )
 					  currency_link );
 
     _g_data_currency_link_free ( currency_link );
+    gsb_data_currency_link_rates_changed ();
+
+    /* the counters of the metatrees are converted with the links */
+    gsb_data_transaction_invalidate_counters ();
 
     return TRUE;
 }
@@ -302,6 +434,7 @@ gint gsb_data_currency_link_set_new_number ( gint currency_link_number,
 	return 0;
 
     currency_link -> currency_link_number = new_no_currency_link;
+    gsb_data_currency_link_rates_changed ();
     return new_no_currency_link;
 }
 
@@ -348,6 +481,8 @@ gboolean gsb_data_currency_link_set_first_currency ( gint currency_link_number,
 
     currency_link -> first_currency = first_currency;
     gsb_data_currency_link_check_for_invalid (currency_link_number);
+    gsb_data_currency_link_rates_changed ();
+    gsb_data_transaction_invalidate_counters ();
 
     return TRUE;
 }
@@ -394,6 +529,8 @@ gboolean gsb_data_currency_link_set_second_currency ( gint currency_link_number,
 
     currency_link -> second_currency = second_currency;
     gsb_data_currency_link_check_for_invalid (currency_link_number);
+    gsb_data_currency_link_rates_changed ();
+    gsb_data_transaction_invalidate_counters ();
 
     return TRUE;
 }
@@ -437,6 +574,8 @@ gboolean gsb_data_currency_link_set_change_rate ( gint currency_link_number,
 	return FALSE;
 
     currency_link -> change_rate = change_rate;
+    gsb_data_currency_link_rates_changed ();
+    gsb_data_transaction_invalidate_counters ();
 
     return TRUE;
 }
@@ -566,7 +705,7 @@ gboolean gsb_data_currency_link_check_for_invalid ( gint currency_link_number )
 gint gsb_data_currency_link_search ( gint currency_1,
                         gint currency_2 )
 {
-    GSList *tmp_list;
+    CurrencyLinkRate *rate;
 
     if (!currency_1
 	||
@@ -576,28 +715,39 @@ gint gsb_data_currency_link_search ( gint currency_1,
     if ( currency_1 == currency_2 )
 	return -1;
 
-    tmp_list = currency_link_list;
+    rate = gsb_data_currency_link_get_rate ( currency_1, currency_2 );
+    if ( !rate )
+        return 0;
 
-    while (tmp_list)
-    {
-	CurrencyLink *tmp_currency_link;
+    return rate -> currency_link_number;
+}
 
-	tmp_currency_link = tmp_list -> data;
 
-	if ( !tmp_currency_link -> invalid_link
-	     &&
-	     (( tmp_currency_link -> first_currency == currency_1
-		&&
-		tmp_currency_link -> second_currency == currency_2 )
-	      ||
-	      ( tmp_currency_link -> first_currency == currency_2
-		&&
-		tmp_currency_link -> second_currency == currency_1 )))
-	    return tmp_currency_link -> currency_link_number;
+/**
+ * convert an amount from a currency to another one with the link between them
+ *
+ * \param currency_1 the currency of the amount
+ * \param currency_2 the currency wanted
+ * \param amount a pointer to the amount to convert, unchanged if no link
+ *
+ * \return TRUE if there is a link between the 2 currencies, FALSE else
+ * */
+gboolean gsb_data_currency_link_convert ( gint currency_1,
+                        gint currency_2,
+                        GsbReal *amount )
+{
+    CurrencyLinkRate *rate;
 
-	tmp_list = tmp_list -> next;
-    }
-    return 0;
+    rate = gsb_data_currency_link_get_rate ( currency_1, currency_2 );
+    if ( !rate )
+        return FALSE;
+
+    if ( rate -> multiply )
+        *amount = gsb_real_mul ( *amount, rate -> change_rate );
+    else
+        *amount = gsb_real_div ( *amount, rate -> change_rate );
+
+    return TRUE;
 }
 
 
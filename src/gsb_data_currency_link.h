@@ -21,6 +21,9 @@ enum LinkListColumns {
 };
 
 /* START_DECLARATION */
+gboolean 		gsb_data_currency_link_convert 					(gint currency_1,
+																 gint currency_2,
+																 GsbReal *amount);
 GsbReal 		gsb_data_currency_link_get_change_rate 			(gint currency_link_number);
 GSList *		gsb_data_currency_link_get_currency_link_list 	(void);
 gint 			gsb_data_currency_link_get_first_currency 		(gint currency_link_number);
@@ -42,6 +42,7 @@
 #include "gsb_data_currency.h"
 #include "gsb_data_currency_link.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file_cache.h"
 #include "navigation.h"
 #include "gsb_real.h"
 #include "gsb_rgba.h"
@@ -1060,7 +1061,6 @@ gchar *gsb_data_partial_balance_get_marked_balance ( gint partial_balance_number
         GsbReal tmp_real;
         gint account_nb;
         gint account_currency;
-        gint link_number;
 
         account_nb = utils_str_atoi ( tab[i] );
         account_currency = gsb_data_account_get_currency ( account_nb );
@@ -1068,17 +1068,9 @@ gchar *gsb_data_partial_balance_get_marked_balance ( gint partial_balance_number
 
         if ( tmp_real.mantissa != 0 && partial_balance -> currency != account_currency )
         {
-            if ( ( link_number = gsb_data_currency_link_search ( account_currency,
-                        partial_balance -> currency ) ) )
-            {
-                if ( gsb_data_currency_link_get_first_currency (
-                 link_number) == account_currency )
-                    tmp_real = gsb_real_mul ( tmp_real,
-                                gsb_data_currency_link_get_change_rate ( link_number ) );
-                else
-                    tmp_real = gsb_real_div ( tmp_real,
-                                gsb_data_currency_link_get_change_rate ( link_number ) );
-            }
+            gsb_data_currency_link_convert ( account_currency,
+                        partial_balance -> currency,
+                        &tmp_real );
 
         }
         solde = gsb_real_add ( solde, tmp_real );
@@ -1140,7 +1132,6 @@ GsbReal gsb_data_partial_balance_get_current_amount ( gint partial_balance_numbe
         GsbReal tmp_real;
         gint account_nb;
         gint account_currency;
-        gint link_number;
 
         account_nb = utils_str_atoi ( tab[i] );
         account_currency = gsb_data_account_get_currency ( account_nb );
@@ -1148,17 +1139,9 @@ GsbReal gsb_data_partial_balance_get_current_amount ( gint partial_balance_numbe
 
         if ( tmp_real.mantissa != 0 && partial_balance -> currency != account_currency )
         {
-            if ( ( link_number = gsb_data_currency_link_search ( account_currency,
-                        partial_balance -> currency ) ) )
-            {
-                if ( gsb_data_currency_link_get_first_currency (
-                        link_number) == account_currency )
-                    tmp_real = gsb_real_mul ( tmp_real,
-                                gsb_data_currency_link_get_change_rate ( link_number ) );
-                else
-                    tmp_real = gsb_real_div ( tmp_real,
-                                gsb_data_currency_link_get_change_rate ( link_number ) );
-            }
+            gsb_data_currency_link_convert ( account_currency,
+                        partial_balance -> currency,
+                        &tmp_real );
         }
         solde = gsb_real_add ( solde, tmp_real );
     }
@@ -1514,6 +1497,7 @@ GPtrArray *gsb_data_partial_balance_calculate_balances_at_date ( gint partial_ba
 
     for ( i = 0; tab[i]; i++ )
     {
+        GsbFileCacheArchiveSummary archives;
         gint account_number;
         gint floating_point;
         GsbReal *balance;
@@ -1530,6 +1514,13 @@ GPtrArray *gsb_data_partial_balance_calculate_balances_at_date ( gint partial_ba
         /* on initialise le tableau des soldes de chaque compte */
         balance = g_malloc0 ( sizeof ( GsbReal ) );
         tmp_balance = gsb_data_account_get_init_balance ( account_number, floating_point );
+
+        /* les archives gardées dans le cache sont chargées si elles ont des opérations
+         * après la date, les autres sont comptées avec leur résumé */
+        gsb_file_cache_load_account_archives ( account_number, g_date_get_julian ( date ) + 1 );
+        gsb_file_cache_get_account_archives_summary ( account_number, &archives );
+        tmp_balance = gsb_real_add ( tmp_balance,
+                        gsb_real_adjust_exponent ( archives.balance, floating_point ) );
         balance->mantissa = tmp_balance.mantissa;
         balance->exponent = tmp_balance.exponent;
         g_ptr_array_add ( current_balances, balance );
@@ -1541,7 +1532,7 @@ GPtrArray *gsb_data_partial_balance_calculate_balances_at_date ( gint partial_ba
         g_ptr_array_add ( current_balances_later, balance );
     }
 
-    tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+    tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
 
     while (tmp_list)
     {
@@ -1905,7 +1896,6 @@ GsbReal gsb_data_partial_balance_get_balance_at_date ( gint partial_balance_numb
         GsbReal tmp_real;
         gint account_number;
         gint account_currency;
-        gint link_number;
 
         account_number = utils_str_atoi ( tab[i] );
         account_currency = gsb_data_account_get_currency ( account_number );
@@ -1913,16 +1903,9 @@ GsbReal gsb_data_partial_balance_get_balance_at_date ( gint partial_balance_numb
 
         if ( tmp_real.mantissa != 0 && partial_balance -> currency != account_currency )
         {
-            if ( ( link_number = gsb_data_currency_link_search ( account_currency,
-                        partial_balance -> currency ) ) )
-            {
-                if ( gsb_data_currency_link_get_first_currency ( link_number) == account_currency )
-                    tmp_real = gsb_real_mul ( tmp_real,
-                                gsb_data_currency_link_get_change_rate ( link_number ) );
-                else
-                    tmp_real = gsb_real_div ( tmp_real,
-                                gsb_data_currency_link_get_change_rate ( link_number ) );
-            }
+            gsb_data_currency_link_convert ( account_currency,
+                        partial_balance -> currency,
+                        &tmp_real );
         }
         solde = gsb_real_add ( solde, tmp_real );
     }
@@ -37,10 +37,12 @@
 #include "gsb_data_payee.h"
 #include "grisbi_win.h"
 #include "gsb_combo_box.h"
+#include "gsb_data_currency.h"
 #include "gsb_data_form.h"
 #include "gsb_data_report.h"
 #include "gsb_data_scheduled.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file_cache.h"
 #include "gsb_form_widget.h"
 #include "gtk_combofix.h"
 #include "tiers_onglet.h"
@@ -77,9 +79,24 @@ static GSList *payee_list = NULL;
 /** a pointer to the last payee used (to increase the speed) */
 static PayeeStruct *payee_buffer = NULL;
 
+/** index of the payees by name, see utils_str_name_index_new */
+static GHashTable *payee_names_index = NULL;
+
 /** a pointer to a "blank" payee structure, used in the list of payee
  * to group the transactions without payee */
 static PayeeStruct *empty_payee = NULL;
+
+/** TRUE when the counters are computed, they are then maintained transaction
+ * by transaction ; with the currency and the archives setting used to compute them */
+static gboolean counters_valid = FALSE;
+static gint counters_currency = 0;
+static gboolean counters_with_archives = FALSE;
+
+/** while the counters are computed again, the amounts of each payee are kept
+ * in a GArray of mantissas with the exponent of the currency of the tree,
+ * they are summed by gsb_real_sum_mantissas at the end ; NULL the rest of the time */
+static GHashTable *counters_mantissas = NULL;
+static gint counters_exponent = 0;
 /*END_STATIC*/
 
 /*START_EXTERN*/
@@ -110,20 +127,6 @@ static void _gsb_data_payee_free (PayeeStruct* payee)
 		payee_buffer = NULL;
 }
 
-/**
- * compare deux structures payees par le numéro de tiers
- *
- * \param	structure 1
- * \param	structure 1
- *
- * \return -1, 0 ou 1 en fonction du résultat de la comparaison.
- **/
-static gint gsb_data_payee_get_pointer_in_gslist (PayeeStruct *payee1,
-												  PayeeStruct *payee2)
-{
-    return (payee1->payee_number - payee2->payee_number);
-}
-
 /**
  * return a g_slist of names of all the payees
  * it's not a copy of the gchar...
@@ -180,6 +183,32 @@ static gint gsb_data_payee_get_pointer_from_name_in_glist (PayeeStruct *payee,
     return (my_strcasecmp (payee->payee_name, name));
 }
 
+/**
+ * find a payee by his name, case insensitive, with the index of the names
+ * if several payees have that name, the first in the list of payees is returned
+ *
+ * \param name the name we are looking for
+ *
+ * \return the struct of the payee or NULL if not found
+ **/
+static PayeeStruct *gsb_data_payee_get_structure_by_name (const gchar *name)
+{
+    GSList *list_tmp;
+
+	if (name && payee_names_index)
+	{
+		list_tmp = utils_str_name_index_lookup (payee_names_index, name);
+		if (!list_tmp || !list_tmp->next)
+			return list_tmp ? list_tmp->data : NULL;
+	}
+
+	list_tmp = g_slist_find_custom (payee_list,
+									name,
+									(GCompareFunc) gsb_data_payee_get_pointer_from_name_in_glist);
+
+	return list_tmp ? list_tmp->data : NULL;
+}
+
 /** find and return the last number of payee
  *
  * \param none
@@ -235,6 +264,301 @@ static void gsb_data_payee_reset_counters (void)
     empty_payee->payee_nb_transactions = 0;
 }
 
+/**
+ * tell if the counters of the payees are up to date, ie they were
+ * computed since the file was loaded, with the current currency of the tree
+ * and the current setting for the archives
+ *
+ * \param
+ *
+ * \return TRUE if the counters can be maintained transaction by transaction
+ **/
+static gboolean gsb_data_payee_counters_are_valid (void)
+{
+	GrisbiWinEtat *w_etat;
+
+	if (!counters_valid)
+		return FALSE;
+
+	w_etat = grisbi_win_get_w_etat ();
+
+	return (counters_currency == payee_tree_currency ()
+			&& counters_with_archives == w_etat->metatree_add_archive_in_totals);
+}
+
+/**
+ * add an amount to the balance of a payee, or keep it to be summed
+ * with the other amounts of the payee when the counters are computed again
+ *
+ * \param payee
+ * \param amount
+ *
+ * \return
+ **/
+static void gsb_data_payee_count_balance (PayeeStruct *payee,
+										  GsbReal amount)
+{
+	GArray *mantissas;
+
+	if (!counters_mantissas)
+	{
+		payee->payee_balance = gsb_real_add (payee->payee_balance, amount);
+		return;
+	}
+
+	mantissas = g_hash_table_lookup (counters_mantissas, payee);
+	if (!mantissas)
+	{
+		mantissas = g_array_new (FALSE, FALSE, sizeof (gint64));
+		g_hash_table_insert (counters_mantissas, payee, mantissas);
+	}
+	gsb_real_append_mantissa (mantissas, amount, counters_exponent);
+}
+
+/**
+ * add the amounts kept while the counters are computed again to the balances of the payees
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_data_payee_sum_balances (void)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	g_hash_table_iter_init (&iter, counters_mantissas);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		PayeeStruct *payee = key;
+		GArray *mantissas = value;
+
+		payee->payee_balance = gsb_real_add (payee->payee_balance,
+											 gsb_real_sum_mantissas ((gint64 *) mantissas->data,
+																	 mantissas->len,
+																	 counters_exponent));
+	}
+	g_hash_table_destroy (counters_mantissas);
+	counters_mantissas = NULL;
+}
+
+/**
+ * add or remove the given transaction to/from its payee in the counters
+ * if the transaction has no payee, use the blank payee
+ * the children of split transactions and one side of the transfers are not counted
+ *
+ * \param transaction_number the transaction we want to work with
+ * \param add TRUE to add the transaction, FALSE to remove it
+ *
+ * \return
+ **/
+static void gsb_data_payee_count_transaction (gint transaction_number,
+											  gboolean add)
+{
+    PayeeStruct *payee;
+	GsbReal amount;
+
+	if (!gsb_data_payee_transaction_is_counted (transaction_number))
+		return;
+
+	/* if no payee in that transaction and it's neither a split transaction, we work with empty_payee */
+    payee = gsb_data_payee_get_structure (gsb_data_transaction_get_party_number (transaction_number));
+
+    /* should not happen, this is if the transaction has a payee which doesn't exists
+     * we show a debug warning and get without payee */
+    if (!payee)
+    {
+        gchar *tmpstr;
+
+        tmpstr = g_strdup_printf ("The transaction %d has a payee %d but it doesn't exist.",
+								  transaction_number,
+								  gsb_data_transaction_get_party_number (transaction_number));
+        warning_debug (tmpstr);
+        g_free (tmpstr);
+        payee = empty_payee;
+    }
+
+	amount = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
+																	payee_tree_currency (),
+																	-1);
+	if (add)
+	{
+		payee->payee_nb_transactions ++;
+		gsb_data_payee_count_balance (payee, amount);
+	}
+	else
+	{
+		payee->payee_nb_transactions --;
+		payee->payee_balance = gsb_real_sub (payee->payee_balance, amount);
+	}
+
+	if (!payee->payee_nb_transactions) /* Cope with float errors */
+		payee->payee_balance = null_real;
+}
+
+/**
+ * add the totals of the archives kept in the cache of the file to the counters,
+ * the totals are in the currency of the tree
+ *
+ * \param archives_totals a list of GsbFileCacheArchiveTotal
+ *
+ * \return
+ **/
+static void gsb_data_payee_count_archives_totals (GSList *archives_totals)
+{
+	GSList *tmp_list;
+
+	for (tmp_list = archives_totals; tmp_list; tmp_list = tmp_list->next)
+	{
+		GsbFileCacheArchiveTotal *total;
+		PayeeStruct *payee;
+
+		total = tmp_list->data;
+		if (!total->nb_counted)
+			continue;
+
+		payee = gsb_data_payee_get_structure (total->div_number);
+		if (!payee)
+			payee = empty_payee;
+
+		payee->payee_nb_transactions += total->nb_counted;
+		gsb_data_payee_count_balance (payee, total->amount);
+	}
+}
+
+/**
+ * add the payees of the archives kept in the cache of the file to a list of payees used
+ *
+ * \param used the list of the numbers of the payees used
+ *
+ * \return the new list
+ **/
+static GSList *gsb_data_payee_append_archived_payees (GSList *used)
+{
+	GSList *archives_totals;
+	GSList *tmp_list;
+
+	archives_totals = gsb_file_cache_get_archives_totals (METATREE_PAYEE, 0);
+	for (tmp_list = archives_totals; tmp_list; tmp_list = tmp_list->next)
+	{
+		gint payee_number;
+
+		payee_number = ((GsbFileCacheArchiveTotal *) tmp_list->data)->div_number;
+		if (!g_slist_find (used, GINT_TO_POINTER (payee_number)))
+			used = g_slist_append (used, GINT_TO_POINTER (payee_number));
+	}
+	g_slist_free_full (archives_totals, g_free);
+
+	return used;
+}
+
+/**
+ * compute again the counters of the payees from all the transactions,
+ * the archives kept in the cache of the file are counted with their totals
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_data_payee_compute_counters (void)
+{
+    GSList *list_tmp_transactions;
+	GSList *archives_totals = NULL;
+	GrisbiWinEtat *w_etat;
+
+	w_etat = grisbi_win_get_w_etat ();
+	gsb_data_payee_reset_counters ();
+	counters_exponent = gsb_data_currency_get_floating_point (payee_tree_currency ());
+	counters_mantissas = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) g_array_unref);
+
+    if (w_etat->metatree_add_archive_in_totals)
+	{
+		archives_totals = gsb_file_cache_get_archives_totals (METATREE_PAYEE, payee_tree_currency ());
+        list_tmp_transactions = gsb_data_transaction_get_loaded_transactions_list ();
+	}
+    else
+        list_tmp_transactions = gsb_data_transaction_get_transactions_list ();
+
+    while (list_tmp_transactions)
+    {
+		gint transaction_number_tmp;
+
+		transaction_number_tmp = gsb_data_transaction_get_transaction_number (list_tmp_transactions->data);
+		gsb_data_payee_count_transaction (transaction_number_tmp, TRUE);
+
+		list_tmp_transactions = list_tmp_transactions->next;
+    }
+	gsb_data_payee_count_archives_totals (archives_totals);
+	g_slist_free_full (archives_totals, g_free);
+	gsb_data_payee_sum_balances ();
+
+	counters_valid = TRUE;
+	counters_currency = payee_tree_currency ();
+	counters_with_archives = w_etat->metatree_add_archive_in_totals;
+}
+
+/**
+ * debug only : compare the counters maintained transaction by transaction
+ * with a full count, show a warning if they differ
+ * at the end, the counters are the ones of the full count
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_data_payee_check_counters (void)
+{
+	GArray *numbers;
+	GArray *balances;
+	GSList *list_tmp;
+	gint nb_errors = 0;
+	guint i = 0;
+
+	numbers = g_array_new (FALSE, FALSE, sizeof (gint));
+	balances = g_array_new (FALSE, FALSE, sizeof (GsbReal));
+
+	g_array_append_val (numbers, empty_payee->payee_nb_transactions);
+	g_array_append_val (balances, empty_payee->payee_balance);
+	for (list_tmp = payee_list; list_tmp; list_tmp = list_tmp->next)
+	{
+		PayeeStruct *payee;
+
+		payee = list_tmp->data;
+		g_array_append_val (numbers, payee->payee_nb_transactions);
+		g_array_append_val (balances, payee->payee_balance);
+	}
+
+	gsb_data_payee_compute_counters ();
+
+	if (g_array_index (numbers, gint, i) != empty_payee->payee_nb_transactions
+		|| gsb_real_cmp (g_array_index (balances, GsbReal, i), empty_payee->payee_balance))
+		nb_errors++;
+	for (list_tmp = payee_list; list_tmp; list_tmp = list_tmp->next)
+	{
+		PayeeStruct *payee;
+
+		payee = list_tmp->data;
+		i++;
+		if (g_array_index (numbers, gint, i) != payee->payee_nb_transactions
+			|| gsb_real_cmp (g_array_index (balances, GsbReal, i), payee->payee_balance))
+			nb_errors++;
+	}
+
+	if (nb_errors)
+	{
+		gchar *tmpstr;
+
+		tmpstr = g_strdup_printf ("%d counters of the payees were wrong, they are computed again.",
+								  nb_errors);
+		warning_debug (tmpstr);
+		g_free (tmpstr);
+	}
+
+	g_array_free (numbers, TRUE);
+	g_array_free (balances, TRUE);
+}
+
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
@@ -259,10 +583,17 @@ gboolean gsb_data_payee_init_variables (gboolean cleanup)
 		_gsb_data_payee_free (payee);
     }
     g_slist_free (payee_list);
+	if (payee_names_index)
+	{
+		g_hash_table_destroy (payee_names_index);
+		payee_names_index = NULL;
+	}
+	counters_valid = FALSE;
 	if (cleanup)
 	{
 		payee_list = NULL;
 		payee_buffer = NULL;
+		payee_names_index = utils_str_name_index_new ();
 
 		/* create the blank payee */
 		if (empty_payee)
@@ -381,6 +712,9 @@ gint gsb_data_payee_new (const gchar *name)
 
         if (combofix && name)
             gtk_combofix_append_text (GTK_COMBOFIX (combofix), name);
+
+		if (payee_names_index)
+			utils_str_name_index_add (payee_names_index, payee->payee_name, payee);
     }
     else
         payee->payee_name = NULL;
@@ -413,7 +747,15 @@ gboolean gsb_data_payee_remove (gint no_payee)
     if (combofix)
         gtk_combofix_remove_text (GTK_COMBOFIX (combofix), payee->payee_name);
 
+    if (payee_names_index)
+        utils_str_name_index_remove (payee_names_index, payee->payee_name, payee);
+
     payee_list = g_slist_remove (payee_list, payee);
+
+    /* the transactions still counted in that payee cannot be removed from the counters anymore */
+    if (payee->payee_nb_transactions)
+        counters_valid = FALSE;
+
     _gsb_data_payee_free (payee);
 
     return TRUE;
@@ -455,17 +797,12 @@ gint gsb_data_payee_set_new_number (gint no_payee,
 gint gsb_data_payee_get_number_by_name (const gchar *name,
 										gboolean create)
 {
-    GSList *list_tmp;
+    PayeeStruct *payee;
     gint payee_number = 0;
 
-    list_tmp = g_slist_find_custom (payee_list,
-									name,
-									(GCompareFunc) gsb_data_payee_get_pointer_from_name_in_glist);
-    if (list_tmp)
+    payee = gsb_data_payee_get_structure_by_name (name);
+    if (payee)
     {
-        PayeeStruct *payee;
-
-        payee = list_tmp->data;
         payee_number = payee->payee_number;
     }
     else
@@ -531,11 +868,15 @@ gboolean gsb_data_payee_set_name (gint no_payee,
     {
 		if (combofix)
 			gtk_combofix_remove_text (GTK_COMBOFIX (combofix), payee->payee_name);
+		if (payee_names_index)
+			utils_str_name_index_remove (payee_names_index, payee->payee_name, payee);
 		g_free (payee->payee_name);
     }
 
     /* and copy the new one or set NULL */
     payee->payee_name = my_strdup (name);
+	if (payee_names_index)
+		utils_str_name_index_add (payee_names_index, payee->payee_name, payee);
 
     if (combofix && name && strlen (name))
         gtk_combofix_append_text (GTK_COMBOFIX (combofix), name);
@@ -734,6 +1075,9 @@ GsbReal gsb_data_payee_get_balance (gint no_payee)
 
 /**
  * update the counters of the payees
+ * the counters are computed from all the transactions only the first time,
+ * after that they are maintained by the transactions themselves
+ * (see gsb_data_payee_add_transaction_to_payee) so that function is fast
  *
  * \param
  *
@@ -741,31 +1085,30 @@ GsbReal gsb_data_payee_get_balance (gint no_payee)
  **/
 void gsb_data_payee_update_counters (void)
 {
-    GSList *list_tmp_transactions;
-	GrisbiWinEtat *w_etat;
-
-	w_etat = grisbi_win_get_w_etat ();
-	gsb_data_payee_reset_counters ();
-
-    if (w_etat->metatree_add_archive_in_totals)
-        list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
-    else
-        list_tmp_transactions = gsb_data_transaction_get_transactions_list ();
-
-    while (list_tmp_transactions)
-    {
-		gint transaction_number_tmp;
-
-		transaction_number_tmp = gsb_data_transaction_get_transaction_number (list_tmp_transactions->data);
-		gsb_data_payee_add_transaction_to_payee (transaction_number_tmp);
+	if (!gsb_data_payee_counters_are_valid ())
+		gsb_data_payee_compute_counters ();
+	else if (debug_get_debug_mode ())
+		gsb_data_payee_check_counters ();
+}
 
-		list_tmp_transactions = list_tmp_transactions->next;
-    }
+/**
+ * forget the counters of the payees, they will be computed again
+ * by the next gsb_data_payee_update_counters
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_data_payee_invalidate_counters (void)
+{
+	counters_valid = FALSE;
 }
 
 /**
  * add the given transaction to its payee in the counters
  * if the transaction has no payee, add it to the blank payee
+ * called when a transaction is created or changed, do nothing
+ * if the counters are not computed yet
  *
  * \param transaction_number the transaction we want to work with
  *
@@ -773,50 +1116,15 @@ void gsb_data_payee_update_counters (void)
  **/
 void gsb_data_payee_add_transaction_to_payee (gint transaction_number)
 {
-    PayeeStruct *payee;
-	gint contra_number;
-
-	/* if the transaction is a split transaction or a contra transaction don't take it */
-	if (gsb_data_transaction_get_mother_transaction_number (transaction_number))
-	{
-		return;
-	}
-	else if ((contra_number = gsb_data_transaction_get_contra_transaction_number (transaction_number)) > 0)
-	{
-		gint tmp_number;
-
-		tmp_number = gsb_data_transaction_get_contra_transaction_number (contra_number);
-		if (tmp_number > contra_number)
-			return;
-	}
-
-	/* if no payee in that transaction and it's neither a split transaction, we work with empty_payee */
-    payee = gsb_data_payee_get_structure (gsb_data_transaction_get_party_number (transaction_number));
-
-    /* should not happen, this is if the transaction has a payee which doesn't exists
-     * we show a debug warning and get without payee */
-    if (!payee)
-    {
-        gchar *tmpstr;
-
-        tmpstr = g_strdup_printf ("The transaction %d has a payee %d but it doesn't exist.",
-								  transaction_number,
-								  gsb_data_transaction_get_party_number (transaction_number));
-        warning_debug (tmpstr);
-        g_free (tmpstr);
-        payee = empty_payee;
-    }
-
-    payee->payee_nb_transactions ++;
-	payee->payee_balance = gsb_real_add (payee->payee_balance,
-										 gsb_data_transaction_get_adjusted_amount_for_currency
-										 (transaction_number, payee_tree_currency (),
-										  -1));
+	if (gsb_data_payee_counters_are_valid ())
+		gsb_data_payee_count_transaction (transaction_number, TRUE);
 }
 
 /**
  * remove the given transaction to its payee in the counters
  * if the transaction has no payee, remove it to the blank payee
+ * called when a transaction is deleted or before it's changed, do nothing
+ * if the counters are not computed yet
  *
  * \param transaction_number the transaction we want to work with
  *
@@ -824,31 +1132,31 @@ void gsb_data_payee_add_transaction_to_payee (gint transaction_number)
  **/
 void gsb_data_payee_remove_transaction_from_payee (gint transaction_number)
 {
-    PayeeStruct *payee;
+	if (gsb_data_payee_counters_are_valid ())
+		gsb_data_payee_count_transaction (transaction_number, FALSE);
+}
 
-    payee = gsb_data_payee_get_structure (gsb_data_transaction_get_party_number (transaction_number));
+/**
+ * tell if a transaction is counted in the counters of its payee,
+ * the children of split transactions and one side of the transfers are not counted
+ *
+ * \param transaction_number
+ *
+ * \return TRUE if the transaction is counted
+ **/
+gboolean gsb_data_payee_transaction_is_counted (gint transaction_number)
+{
+	gint contra_number;
 
-    /* if no payee in that transaction, and it's neither a split, neither a transfer,
-     * we work with empty_payee */
+	if (gsb_data_transaction_get_mother_transaction_number (transaction_number))
+		return FALSE;
 
-    if (!payee
-		&& !gsb_data_transaction_get_split_of_transaction (transaction_number)
-		&& gsb_data_transaction_get_contra_transaction_number (transaction_number) == 0)
-	{
-        payee = empty_payee;
-	}
+	contra_number = gsb_data_transaction_get_contra_transaction_number (transaction_number);
+	if (contra_number > 0
+		&& gsb_data_transaction_get_contra_transaction_number (contra_number) > contra_number)
+		return FALSE;
 
-    if (payee)
-    {
-        payee->payee_nb_transactions --;
-        payee->payee_balance = gsb_real_sub (payee->payee_balance,
-											 gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
-																									payee_tree_currency (),
-																									-1));
-
-        if (!payee->payee_nb_transactions) /* Cope with float errors */
-            payee->payee_balance = null_real;
-    }
+	return TRUE;
 }
 
 /**
@@ -866,7 +1174,7 @@ gint gsb_data_payee_remove_unused (void)
     gint nb_removed = 0;
 
 	/* first we create a list of used categories */
-    tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+    tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
     while (tmp_list)
     {
         gint payee_number;
@@ -880,6 +1188,7 @@ gint gsb_data_payee_remove_unused (void)
         }
         tmp_list = tmp_list->next;
     }
+	used = gsb_data_payee_append_archived_payees (used);
 
     /* it also scans the list of sheduled transactions. fix bug 538 */
     tmp_list = gsb_data_scheduled_get_scheduled_list ();
@@ -1026,7 +1335,7 @@ gint gsb_data_payee_get_unused_payees (void)
 
     /* méthode longue */
     /* first we create a list of used payees */
-    tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+    tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
     while (tmp_list)
     {
         gint payee_number;
@@ -1039,6 +1348,7 @@ gint gsb_data_payee_get_unused_payees (void)
         }
         tmp_list = tmp_list->next;
     }
+	used = gsb_data_payee_append_archived_payees (used);
 
     /* it also scans the list of sheduled transactions. fix bug 538 */
     tmp_list = gsb_data_scheduled_get_scheduled_list ();
@@ -1165,9 +1475,12 @@ gboolean gsb_data_payee_set_use_regex (gint no_payee,
  **/
 GSList *gsb_data_payee_get_unarchived_payees_list (void)
 {
-	GSList *tmp_list;
 	GSList *payees_list = NULL;
 	GSList *transactions_list;
+	GHashTable *used_payees;
+
+	/* the payees already in the list */
+	used_payees = g_hash_table_new (NULL, NULL);
 
 	transactions_list = gsb_data_transaction_get_transactions_list ();
 	while (transactions_list)
@@ -1180,19 +1493,16 @@ GSList *gsb_data_payee_get_unarchived_payees_list (void)
 		payee_number = gsb_data_transaction_get_party_number (transaction_number);
 		payee = gsb_data_payee_get_structure (payee_number);
 
-		if (payee)
+		if (payee && !g_hash_table_contains (used_payees, payee))
 		{
-			tmp_list = g_slist_find_custom (payees_list,
-											payee,
-											(GCompareFunc) gsb_data_payee_get_pointer_in_gslist);
-			if (!tmp_list)
-			{
-				payees_list = g_slist_append (payees_list, payee);
-			}
+			g_hash_table_add (used_payees, payee);
+			payees_list = g_slist_prepend (payees_list, payee);
 		}
 		transactions_list = transactions_list->next;
 	}
-	return payees_list;
+	g_hash_table_destroy (used_payees);
+
+	return g_slist_reverse (payees_list);
 }
 
 /**
@@ -29,6 +29,7 @@ GSList *		gsb_data_payee_get_unarchived_payees_list		(void);
 gint 			gsb_data_payee_get_unused_payees 				(void);
 gint			gsb_data_payee_get_use_regex 					(gint no_payee);
 gboolean 		gsb_data_payee_init_variables 					(gboolean cleanup);
+void 			gsb_data_payee_invalidate_counters 				(void);
 gint 			gsb_data_payee_new 								(const gchar *name);
 gboolean 		gsb_data_payee_remove 							(gint no_payee);
 void 			gsb_data_payee_remove_transaction_from_payee 	(gint transaction_number);
@@ -45,6 +46,7 @@ gboolean 		gsb_data_payee_set_search_string 				(gint no_payee,
 																 const gchar *search_string);
 gboolean		gsb_data_payee_set_use_regex 					(gint no_payee,
 																 gint use_regex);
+gboolean		gsb_data_payee_transaction_is_counted			(gint transaction_number);
 void 			gsb_data_payee_update_counters 					(void);
 gboolean 		gsb_data_payee_compare_payees_by_name 			(gpointer payee_ptr_a,
 																 gpointer payee_ptr_b);
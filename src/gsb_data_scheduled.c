@@ -1703,8 +1703,7 @@ GsbReal gsb_data_scheduled_get_adjusted_amount_for_currency (gint scheduled_numb
 															 gint return_exponent)
 {
     ScheduledStruct *scheduled;
-    GsbReal amount = null_real;
-    gint link_number;
+    GsbReal amount;
 
     if (return_exponent == -1)
         return_exponent = gsb_data_currency_get_floating_point (return_currency_number);
@@ -1719,28 +1718,22 @@ GsbReal gsb_data_scheduled_get_adjusted_amount_for_currency (gint scheduled_numb
     if (scheduled->currency_number == return_currency_number)
         return gsb_real_adjust_exponent  (scheduled->scheduled_amount, return_exponent);
 
-    /* now we can adjust the amount */
-    if ((link_number = gsb_data_currency_link_search (scheduled->currency_number,
-													  return_currency_number)))
+    /* now we can adjust the amount with the hard link between
+     * the transaction currency and the return currency */
+    amount = scheduled->scheduled_amount;
+    if (!gsb_data_currency_link_convert (scheduled->currency_number, return_currency_number, &amount))
     {
-	/* there is a hard link between the transaction currency and the return currency */
-        if (gsb_data_currency_link_get_first_currency (link_number) == scheduled->currency_number)
-            amount = gsb_real_mul (scheduled->scheduled_amount,
-								   gsb_data_currency_link_get_change_rate (link_number));
-        else
-            amount = gsb_real_div (scheduled->scheduled_amount,
-								   gsb_data_currency_link_get_change_rate (link_number));
-
-    }
-    else if (return_currency_number > 0 && scheduled->currency_number > 0)
-    {
-        gchar *tmp_str;
+        amount = null_real;
+        if (return_currency_number > 0 && scheduled->currency_number > 0)
+        {
+            gchar *tmp_str;
 
-        tmp_str = g_strdup (_("Error: is missing one or more links between currencies.\n"
-							  "You need to fix it and start over."));
-        dialogue_error (tmp_str);
+            tmp_str = g_strdup (_("Error: is missing one or more links between currencies.\n"
+                                  "You need to fix it and start over."));
+            dialogue_error (tmp_str);
 
-        g_free (tmp_str);
+            g_free (tmp_str);
+        }
     }
 
     return gsb_real_adjust_exponent  (amount, return_exponent);
@@ -49,7 +49,9 @@
 #include "gsb_data_payee.h"
 #include "gsb_data_payment.h"
 #include "gsb_file.h"
+#include "gsb_file_cache.h"
 #include "gsb_real.h"
+#include "gsb_search_index.h"
 #include "gsb_transactions_list.h"
 #include "gsb_transactions_list_sort.h"
 #include "structures.h"
@@ -74,6 +76,7 @@ struct _TransactionStruct
     gchar *notes;
     gint marked_transaction;            /**<  OPERATION_NORMALE=nothing, OPERATION_POINTEE=P, OPERATION_TELEPOINTEE=T, OPERATION_RAPPROCHEE=R */
     gint archive_number;                /**< if it's an archived transaction, contains the number of the archive */
+    gboolean in_transactions_list;      /**< TRUE if the transaction is in transactions_list, not saved */
     gshort automatic_transaction;       /**< 0=manual, 1=automatic (scheduled transaction) */
     gint reconcile_number;              /**< the number of reconciliation, carreful : can be filled without marked_transaction=OPERATION_RAPPROCHEE sometimes,
                                              it happen if the user did ctrl R to un-R the transaction, we keep reconcile_number because most of them
@@ -114,6 +117,15 @@ static void gsb_data_transaction_free ( TransactionStruct *transaction);
 static gint gsb_data_transaction_get_last_white_number (void);
 static TransactionStruct *gsb_data_transaction_get_transaction_by_no ( gint transaction_number );
 static gboolean gsb_data_transaction_save_transaction_pointer ( gpointer transaction );
+static GSList *gsb_data_transaction_list_append ( GSList *list,
+                        GSList **tail,
+                        TransactionStruct *transaction );
+static GSList *gsb_data_transaction_list_remove ( GSList *list,
+                        GSList **tail,
+                        TransactionStruct *transaction );
+static void gsb_data_transaction_index_remove ( TransactionStruct *transaction );
+static void gsb_data_transaction_update_counters ( TransactionStruct *transaction,
+                        gboolean add );
 /*END_STATIC*/
 
 /*START_EXTERN*/
@@ -131,6 +143,23 @@ static GSList *complete_transactions_list = NULL;
  * and 1 white line per split of transaction */
 static GSList *white_transactions_list = NULL;
 
+/** the last link of transactions_list, complete_transactions_list and white_transactions_list,
+ * so appending a transaction doesn't walk the list ; NULL if unknown */
+static GSList *transactions_list_tail = NULL;
+static GSList *complete_transactions_list_tail = NULL;
+static GSList *white_transactions_list_tail = NULL;
+
+/** index of all the transactions (archived and not archived) by number */
+static GHashTable *transactions_hash = NULL;
+
+/** index of the white lines by number */
+static GHashTable *white_transactions_hash = NULL;
+
+/** the greatest transaction number and the lowest white line number,
+ * 0 if they must be computed again */
+static gint last_transaction_number = 0;
+static gint last_white_transaction_number = 0;
+
 /** 2 pointers to the 2 last transaction used (to increase the speed) */
 static TransactionStruct *transaction_buffer[2];
 
@@ -152,6 +181,168 @@ gboolean gsb_data_transaction_init_variables ( void )
 }
 
 
+/**
+ * append a transaction to one of the transactions lists,
+ * using the tail of the list to avoid to walk it
+ *
+ * \param list the list to append to
+ * \param tail a pointer to the last link of that list, NULL if unknown
+ * \param transaction the transaction to append
+ *
+ * \return the new start of the list
+ * */
+static GSList *gsb_data_transaction_list_append ( GSList *list,
+                        GSList **tail,
+                        TransactionStruct *transaction )
+{
+    GSList *new_link;
+
+    new_link = g_slist_alloc ();
+    new_link -> data = transaction;
+
+    if ( !list )
+    {
+        *tail = new_link;
+        return new_link;
+    }
+
+    if ( !*tail )
+        *tail = g_slist_last ( list );
+
+    ( *tail ) -> next = new_link;
+    *tail = new_link;
+
+    return list;
+}
+
+
+/**
+ * remove a transaction from one of the transactions lists
+ * and forget the tail of the list if it was the last link
+ *
+ * \param list the list to remove from
+ * \param tail a pointer to the last link of that list
+ * \param transaction the transaction to remove
+ *
+ * \return the new start of the list
+ * */
+static GSList *gsb_data_transaction_list_remove ( GSList *list,
+                        GSList **tail,
+                        TransactionStruct *transaction )
+{
+    if ( *tail && ( *tail ) -> data == transaction )
+        *tail = NULL;
+
+    return g_slist_remove ( list, transaction );
+}
+
+
+/**
+ * remove a transaction from the 2 transactions lists and from the index
+ * the transaction is not freed
+ *
+ * \param transaction
+ *
+ * \return
+ * */
+static void gsb_data_transaction_index_remove ( TransactionStruct *transaction )
+{
+    gsb_data_account_balance_index_update_transaction ( transaction -> account_number,
+                        transaction -> transaction_number );
+
+    transactions_list = gsb_data_transaction_list_remove ( transactions_list,
+                        &transactions_list_tail,
+                        transaction );
+    transaction -> in_transactions_list = FALSE;
+    complete_transactions_list = gsb_data_transaction_list_remove ( complete_transactions_list,
+                        &complete_transactions_list_tail,
+                        transaction );
+
+    if ( transactions_hash )
+        g_hash_table_remove ( transactions_hash, GINT_TO_POINTER ( transaction -> transaction_number ) );
+
+    /* the last number will be searched again only if needed */
+    if ( transaction -> transaction_number == last_transaction_number )
+        last_transaction_number = 0;
+}
+
+
+/**
+ * add or remove a transaction to/from the counters of the payees,
+ * the categories and the budgets
+ * called before and after a change of a field used by the counters,
+ * so they never need to be computed again from all the transactions
+ * the white lines and the transactions not shown in the metatrees are not counted
+ *
+ * \param transaction
+ * \param add TRUE to add the transaction, FALSE to remove it
+ *
+ * \return
+ * */
+static void gsb_data_transaction_update_counters ( TransactionStruct *transaction,
+                        gboolean add )
+{
+    gint transaction_number;
+
+    transaction_number = transaction -> transaction_number;
+    if ( transaction_number <= 0 )
+        return;
+
+    /* the same fields are in the search index */
+    gsb_search_index_mark_transaction ( transaction_number );
+
+    if ( !transaction -> in_transactions_list )
+    {
+        GrisbiWinEtat *w_etat;
+
+        w_etat = grisbi_win_get_w_etat ();
+        if ( !w_etat || !w_etat -> metatree_add_archive_in_totals )
+            return;
+    }
+
+    if ( add )
+    {
+        gsb_data_payee_add_transaction_to_payee ( transaction_number );
+        gsb_data_category_add_transaction_to_category ( transaction_number,
+                        transaction -> category_number,
+                        transaction -> sub_category_number );
+        gsb_data_budget_add_transaction_to_budget ( transaction_number,
+                        transaction -> budgetary_number,
+                        transaction -> sub_budgetary_number );
+    }
+    else
+    {
+        gsb_data_payee_remove_transaction_from_payee ( transaction_number );
+        gsb_data_category_remove_transaction_from_category ( transaction_number );
+        gsb_data_budget_remove_transaction_from_budget ( transaction_number );
+    }
+}
+
+
+/**
+ * forget the counters of the payees, the categories and the budgets,
+ * to call when an amount they count changes without a change of the transaction
+ * (exchange rates, currency of an account...)
+ *
+ * \param
+ *
+ * \return
+ * */
+void gsb_data_transaction_invalidate_counters ( void )
+{
+    /* the summaries of the archives kept in the cache of the file use the old rates
+     * for the transactions in another currency than their account ; the totals
+     * for the metatrees are in the currency of the transactions and stay right */
+    gsb_file_cache_load_converted_archives ();
+
+    gsb_data_account_set_all_balances_are_dirty ();
+    gsb_data_payee_invalidate_counters ();
+    gsb_data_category_invalidate_counters ();
+    gsb_data_budget_invalidate_counters ();
+    gsb_search_index_invalidate_amounts ();
+}
+
+
 /**
  * return a pointer to the g_slist of transactions structure
  * it's not a copy, so we must not free or change it
@@ -172,16 +363,56 @@ GSList *gsb_data_transaction_get_transactions_list ( void )
  * it's not a copy, so we must not free or change it
  * if we want to change something, use gsb_data_transaction_copy_transactions_list instead
  * THIS IS THE COMPLETE LIST (WITH THE ARCHIVED TRANSACTIONS)
+ * the archives kept in the cache of the file are loaded before, so it is
+ * only for the functions which need all the archived transactions ; the others
+ * use gsb_data_transaction_get_loaded_transactions_list with the summaries
+ * and the totals of gsb_file_cache.c
  *
  * \param none
  *
  * \return the slist of transactions structures
  * */
 GSList *gsb_data_transaction_get_complete_transactions_list ( void )
+{
+    gsb_file_cache_load_archive ( 0 );
+
+    return complete_transactions_list;
+}
+
+/**
+ * return a pointer to the complete g_slist of transactions structure
+ * without loading the archives kept in the cache of the file,
+ * for the functions which use the summaries of that archives
+ * or load only the archives they need
+ *
+ * \param none
+ *
+ * \return the slist of transactions structures loaded
+ * */
+GSList *gsb_data_transaction_get_loaded_transactions_list ( void )
 {
     return complete_transactions_list;
 }
 
+/**
+ * tell if a transaction is in the list of the transactions shown,
+ * ie not archived or an archived transaction loaded into Grisbi
+ *
+ * \param transaction_number
+ *
+ * \return TRUE if the transaction is in gsb_data_transaction_get_transactions_list ()
+ * */
+gboolean gsb_data_transaction_is_in_transactions_list ( gint transaction_number )
+{
+    TransactionStruct *transaction;
+
+    transaction = gsb_data_transaction_get_transaction_by_no ( transaction_number );
+    if ( !transaction )
+        return FALSE;
+
+    return transaction -> in_transactions_list;
+}
+
 /**
  * just append the archived transaction given in param
  * into the non archived transactions list
@@ -199,7 +430,12 @@ gboolean gsb_data_transaction_add_archived_to_list ( gint transaction_number )
 
     if ( !transaction )
 	    return FALSE;
-    transactions_list = g_slist_append ( transactions_list, transaction );
+    gsb_data_transaction_update_counters ( transaction, FALSE );
+    transactions_list = gsb_data_transaction_list_append ( transactions_list,
+                        &transactions_list_tail,
+                        transaction );
+    transaction -> in_transactions_list = TRUE;
+    gsb_data_transaction_update_counters ( transaction, TRUE );
 
     return TRUE;
 }
@@ -235,6 +471,10 @@ gint gsb_data_transaction_get_last_number (void)
     gint last_number = 0;
     GSList *transactions_list_tmp;
 
+    /* the number is kept up to date when creating the transactions */
+    if ( last_transaction_number )
+        return last_transaction_number;
+
     transactions_list_tmp = complete_transactions_list;
 
     while (transactions_list_tmp)
@@ -247,6 +487,11 @@ gint gsb_data_transaction_get_last_number (void)
 
 	transactions_list_tmp = transactions_list_tmp -> next;
     }
+
+    /* the numbers of the archives not loaded are kept in the cache */
+    last_number = MAX ( last_number, gsb_file_cache_get_archives_last_number () );
+    last_transaction_number = last_number;
+
     return last_number;
 }
 
@@ -266,6 +511,9 @@ gint gsb_data_transaction_get_last_white_number (void)
     gint last_number = 0;
     GSList *transactions_list_tmp;
 
+    if ( last_white_transaction_number )
+        return last_white_transaction_number;
+
     transactions_list_tmp = white_transactions_list;
 
     while (transactions_list_tmp)
@@ -285,6 +533,8 @@ gint gsb_data_transaction_get_last_white_number (void)
 
     if ( !last_number )
 	last_number = -1;
+    else
+        last_white_transaction_number = last_number;
 
     return last_number;
 }
@@ -343,7 +593,8 @@ gboolean gsb_data_transaction_save_transaction_pointer ( gpointer transaction )
  * */
 TransactionStruct *gsb_data_transaction_get_transaction_by_no ( gint transaction_number )
 {
-    GSList *transactions_list_tmp;
+    TransactionStruct *transaction;
+    GHashTable *hash;
 
     if (!transaction_number)
 	return NULL;
@@ -360,27 +611,33 @@ TransactionStruct *gsb_data_transaction_get_transaction_by_no ( gint transaction
 	return transaction_buffer[1];
 
     if ( transaction_number < 0 )
-	transactions_list_tmp = white_transactions_list;
+	hash = white_transactions_hash;
     else
-	transactions_list_tmp = complete_transactions_list;
+	hash = transactions_hash;
 
-    while ( transactions_list_tmp )
-    {
-	TransactionStruct *transaction;
+    if ( hash )
+        transaction = g_hash_table_lookup ( hash, GINT_TO_POINTER ( transaction_number ) );
+    else
+        transaction = NULL;
 
-	transaction = transactions_list_tmp -> data;
+    /* the transaction can be in an archive kept in the cache of the file */
+    if ( !transaction && transaction_number > 0 && gsb_file_cache_archives_pending () )
+    {
+	gint archive_number;
 
-	if ( transaction -> transaction_number == transaction_number )
+	archive_number = gsb_file_cache_find_archive_of_transaction ( transaction_number );
+	if ( archive_number )
 	{
-	    gsb_data_transaction_save_transaction_pointer ( transaction );
-	    return transaction;
+	    gsb_file_cache_load_archive ( archive_number );
+	    transaction = g_hash_table_lookup ( transactions_hash, GINT_TO_POINTER ( transaction_number ) );
 	}
-
-	transactions_list_tmp = transactions_list_tmp -> next;
     }
 
-    /* here, we didn't find any transaction with that number */
-    return NULL;
+    /* if NULL, we didn't find any transaction with that number */
+    if ( transaction )
+	gsb_data_transaction_save_transaction_pointer ( transaction );
+
+    return transaction;
 }
 
 
@@ -471,9 +728,12 @@ gboolean gsb_data_transaction_set_account_number ( gint transaction_number,
     if ( !transaction )
 	return FALSE;
 
-    gsb_data_account_set_balances_are_dirty ( transaction -> account_number );
+    gsb_data_account_balance_index_update_transaction ( transaction -> account_number,
+                        transaction_number );
+    gsb_data_transaction_update_counters ( transaction, FALSE );
     transaction -> account_number = no_account;
-    gsb_data_account_set_balances_are_dirty ( no_account );
+    gsb_data_transaction_update_counters ( transaction, TRUE );
+    gsb_data_account_balance_index_update_transaction ( no_account, transaction_number );
 
     /* if the transaction is a split, change all the children */
     if (transaction -> split_of_transaction)
@@ -487,7 +747,18 @@ gboolean gsb_data_transaction_set_account_number ( gint transaction_number,
 	while (tmp_list)
 	{
 	    transaction = tmp_list -> data;
+
+	    /* the white line of the split is not in the balance index */
+	    if ( transaction -> transaction_number > 0 )
+	    {
+		gsb_data_account_balance_index_update_transaction ( transaction -> account_number,
+                        transaction -> transaction_number );
+		gsb_data_account_balance_index_update_transaction ( no_account,
+                        transaction -> transaction_number );
+	    }
+	    gsb_data_transaction_update_counters ( transaction, FALSE );
 	    transaction -> account_number = no_account;
+	    gsb_data_transaction_update_counters ( transaction, TRUE );
 	    tmp_list = tmp_list -> next;
 	}
 	g_slist_free (save_tmp_list);
@@ -540,6 +811,8 @@ gboolean gsb_data_transaction_set_date ( gint transaction_number,
     if (transaction -> date)
         g_date_free (transaction -> date);
     transaction -> date = gsb_date_copy (date);
+    gsb_data_account_balance_index_update_transaction ( transaction -> account_number,
+                        transaction -> transaction_number );
 
     /* if the transaction is a split, change all the children */
     if (transaction -> split_of_transaction)
@@ -623,6 +896,8 @@ gboolean gsb_data_transaction_set_value_date ( gint transaction_number,
     if (transaction ->  value_date)
         g_date_free (transaction ->  value_date);
     transaction ->  value_date = gsb_date_copy (date);
+    gsb_data_account_balance_index_update_transaction ( transaction -> account_number,
+                        transaction -> transaction_number );
 
     /* if the transaction is a split, change all the children */
     if (transaction -> split_of_transaction)
@@ -711,8 +986,11 @@ gboolean gsb_data_transaction_set_amount ( gint transaction_number,
     if ( !transaction )
         return FALSE;
 
+    gsb_data_transaction_update_counters ( transaction, FALSE );
     transaction -> transaction_amount = amount;
-    gsb_data_account_set_balances_are_dirty ( transaction -> account_number );
+    gsb_data_transaction_update_counters ( transaction, TRUE );
+    gsb_data_account_balance_index_update_transaction ( transaction -> account_number,
+                        transaction -> transaction_number );
 
     return TRUE;
 }
@@ -767,7 +1045,6 @@ GsbReal gsb_data_transaction_get_adjusted_amount_for_currency ( gint transaction
 {
     TransactionStruct *transaction;
     GsbReal amount = null_real;
-    gint link_number;
 
     if (return_exponent == -1)
 	return_exponent = gsb_data_currency_get_floating_point (return_currency_number);
@@ -801,15 +1078,9 @@ GsbReal gsb_data_transaction_get_adjusted_amount_for_currency ( gint transaction
 		account_currency = gsb_data_account_get_currency (transaction->account_number);
 		if (account_currency != return_currency_number)
 		{
-			if ((link_number = gsb_data_currency_link_search (account_currency, return_currency_number)))
-			{
-				/* there is a hard link between the account currency and the return currency */
-				if ( gsb_data_currency_link_get_first_currency (link_number) == account_currency)
-					amount = gsb_real_mul (amount, gsb_data_currency_link_get_change_rate (link_number));
-				else
-					amount = gsb_real_div (amount, gsb_data_currency_link_get_change_rate (link_number));
-			}
-			else
+			/* if there is a hard link between the account currency and the return currency,
+			 * the amount is converted with it */
+			if (!gsb_data_currency_link_convert (account_currency, return_currency_number, &amount))
 			{
 				GsbReal current_exchange;
 				GsbReal current_exchange_fees;
@@ -830,16 +1101,14 @@ GsbReal gsb_data_transaction_get_adjusted_amount_for_currency ( gint transaction
 			}
 		}
     }
-    else if ( (link_number = gsb_data_currency_link_search ( transaction -> currency_number,
-							return_currency_number ) ) )
+    else if ( gsb_data_currency_link_search ( transaction -> currency_number,
+                        return_currency_number ) )
     {
 		/* there is a hard link between the transaction currency and the return currency */
-        if ( gsb_data_currency_link_get_first_currency (link_number) == transaction -> currency_number)
-            amount = gsb_real_mul ( transaction -> transaction_amount,
-                        gsb_data_currency_link_get_change_rate (link_number));
-        else
-            amount = gsb_real_div ( transaction -> transaction_amount,
-                        gsb_data_currency_link_get_change_rate (link_number));
+        amount = transaction -> transaction_amount;
+        gsb_data_currency_link_convert ( transaction -> currency_number,
+                        return_currency_number,
+                        &amount );
 
         /* The costs are still deducted from the transaction. In case of internal transfer there is no charge. */
         amount = gsb_real_sub (amount, transaction -> exchange_fees);
@@ -915,7 +1184,11 @@ gboolean gsb_data_transaction_set_currency_number ( gint transaction_number,
     if ( !transaction )
 	return FALSE;
 
+    gsb_data_transaction_update_counters ( transaction, FALSE );
     transaction -> currency_number = no_currency;
+    gsb_data_transaction_update_counters ( transaction, TRUE );
+    gsb_data_account_balance_index_update_transaction ( transaction -> account_number,
+                        transaction -> transaction_number );
 
     /* if the transaction is a split, change all the children */
     if (transaction -> split_of_transaction)
@@ -929,7 +1202,9 @@ gboolean gsb_data_transaction_set_currency_number ( gint transaction_number,
 	while (tmp_list)
 	{
 	    transaction = tmp_list -> data;
+	    gsb_data_transaction_update_counters ( transaction, FALSE );
 	    transaction -> currency_number = no_currency;
+	    gsb_data_transaction_update_counters ( transaction, TRUE );
 	    tmp_list = tmp_list -> next;
 	}
 	g_slist_free (save_tmp_list);
@@ -984,7 +1259,11 @@ gboolean gsb_data_transaction_set_change_between ( gint transaction_number,
     if ( !transaction )
 	return FALSE;
 
+    gsb_data_transaction_update_counters ( transaction, FALSE );
     transaction -> change_between_account_and_transaction = value;
+    gsb_data_transaction_update_counters ( transaction, TRUE );
+    gsb_data_account_balance_index_update_transaction ( transaction -> account_number,
+                        transaction -> transaction_number );
 
     /* if the transaction is a split, change all the children */
     if (transaction -> split_of_transaction)
@@ -998,7 +1277,9 @@ gboolean gsb_data_transaction_set_change_between ( gint transaction_number,
 	while (tmp_list)
 	{
 	    transaction = tmp_list -> data;
+	    gsb_data_transaction_update_counters ( transaction, FALSE );
 	    transaction -> change_between_account_and_transaction = value;
+	    gsb_data_transaction_update_counters ( transaction, TRUE );
 	    tmp_list = tmp_list -> next;
 	}
 	g_slist_free (save_tmp_list);
@@ -1049,7 +1330,11 @@ gboolean gsb_data_transaction_set_exchange_rate ( gint transaction_number,
     if ( !transaction )
 	return FALSE;
 
+    gsb_data_transaction_update_counters ( transaction, FALSE );
     transaction -> exchange_rate = rate;
+    gsb_data_transaction_update_counters ( transaction, TRUE );
+    gsb_data_account_balance_index_update_transaction ( transaction -> account_number,
+                        transaction -> transaction_number );
 
     /* if the transaction is a split, change all the children */
     if (transaction -> split_of_transaction)
@@ -1063,7 +1348,9 @@ gboolean gsb_data_transaction_set_exchange_rate ( gint transaction_number,
 	while (tmp_list)
 	{
 	    transaction = tmp_list -> data;
+	    gsb_data_transaction_update_counters ( transaction, FALSE );
 	    transaction -> exchange_rate = rate;
+	    gsb_data_transaction_update_counters ( transaction, TRUE );
 	    tmp_list = tmp_list -> next;
 	}
 	g_slist_free (save_tmp_list);
@@ -1112,7 +1399,11 @@ gboolean gsb_data_transaction_set_exchange_fees ( gint transaction_number,
     if ( !transaction )
 	return FALSE;
 
+    gsb_data_transaction_update_counters ( transaction, FALSE );
     transaction -> exchange_fees = rate;
+    gsb_data_transaction_update_counters ( transaction, TRUE );
+    gsb_data_account_balance_index_update_transaction ( transaction -> account_number,
+                        transaction -> transaction_number );
 
     /* if the transaction is a split, change all the children */
     if (transaction -> split_of_transaction)
@@ -1126,7 +1417,9 @@ gboolean gsb_data_transaction_set_exchange_fees ( gint transaction_number,
 	while (tmp_list)
 	{
 	    transaction = tmp_list -> data;
+	    gsb_data_transaction_update_counters ( transaction, FALSE );
 	    transaction -> exchange_fees = rate;
+	    gsb_data_transaction_update_counters ( transaction, TRUE );
 	    tmp_list = tmp_list -> next;
 	}
 	g_slist_free (save_tmp_list);
@@ -1176,7 +1469,9 @@ gboolean gsb_data_transaction_set_party_number ( gint transaction_number,
     if ( !transaction )
 	return FALSE;
 
+    gsb_data_transaction_update_counters ( transaction, FALSE );
     transaction -> party_number = no_party;
+    gsb_data_transaction_update_counters ( transaction, TRUE );
 
     /* if the transaction is a split, change all the children */
     if (transaction -> split_of_transaction)
@@ -1190,7 +1485,9 @@ gboolean gsb_data_transaction_set_party_number ( gint transaction_number,
 	while (tmp_list)
 	{
 	    transaction = tmp_list -> data;
+	    gsb_data_transaction_update_counters ( transaction, FALSE );
 	    transaction -> party_number = no_party;
+	    gsb_data_transaction_update_counters ( transaction, TRUE );
 	    tmp_list = tmp_list -> next;
 	}
 	g_slist_free (save_tmp_list);
@@ -1236,7 +1533,9 @@ gboolean gsb_data_transaction_set_category_number ( gint transaction_number,
     if ( !transaction )
 	return FALSE;
 
+    gsb_data_transaction_update_counters ( transaction, FALSE );
     transaction -> category_number = no_category;
+    gsb_data_transaction_update_counters ( transaction, TRUE );
 
     return TRUE;
 }
@@ -1278,7 +1577,9 @@ gboolean gsb_data_transaction_set_sub_category_number ( gint transaction_number,
     if ( !transaction )
 	return FALSE;
 
+    gsb_data_transaction_update_counters ( transaction, FALSE );
     transaction -> sub_category_number = no_sub_category;
+    gsb_data_transaction_update_counters ( transaction, TRUE );
 
     return TRUE;
 }
@@ -1322,7 +1623,9 @@ gboolean gsb_data_transaction_set_split_of_transaction ( gint transaction_number
     if ( !transaction )
 	return FALSE;
 
+    gsb_data_transaction_update_counters ( transaction, FALSE );
     transaction -> split_of_transaction = is_split;
+    gsb_data_transaction_update_counters ( transaction, TRUE );
 
     return TRUE;
 }
@@ -1364,6 +1667,7 @@ gboolean gsb_data_transaction_set_notes ( gint transaction_number,
     if ( !transaction )
         return FALSE;
 
+    gsb_search_index_mark_transaction ( transaction_number );
     g_free ( transaction -> notes );
     transaction -> notes = my_strdup ( notes );
 
@@ -1471,6 +1775,7 @@ gboolean gsb_data_transaction_set_method_of_payment_content ( gint transaction_n
     if ( !transaction )
         return FALSE;
 
+    gsb_search_index_mark_transaction ( transaction_number );
     g_free ( transaction -> method_of_payment_content );
     transaction -> method_of_payment_content = my_strdup ( method_of_payment_content );
 
@@ -1518,7 +1823,9 @@ gboolean gsb_data_transaction_set_marked_transaction ( gint transaction_number,
     if ( !transaction )
 	return FALSE;
 
-    gsb_data_account_set_balances_are_dirty ( transaction->account_number );
+    gsb_data_account_update_marked_balance ( transaction -> account_number,
+                        transaction_number,
+                        marked_transaction );
     transaction -> marked_transaction = marked_transaction;
 
     /* if the transaction is a split, change all the children */
@@ -1586,15 +1893,22 @@ gboolean gsb_data_transaction_set_archive_number ( gint transaction_number,
      * so we mustn't add it,
      * else, according to the new value, we remove it
     */
+    gsb_data_transaction_update_counters ( transaction, FALSE );
     if ( !transaction -> archive_number )
     {
         /* the transaction was not an archive, so it's into the 2 lists,
          * if we transform it as an archive, we remove it from the transactions_list */
         if ( archive_number )
-            transactions_list = g_slist_remove ( transactions_list, transaction );
+        {
+            transactions_list = gsb_data_transaction_list_remove ( transactions_list,
+                        &transactions_list_tail,
+                        transaction );
+            transaction -> in_transactions_list = FALSE;
+        }
     }
 
     transaction -> archive_number = archive_number;
+    gsb_data_transaction_update_counters ( transaction, TRUE );
 
     return TRUE;
 }
@@ -1775,7 +2089,9 @@ gboolean gsb_data_transaction_set_budgetary_number ( gint transaction_number,
     if ( !transaction )
 	return FALSE;
 
+    gsb_data_transaction_update_counters ( transaction, FALSE );
     transaction -> budgetary_number = budgetary_number;
+    gsb_data_transaction_update_counters ( transaction, TRUE );
 
     return TRUE;
 }
@@ -1813,7 +2129,9 @@ gboolean gsb_data_transaction_set_sub_budgetary_number ( gint transaction_number
     if ( !transaction )
 	return FALSE;
 
+    gsb_data_transaction_update_counters ( transaction, FALSE );
     transaction -> sub_budgetary_number = sub_budgetary_number;
+    gsb_data_transaction_update_counters ( transaction, TRUE );
 
     return TRUE;
 }
@@ -1851,6 +2169,7 @@ gboolean gsb_data_transaction_set_voucher ( gint transaction_number,
     if ( !transaction )
         return FALSE;
 
+    gsb_search_index_mark_transaction ( transaction_number );
     g_free ( transaction -> voucher );
 
     if ( voucher && strlen (voucher) )
@@ -1901,6 +2220,7 @@ gboolean gsb_data_transaction_set_bank_references ( gint transaction_number,
     if ( !transaction )
         return FALSE;
 
+    gsb_search_index_mark_transaction ( transaction_number );
     g_free ( transaction -> bank_references );
     transaction -> bank_references = my_strdup ( bank_references );
 
@@ -1939,14 +2259,39 @@ gboolean gsb_data_transaction_set_contra_transaction_number ( gint transaction_n
                         gint transaction_number_transfer )
 {
     TransactionStruct *transaction;
+    TransactionStruct *old_contra_transaction = NULL;
+    TransactionStruct *new_contra_transaction = NULL;
 
     transaction = gsb_data_transaction_get_transaction_by_no ( transaction_number);
 
     if ( !transaction )
 	return FALSE;
 
+    /* only one side of a transfer is counted for the payees, and it's chosen
+     * with the contra-transaction number, so the 2 sides must be counted again */
+    if ( transaction -> transaction_number_transfer > 0 )
+        old_contra_transaction = gsb_data_transaction_get_transaction_by_no (
+                        transaction -> transaction_number_transfer );
+    if ( transaction_number_transfer > 0
+         &&
+         transaction_number_transfer != transaction -> transaction_number_transfer )
+        new_contra_transaction = gsb_data_transaction_get_transaction_by_no (
+                        transaction_number_transfer );
+
+    gsb_data_transaction_update_counters ( transaction, FALSE );
+    if ( old_contra_transaction && old_contra_transaction != transaction )
+        gsb_data_transaction_update_counters ( old_contra_transaction, FALSE );
+    if ( new_contra_transaction && new_contra_transaction != transaction )
+        gsb_data_transaction_update_counters ( new_contra_transaction, FALSE );
+
     transaction -> transaction_number_transfer = transaction_number_transfer;
 
+    gsb_data_transaction_update_counters ( transaction, TRUE );
+    if ( old_contra_transaction && old_contra_transaction != transaction )
+        gsb_data_transaction_update_counters ( old_contra_transaction, TRUE );
+    if ( new_contra_transaction && new_contra_transaction != transaction )
+        gsb_data_transaction_update_counters ( new_contra_transaction, TRUE );
+
     return TRUE;
 }
 
@@ -2018,7 +2363,11 @@ gboolean gsb_data_transaction_set_mother_transaction_number ( gint transaction_n
     if ( !transaction )
 	return FALSE;
 
+    gsb_data_transaction_update_counters ( transaction, FALSE );
     transaction -> mother_transaction_number = mother_transaction_number;
+    gsb_data_transaction_update_counters ( transaction, TRUE );
+    gsb_data_account_balance_index_update_transaction ( transaction -> account_number,
+                        transaction -> transaction_number );
 
     return TRUE;
 }
@@ -2059,12 +2408,25 @@ gint gsb_data_transaction_new_transaction_with_number ( gint no_account,
     transaction -> bank_references = g_strdup("");
 
     /* we append the transaction to the complete transactions list and the non archive transaction list */
-    transactions_list = g_slist_append ( transactions_list,
-					 transaction );
-    complete_transactions_list = g_slist_append ( complete_transactions_list,
-						  transaction );
+    transactions_list = gsb_data_transaction_list_append ( transactions_list,
+                        &transactions_list_tail,
+                        transaction );
+    transaction -> in_transactions_list = TRUE;
+    complete_transactions_list = gsb_data_transaction_list_append ( complete_transactions_list,
+                        &complete_transactions_list_tail,
+                        transaction );
+
+    if ( !transactions_hash )
+        transactions_hash = g_hash_table_new ( g_direct_hash, g_direct_equal );
+    g_hash_table_insert ( transactions_hash, GINT_TO_POINTER ( transaction_number ), transaction );
+
+    if ( last_transaction_number && transaction_number > last_transaction_number )
+        last_transaction_number = transaction_number;
+
+    gsb_data_account_balance_index_update_transaction ( no_account, transaction_number );
 
     gsb_data_transaction_save_transaction_pointer (transaction);
+    gsb_data_transaction_update_counters ( transaction, TRUE );
 
     return transaction -> transaction_number;
 }
@@ -2125,8 +2487,18 @@ gint gsb_data_transaction_new_white_line ( gint mother_transaction_number)
     else
 	transaction -> transaction_number = -1;
 
-    white_transactions_list = g_slist_append ( white_transactions_list,
-					       transaction );
+    white_transactions_list = gsb_data_transaction_list_append ( white_transactions_list,
+                        &white_transactions_list_tail,
+                        transaction );
+
+    if ( !white_transactions_hash )
+        white_transactions_hash = g_hash_table_new ( g_direct_hash, g_direct_equal );
+    g_hash_table_insert ( white_transactions_hash,
+                        GINT_TO_POINTER ( transaction -> transaction_number ),
+                        transaction );
+
+    if ( transaction -> transaction_number < last_white_transaction_number )
+        last_white_transaction_number = transaction -> transaction_number;
 
     gsb_data_transaction_save_transaction_pointer (transaction);
 
@@ -2156,6 +2528,7 @@ gboolean gsb_data_transaction_copy_transaction ( gint source_transaction_number,
     TransactionStruct *source_transaction;
     TransactionStruct *target_transaction;
     gint target_transaction_account_number;
+    gboolean target_in_transactions_list;
 
     source_transaction = gsb_data_transaction_get_transaction_by_no ( source_transaction_number);
     target_transaction = gsb_data_transaction_get_transaction_by_no ( target_transaction_number);
@@ -2167,12 +2540,15 @@ gboolean gsb_data_transaction_copy_transaction ( gint source_transaction_number,
 
     /* on sauvegarde le numéro de compte initial */
     target_transaction_account_number = target_transaction -> account_number;
+    target_in_transactions_list = target_transaction -> in_transactions_list;
 
+    gsb_data_transaction_update_counters ( target_transaction, FALSE );
     memcpy ( target_transaction,
 	     source_transaction,
 	     sizeof ( TransactionStruct ));
     target_transaction -> transaction_number = target_transaction_number;
     target_transaction -> account_number = target_transaction_account_number;
+    target_transaction -> in_transactions_list = target_in_transactions_list;
     if ( reset_mark )
     {
         target_transaction -> reconcile_number = 0;
@@ -2182,6 +2558,9 @@ gboolean gsb_data_transaction_copy_transaction ( gint source_transaction_number,
 
     /* make the archive_number */
     target_transaction -> archive_number = 0;
+    gsb_data_account_balance_index_update_transaction ( target_transaction_account_number,
+                        target_transaction_number );
+    gsb_data_transaction_update_counters ( target_transaction, TRUE );
 
     /* make a new copy of all the pointers */
     if (source_transaction -> notes)
@@ -2213,7 +2592,8 @@ static void gsb_data_transaction_free ( TransactionStruct *transaction)
     if ( ! transaction )
         return;
 
-    gsb_data_account_set_balances_are_dirty ( transaction -> account_number );
+    gsb_data_account_balance_index_update_transaction ( transaction -> account_number,
+                        transaction -> transaction_number );
 
     g_free ( transaction -> transaction_id );
     g_free ( transaction -> notes );
@@ -2251,6 +2631,9 @@ gboolean gsb_data_transaction_remove_transaction ( gint transaction_number )
     if ( !transaction )
 	return FALSE;
 
+    /* we remove the transaction from the counters while its contra-transaction exists */
+    gsb_data_transaction_update_counters ( transaction, FALSE );
+
     /* check if it's a transfer */
     if (transaction -> transaction_number_transfer)
     {
@@ -2260,15 +2643,10 @@ gboolean gsb_data_transaction_remove_transaction ( gint transaction_number )
 	if (contra_transaction)
 	{
 	    /* we remove the transaction from the counters */
-	    gsb_data_payee_remove_transaction_from_payee (contra_transaction -> transaction_number) ;
-	    gsb_data_category_remove_transaction_from_category (contra_transaction -> transaction_number);
-	    gsb_data_budget_remove_transaction_from_budget (contra_transaction -> transaction_number);
+	    gsb_data_transaction_update_counters ( contra_transaction, FALSE );
 
 	    /* we remove the transaction from the 2 lists */
-	    transactions_list = g_slist_remove ( transactions_list,
-						 contra_transaction );
-	    complete_transactions_list = g_slist_remove ( complete_transactions_list,
-							  contra_transaction );
+	    gsb_data_transaction_index_remove ( contra_transaction );
 	    gsb_data_transaction_free (contra_transaction);
 	}
     }
@@ -2292,40 +2670,24 @@ gboolean gsb_data_transaction_remove_transaction ( gint transaction_number )
 		/* it's a transfer, delete the transfer */
 
 		/* we remove the transaction from the counters */
-		gsb_data_payee_remove_transaction_from_payee (contra_transaction -> transaction_number) ;
-		gsb_data_category_remove_transaction_from_category (contra_transaction -> transaction_number);
-		gsb_data_budget_remove_transaction_from_budget (contra_transaction -> transaction_number);
-
-		transactions_list = g_slist_remove ( transactions_list,
-						     contra_transaction );
-		complete_transactions_list = g_slist_remove ( complete_transactions_list,
-							      contra_transaction );
+		gsb_data_transaction_update_counters ( contra_transaction, FALSE );
+
+		gsb_data_transaction_index_remove ( contra_transaction );
 		gsb_data_transaction_free (contra_transaction);
 	    }
 
 	    /* delete the child */
 	    /* we remove the child from the counters */
-	    gsb_data_payee_remove_transaction_from_payee (child_transaction -> transaction_number) ;
-	    gsb_data_category_remove_transaction_from_category (child_transaction -> transaction_number);
-	    gsb_data_budget_remove_transaction_from_budget (child_transaction -> transaction_number);
-
-	    transactions_list = g_slist_remove ( transactions_list,
-						 child_transaction );
-	    complete_transactions_list = g_slist_remove ( complete_transactions_list,
-							  child_transaction );
+	    gsb_data_transaction_update_counters ( child_transaction, FALSE );
+
+	    gsb_data_transaction_index_remove ( child_transaction );
 	    gsb_data_transaction_free (child_transaction);
 	    tmp_list = tmp_list -> next;
 	}
     }
 
-    /* we have now to remove the transaction from the counters */
-    gsb_data_payee_remove_transaction_from_payee (transaction_number);
-    gsb_data_category_remove_transaction_from_category (transaction_number);
-    gsb_data_budget_remove_transaction_from_budget (transaction_number);
-
     /* now can remove safely the transaction */
-    transactions_list = g_slist_remove ( transactions_list, transaction );
-    complete_transactions_list = g_slist_remove ( complete_transactions_list, transaction );
+    gsb_data_transaction_index_remove ( transaction );
 
     /* force the update module budget */
     gsb_data_account_set_bet_maj ( transaction -> account_number, BET_MAJ_ALL );
@@ -2349,17 +2711,26 @@ gboolean gsb_data_transaction_remove_transaction ( gint transaction_number )
 gboolean gsb_data_transaction_remove_transaction_without_check ( gint transaction_number )
 {
     TransactionStruct *transaction;
+    TransactionStruct *contra_transaction = NULL;
 
     transaction = gsb_data_transaction_get_transaction_by_no (transaction_number);
 
     if ( !transaction )
 	return FALSE;
 
-    /* delete the transaction from the lists */
-    transactions_list = g_slist_remove ( transactions_list,
-					 transaction );
-    complete_transactions_list = g_slist_remove ( complete_transactions_list,
-						  transaction );
+    /* the contra-transaction can be counted differently without that transaction */
+    if ( transaction -> transaction_number_transfer > 0 )
+        contra_transaction = gsb_data_transaction_get_transaction_by_no (
+                        transaction -> transaction_number_transfer );
+    if ( contra_transaction )
+        gsb_data_transaction_update_counters ( contra_transaction, FALSE );
+
+    /* delete the transaction from the counters and the lists */
+    gsb_data_transaction_update_counters ( transaction, FALSE );
+    gsb_data_transaction_index_remove ( transaction );
+
+    if ( contra_transaction )
+        gsb_data_transaction_update_counters ( contra_transaction, TRUE );
 
     /* we free the buffer to avoid big possibly crashes */
     transaction_buffer[0] = NULL;
@@ -2392,6 +2763,28 @@ void gsb_data_transaction_delete_all_transactions ( void )
         g_slist_free ( transactions_list );
         transactions_list = NULL;
     }
+    if ( white_transactions_list )
+    {
+        g_slist_free_full ( white_transactions_list, (GDestroyNotify) gsb_data_transaction_free );
+        white_transactions_list = NULL;
+    }
+    if ( transactions_hash )
+    {
+        g_hash_table_destroy ( transactions_hash );
+        transactions_hash = NULL;
+    }
+    if ( white_transactions_hash )
+    {
+        g_hash_table_destroy ( white_transactions_hash );
+        white_transactions_hash = NULL;
+    }
+    gsb_search_index_free ();
+    gsb_file_cache_forget_archives ();
+    transactions_list_tail = NULL;
+    complete_transactions_list_tail = NULL;
+    white_transactions_list_tail = NULL;
+    last_transaction_number = 0;
+    last_white_transaction_number = 0;
     transaction_buffer[0] = NULL;
     transaction_buffer[1] = NULL;
     current_transaction_buffer = 0;
@@ -2432,11 +2825,11 @@ GSList *gsb_data_transaction_get_children ( gint transaction_number,
 	if ( tmp_transaction -> mother_transaction_number == transaction_number )
 	{
 	    if (return_number)
-		children_list = g_slist_append ( children_list,
-						 GINT_TO_POINTER (tmp_transaction -> transaction_number));
+		children_list = g_slist_prepend ( children_list,
+						  GINT_TO_POINTER (tmp_transaction -> transaction_number));
 	    else
-		children_list = g_slist_append ( children_list,
-						 tmp_transaction);
+		children_list = g_slist_prepend ( children_list,
+						  tmp_transaction);
 	}
 	tmp_list = tmp_list -> next;
     }
@@ -2452,16 +2845,16 @@ GSList *gsb_data_transaction_get_children ( gint transaction_number,
 	if ( tmp_transaction -> mother_transaction_number == transaction_number )
 	{
 	    if (return_number)
-		children_list = g_slist_append ( children_list,
-						 GINT_TO_POINTER (tmp_transaction -> transaction_number));
+		children_list = g_slist_prepend ( children_list,
+						  GINT_TO_POINTER (tmp_transaction -> transaction_number));
 	    else
-		children_list = g_slist_append ( children_list,
-						 tmp_transaction);
+		children_list = g_slist_prepend ( children_list,
+						  tmp_transaction);
 	}
 	tmp_list = tmp_list -> next;
     }
 
-    return children_list;
+    return g_slist_reverse ( children_list );
 }
 
 
@@ -2587,14 +2980,20 @@ gint gsb_data_transaction_check_content_payment ( gint payment_number,
 
 /**
  * return a copy of the g_slist of transactions structure
- * sorted by date
- *  * THIS IS THE LIST WITHOUT THE ARCHIVED TRANSACTIONS
+ * sorted by date, to show the transactions of a division in a metatree
+ * with the archived transactions if they are in the totals of the metatree,
+ * the archives kept in the cache of the file are loaded only if they
+ * have transactions of that division
  *
- * \param none
+ * \param content METATREE_PAYEE, METATREE_CATEGORY or METATREE_BUDGET
+ * \param div_number the division shown
+ * \param sub_div_number the sub-division shown, -1 for all the sub-divisions
  *
  * \return the slist of transactions structures
  * */
-GSList *gsb_data_transaction_get_metatree_transactions_list ( void )
+GSList *gsb_data_transaction_get_metatree_transactions_list ( gint content,
+                        gint div_number,
+                        gint sub_div_number )
 {
     GSList *list_tmp;
 	GrisbiWinEtat *w_etat;
@@ -2602,7 +3001,10 @@ GSList *gsb_data_transaction_get_metatree_transactions_list ( void )
 	w_etat = grisbi_win_get_w_etat ();
 
     if ( w_etat->metatree_add_archive_in_totals )
+    {
+        gsb_file_cache_load_division_archives ( content, div_number, sub_div_number );
         list_tmp = g_slist_copy ( complete_transactions_list );
+    }
     else
         list_tmp = g_slist_copy ( transactions_list );
 
@@ -2729,7 +3131,12 @@ gboolean gsb_data_transaction_remove_transaction_in_transaction_list ( gint tran
         return FALSE;
 
     /* delete the transaction from the lists */
-    transactions_list = g_slist_remove ( transactions_list, transaction );
+    gsb_data_transaction_update_counters ( transaction, FALSE );
+    transactions_list = gsb_data_transaction_list_remove ( transactions_list,
+                        &transactions_list_tail,
+                        transaction );
+    transaction -> in_transactions_list = FALSE;
+    gsb_data_transaction_update_counters ( transaction, TRUE );
 
     return TRUE;
 }
@@ -2769,13 +3176,12 @@ GSList *gsb_import_get_transactions_list_for_import (gint account_number,
 			&&
 			g_date_compare (ope_date, first_date_import) >= 0)
         {
-            ope_list = g_slist_insert_sorted (ope_list,
-											  transaction,
-											  (GCompareFunc) classement_sliste_transactions_par_date_decroissante);
+            ope_list = g_slist_prepend (ope_list, transaction);
         }
 
         tmp_list = tmp_list->next;
     }
+	ope_list = g_slist_sort (ope_list, (GCompareFunc) classement_sliste_transactions_par_date_decroissante);
 
 	tmp_list = ope_list;
     while (tmp_list)
@@ -2783,13 +3189,13 @@ GSList *gsb_import_get_transactions_list_for_import (gint account_number,
         TransactionStruct *transaction;
 
         transaction = tmp_list->data;
-		return_list = g_slist_append (return_list, GINT_TO_POINTER (transaction->transaction_number));
+		return_list = g_slist_prepend (return_list, GINT_TO_POINTER (transaction->transaction_number));
 		tmp_list = tmp_list->next;
     }
 
     g_slist_free (ope_list);
 
-    return return_list;
+    return g_slist_reverse (return_list);
 }
 
 /*
@@ -58,8 +58,11 @@ GsbReal 		gsb_data_transaction_get_last_transaction_with_div_sub_div 		(gint acc
 																				 gint div_number,
 																				 gint sub_div_nb,
 																				 gint type_div);
+GSList *		gsb_data_transaction_get_loaded_transactions_list 				(void);
 gint 			gsb_data_transaction_get_marked_transaction 					(gint transaction_number);
-GSList *		gsb_data_transaction_get_metatree_transactions_list 			(void);
+GSList *		gsb_data_transaction_get_metatree_transactions_list 			(gint content,
+																				 gint div_number,
+																				 gint sub_div_number);
 const gchar *	gsb_data_transaction_get_method_of_payment_content				(gint transaction_number);
 gint 			gsb_data_transaction_get_method_of_payment_number 				(gint transaction_number);
 gint 			gsb_data_transaction_get_mother_transaction_number 				(gint transaction_number);
@@ -80,6 +83,8 @@ const GDate *	gsb_data_transaction_get_value_date_or_date 					(gint transaction
 const gchar *	gsb_data_transaction_get_voucher 								(gint transaction_number);
 gint 			gsb_data_transaction_get_white_line 							(gint transaction_number);
 gboolean 		gsb_data_transaction_init_variables 							(void);
+void 			gsb_data_transaction_invalidate_counters 						(void);
+gboolean 		gsb_data_transaction_is_in_transactions_list 					(gint transaction_number);
 gint 			gsb_data_transaction_new_transaction 							(gint no_account);
 gint 			gsb_data_transaction_new_transaction_with_number 				(gint no_account,
                         														 gint transaction_number);
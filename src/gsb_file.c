@@ -48,6 +48,7 @@
 #include "gsb_data_account.h"
 #include "gsb_data_archive_store.h"
 #include "gsb_dirs.h"
+#include "gsb_file_cache.h"
 #include "gsb_file_load.h"
 #include "gsb_file_save.h"
 #include "gsb_file_util.h"
@@ -447,15 +448,38 @@ static gint gsb_file_dialog_save (const gchar *filename,
     return result;
 }
 
+/**
+ * called when a backup saved in background is finished
+ *
+ * \param filename the name of the backup
+ * \param saved TRUE if the backup is saved
+ * \param file_changed not used, the file stays modified after a backup
+ * \param parts_position not used, there is no cache for the backups
+ * \param user_data not used
+ *
+ * \return
+ **/
+static void gsb_file_save_backup_done (const gchar *filename,
+									   gboolean saved,
+									   gboolean file_changed,
+									   const GsbFileSavePartsPosition *parts_position,
+									   gpointer user_data)
+{
+    grisbi_win_status_bar_message (_("Done"));
+}
+
 /**
  * save a backup of the file
  *
- * \param
+ * \param make_bakup_single_file
+ * \param compress_backup
+ * \param in_background TRUE to save the backup without blocking the gui
  *
  * \return TRUE ok, FALSE problem
  **/
 static gboolean gsb_file_save_backup (gboolean make_bakup_single_file,
-									  gboolean compress_backup)
+									  gboolean compress_backup,
+									  gboolean in_background)
 {
     gboolean retour;
 	gchar *new_filename;
@@ -509,13 +533,20 @@ static gboolean gsb_file_save_backup (gboolean make_bakup_single_file,
 										 day_time->tm_sec);
     }
 
-    retour = gsb_file_save_save_file (new_filename, compress_backup, 0);
+    if (in_background)
+        retour = gsb_file_save_save_file_in_background (new_filename,
+														compress_backup,
+														gsb_file_save_backup_done,
+														NULL);
+    else
+    {
+        retour = gsb_file_save_save_file (new_filename, compress_backup, 0, NULL);
+        grisbi_win_status_bar_message (_("Done"));
+    }
 
     g_free (new_filename);
     g_free (name);
 
-    grisbi_win_status_bar_message (_("Done"));
-
     return (retour);
 }
 
@@ -538,13 +569,104 @@ static gboolean gsb_file_automatic_backup (gpointer p_conf)
 	/* stop the timeout */
         return FALSE;
 
-    /* we save only if there is a nb of minutes, but don't stop the timer if not */
-    if (a_conf->make_backup_nb_minutes)
-        gsb_file_save_backup (a_conf->make_bakup_single_file, a_conf->compress_backup);
+    /* we save only if there is a nb of minutes, but don't stop the timer if not,
+     * and not while the file is saving */
+    if (a_conf->make_backup_nb_minutes && !run.file_is_saving)
+        gsb_file_save_backup (a_conf->make_bakup_single_file, a_conf->compress_backup, TRUE);
 
     return TRUE;
 }
 
+/**
+ * update grisbi after the file is saved
+ *
+ * \param filename the previous name of the file, NULL if it had no name
+ * \param new_filename the name of the saved file
+ * \param origine 0 from gsb_file_save (menu), -1 from gsb_file_close, -2 from gsb_file_save_as
+ * \param saved TRUE if the file is saved
+ * \param file_changed TRUE if the file was modified during the save, it stays modified
+ * \param parts_position the position of the parts in the saved file, for its cache
+ *
+ * \return
+ **/
+static void gsb_file_save_file_finish (const gchar *filename,
+									   const gchar *new_filename,
+									   gint origine,
+									   gboolean saved,
+									   gboolean file_changed,
+									   const GsbFileSavePartsPosition *parts_position)
+{
+	GrisbiAppConf *a_conf;
+
+	a_conf = grisbi_app_get_a_conf ();
+
+    if (saved)
+    {
+		grisbi_win_set_filename (NULL, new_filename);
+
+		/* on ajoute un item au menu recent_file si origine = -2 */
+		if (origine == -2)
+			utils_files_append_name_to_recent_array (new_filename);
+
+		/* saving was right, so unlock the last name */
+        gsb_file_util_modify_lock (filename, FALSE);
+
+        /* and lock the new name */
+        gsb_file_util_modify_lock (new_filename, TRUE);
+
+        /* update variables */
+        etat.fichier_deja_ouvert = 0;
+        if (!file_changed)
+            gsb_file_set_modified (FALSE);
+
+		/* the cache of the file must be made from the data saved in the file */
+		if (file_changed)
+			gsb_file_cache_remove (new_filename);
+		else
+			gsb_file_cache_save (new_filename, parts_position);
+        grisbi_win_set_window_title (gsb_gui_navigation_get_current_account ());
+
+		/* Si nettoyage des fichiers de backup on le fait ici */
+		if (a_conf->remove_backup_files)
+		{
+			GrisbiWinRun *w_run;
+
+			w_run = (GrisbiWinRun *) grisbi_win_get_w_run ();
+			if (!w_run->remove_backup_files)
+			{
+				gsb_file_remove_old_backup (new_filename,a_conf->remove_backup_months);
+				w_run->remove_backup_files = TRUE;
+			}
+		}
+    }
+
+    grisbi_win_status_bar_message (_("Done"));
+}
+
+/**
+ * called when the file saved in background is finished
+ *
+ * \param new_filename the name of the saved file
+ * \param saved TRUE if the file is saved
+ * \param file_changed TRUE if the file was modified during the save
+ * \param parts_position the position of the parts in the saved file
+ * \param user_data the previous name of the file, freed here
+ *
+ * \return
+ **/
+static void gsb_file_save_file_done (const gchar *new_filename,
+									 gboolean saved,
+									 gboolean file_changed,
+									 const GsbFileSavePartsPosition *parts_position,
+									 gpointer user_data)
+{
+	gchar *filename;
+
+	filename = (gchar *) user_data;
+	gsb_file_save_file_finish (filename, new_filename, 0, saved, file_changed, parts_position);
+	g_free (filename);
+}
+
 /**
  * save the file
  *
@@ -557,10 +679,14 @@ static gboolean gsb_file_save_file (gint origine)
     gint result = 0;
     gchar *nouveau_nom_enregistrement;
 	gchar *filename;
+	GsbFileSavePartsPosition parts_position;
 	GrisbiAppConf *a_conf;
 
     devel_debug_int (origine);
 
+	/* a save in background not finished could change the modified state */
+	gsb_file_save_wait_background ();
+
 	/* on regarde si il y a quelque chose à sauvegarder sauf pour "sauvegarder sous" */
 	if ((!gsb_file_get_modified () && origine != -2)
         ||
@@ -621,49 +747,34 @@ static gboolean gsb_file_save_file (gint origine)
 
     /* make backup before saving if asked */
     if (a_conf->sauvegarde_fermeture)
-        gsb_file_save_backup (a_conf->make_bakup_single_file, a_conf->compress_backup);
+        gsb_file_save_backup (a_conf->make_bakup_single_file, a_conf->compress_backup, FALSE);
 
     /*  on a maintenant un nom de fichier et on sait qu'on peut sauvegarder */
     grisbi_win_status_bar_message (_("Saving file"));
 
-    result = gsb_file_save_save_file (nouveau_nom_enregistrement, a_conf->compress_file, 0);
-
-    if (result)
+    /* the save from the menu doesn't block the gui, the end is done
+     * by gsb_file_save_file_done */
+    if (origine == 0)
     {
-		grisbi_win_set_filename (NULL, nouveau_nom_enregistrement);
-
-		/* on ajoute un item au menu recent_file si origine = -2 */
-		if (origine == -2)
-			utils_files_append_name_to_recent_array (nouveau_nom_enregistrement);
-
-		/* saving was right, so unlock the last name */
-        gsb_file_util_modify_lock (filename, FALSE);
-
-        /* and lock the new name */
-        gsb_file_util_modify_lock (nouveau_nom_enregistrement, TRUE);
-
-        /* update variables */
-        etat.fichier_deja_ouvert = 0;
-        gsb_file_set_modified (FALSE);
-        grisbi_win_set_window_title (gsb_gui_navigation_get_current_account ());
-
-		/* Si nettoyage des fichiers de backup on le fait ici */
-		if (a_conf->remove_backup_files)
-		{
-			GrisbiWinRun *w_run;
+        result = gsb_file_save_save_file_in_background (nouveau_nom_enregistrement,
+														a_conf->compress_file,
+														gsb_file_save_file_done,
+														filename);
+        g_free (nouveau_nom_enregistrement);
+        if (!result)
+        {
+            g_free (filename);
+            grisbi_win_status_bar_message (_("Done"));
+        }
 
-			w_run = (GrisbiWinRun *) grisbi_win_get_w_run ();
-			if (!w_run->remove_backup_files)
-			{
-				gsb_file_remove_old_backup (nouveau_nom_enregistrement,a_conf->remove_backup_months);
-				w_run->remove_backup_files = TRUE;
-			}
-		}
+        return (result);
     }
 
+    result = gsb_file_save_save_file (nouveau_nom_enregistrement, a_conf->compress_file, 0, &parts_position);
+    gsb_file_save_file_finish (filename, nouveau_nom_enregistrement, origine, result, FALSE, &parts_position);
+
 	g_free (filename);
 	g_free (nouveau_nom_enregistrement);
-    grisbi_win_status_bar_message (_("Done"));
 
     return (result);
 }
@@ -902,7 +1013,7 @@ gboolean gsb_file_open_file (const gchar *filename)
         /* we make a backup if necessary */
         if (a_conf->sauvegarde_demarrage)
         {
-			gsb_file_save_backup (a_conf->make_bakup_single_file, a_conf->compress_backup);
+			gsb_file_save_backup (a_conf->make_bakup_single_file, a_conf->compress_backup, FALSE);
         }
     }
     else
@@ -1100,6 +1211,9 @@ gboolean gsb_file_close (void)
         return TRUE;
 	}
 
+	/* a save in background must be finished before closing the file */
+	gsb_file_save_wait_background ();
+
 	a_conf = grisbi_app_get_a_conf ();
 
 	/* on récupère le nom du fichier */
@@ -1170,6 +1284,7 @@ void gsb_file_set_modified (gboolean modified)
     {
 		/* modification pour gerer la non modification par la recherche dans la liste des operations */
 		run.file_modification = time (NULL);
+		run.file_modification_stamp++;
         gsb_menu_gui_sensitive_win_menu_item ("save", TRUE);
     }
     else
@@ -1290,6 +1405,9 @@ gboolean gsb_file_quit (void)
         return TRUE;
 	}
 
+	/* a save in background must be finished before closing the file */
+	gsb_file_save_wait_background ();
+
 	a_conf = grisbi_app_get_a_conf ();
 
 	/* on récupère le nom du fichier */
@@ -0,0 +1,2835 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*     Copyright (C)    2000-2008 Cédric Auger (cedric@grisbi.org)            */
+/*          2003-2009 Benjamin Drieu (bdrieu@april.org)                       */
+/*          2008-2021 Pierre Biava (grisbi@pierre.biava.name)                 */
+/*          https://www.grisbi.org/                                           */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file gsb_file_cache.c
+ * binary cache of the grisbi file
+ *
+ * the cache is a file written next to the grisbi file, named .name.gsb.cache,
+ * which contains the transactions, the payees, the categories and the budgets
+ * as tables of fixed size records which are read directly from the mapped file.
+ * it is used only if the grisbi file is the one saved with the cache : same size
+ * and same checksum, computed on all the file each time the cache is opened.
+ * Else the grisbi file is loaded as usual. The grisbi file is always
+ * the reference, the cache can be removed at any time.
+ *
+ * the archived transactions are kept in compressed segments, one by archive,
+ * with a summary by account and totals by payee, category and budget of each
+ * archive. When the file is loaded from the cache, only the summaries and the
+ * totals are read, the segments stay in the mapped cache and an archive is
+ * loaded when its transactions are needed : to show the archive in the list
+ * of transactions or in a metatree, to search or to compute a report in the
+ * archives, or for the functions which change the archived transactions.
+ * The balances and the counters of the metatrees use the summaries and the
+ * totals while the amounts they keep are right.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+#include <glib/gstdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+/*START_INCLUDE*/
+#include "gsb_file_cache.h"
+#include "grisbi_win.h"
+#include "gsb_data_account.h"
+#include "gsb_data_budget.h"
+#include "gsb_data_category.h"
+#include "gsb_data_currency.h"
+#include "gsb_data_payee.h"
+#include "gsb_data_transaction.h"
+#include "gsb_file_save.h"
+#include "gsb_real.h"
+#include "gsb_trace.h"
+#include "import.h"
+#include "structures.h"
+#include "utils_dates.h"
+#include "erreur.h"
+/*END_INCLUDE*/
+
+/*START_STATIC*/
+/*END_STATIC*/
+
+/*START_EXTERN*/
+/*END_EXTERN*/
+
+#define GSB_FILE_CACHE_MAGIC "GSBCACHE"
+#define GSB_FILE_CACHE_VERSION 5
+#define GSB_FILE_CACHE_BYTE_ORDER 0x01020304
+#define GSB_FILE_CACHE_CHECKSUM_SIZE 32
+
+/* the header of the cache, at the beginning of the file.
+ * the values are written in the byte order of the computer,
+ * a cache made on another computer is not used */
+typedef struct _GsbFileCacheHeader		GsbFileCacheHeader;
+
+struct _GsbFileCacheHeader
+{
+	gchar		magic[8];
+	guint32		version;
+	guint32		byte_order;
+	guint64		xml_size;									/* size of the grisbi file */
+	guint8		xml_checksum[GSB_FILE_CACHE_CHECKSUM_SIZE];	/* SHA256 of the grisbi file */
+	guint64		transactions_begin;							/* position of the parts in the grisbi file */
+	guint64		transactions_end;
+	guint64		divisions_begin;
+	guint64		divisions_end;
+	guint32		nb_transactions;							/* transactions not archived */
+	guint32		nb_payees;
+	guint32		nb_categories;								/* categories and sub-categories */
+	guint32		nb_budgets;									/* budgets and sub-budgets */
+	guint32		strings_size;
+	guint32		data_crc;									/* crc32 of all that follows the header */
+	guint32		nb_segments;								/* one segment by archive */
+	guint32		nb_summaries;
+	guint32		nb_totals;
+	guint32		reserved;									/* keeps segments_size aligned */
+	guint64		segments_size;								/* size of the compressed segments */
+};
+
+/* a transaction in the cache, the strings are offsets in the strings
+ * of the cache, 0 for a NULL string, the dates are julian days, 0 for no date */
+typedef struct _GsbFileCacheTransaction	GsbFileCacheTransaction;
+
+struct _GsbFileCacheTransaction
+{
+	gint64		amount;
+	gint64		exchange_rate;
+	gint64		exchange_fees;
+	gint32		amount_exponent;
+	gint32		exchange_rate_exponent;
+	gint32		exchange_fees_exponent;
+	gint32		account_number;
+	gint32		transaction_number;
+	gint32		currency_number;
+	gint32		change_between;
+	gint32		party_number;
+	gint32		category_number;
+	gint32		sub_category_number;
+	gint32		split_of_transaction;
+	gint32		method_of_payment_number;
+	gint32		marked_transaction;
+	gint32		archive_number;
+	gint32		automatic_transaction;
+	gint32		reconcile_number;
+	gint32		financial_year_number;
+	gint32		budgetary_number;
+	gint32		sub_budgetary_number;
+	gint32		contra_transaction_number;
+	gint32		mother_transaction_number;
+	guint32		date;
+	guint32		value_date;
+	guint32		transaction_id;
+	guint32		notes;
+	guint32		method_of_payment_content;
+	guint32		voucher;
+	guint32		bank_references;
+};
+
+/* a payee in the cache */
+typedef struct _GsbFileCachePayee		GsbFileCachePayee;
+
+struct _GsbFileCachePayee
+{
+	gint32		payee_number;
+	gint32		ignore_case;
+	gint32		use_regex;
+	guint32		name;
+	guint32		description;
+	guint32		search_string;
+};
+
+/* a category or a budget in the cache, the sub-divisions follow their division */
+typedef struct _GsbFileCacheDivision	GsbFileCacheDivision;
+
+struct _GsbFileCacheDivision
+{
+	gint32		div_number;						/* number of the division, 0 for a division */
+	gint32		number;
+	gint32		type;
+	guint32		name;
+};
+
+/* the transactions of an archive, compressed with zlib. The segment uncompressed
+ * contains the transactions then their strings, the offset 0 of the strings is
+ * the NULL string. The numbers of the transactions are kept sorted and not
+ * compressed, to find the archive of a transaction without loading it */
+typedef struct _GsbFileCacheSegment		GsbFileCacheSegment;
+
+struct _GsbFileCacheSegment
+{
+	guint64		offset;							/* position in the compressed segments */
+	guint32		compressed_size;
+	guint32		size;							/* size of the segment uncompressed */
+	gint32		archive_number;
+	guint32		nb_transactions;
+	guint32		numbers_index;					/* position of the first number of the segment */
+	gint32		last_transaction_number;
+};
+
+/* the summary of an archive for an account, see GsbFileCacheArchiveSummary */
+typedef struct _GsbFileCacheSummary		GsbFileCacheSummary;
+
+struct _GsbFileCacheSummary
+{
+	gint64		balance;
+	gint64		marked_balance;
+	gint64		waiting_marked_balance;
+	gint32		balance_exponent;
+	gint32		marked_balance_exponent;
+	gint32		waiting_marked_balance_exponent;
+	gint32		archive_number;
+	gint32		account_number;
+	guint32		nb_transactions;
+	guint32		nb_pointed;
+	guint32		nb_converted;
+	guint32		first_julian;
+	guint32		last_julian;
+};
+
+/* the total of an archive for a payee, a category or a budget,
+ * see GsbFileCacheArchiveTotal */
+typedef struct _GsbFileCacheTotal		GsbFileCacheTotal;
+
+struct _GsbFileCacheTotal
+{
+	gint64		amount;
+	gint32		amount_exponent;
+	gint32		archive_number;
+	gint32		type;
+	gint32		div_number;
+	gint32		sub_div_number;
+	gint32		currency_number;
+	guint32		nb_transactions;
+	guint32		nb_counted;
+};
+
+G_STATIC_ASSERT (sizeof (GsbFileCacheHeader) == 136);
+G_STATIC_ASSERT (sizeof (GsbFileCacheTransaction) == 136);
+G_STATIC_ASSERT (sizeof (GsbFileCachePayee) == 24);
+G_STATIC_ASSERT (sizeof (GsbFileCacheDivision) == 16);
+G_STATIC_ASSERT (sizeof (GsbFileCacheSegment) == 32);
+G_STATIC_ASSERT (sizeof (GsbFileCacheSummary) == 64);
+G_STATIC_ASSERT (sizeof (GsbFileCacheTotal) == 40);
+
+/* a cache opened to load a grisbi file
+ * the cache is made of the header, the tables of transactions, payees, categories
+ * and budgets, the segments, the summaries, the totals, the numbers of the archived
+ * transactions, the compressed segments and the strings */
+struct _GsbFileCache
+{
+	GMappedFile *					mapped_file;
+	const GsbFileCacheHeader *		header;
+	const GsbFileCacheTransaction *	transactions;
+	const GsbFileCachePayee *		payees;
+	const GsbFileCacheDivision *	categories;
+	const GsbFileCacheDivision *	budgets;
+	const GsbFileCacheSegment *		segments;
+	const GsbFileCacheSummary *		summaries;
+	const GsbFileCacheTotal *		totals;
+	const gint32 *					numbers;
+	const guint8 *					segments_data;
+	const gchar *					strings;
+};
+
+/* the archives of the file loaded from the cache which are not loaded yet,
+ * the cache stays mapped until they are all loaded or the file is closed */
+typedef struct _GsbFileCacheArchives	GsbFileCacheArchives;
+
+struct _GsbFileCacheArchives
+{
+	GMappedFile *		mapped_file;
+	const gint32 *		numbers;
+	const guint8 *		segments_data;
+	GSList *			segments;				/* the GsbFileCacheSegment not loaded */
+	GSList *			summaries;				/* the GsbFileCacheSummary of that segments */
+	GSList *			totals;					/* the GsbFileCacheTotal of that segments */
+};
+
+/* NULL if there is no archive to load */
+static GsbFileCacheArchives *pending_archives = NULL;
+
+/* TRUE while the cache is written, the archives are not loaded then */
+static gboolean archives_locked = FALSE;
+
+/* a copy of the transactions of the file which can be written by a thread,
+ * the transactions loaded are copied in records of the cache and the
+ * archives not loaded are read from their segments */
+struct _GsbFileCacheSnapshot
+{
+	GArray *			records;				/* GsbFileCacheTransaction of the transactions loaded */
+	GByteArray *		strings;				/* strings of that records */
+	GMappedFile *		mapped_file;			/* the cache of the archives not loaded, or NULL */
+	const guint8 *		segments_data;
+	GSList *			segments;				/* the GsbFileCacheSegment not loaded */
+	GHashTable *		currencies_floating_point;	/* floating point + 1 by currency number */
+	GHashTable *		accounts_floating_point;	/* floating point + 1 by account number */
+};
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
+/**
+ * get the name of the cache of a grisbi file, .name.gsb.cache in the same
+ * directory as the lock file
+ *
+ * \param filename the name of the grisbi file
+ *
+ * \return the name of the cache, to free
+ **/
+static gchar *gsb_file_cache_get_filename (const gchar *filename)
+{
+	gchar *cache_filename;
+	gchar *dir_part;
+	gchar *file_part;
+
+	dir_part = g_path_get_dirname (filename);
+	file_part = g_path_get_basename (filename);
+
+	cache_filename = g_strconcat (dir_part, G_DIR_SEPARATOR_S, ".", file_part, ".cache", NULL);
+
+	g_free (dir_part);
+	g_free (file_part);
+
+	return cache_filename;
+}
+
+/**
+ * compute the SHA256 of the grisbi file as it is on the disk
+ *
+ * \param filename
+ * \param checksum the buffer to fill with the checksum
+ * \param size a pointer to fill with the size of the file
+ *
+ * \return TRUE if the file could be read
+ **/
+static gboolean gsb_file_cache_get_xml_checksum (const gchar *filename,
+												 guint8 checksum[GSB_FILE_CACHE_CHECKSUM_SIZE],
+												 guint64 *size)
+{
+	GMappedFile *mapped_file;
+	GChecksum *sha256;
+	gsize checksum_size = GSB_FILE_CACHE_CHECKSUM_SIZE;
+
+	mapped_file = g_mapped_file_new (filename, FALSE, NULL);
+	if (!mapped_file)
+		return FALSE;
+
+	*size = g_mapped_file_get_length (mapped_file);
+
+	sha256 = g_checksum_new (G_CHECKSUM_SHA256);
+	if (*size)
+		g_checksum_update (sha256,
+						   (const guchar *) g_mapped_file_get_contents (mapped_file),
+						   *size);
+	g_checksum_get_digest (sha256, checksum, &checksum_size);
+
+	g_checksum_free (sha256);
+	g_mapped_file_unref (mapped_file);
+
+	return TRUE;
+}
+
+/**
+ * add a string to the strings of the cache
+ * the empty strings are saved as NULL, as in the grisbi file
+ *
+ * \param strings
+ * \param string
+ *
+ * \return the offset of the string, 0 for NULL
+ **/
+static guint32 gsb_file_cache_add_string (GByteArray *strings,
+										  const gchar *string)
+{
+	guint32 offset;
+
+	if (!string || !strlen (string))
+		return 0;
+
+	offset = strings->len;
+	g_byte_array_append (strings, (const guint8 *) string, strlen (string) + 1);
+
+	return offset;
+}
+
+/**
+ * add a name of category or budget to the strings of the cache,
+ * the name is saved as it is written in the grisbi file
+ *
+ * \param strings
+ * \param name the name to free
+ *
+ * \return the offset of the name, 0 for NULL
+ **/
+static guint32 gsb_file_cache_add_name (GByteArray *strings,
+										gchar *name)
+{
+	guint32 offset = 0;
+
+	if (name)
+	{
+		offset = strings->len;
+		g_byte_array_append (strings, (const guint8 *) name, strlen (name) + 1);
+		g_free (name);
+	}
+
+	return offset;
+}
+
+/**
+ * return the real as it is read from the grisbi file, without writing it :
+ * the value written by gsb_real_safe_real_to_string () then read by
+ * gsb_real_safe_real_from_string ()
+ *
+ * \param number
+ * \param floating_point the floating point used to save the real
+ *
+ * \return
+ **/
+static GsbReal gsb_file_cache_get_saved_real (GsbReal number,
+											  gint floating_point)
+{
+	gint64 power = 1;
+	lldiv_t units;
+	gint i;
+
+	if (number.exponent < 0
+		|| number.exponent >= EXPONENT_MAX
+		|| number.mantissa == error_real.mantissa)
+		return error_real;
+
+	if (floating_point != -1)
+		number = gsb_real_adjust_exponent (number, floating_point);
+
+	/* 0 is written "0.00" and read without exponent */
+	if (number.mantissa == 0)
+		return null_real;
+
+	/* the integer part is written from a double */
+	for (i = 0; i < number.exponent; i++)
+		power *= 10;
+	units = lldiv (llabs (number.mantissa), power);
+	if (units.quot > G_GINT64_CONSTANT (1) << 53)
+	{
+		units.quot = (gint64) (gdouble) units.quot;
+		number.mantissa = (number.mantissa < 0 ? -1 : 1) * (units.quot * power + units.rem);
+	}
+
+	/* a number without decimals is written with ".0" */
+	if (number.exponent == 0)
+	{
+		number.mantissa *= 10;
+		number.exponent = 1;
+	}
+
+	return number;
+}
+
+/**
+ * fill the record of a transaction in the cache,
+ * with the values as they are in the grisbi file
+ *
+ * \param transaction_number
+ * \param record the record to fill
+ * \param strings the strings of the record
+ *
+ * \return
+ **/
+static void gsb_file_cache_make_transaction_record (gint transaction_number,
+													GsbFileCacheTransaction *record,
+													GByteArray *strings)
+{
+	const GDate *date;
+	GsbReal number;
+
+	memset (record, 0, sizeof (GsbFileCacheTransaction));
+
+	/* the reals are rounded as in gsb_file_save_transaction_part */
+	number = gsb_file_cache_get_saved_real (gsb_data_transaction_get_amount (transaction_number),
+											gsb_data_transaction_get_currency_floating_point
+											(transaction_number));
+	record->amount = number.mantissa;
+	record->amount_exponent = number.exponent;
+	number = gsb_file_cache_get_saved_real (gsb_data_transaction_get_exchange_rate (transaction_number),
+											-1);
+	record->exchange_rate = number.mantissa;
+	record->exchange_rate_exponent = number.exponent;
+	number = gsb_file_cache_get_saved_real (gsb_data_transaction_get_exchange_fees (transaction_number),
+											gsb_data_account_get_currency_floating_point
+											(gsb_data_transaction_get_account_number (transaction_number)));
+	record->exchange_fees = number.mantissa;
+	record->exchange_fees_exponent = number.exponent;
+
+	record->account_number = gsb_data_transaction_get_account_number (transaction_number);
+	record->transaction_number = transaction_number;
+	record->currency_number = gsb_data_transaction_get_currency_number (transaction_number);
+	record->change_between = gsb_data_transaction_get_change_between (transaction_number);
+	record->party_number = gsb_data_transaction_get_party_number (transaction_number);
+	record->category_number = gsb_data_transaction_get_category_number (transaction_number);
+	record->sub_category_number = gsb_data_transaction_get_sub_category_number (transaction_number);
+	record->split_of_transaction = gsb_data_transaction_get_split_of_transaction (transaction_number);
+	record->method_of_payment_number = gsb_data_transaction_get_method_of_payment_number (transaction_number);
+	record->marked_transaction = gsb_data_transaction_get_marked_transaction (transaction_number);
+	record->archive_number = gsb_data_transaction_get_archive_number (transaction_number);
+	record->automatic_transaction = gsb_data_transaction_get_automatic_transaction (transaction_number);
+	record->reconcile_number = gsb_data_transaction_get_reconcile_number (transaction_number);
+	record->financial_year_number = gsb_data_transaction_get_financial_year_number (transaction_number);
+	record->budgetary_number = gsb_data_transaction_get_budgetary_number (transaction_number);
+	record->sub_budgetary_number = gsb_data_transaction_get_sub_budgetary_number (transaction_number);
+	record->contra_transaction_number = gsb_data_transaction_get_contra_transaction_number (transaction_number);
+	record->mother_transaction_number = gsb_data_transaction_get_mother_transaction_number (transaction_number);
+
+	date = gsb_data_transaction_get_date (transaction_number);
+	if (date && g_date_valid (date))
+		record->date = g_date_get_julian (date);
+	date = gsb_data_transaction_get_value_date (transaction_number);
+	if (date && g_date_valid (date))
+		record->value_date = g_date_get_julian (date);
+
+	record->transaction_id = gsb_file_cache_add_string (strings,
+														gsb_data_transaction_get_transaction_id
+														(transaction_number));
+	record->notes = gsb_file_cache_add_string (strings, gsb_data_transaction_get_notes (transaction_number));
+	record->method_of_payment_content = gsb_file_cache_add_string (strings,
+																   gsb_data_transaction_get_method_of_payment_content
+																   (transaction_number));
+	record->voucher = gsb_file_cache_add_string (strings, gsb_data_transaction_get_voucher (transaction_number));
+	record->bank_references = gsb_file_cache_add_string (strings,
+														 gsb_data_transaction_get_bank_references
+														 (transaction_number));
+}
+
+/**
+ * add the transactions not archived to the tables of the cache,
+ * the archived transactions are kept by archive to be saved in the segments
+ *
+ * \param tables
+ * \param strings
+ * \param archived the hash table to fill with the numbers of the archived
+ * transactions by archive, in a GArray
+ *
+ * \return the number of transactions not archived
+ **/
+static guint32 gsb_file_cache_save_transactions (GByteArray *tables,
+												 GByteArray *strings,
+												 GHashTable *archived)
+{
+	GSList *list_tmp;
+	guint32 nb_transactions = 0;
+
+	/* the archives not loaded are saved after, from the segments of the cache */
+	list_tmp = gsb_data_transaction_get_loaded_transactions_list ();
+
+	while (list_tmp)
+	{
+		GsbFileCacheTransaction record;
+		gint transaction_number;
+		gint archive_number;
+
+		transaction_number = gsb_data_transaction_get_transaction_number (list_tmp->data);
+		list_tmp = list_tmp->next;
+
+		archive_number = gsb_data_transaction_get_archive_number (transaction_number);
+		if (archive_number)
+		{
+			GArray *numbers;
+
+			numbers = g_hash_table_lookup (archived, GINT_TO_POINTER (archive_number));
+			if (!numbers)
+			{
+				numbers = g_array_new (FALSE, FALSE, sizeof (gint));
+				g_hash_table_insert (archived, GINT_TO_POINTER (archive_number), numbers);
+			}
+			g_array_append_val (numbers, transaction_number);
+			continue;
+		}
+
+		gsb_file_cache_make_transaction_record (transaction_number, &record, strings);
+		g_byte_array_append (tables, (const guint8 *) &record, sizeof (GsbFileCacheTransaction));
+		nb_transactions++;
+	}
+
+	return nb_transactions;
+}
+
+/**
+ * add an archived transaction to the summary of its account
+ *
+ * \param summaries the summaries of the archive by account
+ * \param archive_number
+ * \param transaction_number
+ *
+ * \return
+ **/
+static void gsb_file_cache_add_to_summaries (GHashTable *summaries,
+											 gint archive_number,
+											 gint transaction_number)
+{
+	GsbFileCacheArchiveSummary *summary;
+	const GDate *dates[2];
+	GsbReal amount;
+	gint account_number;
+	gint marked_transaction;
+	gint i;
+
+	account_number = gsb_data_transaction_get_account_number (transaction_number);
+	summary = g_hash_table_lookup (summaries, GINT_TO_POINTER (account_number));
+	if (!summary)
+	{
+		summary = g_malloc0 (sizeof (GsbFileCacheArchiveSummary));
+		summary->archive_number = archive_number;
+		summary->account_number = account_number;
+		summary->balance = null_real;
+		summary->marked_balance = null_real;
+		summary->waiting_marked_balance = null_real;
+		summary->first_julian = G_MAXUINT32;
+		g_hash_table_insert (summaries, GINT_TO_POINTER (account_number), summary);
+	}
+	summary->nb_transactions++;
+
+	/* the balances use the value dates and the dates */
+	dates[0] = gsb_data_transaction_get_date (transaction_number);
+	dates[1] = gsb_data_transaction_get_value_date (transaction_number);
+	for (i = 0; i < 2; i++)
+	{
+		guint32 julian;
+
+		if (!dates[i] || !g_date_valid (dates[i]))
+			continue;
+
+		julian = g_date_get_julian (dates[i]);
+		summary->first_julian = MIN (summary->first_julian, julian);
+		summary->last_julian = MAX (summary->last_julian, julian);
+	}
+
+	/* the children of the splits are not counted in the balances */
+	if (gsb_data_transaction_get_mother_transaction_number (transaction_number))
+		return;
+
+	/* the amount of these transactions depends on the exchange rates */
+	if (gsb_data_transaction_get_currency_number (transaction_number)
+		!= gsb_data_account_get_currency (account_number))
+		summary->nb_converted++;
+
+	amount = gsb_data_transaction_get_adjusted_amount (transaction_number,
+													   gsb_data_account_get_currency_floating_point
+													   (account_number));
+	summary->balance = gsb_real_add (summary->balance, amount);
+
+	marked_transaction = gsb_data_transaction_get_marked_transaction (transaction_number);
+	if (marked_transaction)
+	{
+		summary->marked_balance = gsb_real_add (summary->marked_balance, amount);
+		if (marked_transaction == OPERATION_POINTEE || marked_transaction == OPERATION_TELEPOINTEE)
+			summary->waiting_marked_balance = gsb_real_add (summary->waiting_marked_balance, amount);
+		if (marked_transaction == OPERATION_POINTEE)
+			summary->nb_pointed++;
+	}
+}
+
+/**
+ * hash a total of an archive by its division and its currency
+ *
+ * \param key a GsbFileCacheArchiveTotal
+ *
+ * 
+eturn the hash
+ **/
+static guint gsb_file_cache_total_hash (gconstpointer key)
+{
+	const GsbFileCacheArchiveTotal *total = key;
+
+	return ((guint) total->type * 31 + (guint) total->div_number) * 1000003
+		+ (guint) total->sub_div_number * 31 + (guint) total->currency_number;
+}
+
+/**
+ * compare 2 totals of an archive by their division and their currency
+ *
+ * \param key_1 a GsbFileCacheArchiveTotal
+ * \param key_2 a GsbFileCacheArchiveTotal
+ *
+ * 
+eturn TRUE if they are the same total
+ **/
+static gboolean gsb_file_cache_total_equal (gconstpointer key_1,
+											gconstpointer key_2)
+{
+	const GsbFileCacheArchiveTotal *total_1 = key_1;
+	const GsbFileCacheArchiveTotal *total_2 = key_2;
+
+	return total_1->type == total_2->type
+		&& total_1->div_number == total_2->div_number
+		&& total_1->sub_div_number == total_2->sub_div_number
+		&& total_1->currency_number == total_2->currency_number;
+}
+
+/**
+ * add an archived transaction to the total of a division
+ *
+ * \param totals the totals of the archive
+ * \param archive_number
+ * \param transaction_number
+ * \param type METATREE_PAYEE, METATREE_CATEGORY or METATREE_BUDGET
+ * \param div_number
+ * \param sub_div_number
+ * \param counted TRUE if the transaction is counted in the metatree
+ *
+ * 
+eturn
+ **/
+static void gsb_file_cache_add_to_total (GHashTable *totals,
+										 gint archive_number,
+										 gint transaction_number,
+										 gint type,
+										 gint div_number,
+										 gint sub_div_number,
+										 gboolean counted)
+{
+	GsbFileCacheArchiveTotal key;
+	GsbFileCacheArchiveTotal *total;
+
+	key.type = type;
+	key.div_number = div_number;
+	key.sub_div_number = sub_div_number;
+	key.currency_number = gsb_data_transaction_get_currency_number (transaction_number);
+
+	total = g_hash_table_lookup (totals, &key);
+	if (!total)
+	{
+		total = g_malloc0 (sizeof (GsbFileCacheArchiveTotal));
+		*total = key;
+		total->archive_number = archive_number;
+		total->amount = null_real;
+		g_hash_table_add (totals, total);
+	}
+	total->nb_transactions++;
+
+	if (!counted)
+		return;
+
+	/* as gsb_data_transaction_get_adjusted_amount_for_currency in the currency of the transaction */
+	total->amount = gsb_real_add (total->amount,
+								  gsb_real_adjust_exponent (gsb_data_transaction_get_amount (transaction_number),
+															gsb_data_currency_get_floating_point
+															(key.currency_number)));
+	total->nb_counted++;
+}
+
+/**
+ * add an archived transaction to the totals of its payee, its category and its budget
+ *
+ * \param totals the totals of the archive
+ * \param archive_number
+ * \param transaction_number
+ *
+ * 
+eturn
+ **/
+static void gsb_file_cache_add_to_totals (GHashTable *totals,
+										  gint archive_number,
+										  gint transaction_number)
+{
+	gsb_file_cache_add_to_total (totals,
+								 archive_number,
+								 transaction_number,
+								 METATREE_PAYEE,
+								 gsb_data_transaction_get_party_number (transaction_number),
+								 0,
+								 gsb_data_payee_transaction_is_counted (transaction_number));
+	gsb_file_cache_add_to_total (totals,
+								 archive_number,
+								 transaction_number,
+								 METATREE_CATEGORY,
+								 gsb_data_transaction_get_category_number (transaction_number),
+								 gsb_data_transaction_get_sub_category_number (transaction_number),
+								 gsb_data_category_transaction_is_counted (transaction_number));
+	gsb_file_cache_add_to_total (totals,
+								 archive_number,
+								 transaction_number,
+								 METATREE_BUDGET,
+								 gsb_data_transaction_get_budgetary_number (transaction_number),
+								 gsb_data_transaction_get_sub_budgetary_number (transaction_number),
+								 gsb_data_budget_transaction_is_counted (transaction_number));
+}
+
+/**
+ * add the summary of an archive for an account to the summaries of the cache
+ *
+ * \param summary
+ * \param summaries
+ *
+ * \return
+ **/
+static void gsb_file_cache_save_summary (const GsbFileCacheArchiveSummary *summary,
+										 GByteArray *summaries)
+{
+	GsbFileCacheSummary record;
+
+	memset (&record, 0, sizeof (GsbFileCacheSummary));
+	record.balance = summary->balance.mantissa;
+	record.balance_exponent = summary->balance.exponent;
+	record.marked_balance = summary->marked_balance.mantissa;
+	record.marked_balance_exponent = summary->marked_balance.exponent;
+	record.waiting_marked_balance = summary->waiting_marked_balance.mantissa;
+	record.waiting_marked_balance_exponent = summary->waiting_marked_balance.exponent;
+	record.archive_number = summary->archive_number;
+	record.account_number = summary->account_number;
+	record.nb_transactions = summary->nb_transactions;
+	record.nb_pointed = summary->nb_pointed;
+	record.nb_converted = summary->nb_converted;
+	record.last_julian = summary->last_julian;
+
+	/* no transaction with a date */
+	if (summary->first_julian <= summary->last_julian)
+		record.first_julian = summary->first_julian;
+
+	g_byte_array_append (summaries, (const guint8 *) &record, sizeof (GsbFileCacheSummary));
+}
+
+/**
+ * add the total of an archive for a division to the totals of the cache
+ *
+ * \param total
+ * \param totals
+ *
+ * 
+eturn
+ **/
+static void gsb_file_cache_save_total (const GsbFileCacheArchiveTotal *total,
+									   GByteArray *totals)
+{
+	GsbFileCacheTotal record;
+
+	memset (&record, 0, sizeof (GsbFileCacheTotal));
+	record.amount = total->amount.mantissa;
+	record.amount_exponent = total->amount.exponent;
+	record.archive_number = total->archive_number;
+	record.type = total->type;
+	record.div_number = total->div_number;
+	record.sub_div_number = total->sub_div_number;
+	record.currency_number = total->currency_number;
+	record.nb_transactions = total->nb_transactions;
+	record.nb_counted = total->nb_counted;
+
+	g_byte_array_append (totals, (const guint8 *) &record, sizeof (GsbFileCacheTotal));
+}
+
+/**
+ * compare 2 numbers for g_array_sort
+ *
+ * \param number_1
+ * \param number_2
+ *
+ * \return -1, 0 or 1 as strcmp
+ **/
+static gint gsb_file_cache_numbers_cmp (const gint *number_1,
+										const gint *number_2)
+{
+	if (*number_1 != *number_2)
+		return *number_1 < *number_2 ? -1 : 1;
+
+	return 0;
+}
+
+/**
+ * compare 2 numbers kept in pointers for g_list_sort
+ *
+ * \param pointer_1
+ * \param pointer_2
+ *
+ * \return -1, 0 or 1 as strcmp
+ **/
+static gint gsb_file_cache_pointers_cmp (gconstpointer pointer_1,
+										 gconstpointer pointer_2)
+{
+	gint number_1 = GPOINTER_TO_INT (pointer_1);
+	gint number_2 = GPOINTER_TO_INT (pointer_2);
+
+	return gsb_file_cache_numbers_cmp (&number_1, &number_2);
+}
+
+/**
+ * add the segment of the transactions of an archive to the cache
+ *
+ * \param archive_number
+ * \param transactions the numbers of the transactions of the archive
+ * \param segments the table of the segments
+ * \param summaries the table of the summaries
+ * \param totals the table of the totals
+ * \param numbers the numbers of the archived transactions
+ * \param segments_data the compressed segments
+ *
+ * \return TRUE if the segment is made
+ **/
+static gboolean gsb_file_cache_save_segment (gint archive_number,
+											 GArray *transactions,
+											 GByteArray *segments,
+											 GByteArray *summaries,
+											 GByteArray *totals,
+											 GByteArray *numbers,
+											 GByteArray *segments_data)
+{
+	GsbFileCacheSegment segment;
+	GByteArray *records;
+	GByteArray *strings;
+	GHashTable *account_summaries;
+	GHashTable *division_totals;
+	GHashTableIter iter;
+	gpointer value;
+	uLongf compressed_size;
+	guint i;
+	gint result;
+
+	memset (&segment, 0, sizeof (GsbFileCacheSegment));
+	segment.archive_number = archive_number;
+	segment.nb_transactions = transactions->len;
+	segment.numbers_index = numbers->len / sizeof (gint32);
+
+	records = g_byte_array_sized_new (transactions->len * sizeof (GsbFileCacheTransaction));
+	strings = g_byte_array_new ();
+	g_byte_array_append (strings, (const guint8 *) "", 1);
+	account_summaries = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+	division_totals = g_hash_table_new_full (gsb_file_cache_total_hash, gsb_file_cache_total_equal, g_free, NULL);
+
+	for (i = 0; i < transactions->len; i++)
+	{
+		GsbFileCacheTransaction record;
+		gint transaction_number;
+
+		transaction_number = g_array_index (transactions, gint, i);
+		gsb_file_cache_make_transaction_record (transaction_number, &record, strings);
+		g_byte_array_append (records, (const guint8 *) &record, sizeof (GsbFileCacheTransaction));
+		gsb_file_cache_add_to_summaries (account_summaries, archive_number, transaction_number);
+		gsb_file_cache_add_to_totals (division_totals, archive_number, transaction_number);
+
+		if (transaction_number > segment.last_transaction_number)
+			segment.last_transaction_number = transaction_number;
+	}
+
+	/* the strings of the segment follow its transactions */
+	g_byte_array_append (records, strings->data, strings->len);
+	g_byte_array_free (strings, TRUE);
+	segment.size = records->len;
+
+	segment.offset = segments_data->len;
+	compressed_size = compressBound (records->len);
+	g_byte_array_set_size (segments_data, segments_data->len + compressed_size);
+	result = compress2 (segments_data->data + segment.offset,
+						&compressed_size,
+						records->data,
+						records->len,
+						Z_BEST_SPEED);
+	g_byte_array_free (records, TRUE);
+
+	if (result != Z_OK)
+	{
+		g_hash_table_destroy (account_summaries);
+		g_hash_table_destroy (division_totals);
+		return FALSE;
+	}
+	g_byte_array_set_size (segments_data, segment.offset + compressed_size);
+	segment.compressed_size = compressed_size;
+	g_byte_array_append (segments, (const guint8 *) &segment, sizeof (GsbFileCacheSegment));
+
+	/* the numbers are sorted to find a transaction without loading the segment */
+	g_array_sort (transactions, (GCompareFunc) gsb_file_cache_numbers_cmp);
+	for (i = 0; i < transactions->len; i++)
+	{
+		gint32 number;
+
+		number = g_array_index (transactions, gint, i);
+		g_byte_array_append (numbers, (const guint8 *) &number, sizeof (gint32));
+	}
+
+	g_hash_table_iter_init (&iter, account_summaries);
+	while (g_hash_table_iter_next (&iter, NULL, &value))
+		gsb_file_cache_save_summary (value, summaries);
+	g_hash_table_destroy (account_summaries);
+
+	g_hash_table_iter_init (&iter, division_totals);
+	while (g_hash_table_iter_next (&iter, &value, NULL))
+		gsb_file_cache_save_total (value, totals);
+	g_hash_table_destroy (division_totals);
+
+	return TRUE;
+}
+
+/**
+ * add to the cache a segment which is not loaded, as it is in the cache
+ * which was used to load the file
+ *
+ * \param pending_segment
+ * \param segments the table of the segments
+ * \param summaries the table of the summaries
+ * \param totals the table of the totals
+ * \param numbers the numbers of the archived transactions
+ * \param segments_data the compressed segments
+ *
+ * \return
+ **/
+static void gsb_file_cache_save_pending_segment (const GsbFileCacheSegment *pending_segment,
+												 GByteArray *segments,
+												 GByteArray *summaries,
+												 GByteArray *totals,
+												 GByteArray *numbers,
+												 GByteArray *segments_data)
+{
+	GsbFileCacheSegment segment;
+	GSList *tmp_list;
+
+	segment = *pending_segment;
+	segment.offset = segments_data->len;
+	segment.numbers_index = numbers->len / sizeof (gint32);
+	g_byte_array_append (segments, (const guint8 *) &segment, sizeof (GsbFileCacheSegment));
+
+	g_byte_array_append (segments_data,
+						 pending_archives->segments_data + pending_segment->offset,
+						 pending_segment->compressed_size);
+	g_byte_array_append (numbers,
+						 (const guint8 *) (pending_archives->numbers + pending_segment->numbers_index),
+						 pending_segment->nb_transactions * sizeof (gint32));
+
+	tmp_list = pending_archives->summaries;
+	while (tmp_list)
+	{
+		const GsbFileCacheSummary *summary;
+
+		summary = tmp_list->data;
+		if (summary->archive_number == pending_segment->archive_number)
+			g_byte_array_append (summaries, (const guint8 *) summary, sizeof (GsbFileCacheSummary));
+
+		tmp_list = tmp_list->next;
+	}
+
+	tmp_list = pending_archives->totals;
+	while (tmp_list)
+	{
+		const GsbFileCacheTotal *total;
+
+		total = tmp_list->data;
+		if (total->archive_number == pending_segment->archive_number)
+			g_byte_array_append (totals, (const guint8 *) total, sizeof (GsbFileCacheTotal));
+
+		tmp_list = tmp_list->next;
+	}
+}
+
+/**
+ * add the segments of the archives to the cache, the loaded archives
+ * are compressed again, the others are copied from the cache
+ *
+ * \param archived the numbers of the archived transactions loaded, by archive
+ * \param segments the table of the segments
+ * \param summaries the table of the summaries
+ * \param totals the table of the totals
+ * \param numbers the numbers of the archived transactions
+ * \param segments_data the compressed segments
+ *
+ * \return TRUE if the segments are made
+ **/
+static gboolean gsb_file_cache_save_segments (GHashTable *archived,
+											  GByteArray *segments,
+											  GByteArray *summaries,
+											  GByteArray *totals,
+											  GByteArray *numbers,
+											  GByteArray *segments_data)
+{
+	GList *archives;
+	GList *tmp_list;
+	gboolean result = TRUE;
+
+	archives = g_hash_table_get_keys (archived);
+	archives = g_list_sort (archives, (GCompareFunc) gsb_file_cache_pointers_cmp);
+
+	for (tmp_list = archives; tmp_list && result; tmp_list = tmp_list->next)
+		result = gsb_file_cache_save_segment (GPOINTER_TO_INT (tmp_list->data),
+											  g_hash_table_lookup (archived, tmp_list->data),
+											  segments,
+											  summaries,
+											  totals,
+											  numbers,
+											  segments_data);
+	g_list_free (archives);
+
+	if (result && pending_archives)
+	{
+		GSList *pending_list;
+
+		pending_list = pending_archives->segments;
+		while (pending_list)
+		{
+			gsb_file_cache_save_pending_segment (pending_list->data,
+												 segments,
+												 summaries,
+												 totals,
+												 numbers,
+												 segments_data);
+			pending_list = pending_list->next;
+		}
+	}
+
+	return result;
+}
+
+/**
+ * add the payees to the tables of the cache
+ *
+ * \param tables
+ * \param strings
+ *
+ * \return the number of payees
+ **/
+static guint32 gsb_file_cache_save_payees (GByteArray *tables,
+										   GByteArray *strings)
+{
+	GSList *list_tmp;
+	guint32 nb_payees = 0;
+
+	list_tmp = gsb_data_payee_get_payees_list ();
+
+	while (list_tmp)
+	{
+		GsbFileCachePayee record;
+		gint payee_number;
+
+		payee_number = gsb_data_payee_get_no_payee (list_tmp->data);
+
+		/* as in the grisbi file, the payees without name are not saved */
+		if (gsb_data_payee_get_name (payee_number, TRUE) == NULL)
+		{
+			list_tmp = list_tmp->next;
+			continue;
+		}
+
+		record.payee_number = payee_number;
+		record.ignore_case = gsb_data_payee_get_ignore_case (payee_number);
+		record.use_regex = gsb_data_payee_get_use_regex (payee_number);
+		record.name = gsb_file_cache_add_string (strings, gsb_data_payee_get_name (payee_number, TRUE));
+		record.description = gsb_file_cache_add_string (strings, gsb_data_payee_get_description (payee_number));
+		record.search_string = gsb_file_cache_add_string (strings, gsb_data_payee_get_search_string (payee_number));
+
+		g_byte_array_append (tables, (const guint8 *) &record, sizeof (GsbFileCachePayee));
+		nb_payees++;
+
+		list_tmp = list_tmp->next;
+	}
+
+	return nb_payees;
+}
+
+/**
+ * add the categories and the sub-categories to the tables of the cache
+ *
+ * \param tables
+ * \param strings
+ *
+ * \return the number of categories and sub-categories
+ **/
+static guint32 gsb_file_cache_save_categories (GByteArray *tables,
+											   GByteArray *strings)
+{
+	GSList *list_tmp;
+	guint32 nb_categories = 0;
+
+	list_tmp = gsb_data_category_get_categories_list ();
+
+	while (list_tmp)
+	{
+		GsbFileCacheDivision record;
+		gint category_number;
+		GSList *sub_list_tmp;
+
+		category_number = gsb_data_category_get_no_category (list_tmp->data);
+
+		record.div_number = 0;
+		record.number = category_number;
+		record.type = gsb_data_category_get_type (category_number);
+		record.name = gsb_file_cache_add_name (strings, gsb_data_category_get_name (category_number, 0, NULL));
+		g_byte_array_append (tables, (const guint8 *) &record, sizeof (GsbFileCacheDivision));
+		nb_categories++;
+
+		sub_list_tmp = gsb_data_category_get_sub_category_list (category_number);
+
+		while (sub_list_tmp)
+		{
+			gint sub_category_number;
+
+			sub_category_number = gsb_data_category_get_no_sub_category (sub_list_tmp->data);
+
+			record.div_number = category_number;
+			record.number = sub_category_number;
+			record.type = 0;
+			record.name = gsb_file_cache_add_name (strings,
+												   gsb_data_category_get_sub_category_name (category_number,
+																							sub_category_number,
+																							NULL));
+			g_byte_array_append (tables, (const guint8 *) &record, sizeof (GsbFileCacheDivision));
+			nb_categories++;
+
+			sub_list_tmp = sub_list_tmp->next;
+		}
+
+		list_tmp = list_tmp->next;
+	}
+
+	return nb_categories;
+}
+
+/**
+ * add the budgets and the sub-budgets to the tables of the cache
+ *
+ * \param tables
+ * \param strings
+ *
+ * \return the number of budgets and sub-budgets
+ **/
+static guint32 gsb_file_cache_save_budgets (GByteArray *tables,
+											GByteArray *strings)
+{
+	GSList *list_tmp;
+	guint32 nb_budgets = 0;
+
+	list_tmp = gsb_data_budget_get_budgets_list ();
+
+	while (list_tmp)
+	{
+		GsbFileCacheDivision record;
+		gint budget_number;
+		GSList *sub_list_tmp;
+
+		budget_number = gsb_data_budget_get_no_budget (list_tmp->data);
+
+		record.div_number = 0;
+		record.number = budget_number;
+		record.type = gsb_data_budget_get_type (budget_number);
+		record.name = gsb_file_cache_add_name (strings, gsb_data_budget_get_name (budget_number, 0, NULL));
+		g_byte_array_append (tables, (const guint8 *) &record, sizeof (GsbFileCacheDivision));
+		nb_budgets++;
+
+		sub_list_tmp = gsb_data_budget_get_sub_budget_list (budget_number);
+
+		while (sub_list_tmp)
+		{
+			gint sub_budget_number;
+
+			sub_budget_number = gsb_data_budget_get_no_sub_budget (sub_list_tmp->data);
+
+			record.div_number = budget_number;
+			record.number = sub_budget_number;
+			record.type = 0;
+			record.name = gsb_file_cache_add_name (strings,
+												   gsb_data_budget_get_sub_budget_name (budget_number,
+																						sub_budget_number,
+																						NULL));
+			g_byte_array_append (tables, (const guint8 *) &record, sizeof (GsbFileCacheDivision));
+			nb_budgets++;
+
+			sub_list_tmp = sub_list_tmp->next;
+		}
+
+		list_tmp = list_tmp->next;
+	}
+
+	return nb_budgets;
+}
+
+/**
+ * write the cache in a temporary file which replaces the cache,
+ * without any message, the cache is not necessary
+ *
+ * \param cache_filename
+ * \param content
+ * \param length
+ *
+ * \return TRUE if the cache is written
+ **/
+static gboolean gsb_file_cache_write_file (const gchar *cache_filename,
+										   const guint8 *content,
+										   gsize length)
+{
+	gchar *tmp_filename;
+	gsize written = 0;
+	gint fd;
+
+	tmp_filename = g_strconcat (cache_filename, ".XXXXXX", NULL);
+	fd = g_mkstemp (tmp_filename);
+	if (fd == -1)
+	{
+		g_free (tmp_filename);
+		return FALSE;
+	}
+
+	while (written < length)
+	{
+		gssize result;
+
+		result = write (fd, content + written, length - written);
+		if (result < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		written += result;
+	}
+
+	if (close (fd) != 0 || written < length || g_rename (tmp_filename, cache_filename) != 0)
+	{
+		g_unlink (tmp_filename);
+		g_free (tmp_filename);
+
+		return FALSE;
+	}
+	g_free (tmp_filename);
+
+	return TRUE;
+}
+
+/**
+ * get a string of the cache
+ *
+ * \param strings the strings of the cache or of a segment
+ * \param strings_size
+ * \param offset
+ *
+ * \return the string, NULL for the offset 0
+ **/
+static const gchar *gsb_file_cache_get_string (const gchar *strings,
+											   guint32 strings_size,
+											   guint32 offset)
+{
+	if (!offset || offset >= strings_size)
+		return NULL;
+
+	return strings + offset;
+}
+
+/**
+ * load a transaction of the cache, as gsb_file_load_transactions_part does
+ *
+ * \param record
+ * \param strings the strings of the record
+ * \param strings_size
+ *
+ * \return
+ **/
+static void gsb_file_cache_load_transaction (const GsbFileCacheTransaction *record,
+											 const gchar *strings,
+											 guint32 strings_size)
+{
+	const gchar *string;
+	gint transaction_number;
+
+	transaction_number = gsb_data_transaction_new_transaction_with_number (record->account_number,
+																		   record->transaction_number);
+
+	string = gsb_file_cache_get_string (strings, strings_size, record->transaction_id);
+	if (string)
+		gsb_data_transaction_set_transaction_id (transaction_number, string);
+
+	if (record->date)
+	{
+		GDate *date;
+
+		date = g_date_new_julian (record->date);
+		gsb_data_transaction_set_date (transaction_number, date);
+		g_date_free (date);
+	}
+	if (record->value_date)
+	{
+		GDate *date;
+
+		date = g_date_new_julian (record->value_date);
+		gsb_data_transaction_set_value_date (transaction_number, date);
+		g_date_free (date);
+	}
+
+	gsb_data_transaction_set_currency_number (transaction_number, record->currency_number);
+	gsb_data_transaction_set_amount (transaction_number,
+									 gsb_real_new (record->amount, record->amount_exponent));
+	gsb_data_transaction_set_change_between (transaction_number, record->change_between);
+	gsb_data_transaction_set_exchange_rate (transaction_number,
+											gsb_real_new (record->exchange_rate,
+														  record->exchange_rate_exponent));
+	gsb_data_transaction_set_exchange_fees (transaction_number,
+											gsb_real_new (record->exchange_fees,
+														  record->exchange_fees_exponent));
+	gsb_data_transaction_set_party_number (transaction_number, record->party_number);
+	gsb_data_transaction_set_category_number (transaction_number, record->category_number);
+	gsb_data_transaction_set_sub_category_number (transaction_number, record->sub_category_number);
+	gsb_data_transaction_set_split_of_transaction (transaction_number, record->split_of_transaction);
+
+	string = gsb_file_cache_get_string (strings, strings_size, record->notes);
+	if (string)
+		gsb_data_transaction_set_notes (transaction_number, string);
+
+	gsb_data_transaction_set_method_of_payment_number (transaction_number, record->method_of_payment_number);
+
+	string = gsb_file_cache_get_string (strings, strings_size, record->method_of_payment_content);
+	if (string)
+		gsb_data_transaction_set_method_of_payment_content (transaction_number, string);
+
+	gsb_data_transaction_set_marked_transaction (transaction_number, record->marked_transaction);
+	gsb_data_transaction_set_archive_number (transaction_number, record->archive_number);
+	gsb_data_transaction_set_automatic_transaction (transaction_number, record->automatic_transaction);
+	gsb_data_transaction_set_reconcile_number (transaction_number, record->reconcile_number);
+	gsb_data_transaction_set_financial_year_number (transaction_number, record->financial_year_number);
+	gsb_data_transaction_set_budgetary_number (transaction_number, record->budgetary_number);
+	gsb_data_transaction_set_sub_budgetary_number (transaction_number, record->sub_budgetary_number);
+
+	string = gsb_file_cache_get_string (strings, strings_size, record->voucher);
+	if (string)
+		gsb_data_transaction_set_voucher (transaction_number, string);
+
+	string = gsb_file_cache_get_string (strings, strings_size, record->bank_references);
+	if (string)
+		gsb_data_transaction_set_bank_references (transaction_number, string);
+
+	gsb_data_transaction_set_contra_transaction_number (transaction_number,
+														record->contra_transaction_number);
+	gsb_data_transaction_set_mother_transaction_number (transaction_number,
+														record->mother_transaction_number);
+}
+
+/**
+ * load the transactions of the cache which are not archived
+ *
+ * \param cache
+ *
+ * \return
+ **/
+static void gsb_file_cache_load_transactions (GsbFileCache *cache)
+{
+	guint32 i;
+
+	for (i = 0 ; i < cache->header->nb_transactions ; i++)
+		gsb_file_cache_load_transaction (&cache->transactions[i], cache->strings, cache->header->strings_size);
+}
+
+/**
+ * load the payees of the cache, as gsb_file_load_party_part does
+ *
+ * \param cache
+ *
+ * \return
+ **/
+static void gsb_file_cache_load_payees (GsbFileCache *cache)
+{
+	guint32 i;
+
+	for (i = 0 ; i < cache->header->nb_payees ; i++)
+	{
+		const GsbFileCachePayee *record;
+		const gchar *string;
+		gint payee_number;
+
+		record = &cache->payees[i];
+
+		payee_number = gsb_data_payee_new (NULL);
+		payee_number = gsb_data_payee_set_new_number (payee_number, record->payee_number);
+		string = gsb_file_cache_get_string (cache->strings, cache->header->strings_size, record->name);
+		if (string)
+			gsb_data_payee_set_name (payee_number, string);
+
+		string = gsb_file_cache_get_string (cache->strings, cache->header->strings_size, record->description);
+		if (string)
+			gsb_data_payee_set_description (payee_number, string);
+
+		string = gsb_file_cache_get_string (cache->strings, cache->header->strings_size, record->search_string);
+		if (string)
+		{
+			struct ImportPayeeAsso *assoc;
+
+			gsb_data_payee_set_search_string (payee_number, string);
+			gsb_data_payee_set_ignore_case (payee_number, record->ignore_case);
+			gsb_data_payee_set_use_regex (payee_number, record->use_regex);
+
+			assoc = g_malloc (sizeof (struct ImportPayeeAsso));
+			assoc->payee_number = payee_number;
+			assoc->search_str = g_strdup (string);
+			assoc->ignore_case = record->ignore_case;
+			assoc->use_regex = record->use_regex;
+			gsb_import_associations_list_append_assoc (payee_number, assoc);
+		}
+	}
+}
+
+/**
+ * load the categories of the cache, as gsb_file_load_category_part
+ * and gsb_file_load_sub_category_part do
+ *
+ * \param cache
+ *
+ * \return
+ **/
+static void gsb_file_cache_load_categories (GsbFileCache *cache)
+{
+	guint32 i;
+	gint new_category_number = 0;
+
+	for (i = 0 ; i < cache->header->nb_categories ; i++)
+	{
+		const GsbFileCacheDivision *record;
+		const gchar *name;
+
+		record = &cache->categories[i];
+		name = gsb_file_cache_get_string (cache->strings, cache->header->strings_size, record->name);
+
+		if (record->div_number == 0)
+			new_category_number = gsb_data_category_test_create_category (record->number,
+																		  name,
+																		  record->type);
+		/* the sub-categories without name are not loaded from the grisbi file */
+		else if (name)
+			gsb_data_category_test_create_sub_category (new_category_number, record->number, name);
+	}
+}
+
+/**
+ * load the budgets of the cache, as gsb_file_load_budgetary_part
+ * and gsb_file_load_sub_budgetary_part do
+ *
+ * \param cache
+ *
+ * \return
+ **/
+static void gsb_file_cache_load_budgets (GsbFileCache *cache)
+{
+	guint32 i;
+	gint new_budget_number = 0;
+
+	for (i = 0 ; i < cache->header->nb_budgets ; i++)
+	{
+		const GsbFileCacheDivision *record;
+		const gchar *name;
+
+		record = &cache->budgets[i];
+		name = gsb_file_cache_get_string (cache->strings, cache->header->strings_size, record->name);
+
+		if (record->div_number == 0)
+			new_budget_number = gsb_data_budget_test_create_budget (record->number,
+																	name,
+																	record->type);
+		/* the sub-budgets without name are not loaded from the grisbi file */
+		else if (name)
+			gsb_data_budget_test_create_sub_budget (new_budget_number, record->number, name);
+	}
+}
+
+/**
+ * check that the segments of a cache are in the compressed segments
+ * and that they follow each other in the numbers of the archived transactions
+ *
+ * \param segments
+ * \param nb_segments
+ * \param segments_size the size of the compressed segments
+ * \param nb_numbers a pointer to fill with the number of archived transactions
+ *
+ * \return TRUE if the segments are right
+ **/
+static gboolean gsb_file_cache_check_segments (const GsbFileCacheSegment *segments,
+											   guint32 nb_segments,
+											   guint64 segments_size,
+											   guint64 *nb_numbers)
+{
+	guint32 i;
+
+	*nb_numbers = 0;
+	for (i = 0 ; i < nb_segments ; i++)
+	{
+		const GsbFileCacheSegment *segment;
+
+		segment = &segments[i];
+		if (segment->offset > segments_size
+			|| segment->compressed_size > segments_size - segment->offset
+			|| segment->numbers_index != *nb_numbers
+			|| segment->size <= (guint64) segment->nb_transactions * sizeof (GsbFileCacheTransaction))
+			return FALSE;
+
+		*nb_numbers += segment->nb_transactions;
+	}
+
+	return TRUE;
+}
+
+/**
+ * uncompress a segment of the archives not loaded
+ *
+ * \param segments_data the compressed segments of the cache
+ * \param segment
+ *
+ * \return the transactions then the strings of the segment, to free, NULL if problem
+ **/
+static gchar *gsb_file_cache_uncompress_segment (const guint8 *segments_data,
+												 const GsbFileCacheSegment *segment)
+{
+	gchar *data;
+	uLongf size;
+
+	data = g_malloc (segment->size);
+	size = segment->size;
+
+	if (uncompress ((Bytef *) data,
+					&size,
+					segments_data + segment->offset,
+					segment->compressed_size) != Z_OK
+		|| size != segment->size
+		|| data[size - 1] != '\0')
+	{
+		g_critical ("cannot uncompress the archive %d of the cache", segment->archive_number);
+		g_free (data);
+
+		return NULL;
+	}
+
+	return data;
+}
+
+/**
+ * remove a segment, its summaries and its totals from the archives not loaded,
+ * the cache is released when there is no more archive to load
+ *
+ * \param segment
+ *
+ * \return
+ **/
+static void gsb_file_cache_forget_segment (const GsbFileCacheSegment *segment)
+{
+	GSList *tmp_list;
+
+	pending_archives->segments = g_slist_remove (pending_archives->segments, segment);
+
+	tmp_list = pending_archives->summaries;
+	while (tmp_list)
+	{
+		const GsbFileCacheSummary *summary;
+
+		summary = tmp_list->data;
+		tmp_list = tmp_list->next;
+
+		if (summary->archive_number == segment->archive_number)
+			pending_archives->summaries = g_slist_remove (pending_archives->summaries, summary);
+	}
+
+	tmp_list = pending_archives->totals;
+	while (tmp_list)
+	{
+		const GsbFileCacheTotal *total;
+
+		total = tmp_list->data;
+		tmp_list = tmp_list->next;
+
+		if (total->archive_number == segment->archive_number)
+			pending_archives->totals = g_slist_remove (pending_archives->totals, total);
+	}
+
+	if (!pending_archives->segments)
+		gsb_file_cache_forget_archives ();
+}
+
+/**
+ * fill a summary of an archive from the summary kept in the cache
+ *
+ * \param record
+ * \param summary
+ *
+ * \return
+ **/
+static void gsb_file_cache_get_summary (const GsbFileCacheSummary *record,
+										GsbFileCacheArchiveSummary *summary)
+{
+	summary->archive_number = record->archive_number;
+	summary->account_number = record->account_number;
+	summary->balance = gsb_real_new (record->balance, record->balance_exponent);
+	summary->marked_balance = gsb_real_new (record->marked_balance, record->marked_balance_exponent);
+	summary->waiting_marked_balance = gsb_real_new (record->waiting_marked_balance,
+													record->waiting_marked_balance_exponent);
+	summary->nb_transactions = record->nb_transactions;
+	summary->nb_pointed = record->nb_pointed;
+	summary->nb_converted = record->nb_converted;
+	summary->first_julian = record->first_julian;
+	summary->last_julian = record->last_julian;
+}
+
+/**
+ * fill a total of an archive from the total kept in the cache
+ *
+ * \param record
+ * \param total
+ *
+ * \return
+ **/
+static void gsb_file_cache_get_total (const GsbFileCacheTotal *record,
+									  GsbFileCacheArchiveTotal *total)
+{
+	total->archive_number = record->archive_number;
+	total->type = record->type;
+	total->div_number = record->div_number;
+	total->sub_div_number = record->sub_div_number;
+	total->currency_number = record->currency_number;
+	total->amount = gsb_real_new (record->amount, record->amount_exponent);
+	total->nb_transactions = record->nb_transactions;
+	total->nb_counted = record->nb_counted;
+}
+
+/**
+ * add an archive to a list of archives to load, if it is not in the list
+ *
+ * \param archive_numbers
+ * \param archive_number
+ *
+ * \return the new list
+ **/
+static GSList *gsb_file_cache_add_archive_number (GSList *archive_numbers,
+												  gint archive_number)
+{
+	if (g_slist_find (archive_numbers, GINT_TO_POINTER (archive_number)))
+		return archive_numbers;
+
+	return g_slist_prepend (archive_numbers, GINT_TO_POINTER (archive_number));
+}
+
+/**
+ * load some archives kept in the cache
+ *
+ * \param archive_numbers the list of the archives to load, freed here
+ *
+ * \return TRUE if an archive is loaded
+ **/
+static gboolean gsb_file_cache_load_archives (GSList *archive_numbers)
+{
+	GSList *tmp_list;
+	gboolean loaded;
+
+	loaded = archive_numbers && !archives_locked;
+	for (tmp_list = archive_numbers; tmp_list; tmp_list = tmp_list->next)
+		gsb_file_cache_load_archive (GPOINTER_TO_INT (tmp_list->data));
+	g_slist_free (archive_numbers);
+
+	return loaded;
+}
+
+/**
+ * write an archived transaction of the cache in the grisbi file,
+ * as gsb_file_save_transaction_part does
+ *
+ * \param writer
+ * \param record
+ * \param strings the strings of the record
+ * \param strings_size
+ * \param archive_number the archive number to write
+ * \param floating_point the floating point of the currency of the transaction
+ * \param floating_fees the floating point of the currency of the account
+ *
+ * \return
+ **/
+static void gsb_file_cache_save_transaction_record (GsbFileSaveWriter *writer,
+													const GsbFileCacheTransaction *record,
+													const gchar *strings,
+													guint32 strings_size,
+													gint archive_number,
+													gint floating_point,
+													gint floating_fees)
+{
+	GDate tmp_date;
+	gchar amount[GSB_REAL_SAFE_STRING_SIZE];
+	gchar exchange_rate[GSB_REAL_SAFE_STRING_SIZE];
+	gchar exchange_fees[GSB_REAL_SAFE_STRING_SIZE];
+	gchar date[SIZEOF_FORMATTED_STRING_DATE_SAFE];
+	gchar value_date[SIZEOF_FORMATTED_STRING_DATE_SAFE];
+
+	/* the strings are formatted in buffers on the stack, without allocation */
+	gsb_real_safe_real_to_buffer (gsb_real_new (record->amount, record->amount_exponent),
+								  floating_point,
+								  amount);
+	gsb_real_safe_real_to_buffer (gsb_real_new (record->exchange_rate, record->exchange_rate_exponent),
+								  -1,
+								  exchange_rate);
+	gsb_real_safe_real_to_buffer (gsb_real_new (record->exchange_fees, record->exchange_fees_exponent),
+								  floating_fees,
+								  exchange_fees);
+
+	date[0] = 0;
+	value_date[0] = 0;
+	g_date_clear (&tmp_date, 1);
+	if (record->date)
+	{
+		g_date_set_julian (&tmp_date, record->date);
+		gsb_format_gdate_safe_to_buffer (&tmp_date, date);
+	}
+	if (record->value_date)
+	{
+		g_date_set_julian (&tmp_date, record->value_date);
+		gsb_format_gdate_safe_to_buffer (&tmp_date, value_date);
+	}
+
+	gsb_file_save_writer_printf (writer, "\t<Transaction Ac=\"%d\" Nb=\"%d\" Id=\"%s\" Dt=\"%s\" "
+										  "Dv=\"%s\" Cu=\"%d\" Am=\"%s\" Exb=\"%d\" Exr=\"%s\" Exf=\"%s\" "
+										  "Pa=\"%d\" Ca=\"%d\" Sca=\"%d\" Br=\"%d\" No=\"%s\" Pn=\"%d\" "
+										  "Pc=\"%s\" Ma=\"%d\" Ar=\"%d\" Au=\"%d\" Re=\"%d\" Fi=\"%d\" "
+										  "Bu=\"%d\" Sbu=\"%d\" Vo=\"%s\" Ba=\"%s\" Trt=\"%d\" Mo=\"%d\" />\n",
+										  record->account_number,
+										  record->transaction_number,
+										  my_safe_null_str (gsb_file_cache_get_string (strings, strings_size,
+																					   record->transaction_id)),
+										  my_safe_null_str (date),
+										  my_safe_null_str (value_date),
+										  record->currency_number,
+										  my_safe_null_str (amount),
+										  record->change_between,
+										  my_safe_null_str (exchange_rate),
+										  my_safe_null_str (exchange_fees),
+										  record->party_number,
+										  record->category_number,
+										  record->sub_category_number,
+										  record->split_of_transaction,
+										  my_safe_null_str (gsb_file_cache_get_string (strings, strings_size,
+																					   record->notes)),
+										  record->method_of_payment_number,
+										  my_safe_null_str (gsb_file_cache_get_string (strings, strings_size,
+																					   record->method_of_payment_content)),
+										  record->marked_transaction,
+										  archive_number,
+										  record->automatic_transaction,
+										  record->reconcile_number,
+										  record->financial_year_number,
+										  record->budgetary_number,
+										  record->sub_budgetary_number,
+										  my_safe_null_str (gsb_file_cache_get_string (strings, strings_size,
+																					   record->voucher)),
+										  my_safe_null_str (gsb_file_cache_get_string (strings, strings_size,
+																					   record->bank_references)),
+										  record->contra_transaction_number,
+										  record->mother_transaction_number);
+}
+
+/**
+ * return the floating point of a currency or of an account kept in a snapshot
+ *
+ * \param floating_points the floating points + 1 of the snapshot
+ * \param number the number of the currency or of the account
+ *
+ * \return the floating point, -1 if unknown
+ **/
+static gint gsb_file_cache_snapshot_get_floating_point (GHashTable *floating_points,
+														gint number)
+{
+	return GPOINTER_TO_INT (g_hash_table_lookup (floating_points, GINT_TO_POINTER (number))) - 1;
+}
+
+/**
+ * write in the grisbi file the transactions of an archive not loaded
+ *
+ * \param writer the writer of the file
+ * \param segments_data
+ * \param segment the segment of the archive
+ * \param archive_number 0 if the whole file is written, else the number of the archive exported
+ * \param snapshot the snapshot which gives the floating points, NULL to read them in the data
+ *
+ * \return
+ **/
+static void gsb_file_cache_write_segment (GsbFileSaveWriter *writer,
+										  const guint8 *segments_data,
+										  const GsbFileCacheSegment *segment,
+										  gint archive_number,
+										  GsbFileCacheSnapshot *snapshot)
+{
+	const GsbFileCacheTransaction *records;
+	gchar *data;
+	guint32 strings_position;
+	guint32 i;
+
+	data = gsb_file_cache_uncompress_segment (segments_data, segment);
+	if (!data)
+		return;
+
+	/* as in gsb_file_save_transaction_part, the archive number of
+	 * an archive exported is 0, to show the transactions when it is opened */
+	records = (const GsbFileCacheTransaction *) data;
+	strings_position = segment->nb_transactions * sizeof (GsbFileCacheTransaction);
+	for (i = 0 ; i < segment->nb_transactions ; i++)
+	{
+		gint floating_point;
+		gint floating_fees;
+
+		if (snapshot)
+		{
+			floating_point = gsb_file_cache_snapshot_get_floating_point (snapshot->currencies_floating_point,
+																		 records[i].currency_number);
+			floating_fees = gsb_file_cache_snapshot_get_floating_point (snapshot->accounts_floating_point,
+																		records[i].account_number);
+		}
+		else
+		{
+			floating_point = gsb_data_currency_get_floating_point (records[i].currency_number);
+			floating_fees = gsb_data_account_get_currency_floating_point (records[i].account_number);
+		}
+
+		gsb_file_cache_save_transaction_record (writer,
+												&records[i],
+												data + strings_position,
+												segment->size - strings_position,
+												archive_number ? 0 : records[i].archive_number,
+												floating_point,
+												floating_fees);
+	}
+	g_free (data);
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * tell if there are archives of the file kept in the cache and not loaded
+ *
+ * \param
+ *
+ * \return TRUE if some archives are not loaded
+ **/
+gboolean gsb_file_cache_archives_pending (void)
+{
+	return pending_archives != NULL;
+}
+
+/**
+ * find the archive not loaded which contains a transaction
+ *
+ * \param transaction_number
+ *
+ * \return the number of the archive, 0 if the transaction is not in an archive not loaded
+ **/
+gint gsb_file_cache_find_archive_of_transaction (gint transaction_number)
+{
+	GSList *tmp_list;
+
+	if (!pending_archives || transaction_number <= 0)
+		return 0;
+
+	tmp_list = pending_archives->segments;
+	while (tmp_list)
+	{
+		const GsbFileCacheSegment *segment;
+		const gint32 *numbers;
+		guint low;
+		guint high;
+
+		segment = tmp_list->data;
+		tmp_list = tmp_list->next;
+
+		if (transaction_number > segment->last_transaction_number)
+			continue;
+
+		/* the numbers of a segment are sorted */
+		numbers = pending_archives->numbers + segment->numbers_index;
+		low = 0;
+		high = segment->nb_transactions;
+		while (low < high)
+		{
+			guint middle;
+
+			middle = low + (high - low) / 2;
+			if (numbers[middle] < transaction_number)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+
+		if (low < segment->nb_transactions && numbers[low] == transaction_number)
+			return segment->archive_number;
+	}
+
+	return 0;
+}
+
+/**
+ * forget the archives not loaded and release the cache,
+ * to call when the transactions of the file are freed
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_file_cache_forget_archives (void)
+{
+	if (!pending_archives)
+		return;
+
+	g_slist_free (pending_archives->segments);
+	g_slist_free (pending_archives->summaries);
+	g_slist_free (pending_archives->totals);
+	g_mapped_file_unref (pending_archives->mapped_file);
+	g_free (pending_archives);
+	pending_archives = NULL;
+}
+
+/**
+ * free a cache opened by gsb_file_cache_open
+ *
+ * \param cache
+ *
+ * \return
+ **/
+void gsb_file_cache_free (GsbFileCache *cache)
+{
+	if (!cache)
+		return;
+
+	g_mapped_file_unref (cache->mapped_file);
+	g_free (cache);
+}
+
+/**
+ * get the summary of the archives not loaded of an account,
+ * the archive number of the summary is 0
+ *
+ * \param account_number
+ * \param summary the summary to fill
+ *
+ * \return TRUE if the account has transactions in archives not loaded
+ **/
+gboolean gsb_file_cache_get_account_archives_summary (gint account_number,
+													  GsbFileCacheArchiveSummary *summary)
+{
+	GSList *tmp_list;
+	gboolean found = FALSE;
+
+	memset (summary, 0, sizeof (GsbFileCacheArchiveSummary));
+	summary->account_number = account_number;
+	summary->balance = null_real;
+	summary->marked_balance = null_real;
+	summary->waiting_marked_balance = null_real;
+
+	if (!pending_archives)
+		return FALSE;
+
+	tmp_list = pending_archives->summaries;
+	while (tmp_list)
+	{
+		GsbFileCacheArchiveSummary archive_summary;
+
+		if (((const GsbFileCacheSummary *) tmp_list->data)->account_number != account_number)
+		{
+			tmp_list = tmp_list->next;
+			continue;
+		}
+
+		gsb_file_cache_get_summary (tmp_list->data, &archive_summary);
+		summary->balance = gsb_real_add (summary->balance, archive_summary.balance);
+		summary->marked_balance = gsb_real_add (summary->marked_balance, archive_summary.marked_balance);
+		summary->waiting_marked_balance = gsb_real_add (summary->waiting_marked_balance,
+														archive_summary.waiting_marked_balance);
+		summary->nb_transactions += archive_summary.nb_transactions;
+		summary->nb_pointed += archive_summary.nb_pointed;
+		summary->nb_converted += archive_summary.nb_converted;
+
+		if (!found || archive_summary.first_julian < summary->first_julian)
+			summary->first_julian = archive_summary.first_julian;
+		summary->last_julian = MAX (summary->last_julian, archive_summary.last_julian);
+		found = TRUE;
+
+		tmp_list = tmp_list->next;
+	}
+
+	return found;
+}
+
+/**
+ * get the greatest number of the transactions in the archives not loaded
+ *
+ * \param
+ *
+ * \return the number, 0 if no archive is waiting to be loaded
+ **/
+gint gsb_file_cache_get_archives_last_number (void)
+{
+	GSList *tmp_list;
+	gint last_number = 0;
+
+	if (!pending_archives)
+		return 0;
+
+	tmp_list = pending_archives->segments;
+	while (tmp_list)
+	{
+		const GsbFileCacheSegment *segment;
+
+		segment = tmp_list->data;
+		if (segment->last_transaction_number > last_number)
+			last_number = segment->last_transaction_number;
+
+		tmp_list = tmp_list->next;
+	}
+
+	return last_number;
+}
+
+/**
+ * get the summaries of the archives not loaded, one by archive and by account
+ *
+ * \param
+ *
+ * \return a list of GsbFileCacheArchiveSummary, to free with g_slist_free_full (list, g_free)
+ **/
+GSList *gsb_file_cache_get_archives_summaries (void)
+{
+	GSList *summaries = NULL;
+	GSList *tmp_list;
+
+	if (!pending_archives)
+		return NULL;
+
+	tmp_list = pending_archives->summaries;
+	while (tmp_list)
+	{
+		GsbFileCacheArchiveSummary *summary;
+
+		summary = g_malloc0 (sizeof (GsbFileCacheArchiveSummary));
+		gsb_file_cache_get_summary (tmp_list->data, summary);
+		summaries = g_slist_prepend (summaries, summary);
+
+		tmp_list = tmp_list->next;
+	}
+
+	return g_slist_reverse (summaries);
+}
+
+/**
+ * get the totals of the archives not loaded for the payees, the categories
+ * or the budgets, one by archive, by division and by currency of the transactions.
+ * the archives which have counted transactions in another currency are loaded
+ * before, their amounts are converted transaction by transaction
+ *
+ * \param type METATREE_PAYEE, METATREE_CATEGORY or METATREE_BUDGET
+ * \param currency_number the currency of the amounts, 0 if the amounts are not used
+ *
+ * \return a list of GsbFileCacheArchiveTotal, to free with g_slist_free_full (list, g_free)
+ **/
+GSList *gsb_file_cache_get_archives_totals (gint type,
+											gint currency_number)
+{
+	GSList *totals = NULL;
+	GSList *tmp_list;
+
+	if (!pending_archives)
+		return NULL;
+
+	if (currency_number)
+	{
+		GSList *archive_numbers = NULL;
+
+		for (tmp_list = pending_archives->totals; tmp_list; tmp_list = tmp_list->next)
+		{
+			const GsbFileCacheTotal *record;
+
+			record = tmp_list->data;
+			if (record->type == type && record->nb_counted && record->currency_number != currency_number)
+				archive_numbers = gsb_file_cache_add_archive_number (archive_numbers, record->archive_number);
+		}
+		gsb_file_cache_load_archives (archive_numbers);
+
+		if (!pending_archives)
+			return NULL;
+	}
+
+	for (tmp_list = pending_archives->totals; tmp_list; tmp_list = tmp_list->next)
+	{
+		GsbFileCacheArchiveTotal *total;
+
+		if (((const GsbFileCacheTotal *) tmp_list->data)->type != type)
+			continue;
+
+		total = g_malloc0 (sizeof (GsbFileCacheArchiveTotal));
+		gsb_file_cache_get_total (tmp_list->data, total);
+		totals = g_slist_prepend (totals, total);
+	}
+
+	return g_slist_reverse (totals);
+}
+
+/**
+ * get the position of the parts of the grisbi file which are in the cache,
+ * that parts are not parsed when the file is loaded
+ *
+ * \param cache
+ * \param position the structure to fill
+ *
+ * \return
+ **/
+void gsb_file_cache_get_parts_position (GsbFileCache *cache,
+										GsbFileSavePartsPosition *position)
+{
+	position->transactions_begin = cache->header->transactions_begin;
+	position->transactions_end = cache->header->transactions_end;
+	position->divisions_begin = cache->header->divisions_begin;
+	position->divisions_end = cache->header->divisions_end;
+}
+
+/**
+ * load the transactions, payees, categories and budgets of the cache,
+ * to call after the rest of the grisbi file is loaded
+ *
+ * \param cache
+ *
+ * \return
+ **/
+void gsb_file_cache_load (GsbFileCache *cache)
+{
+	guint32 i;
+
+	devel_debug_int (cache->header->nb_transactions);
+
+	gsb_file_cache_load_transactions (cache);
+	gsb_file_cache_load_payees (cache);
+	gsb_file_cache_load_categories (cache);
+	gsb_file_cache_load_budgets (cache);
+
+	/* the archives are loaded when they are needed, the cache stays mapped for them */
+	gsb_file_cache_forget_archives ();
+	if (!cache->header->nb_segments)
+		return;
+
+	pending_archives = g_malloc0 (sizeof (GsbFileCacheArchives));
+	pending_archives->mapped_file = g_mapped_file_ref (cache->mapped_file);
+	pending_archives->numbers = cache->numbers;
+	pending_archives->segments_data = cache->segments_data;
+
+	for (i = cache->header->nb_segments ; i > 0 ; i--)
+		pending_archives->segments = g_slist_prepend (pending_archives->segments,
+													  (gpointer) &cache->segments[i - 1]);
+	for (i = cache->header->nb_summaries ; i > 0 ; i--)
+		pending_archives->summaries = g_slist_prepend (pending_archives->summaries,
+													   (gpointer) &cache->summaries[i - 1]);
+	for (i = cache->header->nb_totals ; i > 0 ; i--)
+		pending_archives->totals = g_slist_prepend (pending_archives->totals,
+													(gpointer) &cache->totals[i - 1]);
+}
+
+/**
+ * load the archives kept in the cache which have transactions of an account
+ * with a date or a value date at or after a day
+ *
+ * \param account_number
+ * \param julian the julian day, 0 to load all the archives of the account
+ *
+ * \return
+ **/
+void gsb_file_cache_load_account_archives (gint account_number,
+										   guint32 julian)
+{
+	GSList *archive_numbers = NULL;
+	GSList *tmp_list;
+
+	if (!pending_archives)
+		return;
+
+	for (tmp_list = pending_archives->summaries; tmp_list; tmp_list = tmp_list->next)
+	{
+		const GsbFileCacheSummary *record;
+
+		record = tmp_list->data;
+		if (record->account_number == account_number && record->last_julian >= julian)
+			archive_numbers = gsb_file_cache_add_archive_number (archive_numbers, record->archive_number);
+	}
+	gsb_file_cache_load_archives (archive_numbers);
+}
+
+/**
+ * load the transactions of an archive kept in the cache,
+ * nothing is done if the archive is already loaded
+ *
+ * \param archive_number the archive to load, 0 to load all the archives
+ *
+ * \return
+ **/
+void gsb_file_cache_load_archive (gint archive_number)
+{
+	GMappedFile *mapped_file;
+	const guint8 *segments_data;
+	GSList *segments = NULL;
+	GSList *tmp_list;
+	gint64 trace_start;
+	guint32 nb_transactions = 0;
+
+	if (!pending_archives || archives_locked)
+		return;
+
+	devel_debug_int (archive_number);
+	trace_start = gsb_trace_begin ();
+
+	/* the segments are removed from the archives not loaded before they are loaded,
+	 * because the creation of the transactions can ask for the complete list of transactions */
+	mapped_file = g_mapped_file_ref (pending_archives->mapped_file);
+	segments_data = pending_archives->segments_data;
+
+	tmp_list = pending_archives->segments;
+	while (tmp_list)
+	{
+		const GsbFileCacheSegment *segment;
+
+		segment = tmp_list->data;
+		tmp_list = tmp_list->next;
+
+		if (archive_number && segment->archive_number != archive_number)
+			continue;
+
+		segments = g_slist_append (segments, (gpointer) segment);
+		gsb_file_cache_forget_segment (segment);
+	}
+
+	/* the totals of these archives are in the counters of the metatrees,
+	 * they are computed again without them */
+	if (segments)
+	{
+		gsb_data_payee_invalidate_counters ();
+		gsb_data_category_invalidate_counters ();
+		gsb_data_budget_invalidate_counters ();
+	}
+
+	tmp_list = segments;
+	while (tmp_list)
+	{
+		const GsbFileCacheSegment *segment;
+		const GsbFileCacheTransaction *records;
+		gchar *data;
+		guint32 strings_position;
+		guint32 i;
+
+		segment = tmp_list->data;
+		tmp_list = tmp_list->next;
+
+		data = gsb_file_cache_uncompress_segment (segments_data, segment);
+		if (!data)
+			continue;
+
+		records = (const GsbFileCacheTransaction *) data;
+		strings_position = segment->nb_transactions * sizeof (GsbFileCacheTransaction);
+		for (i = 0 ; i < segment->nb_transactions ; i++)
+			gsb_file_cache_load_transaction (&records[i],
+											 data + strings_position,
+											 segment->size - strings_position);
+		nb_transactions += segment->nb_transactions;
+		g_free (data);
+	}
+
+	/* the summaries of these archives are no more in the balances of the accounts */
+	if (segments)
+		gsb_data_account_set_all_balances_are_dirty ();
+
+	g_slist_free (segments);
+	g_mapped_file_unref (mapped_file);
+
+	gsb_trace_count ("archives_transactions", nb_transactions);
+	gsb_trace_end ("archives_load", trace_start);
+}
+
+/**
+ * load the archives kept in the cache whose summaries have amounts converted
+ * from another currency, to call when the exchange rates change
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_file_cache_load_converted_archives (void)
+{
+	GSList *archive_numbers = NULL;
+	GSList *tmp_list;
+
+	if (!pending_archives)
+		return;
+
+	for (tmp_list = pending_archives->summaries; tmp_list; tmp_list = tmp_list->next)
+	{
+		const GsbFileCacheSummary *record;
+
+		record = tmp_list->data;
+		if (record->nb_converted)
+			archive_numbers = gsb_file_cache_add_archive_number (archive_numbers, record->archive_number);
+	}
+	gsb_file_cache_load_archives (archive_numbers);
+}
+
+/**
+ * load the archives kept in the cache which have transactions
+ * of a payee, a category or a budget
+ *
+ * \param type METATREE_PAYEE, METATREE_CATEGORY or METATREE_BUDGET
+ * \param div_number
+ * \param sub_div_number -1 for all the sub-divisions of the division
+ *
+ * \return TRUE if an archive is loaded
+ **/
+gboolean gsb_file_cache_load_division_archives (gint type,
+												gint div_number,
+												gint sub_div_number)
+{
+	GSList *archive_numbers = NULL;
+	GSList *tmp_list;
+
+	if (!pending_archives)
+		return FALSE;
+
+	for (tmp_list = pending_archives->totals; tmp_list; tmp_list = tmp_list->next)
+	{
+		const GsbFileCacheTotal *record;
+
+		record = tmp_list->data;
+		if (record->type == type
+			&& record->div_number == div_number
+			&& (sub_div_number < 0 || record->sub_div_number == sub_div_number))
+			archive_numbers = gsb_file_cache_add_archive_number (archive_numbers, record->archive_number);
+	}
+
+	return gsb_file_cache_load_archives (archive_numbers);
+}
+
+/**
+ * open the cache of a grisbi file if it can be used,
+ * the cache must be made by this version of grisbi on this computer
+ * and for the grisbi file as it is now on the disk
+ *
+ * \param filename the name of the grisbi file
+ *
+ * \return the cache to free with gsb_file_cache_free, NULL if there is
+ * no cache which can be used
+ **/
+GsbFileCache *gsb_file_cache_open (const gchar *filename)
+{
+	GsbFileCache *cache;
+	GMappedFile *mapped_file;
+	const GsbFileCacheHeader *header;
+	const gchar *content;
+	gchar *cache_filename;
+	guint8 xml_checksum[GSB_FILE_CACHE_CHECKSUM_SIZE];
+	guint64 xml_size;
+	guint64 length;
+	guint64 tables_size;
+	guint64 archives_size;
+	guint64 nb_numbers;
+
+	cache_filename = gsb_file_cache_get_filename (filename);
+	if (!g_file_test (cache_filename, G_FILE_TEST_EXISTS))
+	{
+		g_free (cache_filename);
+		return NULL;
+	}
+
+	mapped_file = g_mapped_file_new (cache_filename, FALSE, NULL);
+	g_free (cache_filename);
+	if (!mapped_file)
+		return NULL;
+
+	content = g_mapped_file_get_contents (mapped_file);
+	length = g_mapped_file_get_length (mapped_file);
+	header = (const GsbFileCacheHeader *) content;
+
+	/* check the cache itself */
+	if (length < sizeof (GsbFileCacheHeader)
+		|| memcmp (header->magic, GSB_FILE_CACHE_MAGIC, sizeof (header->magic))
+		|| header->version != GSB_FILE_CACHE_VERSION
+		|| header->byte_order != GSB_FILE_CACHE_BYTE_ORDER)
+	{
+		devel_debug ("cache of the file not used: bad header");
+		g_mapped_file_unref (mapped_file);
+
+		return NULL;
+	}
+
+	tables_size = (guint64) header->nb_transactions * sizeof (GsbFileCacheTransaction)
+		+ (guint64) header->nb_payees * sizeof (GsbFileCachePayee)
+		+ ((guint64) header->nb_categories + header->nb_budgets) * sizeof (GsbFileCacheDivision);
+	archives_size = (guint64) header->nb_segments * sizeof (GsbFileCacheSegment)
+		+ (guint64) header->nb_summaries * sizeof (GsbFileCacheSummary)
+		+ (guint64) header->nb_totals * sizeof (GsbFileCacheTotal);
+
+	/* the segments give the number of archived transactions */
+	if (length < sizeof (GsbFileCacheHeader) + tables_size + archives_size
+		|| !gsb_file_cache_check_segments ((const GsbFileCacheSegment *) (content
+																		  + sizeof (GsbFileCacheHeader)
+																		  + tables_size),
+										   header->nb_segments,
+										   header->segments_size,
+										   &nb_numbers))
+	{
+		devel_debug ("cache of the file not used: damaged cache");
+		g_mapped_file_unref (mapped_file);
+
+		return NULL;
+	}
+	archives_size += nb_numbers * sizeof (gint32) + header->segments_size;
+
+	if (length != sizeof (GsbFileCacheHeader) + tables_size + archives_size + header->strings_size
+		|| header->strings_size == 0
+		|| content[length - 1] != '\0'
+		|| header->data_crc != crc32 (0L,
+									  (const Bytef *) content + sizeof (GsbFileCacheHeader),
+									  (uInt) (length - sizeof (GsbFileCacheHeader))))
+	{
+		devel_debug ("cache of the file not used: damaged cache");
+		g_mapped_file_unref (mapped_file);
+
+		return NULL;
+	}
+
+	/* check that the cache is made for the grisbi file : the size, the modification
+	 * time or some bytes can stay the same when the file is changed by another
+	 * program, so all the file is hashed, which is still faster than parsing it */
+	if (!gsb_file_cache_get_xml_checksum (filename, xml_checksum, &xml_size)
+		|| xml_size != header->xml_size
+		|| memcmp (xml_checksum, header->xml_checksum, GSB_FILE_CACHE_CHECKSUM_SIZE))
+	{
+		devel_debug ("cache of the file not used: the file has changed");
+		g_mapped_file_unref (mapped_file);
+
+		return NULL;
+	}
+
+	cache = g_malloc0 (sizeof (GsbFileCache));
+	cache->mapped_file = mapped_file;
+	cache->header = header;
+	cache->transactions = (const GsbFileCacheTransaction *) (content + sizeof (GsbFileCacheHeader));
+	cache->payees = (const GsbFileCachePayee *) (cache->transactions + header->nb_transactions);
+	cache->categories = (const GsbFileCacheDivision *) (cache->payees + header->nb_payees);
+	cache->budgets = cache->categories + header->nb_categories;
+	cache->segments = (const GsbFileCacheSegment *) (cache->budgets + header->nb_budgets);
+	cache->summaries = (const GsbFileCacheSummary *) (cache->segments + header->nb_segments);
+	cache->totals = (const GsbFileCacheTotal *) (cache->summaries + header->nb_summaries);
+	cache->numbers = (const gint32 *) (cache->totals + header->nb_totals);
+	cache->segments_data = (const guint8 *) (cache->numbers + nb_numbers);
+	cache->strings = (const gchar *) (cache->segments_data + header->segments_size);
+
+	return cache;
+}
+
+/**
+ * remove the cache of a grisbi file if there is one
+ *
+ * \param filename the name of the grisbi file
+ *
+ * \return
+ **/
+void gsb_file_cache_remove (const gchar *filename)
+{
+	gchar *cache_filename;
+
+	cache_filename = gsb_file_cache_get_filename (filename);
+	if (g_file_test (cache_filename, G_FILE_TEST_EXISTS))
+		g_unlink (cache_filename);
+	g_free (cache_filename);
+}
+
+/**
+ * write the cache of the grisbi file, to call just after the file
+ * is saved and while the data are the data saved in the file.
+ * there is no cache for the crypted files.
+ *
+ * \param filename the name of the grisbi file
+ * \param parts_position the position of the parts in the file, given by the save of the file
+ *
+ * \return TRUE if the cache is written
+ **/
+gboolean gsb_file_cache_save (const gchar *filename,
+							  const GsbFileSavePartsPosition *parts_position)
+{
+	GsbFileCacheHeader header;
+	GByteArray *content;
+	GByteArray *strings;
+	GByteArray *segments;
+	GByteArray *summaries;
+	GByteArray *totals;
+	GByteArray *numbers;
+	GByteArray *segments_data;
+	GHashTable *archived;
+	gchar *cache_filename;
+	gboolean result;
+	GrisbiWinEtat *w_etat;
+
+	devel_debug (filename);
+	w_etat = (GrisbiWinEtat *) grisbi_win_get_w_etat ();
+
+	/* the cache would contain the data of the crypted file */
+	if (w_etat->crypt_file || !parts_position || !parts_position->transactions_end)
+	{
+		gsb_file_cache_remove (filename);
+		return FALSE;
+	}
+
+	memset (&header, 0, sizeof (GsbFileCacheHeader));
+	memcpy (header.magic, GSB_FILE_CACHE_MAGIC, sizeof (header.magic));
+	header.version = GSB_FILE_CACHE_VERSION;
+	header.byte_order = GSB_FILE_CACHE_BYTE_ORDER;
+	header.transactions_begin = parts_position->transactions_begin;
+	header.transactions_end = parts_position->transactions_end;
+	header.divisions_begin = parts_position->divisions_begin;
+	header.divisions_end = parts_position->divisions_end;
+
+	if (!gsb_file_cache_get_xml_checksum (filename, header.xml_checksum, &header.xml_size))
+	{
+		gsb_file_cache_remove (filename);
+		return FALSE;
+	}
+
+	/* the totals of the archives ask for the transfers, which must not load an archive
+	 * while the archived transactions are written */
+	archives_locked = TRUE;
+
+	/* the header is written at the end, when the tables are done */
+	content = g_byte_array_sized_new (sizeof (GsbFileCacheHeader)
+									  + g_slist_length (gsb_data_transaction_get_transactions_list ())
+									  * sizeof (GsbFileCacheTransaction));
+	g_byte_array_set_size (content, sizeof (GsbFileCacheHeader));
+
+	/* the offset 0 of the strings is the NULL string */
+	strings = g_byte_array_new ();
+	g_byte_array_append (strings, (const guint8 *) "", 1);
+
+	archived = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) g_array_unref);
+	header.nb_transactions = gsb_file_cache_save_transactions (content, strings, archived);
+	header.nb_payees = gsb_file_cache_save_payees (content, strings);
+	header.nb_categories = gsb_file_cache_save_categories (content, strings);
+	header.nb_budgets = gsb_file_cache_save_budgets (content, strings);
+	header.strings_size = strings->len;
+
+	segments = g_byte_array_new ();
+	summaries = g_byte_array_new ();
+	totals = g_byte_array_new ();
+	numbers = g_byte_array_new ();
+	segments_data = g_byte_array_new ();
+	result = gsb_file_cache_save_segments (archived, segments, summaries, totals, numbers, segments_data);
+	g_hash_table_destroy (archived);
+	archives_locked = FALSE;
+
+	header.nb_segments = segments->len / sizeof (GsbFileCacheSegment);
+	header.nb_summaries = summaries->len / sizeof (GsbFileCacheSummary);
+	header.nb_totals = totals->len / sizeof (GsbFileCacheTotal);
+	header.segments_size = segments_data->len;
+
+	g_byte_array_append (content, segments->data, segments->len);
+	g_byte_array_append (content, summaries->data, summaries->len);
+	g_byte_array_append (content, totals->data, totals->len);
+	g_byte_array_append (content, numbers->data, numbers->len);
+	g_byte_array_append (content, segments_data->data, segments_data->len);
+	g_byte_array_append (content, strings->data, strings->len);
+	g_byte_array_free (segments, TRUE);
+	g_byte_array_free (summaries, TRUE);
+	g_byte_array_free (totals, TRUE);
+	g_byte_array_free (numbers, TRUE);
+	g_byte_array_free (segments_data, TRUE);
+	g_byte_array_free (strings, TRUE);
+
+	if (!result)
+	{
+		g_byte_array_free (content, TRUE);
+		gsb_file_cache_remove (filename);
+
+		return FALSE;
+	}
+
+	header.data_crc = crc32 (0L,
+							 content->data + sizeof (GsbFileCacheHeader),
+							 content->len - sizeof (GsbFileCacheHeader));
+	memcpy (content->data, &header, sizeof (GsbFileCacheHeader));
+
+	cache_filename = gsb_file_cache_get_filename (filename);
+	result = gsb_file_cache_write_file (cache_filename, content->data, content->len);
+	if (!result)
+		g_unlink (cache_filename);
+
+	g_free (cache_filename);
+	g_byte_array_free (content, TRUE);
+
+	return result;
+}
+
+/**
+ * write in the grisbi file the transactions of the archives not loaded,
+ * as gsb_file_save_transaction_part does, without loading them
+ *
+ * \param writer the writer of the file
+ * \param archive_number 0 to write all the archives not loaded, the number
+ * of archive to export only that transactions
+ *
+ * \return
+ **/
+void gsb_file_cache_save_archives_part (GsbFileSaveWriter *writer,
+										gint archive_number)
+{
+	GSList *tmp_list;
+
+	if (!pending_archives)
+		return;
+
+	tmp_list = pending_archives->segments;
+	while (tmp_list)
+	{
+		const GsbFileCacheSegment *segment;
+
+		segment = tmp_list->data;
+		tmp_list = tmp_list->next;
+
+		if (archive_number && segment->archive_number != archive_number)
+			continue;
+
+		gsb_file_cache_write_segment (writer, pending_archives->segments_data, segment, archive_number, NULL);
+	}
+}
+
+/**
+ * free a snapshot of the transactions
+ *
+ * \param snapshot
+ *
+ * \return
+ **/
+void gsb_file_cache_snapshot_free (GsbFileCacheSnapshot *snapshot)
+{
+	g_array_free (snapshot->records, TRUE);
+	g_byte_array_free (snapshot->strings, TRUE);
+	if (snapshot->mapped_file)
+		g_mapped_file_unref (snapshot->mapped_file);
+	g_slist_free (snapshot->segments);
+	g_hash_table_destroy (snapshot->currencies_floating_point);
+	g_hash_table_destroy (snapshot->accounts_floating_point);
+	g_free (snapshot);
+}
+
+/**
+ * copy the transactions of the file to write them later in a thread,
+ * they are copied as they are written in the file, the archives not loaded
+ * stay in the cache which is kept mapped until the snapshot is freed
+ *
+ * \param
+ *
+ * \return a new snapshot, to free with gsb_file_cache_snapshot_free ()
+ **/
+GsbFileCacheSnapshot *gsb_file_cache_snapshot_new (void)
+{
+	GsbFileCacheSnapshot *snapshot;
+	GSList *tmp_list;
+
+	snapshot = g_malloc0 (sizeof (GsbFileCacheSnapshot));
+	snapshot->records = g_array_new (FALSE, FALSE, sizeof (GsbFileCacheTransaction));
+	snapshot->strings = g_byte_array_new ();
+
+	/* the offset 0 of the strings is the NULL string */
+	g_byte_array_append (snapshot->strings, (const guint8 *) "", 1);
+
+	tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
+	while (tmp_list)
+	{
+		GsbFileCacheTransaction record;
+
+		gsb_file_cache_make_transaction_record (gsb_data_transaction_get_transaction_number (tmp_list->data),
+												&record,
+												snapshot->strings);
+		g_array_append_val (snapshot->records, record);
+		tmp_list = tmp_list->next;
+	}
+
+	/* the floating points used to write the archives not loaded */
+	snapshot->currencies_floating_point = g_hash_table_new (g_direct_hash, g_direct_equal);
+	tmp_list = gsb_data_currency_get_currency_list ();
+	while (tmp_list)
+	{
+		gint currency_number;
+
+		currency_number = gsb_data_currency_get_no_currency (tmp_list->data);
+		g_hash_table_insert (snapshot->currencies_floating_point,
+							 GINT_TO_POINTER (currency_number),
+							 GINT_TO_POINTER (gsb_data_currency_get_floating_point (currency_number) + 1));
+		tmp_list = tmp_list->next;
+	}
+
+	snapshot->accounts_floating_point = g_hash_table_new (g_direct_hash, g_direct_equal);
+	tmp_list = gsb_data_account_get_list_accounts ();
+	while (tmp_list)
+	{
+		gint account_number;
+
+		account_number = gsb_data_account_get_no_account (tmp_list->data);
+		g_hash_table_insert (snapshot->accounts_floating_point,
+							 GINT_TO_POINTER (account_number),
+							 GINT_TO_POINTER (gsb_data_account_get_currency_floating_point (account_number) + 1));
+		tmp_list = tmp_list->next;
+	}
+
+	if (pending_archives)
+	{
+		snapshot->mapped_file = g_mapped_file_ref (pending_archives->mapped_file);
+		snapshot->segments_data = pending_archives->segments_data;
+		snapshot->segments = g_slist_copy (pending_archives->segments);
+	}
+
+	return snapshot;
+}
+
+/**
+ * write the transactions of a snapshot as gsb_file_save_transaction_part does,
+ * without reading the data of grisbi so it can be called by a thread
+ *
+ * \param writer the writer of the file
+ * \param snapshot
+ *
+ * \return
+ **/
+void gsb_file_cache_snapshot_save (GsbFileSaveWriter *writer,
+								   GsbFileCacheSnapshot *snapshot)
+{
+	GSList *tmp_list;
+	guint i;
+
+	/* the records are rounded as in the file, they are written with their exponent */
+	for (i = 0; i < snapshot->records->len; i++)
+	{
+		const GsbFileCacheTransaction *record;
+
+		record = &g_array_index (snapshot->records, GsbFileCacheTransaction, i);
+		gsb_file_cache_save_transaction_record (writer,
+												record,
+												(const gchar *) snapshot->strings->data,
+												snapshot->strings->len,
+												record->archive_number,
+												-1,
+												-1);
+	}
+
+	tmp_list = snapshot->segments;
+	while (tmp_list)
+	{
+		gsb_file_cache_write_segment (writer, snapshot->segments_data, tmp_list->data, 0, snapshot);
+		tmp_list = tmp_list->next;
+	}
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
@@ -0,0 +1,79 @@
+#ifndef _GSB_FILE_CACHE_H
+#define _GSB_FILE_CACHE_H (1)
+
+#include <glib.h>
+
+/* START_INCLUDE_H */
+#include "gsb_file_save.h"
+#include "gsb_real.h"
+/* END_INCLUDE_H */
+
+typedef struct _GsbFileCache				GsbFileCache;
+typedef struct _GsbFileCacheArchiveSummary	GsbFileCacheArchiveSummary;
+typedef struct _GsbFileCacheArchiveTotal	GsbFileCacheArchiveTotal;
+typedef struct _GsbFileCacheSnapshot		GsbFileCacheSnapshot;
+
+/* what is known of the transactions of an archive in an account
+ * while that archive is kept in the cache and not loaded */
+struct _GsbFileCacheArchiveSummary
+{
+	gint		archive_number;
+	gint		account_number;
+	GsbReal		balance;				/* in the currency of the account, without the children of the splits */
+	GsbReal		marked_balance;			/* balance of the marked transactions */
+	GsbReal		waiting_marked_balance;	/* balance of the pointed and telepointed transactions */
+	gint		nb_transactions;		/* with the children of the splits */
+	gint		nb_pointed;
+	gint		nb_converted;			/* transactions in another currency than the account */
+	guint32		first_julian;			/* first and last date or value date */
+	guint32		last_julian;
+};
+
+/* what is known of the transactions of an archive in a payee, a category or a budget
+ * while that archive is kept in the cache and not loaded, by currency of the transactions */
+struct _GsbFileCacheArchiveTotal
+{
+	gint		archive_number;
+	gint		type;					/* METATREE_PAYEE, METATREE_CATEGORY or METATREE_BUDGET */
+	gint		div_number;
+	gint		sub_div_number;			/* 0 for the payees */
+	gint		currency_number;
+	GsbReal		amount;					/* in the currency, of the transactions counted in the metatree */
+	gint		nb_transactions;		/* all the transactions of the division */
+	gint		nb_counted;				/* without the transfers and the splits, as the metatree */
+};
+
+/* START_DECLARATION */
+gboolean		gsb_file_cache_archives_pending		(void);
+gint			gsb_file_cache_find_archive_of_transaction	(gint transaction_number);
+void			gsb_file_cache_forget_archives		(void);
+void			gsb_file_cache_free					(GsbFileCache *cache);
+gboolean		gsb_file_cache_get_account_archives_summary	(gint account_number,
+															 GsbFileCacheArchiveSummary *summary);
+GSList *		gsb_file_cache_get_archives_summaries	(void);
+GSList *		gsb_file_cache_get_archives_totals	(gint type,
+													 gint currency_number);
+gint			gsb_file_cache_get_archives_last_number	(void);
+void			gsb_file_cache_get_parts_position	(GsbFileCache *cache,
+                        							 GsbFileSavePartsPosition *position);
+void			gsb_file_cache_load					(GsbFileCache *cache);
+void			gsb_file_cache_load_account_archives	(gint account_number,
+														 guint32 julian);
+void			gsb_file_cache_load_archive			(gint archive_number);
+void			gsb_file_cache_load_converted_archives	(void);
+gboolean		gsb_file_cache_load_division_archives	(gint type,
+														 gint div_number,
+														 gint sub_div_number);
+GsbFileCache *	gsb_file_cache_open					(const gchar *filename);
+void			gsb_file_cache_remove				(const gchar *filename);
+gboolean		gsb_file_cache_save					(const gchar *filename,
+													 const GsbFileSavePartsPosition *parts_position);
+void			gsb_file_cache_save_archives_part	(GsbFileSaveWriter *writer,
+													 gint archive_number);
+void			gsb_file_cache_snapshot_free		(GsbFileCacheSnapshot *snapshot);
+GsbFileCacheSnapshot *	gsb_file_cache_snapshot_new	(void);
+void			gsb_file_cache_snapshot_save		(GsbFileSaveWriter *writer,
+													 GsbFileCacheSnapshot *snapshot);
+/* END_DECLARATION */
+
+#endif
@@ -68,12 +68,14 @@
 #include "gsb_data_transaction.h"
 #include "gsb_dirs.h"
 #include "gsb_file.h"
+#include "gsb_file_cache.h"
 #include "gsb_file_util.h"
 #include "gsb_locale.h"
 #include "gsb_real.h"
 #include "gsb_rgba.h"
 #include "gsb_select_icon.h"
 #include "gsb_scheduler_list.h"
+#include "gsb_trace.h"
 #include "gsb_transactions_list.h"
 #include "import.h"
 #include "menu.h"
@@ -110,6 +112,9 @@ struct DownloadTmpValues
     gboolean		report_part;
 };
 
+/* size of the chunks read in the grisbi file while loading it */
+#define GSB_FILE_LOAD_CHUNK_SIZE 65536
+
 static struct DownloadTmpValues download_tmp_values = {FALSE, NULL, NULL, FALSE, FALSE, FALSE};
 
 /* structure temporaire pour le chargement d'un tiers/catégorie/imputation et sous-catégorie
@@ -132,13 +137,15 @@ static struct TmpDivSousDivStruct *buffer_new_div_sous_div;
  *  check if the xml file is the last structure (before 0.6) or
  * the new structure (after 0.6)
  *
- * \param file_content the grisbi file
+ * \param file_content the beginning of the grisbi file
+ * \param length length of file_content
  *
  * \return TRUE if the version is after 0.6
  **/
-static gboolean gsb_file_load_check_new_structure (gchar *file_content)
+static gboolean gsb_file_load_check_new_structure (const gchar *file_content,
+												   gsize length)
 {
-	if (strstr (file_content, "Generalites"))
+	if (g_strstr_len (file_content, length, "Generalites"))
 		return FALSE;
 
 	return TRUE;
@@ -3903,172 +3910,396 @@ static void gsb_file_load_start_element (GMarkupParseContext *context,
     }
 }
 
-/******************************************************************************/
-/* Public Methods                                                             */
-/******************************************************************************/
 /**
- * called to open the grisbi file given in param
+ * ask to the user if the file which is not a valid UTF8 file should be fixed
  *
- * \filename the filename to load with full path
+ * \param filename
  *
- * \return TRUE if ok
+ * \return TRUE to fix the file, FALSE to load another file
  **/
-gboolean gsb_file_load_open_file (const gchar *filename)
+static gboolean gsb_file_load_ask_fix_utf8 (const gchar *filename)
 {
-    gchar *file_content;
-    gchar *tmp_file_content;
-    gulong length;
-	gboolean changed = TRUE;
-	gboolean show_msg = TRUE;
-	GrisbiAppConf *a_conf;
-	GrisbiWinEtat *w_etat;
+	GtkWidget *dialog;
+	gchar *text;
+	gchar *hint;
+	gboolean fix;
 
-    devel_debug (filename);
+	hint = g_strdup_printf (_("'%s' is not a valid UTF8 file"), filename);
 
-#ifndef G_OS_WIN32      /* check the access to the file and display a message */
-    gint return_value;
-    struct stat buffer_stat;
 
-     /* fill the buffer stat to check the permission */
-    return_value = g_stat (filename, &buffer_stat);
-    if (!return_value && buffer_stat.st_mode & (S_IRGRP | S_IROTH))
-        gsb_file_util_display_warning_permissions ();
-#endif /* G_OS_WIN32 */
+	text = g_strdup_printf (_("You can choose to fix the file with the substitution character? "
+							  "or return to the file choice.\n"));
 
-	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
+	dialog = dialogue_special_no_run (GTK_MESSAGE_ERROR, GTK_BUTTONS_NONE, text, hint);
 
-	/* load the file */
-    if (gsb_file_util_get_contents (filename, &tmp_file_content, &length))
-    {
-        GMarkupParser *markup_parser;
-        GMarkupParseContext *context;
-		gboolean is_crypt = FALSE;
-		GrisbiWinRun *w_run;
+	gtk_dialog_add_buttons (GTK_DIALOG(dialog),
+							_("Load another file"), GTK_RESPONSE_NO,
+							_("Correct the file"), GTK_RESPONSE_OK,
+								NULL);
+	fix = (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_OK);
+	gtk_widget_destroy (dialog);
+	g_free (hint);
+	g_free (text);
+
+	return fix;
+}
 
-		/* first, we check if the file is crypted, if it is, we decrypt it */
-		if (!strncmp (tmp_file_content, "Grisbi encrypted file ", 22) ||
-			 !strncmp (tmp_file_content, "Grisbi encryption v2: ", 22))
+/**
+ * get the length of the UTF8 character cut at the end of a chunk of the file
+ * that bytes must be kept for the next chunk
+ *
+ * \param chunk
+ * \param length length of the chunk
+ *
+ * \return the number of bytes to keep, 0 if the last character is complete
+ **/
+static gsize gsb_file_load_get_utf8_tail (const gchar *chunk,
+										  gsize length)
+{
+	gsize tail;
+
+	/* look for the first byte of the last character */
+	for (tail = 1 ; tail <= 3 && tail <= length ; tail++)
+	{
+		const gchar *last_char;
+
+		last_char = chunk + length - tail;
+		if ((*last_char & 0xC0) != 0x80)
 		{
+			if (g_utf8_get_char_validated (last_char, tail) == (gunichar) -2)
+				return tail;
+			else
+				return 0;
+		}
+	}
+	return 0;
+}
+
+/**
+ * remove from the bytes just read the part of the file which is in the cache
+ *
+ * \param data the bytes just read
+ * \param length the number of bytes
+ * \param position the position of data in the uncompressed file
+ * \param begin the position of the beginning of the part
+ * \param end the position of the end of the part
+ *
+ * \return the number of bytes kept at the beginning of data
+ **/
+static gsize gsb_file_load_skip_cached_part (gchar *data,
+											 gsize length,
+											 guint64 position,
+											 guint64 begin,
+											 guint64 end)
+{
+	gsize first;
+	gsize last;
+
+	if (end <= position || begin >= position + length)
+		return length;
+
+	first = MAX (begin, position) - position;
+	last = MIN (end, position + length) - position;
+	memmove (data + first, data + last, length - last);
+
+	return length - (last - first);
+}
+
+/* the parser of the grisbi file */
+static GMarkupParser markup_parser = {(void *) gsb_file_load_start_element,
+									  NULL,
+									  NULL,
+									  NULL,
+									  (void *) gsb_file_load_error};
+
+/**
+ * load a crypted grisbi file, the file is decrypted in memory
+ * before being parsed
+ *
+ * \param filename
+ *
+ * \return TRUE if the file was parsed
+ **/
+static gboolean gsb_file_load_parse_crypted_file (const gchar *filename)
+{
 #ifdef HAVE_SSL
-			length = gsb_file_util_crypt_file (filename, &tmp_file_content, FALSE, length);
+	GMarkupParseContext *context;
+	gchar *file_content;
+	gulong length;
+	GrisbiWinRun *w_run;
 
-			if (! length)
-			{
-				g_free (tmp_file_content);
-				return FALSE;
-			}
-			else
-				is_crypt = TRUE;
+	if (!gsb_file_util_get_contents (filename, &file_content, &length))
+		return FALSE;
+
+	length = gsb_file_util_crypt_file (filename, &file_content, FALSE, length);
+
+	if (! length)
+	{
+		g_free (file_content);
+		return FALSE;
+	}
+
+	w_run = grisbi_win_get_w_run ();
+	if (!gsb_file_load_check_new_structure (file_content, length))
+	{
+		w_run->old_version = TRUE;
+		g_free (file_content);
+
+		return FALSE;
+	}
+	w_run->old_version = FALSE;
+
+	context = g_markup_parse_context_new (&markup_parser, 0, NULL, NULL);
+	if (!g_markup_parse_context_parse (context, file_content, strlen (file_content), NULL))
+		download_tmp_values.download_ok = FALSE;
+
+	g_markup_parse_context_free (context);
+	g_free (file_content);
+
+	return TRUE;
 #else
-			{
-				gchar *text;
-				gchar *hint;
+	gchar *text;
+	gchar *hint;
 
-				g_free (tmp_file_content);
-				text = g_strdup_printf (_("This build of Grisbi does not support encryption.\n"
-										  "Please recompile Grisbi with OpenSSL encryption enabled."));
+	text = g_strdup_printf (_("This build of Grisbi does not support encryption.\n"
+							  "Please recompile Grisbi with OpenSSL encryption enabled."));
 
-				hint = g_strdup_printf (_("Cannot open encrypted file '%s'"), filename);
+	hint = g_strdup_printf (_("Cannot open encrypted file '%s'"), filename);
 
-				dialogue_error_hint (text, hint);
-				g_free (hint);
-				g_free (text);
-				return FALSE;
-			}
+	dialogue_error_hint (text, hint);
+	g_free (hint);
+	g_free (text);
+
+	return FALSE;
 #endif
-		}
+}
 
-		/* si le fichier n'a pas été chiffré et n'est pas un fichier UTF8 valide on le corrige si possible */
-		if (!is_crypt && !g_utf8_validate (tmp_file_content, length, NULL))
-		{
-			GtkWidget *dialog;
-			gchar *text;
-			gchar *hint;
+/**
+ * load the grisbi file chunk by chunk, so the file, compressed or not,
+ * is never loaded completely in memory
+ * the UTF8 is checked for each chunk and the progress is showed in the status bar
+ *
+ * \param filename
+ *
+ * \return TRUE if the file was parsed
+ **/
+static gboolean gsb_file_load_parse_file (const gchar *filename)
+{
+	GsbFileStream *stream;
+	GMarkupParseContext *context = NULL;
+	gchar *buffer;
+	gsize tail = 0;
+	gint last_percent = -1;
+	gboolean first_chunk = TRUE;
+	gboolean fix_utf8 = FALSE;
+	gboolean parse_ok = TRUE;
+	guint64 position = 0;
+	GsbFileCache *cache;
+	GsbFileSavePartsPosition cached_parts = {0, 0, 0, 0};
+	gint64 trace_start;
+	GrisbiWinRun *w_run;
 
-			hint = g_strdup_printf (_("'%s' is not a valid UTF8 file"), filename);
+	stream = gsb_file_util_stream_open (filename);
+	if (!stream)
+		return FALSE;
 
+	trace_start = gsb_trace_begin ();
 
-			text = g_strdup_printf (_("You can choose to fix the file with the substitution character? "
-									  "or return to the file choice.\n"));
+	/* if the cache of the file is valid, the transactions, payees, categories
+	 * and budgets are not parsed, they are loaded from the cache at the end */
+	cache = gsb_file_cache_open (filename);
+	if (cache)
+		gsb_file_cache_get_parts_position (cache, &cached_parts);
 
-			dialog = dialogue_special_no_run (GTK_MESSAGE_ERROR, GTK_BUTTONS_NONE, text, hint);
+	w_run = grisbi_win_get_w_run ();
+	buffer = g_malloc (GSB_FILE_LOAD_CHUNK_SIZE);
 
-			gtk_dialog_add_buttons (GTK_DIALOG(dialog),
-									_("Load another file"), GTK_RESPONSE_NO,
-									_("Correct the file"), GTK_RESPONSE_OK,
-										NULL);
-			if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_OK)
+	while (parse_ok)
+	{
+		gchar *chunk;
+		gssize read_size;
+		gsize length;
+		gint percent;
+
+		/* the bytes of a cut character are kept at the beginning of the buffer */
+		read_size = gsb_file_util_stream_read (stream, buffer + tail, GSB_FILE_LOAD_CHUNK_SIZE - tail);
+		if (read_size < 0)
+		{
+			parse_ok = FALSE;
+			break;
+		}
+		if (read_size == 0 && tail == 0)
+			break;
+
+		gsb_trace_count ("file_load_bytes", read_size);
+
+		/* the parts in the cache are skipped, the last part first to keep the position of the first */
+		length = gsb_file_load_skip_cached_part (buffer + tail,
+												 read_size,
+												 position,
+												 cached_parts.divisions_begin,
+												 cached_parts.divisions_end);
+		length = gsb_file_load_skip_cached_part (buffer + tail,
+												 length,
+												 position,
+												 cached_parts.transactions_begin,
+												 cached_parts.transactions_end);
+		position += read_size;
+		length += tail;
+
+		if (first_chunk)
+		{
+			first_chunk = FALSE;
+
+			/* first, we check if the file is crypted, if it is, we decrypt it in memory */
+			if (length >= 22
+				&& (!strncmp (buffer, "Grisbi encrypted file ", 22)
+					|| !strncmp (buffer, "Grisbi encryption v2: ", 22)))
 			{
-				file_content = g_utf8_make_valid (tmp_file_content, length);
-				gtk_widget_destroy (dialog);
+				g_free (buffer);
+				gsb_file_util_stream_close (stream);
+				gsb_file_cache_free (cache);
+
+				return gsb_file_load_parse_crypted_file (filename);
 			}
-			else
+
+			/* we begin to check if we are in a version under 0.6 or 0.6 and above,
+			 * because the xml structure changes after 0.6 */
+			if (!gsb_file_load_check_new_structure (buffer, length))
 			{
-				g_free (tmp_file_content);
-				gtk_widget_destroy (dialog);
-				return FALSE;
+				w_run->old_version = TRUE;
+				parse_ok = FALSE;
+				break;
 			}
-		}
-		else
-			file_content = tmp_file_content;
+			w_run->old_version = FALSE;
 
-		/* set the icons directory */
-		gsb_dirs_set_user_icons_dir (filename);
+			context = g_markup_parse_context_new (&markup_parser, 0, NULL, NULL);
+		}
 
-		w_run = grisbi_win_get_w_run ();
+		/* a character cut at the end of the chunk is parsed with the next chunk */
+		if (read_size > 0)
+			tail = gsb_file_load_get_utf8_tail (buffer, length);
+		else
+			tail = 0;
+		length -= tail;
 
-		/* we begin to check if we are in a version under 0.6 or 0.6 and above,
-		 * because the xml structure changes after 0.6 */
-		markup_parser = g_malloc0 (sizeof (GMarkupParser));
-		if (gsb_file_load_check_new_structure (file_content))
-		{
-			/* fill the GMarkupParser for a new xml structure */
-			markup_parser->start_element = (void *) gsb_file_load_start_element;
-			markup_parser->error = (void *) gsb_file_load_error;
-			w_run->old_version = FALSE;
-		}
+		/* si le chunk n'est pas un texte UTF8 valide on le corrige si possible */
+		if (g_utf8_validate (buffer, length, NULL))
+			chunk = buffer;
 		else
 		{
-			w_run->old_version = TRUE;
-			g_free (markup_parser);
+			if (!fix_utf8)
+				fix_utf8 = gsb_file_load_ask_fix_utf8 (filename);
 
-			return FALSE;
+			if (!fix_utf8)
+			{
+				parse_ok = FALSE;
+				break;
+			}
+			chunk = g_utf8_make_valid (buffer, length);
 		}
 
-		context = g_markup_parse_context_new (markup_parser,
-							0,
-							NULL,
-						NULL);
-		download_tmp_values.download_ok = FALSE;
-
-		if (! g_markup_parse_context_parse (context,
-						file_content,
-						strlen (file_content),
-						NULL))
+		if (!g_markup_parse_context_parse (context,
+										   chunk,
+										   chunk == buffer ? (gssize) length : -1,
+										   NULL))
 		{
 			download_tmp_values.download_ok = FALSE;
+			parse_ok = FALSE;
 		}
 
-		g_markup_parse_context_free (context);
-		g_free (markup_parser);
-		g_free (file_content);
+		if (chunk != buffer)
+			g_free (chunk);
 
-		if (!download_tmp_values.download_ok)
-			return FALSE;
+		if (tail)
+			memmove (buffer, buffer + length, tail);
 
-		if (w_run->account_number_is_0)
+		percent = gsb_file_util_stream_get_percent (stream);
+		if (percent != last_percent)
 		{
-			gsb_data_account_renum_account_number_0 (filename);
+			gchar *tmp_str;
+
+			tmp_str = g_strdup_printf (_("Loading accounts (%d%%)"), percent);
+			grisbi_win_status_bar_message (tmp_str);
+			g_free (tmp_str);
+			last_percent = percent;
 		}
+	}
 
-		if (a_conf->sauvegarde_demarrage)
-			gsb_file_set_modified (TRUE);
+	if (context)
+		g_markup_parse_context_free (context);
+	g_free (buffer);
+	gsb_file_util_stream_close (stream);
+	gsb_trace_end ("file_load_parse", trace_start);
 
-    }
-    else
-    {
-        return FALSE;
-    }
+	if (cache)
+	{
+		trace_start = gsb_trace_begin ();
+		if (parse_ok && download_tmp_values.download_ok)
+			gsb_file_cache_load (cache);
+		gsb_file_cache_free (cache);
+		gsb_trace_end ("file_load_cache", trace_start);
+	}
+
+	return parse_ok;
+}
+
+/******************************************************************************/
+/* Public Methods                                                             */
+/******************************************************************************/
+/**
+ * called to open the grisbi file given in param
+ *
+ * \filename the filename to load with full path
+ *
+ * \return TRUE if ok
+ **/
+gboolean gsb_file_load_open_file (const gchar *filename)
+{
+	gboolean changed = TRUE;
+	gboolean show_msg = TRUE;
+	GrisbiAppConf *a_conf;
+	GrisbiWinEtat *w_etat;
+	GrisbiWinRun *w_run;
+
+    devel_debug (filename);
+
+#ifndef G_OS_WIN32      /* check the access to the file and display a message */
+    gint return_value;
+    struct stat buffer_stat;
+
+     /* fill the buffer stat to check the permission */
+    return_value = g_stat (filename, &buffer_stat);
+    if (!return_value && buffer_stat.st_mode & (S_IRGRP | S_IROTH))
+        gsb_file_util_display_warning_permissions ();
+#endif /* G_OS_WIN32 */
+
+	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
+
+	/* set the icons directory */
+	gsb_dirs_set_user_icons_dir (filename);
+
+	/* load the file */
+	download_tmp_values.download_ok = FALSE;
+
+	if (!gsb_file_load_parse_file (filename) || !download_tmp_values.download_ok)
+	{
+		/* the file is parsed by chunks: the data of the chunks already parsed
+		 * are forgotten when the user doesn't fix an invalid UTF8 chunk
+		 * or when a chunk cannot be parsed */
+		init_variables ();
+
+		return FALSE;
+	}
+
+	w_run = (GrisbiWinRun *) grisbi_win_get_w_run ();
+	if (w_run->account_number_is_0)
+	{
+		gsb_data_account_renum_account_number_0 (filename);
+	}
+
+	if (a_conf->sauvegarde_demarrage)
+		gsb_file_set_modified (TRUE);
 
 	w_etat = (GrisbiWinEtat *) grisbi_win_get_w_etat ();
 
@@ -58,9 +58,7 @@ static gboolean gsb_file_others_check_file ( gchar *file_content,
 				      gint origin );
 static gboolean gsb_file_others_load ( gchar *filename,
 				gint origin );
-static gulong gsb_file_others_save_general_part ( gulong iterator,
-					   gulong *length_calculated,
-					   gchar **file_content,
+static void gsb_file_others_save_general_part ( GsbFileSaveWriter *writer,
 					   const gchar *version );
 static void gsb_file_others_start_budget_from_category ( GMarkupParseContext *context,
 				     const gchar *element_name,
@@ -93,84 +91,39 @@ static void gsb_file_others_start_element ( GMarkupParseContext *context,
  * */
 gboolean gsb_file_others_save_category ( gchar *filename )
 {
-    gchar *file_content;
-    gchar *tmp_str;
-    FILE *file;
-    gulong iterator;
-    gulong length_calculated;
-    gulong length_part;
+    GsbFileSaveWriter *writer;
 
     devel_debug (filename);
 
-    /* we begin to try to reserve enough memory to make the entire file
-     * if not enough, we will make it growth later
-     * the data below are about the memory to take for each part and for 1 of this part
-     * with that i think we will allocate enough memory in one time but not too much */
-
-    length_part = 500;
-
-    length_calculated = length_part * g_slist_length (gsb_data_category_get_categories_list());
-    if ( length_calculated == 0 )
+    if ( !gsb_data_category_get_categories_list () )
     {
-        tmp_str = g_strdup ( _("There is no category to record. Back.") );
-        dialogue_error ( tmp_str );
-        g_free ( tmp_str );
+        dialogue_error ( _("There is no category to record. Back.") );
 
         return ( TRUE );
     }
 
-    iterator = 0;
-    file_content = g_malloc0 ( length_calculated );
+    writer = gsb_file_save_writer_new ( filename, FALSE );
+    if ( !writer )
+        return ( FALSE );
 
     /* begin the file whit xml markup */
 
-    iterator = gsb_file_save_append_part ( iterator,
-					   &length_calculated,
-					   &file_content,
-					   my_strdup ("<?xml version=\"1.0\"?>\n<Grisbi_categ>\n"));
+    gsb_file_save_writer_write ( writer,
+				 "<?xml version=\"1.0\"?>\n<Grisbi_categ>\n",
+				 -1 );
 
-    iterator = gsb_file_others_save_general_part ( iterator,
-						   &length_calculated,
-						   &file_content,
-						   VERSION_FICHIER_CATEG );
+    gsb_file_others_save_general_part ( writer,
+					VERSION_FICHIER_CATEG );
 
-    iterator = gsb_file_save_category_part ( iterator,
-					     &length_calculated,
-					     &file_content );
+    gsb_file_save_category_part ( writer );
 
     /* finish the file */
 
-    iterator = gsb_file_save_append_part ( iterator,
-					   &length_calculated,
-					   &file_content,
-					   my_strdup ("</Grisbi_categ>"));
-
-    /* the file is in memory, we can save it */
-
-	file = utils_files_utf8_fopen ( filename, "w" );
-
-    if ( !file
-	 ||
-	 !fwrite ( file_content,
-		   sizeof (gchar),
-		   iterator,
-		   file ))
-    {
-        tmp_str = g_strdup_printf ( _("Cannot save file '%s': %s"),
-                        filename,
-                        g_strerror ( errno ) );
-        dialogue_error ( tmp_str );
-        g_free ( tmp_str );
-        g_free ( file_content );
-        if (file)
-            fclose(file);
-        return ( FALSE );
-    }
-
-    fclose (file);
-    g_free ( file_content);
+    gsb_file_save_writer_write ( writer,
+				 "</Grisbi_categ>",
+				 -1 );
 
-    return ( TRUE );
+    return gsb_file_save_writer_close ( writer );
 }
 
 /**
@@ -185,83 +138,39 @@ gboolean gsb_file_others_save_category ( gchar *filename )
  * */
 gboolean gsb_file_others_save_budget ( gchar *filename )
 {
-    gchar *file_content;
-    gchar *tmp_str;
-    FILE *file;
-    gulong iterator;
-    gulong length_calculated;
-    gulong length_part;
+    GsbFileSaveWriter *writer;
 
     devel_debug (filename);
-    gboolean ret = TRUE;
-
-    /* we begin to try to reserve enough memory to make the entire file
-     * if not enough, we will make it growth later
-     * the data below are about the memory to take for each part and for 1 of this part
-     * with that i think we will allocate enough memory in one time but not too much */
-
-    length_part = 500;
 
-    length_calculated = length_part * g_slist_length ( gsb_data_budget_get_budgets_list () );
-    if ( length_calculated == 0 )
+    if ( !gsb_data_budget_get_budgets_list () )
     {
-        tmp_str = g_strdup ( _("There is no budgetary line to record. Back.") );
-        dialogue_error ( tmp_str );
-        g_free ( tmp_str );
+        dialogue_error ( _("There is no budgetary line to record. Back.") );
 
         return ( TRUE );
     }
 
-    iterator = 0;
-    file_content = g_malloc0 ( length_calculated );
+    writer = gsb_file_save_writer_new ( filename, FALSE );
+    if ( !writer )
+        return ( FALSE );
 
     /* begin the file whit xml markup */
 
-    iterator = gsb_file_save_append_part ( iterator,
-					   &length_calculated,
-					   &file_content,
-					   my_strdup ("<?xml version=\"1.0\"?>\n<Grisbi_budget>\n"));
+    gsb_file_save_writer_write ( writer,
+				 "<?xml version=\"1.0\"?>\n<Grisbi_budget>\n",
+				 -1 );
 
-    iterator = gsb_file_others_save_general_part ( iterator,
-						   &length_calculated,
-						   &file_content,
-						   VERSION_FICHIER_IB );
+    gsb_file_others_save_general_part ( writer,
+					VERSION_FICHIER_IB );
 
-    iterator = gsb_file_save_budgetary_part ( iterator,
-					      &length_calculated,
-					      &file_content );
+    gsb_file_save_budgetary_part ( writer );
 
     /* finish the file */
 
-    iterator = gsb_file_save_append_part ( iterator,
-					   &length_calculated,
-					   &file_content,
-					   my_strdup ("</Grisbi_budget>"));
+    gsb_file_save_writer_write ( writer,
+				 "</Grisbi_budget>",
+				 -1 );
 
-    /* the file is in memory, we can save it */
-
-	file = utils_files_utf8_fopen ( filename, "w" );
-
-    if ( !file
-	 ||
-	 !fwrite ( file_content,
-		   sizeof (gchar),
-		   iterator,
-		   file ))
-    {
-        tmp_str = g_strdup_printf ( _("Cannot save file '%s': %s"),
-                        filename,
-                        g_strerror ( errno ) );
-        dialogue_error ( tmp_str );
-        g_free ( tmp_str );
-        ret = FALSE;
-    }
-
-    if (file)
-	fclose ( file );
-    g_free ( file_content);
-
-    return ( ret );
+    return gsb_file_save_writer_close ( writer );
 }
 
 /**
@@ -276,85 +185,40 @@ gboolean gsb_file_others_save_budget ( gchar *filename )
  * */
 gboolean gsb_file_others_save_report ( gchar *filename )
 {
-    gchar *file_content;
-    gchar *tmp_str;
-    FILE *file;
-    gulong iterator;
-    gulong length_calculated;
-    gulong length_part;
+    GsbFileSaveWriter *writer;
 
     devel_debug (filename);
 
-    /* we begin to try to reserve enough memory to make the entire file
-     * if not enough, we will make it growth later
-     * the data below are about the memory to take for each part and for 1 of this part
-     * with that i think we will allocate enough memory in one time but not too much */
-
-    length_part = 2500;
-
-    length_calculated = length_part * g_slist_length (gsb_data_report_get_report_list ());
-    if ( length_calculated == 0 )
+    if ( !gsb_data_report_get_report_list () )
     {
-        tmp_str = g_strdup ( _("There is no report to record. Back.") );
-        dialogue_error ( tmp_str );
-        g_free ( tmp_str );
+        dialogue_error ( _("There is no report to record. Back.") );
 
         return ( TRUE );
     }
 
-    iterator = 0;
-    file_content = g_malloc0 ( length_calculated );
+    writer = gsb_file_save_writer_new ( filename, FALSE );
+    if ( !writer )
+        return ( FALSE );
 
     /* begin the file whit xml markup */
 
-    iterator = gsb_file_save_append_part ( iterator,
-					   &length_calculated,
-					   &file_content,
-					   my_strdup ("<?xml version=\"1.0\"?>\n<Grisbi_report>\n"));
+    gsb_file_save_writer_write ( writer,
+				 "<?xml version=\"1.0\"?>\n<Grisbi_report>\n",
+				 -1 );
 
-    iterator = gsb_file_others_save_general_part ( iterator,
-						   &length_calculated,
-						   &file_content,
-						   VERSION_FICHIER_ETAT );
+    gsb_file_others_save_general_part ( writer,
+					VERSION_FICHIER_ETAT );
 
-    iterator = gsb_file_save_report_part ( iterator,
-					   &length_calculated,
-					   &file_content,
-					   TRUE );
+    gsb_file_save_report_part ( writer,
+				TRUE );
 
     /* finish the file */
 
-    iterator = gsb_file_save_append_part ( iterator,
-					   &length_calculated,
-					   &file_content,
-					   my_strdup ("</Grisbi_report>"));
-
-    /* the file is in memory, we can save it */
+    gsb_file_save_writer_write ( writer,
+				 "</Grisbi_report>",
+				 -1 );
 
-    file = utils_files_utf8_fopen ( filename, "w" );
-
-    if ( !file
-	 ||
-	 !fwrite ( file_content,
-		   sizeof (gchar),
-		   iterator,
-		   file ))
-    {
-        tmp_str = g_strdup_printf ( _("Cannot save file '%s': %s"),
-                        filename,
-                        g_strerror ( errno ) );
-        dialogue_error ( tmp_str);
-        g_free ( tmp_str );
-        g_free ( file_content );
-        if (file)
-            fclose(file);
-        return ( FALSE );
-    }
-
-    fclose ( file );
-    g_free ( file_content);
-
-    return ( TRUE );
+    return gsb_file_save_writer_close ( writer );
 }
 
 
@@ -362,37 +226,22 @@ gboolean gsb_file_others_save_report ( gchar *filename )
  * save the general part for the others files
  * for now, it's just the version of grisbi and the version of the file
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  * \param version the version of the file (depends of categ, budget or report)
  *
- * \return the new iterator
+ * \return
  * */
-gulong gsb_file_others_save_general_part ( gulong iterator,
-					   gulong *length_calculated,
-					   gchar **file_content,
-					   const gchar *version )
+void gsb_file_others_save_general_part ( GsbFileSaveWriter *writer,
+					 const gchar *version )
 {
-	gulong result;
-    gchar *new_string;
-
     /* save the general information */
 
-    new_string = g_strdup_printf ( "\t<General\n"
-				   "\t\tFile_version=\"%s\"\n"
-				   "\t\tGrisbi_version=\"%s\" />\n",
-				   version,
-				   VERSION );
-
-    /* append the new string to the file content
-     * and return the new iterator */
-
-    result = gsb_file_save_append_part ( iterator,
-						length_calculated,
-						file_content,
-						new_string );
-    return result;
+    gsb_file_save_writer_printf ( writer,
+				  "\t<General\n"
+				  "\t\tFile_version=\"%s\"\n"
+				  "\t\tGrisbi_version=\"%s\" />\n",
+				  version,
+				  VERSION );
 }
 
 
@@ -32,11 +32,14 @@
 
 #include "include.h"
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 #include <errno.h>
+#include <stdint.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <zlib.h>
+#include <gio/gio.h>
 
 /*START_INCLUDE*/
 #include "gsb_file_save.h"
@@ -70,11 +73,13 @@
 #include "gsb_data_transaction.h"
 #include "gsb_dirs.h"
 #include "gsb_file.h"
+#include "gsb_file_cache.h"
 #include "gsb_locale.h"
 #include "gsb_real.h"
 #include "gsb_rgba.h"
 #include "gsb_select_icon.h"
 #include "gsb_scheduler_list.h"
+#include "gsb_trace.h"
 #include "gsb_transactions_list.h"
 #include "import_csv.h"
 #include "navigation.h"
@@ -94,21 +99,168 @@
 /*START_EXTERN*/
 /*END_EXTERN*/
 
+/* size of the buffer of the writer, the file is written by blocks of that size */
+#define GSB_FILE_SAVE_BUFFER_SIZE 65536
+
+/* size of the buffer used to format the conversions other than %d and %s */
+#define GSB_FILE_SAVE_CONVERSION_SIZE 512
+
+/* the writer used to save the file, the file is written by blocks in a
+ * temporary file which replaces the file when all is written */
+struct _GsbFileSaveWriter
+{
+	gchar		buffer[GSB_FILE_SAVE_BUFFER_SIZE];
+	gsize		length;				/* used part of the buffer */
+	GString *	memory;				/* content of the file if the writer is in memory */
+	gzFile		gz_file;			/* set if the file is compressed */
+	gint		fd;
+	gchar *		filename;
+	gchar *		tmp_filename;
+	gint		error;				/* errno of the first error, 0 if none */
+	guint64		position;			/* number of bytes written since the beginning */
+	gchar		conversion[GSB_FILE_SAVE_CONVERSION_SIZE];	/* to format the conversions other than %d and %s */
+	GsbFileSavePartsPosition	parts_position;	/* set when a complete file is written */
+};
+
 /******************************************************************************/
 /* Private functions                                                          */
 /******************************************************************************/
+/**
+ * write the buffer of the writer to the file
+ *
+ * \param writer
+ *
+ * \return
+ **/
+static void gsb_file_save_writer_flush (GsbFileSaveWriter *writer)
+{
+	gsize written = 0;
+
+	/* after an error, nothing is written anymore, it will be shown at the end */
+	if (writer->error || !writer->length)
+	{
+		writer->length = 0;
+		return;
+	}
+
+	if (writer->gz_file)
+	{
+		if (gzwrite (writer->gz_file, writer->buffer, (unsigned) writer->length) != (gint) writer->length)
+		{
+			gint errnum;
+
+			gzerror (writer->gz_file, &errnum);
+			writer->error = (errnum == Z_ERRNO) ? errno : EIO;
+		}
+	}
+	else
+	{
+		while (written < writer->length)
+		{
+			gssize result;
+
+			result = write (writer->fd, writer->buffer + written, writer->length - written);
+			if (result < 0)
+			{
+				if (errno == EINTR)
+					continue;
+
+				writer->error = errno;
+				break;
+			}
+			written += result;
+		}
+	}
+	writer->length = 0;
+}
+
+/**
+ * write a text to the file, escaped as g_markup_escape_text does
+ * the text is written directly in the buffer, without allocation
+ *
+ * \param writer
+ * \param text
+ * \param length the number of bytes of text to write, -1 to write all the text
+ *
+ * \return
+ **/
+static void gsb_file_save_writer_write_escaped (GsbFileSaveWriter *writer,
+												const gchar *text,
+												gssize length)
+{
+	const gchar *ptr;
+	const gchar *start;
+
+	if (!text)
+		text = "(null)";
+
+	ptr = start = text;
+	while ((length < 0 || ptr - text < length) && *ptr)
+	{
+		const gchar *entity = NULL;
+		gchar tmp_entity[12];
+		guchar c;
+		gint char_length = 1;
+
+		c = (guchar) *ptr;
+		switch (c)
+		{
+			case '&':
+				entity = "&amp;";
+				break;
+			case '<':
+				entity = "&lt;";
+				break;
+			case '>':
+				entity = "&gt;";
+				break;
+			case '\'':
+				entity = "&#39;";
+				break;
+			case '"':
+				entity = "&quot;";
+				break;
+			default:
+				/* the control characters are written as character references */
+				if ((c >= 0x1 && c <= 0x8) || c == 0xb || c == 0xc || (c >= 0xe && c <= 0x1f) || c == 0x7f)
+				{
+					g_snprintf (tmp_entity, sizeof (tmp_entity), "&#x%x;", c);
+					entity = tmp_entity;
+				}
+				else if (c == 0xc2
+						 && (length < 0 || ptr + 1 - text < length)
+						 && (guchar) ptr[1] >= 0x80
+						 && (guchar) ptr[1] <= 0x9f
+						 && (guchar) ptr[1] != 0x85)
+				{
+					g_snprintf (tmp_entity, sizeof (tmp_entity), "&#x%x;", (guchar) ptr[1]);
+					entity = tmp_entity;
+					char_length = 2;
+				}
+				break;
+		}
+
+		if (entity)
+		{
+			gsb_file_save_writer_write (writer, start, ptr - start);
+			gsb_file_save_writer_write (writer, entity, -1);
+			ptr += char_length;
+			start = ptr;
+		}
+		else
+			ptr++;
+	}
+	gsb_file_save_writer_write (writer, start, ptr - start);
+}
+
 /**
  * save the account part
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_account_part (gulong iterator,
-										  gulong *length_calculated,
-										  gchar **file_content)
+static void gsb_file_save_account_part (GsbFileSaveWriter *writer)
 {
 	GSList *list_tmp;
 
@@ -362,31 +514,21 @@ static gulong gsb_file_save_account_part (gulong iterator,
 		g_free (owner_str);
 		g_free (tmp_str);
 
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-											  file_content,
-											  new_string);
+		/* append the new string to the file content */
+		gsb_file_save_append_part (writer, new_string);
 
 		list_tmp = list_tmp->next;
 	}
-
-	/* and return the new iterator */
-	return iterator;
 }
 
 /**
  * save the archives structures
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_archive_part (gulong iterator,
-										  gulong *length_calculated,
-										  gchar **file_content)
+static void gsb_file_save_archive_part (GsbFileSaveWriter *writer)
 {
     GSList *list_tmp;
 
@@ -395,18 +537,17 @@ static gulong gsb_file_save_archive_part (gulong iterator,
     while (list_tmp)
     {
 		gint archive_number;
-		gchar *new_string;
-		gchar *beginning_date;
-		gchar *end_date;
+		gchar beginning_date[SIZEOF_FORMATTED_STRING_DATE_SAFE];
+		gchar end_date[SIZEOF_FORMATTED_STRING_DATE_SAFE];
 
 		archive_number = gsb_data_archive_get_no_archive (list_tmp->data);
 
 		/* set the date */
-		beginning_date = gsb_format_gdate_safe (gsb_data_archive_get_beginning_date (archive_number));
-		end_date = gsb_format_gdate_safe (gsb_data_archive_get_end_date (archive_number));
+		gsb_format_gdate_safe_to_buffer (gsb_data_archive_get_beginning_date (archive_number), beginning_date);
+		gsb_format_gdate_safe_to_buffer (gsb_data_archive_get_end_date (archive_number), end_date);
 
 		/* now we can fill the file content */
-		new_string = g_markup_printf_escaped ("\t<Archive Nb=\"%d\" Na=\"%s\" Bdte=\"%s\" "
+		gsb_file_save_writer_printf (writer, "\t<Archive Nb=\"%d\" Na=\"%s\" Bdte=\"%s\" "
 											  "Edte=\"%s\" Fye=\"%d\" Rep=\"%s\" />\n",
 											  archive_number,
 											  my_safe_null_str(gsb_data_archive_get_name (archive_number)),
@@ -415,36 +556,18 @@ static gulong gsb_file_save_archive_part (gulong iterator,
 											  gsb_data_archive_get_fyear (archive_number),
 											  my_safe_null_str(gsb_data_archive_get_report_title (archive_number)));
 
-		if (beginning_date)
-			g_free (beginning_date);
-		if (end_date)
-			g_free (end_date);
-
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-											  file_content,
-											  new_string);
-
 		list_tmp = list_tmp->next;
     }
-
-	/* and return the new iterator */
-	return iterator;
 }
 
 /**
  * save the banks
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_bank_part (gulong iterator,
-									   gulong *length_calculated,
-									   gchar **file_content)
+static void gsb_file_save_bank_part (GsbFileSaveWriter *writer)
 {
     GSList *list_tmp;
 
@@ -453,7 +576,6 @@ static gulong gsb_file_save_bank_part (gulong iterator,
     while (list_tmp)
     {
 		gint bank_number;
-		gchar *new_string;
 		gchar *adr_str;
 		gchar *rem_str;
 
@@ -464,7 +586,7 @@ static gulong gsb_file_save_bank_part (gulong iterator,
 		rem_str = utils_str_protect_unprotect_multilines_text (gsb_data_bank_get_bank_note (bank_number), TRUE);
 
 		/* now we can fill the file content */
-		new_string = g_markup_printf_escaped ("\t<Bank Nb=\"%d\" Na=\"%s\" Co=\"%s\" BIC=\"%s\" "
+		gsb_file_save_writer_printf (writer, "\t<Bank Nb=\"%d\" Na=\"%s\" Co=\"%s\" BIC=\"%s\" "
 											  "Adr=\"%s\" Tel=\"%s\" Mail=\"%s\" Web=\"%s\" Nac=\"%s\" Faxc=\"%s\" "
 											  "Telc=\"%s\" Mailc=\"%s\" Rem=\"%s\" />\n",
 											  bank_number,
@@ -484,31 +606,18 @@ static gulong gsb_file_save_bank_part (gulong iterator,
 		g_free (adr_str);
 		g_free (rem_str);
 
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-											  file_content,
-											  new_string);
-
 		list_tmp = list_tmp->next;
     }
-
-	/* and return the new iterator */
-	return iterator;
 }
 
 /**
  * save the balance estimate part
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_bet_part (gulong iterator,
-									  gulong *length_calculated,
-									  gchar **file_content)
+static void gsb_file_save_bet_part (GsbFileSaveWriter *writer)
 {
 	gchar *new_string;
 	GPtrArray *tab;
@@ -522,47 +631,34 @@ static gulong gsb_file_save_bet_part (gulong iterator,
 										  w_etat->bet_debut_period, w_etat->bet_cash_account_option);
 
 	/* append the new string to the file content */
-	iterator = gsb_file_save_append_part (iterator,
-										  length_calculated,
-										  file_content,
-										  new_string);
+	gsb_file_save_append_part (writer, new_string);
 
 	tab = bet_data_get_strings_to_save ();
 
 	if (tab == NULL)
-		return iterator;
+		return;
 
 	for (i = 0; i < (gint) tab->len; i++)
 	{
 		new_string = g_ptr_array_index (tab, i);
 
-		/* append the new string to the file content and take the new iterator */
-		iterator =  gsb_file_save_append_part (iterator,
-											   length_calculated,
-											   file_content,
-											   new_string);
+		/* append the new string to the file content */
+		gsb_file_save_append_part (writer, new_string);
 	}
 
 	/* free the tab */
 	g_ptr_array_free (tab, TRUE);
-
-	/* and return the new iterator */
-	return iterator;
 }
 
 #ifdef HAVE_GOFFICE
 /**
  * save the bet graph preferences part
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_bet_graph_part (gulong iterator,
-											gulong *length_calculated,
-											gchar **file_content)
+static void gsb_file_save_bet_graph_part (GsbFileSaveWriter *writer)
 {
 	gchar *new_string = NULL;
 
@@ -570,37 +666,24 @@ static gulong gsb_file_save_bet_graph_part (gulong iterator,
 	new_string = bet_graph_get_configuration_string (BET_ONGLETS_PREV);
 
 	/* append the new string to the file content */
-	iterator = gsb_file_save_append_part (iterator,
-										  length_calculated,
-										  file_content,
-										  new_string);
+	gsb_file_save_append_part (writer, new_string);
 
 	/* save the historical preferences */
 	new_string = bet_graph_get_configuration_string (BET_ONGLETS_HIST);
 
 	/* append the new string to the file content */
-	iterator = gsb_file_save_append_part (iterator,
-										  length_calculated,
-										  file_content,
-										  new_string);
-
-	/* and return the new iterator */
-	return iterator;
+	gsb_file_save_append_part (writer, new_string);
 }
 
 #endif /* HAVE_GOFFICE */
 /**
  * save the currency_links
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_currency_link_part (gulong iterator,
-												gulong *length_calculated,
-												gchar **file_content)
+static void gsb_file_save_currency_link_part (GsbFileSaveWriter *writer)
 {
     GSList *list_tmp;
 
@@ -608,58 +691,40 @@ static gulong gsb_file_save_currency_link_part (gulong iterator,
 
     while (list_tmp)
     {
-		gchar *new_string;
 		gint link_number;
-		gchar *change_rate;
-		gchar *str_date;
+		gchar change_rate[GSB_REAL_SAFE_STRING_SIZE];
+		gchar str_date[SIZEOF_FORMATTED_STRING_DATE_SAFE];
 
 		link_number = gsb_data_currency_link_get_no_currency_link (list_tmp->data);
 
 		/* set the number */
-		change_rate = gsb_real_safe_real_to_string (
-							gsb_data_currency_link_get_change_rate (link_number), -1);
+		gsb_real_safe_real_to_buffer (gsb_data_currency_link_get_change_rate (link_number), -1, change_rate);
 
 		/* set the date of modification */
-		str_date = gsb_format_gdate_safe (gsb_data_currency_link_get_modified_date (link_number));
+		gsb_format_gdate_safe_to_buffer (gsb_data_currency_link_get_modified_date (link_number), str_date);
 
 		/* now we can fill the file content */
-		new_string = g_markup_printf_escaped ("\t<Currency_link Nb=\"%d\" Cu1=\"%d\" Cu2=\"%d\" "
+		gsb_file_save_writer_printf (writer, "\t<Currency_link Nb=\"%d\" Cu1=\"%d\" Cu2=\"%d\" "
 											  "Ex=\"%s\" Modified_date=\"%s\" Fl=\"%d\" />\n",
 											  link_number,
 											  gsb_data_currency_link_get_first_currency (link_number),
 											  gsb_data_currency_link_get_second_currency (link_number),
 											  my_safe_null_str (change_rate),
-											  str_date,
+											  my_safe_null_str (str_date),
 											  gsb_data_currency_link_get_fixed_link (link_number));
 
-		g_free (change_rate);
-		g_free (str_date);
-
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-											  file_content,
-											  new_string);
-
 		list_tmp = list_tmp->next;
     }
-
-	/* and return the new iterator */
-    return iterator;
 }
 
 /**
  * save the currencies
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_currency_part (gulong iterator,
-										   gulong *length_calculated,
-										   gchar **file_content)
+static void gsb_file_save_currency_part (GsbFileSaveWriter *writer)
 {
     GSList *list_tmp;
 
@@ -667,14 +732,13 @@ static gulong gsb_file_save_currency_part (gulong iterator,
 
     while (list_tmp)
     {
-		gchar *new_string;
 		gint currency_number;
 
 		currency_number = gsb_data_currency_get_no_currency (list_tmp->data);
 
 		/* now we can fill the file content */
 
-		new_string = g_markup_printf_escaped ("\t<Currency Nb=\"%d\" Na=\"%s\" Co=\"%s\" "
+		gsb_file_save_writer_printf (writer, "\t<Currency Nb=\"%d\" Na=\"%s\" Co=\"%s\" "
 											  "Ico=\"%s\" Fl=\"%d\" />\n",
 											  currency_number,
 											  my_safe_null_str(gsb_data_currency_get_name (currency_number)),
@@ -682,31 +746,18 @@ static gulong gsb_file_save_currency_part (gulong iterator,
 											  my_safe_null_str(gsb_data_currency_get_code_iso4217 (currency_number)),
 											  gsb_data_currency_get_floating_point (currency_number));
 
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-											  file_content,
-											  new_string);
-
 		list_tmp = list_tmp->next;
     }
-
-	/* and return the new iterator */
-	return iterator;
 }
 
 /**
  * save the financials years
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_financial_year_part (gulong iterator,
-												 gulong *length_calculated,
-												 gchar **file_content)
+static void gsb_file_save_financial_year_part (GsbFileSaveWriter *writer)
 {
     GSList *list_tmp;
 
@@ -714,19 +765,18 @@ static gulong gsb_file_save_financial_year_part (gulong iterator,
 
     while (list_tmp)
     {
-		gchar *new_string;
 		gint fyear_number;
-		gchar *beginning_date;
-		gchar *end_date;
+		gchar beginning_date[SIZEOF_FORMATTED_STRING_DATE_SAFE];
+		gchar end_date[SIZEOF_FORMATTED_STRING_DATE_SAFE];
 
 		fyear_number = gsb_data_fyear_get_no_fyear (list_tmp->data);
 
 		/* set the date */
-		beginning_date = gsb_format_gdate_safe (gsb_data_fyear_get_beginning_date(fyear_number));
-		end_date = gsb_format_gdate_safe (gsb_data_fyear_get_end_date(fyear_number));
+		gsb_format_gdate_safe_to_buffer (gsb_data_fyear_get_beginning_date(fyear_number), beginning_date);
+		gsb_format_gdate_safe_to_buffer (gsb_data_fyear_get_end_date(fyear_number), end_date);
 
 		/* now we can fill the file content */
-		new_string = g_markup_printf_escaped ("\t<Financial_year Nb=\"%d\" Na=\"%s\" Bdte=\"%s\" "
+		gsb_file_save_writer_printf (writer, "\t<Financial_year Nb=\"%d\" Na=\"%s\" Bdte=\"%s\" "
 											  "Edte=\"%s\" Sho=\"%d\" />\n",
 											  fyear_number,
 											  my_safe_null_str(gsb_data_fyear_get_name (fyear_number)),
@@ -734,35 +784,19 @@ static gulong gsb_file_save_financial_year_part (gulong iterator,
 											  my_safe_null_str(end_date),
 											  gsb_data_fyear_get_form_show (fyear_number));
 
-		g_free (beginning_date);
-		g_free (end_date);
-
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-											  file_content,
-											  new_string);
-
 		list_tmp = list_tmp->next;
     }
-
-	/* and return the new iterator */
-	return iterator;
 }
 
 /**
  * save the general part
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  * \param archive_number the number of the archive or 0 if not an archive
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_general_part (gulong iterator,
-										  gulong *length_calculated,
-										  gchar **file_content,
+static void gsb_file_save_general_part (GsbFileSaveWriter *writer,
 										  gint archive_number)
 {
 	GQueue *tmp_queue;
@@ -778,7 +812,6 @@ static gulong gsb_file_save_general_part (gulong iterator,
 	gchar *scheduler_column_width_write;
 	gchar *transaction_column_width_write;
 	gchar *transaction_column_align_write;
-	gchar *new_string;
 	gchar *bet_array_column_width_write;
 	gchar *date_format;
 	gchar *mon_decimal_point;
@@ -894,7 +927,7 @@ static gulong gsb_file_save_general_part (gulong iterator,
 											 TRUE);
 	string_to_free2 = utils_str_dtostr (etat.bet_taux_annuel, BET_TAUX_DIGITS, TRUE);
 	string_to_free3 = utils_str_dtostr (etat.bet_frais, BET_TAUX_DIGITS, TRUE);
-	new_string = g_markup_printf_escaped ("\t<General\n"
+	gsb_file_save_writer_printf (writer, "\t<General\n"
 										  "\t\tFile_version=\"%s\"\n"
 										  "\t\tGrisbi_version=\"%s\"\n"
 										  "\t\tCrypt_file=\"%d\"\n"
@@ -1054,26 +1087,16 @@ static gulong gsb_file_save_general_part (gulong iterator,
 	g_free (form_columns_width);
 
 	g_free (bet_array_column_width_write);
-
-	/* append the new string to the file content and return the new iterator */
-	return gsb_file_save_append_part (iterator,
-									  length_calculated,
-									  file_content,
-									  new_string);
 }
 
 /**
  * save the import rules structures
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_import_rule_part (gulong iterator,
-											  gulong *length_calculated,
-											  gchar **file_content)
+static void gsb_file_save_import_rule_part (GsbFileSaveWriter *writer)
 {
     GSList *list_tmp;
 
@@ -1130,11 +1153,8 @@ static gulong gsb_file_save_import_rule_part (gulong iterator,
 				GSList *tmp_list;
 				gint index = 1;
 
-				/* append the new string to the file content and take the new iterator */
-				iterator = gsb_file_save_append_part (iterator,
-													  length_calculated,
-													  file_content,
-													  new_string);
+				/* append the new string to the file content */
+				gsb_file_save_append_part (writer, new_string);
 
 				tmp_list = gsb_data_import_rule_get_csv_spec_lines_list (import_rule_number);
 				while (tmp_list)
@@ -1151,11 +1171,8 @@ static gulong gsb_file_save_import_rule_part (gulong iterator,
 														  spec_conf_data->csv_spec_conf_used_data,
 														  spec_conf_data->csv_spec_conf_used_text);
 
-					/* append the new string to the file content and take the new iterator */
-					iterator = gsb_file_save_append_part (iterator,
-														  length_calculated,
-														  file_content,
-														  new_string);
+					/* append the new string to the file content */
+					gsb_file_save_append_part (writer, new_string);
 					index++;
 
 					tmp_list = tmp_list->next;
@@ -1167,32 +1184,22 @@ static gulong gsb_file_save_import_rule_part (gulong iterator,
 			new_string = g_strconcat (tmp_str, "/>\n", NULL);
 			g_free (tmp_str);
 
-			/* append the new string to the file content and take the new iterator */
-			iterator = gsb_file_save_append_part (iterator,
-												  length_calculated,
-												  file_content,
-												  new_string);
+			/* append the new string to the file content */
+			gsb_file_save_append_part (writer, new_string);
 		}
 
 		list_tmp = list_tmp->next;
     }
-
-	/* and return the new iterator */
-	return iterator;
 }
 
 /**
  * save the partial_balance structures
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_partial_balance_part (gulong iterator,
-												  gulong *length_calculated,
-												  gchar **file_content)
+static void gsb_file_save_partial_balance_part (GsbFileSaveWriter *writer)
 {
     GSList *list_tmp;
 
@@ -1200,12 +1207,11 @@ static gulong gsb_file_save_partial_balance_part (gulong iterator,
 
     while (list_tmp)
     {
-		gchar *new_string;
 		gint partial_balance_number;
 
 		partial_balance_number = gsb_data_partial_balance_get_number (list_tmp->data);
 
-		new_string = g_markup_printf_escaped ("\t<Partial_balance Nb=\"%d\" Na=\"%s\" "
+		gsb_file_save_writer_printf (writer, "\t<Partial_balance Nb=\"%d\" Na=\"%s\" "
 											  "Acc=\"%s\" Kind=\"%d\" Currency=\"%d\" Colorise=\"%d\" />\n",
 											  partial_balance_number,
 											  my_safe_null_str(gsb_data_partial_balance_get_name
@@ -1216,31 +1222,18 @@ static gulong gsb_file_save_partial_balance_part (gulong iterator,
 											  gsb_data_partial_balance_get_currency (partial_balance_number),
 											  gsb_data_partial_balance_get_colorise (partial_balance_number));
 
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-											  file_content,
-											  new_string);
-
 		list_tmp = list_tmp->next;
     }
-
-	/* and return the new iterator */
-    return iterator;
 }
 
 /**
  * save the parties
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_party_part (gulong iterator,
-										gulong *length_calculated,
-										gchar **file_content)
+static void gsb_file_save_party_part (GsbFileSaveWriter *writer)
 {
     GSList *list_tmp;
 
@@ -1248,7 +1241,6 @@ static gulong gsb_file_save_party_part (gulong iterator,
 
     while (list_tmp)
     {
-        gchar *new_string;
         gint payee_number;
 
         payee_number = gsb_data_payee_get_no_payee (list_tmp->data);
@@ -1260,7 +1252,7 @@ static gulong gsb_file_save_party_part (gulong iterator,
             continue;
         }
 
-        new_string = g_markup_printf_escaped ("\t<Party Nb=\"%d\" Na=\"%s\" Txt=\"%s\" "
+        gsb_file_save_writer_printf (writer, "\t<Party Nb=\"%d\" Na=\"%s\" Txt=\"%s\" "
 											  "Search=\"%s\" IgnCase=\"%d\" UseRegex=\"%d\" />\n",
 											  payee_number,
 											  my_safe_null_str(gsb_data_payee_get_name (payee_number, TRUE)),
@@ -1269,31 +1261,18 @@ static gulong gsb_file_save_party_part (gulong iterator,
 											  gsb_data_payee_get_ignore_case (payee_number),
 											  gsb_data_payee_get_use_regex (payee_number));
 
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-											  file_content,
-											  new_string);
-
 		list_tmp = list_tmp->next;
     }
-
-	/* and return the new iterator */
-	return iterator;
 }
 
 /**
  * save the methods of payment
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_payment_part (gulong iterator,
-										  gulong *length_calculated,
-										  gchar **file_content)
+static void gsb_file_save_payment_part (GsbFileSaveWriter *writer)
 {
 	GSList *list_tmp;
 
@@ -1302,12 +1281,11 @@ static gulong gsb_file_save_payment_part (gulong iterator,
 	while (list_tmp)
 	{
 		gint payment_number;
-		gchar *new_string;
 
 		payment_number = gsb_data_payment_get_number (list_tmp->data);
 
 		/* now we can fill the file content */
-		new_string = g_markup_printf_escaped ("\t<Payment Number=\"%d\" Name=\"%s\" Sign=\"%d\" Show_entry=\"%d\" "
+		gsb_file_save_writer_printf (writer, "\t<Payment Number=\"%d\" Name=\"%s\" Sign=\"%d\" Show_entry=\"%d\" "
 											  "Automatic_number=\"%d\" Current_number=\"%s\" Account=\"%d\" />\n",
 											  payment_number,
 											  my_safe_null_str(gsb_data_payment_get_name (payment_number)),
@@ -1317,35 +1295,21 @@ static gulong gsb_file_save_payment_part (gulong iterator,
 											  gsb_data_payment_get_last_number (payment_number),
 											  gsb_data_payment_get_account_number (payment_number));
 
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-											  file_content,
-											  new_string);
-
 		list_tmp = list_tmp->next;
 	}
-
-	/* and return the new iterator */
-	return iterator;
 }
 
 /**
  * save the print part
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  * \param archive_number the number of the archive or 0 if not an archive
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_print_part (gulong iterator,
-										gulong *length_calculated,
-										gchar **file_content,
+static void gsb_file_save_print_part (GsbFileSaveWriter *writer,
 										gint archive_number)
 {
-	gchar *new_string;
 	gchar *string_to_free1;
 	gchar *string_to_free2;
 	gchar *string_to_free3;
@@ -1356,7 +1320,7 @@ static gulong gsb_file_save_print_part (gulong iterator,
 	string_to_free2 = pango_font_description_to_string (gsb_data_print_config_get_font_title ());
 	string_to_free3 = pango_font_description_to_string (gsb_data_print_config_get_report_font_transactions ());
 	string_to_free4 = pango_font_description_to_string (gsb_data_print_config_get_report_font_title ());
-	new_string = g_markup_printf_escaped ("\t<Print\n"
+	gsb_file_save_writer_printf (writer, "\t<Print\n"
 										  "\t\tDraw_lines=\"%d\"\n"
 										  "\t\tDraw_column=\"%d\"\n"
 										  "\t\tDraw_background=\"%d\"\n"
@@ -1386,26 +1350,16 @@ static gulong gsb_file_save_print_part (gulong iterator,
 		g_free (string_to_free2);
 		g_free (string_to_free3);
 		g_free (string_to_free4);
-
-	/* append the new string to the file content and return the new iterator */
-	return gsb_file_save_append_part (iterator,
-									  length_calculated,
-									  file_content,
-									  new_string);
 }
 
 /**
  * save the reconcile structures
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_reconcile_part (gulong iterator,
-											gulong *length_calculated,
-											gchar **file_content)
+static void gsb_file_save_reconcile_part (GsbFileSaveWriter *writer)
 {
     GList *list_tmp;
 
@@ -1413,37 +1367,31 @@ static gulong gsb_file_save_reconcile_part (gulong iterator,
 
     while (list_tmp)
     {
-		gchar *new_string;
 		gint reconcile_number;
-		gchar *init_date;
-		gchar *final_date;
-		gchar *init_balance;
-		gchar *final_balance;
+		gchar init_date[SIZEOF_FORMATTED_STRING_DATE_SAFE];
+		gchar final_date[SIZEOF_FORMATTED_STRING_DATE_SAFE];
+		gchar init_balance[GSB_REAL_SAFE_STRING_SIZE];
+		gchar final_balance[GSB_REAL_SAFE_STRING_SIZE];
 		gint floating_point;
 
 		reconcile_number = gsb_data_reconcile_get_no_reconcile (list_tmp->data);
 
 		/* set the reconcile dates */
-		init_date = gsb_format_gdate_safe (gsb_data_reconcile_get_init_date (reconcile_number));
-		if (!init_date)
-			init_date  = my_strdup ("");
-
-		final_date = gsb_format_gdate_safe (gsb_data_reconcile_get_final_date (reconcile_number));
-		if (!final_date)
-			final_date = my_strdup ("");
+		gsb_format_gdate_safe_to_buffer (gsb_data_reconcile_get_init_date (reconcile_number), init_date);
+		gsb_format_gdate_safe_to_buffer (gsb_data_reconcile_get_final_date (reconcile_number), final_date);
 
 		/* set the balances strings */
 		floating_point = gsb_data_account_get_currency_floating_point (gsb_data_reconcile_get_account
 																	   (reconcile_number));
-		init_balance = gsb_real_safe_real_to_string (gsb_data_reconcile_get_init_balance
-													 (reconcile_number),
-													 floating_point);
-		final_balance = gsb_real_safe_real_to_string (gsb_data_reconcile_get_final_balance
-													  (reconcile_number),
-													  floating_point);
+		gsb_real_safe_real_to_buffer (gsb_data_reconcile_get_init_balance (reconcile_number),
+									  floating_point,
+									  init_balance);
+		gsb_real_safe_real_to_buffer (gsb_data_reconcile_get_final_balance (reconcile_number),
+									  floating_point,
+									  final_balance);
 
 		/* now we can fill the file content */
-		new_string = g_markup_printf_escaped ("\t<Reconcile Nb=\"%d\" Na=\"%s\" Acc=\"%d\" "
+		gsb_file_save_writer_printf (writer, "\t<Reconcile Nb=\"%d\" Na=\"%s\" Acc=\"%d\" "
 											  "Idate=\"%s\" Fdate=\"%s\" Ibal=\"%s\" Fbal=\"%s\" />\n",
 											  reconcile_number,
 											  my_safe_null_str(gsb_data_reconcile_get_name (reconcile_number)),
@@ -1453,60 +1401,35 @@ static gulong gsb_file_save_reconcile_part (gulong iterator,
 											  my_safe_null_str(init_balance),
 											  my_safe_null_str(final_balance));
 
-		g_free (init_date);
-		g_free (final_date);
-		g_free (init_balance);
-		g_free (final_balance);
-
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-											  file_content,
-											  new_string);
-
 		list_tmp = list_tmp->next;
     }
-
-	/* and return the new iterator */
-	return iterator;
 }
 
 /**
  * save the rgba part
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_rgba_part (gulong iterator,
-									   gulong *length_calculated,
-									   gchar **file_content)
+static void gsb_file_save_rgba_part (GsbFileSaveWriter *writer)
 {
 	gchar *new_string;
 
 	new_string = gsb_rgba_get_string_to_save ();
 
-	/* append the new string to the file content and return the new iterator */
-	return gsb_file_save_append_part (iterator,
-									  length_calculated,
-									  file_content,
-									  new_string);
+	/* append the new string to the file content */
+	gsb_file_save_append_part (writer, new_string);
 }
 
 /**
  * save the scheduled transactions
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_scheduled_part (gulong iterator,
-											gulong *length_calculated,
-											gchar **file_content)
+static void gsb_file_save_scheduled_part (GsbFileSaveWriter *writer)
 {
 	GSList *list_tmp;
 
@@ -1515,25 +1438,25 @@ static gulong gsb_file_save_scheduled_part (gulong iterator,
 	while (list_tmp)
 	{
 		gint scheduled_number;
-		gchar *new_string;
-		gchar *amount;
-		gchar *date;
-		gchar *limit_date;
+		gchar amount[GSB_REAL_SAFE_STRING_SIZE];
+		gchar date[SIZEOF_FORMATTED_STRING_DATE_SAFE];
+		gchar limit_date[SIZEOF_FORMATTED_STRING_DATE_SAFE];
 		gint floating_point;
 
 		scheduled_number = gsb_data_scheduled_get_scheduled_number (list_tmp->data);
 
 		/* set the real */
 		floating_point = gsb_data_transaction_get_currency_floating_point (scheduled_number);
-		amount = gsb_real_safe_real_to_string (gsb_data_scheduled_get_amount (scheduled_number),
-											   floating_point);
+		gsb_real_safe_real_to_buffer (gsb_data_scheduled_get_amount (scheduled_number),
+									  floating_point,
+									  amount);
 
 		/* set the dates */
-		date = gsb_format_gdate_safe (gsb_data_scheduled_get_date (scheduled_number));
-		limit_date = gsb_format_gdate_safe (gsb_data_scheduled_get_limit_date (scheduled_number));
+		gsb_format_gdate_safe_to_buffer (gsb_data_scheduled_get_date (scheduled_number), date);
+		gsb_format_gdate_safe_to_buffer (gsb_data_scheduled_get_limit_date (scheduled_number), limit_date);
 
 		/* now we can fill the file content */
-		new_string = g_markup_printf_escaped ("\t<Scheduled Nb=\"%d\" Dt=\"%s\" Ac=\"%d\" Am=\"%s\" "
+		gsb_file_save_writer_printf (writer, "\t<Scheduled Nb=\"%d\" Dt=\"%s\" Ac=\"%d\" Am=\"%s\" "
 											  "Cu=\"%d\" Pa=\"%d\" Ca=\"%d\" Sca=\"%d\" Tra=\"%d\" Pn=\"%d\" "
 											  "CPn=\"%d\" Pc=\"%s\" Fi=\"%d\" Bu=\"%d\" Sbu=\"%d\" No=\"%s\" "
 											  "Au=\"%d\" Fd=\"%d\" Pe=\"%d\" Pei=\"%d\" Pep=\"%d\" Dtl=\"%s\" Br=\"%d\" "
@@ -1563,51 +1486,34 @@ static gulong gsb_file_save_scheduled_part (gulong iterator,
 											  gsb_data_scheduled_get_split_of_scheduled (scheduled_number),
 											  gsb_data_scheduled_get_mother_scheduled_number (scheduled_number));
 
-		g_free (amount);
-		g_free (date);
-		g_free (limit_date);
-
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-											  file_content,
-											  new_string);
-
 		list_tmp = list_tmp->next;
 	}
-
-	/* and return the new iterator */
-	return iterator;
 }
 
 /**
  * save the transactions
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  * \param archive_number 0 to export all the transactions, the number of archive to export only that transactions
  *
- * \return the new iterator
+ * \return
  **/
-static gulong gsb_file_save_transaction_part (gulong iterator,
-											  gulong *length_calculated,
-											  gchar **file_content,
+static void gsb_file_save_transaction_part (GsbFileSaveWriter *writer,
 											  gint archive_number)
 {
 	GSList *list_tmp;
 
-	list_tmp = gsb_data_transaction_get_complete_transactions_list ();
+	/* the archives kept in the cache of the file are written at the end without loading them */
+	list_tmp = gsb_data_transaction_get_loaded_transactions_list ();
 
 	while (list_tmp)
 	{
 		gint transaction_number;
-		gchar *new_string;
-		gchar *amount;
-		gchar *exchange_rate;
-		gchar *exchange_fees;
-		gchar *date;
-		gchar *value_date;
+		gchar amount[GSB_REAL_SAFE_STRING_SIZE];
+		gchar exchange_rate[GSB_REAL_SAFE_STRING_SIZE];
+		gchar exchange_fees[GSB_REAL_SAFE_STRING_SIZE];
+		gchar date[SIZEOF_FORMATTED_STRING_DATE_SAFE];
+		gchar value_date[SIZEOF_FORMATTED_STRING_DATE_SAFE];
 		gint transaction_archive_number;
 		gint floating_point;
 		gint floating_fees;
@@ -1634,23 +1540,24 @@ static gulong gsb_file_save_transaction_part (gulong iterator,
 		/* set the reals. On met en forme le résultat pour avoir une cohérence dans les montants
 		 * enregistrés dans le fichier à valider */
 		floating_point = gsb_data_transaction_get_currency_floating_point (transaction_number);
-		amount = gsb_real_safe_real_to_string (gsb_data_transaction_get_amount (transaction_number),
-											   floating_point);
-		exchange_rate = gsb_real_safe_real_to_string (gsb_data_transaction_get_exchange_rate
-													  (transaction_number),
-													  -1);
+		gsb_real_safe_real_to_buffer (gsb_data_transaction_get_amount (transaction_number),
+									  floating_point,
+									  amount);
+		gsb_real_safe_real_to_buffer (gsb_data_transaction_get_exchange_rate (transaction_number),
+									  -1,
+									  exchange_rate);
 		floating_fees = gsb_data_account_get_currency_floating_point (gsb_data_transaction_get_account_number
 																	  (transaction_number));
-		exchange_fees = gsb_real_safe_real_to_string (gsb_data_transaction_get_exchange_fees
-													  (transaction_number),
-													  floating_fees );
+		gsb_real_safe_real_to_buffer (gsb_data_transaction_get_exchange_fees (transaction_number),
+									  floating_fees,
+									  exchange_fees);
 
 		/* set the dates */
-		date = gsb_format_gdate_safe (gsb_data_transaction_get_date (transaction_number));
-		value_date = gsb_format_gdate_safe (gsb_data_transaction_get_value_date (transaction_number));
+		gsb_format_gdate_safe_to_buffer (gsb_data_transaction_get_date (transaction_number), date);
+		gsb_format_gdate_safe_to_buffer (gsb_data_transaction_get_value_date (transaction_number), value_date);
 
 		/* now we can fill the file content */
-		new_string = g_markup_printf_escaped ("\t<Transaction Ac=\"%d\" Nb=\"%d\" Id=\"%s\" Dt=\"%s\" "
+		gsb_file_save_writer_printf (writer, "\t<Transaction Ac=\"%d\" Nb=\"%d\" Id=\"%s\" Dt=\"%s\" "
 											  "Dv=\"%s\" Cu=\"%d\" Am=\"%s\" Exb=\"%d\" Exr=\"%s\" Exf=\"%s\" "
 											  "Pa=\"%d\" Ca=\"%d\" Sca=\"%d\" Br=\"%d\" No=\"%s\" Pn=\"%d\" "
 											  "Pc=\"%s\" Ma=\"%d\" Ar=\"%d\" Au=\"%d\" Re=\"%d\" Fi=\"%d\" "
@@ -1687,302 +1594,387 @@ static gulong gsb_file_save_transaction_part (gulong iterator,
 											  gsb_data_transaction_get_contra_transaction_number (transaction_number),
 											  gsb_data_transaction_get_mother_transaction_number (transaction_number));
 
-		g_free (amount);
-		g_free (exchange_rate);
-		g_free (exchange_fees);
-		g_free (date);
-		g_free (value_date);
-
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-											  file_content,
-											  new_string);
-
 		list_tmp = list_tmp->next;
 	}
 
-	/* and return the new iterator */
-	return iterator;
+	gsb_file_cache_save_archives_part (writer, archive_number);
 }
 
-/******************************************************************************/
-/* Public functions                                                           */
-/******************************************************************************/
 /**
- * save the grisbi file or an archive
- * we don't check anything here, all must be done before, here we just write
- * the file and set the permissions
+ * show the error message when the file cannot be saved
  *
- * an archive file is a normal grisbi file, but only with the wanted archived transactions
- * and without scheduled transactions
+ * \param filename
+ * \param error the errno of the error
  *
- * \param filename the name of the file
- * \param compress TRUE if we want to compress the file
- * \param archive_number 0 for complete file, the number of archive if export an archive
+ * \return
+ **/
+static void gsb_file_save_show_error (const gchar *filename,
+									  gint error)
+{
+	gchar *tmp_str;
+
+	tmp_str = g_strdup_printf (_("Cannot save file '%s': %s"),
+							   filename,
+							   g_strerror (error));
+	dialogue_error (tmp_str);
+	g_free (tmp_str);
+}
+
+/**
+ * create a writer, without any message so it can be called by a thread
+ * the file is written in a temporary file in the same directory which
+ * replaces the file when the writer is finished, so the file is never
+ * half saved
  *
- * \return TRUE : ok, FALSE : problem
+ * \param filename the name of the file, NULL to write the file in memory
+ * \param compress TRUE to compress the file
+ * \param error a pointer to fill with the errno if the file cannot be created
+ *
+ * \return a new GsbFileSaveWriter or NULL
  **/
-gboolean gsb_file_save_save_file (const gchar *filename,
-								  gboolean compress,
-								  gint archive_number)
+static GsbFileSaveWriter *gsb_file_save_writer_open (const gchar *filename,
+													 gboolean compress,
+													 gint *error)
 {
-	gint do_chmod;
-	gulong iterator;
+	GsbFileSaveWriter *writer;
 
-	gulong length_calculated;
-	gchar *file_content;
+	writer = g_malloc0 (sizeof (GsbFileSaveWriter));
+	writer->fd = -1;
 
-	gint general_part = 4048;
-	gint account_part = 1300;
-	gint transaction_part = 350;
-	gint party_part = 256;
-	gint category_part = 500;
-	gint budgetary_part = 500;
-	gint currency_part = 100;
-	gint currency_link_part = 100;
-	gint bank_part = 500;
-	gint financial_year_part = 100;
-	gint archive_part = 120;
-	gint reconcile_part = 150;
-	gint report_part = 2500;
-	gint import_rule_part = 50;
-	gint partial_balance_part = 50;
-	gint logo_part = 65536;
-	gint bet_part = 500;
-	gint bet_graph_part = 100;
-	gint rgba_part = 1000;
-	struct stat buf;
-	GrisbiWinEtat *w_etat;
+	if (!filename)
+	{
+		writer->memory = g_string_sized_new (GSB_FILE_SAVE_BUFFER_SIZE);
 
-	devel_debug (filename);
-	w_etat = grisbi_win_get_w_etat ();
+		return writer;
+	}
 
-	if (g_file_test (filename, G_FILE_TEST_EXISTS))
+	writer->filename = g_strdup (filename);
+	writer->tmp_filename = g_strconcat (filename, ".XXXXXX", NULL);
+	writer->fd = g_mkstemp (writer->tmp_filename);
+	*error = errno;
+
+	if (writer->fd != -1 && compress)
 	{
-		/* the file exists, we need to get the chmod values because gtk will overwrite it */
-		if (stat (filename, &buf) == -1)
-			/* stat couldn't get the information, so do as a new file
-			 * and we will set the good chmod */
-			do_chmod = TRUE;
-		else
-			do_chmod = FALSE;
+		writer->gz_file = gzdopen (writer->fd, "wb9");
+		if (!writer->gz_file)
+		{
+			*error = errno ? errno : ENOMEM;
+			close (writer->fd);
+			g_unlink (writer->tmp_filename);
+			writer->fd = -1;
+		}
 	}
-	else
-		/* the file doesn't exist, so we will set the only user chmod */
-		do_chmod = TRUE;
 
-	run.file_is_saving = TRUE;
+	if (writer->fd == -1)
+	{
+		g_free (writer->filename);
+		g_free (writer->tmp_filename);
+		g_free (writer);
 
-	/* we begin to try to reserve enough memory to make the entire file
-	 * if not enough, we will make it growth later
-	 * the data below are about the memory to take for each part and for 1 of this part
-	 * with that i think we will allocate enough memory in one time but not too much */
-
-	length_calculated = general_part
-	+ account_part * gsb_data_account_get_number_of_accounts ()
-	+ transaction_part * g_slist_length (gsb_data_transaction_get_complete_transactions_list ())
-	+ party_part * g_slist_length (gsb_data_payee_get_payees_list ())
-	+ category_part * g_slist_length (gsb_data_category_get_categories_list ())
-	+ budgetary_part * g_slist_length (gsb_data_budget_get_budgets_list ())
-	+ currency_part * g_slist_length (gsb_data_currency_get_currency_list ())
-	+ currency_link_part * g_slist_length (gsb_data_currency_link_get_currency_link_list ())
-	+ bank_part * g_slist_length (gsb_data_bank_get_bank_list ())
-	+ financial_year_part * g_slist_length (gsb_data_fyear_get_fyears_list ())
-	+ archive_part * g_slist_length (gsb_data_archive_get_archives_list ())
-	+ reconcile_part * g_list_length (gsb_data_reconcile_get_reconcile_list ())
-	+ report_part * g_slist_length (gsb_data_report_get_report_list ())
-	+ import_rule_part * g_slist_length (gsb_data_import_rule_get_list ())
-	+ partial_balance_part * g_slist_length (gsb_data_partial_balance_get_list ())
-	+ logo_part
-	+ bet_part
-	+ bet_graph_part
-	+ rgba_part;
-
-	iterator = 0;
-	file_content = g_malloc0 (length_calculated * sizeof (gchar));
+		return NULL;
+	}
 
-	/* begin the file whith xml markup */
-	iterator = gsb_file_save_append_part (iterator,
-					   &length_calculated,
-					   &file_content,
-					   my_strdup ("<?xml version=\"1.0\"?>\n<Grisbi>\n"));
-
-	iterator = gsb_file_save_general_part (iterator,
-						&length_calculated,
-						&file_content,
-						archive_number);
-
-	iterator = gsb_file_save_rgba_part (iterator,
-					  &length_calculated,
-					  &file_content);
-
-	iterator = gsb_file_save_print_part (iterator,
-					  &length_calculated,
-					  &file_content,
-					  archive_number);
-
-	 iterator = gsb_file_save_currency_part (iterator,
-						 &length_calculated,
-						 &file_content);
-
-	iterator = gsb_file_save_account_part (iterator,
-						&length_calculated,
-						&file_content);
-
-	iterator = gsb_file_save_payment_part (iterator,
-						&length_calculated,
-						&file_content);
-
-	iterator = gsb_file_save_transaction_part (iterator,
-						&length_calculated,
-						&file_content,
-						archive_number);
+	*error = 0;
 
-	/* if we export an archive, no scheduled transactions */
-	if (!archive_number)
-	iterator = gsb_file_save_scheduled_part (iterator,
-						  &length_calculated,
-						  &file_content);
+	return writer;
+}
 
-	iterator = gsb_file_save_party_part (iterator,
-					  &length_calculated,
-					  &file_content);
+/**
+ * write a conversion of gsb_file_save_writer_printf () other than %d, %s and %%,
+ * with its flags, width, precision and length modifier
+ * the width and the precision given by * are taken in args
+ * the conversion is formatted in the buffer of the writer, without allocation
+ *
+ * \param writer
+ * \param conversion the conversion in the format, after the %
+ * \param args the values of gsb_file_save_writer_printf ()
+ *
+ * \return a pointer to the format after the conversion, NULL if the conversion is unknown
+ * 			or too long for the buffer of the writer
+ **/
+static const gchar *gsb_file_save_writer_write_conversion (GsbFileSaveWriter *writer,
+														   const gchar *conversion,
+														   va_list *args)
+{
+	gchar spec[64];
+	const gchar *ptr;
+	gsize spec_length = 0;
+	gint width = 0;
+	gint precision = -1;
+	gint nbre_long = 0;
+	gint result;
+	gchar size_modifier = 0;
+	gboolean left_align = FALSE;
+
+	/* the end of the conversion is searched first to check the size of spec,
+	 * each * is replaced by at most 11 characters */
+	ptr = conversion + strspn (conversion, "-+ #0'");
+	if (*ptr == '*')
+		ptr++;
+	while (g_ascii_isdigit (*ptr))
+		ptr++;
+	if (*ptr == '.')
+	{
+		ptr++;
+		if (*ptr == '*')
+			ptr++;
+		while (g_ascii_isdigit (*ptr))
+			ptr++;
+	}
+	ptr += strspn (ptr, "hlLqjzt");
 
-	iterator = gsb_file_save_category_part (iterator,
-						 &length_calculated,
-						 &file_content);
+	if (!*ptr)
+	{
+		g_warning ("gsb_file_save_writer_printf: incomplete conversion in '%s'", conversion);
 
-	iterator = gsb_file_save_budgetary_part (iterator,
-						  &length_calculated,
-						  &file_content);
+		return NULL;
+	}
+	if ((gsize) (ptr - conversion) + 2 * 11 + 3 > sizeof (spec))
+	{
+		g_warning ("gsb_file_save_writer_printf: conversion too long in '%s'", conversion);
 
-	iterator = gsb_file_save_currency_link_part (iterator,
-						  &length_calculated,
-						  &file_content);
+		return NULL;
+	}
 
-	iterator = gsb_file_save_bank_part (iterator,
-					 &length_calculated,
-					 &file_content);
+	/* the conversion is copied with the values of the * to format it alone */
+	spec[spec_length++] = '%';
+	ptr = conversion;
+	while (*ptr && strchr ("-+ #0'", *ptr))
+	{
+		if (*ptr == '-')
+			left_align = TRUE;
+		spec[spec_length++] = *ptr++;
+	}
 
-	iterator = gsb_file_save_financial_year_part (iterator,
-						   &length_calculated,
-						   &file_content);
+	if (*ptr == '*')
+	{
+		width = va_arg (*args, gint);
+		spec_length += g_snprintf (spec + spec_length, sizeof (spec) - spec_length, "%d", width);
+		ptr++;
+	}
+	else if (g_ascii_isdigit (*ptr))
+		width = utils_str_atoi (ptr);
+	while (g_ascii_isdigit (*ptr))
+		spec[spec_length++] = *ptr++;
 
-	/* if we export an archive, no archive information */
-	if (!archive_number)
-	iterator = gsb_file_save_archive_part (iterator,
-						&length_calculated,
-						&file_content);
+	if (*ptr == '.')
+	{
+		spec[spec_length++] = *ptr++;
+		if (*ptr == '*')
+		{
+			precision = va_arg (*args, gint);
+			spec_length += g_snprintf (spec + spec_length, sizeof (spec) - spec_length, "%d", precision);
+			ptr++;
+		}
+		else
+			precision = utils_str_atoi (ptr);
+		while (g_ascii_isdigit (*ptr))
+			spec[spec_length++] = *ptr++;
+	}
 
-	iterator = gsb_file_save_reconcile_part (iterator,
-						  &length_calculated,
-						  &file_content);
+	for (;; ptr++)
+	{
+		/* the values of h and hh are promoted to int */
+		if (*ptr == 'l')
+			nbre_long++;
+		else if (*ptr == 'q')
+			nbre_long += 2;
+		else if (*ptr && strchr ("hLjzt", *ptr))
+			size_modifier = *ptr;
+		else
+			break;
+		spec[spec_length++] = *ptr;
+	}
+	spec[spec_length++] = *ptr;
+	spec[spec_length] = 0;
 
-	iterator = gsb_file_save_import_rule_part (iterator,
-						&length_calculated,
-						&file_content);
+	switch (*ptr)
+	{
+		case 'd':
+		case 'i':
+			if (size_modifier == 'j')
+				result = g_snprintf (writer->conversion, sizeof (writer->conversion), spec, va_arg (*args, intmax_t));
+			else if (size_modifier == 'z' || size_modifier == 't')
+				result = g_snprintf (writer->conversion, sizeof (writer->conversion), spec, va_arg (*args, gssize));
+			else if (nbre_long >= 2)
+				result = g_snprintf (writer->conversion, sizeof (writer->conversion), spec, va_arg (*args, long long));
+			else if (nbre_long == 1)
+				result = g_snprintf (writer->conversion, sizeof (writer->conversion), spec, va_arg (*args, glong));
+			else
+				result = g_snprintf (writer->conversion, sizeof (writer->conversion), spec, va_arg (*args, gint));
+			break;
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+			if (size_modifier == 'j')
+				result = g_snprintf (writer->conversion, sizeof (writer->conversion), spec, va_arg (*args, uintmax_t));
+			else if (size_modifier == 'z' || size_modifier == 't')
+				result = g_snprintf (writer->conversion, sizeof (writer->conversion), spec, va_arg (*args, gsize));
+			else if (nbre_long >= 2)
+				result = g_snprintf (writer->conversion, sizeof (writer->conversion), spec,
+									 va_arg (*args, unsigned long long));
+			else if (nbre_long == 1)
+				result = g_snprintf (writer->conversion, sizeof (writer->conversion), spec, va_arg (*args, gulong));
+			else
+				result = g_snprintf (writer->conversion, sizeof (writer->conversion), spec, va_arg (*args, guint));
+			break;
+		case 'c':
+			result = g_snprintf (writer->conversion, sizeof (writer->conversion), spec, va_arg (*args, gint));
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			if (size_modifier == 'L')
+				result = g_snprintf (writer->conversion, sizeof (writer->conversion), spec, va_arg (*args, long double));
+			else
+				result = g_snprintf (writer->conversion, sizeof (writer->conversion), spec, va_arg (*args, gdouble));
+			break;
+		case 's':
+			{
+				const gchar *text;
+				const gchar *end;
+				gsize text_length;
+				gsize padding;
+
+				/* the width and the precision are applied here because the string
+				 * can be longer than the buffer, it is escaped after that */
+				text = va_arg (*args, const gchar *);
+				if (!text)
+					text = "(null)";
+				if (width < 0)
+				{
+					left_align = TRUE;
+					width = -width;
+				}
+				if (precision < 0)
+					text_length = strlen (text);
+				else if ((end = memchr (text, 0, precision)))
+					text_length = end - text;
+				else
+					text_length = precision;
+				padding = ((gsize) width > text_length) ? width - text_length : 0;
+
+				if (left_align)
+					gsb_file_save_writer_write_escaped (writer, text, text_length);
+				for (; padding > 0; padding--)
+					gsb_file_save_writer_write (writer, " ", 1);
+				if (!left_align)
+					gsb_file_save_writer_write_escaped (writer, text, text_length);
+
+				return ptr + 1;
+			}
+		case 'p':
+			result = g_snprintf (writer->conversion, sizeof (writer->conversion), spec, va_arg (*args, gpointer));
+			break;
+		default:
+			g_warning ("gsb_file_save_writer_printf: unknown conversion in '%s'", conversion);
 
-	iterator = gsb_file_save_partial_balance_part (iterator,
-						&length_calculated,
-						&file_content);
+			return NULL;
+	}
 
-	iterator = gsb_file_save_bet_part (iterator,
-                        &length_calculated,
-                        &file_content);
+	if (result < 0 || (gsize) result >= sizeof (writer->conversion))
+	{
+		g_warning ("gsb_file_save_writer_printf: conversion too long in '%s'", conversion);
 
-#ifdef HAVE_GOFFICE
-	iterator = gsb_file_save_bet_graph_part (iterator,
-						&length_calculated,
-						&file_content);
-#endif /* HAVE_GOFFICE */
+		return NULL;
+	}
+	gsb_file_save_writer_write (writer, writer->conversion, result);
 
-	iterator = gsb_file_save_report_part (iterator,
-					   &length_calculated,
-					   &file_content,
-					   FALSE);
+	return ptr + 1;
+}
 
-	/* finish the file */
-	iterator = gsb_file_save_append_part (iterator,
-					   &length_calculated,
-					   &file_content,
-					   my_strdup ("</Grisbi>"));
+/**
+ * write the end of the file and replace the file by the temporary file,
+ * without any message so it can be called by a thread
+ * the writer is freed
+ *
+ * \param writer
+ *
+ * \return 0 if the file is saved, the errno of the first error else
+ **/
+static gint gsb_file_save_writer_finish (GsbFileSaveWriter *writer)
+{
+	gint error;
 
-	/* crypt the file if asked */
-	if (w_etat->crypt_file)
+	if (writer->memory)
 	{
-#ifdef HAVE_SSL
-		{
-			iterator = gsb_file_util_crypt_file (filename, &file_content, TRUE, iterator);
-			if (!iterator)
-			{
-				g_free (file_content);
-				return FALSE;
-			}
-		}
-#else
-		{
-			gchar *text = _("This build of Grisbi does not support encryption.\n"
-							"Please recompile Grisbi with OpenSSL encryption enabled.");
-			gchar *hint;
-
-			g_free (file_content);
-			hint = g_strdup_printf (_("Cannot save encrypted file '%s'"), filename);
-			dialogue_error_hint (text, hint);
-			g_free (hint);
+		g_string_free (writer->memory, TRUE);
+		g_free (writer);
 
-			return FALSE;
-		}
-#endif
+		return 0;
 	}
 
-	/* the file is in memory, we can save it */
-	/* i didn't succeed to save a "proper" file with zlib without compression,
-	 * it always append some extra characters, so use glib without compression, and
-	 * zlib if compression */
-	if (compress)
+	gsb_file_save_writer_flush (writer);
+
+	if (writer->gz_file)
 	{
-		gzFile grisbi_file;
+		if (gzclose (writer->gz_file) != Z_OK && !writer->error)
+			writer->error = errno ? errno : EIO;
+	}
+	else if (close (writer->fd) == -1 && !writer->error)
+		writer->error = errno;
 
-		grisbi_file = gzopen (filename, "wb9");
+	/* all is written, we can replace the file */
+	if (!writer->error && g_rename (writer->tmp_filename, writer->filename) == -1)
+		writer->error = errno;
 
-		if (!grisbi_file
-		 ||
-		 !gzwrite (grisbi_file, file_content, (unsigned)iterator))
-		{
-			gchar* tmpstr = g_strdup_printf (_("Cannot save file '%s': %s"),
-				              filename,
-                              g_strerror(errno));
-            dialogue_error (tmpstr);
-            g_free (tmpstr);
-            g_free (file_content);
-            if (grisbi_file)
-                gzclose (grisbi_file);
-
-            return (FALSE);
-        }
+	if (writer->error)
+		g_unlink (writer->tmp_filename);
 
-        g_free (file_content);
-        gzclose (grisbi_file);
-    }
-    else
-    {
-        GError *error = NULL;
+	error = writer->error;
+	g_free (writer->filename);
+	g_free (writer->tmp_filename);
+	g_free (writer);
 
-        if (!g_file_set_contents (filename, file_content, iterator, &error))
-        {
-            gchar* tmpstr = g_strdup_printf (_("Cannot save file '%s': %s"),
-                              filename,
-                              error->message);
-            dialogue_error (tmpstr);
-            g_free (tmpstr);
-            g_error_free (error);
+	return error;
+}
 
-			return (FALSE);
-        }
-        g_free (file_content);
-    }
+/**
+ * get the permissions of the file before saving it, because the saved file
+ * replaces it
+ *
+ * \param filename
+ * \param buf a struct stat to fill with the permissions
+ *
+ * \return TRUE if the permissions will have to be set, FALSE to restore the permissions of buf
+ **/
+static gboolean gsb_file_save_get_permissions (const gchar *filename,
+											   struct stat *buf)
+{
+	if (g_file_test (filename, G_FILE_TEST_EXISTS))
+	{
+		/* the file exists, we need to get the chmod values because gtk will overwrite it */
+		if (stat (filename, buf) == -1)
+			/* stat couldn't get the information, so do as a new file
+			 * and we will set the good chmod */
+			return TRUE;
+		else
+			return FALSE;
+	}
+	else
+		/* the file doesn't exist, so we will set the only user chmod */
+		return TRUE;
+}
 
+/**
+ * set the permissions of the file after saving it
+ *
+ * \param filename
+ * \param do_chmod TRUE for a new file
+ * \param buf the permissions of the file before saving it
+ *
+ * \return
+ **/
+static void gsb_file_save_set_permissions (const gchar *filename,
+										   gboolean do_chmod,
+										   struct stat *buf)
+{
     /* if it's a new file, we set the permission */
     if (do_chmod)
     {
@@ -1992,66 +1984,558 @@ gboolean gsb_file_save_save_file (const gchar *filename,
 	}
     else
     {
-        /* it's not a new file but gtk overwrite the permissions
+        /* it's not a new file but the temporary file replaced it
          * so need to re-set the good permissions saved before */
 #if defined (_MINGW)
-        if (_chmod (filename, buf.st_mode) == -1)
+        if (_chmod (filename, buf->st_mode) == -1)
         {
             /* we couldn't set the chmod, set the default permission */
             _chmod (filename, _S_IREAD | _S_IWRITE);
         }
 #else
-        if (chmod (filename, buf.st_mode) == -1)
+        if (chmod (filename, buf->st_mode) == -1)
         {
             /* we couldn't set the chmod, set the default permission */
             (void)chmod (filename, S_IRUSR | S_IWUSR);
         }
         /* restores uid and gid */
-/*        chown (filename, buf.st_uid, buf.st_gid);
+/*        chown (filename, buf->st_uid, buf->st_gid);
 */#endif /*_MINGW */
     }
+}
+
+/**
+ * write the parts of the grisbi file or of an archive which are before the transactions
+ *
+ * \param writer
+ * \param archive_number 0 for complete file, the number of archive if export an archive
+ *
+ * \return
+ **/
+static void gsb_file_save_write_content_begin (GsbFileSaveWriter *writer,
+											   gint archive_number)
+{
+	/* begin the file whith xml markup */
+	gsb_file_save_writer_write (writer, "<?xml version=\"1.0\"?>\n<Grisbi>\n", -1);
+
+	gsb_file_save_general_part (writer, archive_number);
+
+	gsb_file_save_rgba_part (writer);
+
+	gsb_file_save_print_part (writer, archive_number);
+
+	gsb_file_save_currency_part (writer);
+
+	gsb_file_save_account_part (writer);
+
+	gsb_file_save_payment_part (writer);
+}
+
+/**
+ * write the parts of the grisbi file or of an archive which are after the transactions,
+ * the position of the payees, categories and budgets are kept in the writer
+ *
+ * \param writer
+ * \param archive_number 0 for complete file, the number of archive if export an archive
+ *
+ * \return
+ **/
+static void gsb_file_save_write_content_end (GsbFileSaveWriter *writer,
+											 gint archive_number)
+{
+	guint64 divisions_begin;
+
+	/* if we export an archive, no scheduled transactions */
+	if (!archive_number)
+		gsb_file_save_scheduled_part (writer);
+
+	divisions_begin = writer->position;
+	gsb_file_save_party_part (writer);
+
+	gsb_file_save_category_part (writer);
+
+	gsb_file_save_budgetary_part (writer);
+
+	/* keep the position of the parts which can be read from the cache of the file */
+	if (!archive_number)
+	{
+		writer->parts_position.divisions_begin = divisions_begin;
+		writer->parts_position.divisions_end = writer->position;
+	}
+
+	gsb_file_save_currency_link_part (writer);
+
+	gsb_file_save_bank_part (writer);
+
+	gsb_file_save_financial_year_part (writer);
+
+	/* if we export an archive, no archive information */
+	if (!archive_number)
+		gsb_file_save_archive_part (writer);
+
+	gsb_file_save_reconcile_part (writer);
+
+	gsb_file_save_import_rule_part (writer);
+
+	gsb_file_save_partial_balance_part (writer);
+
+	gsb_file_save_bet_part (writer);
+
+#ifdef HAVE_GOFFICE
+	gsb_file_save_bet_graph_part (writer);
+#endif /* HAVE_GOFFICE */
+
+	gsb_file_save_report_part (writer, FALSE);
+
+	/* finish the file */
+	gsb_file_save_writer_write (writer, "</Grisbi>", -1);
+}
+
+/**
+ * write all the parts of the grisbi file or of an archive
+ *
+ * \param writer
+ * \param archive_number 0 for complete file, the number of archive if export an archive
+ *
+ * \return
+ **/
+static void gsb_file_save_write_content (GsbFileSaveWriter *writer,
+										 gint archive_number)
+{
+	guint64 transactions_begin;
+
+	gsb_file_save_write_content_begin (writer, archive_number);
+
+	transactions_begin = writer->position;
+	gsb_file_save_transaction_part (writer, archive_number);
+
+	/* keep the position of the parts which can be read from the cache of the file */
+	if (!archive_number)
+	{
+		writer->parts_position.transactions_begin = transactions_begin;
+		writer->parts_position.transactions_end = writer->position;
+	}
+
+	gsb_file_save_write_content_end (writer, archive_number);
+}
+
+/**
+ * make the content of the grisbi file in memory, crypted if asked
+ *
+ * \param filename the name of the file, used to crypt the file
+ * \param archive_number 0 for complete file, the number of archive if export an archive
+ * \param length a pointer to fill with the length of the content
+ *
+ * \return the content of the file, to free, or NULL if problem
+ **/
+static gchar *gsb_file_save_make_content (const gchar *filename,
+										  gint archive_number,
+										  gulong *length)
+{
+	GsbFileSaveWriter *writer;
+	gchar *file_content;
+	GrisbiWinEtat *w_etat;
+
+	w_etat = grisbi_win_get_w_etat ();
+
+	writer = gsb_file_save_writer_new (NULL, FALSE);
+	gsb_file_save_write_content (writer, archive_number);
+	file_content = gsb_file_save_writer_free_to_memory (writer, length);
+
+	/* crypt the file if asked */
+	if (w_etat->crypt_file)
+	{
+#ifdef HAVE_SSL
+		*length = gsb_file_util_crypt_file (filename, &file_content, TRUE, *length);
+		if (!*length)
+		{
+			g_free (file_content);
+			return NULL;
+		}
+#else
+		gchar *text = _("This build of Grisbi does not support encryption.\n"
+						"Please recompile Grisbi with OpenSSL encryption enabled.");
+		gchar *hint;
+
+		g_free (file_content);
+		hint = g_strdup_printf (_("Cannot save encrypted file '%s'"), filename);
+		dialogue_error_hint (text, hint);
+		g_free (hint);
+
+		return NULL;
+#endif
+	}
+
+	return file_content;
+}
+
+/* a save made in background : the transactions are copied when the save
+ * is asked and the parts around them, which are small, are written in memory,
+ * then the thread formats the transactions and writes all the file */
+typedef struct _GsbFileSaveBackground GsbFileSaveBackground;
+
+struct _GsbFileSaveBackground
+{
+	gchar *					filename;
+	gboolean				compress;
+	gchar *					content_begin;		/* the parts before the transactions, or all the crypted file */
+	gulong					length_begin;
+	GsbFileCacheSnapshot *	snapshot;			/* the transactions, NULL if the file is crypted */
+	gchar *					content_end;		/* the parts after the transactions */
+	gulong					length_end;
+	GsbFileSavePartsPosition	parts_position;	/* the position of the divisions in content_end,
+												 * then in the file when it is written */
+	guint					modification_stamp;	/* run.file_modification_stamp when the save was asked */
+	gboolean				do_chmod;
+	struct stat				buf;
+	GsbFileSaveDoneFunc		done_func;
+	gpointer				user_data;
+	gint					error;				/* errno of the thread, set with thread_finished */
+	gboolean				thread_finished;	/* protected by background_mutex */
+};
+
+/* the save in background not finished, NULL if none */
+static GsbFileSaveBackground *background_save = NULL;
+
+/* to wait for the thread of the save in background */
+static GMutex background_mutex;
+static GCond background_cond;
+
+/**
+ * free a save in background
+ *
+ * \param background
+ *
+ * \return
+ **/
+static void gsb_file_save_background_free (GsbFileSaveBackground *background)
+{
+	g_free (background->filename);
+	g_free (background->content_begin);
+	g_free (background->content_end);
+	if (background->snapshot)
+		gsb_file_cache_snapshot_free (background->snapshot);
+	g_free (background);
+}
+
+/**
+ * write the file of a save in background, called in a thread
+ * only the content and the snapshot made before are used, no data of grisbi
+ *
+ * \param task
+ * \param source_object
+ * \param task_data the GsbFileSaveBackground
+ * \param cancellable
+ *
+ * \return
+ **/
+static void gsb_file_save_background_thread (GTask *task,
+											 gpointer source_object,
+											 gpointer task_data,
+											 GCancellable *cancellable)
+{
+	GsbFileSaveBackground *background;
+	GsbFileSaveWriter *writer;
+	gint64 trace_start;
+	gint error = 0;
+
+	background = (GsbFileSaveBackground *) task_data;
+	trace_start = gsb_trace_begin ();
+
+	writer = gsb_file_save_writer_open (background->filename, background->compress, &error);
+	if (writer)
+	{
+		gsb_file_save_writer_write (writer, background->content_begin, background->length_begin);
+		if (background->snapshot)
+		{
+			guint64 transactions_end;
+
+			background->parts_position.transactions_begin = writer->position;
+			gsb_file_cache_snapshot_save (writer, background->snapshot);
+			transactions_end = writer->position;
+			background->parts_position.transactions_end = transactions_end;
+			background->parts_position.divisions_begin += transactions_end;
+			background->parts_position.divisions_end += transactions_end;
+			gsb_file_save_writer_write (writer, background->content_end, background->length_end);
+		}
+		error = gsb_file_save_writer_finish (writer);
+	}
+	gsb_trace_end ("file_save_write", trace_start);
+
+	g_mutex_lock (&background_mutex);
+	background->error = error;
+	background->thread_finished = TRUE;
+	g_cond_broadcast (&background_cond);
+	g_mutex_unlock (&background_mutex);
+
+	g_task_return_int (task, error);
+}
+
+/**
+ * end a save in background in the main thread, when its thread is finished
+ *
+ * \param background
+ *
+ * \return
+ **/
+static void gsb_file_save_background_finish (GsbFileSaveBackground *background)
+{
+	background_save = NULL;
+
+	if (background->error)
+		gsb_file_save_show_error (background->filename, background->error);
+	else
+		gsb_file_save_set_permissions (background->filename, background->do_chmod, &background->buf);
+
+	run.file_is_saving = FALSE;
+
+	if (background->done_func)
+		background->done_func (background->filename,
+							   background->error == 0,
+							   run.file_modification_stamp != background->modification_stamp,
+							   &background->parts_position,
+							   background->user_data);
+}
+
+/**
+ * called in the main thread when a save in background is finished,
+ * nothing is done if gsb_file_save_wait_background () finished it before
+ *
+ * \param source_object
+ * \param result the GTask
+ * \param user_data the GsbFileSaveBackground
+ *
+ * \return
+ **/
+static void gsb_file_save_background_done (GObject *source_object,
+										   GAsyncResult *result,
+										   gpointer user_data)
+{
+	GsbFileSaveBackground *background;
+
+	background = (GsbFileSaveBackground *) user_data;
+	g_task_propagate_int (G_TASK (result), NULL);
+
+	if (background_save == background)
+		gsb_file_save_background_finish (background);
+
+	gsb_file_save_background_free (background);
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * save the grisbi file or an archive
+ * we don't check anything here, all must be done before, here we just write
+ * the file and set the permissions
+ *
+ * an archive file is a normal grisbi file, but only with the wanted archived transactions
+ * and without scheduled transactions
+ *
+ * \param filename the name of the file
+ * \param compress TRUE if we want to compress the file
+ * \param archive_number 0 for complete file, the number of archive if export an archive
+ * \param parts_position the position of the parts written in the file to fill, or NULL,
+ * the positions are 0 for an archive or a crypted file
+ *
+ * \return TRUE : ok, FALSE : problem
+ **/
+gboolean gsb_file_save_save_file (const gchar *filename,
+								  gboolean compress,
+								  gint archive_number,
+								  GsbFileSavePartsPosition *parts_position)
+{
+	GsbFileSavePartsPosition written_position = {0};
+	gint do_chmod;
+	GsbFileSaveWriter *writer;
+	struct stat buf;
+	gint64 trace_start;
+	GrisbiWinEtat *w_etat;
+
+	devel_debug (filename);
+	w_etat = grisbi_win_get_w_etat ();
+
+	/* a save in background could replace the file after this one */
+	gsb_file_save_wait_background ();
+
+	trace_start = gsb_trace_begin ();
+
+	do_chmod = gsb_file_save_get_permissions (filename, &buf);
+
+	run.file_is_saving = TRUE;
+
+	if (w_etat->crypt_file)
+	{
+		gchar *file_content;
+		gulong length;
+
+		/* the crypt needs all the file in memory */
+		file_content = gsb_file_save_make_content (filename, archive_number, &length);
+		if (!file_content)
+		{
+			run.file_is_saving = FALSE;
+
+			return FALSE;
+		}
+
+		writer = gsb_file_save_writer_new (filename, compress);
+		if (writer)
+			gsb_file_save_writer_write (writer, file_content, length);
+		g_free (file_content);
+	}
+	else
+	{
+		/* the file is written directly in a temporary file, by blocks */
+		writer = gsb_file_save_writer_new (filename, compress);
+		if (writer)
+		{
+			gsb_file_save_write_content (writer, archive_number);
+			written_position = writer->parts_position;
+		}
+	}
+
+	if (!writer || !gsb_file_save_writer_close (writer))
+	{
+		run.file_is_saving = FALSE;
+
+		return FALSE;
+	}
+
+	gsb_file_save_set_permissions (filename, do_chmod, &buf);
+	if (parts_position)
+		*parts_position = written_position;
 
     run.file_is_saving = FALSE;
+	gsb_trace_end ("file_save", trace_start);
 
     return (TRUE);
 }
 
 /**
- * add the string given in arg and
- * check if we don't go throw the upper limit of file_content
- * if yes, we reallocate it
+ * save the grisbi file without blocking the gui
+ * the data are copied now, so the file saved is the state of the data when
+ * this function is called : the transactions are copied in a snapshot and the
+ * other parts, which are small, are written in memory. Then the transactions
+ * are formatted and the file is compressed and written by a thread, done_func
+ * is called in the main loop when finished.
+ * a crypted file is made and crypted now, the thread only writes it.
+ * the modifications made during the save are not in the file, done_func is told
+ * about them so it can let the file modified
  *
- * \param file_content the file content
- * \param iterator the current iterator
- * \param new_string the string we want to add, it will be freed by this function. Do not free it again !
+ * \param filename the name of the file
+ * \param compress TRUE if we want to compress the file
+ * \param done_func the function called when the file is saved, or NULL
+ * \param user_data data given to done_func
  *
- * \return the new iterator
+ * \return TRUE if the save is started, FALSE : problem
  **/
-gulong gsb_file_save_append_part (gulong iterator,
-								  gulong *length_calculated,
-								  gchar **file_content,
-								  gchar *new_string)
+gboolean gsb_file_save_save_file_in_background (const gchar *filename,
+												gboolean compress,
+												GsbFileSaveDoneFunc done_func,
+												gpointer user_data)
 {
-	if (!new_string)
-		return iterator;
+	GsbFileSaveBackground *background;
+	GTask *task;
+	gint64 trace_start;
+	GrisbiWinEtat *w_etat;
 
-	/* we check first if we don't go throw the upper limit */
+	devel_debug (filename);
+	w_etat = grisbi_win_get_w_etat ();
+
+	/* only one save at a time */
+	gsb_file_save_wait_background ();
+
+	background = g_malloc0 (sizeof (GsbFileSaveBackground));
+	background->do_chmod = gsb_file_save_get_permissions (filename, &background->buf);
 
-	while ((iterator + strlen (new_string)) >= *length_calculated)
+	run.file_is_saving = TRUE;
+
+	trace_start = gsb_trace_begin ();
+	if (w_etat->crypt_file)
 	{
-		/* we change the size by adding half of length_calculated */
+		/* the crypt needs all the file in memory and can ask a password */
+		background->content_begin = gsb_file_save_make_content (filename, 0, &background->length_begin);
+		if (!background->content_begin)
+		{
+			gsb_trace_end ("file_save_content", trace_start);
+			g_free (background);
+			run.file_is_saving = FALSE;
 
-		*length_calculated = 1.5 * *length_calculated;
-		*file_content = g_realloc (*file_content, *length_calculated);
+			return FALSE;
+		}
+	}
+	else
+	{
+		GsbFileSaveWriter *writer;
+
+		writer = gsb_file_save_writer_new (NULL, FALSE);
+		gsb_file_save_write_content_begin (writer, 0);
+		background->content_begin = gsb_file_save_writer_free_to_memory (writer, &background->length_begin);
+
+		background->snapshot = gsb_file_cache_snapshot_new ();
 
-		notice_debug ("The length calculated for saving file should be bigger?");
+		/* the positions of the divisions are relative to the end of the transactions */
+		writer = gsb_file_save_writer_new (NULL, FALSE);
+		gsb_file_save_write_content_end (writer, 0);
+		background->parts_position = writer->parts_position;
+		background->content_end = gsb_file_save_writer_free_to_memory (writer, &background->length_end);
 	}
+	gsb_trace_end ("file_save_content", trace_start);
 
-	memcpy (*file_content + iterator, new_string, strlen (new_string));
-	iterator = iterator + strlen (new_string);
-	g_free (new_string);
+	background->filename = g_strdup (filename);
+	background->compress = compress;
+	background->modification_stamp = run.file_modification_stamp;
+	background->done_func = done_func;
+	background->user_data = user_data;
+	background_save = background;
+
+	task = g_task_new (NULL, NULL, gsb_file_save_background_done, background);
+	g_task_set_task_data (task, background, NULL);
+	g_task_run_in_thread (task, gsb_file_save_background_thread);
+	g_object_unref (task);
 
-	return iterator;
+	return TRUE;
+}
+
+/**
+ * wait for the end of the save in background if there is one
+ * the main loop is not run, the thread uses no data of grisbi
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_file_save_wait_background (void)
+{
+	if (!background_save)
+		return;
+
+	g_mutex_lock (&background_mutex);
+	while (!background_save->thread_finished)
+		g_cond_wait (&background_cond, &background_mutex);
+	g_mutex_unlock (&background_mutex);
+
+	/* the callback of the task will only free it */
+	gsb_file_save_background_finish (background_save);
+}
+
+/**
+ * add the string given in arg to the file
+ *
+ * \param writer the writer of the file
+ * \param new_string the string we want to add, it will be freed by this function. Do not free it again !
+ *
+ * \return
+ **/
+void gsb_file_save_append_part (GsbFileSaveWriter *writer,
+								gchar *new_string)
+{
+	if (!new_string)
+		return;
+
+	gsb_file_save_writer_write (writer, new_string, -1);
+	g_free (new_string);
 }
 
 /**
@@ -2075,15 +2559,11 @@ const gchar *my_safe_null_str (const gchar *string)
 /**
  * save the budgetaries
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-gulong gsb_file_save_budgetary_part (gulong iterator,
-									 gulong *length_calculated,
-									 gchar **file_content)
+void gsb_file_save_budgetary_part (GsbFileSaveWriter *writer)
 {
     GSList *list_tmp;
 
@@ -2091,7 +2571,6 @@ gulong gsb_file_save_budgetary_part (gulong iterator,
 
     while (list_tmp)
     {
-		gchar *new_string;
 		gchar *tmp_str;
 		gint budget_number;
 		GSList *sub_list_tmp;
@@ -2100,18 +2579,12 @@ gulong gsb_file_save_budgetary_part (gulong iterator,
 
 		/* now we can fill the file content */
 		tmp_str = gsb_data_budget_get_name (budget_number, 0, "(null)");
-		new_string = g_markup_printf_escaped ("\t<Budgetary Nb=\"%d\" Na=\"%s\" Kd=\"%d\" />\n",
+		gsb_file_save_writer_printf (writer, "\t<Budgetary Nb=\"%d\" Na=\"%s\" Kd=\"%d\" />\n",
 										  budget_number,
 										  tmp_str,
 										  gsb_data_budget_get_type (budget_number));
 		g_free (tmp_str);
 
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-										      file_content,
-											  new_string);
-
 		/* save the sub-budgetaries */
 		sub_list_tmp = gsb_data_budget_get_sub_budget_list (budget_number);
 
@@ -2123,38 +2596,26 @@ gulong gsb_file_save_budgetary_part (gulong iterator,
 
 			/* now we can fill the file content carrefull : the number of budget must be the first */
 			tmp_str = gsb_data_budget_get_sub_budget_name (budget_number, sub_budget_number, "(null)");
-			new_string = g_markup_printf_escaped ("\t<Sub_budgetary Nbb=\"%d\" Nb=\"%d\" Na=\"%s\" />\n",
+			gsb_file_save_writer_printf (writer, "\t<Sub_budgetary Nbb=\"%d\" Nb=\"%d\" Na=\"%s\" />\n",
 												  budget_number,
 												  sub_budget_number,
 												  tmp_str);
 
-			/* append the new string to the file content and take the new iterator */
-			iterator = gsb_file_save_append_part (iterator,
-												  length_calculated,
-												  file_content,
-												  new_string);
-
 			sub_list_tmp = sub_list_tmp->next;
 		}
 
 		list_tmp = list_tmp->next;
     }
-
-	return iterator;
 }
 
 /**
  * save the categories
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  *
- * \return the new iterator
+ * \return
  **/
-gulong gsb_file_save_category_part (gulong iterator,
-									gulong *length_calculated,
-									gchar **file_content)
+void gsb_file_save_category_part (GsbFileSaveWriter *writer)
 {
     GSList *list_tmp;
 
@@ -2162,7 +2623,6 @@ gulong gsb_file_save_category_part (gulong iterator,
 
     while (list_tmp)
     {
-		gchar *new_string;
 		gchar *tmp_str;
 		gint category_number;
 		GSList *sub_list_tmp;
@@ -2171,18 +2631,12 @@ gulong gsb_file_save_category_part (gulong iterator,
 
 		/* now we can fill the file content */
 		tmp_str = gsb_data_category_get_name (category_number, 0, "(null)");
-		new_string = g_markup_printf_escaped ("\t<Category Nb=\"%d\" Na=\"%s\" Kd=\"%d\" />\n",
+		gsb_file_save_writer_printf (writer, "\t<Category Nb=\"%d\" Na=\"%s\" Kd=\"%d\" />\n",
 											  category_number,
 											  tmp_str,
 											  gsb_data_category_get_type (category_number));
 		g_free (tmp_str);
 
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-										      file_content,
-											  new_string);
-
 		/* save the sub-categories */
 		sub_list_tmp = gsb_data_category_get_sub_category_list (category_number);
 
@@ -2194,25 +2648,17 @@ gulong gsb_file_save_category_part (gulong iterator,
 
 			/* now we can fill the file content carrefull : the number of category must be the first */
 			tmp_str = gsb_data_category_get_sub_category_name (category_number, sub_category_number, "(null)");
-			new_string = g_markup_printf_escaped ("\t<Sub_category Nbc=\"%d\" Nb=\"%d\" Na=\"%s\" />\n",
+			gsb_file_save_writer_printf (writer, "\t<Sub_category Nbc=\"%d\" Nb=\"%d\" Na=\"%s\" />\n",
 												  category_number,
 												  sub_category_number,
 												  tmp_str);
 			g_free (tmp_str);
 
-			/* append the new string to the file content and take the new iterator */
-			iterator = gsb_file_save_append_part (iterator,
-												  length_calculated,
-												  file_content,
-												  new_string);
-
 			sub_list_tmp = sub_list_tmp->next;
 		}
 
 		list_tmp = list_tmp->next;
     }
-
-	return iterator;
 }
 
 /**
@@ -2262,16 +2708,12 @@ gboolean gsb_file_save_css_local_file (const gchar *css_data)
 /**
  * save the reports
  *
- * \param iterator the current iterator
- * \param length_calculated a pointer to the variable lengh_calculated
- * \param file_content a pointer to the variable file_content
+ * \param writer the writer of the file
  * \param current_report if TRUE, only save the current report (to exporting a report)
  *
- * \return the new iterator
+ * \return
  **/
-gulong gsb_file_save_report_part (gulong iterator,
-								  gulong *length_calculated,
-								  gchar **file_content,
+void gsb_file_save_report_part (GsbFileSaveWriter *writer,
 								  gboolean current_report)
 {
 	GSList *list_tmp;
@@ -2280,7 +2722,6 @@ gulong gsb_file_save_report_part (gulong iterator,
 
 	while (list_tmp)
 	{
-		gchar *new_string;
 		gint report_number;
 		gint report_number_to_write;
 		GSList *tmp_list;
@@ -2563,7 +3004,7 @@ gulong gsb_file_save_report_part (gulong iterator,
 		date_end = gsb_format_gdate_safe (gsb_data_report_get_personal_date_end (report_number));
 
 		/* now we can fill the file content */
-		new_string = g_markup_printf_escaped ("\t<Report\n"
+		gsb_file_save_writer_printf (writer, "\t<Report\n"
 											  "\t\tNb=\"%d\"\n"
 											  "\t\tName=\"%s\"\n"
 											  "\t\tCompl_name_function=\"%d\"\n"
@@ -2747,12 +3188,6 @@ gulong gsb_file_save_report_part (gulong iterator,
 		g_free (date_start);
 		g_free (date_end);
 
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-											  file_content,
-											  new_string);
-
 		/* save the text comparison */
 		list_tmp_2 = gsb_data_report_get_text_comparison_list (report_number);
 
@@ -2771,7 +3206,7 @@ gulong gsb_file_save_report_part (gulong iterator,
 				text_comparison_number_to_write = text_comparison_number;
 
 			/* now we can fill the file content */
-			new_string = g_markup_printf_escaped ("\t<Text_comparison\n"
+			gsb_file_save_writer_printf (writer, "\t<Text_comparison\n"
 												  "\t\tComparison_number=\"%d\"\n"
 												  "\t\tReport_nb=\"%d\"\n"
 												  "\t\tLast_comparison=\"%d\"\n"
@@ -2807,12 +3242,6 @@ gulong gsb_file_save_report_part (gulong iterator,
 												  gsb_data_report_text_comparison_get_second_amount
 												  (text_comparison_number));
 
-		/* append the new string to the file content and take the new iterator */
-		iterator = gsb_file_save_append_part (iterator,
-											  length_calculated,
-											  file_content,
-											  new_string);
-
 			list_tmp_2 = list_tmp_2->next;
 		}
 
@@ -2822,8 +3251,8 @@ gulong gsb_file_save_report_part (gulong iterator,
 		while (list_tmp_2)
 		{
 			gint amount_comparison_number;
-			gchar *first_amount;
-			gchar *second_amount;
+			gchar first_amount[GSB_REAL_SAFE_STRING_SIZE];
+			gchar second_amount[GSB_REAL_SAFE_STRING_SIZE];
 			gint floating_point;
 
 			amount_comparison_number = GPOINTER_TO_INT (list_tmp_2->data);
@@ -2839,15 +3268,17 @@ gulong gsb_file_save_report_part (gulong iterator,
 			/* set the numbers */
 			floating_point = gsb_data_currency_get_floating_point (gsb_data_report_get_currency_general
 																   (report_number));
-			first_amount = gsb_real_safe_real_to_string (gsb_data_report_amount_comparison_get_first_amount
-														 (amount_comparison_number),
-														 floating_point);
-			second_amount = gsb_real_safe_real_to_string (gsb_data_report_amount_comparison_get_second_amount
-														  (amount_comparison_number),
-														  floating_point);
+			gsb_real_safe_real_to_buffer (gsb_data_report_amount_comparison_get_first_amount
+										  (amount_comparison_number),
+										  floating_point,
+										  first_amount);
+			gsb_real_safe_real_to_buffer (gsb_data_report_amount_comparison_get_second_amount
+										  (amount_comparison_number),
+										  floating_point,
+										  second_amount);
 
 			/* now we can fill the file content */
-			new_string = g_markup_printf_escaped ("\t<Amount_comparison\n"
+			gsb_file_save_writer_printf (writer, "\t<Amount_comparison\n"
 												  "\t\tComparison_number=\"%d\"\n"
 												  "\t\tReport_nb=\"%d\"\n"
 												  "\t\tLast_comparison=\"%d\"\n"
@@ -2869,19 +3300,186 @@ gulong gsb_file_save_report_part (gulong iterator,
 												  my_safe_null_str(first_amount),
 												  my_safe_null_str(second_amount));
 
-			g_free (first_amount);
-			g_free (second_amount);
-
-			/* append the new string to the file content and take the new iterator */
-			iterator = gsb_file_save_append_part (iterator, length_calculated, file_content, new_string);
-
 			list_tmp_2 = list_tmp_2->next;
 		}
 
 		list_tmp = list_tmp->next;
 	}
+}
+
+/**
+ * create a writer to save a file
+ * the file is written in a temporary file in the same directory which
+ * replaces the file when the writer is closed, so the file is never
+ * half saved
+ *
+ * \param filename the name of the file, NULL to write the file in memory
+ * \param compress TRUE to compress the file
+ *
+ * \return a new GsbFileSaveWriter or NULL if the file cannot be created
+ **/
+GsbFileSaveWriter *gsb_file_save_writer_new (const gchar *filename,
+											 gboolean compress)
+{
+	GsbFileSaveWriter *writer;
+	gint error = 0;
+
+	writer = gsb_file_save_writer_open (filename, compress, &error);
+	if (!writer)
+		gsb_file_save_show_error (filename, error);
+
+	return writer;
+}
+
+/**
+ * write a text to the file
+ *
+ * \param writer
+ * \param text
+ * \param length length of text, -1 if text is nul-terminated
+ *
+ * \return
+ **/
+void gsb_file_save_writer_write (GsbFileSaveWriter *writer,
+								 const gchar *text,
+								 gssize length)
+{
+	if (length < 0)
+		length = strlen (text);
+
+	writer->position += length;
+
+	if (writer->memory)
+	{
+		g_string_append_len (writer->memory, text, length);
+		return;
+	}
+
+	while (length > 0)
+	{
+		gsize part;
+
+		part = MIN ((gsize) length, GSB_FILE_SAVE_BUFFER_SIZE - writer->length);
+		memcpy (writer->buffer + writer->length, text, part);
+		writer->length += part;
+		text += part;
+		length -= part;
+
+		if (writer->length == GSB_FILE_SAVE_BUFFER_SIZE)
+			gsb_file_save_writer_flush (writer);
+	}
+}
+
+/**
+ * write a formatted text to the file, as g_markup_printf_escaped
+ * but without any allocation, the conversions of printf other than
+ * %d and %s are formatted in a buffer of the writer
+ * the strings are escaped
+ *
+ * \param writer
+ * \param format
+ * \param ... the values for the conversions of format
+ *
+ * \return
+ **/
+void gsb_file_save_writer_printf (GsbFileSaveWriter *writer,
+								  const gchar *format,
+								  ...)
+{
+	va_list args;
+	const gchar *ptr;
+	const gchar *start;
+
+	va_start (args, format);
+
+	ptr = start = format;
+	while (*ptr)
+	{
+		gchar number[24];
+		gint length;
+
+		if (*ptr != '%')
+		{
+			ptr++;
+			continue;
+		}
+
+		gsb_file_save_writer_write (writer, start, ptr - start);
+		ptr++;
+
+		switch (*ptr)
+		{
+			case 'd':
+				length = g_snprintf (number, sizeof (number), "%d", va_arg (args, gint));
+				gsb_file_save_writer_write (writer, number, length);
+				ptr++;
+				break;
+			case 's':
+				gsb_file_save_writer_write_escaped (writer, va_arg (args, const gchar *), -1);
+				ptr++;
+				break;
+			case '%':
+				gsb_file_save_writer_write (writer, "%", 1);
+				ptr++;
+				break;
+			default:
+				ptr = gsb_file_save_writer_write_conversion (writer, ptr, &args);
+				if (!ptr)
+				{
+					va_end (args);
+					return;
+				}
+		}
+		start = ptr;
+	}
+	gsb_file_save_writer_write (writer, start, ptr - start);
+
+	va_end (args);
+}
+
+/**
+ * close the writer, the temporary file replaces the file
+ * show an error message if the file cannot be written
+ * the writer is freed
+ *
+ * \param writer
+ *
+ * \return TRUE if the file is saved
+ **/
+gboolean gsb_file_save_writer_close (GsbFileSaveWriter *writer)
+{
+	gchar *filename;
+	gint error;
+
+	filename = g_strdup (writer->filename);
+	error = gsb_file_save_writer_finish (writer);
+	if (error)
+		gsb_file_save_show_error (filename, error);
+	g_free (filename);
+
+	return (error == 0);
+}
+
+/**
+ * free a writer created in memory and return the content of the file
+ *
+ * \param writer a writer created without filename
+ * \param length a pointer to fill with the length of the content
+ *
+ * \return the content of the file, to free
+ **/
+gchar *gsb_file_save_writer_free_to_memory (GsbFileSaveWriter *writer,
+											gulong *length)
+{
+	gchar *file_content;
+
+	g_return_val_if_fail (writer->memory, NULL);
+
+	*length = writer->memory->len;
+	file_content = g_string_free (writer->memory, FALSE);
+	g_free (writer);
 
-	return iterator;
+	return file_content;
 }
 
 /**
@@ -6,26 +6,57 @@
 /* START_INCLUDE_H */
 /* END_INCLUDE_H */
 
+typedef struct _GsbFileSaveWriter	GsbFileSaveWriter;
+typedef struct _GsbFileSavePartsPosition	GsbFileSavePartsPosition;
+
+/* position of the parts of the grisbi file kept in its cache,
+ * in bytes from the beginning of the uncompressed file */
+struct _GsbFileSavePartsPosition
+{
+	guint64		transactions_begin;
+	guint64		transactions_end;
+	guint64		divisions_begin;		/* payees, categories and budgets */
+	guint64		divisions_end;
+};
+
+/* called when a save in background is finished, file_changed is TRUE
+ * if the data were modified during the save, parts_position is the
+ * position of the parts in the file saved */
+typedef void (*GsbFileSaveDoneFunc) (const gchar *filename,
+									 gboolean saved,
+									 gboolean file_changed,
+									 const GsbFileSavePartsPosition *parts_position,
+									 gpointer user_data);
+
 
 /* START_DECLARATION */
-gulong			gsb_file_save_append_part		(gulong iterator,
-												 gulong *length_calculated,
-                        						 gchar **file_content,
+void			gsb_file_save_append_part		(GsbFileSaveWriter *writer,
                         						 gchar *new_string);
-gulong			gsb_file_save_budgetary_part	(gulong iterator,
-                        						 gulong *length_calculated,
-                        						 gchar **file_content);
-gulong			gsb_file_save_category_part		(gulong iterator,
-                        						 gulong *length_calculated,
-                        						 gchar **file_content);
+void			gsb_file_save_budgetary_part	(GsbFileSaveWriter *writer);
+void			gsb_file_save_category_part		(GsbFileSaveWriter *writer);
 gboolean		gsb_file_save_css_local_file	(const gchar *css_data);
-gulong			gsb_file_save_report_part		(gulong iterator,
-                        						 gulong *length_calculated,
-                        						 gchar **file_content,
+void			gsb_file_save_report_part		(GsbFileSaveWriter *writer,
                         						 gboolean current_report);
 gboolean		gsb_file_save_save_file			(const gchar *filename,
                         						 gboolean compress,
-                        						 gint archive_number);
+                        						 gint archive_number,
+                        						 GsbFileSavePartsPosition *parts_position);
+gboolean		gsb_file_save_save_file_in_background	(const gchar *filename,
+                        						 gboolean compress,
+                        						 GsbFileSaveDoneFunc done_func,
+                        						 gpointer user_data);
+void			gsb_file_save_wait_background	(void);
+gboolean		gsb_file_save_writer_close		(GsbFileSaveWriter *writer);
+gchar *			gsb_file_save_writer_free_to_memory	(GsbFileSaveWriter *writer,
+                        						 gulong *length);
+GsbFileSaveWriter *	gsb_file_save_writer_new	(const gchar *filename,
+                        						 gboolean compress);
+void			gsb_file_save_writer_printf		(GsbFileSaveWriter *writer,
+                        						 const gchar *format,
+                        						 ...) G_GNUC_PRINTF (2, 3);
+void			gsb_file_save_writer_write		(GsbFileSaveWriter *writer,
+                        						 const gchar *text,
+                        						 gssize length);
 const gchar *	my_safe_null_str				(const gchar *string);
 /* END_DECLARATION */
 
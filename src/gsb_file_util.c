@@ -48,6 +48,14 @@
 /*START_EXTERN*/
 /*END_EXTERN*/
 
+/* a file opened to be read by chunks */
+struct _GsbFileStream
+{
+    gzFile		file;
+    gchar *		os_filename;
+    goffset		file_size;			/* size on the disk, compressed or not */
+};
+
 /******************************************************************************/
 /* Public Methods                                                             */
 /******************************************************************************/
@@ -244,6 +252,131 @@ gboolean gsb_file_util_get_contents (const gchar *filename,
     return TRUE;
 }
 
+/**
+ * open a file, compressed with zlib or not, to read it by chunks
+ * without loading all the file in memory
+ *
+ * \param filename the name of file to open
+ *
+ * \return a new GsbFileStream to free with gsb_file_util_stream_close or NULL
+ **/
+GsbFileStream *gsb_file_util_stream_open (const gchar *filename)
+{
+    GsbFileStream *stream;
+    struct stat stat_buf;
+
+    stream = g_malloc0 (sizeof (GsbFileStream));
+
+#ifdef G_OS_WIN32
+	stream->os_filename = g_locale_from_utf8(filename, -1, NULL, NULL, NULL);
+#else
+	stream->os_filename = g_strdup(filename);
+#endif /* G_OS_WIN32 */
+
+    stream->file = gzopen (stream->os_filename, "rb");
+    if (!stream->file)
+	{
+		g_free (stream->os_filename);
+		g_free (stream);
+
+		return NULL;
+	}
+
+    /* the size is used only to show the progress of the reading */
+    if (stat (stream->os_filename, &stat_buf))
+    {
+		gchar *tmp_str;
+
+		tmp_str = g_strdup_printf (_("Grisbi cannot stat file %s, please check the file."),
+								   stream->os_filename);
+		dialogue_error (tmp_str);
+		g_free (tmp_str);
+		gsb_file_util_stream_close (stream);
+
+		return NULL;
+    }
+    stream->file_size = stat_buf.st_size;
+
+    return stream;
+}
+
+/**
+ * read the next chunk of an opened file, the file is uncompressed if necessary
+ *
+ * \param stream
+ * \param buffer the buffer to fill
+ * \param size the size of the buffer
+ *
+ * \return the number of bytes read, 0 at the end of the file, -1 if error
+ **/
+gssize gsb_file_util_stream_read (GsbFileStream *stream,
+								  gchar *buffer,
+								  gsize size)
+{
+    gint read_size;
+
+    read_size = gzread (stream->file, buffer, (unsigned) size);
+    if (read_size < 0)
+    {
+		gchar *tmp_str;
+		gint errnum;
+		const gchar *error_msg;
+
+		error_msg = gzerror (stream->file, &errnum);
+		if (errnum == Z_ERRNO)
+			error_msg = g_strerror (errno);
+
+		tmp_str = g_strdup_printf (_("Failed to read from file '%s': %s"),
+								   stream->os_filename,
+								   error_msg);
+		dialogue_error (tmp_str);
+		g_free (tmp_str);
+
+		return -1;
+    }
+
+    return read_size;
+}
+
+/**
+ * get the part of the file already read
+ *
+ * \param stream
+ *
+ * \return the percentage of the file read, between 0 and 100
+ **/
+gint gsb_file_util_stream_get_percent (GsbFileStream *stream)
+{
+    goffset offset;
+
+    if (stream->file_size <= 0)
+        return 100;
+
+    /* gzoffset gives the position in the file on the disk, compressed or not */
+    offset = gzoffset (stream->file);
+    if (offset >= stream->file_size)
+        return 100;
+
+    return (gint) (offset * 100 / stream->file_size);
+}
+
+/**
+ * close a file opened with gsb_file_util_stream_open
+ *
+ * \param stream
+ *
+ * \return
+ **/
+void gsb_file_util_stream_close (GsbFileStream *stream)
+{
+    if (!stream)
+        return;
+
+    gzclose (stream->file);
+    g_free (stream->os_filename);
+    g_free (stream);
+}
+
 /**
  * create or delete a file ".name_of_file.lock" to check if the file is opened
  * already or not
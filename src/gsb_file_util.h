@@ -6,6 +6,8 @@
 /* START_INCLUDE_H */
 /* END_INCLUDE_H */
 
+typedef struct _GsbFileStream	GsbFileStream;
+
 /* START_DECLARATION */
 void		gsb_file_util_change_permissions			(void);
 void		gsb_file_util_display_warning_permissions	(void);
@@ -14,6 +16,12 @@ gboolean	gsb_file_util_get_contents					(const gchar *filename,
 														 gulong *length);
 gboolean	gsb_file_util_modify_lock					(const gchar *filename,
 														 gboolean create_lock);
+void		gsb_file_util_stream_close					(GsbFileStream *stream);
+gint		gsb_file_util_stream_get_percent			(GsbFileStream *stream);
+GsbFileStream *	gsb_file_util_stream_open				(const gchar *filename);
+gssize		gsb_file_util_stream_read					(GsbFileStream *stream,
+														 gchar *buffer,
+														 gsize size);
 gboolean	gsb_file_util_test_overwrite 				(const gchar *filename);
 /* END_DECLARATION */
 #endif
@@ -47,6 +47,7 @@
 #include "gsb_data_payment.h"
 #include "gsb_data_report.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file_cache.h"
 #include "gsb_form.h"
 #include "gsb_form_widget.h"
 #include "gsb_payment_method.h"
@@ -267,7 +268,9 @@ gint gsb_form_transactions_look_for_last_party (gint no_party,
 	GrisbiAppConf *a_conf;
 
 	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
-    list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
+
+    /* the archives kept in the cache of the file are loaded only if the party is not found */
+    list_tmp_transactions = gsb_data_transaction_get_loaded_transactions_list ();
 
     while ( list_tmp_transactions )
     {
@@ -292,6 +295,10 @@ gint gsb_form_transactions_look_for_last_party (gint no_party,
     if ( last_transaction_with_party_in_account )
 	return last_transaction_with_party_in_account;
 
+    /* only the archives kept in the cache of the file with that party are loaded */
+    if ( gsb_file_cache_load_division_archives ( METATREE_PAYEE, no_party, -1 ) )
+	return gsb_form_transactions_look_for_last_party ( no_party, no_new_transaction, account_number );
+
     /* if we don't want to complete with a transaction in another account,
      * go away here */
     if ( a_conf->limit_completion_to_current_account )
@@ -314,8 +321,9 @@ gboolean gsb_form_transaction_recover_splits_of_transaction ( gint new_transacti
 {
     GSList *list_tmp_transactions;
 
-    /* go around the transactions list to get the daughters of the last split */
-    list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
+    /* go around the transactions list to get the daughters of the last split,
+     * they are loaded with their mother */
+    list_tmp_transactions = gsb_data_transaction_get_loaded_transactions_list ();
 
     while ( list_tmp_transactions )
     {
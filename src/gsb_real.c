@@ -48,6 +48,11 @@
 #define rint(x) (floor(x + 0.5))
 #endif /*G_OS_WIN32 */
 
+/* gsb_real_sum_mantissas adds blocks of GSB_REAL_SUM_BLOCK mantissas without checking
+ * the overflow when they are all lower than GSB_REAL_SUM_SAFE_MANTISSA (2^52) */
+#define GSB_REAL_SUM_BLOCK 1024
+#define GSB_REAL_SUM_SAFE_MANTISSA G_GUINT64_CONSTANT (0x10000000000000)
+
 /*START_STATIC*/
 /*END_STATIC*/
 
@@ -255,15 +260,12 @@ static gboolean gsb_real_grow_exponent (GsbReal *num,
 
     while (exponent < target_exponent)
     {
-        gint64 new_mantissa;
-
-        new_mantissa = mantissa * 10;
-        if ((new_mantissa > G_MAXINT64) || (new_mantissa < G_MININT64))
+        if ((mantissa > G_MAXINT64 / 10) || (mantissa < G_MININT64 / 10))
         {
             succes = FALSE;
             break;
         }
-        mantissa = new_mantissa;
+        mantissa = mantissa * 10;
         ++exponent;
     }
     num->mantissa = mantissa;
@@ -320,6 +322,67 @@ static gboolean gsb_real_raw_truncate_number (gint64 *mantissa,
     }
 }
 
+/**
+ * add 2 mantissas and check the overflow
+ * the result G_MININT64 is an overflow too because it's the mantissa of error_real
+ *
+ * \param mantissa_1
+ * \param mantissa_2
+ * \param result a pointer to the sum
+ *
+ * \return FALSE if the sum doesn't fit in 64 bits
+ **/
+static inline gboolean gsb_real_raw_add_mantissas (gint64 mantissa_1,
+												   gint64 mantissa_2,
+												   gint64 *result)
+{
+#if (defined (__GNUC__) && __GNUC__ >= 5) || defined (__clang__)
+	if (__builtin_add_overflow (mantissa_1, mantissa_2, result))
+		return FALSE;
+#else
+	if ((mantissa_2 > 0 && mantissa_1 > G_MAXINT64 - mantissa_2)
+		|| (mantissa_2 < 0 && mantissa_1 < G_MININT64 - mantissa_2))
+		return FALSE;
+	*result = mantissa_1 + mantissa_2;
+#endif
+
+	return *result != G_MININT64;
+}
+
+/**
+ * add 2 mantissas with the same exponent when the sum doesn't fit in 64 bits :
+ * the sum is written with one digit less after the point, only if that digit is 0
+ *
+ * \param mantissa_1
+ * \param mantissa_2
+ * \param exponent
+ *
+ * \return the exact sum, error_real if the exponent is already 0 or if the last digit isn't 0
+ **/
+static GsbReal gsb_real_raw_add_truncated (gint64 mantissa_1,
+										   gint64 mantissa_2,
+										   gint exponent)
+{
+	GsbReal number;
+	gint last_digits;
+
+	if (exponent <= 0)
+		return error_real;
+
+	/* an overflow happens only with 2 numbers of the same sign,
+	 * so the last digits have the same sign too */
+	last_digits = mantissa_1 % 10 + mantissa_2 % 10;
+	if (last_digits % 10)
+		return error_real;
+
+	number.mantissa = mantissa_1 / 10 + mantissa_2 / 10 + last_digits / 10;
+	number.exponent = exponent - 1;
+	if (number.mantissa == error_real.mantissa)
+		return error_real;
+
+	return number;
+}
+
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
@@ -769,16 +832,18 @@ GsbReal gsb_real_add (GsbReal number_1,
     gint64 mantissa;
 
     if ((number_1.mantissa == error_real.mantissa)
-      || (number_2.mantissa == error_real.mantissa)
-      || !gsb_real_normalize (&number_1, &number_2))
+      || (number_2.mantissa == error_real.mantissa))
 		return error_real;
 
-	mantissa = (gint64) number_1.mantissa + number_2.mantissa;
-    if ((mantissa > G_MAXINT64) || (mantissa < G_MININT64))
-    {
-        if (!gsb_real_raw_truncate_number (&mantissa, &number_1.exponent))
-            return error_real;
-    }
+	/* the amounts of a currency have usually the same exponent,
+	 * there is nothing to normalize */
+	if (number_1.exponent != number_2.exponent
+		&& !gsb_real_normalize (&number_1, &number_2))
+		return error_real;
+
+	if (!gsb_real_raw_add_mantissas (number_1.mantissa, number_2.mantissa, &mantissa))
+		return gsb_real_raw_add_truncated (number_1.mantissa, number_2.mantissa, number_1.exponent);
+
     number_1.mantissa = mantissa;
 
     return number_1;
@@ -799,6 +864,91 @@ GsbReal gsb_real_sub (GsbReal number_1,
     return gsb_real_add (number_1, number_2);
 }
 
+/**
+ * append the mantissa of a number with the exponent of the sum
+ * to an array of mantissas for gsb_real_sum_mantissas ()
+ *
+ * \param mantissas a GArray of gint64
+ * \param number
+ * \param exponent the exponent of the sum
+ *
+ * \return
+ **/
+void gsb_real_append_mantissa (GArray *mantissas,
+							   GsbReal number,
+							   gint exponent)
+{
+	gint64 mantissa;
+
+	if (number.mantissa == error_real.mantissa)
+		mantissa = error_real.mantissa;
+	else
+		mantissa = gsb_real_adjust_exponent (number, exponent).mantissa;
+
+	g_array_append_val (mantissas, mantissa);
+}
+
+/**
+ * sum an array of mantissas which have the same exponent,
+ * as gsb_real_add would do one by one but faster :
+ * the mantissas are added by blocks which can't overflow,
+ * in a loop the compiler can vectorize
+ *
+ * \param mantissas
+ * \param nbre_mantissas
+ * \param exponent the exponent of all the mantissas
+ *
+ * \return the sum, error_real if a mantissa is error_real or if the sum is too big
+ **/
+GsbReal gsb_real_sum_mantissas (const gint64 *mantissas,
+								gsize nbre_mantissas,
+								gint exponent)
+{
+	GsbReal total = {0, exponent};
+	gsize i = 0;
+
+	while (i < nbre_mantissas)
+	{
+		guint64 sum = 0;
+		guint64 bits = 0;
+		gsize end;
+		gsize j;
+
+		end = MIN (nbre_mantissas, i + GSB_REAL_SUM_BLOCK);
+
+		/* bits has the bits of the absolute values (minus 1 for the negatives) */
+		for (j = i; j < end; j++)
+		{
+			sum += (guint64) mantissas[j];
+			bits |= (guint64) (mantissas[j] ^ (mantissas[j] >> 63));
+		}
+
+		if (bits < GSB_REAL_SUM_SAFE_MANTISSA)
+		{
+			GsbReal block = {(gint64) sum, exponent};
+
+			total = gsb_real_add (total, block);
+		}
+		else
+		{
+			/* big numbers or error_real in the block, one by one */
+			for (j = i; j < end; j++)
+			{
+				GsbReal number = {mantissas[j], exponent};
+
+				total = gsb_real_add (total, number);
+			}
+		}
+
+		if (total.mantissa == error_real.mantissa)
+			return error_real;
+
+		i = end;
+	}
+
+	return total;
+}
+
 /**
  * return the opposite of the number
  * ie 5 returns -5 in GsbReal number
@@ -906,32 +1056,38 @@ GsbReal gsb_real_double_to_real (gdouble number)
 }
 
 /**
- * retourne une chaine représentative d'un nombre avec le point comme séparateur décimal
- * et pas de separateur de milliers
+ * écrit dans le buffer donné la chaine représentative d'un nombre avec le point
+ * comme séparateur décimal et pas de separateur de milliers, sans allocation
  *
- * The returned string should be freed with g_free() when no longer needed.
+ * \param number
+ * \param default_exponent	exposant de la chaine, -1 pour celui du nombre
+ * \param buffer			un buffer de GSB_REAL_SAFE_STRING_SIZE caractères
  *
- * \return
+ * \return buffer
  **/
-gchar *gsb_real_safe_real_to_string (GsbReal number,
-									 gint default_exponent)
+gchar *gsb_real_safe_real_to_buffer (GsbReal number,
+									 gint default_exponent,
+									 gchar *buffer)
 {
-    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+    gchar partie_entiere[G_ASCII_DTOSTR_BUF_SIZE];
     gchar format[40];
-    gchar *result = NULL;
-    gchar *partie_entiere;
     const gchar *sign;
     const gchar *mon_decimal_point;
-    gint nbre_char;
     lldiv_t units;
 
     if ((number.exponent < 0)
     || (number.exponent >= EXPONENT_MAX)
     || (number.mantissa == error_real.mantissa))
-      return g_strdup (ERROR_REAL_STRING);
+    {
+        g_strlcpy (buffer, ERROR_REAL_STRING, GSB_REAL_SAFE_STRING_SIZE);
+        return buffer;
+    }
 
     if (number.mantissa == 0)
-        return g_strdup ("0.00");
+    {
+        g_strlcpy (buffer, "0.00", GSB_REAL_SAFE_STRING_SIZE);
+        return buffer;
+    }
 
     if (default_exponent != -1)
         number = gsb_real_adjust_exponent (number, default_exponent);
@@ -941,19 +1097,29 @@ gchar *gsb_real_safe_real_to_string (GsbReal number,
 
     units = lldiv (llabs (number.mantissa), gsb_real_get_power_10 (number.exponent));
 
-    nbre_char = g_sprintf (buffer, "%.0f", (gdouble) units.quot);
-
-    partie_entiere = g_strndup (buffer, nbre_char);
+    g_snprintf (partie_entiere, sizeof (partie_entiere), "%.0f", (gdouble) units.quot);
 
     g_snprintf (format, sizeof (format), "%s%d%s", "%s%s%s%0", number.exponent, "lld");
 
-    result = g_strdup_printf (format, sign, partie_entiere, mon_decimal_point, units.rem);
-    g_free (partie_entiere);
+    g_snprintf (buffer, GSB_REAL_SAFE_STRING_SIZE, format, sign, partie_entiere, mon_decimal_point, units.rem);
 
-/*     printf ("number.mantissa = %lld number.exponent = %d résultat = %s\n",
- *                         number.mantissa, number.exponent, result);
- */
-    return result;
+    return buffer;
+}
+
+/**
+ * retourne une chaine représentative d'un nombre avec le point comme séparateur décimal
+ * et pas de separateur de milliers
+ *
+ * The returned string should be freed with g_free() when no longer needed.
+ *
+ * \return
+ **/
+gchar *gsb_real_safe_real_to_string (GsbReal number,
+									 gint default_exponent)
+{
+    gchar buffer[GSB_REAL_SAFE_STRING_SIZE];
+
+    return g_strdup (gsb_real_safe_real_to_buffer (number, default_exponent, buffer));
 }
 
 /**
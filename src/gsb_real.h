@@ -6,6 +6,7 @@
 
 #define EXPONENT_MAX 15
 #define ERROR_REAL_STRING "###ERR###"
+#define GSB_REAL_SAFE_STRING_SIZE 48		/* size of the buffer of gsb_real_safe_real_to_buffer () */
 
 /* structure describe a real number. */
 typedef struct _GsbReal		GsbReal;
@@ -28,6 +29,9 @@ GsbReal		gsb_real_add					(GsbReal number_1,
                         					 GsbReal number_2);
 GsbReal		gsb_real_adjust_exponent		(GsbReal number,
                         					 gint return_exponent);
+void		gsb_real_append_mantissa		(GArray *mantissas,
+											 GsbReal number,
+											 gint exponent);
 gint		gsb_real_cmp					(GsbReal number_1,
                         					 GsbReal number_2);
 GsbReal		gsb_real_div					(GsbReal number_1,
@@ -48,9 +52,15 @@ GsbReal		gsb_real_raw_get_from_string	(const gchar *string,
                                         	 const gchar *mon_decimal_point);
 gdouble		gsb_real_real_to_double			(GsbReal number);
 GsbReal		gsb_real_safe_real_from_string	(const gchar *string);
+gchar *		gsb_real_safe_real_to_buffer	(GsbReal number,
+											 gint default_exponent,
+											 gchar *buffer);
 gchar *		gsb_real_safe_real_to_string 	(GsbReal number,
 											 gint default_exponent);
 GsbReal		gsb_real_sub					(GsbReal number_1,
                         					 GsbReal number_2);
+GsbReal		gsb_real_sum_mantissas			(const gint64 *mantissas,
+											 gsize nbre_mantissas,
+											 gint exponent);
 /* END_DECLARATION */
 #endif
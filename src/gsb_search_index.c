@@ -0,0 +1,640 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*     Copyright (C)    2000-2008 Cédric Auger (cedric@grisbi.org)            */
+/*          2003-2009 Benjamin Drieu (bdrieu@april.org)                       */
+/*          2008-2021 Pierre Biava (grisbi@pierre.biava.name)                 */
+/*          https://www.grisbi.org/                                           */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file gsb_search_index.c
+ * index of the transactions for the search dialog
+ *
+ * the index keeps, for all the transactions (archived or not) :
+ * - the trigrams of the normalized notes, voucher, bank references and
+ *   cheque number, with for each trigram the transactions which have it
+ * - the transactions of each payee
+ * - the transactions sorted by amount
+ * it's built at the first search ; after that the data of the transactions call
+ * gsb_search_index_mark_transaction () when they change and the marked
+ * transactions are indexed again before the next search.
+ * the index only gives candidates, the search checks them with the real data.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+#include <string.h>
+
+/*START_INCLUDE*/
+#include "gsb_search_index.h"
+#include "gsb_data_transaction.h"
+#include "gsb_real.h"
+#include "erreur.h"
+/*END_INCLUDE*/
+
+/* what the index keeps for a transaction, to remove it from the index */
+typedef struct _SearchIndexEntry	SearchIndexEntry;
+
+struct _SearchIndexEntry
+{
+	GArray		*trigrams;			/* guint32, without duplicate */
+	gint		payee_number;
+	GsbReal		amount;				/* valid only if amounts_valid */
+};
+
+/* an item of the list of the amounts */
+typedef struct _SearchIndexAmount	SearchIndexAmount;
+
+struct _SearchIndexAmount
+{
+	GsbReal		amount;
+	gint		transaction_number;
+};
+
+/*START_STATIC*/
+/*END_STATIC*/
+
+/*START_EXTERN*/
+/*END_EXTERN*/
+
+/* TRUE once the index is built, until the next file */
+static gboolean			index_built = FALSE;
+
+/* transaction number -> SearchIndexEntry */
+static GHashTable *		index_entries = NULL;
+
+/* trigram -> GHashTable transaction number -> number of fields with that trigram */
+static GHashTable *		index_trigrams = NULL;
+
+/* payee number -> GHashTable set of transaction numbers */
+static GHashTable *		index_payees = NULL;
+
+/* SearchIndexAmount sorted by amount then by transaction number */
+static GArray *			index_amounts = NULL;
+static gboolean			amounts_valid = FALSE;
+
+/* the transactions to index again before the next search */
+static GHashTable *		index_marked = NULL;
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
+/**
+ * compare 2 items of the list of the amounts
+ *
+ * \param a
+ * \param b
+ *
+ * \return -1, 0, 1
+ **/
+static gint gsb_search_index_amount_cmp (const SearchIndexAmount *a,
+										 const SearchIndexAmount *b)
+{
+	gint return_value;
+
+	return_value = gsb_real_cmp (a->amount, b->amount);
+	if (return_value)
+		return return_value;
+
+	return (a->transaction_number > b->transaction_number) - (a->transaction_number < b->transaction_number);
+}
+
+/**
+ * find the position of an item in the list of the amounts,
+ * or the position where it must be inserted
+ *
+ * \param item
+ *
+ * \return the position
+ **/
+static guint gsb_search_index_amount_position (const SearchIndexAmount *item)
+{
+	guint low = 0;
+	guint high;
+
+	high = index_amounts->len;
+	while (low < high)
+	{
+		guint middle;
+
+		middle = (low + high) / 2;
+		if (gsb_search_index_amount_cmp (&g_array_index (index_amounts, SearchIndexAmount, middle), item) < 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
+/**
+ * add the trigrams of a normalized text to an array, without duplicate
+ *
+ * \param trigrams
+ * \param text normalized text
+ *
+ * \return
+ **/
+static void gsb_search_index_add_trigrams (GArray *trigrams,
+										   const gchar *text)
+{
+	const guchar *ptr;
+
+	if (!text)
+		return;
+
+	for (ptr = (const guchar *) text; ptr[0] && ptr[1] && ptr[2]; ptr++)
+	{
+		guint32 trigram;
+		guint i;
+
+		trigram = ((guint32) ptr[0] << 16) | ((guint32) ptr[1] << 8) | ptr[2];
+		for (i = 0; i < trigrams->len; i++)
+			if (g_array_index (trigrams, guint32, i) == trigram)
+				break;
+
+		if (i == trigrams->len)
+			g_array_append_val (trigrams, trigram);
+	}
+}
+
+/**
+ * add the trigrams of a field of a transaction
+ *
+ * \param trigrams
+ * \param text the field, not normalized
+ *
+ * \return
+ **/
+static void gsb_search_index_add_field (GArray *trigrams,
+										const gchar *text)
+{
+	gchar *tmp_str;
+
+	if (!text || !*text)
+		return;
+
+	tmp_str = gsb_search_index_normalize (text);
+	gsb_search_index_add_trigrams (trigrams, tmp_str);
+	g_free (tmp_str);
+}
+
+/**
+ * remove a transaction from the index
+ *
+ * \param transaction_number
+ *
+ * \return
+ **/
+static void gsb_search_index_remove_entry (gint transaction_number)
+{
+	SearchIndexEntry *entry;
+	guint i;
+
+	entry = g_hash_table_lookup (index_entries, GINT_TO_POINTER (transaction_number));
+	if (!entry)
+		return;
+
+	for (i = 0; i < entry->trigrams->len; i++)
+	{
+		GHashTable *transactions;
+		gpointer trigram;
+
+		trigram = GUINT_TO_POINTER (g_array_index (entry->trigrams, guint32, i));
+		transactions = g_hash_table_lookup (index_trigrams, trigram);
+		if (!transactions)
+			continue;
+
+		g_hash_table_remove (transactions, GINT_TO_POINTER (transaction_number));
+		if (g_hash_table_size (transactions) == 0)
+			g_hash_table_remove (index_trigrams, trigram);
+	}
+
+	if (entry->payee_number)
+	{
+		GHashTable *transactions;
+
+		transactions = g_hash_table_lookup (index_payees, GINT_TO_POINTER (entry->payee_number));
+		if (transactions)
+			g_hash_table_remove (transactions, GINT_TO_POINTER (transaction_number));
+	}
+
+	if (amounts_valid)
+	{
+		SearchIndexAmount item;
+		guint position;
+
+		item.amount = entry->amount;
+		item.transaction_number = transaction_number;
+		position = gsb_search_index_amount_position (&item);
+		if (position < index_amounts->len
+			&& g_array_index (index_amounts, SearchIndexAmount, position).transaction_number == transaction_number)
+			g_array_remove_index (index_amounts, position);
+	}
+
+	g_hash_table_remove (index_entries, GINT_TO_POINTER (transaction_number));
+}
+
+/**
+ * add a transaction to the index
+ *
+ * \param transaction_number
+ *
+ * \return
+ **/
+static void gsb_search_index_add_entry (gint transaction_number)
+{
+	SearchIndexEntry *entry;
+	guint i;
+
+	entry = g_malloc0 (sizeof (SearchIndexEntry));
+	entry->trigrams = g_array_new (FALSE, FALSE, sizeof (guint32));
+	gsb_search_index_add_field (entry->trigrams, gsb_data_transaction_get_notes (transaction_number));
+	gsb_search_index_add_field (entry->trigrams, gsb_data_transaction_get_voucher (transaction_number));
+	gsb_search_index_add_field (entry->trigrams, gsb_data_transaction_get_bank_references (transaction_number));
+	gsb_search_index_add_field (entry->trigrams,
+								gsb_data_transaction_get_method_of_payment_content (transaction_number));
+
+	for (i = 0; i < entry->trigrams->len; i++)
+	{
+		GHashTable *transactions;
+		gpointer trigram;
+
+		trigram = GUINT_TO_POINTER (g_array_index (entry->trigrams, guint32, i));
+		transactions = g_hash_table_lookup (index_trigrams, trigram);
+		if (!transactions)
+		{
+			transactions = g_hash_table_new (g_direct_hash, g_direct_equal);
+			g_hash_table_insert (index_trigrams, trigram, transactions);
+		}
+		g_hash_table_add (transactions, GINT_TO_POINTER (transaction_number));
+	}
+
+	entry->payee_number = gsb_data_transaction_get_party_number (transaction_number);
+	if (entry->payee_number)
+	{
+		GHashTable *transactions;
+
+		transactions = g_hash_table_lookup (index_payees, GINT_TO_POINTER (entry->payee_number));
+		if (!transactions)
+		{
+			transactions = g_hash_table_new (g_direct_hash, g_direct_equal);
+			g_hash_table_insert (index_payees, GINT_TO_POINTER (entry->payee_number), transactions);
+		}
+		g_hash_table_add (transactions, GINT_TO_POINTER (transaction_number));
+	}
+
+	if (amounts_valid)
+	{
+		SearchIndexAmount item;
+
+		entry->amount = gsb_data_transaction_get_adjusted_amount (transaction_number, -1);
+		item.amount = entry->amount;
+		item.transaction_number = transaction_number;
+		g_array_insert_val (index_amounts, gsb_search_index_amount_position (&item), item);
+	}
+
+	g_hash_table_insert (index_entries, GINT_TO_POINTER (transaction_number), entry);
+}
+
+/**
+ * free an entry of the index
+ *
+ * \param entry
+ *
+ * \return
+ **/
+static void gsb_search_index_free_entry (SearchIndexEntry *entry)
+{
+	g_array_free (entry->trigrams, TRUE);
+	g_free (entry);
+}
+
+/**
+ * build the index if needed, else index again the marked transactions
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_search_index_update (void)
+{
+	GHashTableIter iter;
+	gpointer key;
+
+	if (!index_built)
+	{
+		GSList *tmp_list;
+
+		index_entries = g_hash_table_new_full (g_direct_hash,
+											   g_direct_equal,
+											   NULL,
+											   (GDestroyNotify) gsb_search_index_free_entry);
+		index_trigrams = g_hash_table_new_full (g_direct_hash,
+												g_direct_equal,
+												NULL,
+												(GDestroyNotify) g_hash_table_destroy);
+		index_payees = g_hash_table_new_full (g_direct_hash,
+											  g_direct_equal,
+											  NULL,
+											  (GDestroyNotify) g_hash_table_destroy);
+		index_marked = g_hash_table_new (g_direct_hash, g_direct_equal);
+		index_amounts = g_array_new (FALSE, FALSE, sizeof (SearchIndexAmount));
+		amounts_valid = FALSE;
+
+		/* the archives kept in the cache of the file are indexed when they are loaded */
+		tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
+		while (tmp_list)
+		{
+			gsb_search_index_add_entry (gsb_data_transaction_get_transaction_number (tmp_list->data));
+			tmp_list = tmp_list->next;
+		}
+		index_built = TRUE;
+
+		return;
+	}
+
+	g_hash_table_iter_init (&iter, index_marked);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+	{
+		gint transaction_number;
+
+		transaction_number = GPOINTER_TO_INT (key);
+		gsb_search_index_remove_entry (transaction_number);
+
+		/* the transaction can have been deleted */
+		if (gsb_data_transaction_get_pointer_of_transaction (transaction_number))
+			gsb_search_index_add_entry (transaction_number);
+	}
+	g_hash_table_remove_all (index_marked);
+}
+
+/**
+ * sort again all the amounts, after a change of the exchange rates
+ * or of the currency of an account
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_search_index_update_amounts (void)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	g_array_set_size (index_amounts, 0);
+
+	g_hash_table_iter_init (&iter, index_entries);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		SearchIndexEntry *entry;
+		SearchIndexAmount item;
+
+		entry = value;
+		entry->amount = gsb_data_transaction_get_adjusted_amount (GPOINTER_TO_INT (key), -1);
+		item.amount = entry->amount;
+		item.transaction_number = GPOINTER_TO_INT (key);
+		g_array_append_val (index_amounts, item);
+	}
+	g_array_sort (index_amounts, (GCompareFunc) gsb_search_index_amount_cmp);
+	amounts_valid = TRUE;
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * normalize a text for the search : the accents are removed
+ * and the letters are set in upper case, character by character,
+ * so a part of a text gives a part of the normalized text
+ *
+ * \param text
+ *
+ * \return a newly allocated string
+ **/
+gchar *gsb_search_index_normalize (const gchar *text)
+{
+	GString *string;
+	gchar *decomposed;
+	const gchar *ptr;
+
+	if (!text)
+		return g_strdup ("");
+
+	decomposed = g_utf8_normalize (text, -1, G_NORMALIZE_ALL);
+	if (!decomposed)
+		return g_ascii_strup (text, -1);
+
+	string = g_string_sized_new (strlen (decomposed));
+	for (ptr = decomposed; *ptr; ptr = g_utf8_next_char (ptr))
+	{
+		gunichar ch;
+
+		ch = g_utf8_get_char (ptr);
+		if (!g_unichar_ismark (ch))
+			g_string_append_unichar (string, g_unichar_toupper (ch));
+	}
+	g_free (decomposed);
+
+	return g_string_free (string, FALSE);
+}
+
+/**
+ * tell the index that a transaction was created, changed or deleted
+ *
+ * \param transaction_number
+ *
+ * \return
+ **/
+void gsb_search_index_mark_transaction (gint transaction_number)
+{
+	if (!index_built || transaction_number <= 0)
+		return;
+
+	g_hash_table_add (index_marked, GINT_TO_POINTER (transaction_number));
+}
+
+/**
+ * tell the index that the amounts of the transactions in the currency
+ * of their account may have changed without a change of the transactions
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_search_index_invalidate_amounts (void)
+{
+	amounts_valid = FALSE;
+}
+
+/**
+ * free the index, to call when the file is closed
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_search_index_free (void)
+{
+	if (!index_built)
+		return;
+
+	g_hash_table_destroy (index_entries);
+	g_hash_table_destroy (index_trigrams);
+	g_hash_table_destroy (index_payees);
+	g_hash_table_destroy (index_marked);
+	g_array_free (index_amounts, TRUE);
+	index_entries = NULL;
+	index_trigrams = NULL;
+	index_payees = NULL;
+	index_marked = NULL;
+	index_amounts = NULL;
+	amounts_valid = FALSE;
+	index_built = FALSE;
+}
+
+/**
+ * add to a set the transactions which may contain a text in their notes,
+ * voucher, bank references or cheque number
+ *
+ * \param text normalized with gsb_search_index_normalize ()
+ * \param result set of transaction numbers to fill
+ *
+ * \return FALSE if the text is too short for the index, the search must check all the transactions
+ **/
+gboolean gsb_search_index_find_text (const gchar *text,
+									 GHashTable *result)
+{
+	GArray *trigrams;
+	GHashTable *smallest = NULL;
+	GHashTableIter iter;
+	gpointer key;
+	guint i;
+
+	if (!text || strlen (text) < 3)
+		return FALSE;
+
+	gsb_search_index_update ();
+
+	trigrams = g_array_new (FALSE, FALSE, sizeof (guint32));
+	gsb_search_index_add_trigrams (trigrams, text);
+
+	/* walk the smallest list of transactions and check the other trigrams */
+	for (i = 0; i < trigrams->len; i++)
+	{
+		GHashTable *transactions;
+
+		transactions = g_hash_table_lookup (index_trigrams,
+											GUINT_TO_POINTER (g_array_index (trigrams, guint32, i)));
+		if (!transactions)
+		{
+			g_array_free (trigrams, TRUE);
+			return TRUE;
+		}
+		if (!smallest || g_hash_table_size (transactions) < g_hash_table_size (smallest))
+			smallest = transactions;
+	}
+
+	g_hash_table_iter_init (&iter, smallest);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+	{
+		for (i = 0; i < trigrams->len; i++)
+		{
+			GHashTable *transactions;
+
+			transactions = g_hash_table_lookup (index_trigrams,
+												GUINT_TO_POINTER (g_array_index (trigrams, guint32, i)));
+			if (transactions != smallest && !g_hash_table_contains (transactions, key))
+				break;
+		}
+		if (i == trigrams->len)
+			g_hash_table_add (result, key);
+	}
+	g_array_free (trigrams, TRUE);
+
+	return TRUE;
+}
+
+/**
+ * add to a set the transactions of a payee
+ *
+ * \param payee_number
+ * \param result set of transaction numbers to fill
+ *
+ * \return
+ **/
+void gsb_search_index_find_payee (gint payee_number,
+								  GHashTable *result)
+{
+	GHashTable *transactions;
+	GHashTableIter iter;
+	gpointer key;
+
+	gsb_search_index_update ();
+
+	transactions = g_hash_table_lookup (index_payees, GINT_TO_POINTER (payee_number));
+	if (!transactions)
+		return;
+
+	g_hash_table_iter_init (&iter, transactions);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+		g_hash_table_add (result, key);
+}
+
+/**
+ * add to a set the transactions with an amount between 2 values,
+ * in the currency of their account
+ *
+ * \param min
+ * \param max
+ * \param result set of transaction numbers to fill
+ *
+ * \return
+ **/
+void gsb_search_index_find_amounts (GsbReal min,
+									GsbReal max,
+									GHashTable *result)
+{
+	SearchIndexAmount item;
+	guint position;
+
+	gsb_search_index_update ();
+	if (!amounts_valid)
+		gsb_search_index_update_amounts ();
+
+	item.amount = min;
+	item.transaction_number = G_MININT;
+	for (position = gsb_search_index_amount_position (&item); position < index_amounts->len; position++)
+	{
+		SearchIndexAmount *found;
+
+		found = &g_array_index (index_amounts, SearchIndexAmount, position);
+		if (gsb_real_cmp (found->amount, max) > 0)
+			break;
+
+		g_hash_table_add (result, GINT_TO_POINTER (found->transaction_number));
+	}
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
@@ -0,0 +1,25 @@
+#ifndef _GSB_SEARCH_INDEX_H
+#define _GSB_SEARCH_INDEX_H (1)
+
+#include <glib.h>
+
+/* START_INCLUDE_H */
+#include "gsb_real.h"
+/* END_INCLUDE_H */
+
+
+/* START_DECLARATION */
+void		gsb_search_index_find_amounts			(GsbReal min,
+													 GsbReal max,
+													 GHashTable *result);
+void		gsb_search_index_find_payee				(gint payee_number,
+													 GHashTable *result);
+gboolean	gsb_search_index_find_text				(const gchar *text,
+													 GHashTable *result);
+void		gsb_search_index_free					(void);
+void		gsb_search_index_invalidate_amounts		(void);
+void		gsb_search_index_mark_transaction		(gint transaction_number);
+gchar *		gsb_search_index_normalize				(const gchar *text);
+/* END_DECLARATION */
+
+#endif
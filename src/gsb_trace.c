@@ -0,0 +1,461 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*     Copyright (C)    2020 Grisbi Development Team                          */
+/*          https://www.grisbi.org/                                           */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file gsb_trace.c
+ * measure the time of the long operations of grisbi :
+ * the spans and the counters are recorded in a ring buffer for each thread,
+ * without formatting nor writing anything. When grisbi quits, they are written
+ * in a trace file for chrome://tracing or summed up in a table on the terminal.
+ * The buffers are kept until the end of the process: a thread still running
+ * when the trace is finished may record an event after the test of
+ * gsb_trace_enabled
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+#include <string.h>
+
+/*START_INCLUDE*/
+#include "gsb_trace.h"
+/*END_INCLUDE*/
+
+/* number of events kept for each thread, the oldest are overwritten */
+#define GSB_TRACE_BUFFER_SIZE		65536
+
+/* output of the trace */
+#define GSB_TRACE_SUMMARY			"summary"
+
+typedef struct _GsbTraceBuffer		GsbTraceBuffer;
+typedef struct _GsbTraceEvent		GsbTraceEvent;
+typedef struct _GsbTraceSummary		GsbTraceSummary;
+
+typedef enum _GsbTraceEventType
+{
+	GSB_TRACE_SPAN,
+	GSB_TRACE_COUNTER
+} GsbTraceEventType;
+
+struct _GsbTraceEvent
+{
+	const gchar *		name;
+	gint64				time;				/* beginning of the span or time of the counter */
+	gint64				value;				/* duration of the span or total of the counter */
+	GsbTraceEventType	type;
+};
+
+struct _GsbTraceBuffer
+{
+	GMutex				mutex;				/* taken by the thread and by gsb_trace_finish () */
+	GsbTraceEvent *		events;
+	guint				next;				/* index of the next event to record */
+	guint				nbre_events;
+	guint64				nbre_lost;			/* events overwritten when the buffer is full */
+	gint				thread_number;
+};
+
+struct _GsbTraceSummary
+{
+	const gchar *		name;
+	guint				nbre_spans;
+	gint64				total;
+	gint64				max;
+};
+
+/*START_STATIC*/
+/* buffer of the current thread */
+static GPrivate trace_buffer_private;
+
+/* all the buffers, and the totals of the counters */
+static GMutex trace_mutex;
+static GPtrArray *trace_buffers = NULL;
+static GHashTable *trace_counters = NULL;
+
+static gchar *trace_output = NULL;
+static gint64 trace_start_time = 0;
+/*END_STATIC*/
+
+/*START_EXTERN*/
+/*END_EXTERN*/
+
+gboolean gsb_trace_enabled = FALSE;
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
+/**
+ * return the buffer of the current thread, created the first time
+ *
+ * \param
+ *
+ * \return the buffer
+ **/
+static GsbTraceBuffer *gsb_trace_get_buffer (void)
+{
+	GsbTraceBuffer *buffer;
+
+	buffer = g_private_get (&trace_buffer_private);
+	if (buffer)
+		return buffer;
+
+	buffer = g_malloc0 (sizeof (GsbTraceBuffer));
+	g_mutex_init (&buffer->mutex);
+	buffer->events = g_new (GsbTraceEvent, GSB_TRACE_BUFFER_SIZE);
+
+	g_mutex_lock (&trace_mutex);
+	buffer->thread_number = trace_buffers->len + 1;
+	g_ptr_array_add (trace_buffers, buffer);
+	g_mutex_unlock (&trace_mutex);
+
+	g_private_set (&trace_buffer_private, buffer);
+
+	return buffer;
+}
+
+/**
+ * record an event in the buffer of the current thread
+ *
+ * \param name
+ * \param time
+ * \param value
+ * \param type
+ *
+ * \return
+ **/
+static void gsb_trace_record_event (const gchar *name,
+									gint64 time,
+									gint64 value,
+									GsbTraceEventType type)
+{
+	GsbTraceBuffer *buffer;
+	GsbTraceEvent *event;
+
+	buffer = gsb_trace_get_buffer ();
+
+	g_mutex_lock (&buffer->mutex);
+	event = &buffer->events[buffer->next];
+	event->name = name;
+	event->time = time;
+	event->value = value;
+	event->type = type;
+
+	buffer->next = (buffer->next + 1) % GSB_TRACE_BUFFER_SIZE;
+	if (buffer->nbre_events < GSB_TRACE_BUFFER_SIZE)
+		buffer->nbre_events++;
+	else
+		buffer->nbre_lost++;
+	g_mutex_unlock (&buffer->mutex);
+}
+
+/**
+ * return the event number i of the buffer, in the order of the recording
+ *
+ * \param buffer
+ * \param i
+ *
+ * \return the event
+ **/
+static GsbTraceEvent *gsb_trace_get_event (GsbTraceBuffer *buffer,
+										   guint i)
+{
+	guint first;
+
+	first = (buffer->next + GSB_TRACE_BUFFER_SIZE - buffer->nbre_events) % GSB_TRACE_BUFFER_SIZE;
+
+	return &buffer->events[(first + i) % GSB_TRACE_BUFFER_SIZE];
+}
+
+/**
+ * write the events in a JSON file of the trace event format,
+ * the times are in microseconds from the beginning of the trace
+ *
+ * \param filename
+ *
+ * \return TRUE if ok
+ **/
+static gboolean gsb_trace_write_json (const gchar *filename)
+{
+	GString *json;
+	GError *error = NULL;
+	gboolean first = TRUE;
+	guint i;
+
+	json = g_string_new ("{\"traceEvents\":[\n");
+
+	for (i = 0; i < trace_buffers->len; i++)
+	{
+		GsbTraceBuffer *buffer;
+		guint j;
+
+		buffer = g_ptr_array_index (trace_buffers, i);
+		g_mutex_lock (&buffer->mutex);
+		for (j = 0; j < buffer->nbre_events; j++)
+		{
+			GsbTraceEvent *event;
+
+			event = gsb_trace_get_event (buffer, j);
+			if (!first)
+				g_string_append (json, ",\n");
+			first = FALSE;
+
+			if (event->type == GSB_TRACE_SPAN)
+				g_string_append_printf (json,
+										"{\"name\":\"%s\",\"cat\":\"grisbi\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+										"\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT "}",
+										event->name,
+										buffer->thread_number,
+										event->time - trace_start_time,
+										event->value);
+			else
+				g_string_append_printf (json,
+										"{\"name\":\"%s\",\"cat\":\"grisbi\",\"ph\":\"C\",\"pid\":1,\"tid\":%d,"
+										"\"ts\":%" G_GINT64_FORMAT ",\"args\":{\"value\":%" G_GINT64_FORMAT "}}",
+										event->name,
+										buffer->thread_number,
+										event->time - trace_start_time,
+										event->value);
+		}
+		g_mutex_unlock (&buffer->mutex);
+	}
+	g_string_append (json, "\n]}\n");
+
+	if (!g_file_set_contents (filename, json->str, json->len, &error))
+	{
+		g_print ("Cannot write the trace file %s: %s\n", filename, error->message);
+		g_error_free (error);
+		g_string_free (json, TRUE);
+
+		return FALSE;
+	}
+	g_string_free (json, TRUE);
+
+	return TRUE;
+}
+
+/**
+ * sort the summaries by total time
+ *
+ * \param summary_1
+ * \param summary_2
+ *
+ * \return -1 if summary_1 took more time
+ **/
+static gint gsb_trace_summary_compare (GsbTraceSummary **summary_1,
+									   GsbTraceSummary **summary_2)
+{
+	if ((*summary_1)->total == (*summary_2)->total)
+		return strcmp ((*summary_1)->name, (*summary_2)->name);
+
+	return (*summary_1)->total > (*summary_2)->total ? -1 : 1;
+}
+
+/**
+ * print the number, the total, the mean and the maximum time of each span
+ * and the total of each counter
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_trace_print_summary (void)
+{
+	GHashTable *spans;
+	GHashTableIter iter;
+	GPtrArray *summaries;
+	gpointer key;
+	gpointer value;
+	guint64 nbre_lost = 0;
+	guint i;
+
+	spans = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+	for (i = 0; i < trace_buffers->len; i++)
+	{
+		GsbTraceBuffer *buffer;
+		guint j;
+
+		buffer = g_ptr_array_index (trace_buffers, i);
+		g_mutex_lock (&buffer->mutex);
+		nbre_lost += buffer->nbre_lost;
+		for (j = 0; j < buffer->nbre_events; j++)
+		{
+			GsbTraceEvent *event;
+			GsbTraceSummary *summary;
+
+			event = gsb_trace_get_event (buffer, j);
+			if (event->type != GSB_TRACE_SPAN)
+				continue;
+
+			summary = g_hash_table_lookup (spans, event->name);
+			if (!summary)
+			{
+				summary = g_malloc0 (sizeof (GsbTraceSummary));
+				summary->name = event->name;
+				g_hash_table_insert (spans, (gpointer) event->name, summary);
+			}
+			summary->nbre_spans++;
+			summary->total += event->value;
+			if (event->value > summary->max)
+				summary->max = event->value;
+		}
+		g_mutex_unlock (&buffer->mutex);
+	}
+
+	summaries = g_ptr_array_new ();
+	g_hash_table_iter_init (&iter, spans);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+		g_ptr_array_add (summaries, value);
+	g_ptr_array_sort (summaries, (GCompareFunc) gsb_trace_summary_compare);
+
+	g_print ("\n%-36s %10s %12s %12s %12s\n", "Span", "Count", "Total (ms)", "Mean (ms)", "Max (ms)");
+	for (i = 0; i < summaries->len; i++)
+	{
+		GsbTraceSummary *summary;
+
+		summary = g_ptr_array_index (summaries, i);
+		g_print ("%-36s %10u %12.3f %12.3f %12.3f\n",
+				 summary->name,
+				 summary->nbre_spans,
+				 summary->total / 1000.0,
+				 summary->total / 1000.0 / summary->nbre_spans,
+				 summary->max / 1000.0);
+	}
+
+	if (g_hash_table_size (trace_counters))
+	{
+		g_print ("\n%-36s %10s\n", "Counter", "Total");
+		g_hash_table_iter_init (&iter, trace_counters);
+		while (g_hash_table_iter_next (&iter, &key, &value))
+			g_print ("%-36s %10" G_GINT64_FORMAT "\n", (const gchar *) key, *(gint64 *) value);
+	}
+
+	if (nbre_lost)
+		g_print ("\n%" G_GUINT64_FORMAT " events were overwritten, the oldest spans are missing\n", nbre_lost);
+
+	g_ptr_array_free (summaries, TRUE);
+	g_hash_table_destroy (spans);
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * enable the trace, once in a process
+ *
+ * \param output	"summary" to print a table when grisbi quits,
+ * 					else the name of the JSON file to write
+ *
+ * \return TRUE if the trace is enabled
+ **/
+gboolean gsb_trace_init (const gchar *output)
+{
+	/* the buffers of a previous trace may still be used by their threads */
+	if (!output || !strlen (output) || trace_buffers)
+		return FALSE;
+
+	trace_output = g_strdup (output);
+	trace_buffers = g_ptr_array_new ();
+	trace_counters = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+	trace_start_time = g_get_monotonic_time ();
+	gsb_trace_enabled = TRUE;
+
+	return TRUE;
+}
+
+/**
+ * disable the trace and write the recorded events,
+ * the buffers are not freed because a thread may still record an event
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_trace_finish (void)
+{
+	if (!gsb_trace_enabled)
+		return;
+
+	gsb_trace_enabled = FALSE;
+
+	g_mutex_lock (&trace_mutex);
+	if (strcmp (trace_output, GSB_TRACE_SUMMARY) == 0)
+		gsb_trace_print_summary ();
+	else
+		gsb_trace_write_json (trace_output);
+	g_mutex_unlock (&trace_mutex);
+}
+
+/**
+ * record a span, use gsb_trace_end () which tests if the trace is enabled
+ *
+ * \param name		static name of the span
+ * \param start		value of gsb_trace_begin () at the beginning of the span
+ *
+ * \return
+ **/
+void gsb_trace_record_span (const gchar *name,
+							gint64 start)
+{
+	gint64 end;
+
+	/* the trace was enabled during the span */
+	if (start == 0)
+		return;
+
+	end = g_get_monotonic_time ();
+	gsb_trace_record_event (name, start, end - start, GSB_TRACE_SPAN);
+}
+
+/**
+ * add a value to a counter, use gsb_trace_count () which tests if the trace is enabled
+ *
+ * \param name		static name of the counter
+ * \param value
+ *
+ * \return
+ **/
+void gsb_trace_record_counter (const gchar *name,
+							   gint64 value)
+{
+	gint64 *total;
+	gint64 time;
+
+	time = g_get_monotonic_time ();
+
+	g_mutex_lock (&trace_mutex);
+	total = g_hash_table_lookup (trace_counters, name);
+	if (!total)
+	{
+		total = g_new0 (gint64, 1);
+		g_hash_table_insert (trace_counters, (gpointer) name, total);
+	}
+	*total += value;
+	value = *total;
+	g_mutex_unlock (&trace_mutex);
+
+	gsb_trace_record_event (name, time, value, GSB_TRACE_COUNTER);
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
@@ -0,0 +1,33 @@
+#ifndef _GSB_TRACE_H
+#define _GSB_TRACE_H (1)
+
+#include <glib.h>
+
+/* START_INCLUDE_H */
+/* END_INCLUDE_H */
+
+/* the spans and the counters are recorded only when the trace is enabled
+ * by the command line option --trace, else they cost a test of this variable */
+extern gboolean gsb_trace_enabled;
+
+/* begin a span: the returned time is given to gsb_trace_end () */
+#define gsb_trace_begin() (G_UNLIKELY (gsb_trace_enabled) ? g_get_monotonic_time () : 0)
+
+/* end the span started at start, name must be a static string */
+#define gsb_trace_end(name,start) \
+	G_STMT_START { if (G_UNLIKELY (gsb_trace_enabled)) gsb_trace_record_span (name, start); } G_STMT_END
+
+/* add value to the counter name, name must be a static string */
+#define gsb_trace_count(name,value) \
+	G_STMT_START { if (G_UNLIKELY (gsb_trace_enabled)) gsb_trace_record_counter (name, value); } G_STMT_END
+
+/* START_DECLARATION */
+void		gsb_trace_finish					(void);
+gboolean	gsb_trace_init						(const gchar *output);
+void		gsb_trace_record_counter			(const gchar *name,
+												 gint64 value);
+void		gsb_trace_record_span				(const gchar *name,
+												 gint64 start);
+/* END_DECLARATION */
+
+#endif /*_GSB_TRACE_H*/
@@ -53,11 +53,13 @@
 #include "gsb_data_scheduled.h"
 #include "gsb_data_transaction.h"
 #include "gsb_file.h"
+#include "gsb_file_cache.h"
 #include "gsb_form.h"
 #include "gsb_form_transaction.h"
 #include "gsb_real.h"
 #include "gsb_reconcile.h"
 #include "gsb_scheduler_list.h"
+#include "gsb_trace.h"
 #include "import.h"
 #include "menu.h"
 #include "mouse.h"
@@ -352,6 +354,7 @@ static gboolean gsb_transactions_list_move_transaction_to_account (gint transact
 
     /* we change now the account of the transaction */
     gsb_data_transaction_set_account_number (transaction_number, target_account);
+    transaction_list_move_account_rows (transaction_number);
 
     /* update the field of the contra transaction if necessary. Ce transfert ne doit pas
      * modifier la balance du compte */
@@ -2166,8 +2169,10 @@ static gboolean gsb_transactions_list_fill_model (void)
 {
     GSList *tmp_list;
     gint transaction_number;
+    gint64 trace_start;
 
     devel_debug (NULL);
+    trace_start = gsb_trace_begin ();
 
     /* add the transations which represent the archives to the store
      * 1 line per archive and per account */
@@ -2193,6 +2198,9 @@ static gboolean gsb_transactions_list_fill_model (void)
         g_slist_free (orphan_child_transactions);
         orphan_child_transactions = NULL;
     }
+    gsb_trace_count ("transactions_list_transactions", g_slist_length (gsb_data_transaction_get_transactions_list ()));
+    gsb_trace_end ("transactions_list_fill", trace_start);
+
     return FALSE;
 }
 
@@ -4168,8 +4176,10 @@ gboolean gsb_transactions_list_restore_archive (gint archive_number,
         orphan_child_transactions = NULL;
 
         /* second step, we add all the archived transactions of that archive into the
-         * transactions_list and into the store */
-        tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+         * transactions_list and into the store, only that archive is loaded
+         * if it is kept in the cache of the file */
+        gsb_file_cache_load_archive (archive_number);
+        tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
         while (tmp_list)
         {
             transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
@@ -4283,8 +4293,10 @@ gboolean gsb_transactions_list_add_transactions_from_archive (gint archive_numbe
         orphan_child_transactions = NULL;
 
         /* second step, we add all the archived transactions of that archive into the
-         * transactions_list and into the store */
-        tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+         * transactions_list and into the store, only that archive is loaded
+         * if it is kept in the cache of the file */
+        gsb_file_cache_load_archive (archive_number);
+        tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
         while (tmp_list)
         {
             transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
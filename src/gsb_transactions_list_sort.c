@@ -32,6 +32,7 @@
 #endif
 
 #include "include.h"
+#include <string.h>
 #include <glib/gi18n.h>
 
 /*START_INCLUDE*/
@@ -46,140 +47,55 @@
 #include "gsb_data_transaction.h"
 #include "navigation.h"
 #include "gsb_real.h"
+#include "gsb_trace.h"
 #include "gsb_transactions_list.h"
 #include "custom_list.h"
 #include "structures.h"
 #include "erreur.h"
 /*END_INCLUDE*/
 
-/*START_STATIC*/
-/* variables de tri primaire et secondaire */
-static gint transactions_list_primary_sorting = 0;
-static gint transactions_list_secondary_sorting = 0;
+/* a sort key is made of 64 bits words, the most significant first:
+ * the group of the line, 3 words for the sorted element, the transaction number and the line */
+#define SORT_KEY_WORDS				5
+#define SORT_KEY_WORD_ELEMENT		1
+#define SORT_KEY_WORD_NUMBER		4
+#define SORT_KEY_NONE				G_MAXUINT64
 
-static gint gsb_transactions_list_sort_by_amount ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_bank ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_budget ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_category ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_chq ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_credit ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_date ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_date_and_amount ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_date_and_no ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_date_and_party ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_debit ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_financial_year ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_mark ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_no ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_no_sort (  gint transaction_number_1,
-                        gint transaction_number_2,
-                        gint element_number );
-static gint gsb_transactions_list_sort_by_notes ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_party ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_reconcile_nb ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_type ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_value_date ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_by_voucher ( gint transaction_number_1,
-                        gint transaction_number_2 );
-static gint gsb_transactions_list_sort_initial_by_secondary_key ( gint transaction_number_1,
-                        gint transaction_number_2 );
-/*END_STATIC*/
+/* groups of the lines: the archives at the top, the white line at the end */
+#define SORT_KEY_GROUP_TRANSACTION	(G_GUINT64_CONSTANT (1) << 32)
+#define SORT_KEY_GROUP_WHITE_LINE	(G_GUINT64_CONSTANT (2) << 32)
 
+/* the keys are sorted by digits of 16 bits */
+#define SORT_RADIX_BITS				16
+#define SORT_RADIX_SIZE				(1 << SORT_RADIX_BITS)
 
-/*START_EXTERN*/
-/*END_EXTERN*/
+typedef struct _TransactionsListSortKey		TransactionsListSortKey;
+typedef struct _TransactionsListSortStrings	TransactionsListSortStrings;
 
-/**
- * called by a click on the column, used to sort the list
- *
- * \param model
- * \param iter_1
- * \param iter_2
- * \param column_number the number of the column (0 to CUSTOM_MODEL_VISIBLE_COLUMNS) we want to sort by
- *
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort (CustomRecord **a,
-                        CustomRecord **b,
-                        CustomList *custom_list)
+/* key of a visible record, computed once before sorting */
+struct _TransactionsListSortKey
 {
-    gint account_number;
-    gint return_value;
-    CustomRecord *record_1 = NULL;
-    CustomRecord *record_2 = NULL;
-
-    account_number = gsb_gui_navigation_get_current_account ();
-    if (account_number == -1)
-	/* normally cannot happen, except come here at the opening
-	 * of grisbi, and must return 0 if we don't want a crash */
-	return 0;
-
-    /* i don't know why but sometimes there is a comparison between the 2 same rows... */
-    if (*a == *b)
-	return 0;
-
-    /* first of all, check the archive */
-    return_value = gsb_transactions_list_sort_check_archive ( *a, *b );
-    if (!return_value)
-    {
-	/* check the general tests (white line...) */
-	/* get the records */
-	record_1 = *a;
-	record_2 = *b;
-	return_value = gsb_transactions_list_sort_general_test ( record_1, record_2 );
-    }
-
-    if (return_value)
-    {
-	/* we have already a returned value, but for archive or general test,
-	 * the pos of the row need not to change, so must keep the return_value */
-	return return_value;
-    }
-    else
-    {
-	/* get the transaction numbers */
-	gint element_number;
-	gint transaction_number_1 = gsb_data_transaction_get_transaction_number (record_1 -> transaction_pointer);
-	gint transaction_number_2 = gsb_data_transaction_get_transaction_number (record_2 -> transaction_pointer);
-
-	/* get the element used to sort the list */
-	element_number = gsb_data_account_get_element_sort ( account_number,
-							     custom_list -> sort_col);
+	CustomRecord *	record;
+	guint64			words[SORT_KEY_WORDS];
+	guint			string_words;				/* bit set for the words which are the id of a string */
+};
 
-		/* if element_number = 0 it's forced to ELEMENT_VALUE_DATE */
-		if ( element_number == 0 )
-			element_number = ELEMENT_VALUE_DATE;
-
-	return_value = gsb_transactions_list_sort_by_no_sort ( transaction_number_1,
-							       transaction_number_2,
-							       element_number );
-    }
+/* strings of the sorted element, each one is compared once with the others */
+struct _TransactionsListSortStrings
+{
+	GHashTable *	ids;						/* string -> id of the string */
+	GPtrArray *		collate_keys;				/* id -> collate key of the casefolded string */
+};
 
-    if (custom_list -> sort_order == GTK_SORT_DESCENDING)
-	return_value = -return_value;
+/*START_STATIC*/
+/* variables de tri primaire et secondaire */
+static gint transactions_list_primary_sorting = 0;
+static gint transactions_list_secondary_sorting = 0;
+/*END_STATIC*/
 
-    return return_value;
-}
 
+/*START_EXTERN*/
+/*END_EXTERN*/
 
 /**
  * this is the first check of all : the archive
@@ -271,952 +187,572 @@ gint gsb_transactions_list_sort_general_test ( CustomRecord *record_1,
 
 
 /**
- * find the right function to sort the list and sort the 2 iters given
  *
- * \param model
- * \param iter_1
- * \param iter_2
- * \param no_sort permit to find the right function
  *
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_no_sort (  gint transaction_number_1,
-                        gint transaction_number_2,
-                        gint element_number )
+ * \param
+ *
+ * \return
+ **/
+void gsb_transactions_list_set_primary_sort (gint primary_sort)
 {
-    gchar* tmpstr;
-
-    switch (element_number)
-    {
-	case ELEMENT_DATE:  /* = 1 */
-	    return ( gsb_transactions_list_sort_by_date ( transaction_number_1,
-							  transaction_number_2));
-	    break;
-	case ELEMENT_VALUE_DATE:
-	    return ( gsb_transactions_list_sort_by_value_date ( transaction_number_1,
-								transaction_number_2));
-	    break;
-	case ELEMENT_PARTY:
-	    return ( gsb_transactions_list_sort_by_party ( transaction_number_1,
-							   transaction_number_2));
-	    break;
-	case ELEMENT_BUDGET:
-	    return ( gsb_transactions_list_sort_by_budget ( transaction_number_1,
-							    transaction_number_2));
-	    break;
-	case ELEMENT_CREDIT:
-	    return ( gsb_transactions_list_sort_by_credit ( transaction_number_1,
-							    transaction_number_2));
-	    break;
-	case ELEMENT_DEBIT:
-	    return ( gsb_transactions_list_sort_by_debit ( transaction_number_1,
-							   transaction_number_2));
-	    break;
-	case ELEMENT_BALANCE:
-	    /* 	    balance, normally, shouldn't be here... in case, give back the date */
-	    return ( gsb_transactions_list_sort_by_date ( transaction_number_1,
-							  transaction_number_2));
-	    break;
-	case ELEMENT_AMOUNT:
-	    return ( gsb_transactions_list_sort_by_amount ( transaction_number_1,
-							    transaction_number_2));
-	    break;
-	case ELEMENT_PAYMENT_TYPE:
-	    return ( gsb_transactions_list_sort_by_type ( transaction_number_1,
-							  transaction_number_2));
-	    break;
-	case ELEMENT_RECONCILE_NB:
-	    return ( gsb_transactions_list_sort_by_reconcile_nb ( transaction_number_1,
-								  transaction_number_2));
-	    break;
-	case ELEMENT_EXERCICE:
-	    return ( gsb_transactions_list_sort_by_financial_year ( transaction_number_1,
-								    transaction_number_2));
-	    break;
-	case ELEMENT_CATEGORY:
-	    return ( gsb_transactions_list_sort_by_category ( transaction_number_1,
-							      transaction_number_2));
-	    break;
-	case ELEMENT_MARK:
-	    return ( gsb_transactions_list_sort_by_mark ( transaction_number_1,
-							  transaction_number_2));
-	    break;
-	case ELEMENT_VOUCHER:
-	    return ( gsb_transactions_list_sort_by_voucher ( transaction_number_1,
-							     transaction_number_2));
-	    break;
-	case ELEMENT_NOTES:
-	    return ( gsb_transactions_list_sort_by_notes ( transaction_number_1,
-							   transaction_number_2));
-	    break;
-	case ELEMENT_BANK:
-	    return ( gsb_transactions_list_sort_by_bank ( transaction_number_1,
-							  transaction_number_2));
-	    break;
-	case ELEMENT_NO:
-	    return ( gsb_transactions_list_sort_by_no ( transaction_number_1,
-							transaction_number_2));
-	    break;
-	case ELEMENT_CHQ:
-	    return ( gsb_transactions_list_sort_by_chq ( transaction_number_1,
-							 transaction_number_2));
-	    break;
-	default :
-	    tmpstr = g_strdup_printf ( _("Ask for the sort number %d which doesn't exist... return by date"),
-	                              element_number );
-	    warning_debug (tmpstr);
-	    g_free(tmpstr);
-	    return ( gsb_transactions_list_sort_by_date ( transaction_number_1,
-							  transaction_number_2));
-    }
+	transactions_list_primary_sorting = primary_sort;
 }
 
-
-
 /**
- * used to compare the 2 dates first, and if they are the same
- * the 2 no of transactions to find the good return for sort
- * called at the end of each sort test, if they are equal
  *
- * \param none but the local variables transaction_number_1 and transaction_number_2 MUST be set
  *
- * \return -1 if transaction_number_1 is above transaction_number_2
- * */
-gint gsb_transactions_list_sort_by_date_and_no ( gint transaction_number_1,
-                        gint transaction_number_2 )
+ * \param
+ *
+ * \return
+ **/
+void gsb_transactions_list_set_secondary_sort (gint secondary_sort)
 {
-    gint return_value;
-
-    if ( !gsb_data_transaction_get_date (transaction_number_1) )
-    {
-    return 1;
-    }
-    if ( !gsb_data_transaction_get_date (transaction_number_2) )
-    {
-    return -1;
-    }
-
-    /* i tried to set in the transactions a value for date as a gint as yyyymmdd
-     * and here only do (gint transaction_1_date) - (gint transaction_2_date)
-     * to increase the speed, but change nothing (perhaps 0,05sec for 250000 rows...)
-     * so let like that */
-    return_value = g_date_compare ( gsb_data_transaction_get_date (transaction_number_1),
-                        gsb_data_transaction_get_date (transaction_number_2));
-
-    /* no difference in the dates, sort by number of transaction */
-    if ( !return_value )
-    return_value = transaction_number_1 - transaction_number_2;
-
-    return return_value;
+	transactions_list_secondary_sorting = secondary_sort;
 }
 
-
 /**
- * compared by date and by amount
+ * return a key which keeps the order of the signed numbers
  *
- * \param none but the local variables transaction_number_1 and transaction_number_2 MUST be set
+ * \param value
  *
- * \return -1 if amount_2 is above amount_number_1
- * */
-gint gsb_transactions_list_sort_by_date_and_amount ( gint transaction_number_1,
-                        gint transaction_number_2 )
+ * \return the key of the value
+ **/
+static guint64 gsb_transactions_list_sort_key_from_gint64 (gint64 value)
 {
-    gint return_value;
-    GsbReal amount_1;
-    GsbReal amount_2;
-
-    if ( !gsb_data_transaction_get_date (transaction_number_1) )
-    {
-        return 1;
-    }
-    if ( !gsb_data_transaction_get_date (transaction_number_2) )
-    {
-        return -1;
-    }
-
-    return_value = g_date_compare ( gsb_data_transaction_get_date (transaction_number_1),
-                        gsb_data_transaction_get_date (transaction_number_2));
-
-    if ( return_value == 0 )
-    {
-        /* no difference in the dates, sort by amount of transaction */
-        amount_1 = gsb_data_transaction_get_amount ( transaction_number_1 );
-        amount_2 = gsb_data_transaction_get_amount ( transaction_number_2 );
-        return_value = (gint)(amount_2.mantissa - amount_1.mantissa);
-        if ( return_value == 0 )
-            return_value = transaction_number_1 - transaction_number_2;
-    }
-
-    return return_value;
+	return (guint64) value ^ (G_GUINT64_CONSTANT (1) << 63);
 }
 
-
 /**
- * compared by date and by party
+ * return the key of a date, the transactions without date are set after the others
  *
- * \param none but the local variables transaction_number_1 and transaction_number_2 MUST be set
+ * \param date
  *
- * \return -1 if amount_2 is above amount_number_1
- * */
-gint gsb_transactions_list_sort_by_date_and_party ( gint transaction_number_1,
-                        gint transaction_number_2 )
+ * \return the julian day of the date or SORT_KEY_NONE
+ **/
+static guint64 gsb_transactions_list_sort_key_from_date (const GDate *date)
 {
-    gint return_value;
-
-    if ( !gsb_data_transaction_get_date (transaction_number_1) )
-    {
-        return 1;
-    }
-    if ( !gsb_data_transaction_get_date (transaction_number_2) )
-    {
-        return -1;
-    }
-
-    return_value = g_date_compare ( gsb_data_transaction_get_date (transaction_number_1),
-                        gsb_data_transaction_get_date (transaction_number_2));
-
-    if ( return_value == 0 )
-    {
-        /* no difference in the dates, sort by party */
-        return_value = gsb_transactions_list_sort_by_party ( transaction_number_1,
-                        transaction_number_2 );
-    }
+	if (!date)
+		return SORT_KEY_NONE;
 
-    return return_value;
+	return g_date_get_julian (date);
 }
 
-
 /**
- * used to compare 2 iters and sort the by no of transaction
- * always put the white line below
+ * set a word of the key with the id of a string,
+ * the id will be replaced by the rank of the string before sorting
  *
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
+ * \param key
+ * \param word
+ * \param strings
+ * \param string		the string, NULL to set the key before the other strings
  *
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_no ( gint transaction_number_1,
-                        gint transaction_number_2 )
+ * \return
+ **/
+static void gsb_transactions_list_sort_key_set_string (TransactionsListSortKey *key,
+													   gint word,
+													   TransactionsListSortStrings *strings,
+													   const gchar *string)
 {
-    return transaction_number_1 - transaction_number_2;
-}
+	gpointer id;
+
+	if (!string)
+	{
+		key->words[word] = 0;
+		return;
+	}
 
+	if (!g_hash_table_lookup_extended (strings->ids, string, NULL, &id))
+	{
+		gchar *tmp_str;
+
+		id = GUINT_TO_POINTER (strings->collate_keys->len);
+		tmp_str = g_utf8_casefold (string, -1);
+		g_ptr_array_add (strings->collate_keys, g_utf8_collate_key (tmp_str, -1));
+		g_free (tmp_str);
+		g_hash_table_insert (strings->ids, g_strdup (string), id);
+	}
 
+	key->words[word] = GPOINTER_TO_UINT (id);
+	key->string_words |= 1 << word;
+}
 
 /**
- * used to compare 2 iters and sort the by date first, and no
- * or amount transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_date ( gint transaction_number_1,
-                        gint transaction_number_2 )
+ * set the words of the key for a sort by date,
+ * the secondary sort give the order of the transactions of the same day
+ *
+ * \param key
+ * \param word				the first word to set, the next one is used by the secondary sort
+ * \param transaction_number
+ * \param strings
+ *
+ * \return
+ **/
+static void gsb_transactions_list_sort_key_set_date (TransactionsListSortKey *key,
+													 gint word,
+													 gint transaction_number,
+													 TransactionsListSortStrings *strings)
 {
-    if (transactions_list_secondary_sorting == 1 )
-        return gsb_transactions_list_sort_by_date_and_amount (
-                        transaction_number_1, transaction_number_2 );
-    else if (transactions_list_secondary_sorting == 2 )
-        return gsb_transactions_list_sort_by_date_and_party (
-                        transaction_number_1, transaction_number_2 );
-    else
-        return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
+	key->words[word] = gsb_transactions_list_sort_key_from_date (gsb_data_transaction_get_date (transaction_number));
+
+	if (transactions_list_secondary_sorting == 1)
+		key->words[word + 1] = SORT_KEY_NONE - gsb_transactions_list_sort_key_from_gint64 (
+							   gsb_data_transaction_get_amount (transaction_number).mantissa);
+	else if (transactions_list_secondary_sorting == 2)
+		gsb_transactions_list_sort_key_set_string (key,
+												   word + 1,
+												   strings,
+												   gsb_data_payee_get_name (gsb_data_transaction_get_party_number (transaction_number),
+																			TRUE));
 }
 
-
 /**
- * used to compare 2 iters and sort the by value date or date if not exist
- * always put the white line below
+ * set the words of the key for the element sorted, then the words which
+ * order the transactions with the same element (date, number, payee...)
  *
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
+ * \param key
+ * \param element_number
+ * \param transaction_number
+ * \param strings
  *
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_value_date ( gint transaction_number_1,
-                        gint transaction_number_2 )
+ * \return
+ **/
+static void gsb_transactions_list_sort_key_set_element (TransactionsListSortKey *key,
+														gint element_number,
+														gint transaction_number,
+														TransactionsListSortStrings *strings)
 {
-    gint return_value;
-    const GDate *value_date_1 = NULL;
-    const GDate *value_date_2 = NULL;
-
-	if (transactions_list_primary_sorting == 2)
-		return gsb_transactions_list_sort_by_date (transaction_number_1, transaction_number_2);
+	guint64 *words;
+	gchar *tmp_str;
 
-   /* need to work a little more here because value date is not obligatory filled,
-     * if we compare 2 transactions and 1 has no value date, set the value date before */
-    value_date_1 = gsb_data_transaction_get_value_date ( transaction_number_1 );
-    if ( !value_date_1 && !transactions_list_primary_sorting )
-        value_date_1 = gsb_data_transaction_get_date ( transaction_number_1 );
-
-    value_date_2 = gsb_data_transaction_get_value_date ( transaction_number_2 );
-    if ( !value_date_2 && !transactions_list_primary_sorting )
-        value_date_2 = gsb_data_transaction_get_date ( transaction_number_2 );
-
-    if ( value_date_1 )
-    {
-        if (value_date_2)
-            return_value = g_date_compare ( value_date_1, value_date_2);
-        else
-            return_value = -1;
-    }
-    else
-    {
-        if (value_date_2)
-            return_value = 1;
-        else
-            return gsb_transactions_list_sort_by_date ( transaction_number_1, transaction_number_2 );
-    }
+	words = key->words + SORT_KEY_WORD_ELEMENT;
 
-    if ( return_value )
-        return return_value;
-    else
-        return gsb_transactions_list_sort_initial_by_secondary_key (
-                        transaction_number_1, transaction_number_2 );
+	switch (element_number)
+	{
+		case ELEMENT_VALUE_DATE:
+		{
+			const GDate *value_date;
+
+			if (transactions_list_primary_sorting == 2)
+			{
+				gsb_transactions_list_sort_key_set_date (key, SORT_KEY_WORD_ELEMENT, transaction_number, strings);
+				break;
+			}
+
+			value_date = gsb_data_transaction_get_value_date (transaction_number);
+			if (!value_date && !transactions_list_primary_sorting)
+				value_date = gsb_data_transaction_get_date (transaction_number);
+
+			if (!value_date)
+			{
+				/* the transactions without value date are sorted by date after the others */
+				words[0] = SORT_KEY_NONE;
+				gsb_transactions_list_sort_key_set_date (key, SORT_KEY_WORD_ELEMENT + 1, transaction_number, strings);
+				break;
+			}
+
+			words[0] = g_date_get_julian (value_date);
+			switch (transactions_list_secondary_sorting)
+			{
+				case 1:
+					words[1] = SORT_KEY_NONE - gsb_transactions_list_sort_key_from_gint64 (
+							   gsb_data_transaction_get_adjusted_amount (transaction_number, -1).mantissa);
+					words[2] = gsb_transactions_list_sort_key_from_date (gsb_data_transaction_get_date (transaction_number));
+					break;
+				case 2:
+					gsb_transactions_list_sort_key_set_string (key,
+															   SORT_KEY_WORD_ELEMENT + 1,
+															   strings,
+															   gsb_data_payee_get_name (
+															   gsb_data_transaction_get_party_number (transaction_number),
+															   TRUE));
+					words[2] = gsb_transactions_list_sort_key_from_date (gsb_data_transaction_get_date (transaction_number));
+					break;
+				case 3:
+					words[1] = gsb_transactions_list_sort_key_from_date (gsb_data_transaction_get_date (transaction_number));
+					break;
+				default:
+					/* sort by transaction number */
+					break;
+			}
+			break;
+		}
+		case ELEMENT_PARTY:
+			gsb_transactions_list_sort_key_set_string (key,
+													   SORT_KEY_WORD_ELEMENT,
+													   strings,
+													   gsb_data_payee_get_name (gsb_data_transaction_get_party_number (transaction_number),
+																				TRUE));
+			words[1] = gsb_transactions_list_sort_key_from_date (gsb_data_transaction_get_date (transaction_number));
+			break;
+		case ELEMENT_BUDGET:
+			tmp_str = gsb_data_budget_get_name (gsb_data_transaction_get_budgetary_number (transaction_number),
+												gsb_data_transaction_get_sub_budgetary_number (transaction_number),
+												NULL);
+			gsb_transactions_list_sort_key_set_string (key, SORT_KEY_WORD_ELEMENT, strings, tmp_str);
+			g_free (tmp_str);
+			words[1] = gsb_transactions_list_sort_key_from_date (gsb_data_transaction_get_date (transaction_number));
+			break;
+		case ELEMENT_CREDIT:
+			words[0] = gsb_transactions_list_sort_key_from_gint64 (
+					   gsb_data_transaction_get_adjusted_amount (transaction_number, -1).mantissa);
+			words[1] = gsb_transactions_list_sort_key_from_date (gsb_data_transaction_get_date (transaction_number));
+			break;
+		case ELEMENT_DEBIT:
+		case ELEMENT_AMOUNT:
+			words[0] = SORT_KEY_NONE - gsb_transactions_list_sort_key_from_gint64 (
+					   gsb_data_transaction_get_adjusted_amount (transaction_number, -1).mantissa);
+			words[1] = gsb_transactions_list_sort_key_from_date (gsb_data_transaction_get_date (transaction_number));
+			break;
+		case ELEMENT_PAYMENT_TYPE:
+		{
+			const gchar *content;
+			const gchar *name;
+
+			name = gsb_data_payment_get_name (gsb_data_transaction_get_method_of_payment_number (transaction_number));
+			content = gsb_data_transaction_get_method_of_payment_content (transaction_number);
+			gsb_transactions_list_sort_key_set_string (key, SORT_KEY_WORD_ELEMENT, strings, name ? name : "");
+			gsb_transactions_list_sort_key_set_string (key, SORT_KEY_WORD_ELEMENT + 1, strings, content ? content : "");
+			words[2] = gsb_transactions_list_sort_key_from_date (gsb_data_transaction_get_date (transaction_number));
+			break;
+		}
+		case ELEMENT_RECONCILE_NB:
+		{
+			const gchar *name;
+
+			name = gsb_data_reconcile_get_name (gsb_data_transaction_get_reconcile_number (transaction_number));
+			gsb_transactions_list_sort_key_set_string (key, SORT_KEY_WORD_ELEMENT, strings, name ? name : "");
+			words[1] = gsb_transactions_list_sort_key_from_date (gsb_data_transaction_get_date (transaction_number));
+			break;
+		}
+		case ELEMENT_EXERCICE:
+		{
+			GDate *date;
+
+			/* the transactions without financial year are set before the others */
+			date = gsb_data_fyear_get_beginning_date (gsb_data_transaction_get_financial_year_number (transaction_number));
+			words[0] = date ? g_date_get_julian (date) : 0;
+			words[1] = gsb_transactions_list_sort_key_from_date (gsb_data_transaction_get_date (transaction_number));
+			break;
+		}
+		case ELEMENT_CATEGORY:
+			tmp_str = gsb_data_transaction_get_category_real_name (transaction_number);
+			gsb_transactions_list_sort_key_set_string (key, SORT_KEY_WORD_ELEMENT, strings, tmp_str ? tmp_str : "");
+			g_free (tmp_str);
+			words[1] = gsb_transactions_list_sort_key_from_date (gsb_data_transaction_get_date (transaction_number));
+			break;
+		case ELEMENT_MARK:
+			words[0] = gsb_transactions_list_sort_key_from_gint64 (gsb_data_transaction_get_marked_transaction (transaction_number));
+			words[1] = gsb_transactions_list_sort_key_from_date (gsb_data_transaction_get_date (transaction_number));
+			break;
+		case ELEMENT_VOUCHER:
+		case ELEMENT_NOTES:
+		case ELEMENT_BANK:
+		case ELEMENT_CHQ:
+		{
+			const gchar *string;
+
+			if (element_number == ELEMENT_VOUCHER)
+				string = gsb_data_transaction_get_voucher (transaction_number);
+			else if (element_number == ELEMENT_NOTES)
+				string = gsb_data_transaction_get_notes (transaction_number);
+			else if (element_number == ELEMENT_BANK)
+				string = gsb_data_transaction_get_bank_references (transaction_number);
+			else
+				string = gsb_data_transaction_get_method_of_payment_content (transaction_number);
+
+			gsb_transactions_list_sort_key_set_string (key, SORT_KEY_WORD_ELEMENT, strings, string ? string : "");
+			words[1] = gsb_transactions_list_sort_key_from_date (gsb_data_transaction_get_date (transaction_number));
+			break;
+		}
+		case ELEMENT_NO:
+			/* sort by transaction number */
+			break;
+		case ELEMENT_DATE:
+		case ELEMENT_BALANCE:
+		default:
+			/* balance, normally, shouldn't be here... in case, give back the date */
+			gsb_transactions_list_sort_key_set_date (key, SORT_KEY_WORD_ELEMENT, transaction_number, strings);
+			break;
+	}
 }
 
-
-/** used to compare 2 iters and sort the by party first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_party ( gint transaction_number_1,
-                        gint transaction_number_2 )
+/**
+ * fill the key of a record
+ *
+ * \param key				the key with the record set
+ * \param element_number
+ * \param descending		TRUE for a descending sort
+ * \param strings
+ *
+ * \return
+ **/
+static void gsb_transactions_list_sort_key_fill (TransactionsListSortKey *key,
+												 gint element_number,
+												 gboolean descending,
+												 TransactionsListSortStrings *strings)
 {
-    gint return_value;
-    gint party_number_1;
-    gint party_number_2;
-
-    party_number_1 = gsb_data_transaction_get_party_number ( transaction_number_1 );
-    party_number_2 = gsb_data_transaction_get_party_number ( transaction_number_2 );
-
-    if (  party_number_1 == party_number_2 )
-	    return_value = gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-    else
-    {
-        const gchar *temp_1;
-        const gchar *temp_2;
-
-        temp_1 = gsb_data_payee_get_name ( party_number_1, TRUE );
-        if ( temp_1 == NULL )
-            return -1;
-
-        temp_2 = gsb_data_payee_get_name ( party_number_2, TRUE );
-        if ( temp_2 == NULL )
-            return 1;
+	CustomRecord *record;
+	gint transaction_number;
+	guint32 number;
 
-        /* g_utf8_collate is said not very fast, must try with big big account to check
-         * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-        return_value = g_utf8_collate ( g_utf8_casefold ( temp_1, -1 ),
-                        g_utf8_casefold ( temp_2, -1 ));
-    }
+	record = key->record;
 
-    if ( return_value )
-        return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
+	/* the archives are at the top of the list, by number of archive */
+	if (record->what_is_line == IS_ARCHIVE)
+	{
+		key->words[0] = (guint32) gsb_data_archive_store_get_archive_number (
+						gsb_data_archive_store_get_number (record->transaction_pointer));
+		return;
+	}
 
+	/* the white line is always at the end of the list */
+	transaction_number = gsb_data_transaction_get_transaction_number (record->transaction_pointer);
+	if (transaction_number <= 0)
+	{
+		key->words[0] = SORT_KEY_GROUP_WHITE_LINE;
+		key->words[SORT_KEY_WORD_NUMBER] = record->line_in_transaction;
+		return;
+	}
 
-/** used to compare 2 iters and sort the by budgetary first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_budget ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-    gint budgetary_number_1;
-    gint budgetary_number_2;
-    gint sub_budgetary_number_1;
-    gint sub_budgetary_number_2;
-
-    budgetary_number_1 = gsb_data_transaction_get_budgetary_number ( transaction_number_1 );
-    budgetary_number_2 = gsb_data_transaction_get_budgetary_number ( transaction_number_2 );
-    sub_budgetary_number_1 = gsb_data_transaction_get_sub_budgetary_number ( transaction_number_1 );
-    sub_budgetary_number_2 = gsb_data_transaction_get_sub_budgetary_number ( transaction_number_2 );
-
-    if ( budgetary_number_1 == budgetary_number_2
-	 &&
-	 sub_budgetary_number_1 == sub_budgetary_number_2 )
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-    else
-    {
-        const gchar *temp_1;
-        const gchar *temp_2;
-
-        temp_1 = gsb_data_budget_get_name ( budgetary_number_1,
-                            sub_budgetary_number_1,
-                            NULL );
-        if ( temp_1 == NULL )
-            return -1;
-
-        temp_2 = gsb_data_budget_get_name ( budgetary_number_2,
-                            sub_budgetary_number_2,
-                            NULL);
-        if ( temp_2 == NULL )
-            return 1;
-
-        /* g_utf8_collate is said not very fast, must try with big big account to check
-         * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-        return_value = g_utf8_collate ( g_utf8_casefold ( temp_1, -1 ),
-                        g_utf8_casefold ( temp_2, -1 ) );
-    }
+	/* the lines of a transaction keep their order whatever the sort order */
+	key->words[0] = SORT_KEY_GROUP_TRANSACTION;
+	number = descending ? G_MAXUINT32 - transaction_number : (guint32) transaction_number;
+	key->words[SORT_KEY_WORD_NUMBER] = ((guint64) number << 32) | (guint32) record->line_in_transaction;
 
-    if ( return_value )
-	    return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
+	gsb_transactions_list_sort_key_set_element (key, element_number, transaction_number, strings);
 }
 
-
 /**
- * used to compare 2 iters and sort the by credit amount first, and
- * by date and no transaction after
- * always put the white line below
+ * compare 2 strings by their collate keys
  *
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
+ * \param id_1
+ * \param id_2
+ * \param collate_keys
  *
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_credit ( gint transaction_number_1,
-                        gint transaction_number_2 )
+ * \return -1 if id_1 is before id_2
+ **/
+static gint gsb_transactions_list_sort_strings_compare (const guint *id_1,
+														const guint *id_2,
+														GPtrArray *collate_keys)
 {
-    gint return_value;
-
-    /* for the amounts, we have to check also the currency */
-    return_value = gsb_real_cmp ( gsb_data_transaction_get_adjusted_amount ( transaction_number_1, -1),
-				  gsb_data_transaction_get_adjusted_amount ( transaction_number_2, -1));
-
-    if ( return_value )
-	    return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
+	return strcmp (g_ptr_array_index (collate_keys, *id_1), g_ptr_array_index (collate_keys, *id_2));
 }
 
-
-
-/** used to compare 2 iters and sort the by debit amount first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_debit ( gint transaction_number_1,
-                        gint transaction_number_2 )
+/**
+ * replace the id of the strings in the keys by the rank of the strings,
+ * the equal strings have the same rank and the rank 0 is kept for no string
+ *
+ * \param strings
+ * \param keys
+ * \param nbre_keys
+ *
+ * \return
+ **/
+static void gsb_transactions_list_sort_strings_rank (TransactionsListSortStrings *strings,
+													 TransactionsListSortKey *keys,
+													 gint nbre_keys)
 {
-    gint return_value;
-
-    /* for the amounts, we have to check also the currency */
-    return_value = gsb_real_cmp ( gsb_data_transaction_get_adjusted_amount ( transaction_number_2, -1),
-				  gsb_data_transaction_get_adjusted_amount ( transaction_number_1, -1));
-
-    if ( return_value )
-	    return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
-
+	guint *ids;
+	guint *ranks;
+	guint nbre_strings;
+	guint rank = 0;
+	guint i;
+	gint j;
+
+	nbre_strings = strings->collate_keys->len;
+	if (nbre_strings == 0)
+		return;
+
+	ids = g_new (guint, nbre_strings);
+	for (i = 0; i < nbre_strings; i++)
+		ids[i] = i;
+
+	g_qsort_with_data (ids,
+					   nbre_strings,
+					   sizeof (guint),
+					   (GCompareDataFunc) gsb_transactions_list_sort_strings_compare,
+					   strings->collate_keys);
+
+	ranks = g_new (guint, nbre_strings);
+	for (i = 0; i < nbre_strings; i++)
+	{
+		if (i == 0 || gsb_transactions_list_sort_strings_compare (&ids[i - 1], &ids[i], strings->collate_keys))
+			rank++;
+		ranks[ids[i]] = rank;
+	}
 
+	for (j = 0; j < nbre_keys; j++)
+	{
+		gint word;
 
-/** used to compare 2 iters and sort the by amount first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_amount ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
+		if (!keys[j].string_words)
+			continue;
 
-    /* for the amounts, we have to check also the currency */
-    return_value = gsb_real_cmp ( gsb_data_transaction_get_adjusted_amount ( transaction_number_2, -1),
-				  gsb_data_transaction_get_adjusted_amount ( transaction_number_1, -1));
+		for (word = 0; word < SORT_KEY_WORDS; word++)
+			if (keys[j].string_words & (1 << word))
+				keys[j].words[word] = ranks[keys[j].words[word]];
+	}
 
-    if ( return_value )
-	    return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no (transaction_number_1, transaction_number_2);
+	g_free (ids);
+	g_free (ranks);
 }
 
-
-
-/** used to compare 2 iters and sort the by type first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_type ( gint transaction_number_1,
-                        gint transaction_number_2 )
+/**
+ * sort the keys by their words with a LSD radix sort,
+ * the digits which are the same for all the keys are skipped
+ *
+ * \param keys
+ * \param nbre_keys
+ *
+ * \return
+ **/
+static void gsb_transactions_list_sort_radix (TransactionsListSortKey **keys,
+											  gint nbre_keys)
 {
-    gint return_value;
+	TransactionsListSortKey **src;
+	TransactionsListSortKey **dest;
+	guint *count;
+	gint word;
 
-    /* if it's the same type, we sort by the content of the types */
+	src = keys;
+	dest = g_new (TransactionsListSortKey *, nbre_keys);
+	count = g_new (guint, SORT_RADIX_SIZE);
 
-    if ( gsb_data_transaction_get_method_of_payment_number ( transaction_number_1) == gsb_data_transaction_get_method_of_payment_number ( transaction_number_2))
-    {
-	return_value = g_utf8_collate ( g_utf8_casefold ( gsb_data_transaction_get_method_of_payment_content ( transaction_number_1) ? gsb_data_transaction_get_method_of_payment_content ( transaction_number_1) : "",
-							  -1 ),
-					g_utf8_casefold ( gsb_data_transaction_get_method_of_payment_content ( transaction_number_2) ? gsb_data_transaction_get_method_of_payment_content ( transaction_number_2) : "",
-							  -1 ));
+	for (word = SORT_KEY_WORDS - 1; word >= 0; word--)
+	{
+		gint shift;
 
-	if ( !return_value )
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-    }
-    else
-    {
-	const gchar *temp_1;
-	const gchar *temp_2;
-
-	temp_1 = gsb_data_payment_get_name (gsb_data_transaction_get_method_of_payment_number (transaction_number_1));
-	temp_2 = gsb_data_payment_get_name (gsb_data_transaction_get_method_of_payment_number (transaction_number_2));
-
-	/* g_utf8_collate is said not very fast, must try with big big account to check
-	 * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-	return_value = g_utf8_collate ( g_utf8_casefold ( temp_1 ? temp_1 : "",
-							  -1 ),
-					g_utf8_casefold ( temp_2 ? temp_2 : "",
-							  -1 ));
-    }
+		for (shift = 0; shift < 64; shift += SORT_RADIX_BITS)
+		{
+			TransactionsListSortKey **tmp;
+			guint position = 0;
+			gint digit;
+			gint i;
 
-    if ( return_value )
-	return return_value;
-    else
-    {
-	/* 	it seems that the 2 types are different no but same spell... */
+			memset (count, 0, SORT_RADIX_SIZE * sizeof (guint));
+			for (i = 0; i < nbre_keys; i++)
+				count[(src[i]->words[word] >> shift) & (SORT_RADIX_SIZE - 1)]++;
 
-	return_value = g_utf8_collate ( g_utf8_casefold ( gsb_data_transaction_get_method_of_payment_content ( transaction_number_1)? gsb_data_transaction_get_method_of_payment_content ( transaction_number_1): "",
-							  -1 ),
-					g_utf8_casefold ( gsb_data_transaction_get_method_of_payment_content ( transaction_number_2)? gsb_data_transaction_get_method_of_payment_content ( transaction_number_2): "",
-							  -1 ));
+			if (count[(src[0]->words[word] >> shift) & (SORT_RADIX_SIZE - 1)] == (guint) nbre_keys)
+				continue;
 
-	if ( !return_value )
-		return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-    }
-    return return_value;
-}
+			for (digit = 0; digit < SORT_RADIX_SIZE; digit++)
+			{
+				guint nbre = count[digit];
 
+				count[digit] = position;
+				position += nbre;
+			}
 
+			for (i = 0; i < nbre_keys; i++)
+				dest[count[(src[i]->words[word] >> shift) & (SORT_RADIX_SIZE - 1)]++] = src[i];
 
-/** used to compare 2 iters and sort the by reconcile number first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_reconcile_nb ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
+			tmp = src;
+			src = dest;
+			dest = tmp;
+		}
+	}
 
-    if ( gsb_data_transaction_get_reconcile_number ( transaction_number_1) == gsb_data_transaction_get_reconcile_number ( transaction_number_2))
-		return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-    else
-    {
-	const gchar *temp_1;
-	const gchar *temp_2;
-
-	temp_1 = gsb_data_reconcile_get_name ( gsb_data_transaction_get_reconcile_number ( transaction_number_1));
-	temp_2 = gsb_data_reconcile_get_name ( gsb_data_transaction_get_reconcile_number ( transaction_number_2));
-
-	/* g_utf8_collate is said not very fast, must try with big big account to check
-	 * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-	return_value = g_utf8_collate ( g_utf8_casefold ( temp_1 ? temp_1 : "",
-							  -1 ),
-					g_utf8_casefold ( temp_2 ? temp_2 : "",
-							  -1 ));
-    }
+	if (src != keys)
+	{
+		memcpy (keys, src, nbre_keys * sizeof (TransactionsListSortKey *));
+		dest = src;
+	}
 
-    if ( return_value )
-    	return return_value;
-    else
-		return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
+	g_free (dest);
+	g_free (count);
 }
 
-
-
-/** used to compare 2 iters and sort the by financial_year first, and no
- * transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_financial_year ( gint transaction_number_1,
-                        gint transaction_number_2 )
+/**
+ * sort the visible rows of the list with a key computed once for each row:
+ * the lookups and the collations of the names are done once per row or per name,
+ * then the keys are sorted in linear time. The order is the same as
+ * gsb_transactions_list_sort or gsb_transactions_list_sort_initial
+ *
+ * \param custom_list
+ * \param initial			TRUE for the initial sort by value date
+ *
+ * \return
+ **/
+void gsb_transactions_list_sort_rows (CustomList *custom_list,
+									  gboolean initial)
 {
-    gint return_value;
+	TransactionsListSortKey *keys;
+	TransactionsListSortKey **sorted_keys;
+	TransactionsListSortStrings strings;
+	gint account_number;
+	gint element_number;
+	gint nbre_keys;
+	gint i;
+	gint64 trace_start;
+	gboolean descending;
 
-    if ( gsb_data_transaction_get_financial_year_number ( transaction_number_1)== gsb_data_transaction_get_financial_year_number ( transaction_number_2))
-		return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-    else
-    {
-	GDate *date_1;
-	GDate *date_2;
+	account_number = gsb_gui_navigation_get_current_account ();
+	if (account_number == -1)
+		return;
 
-	date_1 = gsb_data_fyear_get_beginning_date (gsb_data_transaction_get_financial_year_number ( transaction_number_1));
-	date_2 = gsb_data_fyear_get_beginning_date (gsb_data_transaction_get_financial_year_number ( transaction_number_2));
+	nbre_keys = custom_list->num_visibles_rows;
+	if (nbre_keys < 2)
+		return;
 
-	if ( date_1 )
+	if (initial)
 	{
-	    if ( date_2 )
-		return_value = g_date_compare ( date_1,
-						date_2 );
-	    else
-		return_value = 1;
+		element_number = ELEMENT_VALUE_DATE;
+		descending = FALSE;
 	}
 	else
 	{
-	    if ( date_2 )
-		return_value = -1;
-	    else
-		return_value = 0;
-	}
-    }
-
-    if ( return_value )
-	    return return_value;
-    else
-		return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-
-}
-
-
-
-/** used to compare 2 iters and sort the by category first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_category ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-    gchar *temp_1;
-    gchar *temp_2;
-
-    /** we want to take the name of the categ, so, either
-     * split of transaction
-     * transfer : ...
-     * categ : under-categ
-     * and after, we sort by str
-     * */
-
-    temp_1 = gsb_data_transaction_get_category_real_name ( transaction_number_1);
-    temp_2 = gsb_data_transaction_get_category_real_name ( transaction_number_2);
-
-    /* g_utf8_collate is said not very fast, must try with big big account to check
-     * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-    return_value = g_utf8_collate ( g_utf8_casefold ( temp_1 ? temp_1 : "",
-						      -1 ),
-				    g_utf8_casefold ( temp_2 ? temp_2 : "",
-						      -1 ));
-
-    g_free (temp_1);
-    g_free (temp_2);
-
-    if ( return_value )
-	    return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
-
-
-/** used to compare 2 iters and sort the by mark first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_mark ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-
-    return_value = gsb_data_transaction_get_marked_transaction (
-                        transaction_number_1)-
-                        gsb_data_transaction_get_marked_transaction (
-                        transaction_number_2);
-
-
-    if ( return_value )
-	    return return_value;
-    else
-		return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
-
-
+		element_number = gsb_data_account_get_element_sort (account_number, custom_list->sort_col);
 
-/** used to compare 2 iters and sort the by voucher first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_voucher ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-    const gchar *temp_1;
-    const gchar *temp_2;
-
-    temp_1 = gsb_data_transaction_get_voucher ( transaction_number_1);
-    temp_2 = gsb_data_transaction_get_voucher ( transaction_number_2);
-
-    /* g_utf8_collate is said not very fast, must try with big big account to check
-     * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-    return_value = g_utf8_collate ( g_utf8_casefold ( temp_1 ? temp_1 : "",
-						      -1 ),
-				    g_utf8_casefold ( temp_2 ? temp_2 : "",
-						      -1 ));
-
-    if ( return_value )
-	    return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
-
-
-/** used to compare 2 iters and sort the by notes first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_notes ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-    const gchar *temp_1;
-    const gchar *temp_2;
-
-    temp_1 = gsb_data_transaction_get_notes ( transaction_number_1);
-    temp_2 = gsb_data_transaction_get_notes ( transaction_number_2);
-
-    /* g_utf8_collate is said not very fast, must try with big big account to check
-     * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-    return_value = g_utf8_collate ( g_utf8_casefold ( temp_1 ? temp_1 : "",
-						      -1 ),
-				    g_utf8_casefold ( temp_2 ? temp_2 : "",
-						      -1 ));
-
-    if ( return_value )
-	    return return_value;
-    else
-	    return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
-
-
-
-/** used to compare 2 iters and sort the by bank first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_bank ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-    const gchar *temp_1;
-    const gchar *temp_2;
-
-    temp_1 = gsb_data_transaction_get_bank_references ( transaction_number_1);
-    temp_2 = gsb_data_transaction_get_bank_references ( transaction_number_2);
-
-    /* g_utf8_collate is said not very fast, must try with big big account to check
-     * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-    return_value = g_utf8_collate ( g_utf8_casefold ( temp_1 ? temp_1 : "",
-						      -1 ),
-				    g_utf8_casefold ( temp_2 ? temp_2 : "",
-						      -1 ));
-
-    if ( return_value )
-	return return_value;
-    else
-	return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
-
-
-
-/** used to compare 2 iters and sort the by cheque or no of transfer first, and
- * by date and no transaction after
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_by_chq ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    gint return_value;
-    const gchar *temp_1;
-    const gchar *temp_2;
-
-    temp_1 = gsb_data_transaction_get_method_of_payment_content ( transaction_number_1);
-    temp_2 = gsb_data_transaction_get_method_of_payment_content ( transaction_number_2);
-
-    /* g_utf8_collate is said not very fast, must try with big big account to check
-     * if it's enough, for me it's ok (cedric), eventually, change with gsb_strcasecmp */
-    return_value = g_utf8_collate ( g_utf8_casefold ( temp_1 ? temp_1 : "",
-						      -1 ),
-				    g_utf8_casefold ( temp_2 ? temp_2 : "",
-						      -1 ));
-
-    if ( return_value )
-	return return_value;
-    else
-	return gsb_transactions_list_sort_by_date_and_no ( transaction_number_1, transaction_number_2 );
-}
-
-
-/**
- * Called to sort transactions by key primary and secondary key
- *
- * \param model
- * \param iter_1
- * \param iter_2
- *
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_initial (CustomRecord **a,
-                        CustomRecord **b,
-                        CustomList *custom_list)
-{
-    gint account_number;
-    gint return_value;
-    CustomRecord *record_1 = NULL;
-    CustomRecord *record_2 = NULL;
+		/* if element_number = 0 it's forced to ELEMENT_VALUE_DATE */
+		if (element_number == 0)
+			element_number = ELEMENT_VALUE_DATE;
 
-    account_number = gsb_gui_navigation_get_current_account ();
-    if (account_number == -1)
-    {
-        /* normally cannot happen, except come here at the opening
-         * of grisbi, and must return 0 if we don't want a crash */
-        return 0;
-    }
+		descending = (custom_list->sort_order == GTK_SORT_DESCENDING);
+	}
 
-    /* i don't know why but sometimes there is a comparison between the 2 same rows... */
-    if (*a == *b)
-        return 0;
+	trace_start = gsb_trace_begin ();
+	keys = g_new0 (TransactionsListSortKey, nbre_keys);
+	sorted_keys = g_new (TransactionsListSortKey *, nbre_keys);
+	strings.ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	strings.collate_keys = g_ptr_array_new_with_free_func (g_free);
 
-    /* first of all, check the archive */
-    return_value = gsb_transactions_list_sort_check_archive ( *a, *b );
-    if (!return_value)
-    {
-        /* check the general tests (white line...) */
-        /* get the records */
-        record_1 = *a;
-        record_2 = *b;
-        return_value = gsb_transactions_list_sort_general_test ( record_1, record_2 );
-    }
+	for (i = 0; i < nbre_keys; i++)
+	{
+		keys[i].record = custom_list->visibles_rows[i];
+		gsb_transactions_list_sort_key_fill (&keys[i], element_number, descending, &strings);
+		sorted_keys[i] = &keys[i];
+	}
 
-    if (return_value)
-    {
-        /* we have already a returned value, but for archive or general test,
-         * the pos of the row need not to change, so must keep the return_value */
-        return return_value;
-    }
-    else
-    {
-        /* get the transaction numbers */
-        gint transaction_number_1;
-        gint transaction_number_2;
+	gsb_transactions_list_sort_strings_rank (&strings, keys, nbre_keys);
 
-        transaction_number_1 = gsb_data_transaction_get_transaction_number (record_1 -> transaction_pointer);
-        transaction_number_2 = gsb_data_transaction_get_transaction_number (record_2 -> transaction_pointer);
+	/* the element is reversed for a descending sort, the groups are not */
+	if (descending)
+	{
+		for (i = 0; i < nbre_keys; i++)
+		{
+			gint word;
 
-        return_value = gsb_transactions_list_sort_by_value_date ( transaction_number_1, transaction_number_2 );
-    }
+			if (keys[i].words[0] != SORT_KEY_GROUP_TRANSACTION)
+				continue;
 
-    return return_value;
-}
+			for (word = SORT_KEY_WORD_ELEMENT; word < SORT_KEY_WORD_NUMBER; word++)
+				keys[i].words[word] = SORT_KEY_NONE - keys[i].words[word];
+		}
+	}
 
+	gsb_transactions_list_sort_radix (sorted_keys, nbre_keys);
 
-/**
- * used to compare 2 iters and sort the by secondary key:
- * no or amount or payee_name
- * always put the white line below
- * \param model the GtkTreeModel
- * \param iter_1
- * \param iter_2
- * \return -1 if iter_1 is above iter_2
- * */
-gint gsb_transactions_list_sort_initial_by_secondary_key ( gint transaction_number_1,
-                        gint transaction_number_2 )
-{
-    if (transactions_list_secondary_sorting == 1 )
-        return gsb_transactions_list_sort_by_amount (
-                        transaction_number_1, transaction_number_2 );
-    else if (transactions_list_secondary_sorting == 2 )
-        return gsb_transactions_list_sort_by_party (
-                        transaction_number_1, transaction_number_2 );
-    else if (transactions_list_secondary_sorting == 3 )
-        return gsb_transactions_list_sort_by_date_and_no (
-                        transaction_number_1, transaction_number_2 );
-    else
-        return transaction_number_1 - transaction_number_2;
-}
+	for (i = 0; i < nbre_keys; i++)
+		custom_list->visibles_rows[i] = sorted_keys[i]->record;
 
-/**
- *
- *
- * \param
- *
- * \return
- **/
-void gsb_transactions_list_set_primary_sort (gint primary_sort)
-{
-	transactions_list_primary_sorting = primary_sort;
-}
+	g_hash_table_destroy (strings.ids);
+	g_ptr_array_free (strings.collate_keys, TRUE);
+	g_free (sorted_keys);
+	g_free (keys);
 
-/**
- *
- *
- * \param
- *
- * \return
- **/
-void gsb_transactions_list_set_secondary_sort (gint secondary_sort)
-{
-	transactions_list_secondary_sorting = secondary_sort;
+	gsb_trace_count ("transactions_list_sorted_rows", nbre_keys);
+	gsb_trace_end ("transactions_list_sort", trace_start);
 }
 
 /**
@@ -8,15 +8,11 @@
 /* START_DECLARATION */
 void	gsb_transactions_list_set_primary_sort		(gint primary_sort);
 void	gsb_transactions_list_set_secondary_sort	(gint secondary_sort);
-gint	gsb_transactions_list_sort					(CustomRecord **a,
-                        							 CustomRecord **b,
-                        							 CustomList *custom_list);
 gint	gsb_transactions_list_sort_check_archive	(CustomRecord *record_1,
 													 CustomRecord *record_2);
 gint	gsb_transactions_list_sort_general_test		(CustomRecord *record_1,
 													 CustomRecord *record_2);
-gint	gsb_transactions_list_sort_initial			(CustomRecord **a,
-                        CustomRecord **b,
-                        CustomList *custom_list);
+void	gsb_transactions_list_sort_rows				(CustomList *custom_list,
+													 gboolean initial);
 /* END_DECLARATION */
 #endif
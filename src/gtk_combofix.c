@@ -83,6 +83,13 @@ struct _GtkComboFixPrivate
 
     /* old entry */
     gchar *				old_entry;
+
+	/* keys of the rows, shared by the stores and freed with the lists */
+	GStringChunk *		keys;
+
+	/* key of the last text searched by the completion */
+	gchar *				completion_search;
+	gchar *				completion_key;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkComboFix, gtk_combofix, GTK_TYPE_BOX)
@@ -94,9 +101,18 @@ enum CombofixColumns
     COMBOFIX_COL_VISIBLE,               /* boolean : if that line has to be showed */
     COMBOFIX_COL_LIST_NUMBER,           /* int : the number of the list 0, 1 ou 2 (CREDIT DEBIT SPECIAL) */
     COMBOFIX_COL_SEPARATOR,             /* TRUE : if this is a separator */
+    COMBOFIX_COL_SORT_KEY,              /* pointer : collate key of the visible string */
     COMBOFIX_N_COLUMNS
 };
 
+enum CombofixCompletionColumns
+{
+	COMPLETION_COL_STRING = 0,			/* string : what we set in the entry */
+	COMPLETION_COL_MATCH_KEY,			/* pointer : string without accents compared with the entry */
+	COMPLETION_COL_ORDER_KEY,			/* pointer : collate key of the casefolded string */
+	COMPLETION_N_COLUMNS
+};
+
 enum CombofixKeyDirection
 {
     COMBOFIX_UP = 0,
@@ -108,6 +124,72 @@ enum CombofixKeyDirection
 /******************************************************************************/
 /* Private functions                                                          */
 /******************************************************************************/
+/**
+ * return the collate key of a string, stored in the keys of the combofix
+ *
+ * \param priv
+ * \param string
+ * \param casefold		TRUE to compute the key of the casefolded string
+ *
+ * \return a key which must not be freed
+ **/
+static const gchar *gtk_combofix_get_collate_key (GtkComboFixPrivate *priv,
+												  const gchar *string,
+												  gboolean casefold)
+{
+	const gchar *key;
+	gchar *tmp_str;
+
+	if (!string)
+		return NULL;
+
+	if (casefold)
+	{
+		gchar *str_to_free;
+
+		str_to_free = g_utf8_casefold (string, -1);
+		tmp_str = g_utf8_collate_key (str_to_free, -1);
+		g_free (str_to_free);
+	}
+	else
+		tmp_str = g_utf8_collate_key (string, -1);
+
+	key = g_string_chunk_insert_const (priv->keys, tmp_str);
+	g_free (tmp_str);
+
+	return key;
+}
+
+/**
+ * set a row of the completion with the text and its keys
+ *
+ * \param priv
+ * \param store
+ * \param iter
+ * \param text
+ *
+ * \return
+ **/
+static void gtk_combofix_completion_set_row (GtkComboFixPrivate *priv,
+											 GtkListStore *store,
+											 GtkTreeIter *iter,
+											 const gchar *text)
+{
+	const gchar *match_key;
+	gchar *tmp_str;
+
+	tmp_str = utils_str_remove_accents (text);
+	match_key = g_string_chunk_insert_const (priv->keys, tmp_str);
+	g_free (tmp_str);
+
+	gtk_list_store_set (store,
+						iter,
+						COMPLETION_COL_STRING, text,
+						COMPLETION_COL_MATCH_KEY, match_key,
+						COMPLETION_COL_ORDER_KEY, gtk_combofix_get_collate_key (priv, text, TRUE),
+						-1);
+}
+
 /**
  * positionne le bouton "Change" du formulaire si le compte destinataire
  * du transfert a une devise différente du compte de départ.
@@ -218,100 +300,85 @@ static void gtk_combofix_completion_insert_new_item (GtkComboFix *combofix,
 	GtkTreeModel *store;
 	GtkTreeIter iter;
 	GtkTreeIter new_iter;
+	const gchar *text_key;
     GtkComboFixPrivate *priv;
 
 	priv = gtk_combofix_get_instance_private (combofix);
 
 	completion = gtk_entry_get_completion (GTK_ENTRY (priv->entry));
 	store = gtk_entry_completion_get_model (completion);
+	text_key = gtk_combofix_get_collate_key (priv, text, TRUE);
 
 	if (gtk_tree_model_get_iter_first (store, &iter))
 	{
 		do
 		{
-			gchar *tmp_str;
-			gchar *str_to_free1;
-			gchar *str_to_free2;
+			const gchar *row_key;
 
-			gtk_tree_model_get (store, &iter, 0, &tmp_str, -1);
-			if (!tmp_str)
+			gtk_tree_model_get (store, &iter, COMPLETION_COL_ORDER_KEY, &row_key, -1);
+			if (!row_key)
 				continue;
 
-			str_to_free1 = g_utf8_casefold (text, -1);
-			str_to_free2 = g_utf8_casefold (tmp_str, -1);
-			if (g_utf8_collate (str_to_free1, str_to_free2) < 0)
+			if (strcmp (text_key, row_key) < 0)
 			{
 				gtk_list_store_insert_before (GTK_LIST_STORE (store), &new_iter, &iter);
-				gtk_list_store_set (GTK_LIST_STORE (store), &new_iter, 0, text, -1);
-				g_free (str_to_free1);
-				g_free (str_to_free2);
-				g_free (tmp_str);
+				gtk_combofix_completion_set_row (priv, GTK_LIST_STORE (store), &new_iter, text);
 
 				return;
 			}
-			g_free (str_to_free1);
-			g_free (str_to_free2);
-			g_free (tmp_str);
 		}
 		while (gtk_tree_model_iter_next (store, &iter));
 	}
 	else
 	{
 		gtk_list_store_append (GTK_LIST_STORE (store), &new_iter);
-		gtk_list_store_set (GTK_LIST_STORE (store), &new_iter, 0, text, -1);
+		gtk_combofix_completion_set_row (priv, GTK_LIST_STORE (store), &new_iter, text);
 	}
 }
 
 /**
+ * compare the text of the entry with the beginning of a row of the completion.
+ * The key of the text is computed once for each new text, the key of the row
+ * is stored in the model: the test of a row doesn't allocate anything
  *
+ * \param completion
+ * \param key
+ * \param iter
+ * \param combofix
  *
- * \param
- *
- * \return
+ * \return TRUE if the row begins with the text
  **/
 static gboolean  gtk_combofix_completion_match_func (GtkEntryCompletion *completion,
 													 const gchar *key,
 													 GtkTreeIter *iter,
-													 gpointer user_data)
+													 GtkComboFix *combofix)
 {
 	GtkTreeModel *model;
-	gchar *new_key;
-	gchar *new_text;
+	const gchar *row_key;
 	const gchar *search;
-	gchar *text;
-	gchar *tmp_text;
-	gssize nbre_bytes;
-
-	model = gtk_entry_completion_get_model (completion);
-	gtk_tree_model_get (model, iter, 0, &text, -1);
+    GtkComboFixPrivate *priv;
 
-	if (!text)
-		return FALSE;
+	priv = gtk_combofix_get_instance_private (combofix);
 
 	search = gtk_entry_get_text (GTK_ENTRY (gtk_entry_completion_get_entry (completion)));
 	if (!search)
 		return FALSE;
 
-	new_key = utils_str_remove_accents (search);
-	tmp_text = utils_str_remove_accents (text);
-	nbre_bytes = strlen (new_key);
-	new_text = g_strndup (tmp_text, nbre_bytes);
-	g_free (tmp_text);
-
-	if (g_strcmp0 (new_text, new_key) == 0)
+	if (g_strcmp0 (search, priv->completion_search))
 	{
-		g_free (new_key);
-		g_free (new_text);
-		return TRUE;
+		g_free (priv->completion_search);
+		g_free (priv->completion_key);
+		priv->completion_search = g_strdup (search);
+		priv->completion_key = utils_str_remove_accents (search);
 	}
-	else
-	{
-		g_free (new_key);
-		g_free (new_text);
+
+	model = gtk_entry_completion_get_model (completion);
+	gtk_tree_model_get (model, iter, COMPLETION_COL_MATCH_KEY, &row_key, -1);
+
+	if (!row_key)
 		return FALSE;
-	}
 
-	return FALSE;
+	return g_str_has_prefix (row_key, priv->completion_key);
 }
 
 /**
@@ -350,17 +417,19 @@ static void gtk_combofix_remove_for_report (GtkTreeModel *model,
 /**
  * vérifie si il existe un séparateur, l'ajoute si nécessaire
  *
- * \param model
+ * \param priv
  *
  * \return TRUE si un séparateur a été ajouté, FALSE sinon
  **/
-static gboolean gtk_combofix_search_for_report (GtkTreeModel *model)
+static gboolean gtk_combofix_search_for_report (GtkComboFixPrivate *priv)
 {
+    GtkTreeModel *model;
     GtkTreeIter iter;
     gchar *tmp_str;
     gboolean separator;
     gboolean valid;
 
+    model = GTK_TREE_MODEL (priv->store);
     valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL(model), &iter);
     while (valid)
     {
@@ -394,6 +463,7 @@ static gboolean gtk_combofix_search_for_report (GtkTreeModel *model)
                         COMBOFIX_COL_REAL_STRING, tmp_str,
                         COMBOFIX_COL_VISIBLE, TRUE,
                         COMBOFIX_COL_LIST_NUMBER, 1,
+                        COMBOFIX_COL_SORT_KEY, gtk_combofix_get_collate_key (priv, tmp_str, FALSE),
                         -1);
     g_free (tmp_str);
 	report_parent_iter = iter;
@@ -491,25 +561,26 @@ static gboolean gtk_combofix_search_for_text (GtkTreeModel *model,
  * fill a parent_iter of the model given in param
  * with the string given in param
  *
- * \param store
+ * \param priv
  * \param parent_iter
  * \param string
  * \param list_number 	the number of the list
  *
  * \return TRUE
  **/
-static gboolean gtk_combofix_fill_iter_parent (GtkTreeStore *store,
+static gboolean gtk_combofix_fill_iter_parent (GtkComboFixPrivate *priv,
 											   GtkTreeIter *iter_parent,
                         					   const gchar *string,
                         					   gint list_number)
 {
-    gtk_tree_store_append (store, iter_parent, NULL);
-    gtk_tree_store_set (store,
+    gtk_tree_store_append (priv->store, iter_parent, NULL);
+    gtk_tree_store_set (priv->store,
 						iter_parent,
 						COMBOFIX_COL_VISIBLE_STRING, string,
 						COMBOFIX_COL_REAL_STRING, string,
 						COMBOFIX_COL_VISIBLE, TRUE,
 						COMBOFIX_COL_LIST_NUMBER, list_number,
+						COMBOFIX_COL_SORT_KEY, gtk_combofix_get_collate_key (priv, string, FALSE),
 						-1);
 
     return TRUE;
@@ -519,14 +590,14 @@ static gboolean gtk_combofix_fill_iter_parent (GtkTreeStore *store,
  * fill a child_iter of the model given in param
  * with the string given in param
  *
- * \param store
+ * \param priv
  * \param parent_iter
  * \param string
  * \param list_number 	the number of the list
  *
  * \return TRUE
  **/
-static gboolean gtk_combofix_fill_iter_child (GtkTreeStore *store,
+static gboolean gtk_combofix_fill_iter_child (GtkComboFixPrivate *priv,
 											  GtkTreeIter *iter_parent,
                         					  const gchar *string,
                         					  const gchar *real_string,
@@ -534,13 +605,14 @@ static gboolean gtk_combofix_fill_iter_child (GtkTreeStore *store,
 {
     GtkTreeIter iter_child;
 
-    gtk_tree_store_append (store, &iter_child, iter_parent);
-    gtk_tree_store_set (store,
+    gtk_tree_store_append (priv->store, &iter_child, iter_parent);
+    gtk_tree_store_set (priv->store,
                         &iter_child,
                         COMBOFIX_COL_VISIBLE_STRING, string,
                         COMBOFIX_COL_REAL_STRING, real_string,
                         COMBOFIX_COL_VISIBLE, TRUE,
                         COMBOFIX_COL_LIST_NUMBER, list_number,
+                        COMBOFIX_COL_SORT_KEY, gtk_combofix_get_collate_key (priv, string, FALSE),
                         -1);
 
     return TRUE;
@@ -606,17 +678,17 @@ static gboolean gtk_combofix_fill_store (GtkComboFix *combofix,
             {
                 /* it's a child */
                 tmp_str = g_strconcat (last_parent, " : ", string + 1, NULL);
-                gtk_combofix_fill_iter_child (priv->store, &iter_parent, string + 1, tmp_str, list_number);
+                gtk_combofix_fill_iter_child (priv, &iter_parent, string + 1, tmp_str, list_number);
 
 				/* append a row in the completion */
 				gtk_list_store_append (GTK_LIST_STORE (completion_store), &new_iter);
-				gtk_list_store_set (GTK_LIST_STORE (completion_store), &new_iter, 0, tmp_str, -1);
+				gtk_combofix_completion_set_row (priv, GTK_LIST_STORE (completion_store), &new_iter, tmp_str);
                 g_free (tmp_str);
             }
             else
             {
                 /* it's a parent */
-                gtk_combofix_fill_iter_parent (priv->store, &iter_parent, string, list_number);
+                gtk_combofix_fill_iter_parent (priv, &iter_parent, string, list_number);
 				/* append a row in the completion ignore reports for payees */
 				if (priv->type == METATREE_PAYEE)
 				{
@@ -626,7 +698,7 @@ static gboolean gtk_combofix_fill_store (GtkComboFix *combofix,
 					if (g_utf8_collate (free_str1, free_str2))
 					{
 						gtk_list_store_append (GTK_LIST_STORE (completion_store), &new_iter);
-						gtk_list_store_set (GTK_LIST_STORE (completion_store), &new_iter, 0, string, -1);
+						gtk_combofix_completion_set_row (priv, GTK_LIST_STORE (completion_store), &new_iter, string);
 					}
 					g_free (free_str2);
 				}
@@ -653,13 +725,13 @@ static gboolean gtk_combofix_fill_store (GtkComboFix *combofix,
 						if (nbre_sub_division == 0)
 						{
 							gtk_list_store_append (GTK_LIST_STORE (completion_store), &new_iter);
-							gtk_list_store_set (GTK_LIST_STORE (completion_store), &new_iter, 0, string, -1);
+							gtk_combofix_completion_set_row (priv, GTK_LIST_STORE (completion_store), &new_iter, string);
 						}
 					}
 					else
 					{
 						gtk_list_store_append (GTK_LIST_STORE (completion_store), &new_iter);
-						gtk_list_store_set (GTK_LIST_STORE (completion_store), &new_iter, 0, string, -1);
+						gtk_combofix_completion_set_row (priv, GTK_LIST_STORE (completion_store), &new_iter, string);
 					}
 				}
 
@@ -1502,6 +1574,7 @@ static gboolean gtk_combofix_select_item (GtkComboFix *combofix,
  * the default function to sort the combofix,
  * if mixed is set, all the list will be sorted by alphabetic order,
  * else, for a complex combofix, each list will be sorted by itself
+ * the strings are compared with the collate keys stored in the model
  *
  * \param model_sort
  * \param iter_1
@@ -1517,10 +1590,8 @@ static gint gtk_combofix_default_sort_func (GtkTreeModel *model_sort,
 {
     gint list_number_1;
     gint list_number_2;
-    gchar *string_1;
-    gchar *string_2;
-    gchar *cmp_string_1;
-    gchar *cmp_string_2;
+    const gchar *key_1;
+    const gchar *key_2;
     gint return_value = 0;
     gboolean separator_1;
     gboolean separator_2;
@@ -1531,7 +1602,7 @@ static gint gtk_combofix_default_sort_func (GtkTreeModel *model_sort,
         gtk_tree_model_get (GTK_TREE_MODEL (model_sort),
 							iter_1,
 							COMBOFIX_COL_LIST_NUMBER, &list_number_1,
-							COMBOFIX_COL_VISIBLE_STRING, &string_1,
+							COMBOFIX_COL_SORT_KEY, &key_1,
 							COMBOFIX_COL_SEPARATOR, &separator_1,
 							-1);
     else
@@ -1541,7 +1612,7 @@ static gint gtk_combofix_default_sort_func (GtkTreeModel *model_sort,
         gtk_tree_model_get (GTK_TREE_MODEL (model_sort),
 							iter_2,
 							COMBOFIX_COL_LIST_NUMBER, &list_number_2,
-							COMBOFIX_COL_VISIBLE_STRING, &string_2,
+							COMBOFIX_COL_SORT_KEY, &key_2,
 							COMBOFIX_COL_SEPARATOR, &separator_2,
 							-1);
     else
@@ -1557,20 +1628,13 @@ static gint gtk_combofix_default_sort_func (GtkTreeModel *model_sort,
         if (separator_2)
             return -1;
 
-        if (string_1 == NULL)
+        if (key_1 == NULL)
             return -1;
-        if (string_2 == NULL)
+        if (key_2 == NULL)
             return 1;
 
-        cmp_string_1 = g_utf8_collate_key (string_1, -1);
-        cmp_string_2 = g_utf8_collate_key (string_2, -1);
-        return_value = strcmp (cmp_string_1, cmp_string_2);
-
-        g_free (cmp_string_1);
-        g_free (cmp_string_2);
+        return_value = strcmp (key_1, key_2);
     }
-    g_free (string_1);
-    g_free (string_2);
 
     return return_value;
 }
@@ -1647,14 +1711,14 @@ static void gtk_combofix_create_entry (GtkComboFix *combofix)
 	if (etat.combofix_case_sensitive)
 		gtk_entry_completion_set_match_func (completion,
 											 (GtkEntryCompletionMatchFunc) gtk_combofix_completion_match_func,
-											 NULL,
+											 combofix,
 											 NULL);
 	gtk_entry_completion_set_minimum_key_length (completion, a_conf->completion_minimum_key_length);
 	gtk_entry_completion_set_popup_single_match (completion, TRUE);
-	gtk_entry_completion_set_text_column (completion, 0);
+	gtk_entry_completion_set_text_column (completion, COMPLETION_COL_STRING);
 
 	/* set store */
-	completion_store = gtk_list_store_new (1, G_TYPE_STRING);
+	completion_store = gtk_list_store_new (COMPLETION_N_COLUMNS, G_TYPE_STRING, G_TYPE_POINTER, G_TYPE_POINTER);
 	gtk_entry_completion_set_model (completion, GTK_TREE_MODEL (completion_store));
 	g_object_unref (completion_store);
 
@@ -1740,7 +1804,8 @@ static void gtk_combofix_create_popup (GtkComboFix *combofix)
 									  G_TYPE_STRING,
 									  G_TYPE_BOOLEAN,
 									  G_TYPE_INT,
-									  G_TYPE_BOOLEAN);
+									  G_TYPE_BOOLEAN,
+									  G_TYPE_POINTER);
 
     /* we set the store in a filter to show only what is selected */
     priv->model_filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (priv->store), NULL);
@@ -1813,6 +1878,7 @@ static void gtk_combofix_init (GtkComboFix *combofix)
     priv->visible_items = 0;
 	priv->ignore_accents = TRUE;		/* reproduit le fonctionnement de la completion de gtk */
 	priv->minimum_key_length = 1;		/* la recherche commence au premier caractère */
+	priv->keys = g_string_chunk_new (4096);
 
     /* the combofix is a vbox */
     vbox = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
@@ -1864,6 +1930,9 @@ static void gtk_combofix_finalize (GObject *combofix)
     if (priv->old_entry && strlen (priv->old_entry))
         g_free (priv->old_entry);
 
+	g_free (priv->completion_search);
+	g_free (priv->completion_key);
+
     /* Unref/free the model first, to workaround gtk/gail bug #694711 */
     gtk_tree_view_set_model (GTK_TREE_VIEW (priv->tree_view), NULL);
     g_object_unref (priv->model_sort);
@@ -1873,6 +1942,9 @@ static void gtk_combofix_finalize (GObject *combofix)
     gtk_widget_destroy (priv->popup);
     g_object_unref (priv->popup);
 
+	/* the keys are used by the models until they are destroyed */
+	g_string_chunk_free (priv->keys);
+
     G_OBJECT_CLASS (gtk_combofix_parent_class)->finalize (combofix);
 }
 
@@ -2068,7 +2140,7 @@ void gtk_combofix_set_properties (GtkWidget *combofix)
 		{
 			gtk_entry_completion_set_match_func (completion,
 												 (GtkEntryCompletionMatchFunc) gtk_combofix_completion_match_func,
-												 NULL,
+												 combofix,
 												 NULL);
 		}
 	}
@@ -2128,7 +2200,7 @@ void gtk_combofix_set_case_sensitive (GtkComboFix *combofix,
 		{
 			gtk_entry_completion_set_match_func (completion,
 												 (GtkEntryCompletionMatchFunc) gtk_combofix_completion_match_func,
-												 NULL,
+												 combofix,
 												 NULL);
 		}
 	}
@@ -2237,6 +2309,9 @@ gboolean gtk_combofix_set_list (GtkComboFix *combofix,
 	if (GTK_LIST_STORE (completion_store))
 		gtk_list_store_clear (GTK_LIST_STORE (completion_store));
 
+	/* no more row uses the keys */
+	g_string_chunk_clear (priv->keys);
+
     tmp_list = list;
     length = g_slist_length (list);
 
@@ -2302,7 +2377,7 @@ void gtk_combofix_append_text (GtkComboFix *combofix,
 	if (pointeurs[1] && GINT_TO_POINTER (pointeurs[1]))
 		return;
 
-	gtk_combofix_fill_iter_parent (priv->store, &iter_parent, text, 0);
+	gtk_combofix_fill_iter_parent (priv, &iter_parent, text, 0);
 
     if (priv->old_entry && strlen (priv->old_entry))
         g_free (priv->old_entry);
@@ -2341,7 +2416,7 @@ void gtk_combofix_append_report (GtkComboFix *combofix,
 	/* initialisation iter à invalid probablement inutile */
 	report_parent_iter.stamp = 0;
     /* on cherche la partie etats on l'ajoute si nécessaire */
-    if (gtk_combofix_search_for_report (GTK_TREE_MODEL (priv->store)))
+    if (gtk_combofix_search_for_report (priv))
         priv->visible_items++;
 
     if (!report_parent_iter.stamp)
@@ -2354,7 +2429,7 @@ void gtk_combofix_append_report (GtkComboFix *combofix,
     /* sinon on l'ajoute dans la liste des tiers */
     tmp_str = g_strdup (_("Report"));
     tmp_str2 = g_strconcat (tmp_str, " : ", report_name, NULL);
-    gtk_combofix_fill_iter_child (priv->store, &report_parent_iter, report_name, tmp_str2, 1);
+    gtk_combofix_fill_iter_child (priv, &report_parent_iter, report_name, tmp_str2, 1);
     priv->visible_items++;
 	g_free (tmp_str);
 
@@ -2362,7 +2437,7 @@ void gtk_combofix_append_report (GtkComboFix *combofix,
 	completion = gtk_entry_get_completion (GTK_ENTRY (priv->entry));
 	completion_model = gtk_entry_completion_get_model (completion);
 	gtk_list_store_append (GTK_LIST_STORE (completion_model), &new_iter);
-	gtk_list_store_set (GTK_LIST_STORE (completion_model), &new_iter, 0, tmp_str2, -1);
+	gtk_combofix_completion_set_row (priv, GTK_LIST_STORE (completion_model), &new_iter, tmp_str2);
     g_free (tmp_str2);
 }
 
@@ -2379,6 +2454,7 @@ void gtk_combofix_remove_text (GtkComboFix *combofix,
 	GtkEntryCompletion *completion;
 	GtkTreeModel *completion_model;
     GtkTreeIter iter;
+	const gchar *text_key;
     gboolean case_sensitive;
     gboolean valid;
     GtkComboFixPrivate *priv;
@@ -2427,19 +2503,25 @@ void gtk_combofix_remove_text (GtkComboFix *combofix,
 	completion = gtk_entry_get_completion (GTK_ENTRY (priv->entry));
 	completion_model = gtk_entry_completion_get_model (completion);
     valid = gtk_tree_model_get_iter_first (completion_model, &iter);
+	text_key = gtk_combofix_get_collate_key (priv, text, TRUE);
 
     while (valid)
     {
         gchar *tmp_str;
+        const gchar *row_key;
 
-        gtk_tree_model_get (completion_model, &iter, 0, &tmp_str, -1);
+        gtk_tree_model_get (completion_model,
+							&iter,
+							COMPLETION_COL_STRING, &tmp_str,
+							COMPLETION_COL_ORDER_KEY, &row_key,
+							-1);
 
         if (case_sensitive && !strcmp (text, tmp_str))
         {
             g_free (tmp_str);
             break;
-}
-        else if (!g_utf8_collate (g_utf8_casefold (text, -1), g_utf8_casefold (tmp_str, -1)))
+		}
+        else if (!strcmp (text_key, row_key))
         {
             g_free (tmp_str);
             break;
@@ -2471,6 +2553,7 @@ void gtk_combofix_remove_report (GtkComboFix *combofix,
     GtkTreeIter iter;
     gchar *tmp_str;
     gchar *tmp_str2;
+	const gchar *report_key;
     gboolean valid;
     GtkComboFixPrivate *priv;
 
@@ -2541,17 +2624,24 @@ void gtk_combofix_remove_report (GtkComboFix *combofix,
 	completion = gtk_entry_get_completion (GTK_ENTRY (priv->entry));
 	completion_model = gtk_entry_completion_get_model (completion);
     valid = gtk_tree_model_get_iter_first (completion_model, &iter);
+	report_key = gtk_combofix_get_collate_key (priv, tmp_str2, TRUE);
 
     while (valid)
     {
-        gtk_tree_model_get (completion_model, &iter, 0, &tmp_str, -1);
+		const gchar *row_key;
+
+        gtk_tree_model_get (completion_model,
+							&iter,
+							COMPLETION_COL_STRING, &tmp_str,
+							COMPLETION_COL_ORDER_KEY, &row_key,
+							-1);
 
         if (etat.combofix_case_sensitive && !strcmp (tmp_str2, tmp_str))
         {
             g_free (tmp_str);
             break;
         }
-        else if (!g_utf8_collate (g_utf8_casefold (tmp_str2, -1), g_utf8_casefold (tmp_str, -1)))
+        else if (!strcmp (report_key, row_key))
         {
             g_free (tmp_str);
             break;
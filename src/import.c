@@ -65,8 +65,10 @@
 #include "gsb_form_scheduler.h"
 #include "gsb_form_transaction.h"
 #include "gsb_form_widget.h"
+#include "gsb_trace.h"
 #include "gsb_transactions_list.h"
 #include "gtk_combofix.h"
+#include "import_asso_matcher.h"
 #include "import_csv.h"
 #include "menu.h"
 #include "navigation.h"
@@ -120,6 +122,9 @@ static gboolean		add_csv_page = FALSE;
 GSList *			liste_associations_tiers = NULL;
 struct ImportPayeeAsso *last_added_assoc;
 
+/* associations compilées, construites à la première recherche après une modification */
+static ImportAssoMatcher *associations_matcher = NULL;
+
 /* nombre de transaction à importer qui affiche une barre de progression */
 #define NBRE_TRANSACTION_FOR_PROGRESS_BAR 250
 
@@ -174,22 +179,13 @@ enum ImportPages
  **/
 static gint gsb_import_associations_find_payee (gchar *imported_tiers)
 {
-    GSList *tmp_list;
-
-    tmp_list = liste_associations_tiers;
-    while (tmp_list)
-    {
-        struct ImportPayeeAsso *assoc;
+	if (!liste_associations_tiers)
+		return 0;
 
-        assoc = tmp_list->data;
-        if (gsb_string_is_trouve (imported_tiers, assoc->search_str, assoc->ignore_case, assoc->use_regex))
-        {
-           return assoc->payee_number;
-        }
-        tmp_list = tmp_list->next;
-    }
+	if (!associations_matcher)
+		associations_matcher = import_asso_matcher_new (liste_associations_tiers);
 
-    return 0;
+	return import_asso_matcher_find_payee (associations_matcher, imported_tiers);
 }
 
 /**
@@ -208,6 +204,19 @@ static void gsb_import_associations_free_assoc (struct ImportPayeeAsso *assoc, g
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
+/**
+ * forget the compiled associations, to call when an association is changed
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_import_associations_invalidate_matcher (void)
+{
+	import_asso_matcher_free (associations_matcher);
+	associations_matcher = NULL;
+}
+
 /**
  *
  *
@@ -229,6 +238,7 @@ GSList *gsb_import_associations_get_liste_associations (void)
  **/
 void gsb_import_associations_init_variables (void)
 {
+	gsb_import_associations_invalidate_matcher ();
     if (liste_associations_tiers)
     {
 		gsb_import_associations_free_liste ();
@@ -266,6 +276,7 @@ gboolean gsb_import_associations_add_assoc (gint payee_number,
 	assoc->use_regex = use_regex;
 
 	last_added_assoc = assoc;
+	gsb_import_associations_invalidate_matcher ();
 
     /* add association in liste_associations_tiers */
     if (g_slist_length (liste_associations_tiers) == 0)
@@ -332,6 +343,7 @@ void gsb_import_associations_remove_assoc (gint payee_number)
     {
 		GSList *tmp_list;
 
+		gsb_import_associations_invalidate_matcher ();
         gsb_data_payee_set_search_string (payee_number, "");
         tmp_list = liste_associations_tiers;
         while (tmp_list)
@@ -361,6 +373,7 @@ void gsb_import_associations_remove_assoc (gint payee_number)
 gint gsb_import_associations_list_append_assoc (gint payee_number,
 												struct ImportPayeeAsso *assoc)
 {
+	gsb_import_associations_invalidate_matcher ();
      if (!g_slist_find_custom (liste_associations_tiers,
 							   assoc,
 							  (GCompareFunc) gsb_import_associations_cmp_assoc))
@@ -380,6 +393,7 @@ gint gsb_import_associations_list_append_assoc (gint payee_number,
  **/
 void gsb_import_associations_free_liste (void)
 {
+	gsb_import_associations_invalidate_matcher ();
 	if (!liste_associations_tiers)
 	{
 		return;
@@ -4648,6 +4662,7 @@ static void traitement_operations_importees (GtkWindow *parent)
 {
     GSList *tmp_list;
     gint new_file;
+	gint64 trace_start;
 	GrisbiAppConf *a_conf;
 
     devel_debug (NULL);
@@ -4670,6 +4685,7 @@ static void traitement_operations_importees (GtkWindow *parent)
     marked_r_transactions_imported = FALSE;
 
     /* go throw the accounts and do what is asked */
+	trace_start = gsb_trace_begin ();
     tmp_list = liste_comptes_importes;
 
     while (tmp_list)
@@ -4678,6 +4694,7 @@ static void traitement_operations_importees (GtkWindow *parent)
     gint account_number = 0;
 
     compte = tmp_list->data;
+	gsb_trace_count ("import_transactions", g_slist_length (compte->operations_importees));
 
     switch (compte->action)
     {
@@ -4787,6 +4804,7 @@ static void traitement_operations_importees (GtkWindow *parent)
     }
     tmp_list = tmp_list->next;
     }
+	gsb_trace_end ("import_accounts", trace_start);
 
     /* if no account created, there is a problem
      * show an error and go away */
@@ -153,6 +153,7 @@ gint		gsb_import_associations_get_last_payee_number	(void);
 GSList *	gsb_import_associations_get_liste_associations	(void);
 void 		gsb_import_associations_free_liste				(void);
 void 		gsb_import_associations_init_variables 			(void);
+void		gsb_import_associations_invalidate_matcher		(void);
 gint 		gsb_import_associations_list_append_assoc 		(gint payee_number,
 															 struct ImportPayeeAsso *assoc);
 void 		gsb_import_associations_remove_assoc 			(gint payee_number);
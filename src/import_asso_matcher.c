@@ -0,0 +1,671 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*     Copyright (C)    2000-2008 Cédric Auger (cedric@grisbi.org)            */
+/*          2003-2009 Benjamin Drieu (bdrieu@april.org)                       */
+/*          2008-2021 Pierre Biava (grisbi@pierre.biava.name)                 */
+/*          https://www.grisbi.org/                                           */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file import_asso_matcher.c
+ * compiled form of the associations between a payee and its search string
+ *
+ * the rules are compiled once for an import, with the same meaning as
+ * gsb_string_is_trouve () :
+ * - a rule without joker "%*" must be equal to the imported payee, case ignored ;
+ *   these rules are kept in a hash table
+ * - a rule with jokers is split on "||" in alternatives, each alternative is split
+ *   on the jokers in words, and an alternative matches when all its words are in
+ *   the imported payee ; all the words are searched at once by an Aho-Corasick
+ *   automaton, one for the words which respect the case, one for the upper-cased
+ *   words of the rules which ignore the case
+ * - a regex rule is a GRegex compiled once
+ * the first rule of the list which matches gives the payee.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+#include <string.h>
+
+/*START_INCLUDE*/
+#include "import_asso_matcher.h"
+#include "import.h"
+#include "erreur.h"
+/*END_INCLUDE*/
+
+/* a node of an Aho-Corasick automaton */
+typedef struct _MatcherNode		MatcherNode;
+
+struct _MatcherNode
+{
+	gint		fail;				/* longest proper suffix which is a node */
+	gint		word;				/* word ending on that node, -1 if none */
+	gint		dict;				/* next node with a word on the fail chain, 0 if none */
+	gint		first_child;
+	gint		next_sibling;
+	guchar		c;					/* byte of the edge from the parent */
+};
+
+/* Aho-Corasick automaton on the bytes of the words */
+typedef struct _MatcherAutomaton	MatcherAutomaton;
+
+struct _MatcherAutomaton
+{
+	GArray		*nodes;				/* MatcherNode, the root is the node 0 */
+	GHashTable	*edges;				/* (node << 8 | byte) + 1 -> child node */
+	GHashTable	*words;				/* word -> GINT_TO_POINTER (word number + 1) */
+};
+
+/* what a rule needs to match */
+enum MatcherRuleType
+{
+	MATCHER_RULE_EXACT,
+	MATCHER_RULE_WORDS,
+	MATCHER_RULE_ALWAYS,
+	MATCHER_RULE_REGEX,
+	MATCHER_RULE_NEVER
+};
+
+typedef struct _MatcherRule			MatcherRule;
+
+struct _MatcherRule
+{
+	gint		payee_number;
+	gint		type;
+	GRegex		*regex;
+};
+
+/* an alternative of a rule with jokers : all its words must be found */
+typedef struct _MatcherAlternative	MatcherAlternative;
+
+struct _MatcherAlternative
+{
+	gint		rule;
+	gboolean	ignore_case;
+	guint		nbre_words;
+	guint		nbre_found;			/* words found in the payee being matched */
+	guint		stamp;				/* payee for which nbre_found is valid */
+};
+
+struct _ImportAssoMatcher
+{
+	GArray		*rules;				/* MatcherRule in the order of the list */
+	GArray		*alternatives;		/* MatcherAlternative */
+	GHashTable	*exact_rules;		/* key of the payee -> GINT_TO_POINTER (first rule + 1) */
+	gint		first_always;		/* first rule which matches every payee, -1 if none */
+
+	/* the words of the alternatives, and for each word the alternatives which use it */
+	MatcherAutomaton	*automaton[2];	/* 0 : respect the case, 1 : ignore the case */
+	GPtrArray	*word_alternatives[2];	/* GArray of gint per word */
+	GArray		*word_stamps[2];		/* guint per word, last payee where found */
+	guint		stamp;
+};
+
+/*START_STATIC*/
+/*END_STATIC*/
+
+/*START_EXTERN*/
+/*END_EXTERN*/
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
+/**
+ * return the key used to compare a payee to a rule without joker,
+ * two strings have the same key if my_strcasecmp () returns 0 for them
+ *
+ * \param string
+ *
+ * \return a newly allocated key
+ **/
+static gchar *import_asso_matcher_exact_key (const gchar *string)
+{
+	gchar *casefold;
+	gchar *key;
+
+	if (!g_utf8_validate (string, -1, NULL))
+		return g_ascii_strdown (string, -1);
+
+	casefold = g_utf8_casefold (string, -1);
+	key = g_utf8_collate_key (casefold, -1);
+	g_free (casefold);
+
+	return key;
+}
+
+/**
+ * create an empty automaton
+ *
+ * \param
+ *
+ * \return the new automaton
+ **/
+static MatcherAutomaton *import_asso_matcher_automaton_new (void)
+{
+	MatcherAutomaton *automaton;
+	MatcherNode root = {0, -1, 0, 0, 0, 0};
+
+	automaton = g_malloc0 (sizeof (MatcherAutomaton));
+	automaton->nodes = g_array_new (FALSE, FALSE, sizeof (MatcherNode));
+	g_array_append_val (automaton->nodes, root);
+	automaton->edges = g_hash_table_new (g_direct_hash, g_direct_equal);
+	automaton->words = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	return automaton;
+}
+
+/**
+ * free an automaton
+ *
+ * \param automaton
+ *
+ * \return
+ **/
+static void import_asso_matcher_automaton_free (MatcherAutomaton *automaton)
+{
+	g_array_free (automaton->nodes, TRUE);
+	g_hash_table_destroy (automaton->edges);
+	g_hash_table_destroy (automaton->words);
+	g_free (automaton);
+}
+
+/**
+ * return the child of a node for a byte
+ *
+ * \param automaton
+ * \param node
+ * \param c
+ *
+ * \return the child, 0 if none (the root is never a child)
+ **/
+static gint import_asso_matcher_automaton_goto (MatcherAutomaton *automaton,
+												gint node,
+												guchar c)
+{
+	return GPOINTER_TO_INT (g_hash_table_lookup (automaton->edges, GINT_TO_POINTER (((node << 8) | c) + 1)));
+}
+
+/**
+ * add a word to the automaton, if it's not already in
+ *
+ * \param automaton
+ * \param word
+ *
+ * \return the number of the word
+ **/
+static gint import_asso_matcher_automaton_add_word (MatcherAutomaton *automaton,
+													const gchar *word)
+{
+	const guchar *ptr;
+	gint node = 0;
+	gint word_number;
+
+	word_number = GPOINTER_TO_INT (g_hash_table_lookup (automaton->words, word)) - 1;
+	if (word_number >= 0)
+		return word_number;
+
+	word_number = g_hash_table_size (automaton->words);
+	g_hash_table_insert (automaton->words, g_strdup (word), GINT_TO_POINTER (word_number + 1));
+
+	for (ptr = (const guchar *) word; *ptr; ptr++)
+	{
+		gint child;
+
+		child = import_asso_matcher_automaton_goto (automaton, node, *ptr);
+		if (!child)
+		{
+			MatcherNode new_node = {0, -1, 0, 0, 0, 0};
+
+			child = automaton->nodes->len;
+			new_node.c = *ptr;
+			new_node.next_sibling = g_array_index (automaton->nodes, MatcherNode, node).first_child;
+			g_array_append_val (automaton->nodes, new_node);
+			g_array_index (automaton->nodes, MatcherNode, node).first_child = child;
+			g_hash_table_insert (automaton->edges,
+								 GINT_TO_POINTER (((node << 8) | *ptr) + 1),
+								 GINT_TO_POINTER (child));
+		}
+		node = child;
+	}
+	g_array_index (automaton->nodes, MatcherNode, node).word = word_number;
+
+	return word_number;
+}
+
+/**
+ * compute the fail and dict links of the automaton, once all the words are in
+ *
+ * \param automaton
+ *
+ * \return
+ **/
+static void import_asso_matcher_automaton_finish (MatcherAutomaton *automaton)
+{
+	GArray *queue;
+	guint i;
+
+	/* breadth first, the links of a node use the links of shorter nodes */
+	queue = g_array_new (FALSE, FALSE, sizeof (gint));
+	for (i = g_array_index (automaton->nodes, MatcherNode, 0).first_child;
+		 i;
+		 i = g_array_index (automaton->nodes, MatcherNode, i).next_sibling)
+	{
+		gint child = i;
+
+		g_array_append_val (queue, child);
+	}
+
+	for (i = 0; i < queue->len; i++)
+	{
+		gint node;
+		gint child;
+
+		node = g_array_index (queue, gint, i);
+		for (child = g_array_index (automaton->nodes, MatcherNode, node).first_child;
+			 child;
+			 child = g_array_index (automaton->nodes, MatcherNode, child).next_sibling)
+		{
+			MatcherNode *child_node;
+			gint fail;
+			guchar c;
+
+			c = g_array_index (automaton->nodes, MatcherNode, child).c;
+			fail = g_array_index (automaton->nodes, MatcherNode, node).fail;
+			while (fail && !import_asso_matcher_automaton_goto (automaton, fail, c))
+				fail = g_array_index (automaton->nodes, MatcherNode, fail).fail;
+			fail = import_asso_matcher_automaton_goto (automaton, fail, c);
+			if (fail == child)
+				fail = 0;
+
+			child_node = &g_array_index (automaton->nodes, MatcherNode, child);
+			child_node->fail = fail;
+			if (g_array_index (automaton->nodes, MatcherNode, fail).word >= 0)
+				child_node->dict = fail;
+			else
+				child_node->dict = g_array_index (automaton->nodes, MatcherNode, fail).dict;
+
+			g_array_append_val (queue, child);
+		}
+	}
+	g_array_free (queue, TRUE);
+}
+
+/**
+ * add an alternative of a rule with jokers
+ *
+ * \param matcher
+ * \param rule the number of the rule
+ * \param alternative the text of the alternative, with the jokers
+ * \param ignore_case
+ *
+ * \return FALSE if the alternative cannot match
+ **/
+static gboolean import_asso_matcher_add_alternative (ImportAssoMatcher *matcher,
+													 gint rule,
+													 const gchar *alternative,
+													 gboolean ignore_case)
+{
+	MatcherAlternative new_alternative = {rule, ignore_case, 0, 0, 0};
+	GHashTable *words_used;
+	gchar **tab_str;
+	gint alternative_number;
+	gint i;
+
+	/* gsb_string_is_trouve () never matches an invalid word ignoring the case, the
+	 * check is done before adding any word to keep the numbers of the alternatives */
+	if (ignore_case && !g_utf8_validate (alternative, -1, NULL))
+		return FALSE;
+
+	alternative_number = matcher->alternatives->len;
+	words_used = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	tab_str = g_strsplit_set (alternative, "%*", 0);
+	for (i = 0; tab_str[i]; i++)
+	{
+		gchar *word;
+		gint word_number;
+		GArray *alternatives;
+
+		if (strlen (tab_str[i]) == 0)
+			continue;
+
+		if (ignore_case)
+			word = g_utf8_strup (tab_str[i], -1);
+		else
+			word = g_strdup (tab_str[i]);
+
+		word_number = import_asso_matcher_automaton_add_word (matcher->automaton[ignore_case], word);
+		g_free (word);
+
+		/* the same word twice in an alternative is found twice */
+		if (g_hash_table_contains (words_used, GINT_TO_POINTER (word_number)))
+			continue;
+		g_hash_table_add (words_used, GINT_TO_POINTER (word_number));
+
+		if ((guint) word_number >= matcher->word_alternatives[ignore_case]->len)
+		{
+			g_ptr_array_add (matcher->word_alternatives[ignore_case], g_array_new (FALSE, FALSE, sizeof (gint)));
+			g_array_set_size (matcher->word_stamps[ignore_case], word_number + 1);
+		}
+		alternatives = g_ptr_array_index (matcher->word_alternatives[ignore_case], word_number);
+		g_array_append_val (alternatives, alternative_number);
+		new_alternative.nbre_words++;
+	}
+	g_hash_table_destroy (words_used);
+	g_strfreev (tab_str);
+
+	/* an alternative without word matches every payee */
+	if (new_alternative.nbre_words == 0)
+	{
+		if (matcher->first_always < 0)
+			matcher->first_always = rule;
+		return TRUE;
+	}
+
+	g_array_append_val (matcher->alternatives, new_alternative);
+
+	return TRUE;
+}
+
+/**
+ * compile a rule of the list
+ *
+ * \param matcher
+ * \param assoc
+ *
+ * \return
+ **/
+static void import_asso_matcher_add_rule (ImportAssoMatcher *matcher,
+										  struct ImportPayeeAsso *assoc)
+{
+	MatcherRule rule = {0, MATCHER_RULE_NEVER, NULL};
+	const gchar *needle;
+	gint rule_number;
+
+	rule_number = matcher->rules->len;
+	rule.payee_number = assoc->payee_number;
+	needle = assoc->search_str;
+
+	if (!needle)
+		;
+	else if (assoc->use_regex)
+	{
+		GError *error = NULL;
+
+		rule.regex = g_regex_new (needle, assoc->ignore_case ? G_REGEX_CASELESS : 0, 0, &error);
+		if (rule.regex)
+			rule.type = MATCHER_RULE_REGEX;
+		else
+		{
+			gchar *tmp_str;
+
+			tmp_str = g_strdup_printf ("invalid regex \"%s\": %s", needle, error->message);
+			warning_debug (tmp_str);
+			g_free (tmp_str);
+			g_error_free (error);
+		}
+	}
+	else if (!strchr (needle, '%') && !strchr (needle, '*'))
+	{
+		gchar *key;
+
+		/* the first rule with that string wins */
+		rule.type = MATCHER_RULE_EXACT;
+		key = import_asso_matcher_exact_key (needle);
+		if (!g_hash_table_contains (matcher->exact_rules, key))
+			g_hash_table_insert (matcher->exact_rules, key, GINT_TO_POINTER (rule_number + 1));
+		else
+			g_free (key);
+	}
+	else
+	{
+		gchar **tab_rules;
+		gint i;
+
+		rule.type = MATCHER_RULE_WORDS;
+		tab_rules = g_strsplit (needle, "||", 0);
+		for (i = 0; tab_rules[i]; i++)
+			if (!import_asso_matcher_add_alternative (matcher, rule_number, tab_rules[i], assoc->ignore_case))
+				continue;
+		g_strfreev (tab_rules);
+	}
+
+	g_array_append_val (matcher->rules, rule);
+}
+
+/**
+ * count the words of a payee found by an automaton, and keep the first
+ * rule which has all the words of one of its alternatives
+ *
+ * \param matcher
+ * \param ignore_case
+ * \param text the payee, upper-cased for the automaton ignoring the case
+ * \param best the first rule matching so far, updated
+ *
+ * \return
+ **/
+static void import_asso_matcher_search_words (ImportAssoMatcher *matcher,
+											  gint ignore_case,
+											  const gchar *text,
+											  gint *best)
+{
+	MatcherAutomaton *automaton;
+	const guchar *ptr;
+	gint node = 0;
+
+	automaton = matcher->automaton[ignore_case];
+	for (ptr = (const guchar *) text; *ptr; ptr++)
+	{
+		gint found;
+
+		while (node && !import_asso_matcher_automaton_goto (automaton, node, *ptr))
+			node = g_array_index (automaton->nodes, MatcherNode, node).fail;
+		node = import_asso_matcher_automaton_goto (automaton, node, *ptr);
+
+		/* all the words which end here */
+		found = g_array_index (automaton->nodes, MatcherNode, node).word >= 0
+			? node
+			: g_array_index (automaton->nodes, MatcherNode, node).dict;
+		while (found)
+		{
+			GArray *alternatives;
+			guint *word_stamp;
+			gint word_number;
+			guint i;
+
+			word_number = g_array_index (automaton->nodes, MatcherNode, found).word;
+			found = g_array_index (automaton->nodes, MatcherNode, found).dict;
+
+			/* each word counts once for a payee */
+			word_stamp = &g_array_index (matcher->word_stamps[ignore_case], guint, word_number);
+			if (*word_stamp == matcher->stamp)
+				continue;
+			*word_stamp = matcher->stamp;
+
+			alternatives = g_ptr_array_index (matcher->word_alternatives[ignore_case], word_number);
+			for (i = 0; i < alternatives->len; i++)
+			{
+				MatcherAlternative *alternative;
+
+				alternative = &g_array_index (matcher->alternatives,
+											  MatcherAlternative,
+											  g_array_index (alternatives, gint, i));
+				if (alternative->stamp != matcher->stamp)
+				{
+					alternative->stamp = matcher->stamp;
+					alternative->nbre_found = 0;
+				}
+				alternative->nbre_found++;
+
+				if (alternative->nbre_found == alternative->nbre_words
+					&& (*best < 0 || alternative->rule < *best))
+					*best = alternative->rule;
+			}
+		}
+	}
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * compile the associations between the payees and their search strings
+ *
+ * \param associations a list of struct ImportPayeeAsso, in the order they are tried
+ *
+ * \return the matcher, to free with import_asso_matcher_free ()
+ **/
+ImportAssoMatcher *import_asso_matcher_new (GSList *associations)
+{
+	ImportAssoMatcher *matcher;
+	gint i;
+
+	matcher = g_malloc0 (sizeof (ImportAssoMatcher));
+	matcher->rules = g_array_new (FALSE, FALSE, sizeof (MatcherRule));
+	matcher->alternatives = g_array_new (FALSE, FALSE, sizeof (MatcherAlternative));
+	matcher->exact_rules = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	matcher->first_always = -1;
+
+	for (i = 0; i < 2; i++)
+	{
+		matcher->automaton[i] = import_asso_matcher_automaton_new ();
+		matcher->word_alternatives[i] = g_ptr_array_new_with_free_func ((GDestroyNotify) g_array_unref);
+		matcher->word_stamps[i] = g_array_new (FALSE, TRUE, sizeof (guint));
+	}
+
+	while (associations)
+	{
+		import_asso_matcher_add_rule (matcher, associations->data);
+		associations = associations->next;
+	}
+
+	for (i = 0; i < 2; i++)
+		import_asso_matcher_automaton_finish (matcher->automaton[i]);
+
+	return matcher;
+}
+
+/**
+ * free the matcher
+ *
+ * \param matcher
+ *
+ * \return
+ **/
+void import_asso_matcher_free (ImportAssoMatcher *matcher)
+{
+	guint i;
+
+	if (!matcher)
+		return;
+
+	for (i = 0; i < matcher->rules->len; i++)
+		if (g_array_index (matcher->rules, MatcherRule, i).regex)
+			g_regex_unref (g_array_index (matcher->rules, MatcherRule, i).regex);
+
+	g_array_free (matcher->rules, TRUE);
+	g_array_free (matcher->alternatives, TRUE);
+	g_hash_table_destroy (matcher->exact_rules);
+
+	for (i = 0; i < 2; i++)
+	{
+		import_asso_matcher_automaton_free (matcher->automaton[i]);
+		g_ptr_array_free (matcher->word_alternatives[i], TRUE);
+		g_array_free (matcher->word_stamps[i], TRUE);
+	}
+	g_free (matcher);
+}
+
+/**
+ * find the payee of the first association which matches an imported payee
+ *
+ * \param matcher
+ * \param imported_tiers
+ *
+ * \return the number of the payee, 0 if no association matches
+ **/
+gint import_asso_matcher_find_payee (ImportAssoMatcher *matcher,
+									 const gchar *imported_tiers)
+{
+	gchar *key;
+	gint best;
+	guint i;
+
+	if (!matcher || !imported_tiers)
+		return 0;
+
+	/* a new payee, the counts of the previous one are obsolete */
+	matcher->stamp++;
+	if (matcher->stamp == 0)
+	{
+		for (i = 0; i < matcher->alternatives->len; i++)
+			g_array_index (matcher->alternatives, MatcherAlternative, i).stamp = 0;
+		for (i = 0; i < 2; i++)
+			memset (matcher->word_stamps[i]->data, 0, matcher->word_stamps[i]->len * sizeof (guint));
+		matcher->stamp = 1;
+	}
+
+	best = matcher->first_always;
+
+	/* the rules without joker */
+	key = import_asso_matcher_exact_key (imported_tiers);
+	i = GPOINTER_TO_INT (g_hash_table_lookup (matcher->exact_rules, key));
+	g_free (key);
+	if (i && (best < 0 || (gint) i - 1 < best))
+		best = i - 1;
+
+	/* the rules with jokers */
+	if (matcher->alternatives->len)
+	{
+		import_asso_matcher_search_words (matcher, FALSE, imported_tiers, &best);
+
+		if (g_utf8_validate (imported_tiers, -1, NULL))
+		{
+			gchar *upper_tiers;
+
+			upper_tiers = g_utf8_strup (imported_tiers, -1);
+			import_asso_matcher_search_words (matcher, TRUE, upper_tiers, &best);
+			g_free (upper_tiers);
+		}
+	}
+
+	/* the regex rules before the best rule found */
+	for (i = 0; i < matcher->rules->len && (best < 0 || (gint) i < best); i++)
+	{
+		MatcherRule *rule;
+
+		rule = &g_array_index (matcher->rules, MatcherRule, i);
+		if (rule->type == MATCHER_RULE_REGEX && g_regex_match (rule->regex, imported_tiers, 0, NULL))
+		{
+			best = i;
+			break;
+		}
+	}
+
+	if (best < 0)
+		return 0;
+
+	return g_array_index (matcher->rules, MatcherRule, best).payee_number;
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
@@ -0,0 +1,19 @@
+#ifndef _IMPORT_ASSO_MATCHER_H
+#define _IMPORT_ASSO_MATCHER_H (1)
+
+#include <glib.h>
+
+/* START_INCLUDE_H */
+/* END_INCLUDE_H */
+
+typedef struct _ImportAssoMatcher	ImportAssoMatcher;
+
+
+/* START_DECLARATION */
+gint				import_asso_matcher_find_payee		(ImportAssoMatcher *matcher,
+														 const gchar *imported_tiers);
+void				import_asso_matcher_free			(ImportAssoMatcher *matcher);
+ImportAssoMatcher *	import_asso_matcher_new				(GSList *associations);
+/* END_DECLARATION */
+
+#endif
@@ -1091,6 +1091,9 @@ void gsb_menu_gui_sensitive_win_menu_item (const gchar *item_name,
     GAction *action;
 
     win = grisbi_app_get_active_window (NULL);
+	if (win == NULL && grisbi_app_is_headless ())
+		return;
+
     action = g_action_map_lookup_action (G_ACTION_MAP (win), item_name);
     g_simple_action_set_enabled (G_SIMPLE_ACTION (action), state);
 }
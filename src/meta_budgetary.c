@@ -44,8 +44,6 @@
 /*START_STATIC*/
 static gint budgetary_line_add_div ( void );
 static gint budgetary_line_add_sub_div ( int div_id );
-static gboolean budgetary_line_add_transaction_to_div ( gint transaction_number,
-						 int div_id );
 static gchar *budgetary_line_div_name ( gint div );
 static gint budgetary_line_get_without_div_pointer ( void );
 static GsbReal budgetary_line_sub_div_balance ( gint div, gint sub_div );
@@ -118,10 +116,6 @@ static MetatreeInterface _budgetary_interface = {
     budgetary_line_add_sub_div,
     gsb_data_budget_remove,
     gsb_data_budget_sub_budget_remove,
-    budgetary_line_add_transaction_to_div,
-    gsb_data_budget_add_transaction_to_budget,
-    gsb_data_budget_remove_transaction_from_budget,
-    gsb_data_budget_remove_transaction_from_budget,
     budgetary_hold_position_set_path,
     budgetary_hold_position_set_expand,
 };
@@ -293,20 +287,6 @@ gint budgetary_line_add_sub_div ( int div_id )
 
 
 
-/**
- *
- *
- *
- */
-gboolean budgetary_line_add_transaction_to_div ( gint transaction_number,
-						 int div_id )
-{
-    gsb_data_budget_add_transaction_to_budget ( transaction_number,
-						div_id, 0 );
-    return TRUE;
-}
-
-
 /**
  *
  *
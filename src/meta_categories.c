@@ -44,8 +44,6 @@
 /*START_STATIC*/
 static gint category_add_div ( void );
 static gint category_add_sub_div ( int div_id );
-static gboolean category_add_transaction_to_div ( gint transaction_number,
-					   int div_id );
 static gchar *category_div_name ( gint div );
 static gint category_get_div_pointer_from_name ( const gchar * name, gboolean create );
 static gint category_get_without_div_pointer ( void );
@@ -97,10 +95,6 @@ static MetatreeInterface _category_interface = {
     category_add_sub_div,
     gsb_data_category_remove,
     gsb_data_category_sub_category_remove,
-    category_add_transaction_to_div,
-    gsb_data_category_add_transaction_to_category,
-    gsb_data_category_remove_transaction_from_category,
-    gsb_data_category_remove_transaction_from_category,
     categories_hold_position_set_path,
     categories_hold_position_set_expand,
 };
@@ -330,19 +324,6 @@ gint category_add_sub_div ( int div_id )
 
 
 
-/**
- *
- *
- */
-gboolean category_add_transaction_to_div ( gint transaction_number,
-					   int div_id )
-{
-    gsb_data_category_add_transaction_to_category ( transaction_number,
-						    div_id, 0 );
-    return TRUE;
-}
-
-
 /**
  *
  *
@@ -42,10 +42,6 @@
 /*START_STATIC*/
 static gint payee_add_div ( void );
 static gint payee_add_sub_div ( int div_id );
-static gboolean payee_add_transaction_to_div ( gint transaction_number,
-					int div_id );
-static void payee_add_transaction_to_sub_div ( gint transaction_number,
-					int div_id, int sub_div_id );
 static gchar *payee_div_name ( gint div );
 static GSList * payee_div_sub_div_list ( gint div );
 static gint payee_div_type ( gint div );
@@ -109,10 +105,6 @@ static MetatreeInterface _payee_interface = {
     payee_add_sub_div,
     gsb_data_payee_remove,
     payee_remove_sub_div,
-    payee_add_transaction_to_div,
-    payee_add_transaction_to_sub_div,
-    gsb_data_payee_remove_transaction_from_payee,
-    gsb_data_payee_remove_transaction_from_payee,
     payees_hold_position_set_path,
     payees_hold_position_set_expand,
 };
@@ -410,30 +402,6 @@ gboolean payee_remove_sub_div ( int div_id, int sub_div_id )
 
 
 
-/**
- *
- *
- */
-gboolean payee_add_transaction_to_div ( gint transaction_number,
-					int div_id )
-{
-    gsb_data_payee_add_transaction_to_payee (transaction_number);
-    return TRUE;
-}
-
-
-
-/**
- *
- *
- */
-void payee_add_transaction_to_sub_div ( gint transaction_number,
-					int div_id, int sub_div_id )
-{
-    return;
-}
-
-
 /**
  *
  *
@@ -42,6 +42,7 @@
 #include "gsb_data_scheduled.h"
 #include "gsb_data_transaction.h"
 #include "gsb_file.h"
+#include "gsb_file_cache.h"
 #include "gsb_real.h"
 #include "gsb_rgba.h"
 #include "gsb_transactions_list.h"
@@ -903,7 +904,8 @@ void supprimer_sub_division ( GtkTreeView * tree_view, GtkTreeModel * model,
 
 	/* move the transactions to the new division numbers, need to do for
      * archived transactions too */
-	list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
+	gsb_file_cache_load_division_archives ( iface -> content, division, sub_division );
+	list_tmp_transactions = gsb_data_transaction_get_loaded_transactions_list ();
 	while ( list_tmp_transactions )
 	{
 	    gint transaction_number_tmp;
@@ -914,9 +916,6 @@ void supprimer_sub_division ( GtkTreeView * tree_view, GtkTreeModel * model,
 		 &&
 		 ( iface -> transaction_sub_div_id (transaction_number_tmp) == sub_division))
 	    {
-		iface -> add_transaction_to_sub_div ( transaction_number_tmp,
-                        nouveau_no_division,
-                        nouveau_no_sub_division );
 		iface -> transaction_set_div_id (transaction_number_tmp, nouveau_no_division);
 		iface -> transaction_set_sub_div_id (transaction_number_tmp, nouveau_no_sub_division);
         list_num = g_slist_append ( list_num, GINT_TO_POINTER (
@@ -1079,7 +1078,10 @@ gboolean division_column_expanded  ( GtkTreeView * treeview, GtkTreeIter * iter,
 			     META_TREE_NO_SUB_DIV_COLUMN, &no_sub_division,
 			     -1 );
 
-    list_tmp_transactions = gsb_data_transaction_get_metatree_transactions_list ();
+	/* the transactions without division are shown with all the sub-divisions */
+    list_tmp_transactions = gsb_data_transaction_get_metatree_transactions_list ( iface -> content,
+                        no_division,
+                        no_division ? no_sub_division : -1 );
 
 	while ( list_tmp_transactions )
 	{
@@ -1461,10 +1463,7 @@ void move_transaction_to_sub_division ( gint transaction_number,
     old_div = iface -> transaction_div_id (transaction_number);
     old_sub_div = iface -> transaction_sub_div_id (transaction_number);
 
-    /* Update old parents */
-    iface -> remove_transaction_from_sub_div ( transaction_number );
-
-    /* Change parameters of the transaction */
+    /* Change parameters of the transaction, that updates the counters of the divisions */
     iface -> transaction_set_div_id ( transaction_number, no_division );
     iface -> transaction_set_sub_div_id ( transaction_number, no_sub_division );
     gsb_transactions_list_update_transaction (transaction_number);
@@ -1475,8 +1474,6 @@ void move_transaction_to_sub_division ( gint transaction_number,
     /* Update new parents */
     if ( iface -> depth > 1 )
     {
-        iface -> add_transaction_to_sub_div ( transaction_number,
-                        no_division, no_sub_division );
         if ( no_sub_division == 0 )
             fill_sub_division_zero ( model, iface, &dest_iter,
                         no_division );
@@ -1488,7 +1485,6 @@ void move_transaction_to_sub_division ( gint transaction_number,
     }
     else
     {
-	iface -> add_transaction_to_div ( transaction_number, no_division );
 	fill_division_row ( model, iface, &dest_iter, no_division );
     }
 
@@ -1574,7 +1570,10 @@ void move_sub_division_to_division ( GtkTreeModel *model,
     }
 
     /* fill the new sub-division (or dest division for payee) with the transactions */
-    list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
+    gsb_file_cache_load_division_archives ( iface -> content,
+                        no_orig_division,
+                        no_orig_sub_division );
+    list_tmp_transactions = gsb_data_transaction_get_loaded_transactions_list ();
 
     while ( list_tmp_transactions )
     {
@@ -1995,8 +1994,12 @@ gboolean find_associated_transactions ( MetatreeInterface * iface,
 {
     GSList *tmp_list;
 
-    /* we need to check all the transactions, even in archives */
-    tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+    /* we need to check all the transactions, even in archives ; the archives
+     * kept in the cache of the file are loaded only if they have that division */
+    gsb_file_cache_load_division_archives ( iface -> content,
+                        no_division,
+                        no_sub_division ? no_sub_division : -1 );
+    tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
 
     while ( tmp_list )
     {
@@ -2789,7 +2792,8 @@ void move_transactions_to_division_payee (GtkTreeModel * model,
     iface = g_object_get_data ( G_OBJECT(model), "metatree-interface" );
 
     /* fill the dest division for payee with the transactions */
-    list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
+    gsb_file_cache_load_division_archives ( iface -> content, orig_div, -1 );
+    list_tmp_transactions = gsb_data_transaction_get_loaded_transactions_list ();
 
     while ( list_tmp_transactions )
     {
@@ -2806,8 +2810,6 @@ void move_transactions_to_division_payee (GtkTreeModel * model,
                     transaction_number_tmp, 0 );
             gsb_transactions_list_update_transaction (
                     transaction_number_tmp );
-            iface -> add_transaction_to_div ( transaction_number_tmp,
-                    dest_div );
         }
         list_tmp_transactions = list_tmp_transactions -> next;
     }
@@ -3367,7 +3369,8 @@ void metatree_reset_transactions_without_div_sub_div ( MetatreeInterface *iface,
     GSList *list_tmp;
 
     /* move the transactions, need to to that for archived transactions too */
-    list_tmp = gsb_data_transaction_get_complete_transactions_list ();
+    gsb_file_cache_load_division_archives ( iface -> content, no_division, -1 );
+    list_tmp = gsb_data_transaction_get_loaded_transactions_list ();
 
     while ( list_tmp )
     {
@@ -3582,7 +3585,8 @@ void metatree_move_transactions_to_sub_div ( MetatreeInterface *iface,
     GSList *list_tmp;
 
     /* move the transactions, need to to that for archived transactions too */
-    list_tmp = gsb_data_transaction_get_complete_transactions_list ();
+    gsb_file_cache_load_division_archives ( iface -> content, no_division, no_sub_division );
+    list_tmp = gsb_data_transaction_get_loaded_transactions_list ();
 
     while ( list_tmp )
     {
@@ -3626,7 +3630,8 @@ gint metatree_move_sub_division_to_division ( MetatreeInterface *iface,
     iface -> remove_sub_div ( no_division, no_sub_division );
 
     /* move the transactions, need to to that for archived transactions too */
-    list_tmp = gsb_data_transaction_get_complete_transactions_list ();
+    gsb_file_cache_load_division_archives ( iface -> content, no_division, no_sub_division );
+    list_tmp = gsb_data_transaction_get_loaded_transactions_list ();
 
     while ( list_tmp )
     {
@@ -3677,7 +3682,8 @@ gint metatree_create_division_from_sub_division ( MetatreeInterface *iface,
     iface -> remove_sub_div ( no_division, no_sub_division );
 
     /* move the transactions, need to to that for archived transactions too */
-    list_tmp = gsb_data_transaction_get_complete_transactions_list ();
+    gsb_file_cache_load_division_archives ( iface -> content, no_division, no_sub_division );
+    list_tmp = gsb_data_transaction_get_loaded_transactions_list ();
 
     while ( list_tmp )
     {
@@ -4018,7 +4024,8 @@ void metatree_transfer_identical_transactions ( GtkWidget *tree_view )
 	    return;
 
     /* move the transactions, need to to that for archived transactions too */
-    list_tmp = gsb_data_transaction_get_complete_transactions_list ();
+    gsb_file_cache_load_division_archives ( iface -> content, no_division, no_sub_division );
+    list_tmp = gsb_data_transaction_get_loaded_transactions_list ();
 
     if ( metatree_find_payee )
     {
@@ -52,10 +52,6 @@ struct _MetatreeInterface {
     gint			(* add_sub_div)						(int);
     gboolean		(* remove_div) (int);
     gboolean		(* remove_sub_div)					(int, int);
-    gboolean		(* add_transaction_to_div)			(gint, int);
-    void			(* add_transaction_to_sub_div)		(gint, int, int);
-    void			(* remove_transaction_from_div)		(int);
-    void			(* remove_transaction_from_sub_div)	(int);
 
     /* sauvegarde dernière sélection */
     gboolean		(* hold_position_set_path)			(GtkTreePath *);
@@ -763,7 +763,7 @@ static gint print_transactions_list_draw_columns_title ( GtkPrintContext *contex
     for (column=0 ; column<CUSTOM_MODEL_VISIBLE_COLUMNS ; column++)
     {
 	PangoLayout *layout;
-	gchar *text;
+	const gchar *text;
 	gint column_position;
 
 	column_position = columns_position[column];
@@ -913,7 +913,7 @@ static gint print_transactions_list_draw_row ( GtkPrintContext *context,
 	column_position = print_transactions_list_draw_column (column_position, line_position);
 
 	/* get the text */
-	text = record -> visible_col[column];
+	text = custom_list_get_cell_text (transaction_model_get_model (), record, column);
 	if (!text)
 	    continue;
 
@@ -41,6 +41,7 @@
 #include "gsb_data_payee.h"
 #include "gsb_data_payment.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file_cache.h"
 #include "gsb_file_util.h"
 #include "gsb_real.h"
 #include "import.h"
@@ -1552,7 +1553,13 @@ gboolean qif_export (const gchar *filename,
 			fprintf (fichier_qif, "!Type:Bank\n");
 	}
 
-    list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
+	/* only the archives kept in the cache of the file which are exported are loaded */
+	if (archive_number)
+		gsb_file_cache_load_archive (archive_number);
+	else
+		gsb_file_cache_load_account_archives (account_nb, 0);
+
+    list_tmp_transactions = gsb_data_transaction_get_loaded_transactions_list ();
     beginning = 1;
 
     while (list_tmp_transactions)
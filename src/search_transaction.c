@@ -47,6 +47,8 @@
 #include "gsb_data_payee.h"
 #include "gsb_data_transaction.h"
 #include "gsb_file.h"
+#include "gsb_file_cache.h"
+#include "gsb_search_index.h"
 #include "gsb_transactions_list.h"
 #include "menu.h"
 #include "navigation.h"
@@ -285,11 +287,99 @@ static gboolean search_transaction_amount_is_valide (gint transaction_number,
 	return FALSE;
 }
 
+/**
+ * cherche un texte dans une chaine
+ *
+ * \param str		chaine où chercher
+ * \param text		texte cherché, normalisé par gsb_search_index_normalize () si ignore_case
+ * \param ignore_case
+ *
+ * \return TRUE si trouvé
+ **/
+static gboolean search_transaction_text_is_found (const gchar *str,
+												  const gchar *text,
+												  gboolean ignore_case)
+{
+	gchar *tmp_str;
+	gboolean found;
+
+	if (!str || !*str)
+		return FALSE;
+
+	if (!ignore_case)
+		return g_strstr_len (str, -1, text) != NULL;
+
+	tmp_str = gsb_search_index_normalize (str);
+	found = strstr (tmp_str, text) != NULL;
+	g_free (tmp_str);
+
+	return found;
+}
+
+/**
+ * vérifie le tiers d'une opération
+ *
+ * \param transaction_number
+ * \param text		texte cherché, normalisé si ignore_case
+ * \param priv
+ *
+ * \return TRUE si le tiers contient le texte
+ **/
+static gboolean search_transaction_payee_is_valide (gint transaction_number,
+													const gchar *text,
+													SearchTransactionPrivate *priv)
+{
+	/* on ne s'occupera pas des opérations filles si on cherche dans tiers */
+	if (gsb_data_transaction_get_mother_transaction_number (transaction_number))
+		return FALSE;
+
+	return search_transaction_text_is_found (gsb_data_payee_get_name (gsb_data_transaction_get_party_number
+																	  (transaction_number),
+																	  TRUE),
+											 text,
+											 priv->ignore_case);
+}
+
+/**
+ * vérifie la note et les références d'une opération (pièce comptable,
+ * références bancaires et numéro de chèque)
+ *
+ * \param transaction_number
+ * \param text		texte cherché, normalisé si ignore_case
+ * \param priv
+ *
+ * \return TRUE si un des champs contient le texte
+ **/
+static gboolean search_transaction_note_is_valide (gint transaction_number,
+												   const gchar *text,
+												   SearchTransactionPrivate *priv)
+{
+	if (search_transaction_text_is_found (gsb_data_transaction_get_notes (transaction_number),
+										  text,
+										  priv->ignore_case))
+		return TRUE;
+
+	if (search_transaction_text_is_found (gsb_data_transaction_get_voucher (transaction_number),
+										  text,
+										  priv->ignore_case))
+		return TRUE;
+
+	if (search_transaction_text_is_found (gsb_data_transaction_get_bank_references (transaction_number),
+										  text,
+										  priv->ignore_case))
+		return TRUE;
+
+	return search_transaction_text_is_found (gsb_data_transaction_get_method_of_payment_content
+											 (transaction_number),
+											 text,
+											 priv->ignore_case);
+}
+
 /**
  *
  *
  * \param
- * \param
+ * \param		texte cherché, normalisé si ignore_case
  *
  * \return
  **/
@@ -297,95 +387,90 @@ static gboolean search_transaction_str_is_valide (gint transaction_number,
 												  const gchar *text,
 												  SearchTransaction *dialog)
 {
-	const gchar *tmp_str;
-	gint mother_number;
-	gint new_search_type;
 	SearchTransactionPrivate *priv;
 
 	priv = search_transaction_get_instance_private (dialog);
 
-	/* on ne s'occupera pas des opérations filles si on cherche dans tiers */
-	mother_number = gsb_data_transaction_get_mother_transaction_number (transaction_number);
+	/* search_str_type : 1 = payee, 2 = note, 3 = all */
+	if (priv->search_str_type != 2 && search_transaction_payee_is_valide (transaction_number, text, priv))
+		return TRUE;
 
-	if (priv->ignore_case)
-		new_search_type = priv->search_str_type +3;
-	else
-		new_search_type = priv->search_str_type;
+	if (priv->search_str_type != 1 && search_transaction_note_is_valide (transaction_number, text, priv))
+		return TRUE;
 
-	switch (new_search_type)
-	{
-		case 1:		/* ignore case = FALSE search_type = payee pas d'operation fille */
-			if (mother_number)
-				return FALSE;
-
-			tmp_str = gsb_data_payee_get_name (gsb_data_transaction_get_party_number
-											  (transaction_number),
-											  TRUE);
-			if (tmp_str && g_strstr_len (tmp_str, -1, text))
-			{
-				return TRUE;
-			}
-
-			break;
-
-		case 2:		/* ignore case = FALSE search_type = note */
-			tmp_str = gsb_data_transaction_get_notes (transaction_number);
+	return FALSE;
+}
 
-			if (tmp_str && g_strstr_len (tmp_str, -1, text))
-				return TRUE;
+/**
+ * remplit l'ensemble des opérations qui peuvent correspondre à la recherche
+ *
+ * \param text		texte cherché, normalisé si ignore_case
+ * \param dialog
+ * \param candidates	ensemble à remplir
+ *
+ * \return FALSE si l'index ne peut pas servir et qu'il faut tester toutes les opérations
+ **/
+static gboolean search_transaction_get_candidates (const gchar *text,
+												   SearchTransaction *dialog,
+												   GHashTable *candidates)
+{
+	SearchTransactionPrivate *priv;
 
-			break;
+	priv = search_transaction_get_instance_private (dialog);
 
-		case 3:		/* ignore case = FALSE search_type = all */
-			if (!mother_number)
-			{
-				tmp_str = gsb_data_payee_get_name (gsb_data_transaction_get_party_number
-												  (transaction_number),
-												  TRUE);
-				if (tmp_str && g_strstr_len (tmp_str, -1, text))
-					return TRUE;
-			}
+	if (priv->search_type == 2)
+	{
+		GsbReal amount;
+		GsbReal delta = null_real;
 
-			tmp_str = gsb_data_transaction_get_notes (transaction_number);
-			if (tmp_str && g_strstr_len (tmp_str, -1, text))
-				return TRUE;
+		amount = utils_real_get_calculate_entry (priv->entry_search_str);
+		if (priv->delta_amount)
+			delta = gsb_real_double_to_real (gtk_spin_button_get_value (GTK_SPIN_BUTTON
+																		(priv->spinbutton_delta_amount)));
+		gsb_search_index_find_amounts (gsb_real_sub (amount, delta), gsb_real_add (amount, delta), candidates);
 
-			break;
+		return TRUE;
+	}
 
-		case 4:		/* ignore case = TRUE search_type = payee pas d'operation fille*/
-			if (mother_number)
-				return FALSE;
+	if (priv->search_str_type != 1)
+	{
+		gchar *tmp_str;
+		gboolean result;
 
-			tmp_str = gsb_data_payee_get_name (gsb_data_transaction_get_party_number
-											  (transaction_number),
-											  TRUE);
-			if (tmp_str && utils_str_my_case_strstr (tmp_str, text))
-				return TRUE;
+		/* l'index contient les textes normalisés */
+		if (priv->ignore_case)
+			result = gsb_search_index_find_text (text, candidates);
+		else
+		{
+			tmp_str = gsb_search_index_normalize (text);
+			result = gsb_search_index_find_text (tmp_str, candidates);
+			g_free (tmp_str);
+		}
+		if (!result)
+			return FALSE;
+	}
 
-			break;
+	if (priv->search_str_type != 2)
+	{
+		GSList *tmp_list;
 
-		case 5:		/* ignore case = TRUE search_type = note */
-			tmp_str = gsb_data_transaction_get_notes (transaction_number);
-			if (tmp_str && utils_str_my_case_strstr (tmp_str, text))
-				return TRUE;
-			break;
+		/* les tiers sont peu nombreux, on les teste tous */
+		tmp_list = gsb_data_payee_get_payees_list ();
+		while (tmp_list)
+		{
+			gint payee_number;
 
-		default:		/* ignore case = TRUE search_type = all */
-			if (!mother_number)
-			{
-				tmp_str = gsb_data_payee_get_name (gsb_data_transaction_get_party_number
-												  (transaction_number),
-												  TRUE);
-				if (tmp_str && g_strstr_len (tmp_str, -1, text))
-					return TRUE;
-			}
+			payee_number = gsb_data_payee_get_no_payee (tmp_list->data);
+			if (search_transaction_text_is_found (gsb_data_payee_get_name (payee_number, TRUE),
+												  text,
+												  priv->ignore_case))
+				gsb_search_index_find_payee (payee_number, candidates);
 
-			tmp_str = gsb_data_transaction_get_notes (transaction_number);
-			if (tmp_str && utils_str_my_case_strstr (tmp_str, text))
-				return TRUE;
-	};
+			tmp_list = tmp_list->next;
+		}
+	}
 
-	return FALSE;
+	return TRUE;
 }
 
 /**
@@ -401,35 +486,69 @@ static GSList *search_transaction_get_list (gint account_number,
 											SearchTransaction *dialog)
 {
 	GSList *list = NULL;
-	GSList *tmp_list;
+	GHashTable *candidates;
+	gchar *search_text;
 	SearchTransactionPrivate *priv;
 
 	priv = search_transaction_get_instance_private (dialog);
-	if (priv->search_archive)
-		tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+
+	/* sans tenir compte de la casse, on compare les textes normalisés */
+	if (priv->search_type == 1 && priv->ignore_case)
+		search_text = gsb_search_index_normalize (text);
 	else
-		tmp_list = gsb_data_transaction_get_transactions_list ();
-	while (tmp_list)
-	{
-		gint transaction_number;
-		TransactionStruct *transaction;
+		search_text = g_strdup (text);
 
-		transaction = tmp_list->data;
+	/* les archives gardées dans le cache du fichier sont chargées pour y chercher */
+	if (priv->search_archive)
+		gsb_file_cache_load_archive (0);
 
-		transaction_number = gsb_data_transaction_get_transaction_number (transaction);
-		if (gsb_data_transaction_get_account_number (transaction_number) == account_number)
+	candidates = g_hash_table_new (g_direct_hash, g_direct_equal);
+	if (search_transaction_get_candidates (search_text, dialog, candidates))
+	{
+		GHashTableIter iter;
+		gpointer key;
+
+		g_hash_table_iter_init (&iter, candidates);
+		while (g_hash_table_iter_next (&iter, &key, NULL))
 		{
-			if (priv->search_type == 1 && search_transaction_str_is_valide (transaction_number, text, dialog))
-			{
-				list = g_slist_append (list, GINT_TO_POINTER (transaction_number));
-			}
+			gint transaction_number;
+
+			transaction_number = GPOINTER_TO_INT (key);
+			if (gsb_data_transaction_get_account_number (transaction_number) != account_number)
+				continue;
+
+			if (!priv->search_archive && !gsb_data_transaction_is_in_transactions_list (transaction_number))
+				continue;
+
+			if (priv->search_type == 1 && search_transaction_str_is_valide (transaction_number, search_text, dialog))
+				list = g_slist_prepend (list, key);
 			else if (priv->search_type == 2 && search_transaction_amount_is_valide (transaction_number, text, dialog))
-			{
-				list = g_slist_append (list, GINT_TO_POINTER (transaction_number));
-			}
+				list = g_slist_prepend (list, key);
+		}
+	}
+	else
+	{
+		GSList *tmp_list;
+
+		/* texte trop court pour l'index : on teste toutes les opérations */
+		if (priv->search_archive)
+			tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+		else
+			tmp_list = gsb_data_transaction_get_transactions_list ();
+		while (tmp_list)
+		{
+			gint transaction_number;
+
+			transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
+			if (gsb_data_transaction_get_account_number (transaction_number) == account_number
+				&& search_transaction_str_is_valide (transaction_number, search_text, dialog))
+				list = g_slist_prepend (list, GINT_TO_POINTER (transaction_number));
+
+			tmp_list = tmp_list->next;
 		}
-		tmp_list = tmp_list->next;
 	}
+	g_hash_table_destroy (candidates);
+	g_free (search_text);
 
 	/* tri de la liste en fonction des dates */
 	list = g_slist_sort_with_data (list, (GCompareDataFunc) search_transaction_sort_result, priv);
@@ -28,6 +28,7 @@
 #endif
 
 #define ETATS_MAX_OPES			3000				/* Nombre d'opérations sélectionnées avant avertissement */
+#define ETATS_THREAD_MIN_OPES	20000				/* Nombre d'opérations à partir duquel l'état est calculé dans des threads */
 
 /* Nbre de messages de delete et de warnings */
 #define NBRE_MSG_WARNINGS		9
@@ -346,6 +347,7 @@ struct _GrisbiWinRun
 
     /* file stuff */
     time_t		file_modification;
+    guint		file_modification_stamp;					/* incremented at each modification, to know if the file was modified during a save */
     gboolean	file_is_saving;
     gboolean	file_is_loading;
     gboolean	menu_save;
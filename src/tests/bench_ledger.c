@@ -0,0 +1,712 @@
+/* *******************************************************************************/
+/*                                 GRISBI                                        */
+/*              Programme de gestion financière personnelle                      */
+/*                              license : GPLv2                                  */
+/*                                                                               */
+/*                      https://www.grisbi.org/                                  */
+/*                                                                               */
+/* *******************************************************************************/
+
+/* *******************************************************************************/
+/*                                                                               */
+/*     This program is free software; you can redistribute it and/or modify      */
+/*     it under the terms of the GNU General Public License as published by      */
+/*     the Free Software Foundation; either version 2 of the License, or         */
+/*     (at your option) any later version.                                       */
+/*                                                                               */
+/*     This program is distributed in the hope that it will be useful,           */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*     GNU General Public License for more details.                              */
+/*                                                                               */
+/*     You should have received a copy of the GNU General Public License         */
+/*     along with this program; if not, write to the Free Software               */
+/*     Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                               */
+/* *******************************************************************************/
+
+/**
+ * \file bench_ledger.c
+ * write a synthetic grisbi file for the benchmarks: several accounts in several
+ * currencies, a lot of payees (some with an import search string), categories,
+ * budgets, splits, transfers and archives of the old years.
+ * the same size and seed give always the same file.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+#include <errno.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+/* START_INCLUDE */
+#include "bench_ledger.h"
+#include "gsb_data_account.h"
+#include "gsb_data_transaction.h"
+#include "structures.h"
+/* END_INCLUDE */
+
+/* the transactions are spread from the first day of BENCH_LEDGER_FIRST_YEAR
+ * to the last day of BENCH_LEDGER_LAST_YEAR, the years up to
+ * BENCH_LEDGER_LAST_ARCHIVED_YEAR are in an archive by year */
+#define BENCH_LEDGER_FIRST_YEAR				2016
+#define BENCH_LEDGER_LAST_YEAR				2025
+#define BENCH_LEDGER_LAST_ARCHIVED_YEAR		2021
+
+#define BENCH_LEDGER_CATEGORIES				40
+#define BENCH_LEDGER_SUB_CATEGORIES			8
+#define BENCH_LEDGER_INCOME_CATEGORIES		5
+#define BENCH_LEDGER_BUDGETS				20
+#define BENCH_LEDGER_SUB_BUDGETS			5
+
+typedef struct _BenchTransaction	BenchTransaction;
+
+struct _BenchTransaction
+{
+	gint		account;
+	gint		number;
+	GDate		date;
+	gint		currency;
+	gint64		cents;
+	gboolean	foreign;
+	gint		payee;
+	gint		category;
+	gint		sub_category;
+	gboolean	is_split;
+	gint		mark;
+	gint		archive;
+	gint		budget;
+	gint		sub_budget;
+	gint		contra;
+	gint		mother;
+};
+
+/* START_STATIC */
+static const gchar *shops[] = {
+	"Supermarche", "Boulangerie", "Pharmacie", "Garage", "Librairie", "Station",
+	"Restaurant", "Cafe", "Cinema", "Fleuriste", "Quincaillerie", "Opticien",
+	"Boucherie", "Primeur", "Coiffeur", "Assurance", "Mutuelle", "Electricite",
+	"Telephone", "Internet", "Loyer", "Parking", "Peage", "Traiteur"
+};
+
+static const gchar *towns[] = {
+	"Paris", "Lyon", "Marseille", "Toulouse", "Nantes", "Lille", "Rennes",
+	"Bordeaux", "Grenoble", "Dijon", "Brest", "Nancy", "Tours", "Amiens"
+};
+
+static const gchar *currencies[][3] = {
+	{"Euro", "E", "EUR"},
+	{"US Dollar", "$", "USD"},
+	{"Pound Sterling", "£", "GBP"},
+	{"Franc suisse", "CHF", "CHF"}
+};
+
+/* exchange rates of the currencies with the euro */
+static const gchar *exchange_rates[] = {"1.00", "1.10", "0.85", "0.95"};
+/* END_STATIC */
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
+/**
+ * return the name of a payee, the same for the file and the imported labels
+ *
+ * \param payee_number
+ *
+ * \return a newly allocated string
+ **/
+static gchar *bench_ledger_payee_name (gint payee_number)
+{
+	gint nb_shops = G_N_ELEMENTS (shops);
+	gint nb_towns = G_N_ELEMENTS (towns);
+
+	return g_strdup_printf ("%s %s %d",
+							shops[payee_number % nb_shops],
+							towns[(payee_number / nb_shops) % nb_towns],
+							payee_number);
+}
+
+/**
+ * return the import search string of a payee, or NULL
+ * one payee in four has a search string with jokers, one in eight
+ * a search string without joker
+ *
+ * \param payee_number
+ *
+ * \return a newly allocated string or NULL
+ **/
+static gchar *bench_ledger_payee_search (gint payee_number)
+{
+	gint nb_shops = G_N_ELEMENTS (shops);
+
+	if (payee_number % 4 == 0)
+		return g_strdup_printf ("%s*%d", shops[payee_number % nb_shops], payee_number);
+	else if (payee_number % 8 == 2)
+		return g_strdup_printf ("PRLV %d %s", payee_number, shops[payee_number % nb_shops]);
+	else
+		return NULL;
+}
+
+/**
+ * return the currency of an account: mostly euros, some dollars and pounds
+ *
+ * \param account_number
+ *
+ * \return the currency number
+ **/
+static gint bench_ledger_account_currency (gint account_number)
+{
+	if (account_number % 5 == 3)
+		return 2;
+	else if (account_number % 7 == 5)
+		return 3;
+	else
+		return 1;
+}
+
+/**
+ * choose a payee, the first payees are used more than the others
+ *
+ * \param rand
+ * \param number_of_payees
+ *
+ * \return a payee number
+ **/
+static gint bench_ledger_random_payee (GRand *rand,
+									   gint number_of_payees)
+{
+	gdouble x;
+
+	x = g_rand_double (rand);
+
+	return 1 + (gint) (x * x * number_of_payees);
+}
+
+/**
+ * write an amount of cents as a grisbi amount
+ *
+ * \param string	buffer of at least 32 chars
+ * \param cents
+ *
+ * \return string
+ **/
+static gchar *bench_ledger_format_amount (gchar *string,
+										  gint64 cents)
+{
+	gint64 abs_cents;
+
+	abs_cents = cents < 0 ? -cents : cents;
+	g_snprintf (string, 32, "%s%" G_GINT64_FORMAT ".%02d",
+				cents < 0 ? "-" : "",
+				abs_cents / 100,
+				(gint) (abs_cents % 100));
+
+	return string;
+}
+
+/**
+ * write a date as in a grisbi file
+ *
+ * \param string	buffer of at least 16 chars
+ * \param date
+ *
+ * \return string
+ **/
+static gchar *bench_ledger_format_date (gchar *string,
+										const GDate *date)
+{
+	g_snprintf (string, 16, "%02d/%02d/%04d",
+				g_date_get_month (date),
+				g_date_get_day (date),
+				g_date_get_year (date));
+
+	return string;
+}
+
+/**
+ * write a transaction in the file
+ *
+ * \param file
+ * \param transaction
+ *
+ * \return
+ **/
+static void bench_ledger_write_transaction (FILE *file,
+											BenchTransaction *transaction)
+{
+	gchar amount[32];
+	gchar date[16];
+
+	fprintf (file,
+			 "\t<Transaction Ac=\"%d\" Nb=\"%d\" Id=\"(null)\" Dt=\"%s\" "
+			 "Dv=\"\" Cu=\"%d\" Am=\"%s\" Exb=\"0\" Exr=\"%s\" Exf=\"0.00\" "
+			 "Pa=\"%d\" Ca=\"%d\" Sca=\"%d\" Br=\"%d\" No=\"(null)\" Pn=\"0\" "
+			 "Pc=\"(null)\" Ma=\"%d\" Ar=\"%d\" Au=\"0\" Re=\"0\" Fi=\"0\" "
+			 "Bu=\"%d\" Sbu=\"%d\" Vo=\"(null)\" Ba=\"(null)\" Trt=\"%d\" Mo=\"%d\" />\n",
+			 transaction->account,
+			 transaction->number,
+			 bench_ledger_format_date (date, &transaction->date),
+			 transaction->currency,
+			 bench_ledger_format_amount (amount, transaction->cents),
+			 transaction->foreign ? exchange_rates[transaction->currency - 1] : "0",
+			 transaction->payee,
+			 transaction->category,
+			 transaction->sub_category,
+			 transaction->is_split,
+			 transaction->mark,
+			 transaction->archive,
+			 transaction->budget,
+			 transaction->sub_budget,
+			 transaction->contra,
+			 transaction->mother);
+}
+
+/**
+ * fill the common part of a new transaction
+ *
+ * \param rand
+ * \param transaction
+ * \param date
+ * \param account
+ *
+ * \return
+ **/
+static void bench_ledger_init_transaction (GRand *rand,
+										   BenchTransaction *transaction,
+										   const GDate *date,
+										   gint account)
+{
+	gint year;
+
+	memset (transaction, 0, sizeof (BenchTransaction));
+	transaction->account = account;
+	transaction->date = *date;
+	transaction->currency = bench_ledger_account_currency (account);
+
+	year = g_date_get_year (date);
+	if (year <= BENCH_LEDGER_LAST_ARCHIVED_YEAR)
+	{
+		transaction->archive = year - BENCH_LEDGER_FIRST_YEAR + 1;
+		transaction->mark = OPERATION_RAPPROCHEE;
+	}
+	else if (g_rand_int_range (rand, 0, 100) < 30)
+		transaction->mark = OPERATION_POINTEE;
+}
+
+/**
+ * choose the category, the budget and the amount of a transaction
+ *
+ * \param rand
+ * \param transaction
+ *
+ * \return
+ **/
+static void bench_ledger_set_division (GRand *rand,
+									   BenchTransaction *transaction)
+{
+	transaction->category = g_rand_int_range (rand, 1, BENCH_LEDGER_CATEGORIES + 1);
+	transaction->sub_category = g_rand_int_range (rand, 0, BENCH_LEDGER_SUB_CATEGORIES + 1);
+
+	if (transaction->category <= BENCH_LEDGER_INCOME_CATEGORIES)
+		transaction->cents = g_rand_int_range (rand, 1000, 300000);
+	else
+		transaction->cents = -g_rand_int_range (rand, 100, 50000);
+
+	if (g_rand_boolean (rand))
+	{
+		transaction->budget = g_rand_int_range (rand, 1, BENCH_LEDGER_BUDGETS + 1);
+		transaction->sub_budget = g_rand_int_range (rand, 0, BENCH_LEDGER_SUB_BUDGETS + 1);
+	}
+}
+
+/**
+ * write the general part, the currencies and the accounts
+ *
+ * \param file
+ * \param number_of_accounts
+ *
+ * \return
+ **/
+static void bench_ledger_write_head (FILE *file,
+									 gint number_of_accounts)
+{
+	gint i;
+
+	fprintf (file,
+			 "<?xml version=\"1.0\"?>\n<Grisbi>\n"
+			 "\t<General\n"
+			 "\t\tFile_version=\"%s\"\n"
+			 "\t\tGrisbi_version=\"%s\"\n"
+			 "\t\tCrypt_file=\"0\"\n"
+			 "\t\tArchive_file=\"0\"\n"
+			 "\t\tFile_title=\"Benchmark\"\n"
+			 "\t\tParty_list_currency_number=\"1\"\n"
+			 "\t\tCategory_list_currency_number=\"1\"\n"
+			 "\t\tBudget_list_currency_number=\"1\" />\n",
+			 VERSION_FICHIER,
+			 VERSION);
+
+	for (i = 0; i < (gint) G_N_ELEMENTS (currencies); i++)
+		fprintf (file, "\t<Currency Nb=\"%d\" Na=\"%s\" Co=\"%s\" Ico=\"%s\" Fl=\"2\" />\n",
+				 i + 1, currencies[i][0], currencies[i][1], currencies[i][2]);
+
+	for (i = 1; i <= number_of_accounts; i++)
+	{
+		gchar amount[32];
+
+		fprintf (file,
+				 "\t<Account\n"
+				 "\t\tName=\"Compte %d\"\n"
+				 "\t\tNumber=\"%d\"\n"
+				 "\t\tOwner=\"Benchmark\"\n"
+				 "\t\tKind=\"%d\"\n"
+				 "\t\tCurrency=\"%d\"\n"
+				 "\t\tBank=\"0\"\n"
+				 "\t\tInitial_balance=\"%s\"\n"
+				 "\t\tMinimum_wanted_balance=\"0.00\"\n"
+				 "\t\tMinimum_authorised_balance=\"0.00\"\n"
+				 "\t\tClosed_account=\"0\"\n"
+				 "\t\tShow_marked=\"0\"\n"
+				 "\t\tShow_archives_lines=\"0\"\n"
+				 "\t\tLines_per_transaction=\"1\"\n"
+				 "\t\tSort_order=\"\"\n"
+				 "\t\tAscending_sort=\"0\"\n"
+				 "\t\tColumn_sort=\"1\"\n"
+				 "\t\tSorting_kind_column=\"18-1-3-13-5-6-0\"\n"
+				 "\t\tBet_use_budget=\"0\" />\n",
+				 i,
+				 i,
+				 i % 6 == 0 ? GSB_TYPE_CASH : GSB_TYPE_BANK,
+				 bench_ledger_account_currency (i),
+				 bench_ledger_format_amount (amount, 100000 * i));
+	}
+}
+
+/**
+ * write the payees, the categories and the budgets
+ *
+ * \param file
+ * \param number_of_payees
+ * \param stats
+ *
+ * \return
+ **/
+static void bench_ledger_write_divisions (FILE *file,
+										  gint number_of_payees,
+										  BenchLedgerStats *stats)
+{
+	gint i;
+	gint j;
+
+	for (i = 1; i <= number_of_payees; i++)
+	{
+		gchar *name;
+		gchar *search;
+
+		name = bench_ledger_payee_name (i);
+		search = bench_ledger_payee_search (i);
+		fprintf (file, "\t<Party Nb=\"%d\" Na=\"%s\" Txt=\"(null)\" Search=\"%s\" "
+					   "IgnCase=\"1\" UseRegex=\"0\" />\n",
+				 i, name, search ? search : "(null)");
+		if (search)
+			stats->associations++;
+		g_free (name);
+		g_free (search);
+	}
+
+	for (i = 1; i <= BENCH_LEDGER_CATEGORIES; i++)
+	{
+		fprintf (file, "\t<Category Nb=\"%d\" Na=\"Categorie %d\" Kd=\"%d\" />\n",
+				 i, i, i <= BENCH_LEDGER_INCOME_CATEGORIES ? 0 : 1);
+		for (j = 1; j <= BENCH_LEDGER_SUB_CATEGORIES; j++)
+			fprintf (file, "\t<Sub_category Nbc=\"%d\" Nb=\"%d\" Na=\"Sous-categorie %d\" />\n",
+					 i, j, j);
+	}
+	stats->categories = BENCH_LEDGER_CATEGORIES * (BENCH_LEDGER_SUB_CATEGORIES + 1);
+
+	for (i = 1; i <= BENCH_LEDGER_BUDGETS; i++)
+	{
+		fprintf (file, "\t<Budgetary Nb=\"%d\" Na=\"Budget %d\" Kd=\"1\" />\n", i, i);
+		for (j = 1; j <= BENCH_LEDGER_SUB_BUDGETS; j++)
+			fprintf (file, "\t<Sub_budgetary Nbb=\"%d\" Nb=\"%d\" Na=\"Sous-budget %d\" />\n",
+					 i, j, j);
+	}
+}
+
+/**
+ * write the links between the currencies and the archives
+ *
+ * \param file
+ * \param stats
+ *
+ * \return
+ **/
+static void bench_ledger_write_tail (FILE *file,
+									 BenchLedgerStats *stats)
+{
+	gint i;
+	gint year;
+
+	for (i = 2; i <= (gint) G_N_ELEMENTS (currencies); i++)
+		fprintf (file, "\t<Currency_link Nb=\"%d\" Cu1=\"1\" Cu2=\"%d\" Ex=\"%s\" "
+					   "Modified_date=\"01/01/%d\" Fl=\"0\" />\n",
+				 i - 1, i, exchange_rates[i - 1], BENCH_LEDGER_LAST_YEAR);
+
+	for (year = BENCH_LEDGER_FIRST_YEAR; year <= BENCH_LEDGER_LAST_ARCHIVED_YEAR; year++)
+	{
+		fprintf (file, "\t<Archive Nb=\"%d\" Na=\"Archive %d\" Bdte=\"01/01/%d\" "
+					   "Edte=\"12/31/%d\" Fye=\"0\" Rep=\"(null)\" />\n",
+				 year - BENCH_LEDGER_FIRST_YEAR + 1, year, year, year);
+		stats->archives++;
+	}
+
+	fprintf (file, "</Grisbi>");
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * write a grisbi file with about number_of_transactions transactions
+ *
+ * \param filename
+ * \param number_of_transactions	the children of the splits and the two
+ * 									parts of the transfers are counted
+ * \param seed						the same seed gives the same file
+ * \param stats						filled with the content of the file, can be NULL
+ * \param error
+ *
+ * \return TRUE if the file is written
+ **/
+gboolean bench_ledger_write (const gchar *filename,
+							 gint number_of_transactions,
+							 guint32 seed,
+							 BenchLedgerStats *stats,
+							 GError **error)
+{
+	FILE *file;
+	GRand *rand;
+	GDate first_date;
+	BenchLedgerStats local_stats = {0};
+	gint number_of_accounts;
+	gint number_of_payees;
+	gint number_of_days;
+	gint written = 0;
+
+	if (!stats)
+		stats = &local_stats;
+	memset (stats, 0, sizeof (BenchLedgerStats));
+
+	file = g_fopen (filename, "w");
+	if (!file)
+	{
+		gint saved_errno = errno;
+
+		g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (saved_errno),
+					 "%s: %s", filename, g_strerror (saved_errno));
+
+		return FALSE;
+	}
+
+	rand = g_rand_new_with_seed (seed);
+
+	number_of_accounts = 4 + number_of_transactions / 25000;
+	number_of_payees = CLAMP (number_of_transactions / 20, 50, 20000);
+	stats->accounts = number_of_accounts;
+	stats->currencies = G_N_ELEMENTS (currencies);
+	stats->payees = number_of_payees;
+
+	g_date_clear (&first_date, 1);
+	g_date_set_dmy (&first_date, 1, G_DATE_JANUARY, BENCH_LEDGER_FIRST_YEAR);
+	number_of_days = 365 * (BENCH_LEDGER_LAST_YEAR - BENCH_LEDGER_FIRST_YEAR + 1)
+		+ (BENCH_LEDGER_LAST_YEAR - BENCH_LEDGER_FIRST_YEAR + 1) / 4;
+
+	bench_ledger_write_head (file, number_of_accounts);
+
+	/* the transactions are written in the order of their dates, as they are entered */
+	while (written < number_of_transactions)
+	{
+		BenchTransaction transaction;
+		GDate date;
+		gint account;
+		gint kind;
+		gint left;
+
+		date = first_date;
+		g_date_add_days (&date, (guint) ((gint64) written * number_of_days / number_of_transactions));
+		account = g_rand_int_range (rand, 1, number_of_accounts + 1);
+		kind = g_rand_int_range (rand, 0, 100);
+		left = number_of_transactions - written;
+
+		bench_ledger_init_transaction (rand, &transaction, &date, account);
+		transaction.number = written + 1;
+		transaction.payee = bench_ledger_random_payee (rand, number_of_payees);
+
+		if (kind < 8 && left >= 3)
+		{
+			/* a split with 2 to 4 children, written after the mother */
+			BenchTransaction children[4];
+			gint nb_children;
+			gint i;
+
+			nb_children = MIN (g_rand_int_range (rand, 2, 5), left - 1);
+			transaction.is_split = TRUE;
+
+			for (i = 0; i < nb_children; i++)
+			{
+				bench_ledger_init_transaction (rand, &children[i], &date, account);
+				children[i].number = transaction.number + i + 1;
+				children[i].mark = transaction.mark;
+				children[i].payee = transaction.payee;
+				children[i].mother = transaction.number;
+				bench_ledger_set_division (rand, &children[i]);
+				transaction.cents += children[i].cents;
+			}
+
+			bench_ledger_write_transaction (file, &transaction);
+			for (i = 0; i < nb_children; i++)
+			{
+				bench_ledger_write_transaction (file, &children[i]);
+				stats->archived += children[i].archive != 0;
+			}
+			stats->transactions += nb_children;
+			stats->splits++;
+			written += nb_children;
+		}
+		else if (kind < 16 && left >= 2 && number_of_accounts > 1)
+		{
+			/* a transfer between two accounts of the same currency */
+			BenchTransaction contra;
+			gint contra_account;
+
+			contra_account = account % number_of_accounts + 1;
+			while (bench_ledger_account_currency (contra_account) != transaction.currency)
+				contra_account = contra_account % number_of_accounts + 1;
+
+			if (contra_account == account)
+			{
+				/* no other account in this currency, make a normal transaction */
+				bench_ledger_set_division (rand, &transaction);
+				bench_ledger_write_transaction (file, &transaction);
+			}
+			else
+			{
+				bench_ledger_init_transaction (rand, &contra, &date, contra_account);
+				contra.number = transaction.number + 1;
+				contra.mark = transaction.mark;
+				contra.payee = transaction.payee;
+				transaction.cents = -g_rand_int_range (rand, 1000, 200000);
+				contra.cents = -transaction.cents;
+				transaction.contra = contra.number;
+				contra.contra = transaction.number;
+				bench_ledger_write_transaction (file, &transaction);
+				bench_ledger_write_transaction (file, &contra);
+				stats->transfers++;
+				stats->transactions++;
+				stats->archived += contra.archive != 0;
+				written++;
+			}
+		}
+		else
+		{
+			bench_ledger_set_division (rand, &transaction);
+
+			/* some transactions in another currency than the account */
+			if (g_rand_int_range (rand, 0, 100) < 3)
+			{
+				transaction.currency = transaction.currency % G_N_ELEMENTS (currencies) + 1;
+				transaction.foreign = TRUE;
+				stats->foreign++;
+			}
+			bench_ledger_write_transaction (file, &transaction);
+		}
+
+		stats->transactions++;
+		stats->archived += transaction.archive != 0;
+		written++;
+	}
+
+	bench_ledger_write_divisions (file, number_of_payees, stats);
+	bench_ledger_write_tail (file, stats);
+
+	g_rand_free (rand);
+
+	if (fclose (file) != 0)
+	{
+		gint saved_errno = errno;
+
+		g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (saved_errno),
+					 "%s: %s", filename, g_strerror (saved_errno));
+
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * make the labels of the transactions of a bank file to import:
+ * the labels of the payees with a search string, as written by a bank,
+ * mixed with labels which match no payee
+ *
+ * \param number_of_labels
+ * \param number_of_payees	the number of payees of the file
+ * \param seed
+ *
+ * \return a NULL terminated array of labels to free with g_strfreev ()
+ **/
+gchar **bench_ledger_make_imported_labels (gint number_of_labels,
+										   gint number_of_payees,
+										   guint32 seed)
+{
+	GRand *rand;
+	gchar **labels;
+	gint nb_shops = G_N_ELEMENTS (shops);
+	gint i;
+
+	rand = g_rand_new_with_seed (seed);
+	labels = g_new0 (gchar *, number_of_labels + 1);
+
+	for (i = 0; i < number_of_labels; i++)
+	{
+		gint payee_number;
+
+		payee_number = bench_ledger_random_payee (rand, number_of_payees);
+		if (payee_number % 4 == 0)
+		{
+			gchar *name;
+			gchar *upper;
+
+			name = bench_ledger_payee_name (payee_number);
+			upper = g_utf8_strup (name, -1);
+			labels[i] = g_strdup_printf ("CB %s %02d/%02d",
+										 upper,
+										 g_rand_int_range (rand, 1, 29),
+										 g_rand_int_range (rand, 1, 13));
+			g_free (upper);
+			g_free (name);
+		}
+		else if (payee_number % 8 == 2)
+			labels[i] = g_strdup_printf ("prlv %d %s", payee_number, shops[payee_number % nb_shops]);
+		else
+			labels[i] = g_strdup_printf ("VIR SEPA %d REF %u",
+										 payee_number,
+										 g_rand_int (rand));
+	}
+
+	g_rand_free (rand);
+
+	return labels;
+}
+
+/**
+ *
+ *
+ *
+ * */
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
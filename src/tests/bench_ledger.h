@@ -0,0 +1,39 @@
+#ifndef _BENCH_LEDGER_H
+#define _BENCH_LEDGER_H (1)
+
+#include <glib.h>
+
+/* START_INCLUDE_H */
+/* END_INCLUDE_H */
+
+typedef struct _BenchLedgerStats	BenchLedgerStats;
+
+/* what the generator has written in the file */
+struct _BenchLedgerStats
+{
+	gint		accounts;
+	gint		currencies;
+	gint		payees;
+	gint		associations;		/* payees with an import search string */
+	gint		categories;			/* categories and sub-categories */
+	gint		archives;
+	gint		transactions;		/* all the transactions, with the children of the splits */
+	gint		splits;				/* mother transactions */
+	gint		transfers;			/* pairs of transactions */
+	gint		archived;			/* transactions in an archive */
+	gint		foreign;			/* transactions in another currency than their account */
+};
+
+
+/* START_DECLARATION */
+gchar **	bench_ledger_make_imported_labels	(gint number_of_labels,
+												 gint number_of_payees,
+												 guint32 seed);
+gboolean	bench_ledger_write					(const gchar *filename,
+												 gint number_of_transactions,
+												 guint32 seed,
+												 BenchLedgerStats *stats,
+												 GError **error);
+/* END_DECLARATION */
+
+#endif
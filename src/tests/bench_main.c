@@ -0,0 +1,678 @@
+/* *******************************************************************************/
+/*                                 GRISBI                                        */
+/*              Programme de gestion financière personnelle                      */
+/*                              license : GPLv2                                  */
+/*                                                                               */
+/*                      https://www.grisbi.org/                                  */
+/*                                                                               */
+/* *******************************************************************************/
+
+/* *******************************************************************************/
+/*                                                                               */
+/*     This program is free software; you can redistribute it and/or modify      */
+/*     it under the terms of the GNU General Public License as published by      */
+/*     the Free Software Foundation; either version 2 of the License, or         */
+/*     (at your option) any later version.                                       */
+/*                                                                               */
+/*     This program is distributed in the hope that it will be useful,           */
+/*     but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*     GNU General Public License for more details.                              */
+/*                                                                               */
+/*     You should have received a copy of the GNU General Public License         */
+/*     along with this program; if not, write to the Free Software               */
+/*     Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                               */
+/* *******************************************************************************/
+
+/**
+ * \file bench_main.c
+ * benchmarks of the data layer of grisbi, without application nor display.
+ * for each size, a file is written by the generator of bench_ledger.c, then
+ * the load, the save, the balances, the metatree counters, the report
+ * selection and the import matching are timed.
+ * the results are written one line by measure, fields separated by tabs:
+ * label, transactions, operation, iterations, min_us, median_us, max_us, items
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+#include <stdlib.h>
+#include <locale.h>
+#include <glib/gstdio.h>
+
+/* START_INCLUDE */
+#include "bench_ledger.h"
+#include "etats_calculs.h"
+#include "grisbi_app.h"
+#include "gsb_data_account.h"
+#include "gsb_data_archive.h"
+#include "gsb_data_archive_store.h"
+#include "gsb_data_bank.h"
+#include "gsb_data_budget.h"
+#include "gsb_data_category.h"
+#include "gsb_data_currency.h"
+#include "gsb_data_currency_link.h"
+#include "gsb_data_fyear.h"
+#include "gsb_data_import_rule.h"
+#include "gsb_data_partial_balance.h"
+#include "gsb_data_payee.h"
+#include "gsb_data_payment.h"
+#include "gsb_data_reconcile.h"
+#include "gsb_data_report.h"
+#include "gsb_data_report_amout_comparison.h"
+#include "gsb_data_report_text_comparison.h"
+#include "gsb_data_scheduled.h"
+#include "gsb_data_transaction.h"
+#include "gsb_dirs.h"
+#include "gsb_file_cache.h"
+#include "gsb_file_load.h"
+#include "gsb_file_save.h"
+#include "gsb_locale.h"
+#include "gsb_regex.h"
+#include "gsb_trace.h"
+#include "import.h"
+#include "import_asso_matcher.h"
+#include "structures.h"
+/* END_INCLUDE */
+
+#define BENCH_SEED					20240601
+#define BENCH_MAX_COUNTER_UPDATES	20000
+
+typedef struct _BenchRun	BenchRun;
+
+struct _BenchRun
+{
+	FILE *			output;
+	const gchar *	label;
+	gint			number_of_transactions;
+	gint			iterations;
+	gint64 *		times;
+};
+
+/* START_STATIC */
+static gchar *		bench_sizes = NULL;
+static gint			bench_iterations = 3;
+static gchar *		bench_directory = NULL;
+static gchar *		bench_generate = NULL;
+static gchar *		bench_output = NULL;
+static gchar *		bench_label = NULL;
+static gchar *		bench_trace = NULL;
+static gboolean		bench_keep = FALSE;
+
+static const GOptionEntry bench_options[] =
+{
+	{"sizes", 's', 0, G_OPTION_ARG_STRING, &bench_sizes,
+	 "Numbers of transactions of the files, separated by commas (10000,100000,1000000)", "N,N,..."},
+	{"iterations", 'i', 0, G_OPTION_ARG_INT, &bench_iterations,
+	 "Number of runs of each measure (3)", "N"},
+	{"directory", 'd', 0, G_OPTION_ARG_FILENAME, &bench_directory,
+	 "Directory of the generated files (a temporary directory)", "DIR"},
+	{"keep", 'k', 0, G_OPTION_ARG_NONE, &bench_keep,
+	 "Keep the generated files", NULL},
+	{"generate", 'g', 0, G_OPTION_ARG_FILENAME, &bench_generate,
+	 "Only write a file of the first size and quit", "FILE"},
+	{"output", 'o', 0, G_OPTION_ARG_FILENAME, &bench_output,
+	 "Write the results in FILE instead of the standard output", "FILE"},
+	{"label", 'l', 0, G_OPTION_ARG_STRING, &bench_label,
+	 "Label of the build in the results (the version)", "LABEL"},
+	{"trace", 't', 0, G_OPTION_ARG_FILENAME, &bench_trace,
+	 "Record the trace of the operations in FILE, or print a summary with \"summary\"", "FILE"},
+	{NULL}
+};
+/* END_STATIC */
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
+/**
+ * forget all the data of the file, as init_variables () without the gui
+ *
+ * \param
+ *
+ * \return
+ **/
+static void bench_reset_data (void)
+{
+	gsb_data_account_init_variables ();
+	gsb_data_transaction_init_variables ();
+	gsb_data_payee_init_variables (TRUE);
+	gsb_data_category_init_variables (TRUE);
+	gsb_data_budget_init_variables (TRUE);
+	gsb_data_report_init_variables ();
+	gsb_data_report_amount_comparison_init_variables ();
+	gsb_data_report_text_comparison_init_variables ();
+	gsb_data_scheduled_init_variables ();
+	gsb_data_currency_init_variables ();
+	gsb_data_currency_link_init_variables ();
+	gsb_data_fyear_init_variables ();
+	gsb_data_bank_init_variables ();
+	gsb_data_reconcile_init_variables ();
+	gsb_data_payment_init_variables ();
+	gsb_data_archive_init_variables ();
+	gsb_data_archive_store_init_variables ();
+	gsb_data_import_rule_init_variables ();
+	gsb_import_associations_init_variables ();
+	gsb_data_partial_balance_init_variables ();
+}
+
+/**
+ * compare two times for qsort
+ *
+ * \param a
+ * \param b
+ *
+ * \return
+ **/
+static gint bench_compare_times (gconstpointer a,
+								 gconstpointer b)
+{
+	gint64 time_a = *(const gint64 *) a;
+	gint64 time_b = *(const gint64 *) b;
+
+	return (time_a > time_b) - (time_a < time_b);
+}
+
+/**
+ * write the result of a measure, the times of the iterations are in run->times
+ *
+ * \param run
+ * \param operation
+ * \param iterations	number of times in run->times
+ * \param items			number of items processed by one iteration
+ *
+ * \return
+ **/
+static void bench_report (BenchRun *run,
+						  const gchar *operation,
+						  gint iterations,
+						  gint64 items)
+{
+	qsort (run->times, iterations, sizeof (gint64), bench_compare_times);
+
+	fprintf (run->output,
+			 "%s\t%d\t%s\t%d\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\n",
+			 run->label,
+			 run->number_of_transactions,
+			 operation,
+			 iterations,
+			 run->times[0],
+			 run->times[iterations / 2],
+			 run->times[iterations - 1],
+			 items);
+	fflush (run->output);
+}
+
+/**
+ * load a file, the data of the previous file are forgotten before
+ *
+ * \param filename
+ * \param run
+ * \param operation
+ *
+ * \return TRUE if the file is loaded at each iteration
+ **/
+static gboolean bench_load (const gchar *filename,
+							BenchRun *run,
+							const gchar *operation)
+{
+	gint i;
+
+	for (i = 0; i < run->iterations; i++)
+	{
+		gint64 start;
+
+		bench_reset_data ();
+		start = g_get_monotonic_time ();
+		if (!gsb_file_load_open_file (filename))
+		{
+			g_printerr ("cannot load %s\n", filename);
+
+			return FALSE;
+		}
+		run->times[i] = g_get_monotonic_time () - start;
+	}
+	bench_report (run, operation, run->iterations,
+				  g_slist_length (gsb_data_transaction_get_loaded_transactions_list ()));
+
+	return TRUE;
+}
+
+/**
+ * compute the balances of all the accounts from their transactions
+ *
+ * \param run
+ *
+ * \return
+ **/
+static void bench_balances (BenchRun *run)
+{
+	gint i;
+
+	for (i = 0; i < run->iterations; i++)
+	{
+		GSList *tmp_list;
+		gint64 start;
+
+		for (tmp_list = gsb_data_account_get_list_accounts (); tmp_list; tmp_list = tmp_list->next)
+			gsb_data_account_set_balances_are_dirty (gsb_data_account_get_no_account (tmp_list->data));
+
+		start = g_get_monotonic_time ();
+		for (tmp_list = gsb_data_account_get_list_accounts (); tmp_list; tmp_list = tmp_list->next)
+			gsb_data_account_calculate_current_and_marked_balances (gsb_data_account_get_no_account
+																	(tmp_list->data));
+		run->times[i] = g_get_monotonic_time () - start;
+	}
+	bench_report (run, "account_balances", run->iterations, gsb_data_account_get_number_of_accounts ());
+}
+
+/**
+ * count the transactions of the payees, categories and budgets from scratch,
+ * then keep the counters up to date while the payee of transactions is changed
+ *
+ * \param run
+ *
+ * \return
+ **/
+static void bench_metatree_counters (BenchRun *run)
+{
+	GArray *transactions;
+	GSList *tmp_list;
+	gint number_of_payees;
+	gint i;
+	guint j;
+
+	for (i = 0; i < run->iterations; i++)
+	{
+		gint64 start;
+
+		gsb_data_payee_invalidate_counters ();
+		gsb_data_category_invalidate_counters ();
+		gsb_data_budget_invalidate_counters ();
+
+		start = g_get_monotonic_time ();
+		gsb_data_payee_update_counters ();
+		gsb_data_category_update_counters ();
+		gsb_data_budget_update_counters ();
+		run->times[i] = g_get_monotonic_time () - start;
+	}
+	bench_report (run, "metatree_counters_compute", run->iterations,
+				  g_slist_length (gsb_data_transaction_get_transactions_list ()));
+
+	/* the children of the splits take the payee of their mother */
+	transactions = g_array_new (FALSE, FALSE, sizeof (gint));
+	for (tmp_list = gsb_data_transaction_get_transactions_list ();
+		 tmp_list && transactions->len < BENCH_MAX_COUNTER_UPDATES;
+		 tmp_list = tmp_list->next)
+	{
+		gint transaction_number;
+
+		transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
+		if (!gsb_data_transaction_get_mother_transaction_number (transaction_number))
+			g_array_append_val (transactions, transaction_number);
+	}
+	number_of_payees = g_slist_length (gsb_data_payee_get_payees_list ());
+
+	for (i = 0; i < run->iterations; i++)
+	{
+		gint64 start;
+
+		start = g_get_monotonic_time ();
+		for (j = 0; j < transactions->len; j++)
+		{
+			gint transaction_number;
+			gint payee_number;
+
+			transaction_number = g_array_index (transactions, gint, j);
+			payee_number = gsb_data_transaction_get_party_number (transaction_number);
+			gsb_data_transaction_set_party_number (transaction_number,
+												   payee_number % MAX (number_of_payees - 1, 1) + 1);
+			gsb_data_transaction_set_party_number (transaction_number, payee_number);
+		}
+		run->times[i] = g_get_monotonic_time () - start;
+	}
+	bench_report (run, "metatree_counters_update", run->iterations, 2 * transactions->len);
+
+	g_array_free (transactions, TRUE);
+}
+
+/**
+ * select the transactions of a report on all the accounts and all the dates
+ *
+ * \param run
+ *
+ * \return
+ **/
+static void bench_report_selection (BenchRun *run)
+{
+	gint report_number;
+	guint selected = 0;
+	gint i;
+
+	report_number = gsb_data_report_new ("Benchmark");
+
+	for (i = 0; i < run->iterations; i++)
+	{
+		GSList *list;
+		gint64 start;
+
+		start = g_get_monotonic_time ();
+		list = recupere_opes_etat (report_number);
+		run->times[i] = g_get_monotonic_time () - start;
+
+		selected = g_slist_length (list);
+		g_slist_free (list);
+	}
+	bench_report (run, "report_selection", run->iterations, selected);
+
+	gsb_data_report_remove (report_number);
+}
+
+/**
+ * look for the payees of the labels of a bank file in the associations
+ *
+ * \param run
+ *
+ * \return
+ **/
+static void bench_import_matching (BenchRun *run)
+{
+	gchar **labels;
+	gint number_of_labels;
+	gint i;
+
+	number_of_labels = MAX (1000, run->number_of_transactions / 10);
+	labels = bench_ledger_make_imported_labels (number_of_labels,
+												g_slist_length (gsb_data_payee_get_payees_list ()),
+												BENCH_SEED);
+
+	for (i = 0; i < run->iterations; i++)
+	{
+		ImportAssoMatcher *matcher;
+		gint64 start;
+		gint j;
+
+		start = g_get_monotonic_time ();
+		matcher = import_asso_matcher_new (gsb_import_associations_get_liste_associations ());
+		for (j = 0; j < number_of_labels; j++)
+			import_asso_matcher_find_payee (matcher, labels[j]);
+		import_asso_matcher_free (matcher);
+		run->times[i] = g_get_monotonic_time () - start;
+	}
+	bench_report (run, "import_matching", run->iterations, number_of_labels);
+
+	g_strfreev (labels);
+}
+
+/**
+ * save the loaded file, then write its cache and load it with the cache
+ *
+ * \param filename	name of the saved file
+ * \param run
+ *
+ * \return TRUE if ok
+ **/
+static gboolean bench_save (const gchar *filename,
+							BenchRun *run)
+{
+	GsbFileSavePartsPosition parts_position;
+	gint64 start;
+	gint i;
+
+	gsb_file_cache_remove (filename);
+	for (i = 0; i < run->iterations; i++)
+	{
+		start = g_get_monotonic_time ();
+		if (!gsb_file_save_save_file (filename, FALSE, 0, &parts_position))
+		{
+			g_printerr ("cannot save %s\n", filename);
+
+			return FALSE;
+		}
+		run->times[i] = g_get_monotonic_time () - start;
+	}
+	bench_report (run, "file_save", run->iterations,
+				  g_slist_length (gsb_data_transaction_get_complete_transactions_list ()));
+
+	/* a readable file makes the load ask a question */
+	g_chmod (filename, 0600);
+
+	start = g_get_monotonic_time ();
+	if (!gsb_file_cache_save (filename, &parts_position))
+	{
+		g_printerr ("cannot write the cache of %s\n", filename);
+
+		return FALSE;
+	}
+	run->times[0] = g_get_monotonic_time () - start;
+	bench_report (run, "file_cache_save", 1,
+				  g_slist_length (gsb_data_transaction_get_complete_transactions_list ()));
+
+	if (!bench_load (filename, run, "file_load_cached"))
+		return FALSE;
+
+	/* the archived transactions are kept in the cache until something needs them */
+	start = g_get_monotonic_time ();
+	gsb_file_cache_load_archive (0);
+	run->times[0] = g_get_monotonic_time () - start;
+	bench_report (run, "archives_load", 1,
+				  g_slist_length (gsb_data_transaction_get_complete_transactions_list ()));
+
+	return TRUE;
+}
+
+/**
+ * run all the measures on a file of number_of_transactions transactions
+ *
+ * \param run
+ * \param directory
+ *
+ * \return TRUE if ok
+ **/
+static gboolean bench_run_size (BenchRun *run,
+								const gchar *directory)
+{
+	GError *error = NULL;
+	gchar *tmp_str;
+	gchar *filename;
+	gchar *saved_filename;
+	BenchLedgerStats stats;
+	gboolean result = FALSE;
+	gint64 start;
+
+	tmp_str = g_strdup_printf ("bench_%d.gsb", run->number_of_transactions);
+	filename = g_build_filename (directory, tmp_str, NULL);
+	g_free (tmp_str);
+	tmp_str = g_strdup_printf ("bench_%d_saved.gsb", run->number_of_transactions);
+	saved_filename = g_build_filename (directory, tmp_str, NULL);
+	g_free (tmp_str);
+
+	start = g_get_monotonic_time ();
+	if (!bench_ledger_write (filename, run->number_of_transactions, BENCH_SEED, &stats, &error))
+	{
+		g_printerr ("cannot write %s\n", error->message);
+		g_error_free (error);
+		goto out;
+	}
+	run->times[0] = g_get_monotonic_time () - start;
+	g_chmod (filename, 0600);
+	gsb_file_cache_remove (filename);
+	bench_report (run, "generate", 1, stats.transactions);
+
+	if (!bench_load (filename, run, "file_load"))
+		goto out;
+
+	bench_balances (run);
+	bench_metatree_counters (run);
+	bench_report_selection (run);
+	bench_import_matching (run);
+
+	result = bench_save (saved_filename, run);
+
+out:
+	if (!bench_keep)
+	{
+		g_unlink (filename);
+		gsb_file_cache_remove (saved_filename);
+		g_unlink (saved_filename);
+	}
+	g_free (filename);
+	g_free (saved_filename);
+
+	return result;
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+int main (int argc, char **argv)
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	GrisbiAppConf *a_conf;
+	GrisbiWinEtat *w_etat;
+	GrisbiWinRun *w_run;
+	BenchRun run = {0};
+	gchar **sizes;
+	gchar *directory;
+	gint status = EXIT_SUCCESS;
+	gint i;
+
+	setlocale (LC_ALL, "");
+
+	context = g_option_context_new ("- benchmarks of grisbi without display");
+	g_option_context_add_main_entries (context, bench_options, NULL);
+	if (!g_option_context_parse (context, &argc, &argv, &error))
+	{
+		g_printerr ("%s\n", error->message);
+		g_error_free (error);
+		g_option_context_free (context);
+
+		return EXIT_FAILURE;
+	}
+	g_option_context_free (context);
+
+	sizes = g_strsplit (bench_sizes ? bench_sizes : "10000,100000,1000000", ",", 0);
+
+	/* only write a file */
+	if (bench_generate)
+	{
+		BenchLedgerStats stats;
+
+		if (!bench_ledger_write (bench_generate, atoi (sizes[0]), BENCH_SEED, &stats, &error))
+		{
+			g_printerr ("%s\n", error->message);
+			g_error_free (error);
+			g_strfreev (sizes);
+
+			return EXIT_FAILURE;
+		}
+		g_chmod (bench_generate, 0600);
+		printf ("%s: %d transactions (%d splits, %d transfers, %d archived, %d in a foreign currency), "
+				"%d accounts, %d payees (%d associations), %d archives\n",
+				bench_generate, stats.transactions, stats.splits, stats.transfers, stats.archived,
+				stats.foreign, stats.accounts, stats.payees, stats.associations, stats.archives);
+		g_strfreev (sizes);
+
+		return EXIT_SUCCESS;
+	}
+
+	if (bench_trace && !gsb_trace_init (bench_trace))
+		g_printerr ("cannot trace in %s\n", bench_trace);
+
+	/* the data layer without application nor window */
+	gsb_dirs_init (argv[0]);
+	gsb_locale_init_lconv_struct ();
+	gsb_regex_init_variables ();
+
+	if (bench_directory)
+		directory = g_strdup (bench_directory);
+	else
+	{
+		directory = g_dir_make_tmp ("grisbi-bench-XXXXXX", &error);
+		if (!directory)
+		{
+			g_printerr ("%s\n", error->message);
+			g_error_free (error);
+			g_strfreev (sizes);
+
+			return EXIT_FAILURE;
+		}
+	}
+
+	run.output = stdout;
+	if (bench_output)
+	{
+		run.output = g_fopen (bench_output, "w");
+		if (!run.output)
+		{
+			g_printerr ("cannot write %s\n", bench_output);
+			g_strfreev (sizes);
+			g_free (directory);
+
+			return EXIT_FAILURE;
+		}
+	}
+	run.label = bench_label ? bench_label : VERSION;
+	run.iterations = MAX (bench_iterations, 1);
+	run.times = g_new0 (gint64, run.iterations);
+
+	/* without application nor window, the getters of the configuration return these structures */
+	a_conf = g_new0 (GrisbiAppConf, 1);
+	w_etat = g_new0 (GrisbiWinEtat, 1);
+	w_etat->metatree_add_archive_in_totals = TRUE;
+	w_etat->export_quote_dates = TRUE;
+	w_run = g_new0 (GrisbiWinRun, 1);
+	w_run->prefs_expand_tree = TRUE;
+	w_run->prefs_selected_row = g_strdup ("0:0");
+	grisbi_app_set_headless_conf (a_conf);
+	grisbi_win_set_headless_structures (w_etat, w_run);
+
+	fprintf (run.output, "# label\ttransactions\toperation\titerations\tmin_us\tmedian_us\tmax_us\titems\n");
+
+	for (i = 0; sizes[i]; i++)
+	{
+		run.number_of_transactions = atoi (sizes[i]);
+		if (run.number_of_transactions <= 0)
+			continue;
+
+		if (!bench_run_size (&run, directory))
+			status = EXIT_FAILURE;
+	}
+
+	bench_reset_data ();
+	gsb_trace_finish ();
+
+	grisbi_win_set_headless_structures (NULL, NULL);
+	grisbi_app_set_headless_conf (NULL);
+	g_free (w_run->prefs_selected_row);
+	g_free (w_run);
+	g_free (w_etat);
+	g_free (a_conf);
+
+	if (!bench_directory && !bench_keep)
+		g_rmdir (directory);
+
+	if (run.output != stdout)
+		fclose (run.output);
+
+	g_free (run.times);
+	g_free (directory);
+	g_strfreev (sizes);
+	gsb_regex_destroy ();
+	gsb_dirs_shutdown ();
+
+	return status;
+}
+
+/**
+ *
+ *
+ *
+ * */
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
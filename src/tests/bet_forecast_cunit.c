@@ -0,0 +1,203 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  bet_forecast_cunit                        */
+/*                                                                            */
+/*     Copyright (C)	2000-2007 Cédric Auger (cedric@grisbi.org)	          */
+/*			2003-2008 Benjamin Drieu (bdrieu@april.org)	                      */
+/* 			https://www.grisbi.org				                              */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, write to the Free Software               */
+/*  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file bet_forecast_cunit.c
+ * cunit tests for bet_forecast
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "include.h"
+
+/* START_INCLUDE */
+#include "bet_forecast_cunit.h"
+#include "bet_data.h"
+#include "bet_forecast.h"
+#include "utils_dates.h"
+#include "gsb_data_account.h"
+#include "gsb_data_currency.h"
+#include "gsb_data_partial_balance.h"
+#include "gsb_data_transaction.h"
+#include "gsb_real.h"
+#include "structures.h"
+/* END_INCLUDE */
+
+/* START_STATIC */
+static gint bet_forecast_cunit_add_transaction(gint account_number,
+                                               gint currency_number,
+                                               gint64 mantissa,
+                                               const GDate *date,
+                                               gint days);
+static void bet_forecast_cunit__bet_forecast_new_for_partial_balance(void);
+static int bet_forecast_cunit_clean_suite(void);
+static int bet_forecast_cunit_init_suite(void);
+/* END_STATIC */
+
+/* START_EXTERN */
+/* END_EXTERN */
+
+/* The suite initialization function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int bet_forecast_cunit_init_suite(void)
+{
+    bet_data_init_variables();
+    bet_data_set_div_ptr(0);
+
+    return 0;
+}
+
+/* The suite cleanup function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int bet_forecast_cunit_clean_suite(void)
+{
+    return 0;
+}
+
+/* add a transaction of amount mantissa / 100 at date + days */
+gint bet_forecast_cunit_add_transaction(gint account_number,
+                                        gint currency_number,
+                                        gint64 mantissa,
+                                        const GDate *date,
+                                        gint days)
+{
+    GDate *tr_date = gsb_date_copy(date);
+    GsbReal amount = { mantissa, 2 };
+    gint tr_number;
+
+    if (days < 0)
+        g_date_subtract_days(tr_date, -days);
+    else
+        g_date_add_days(tr_date, days);
+
+    tr_number = gsb_data_transaction_new_transaction(account_number);
+    gsb_data_transaction_set_currency_number(tr_number, currency_number);
+    gsb_data_transaction_set_amount(tr_number, amount);
+    gsb_data_transaction_set_date(tr_number, tr_date);
+    g_date_free(tr_date);
+
+    return tr_number;
+}
+
+void bet_forecast_cunit__bet_forecast_new_for_partial_balance(void)
+{
+    GDate *date_min = gdate_today();
+    GDate *date_max = gsb_date_copy(date_min);
+    GDate *value_date = gsb_date_copy(date_min);
+    GsbReal expected = { 0, 2 };
+    BetForecast *forecast;
+    BetForecastEvent *event;
+    gchar *liste_cptes;
+    gint nb_transactions = 0;
+    guint i;
+
+    g_date_add_days(date_max, 20);
+
+    gint cur_number = gsb_data_currency_new("EUR");
+    gsb_data_currency_set_floating_point(cur_number, 2);
+
+    gint account_1 = gsb_data_account_new(GSB_TYPE_BANK);
+    gint account_2 = gsb_data_account_new(GSB_TYPE_BANK);
+    gsb_data_account_set_currency(account_1, cur_number);
+    gsb_data_account_set_currency(account_2, cur_number);
+
+    gint partial_number = gsb_partial_balance_new_at_position("cunit", 1);
+    CU_ASSERT_NOT_EQUAL(0, partial_number);
+    liste_cptes = g_strdup_printf("%d;%d", account_1, account_2);
+    gsb_data_partial_balance_set_liste_cptes(partial_number, liste_cptes);
+    gsb_data_partial_balance_set_currency(partial_number, cur_number);
+    g_free(liste_cptes);
+
+    /* before the period : in the initial balance */
+    bet_forecast_cunit_add_transaction(account_1, cur_number, -5000, date_min, -10);
+    bet_forecast_cunit_add_transaction(account_2, cur_number, 10000, date_min, -5);
+
+    /* in the period */
+    bet_forecast_cunit_add_transaction(account_1, cur_number, -3000, date_min, 2);
+
+    /* dated before the period but with a value date in it : only in the period */
+    gint tr_value_date = bet_forecast_cunit_add_transaction(account_2, cur_number, 1000, date_min, -1);
+    g_date_add_days(value_date, 1);
+    gsb_data_transaction_set_value_date(tr_value_date, value_date);
+
+    /* transfer between the 2 accounts : not in the forecast */
+    gint tr_transfer_1 = bet_forecast_cunit_add_transaction(account_1, cur_number, -2000, date_min, 3);
+    gint tr_transfer_2 = bet_forecast_cunit_add_transaction(account_2, cur_number, 2000, date_min, 3);
+    gsb_data_transaction_set_contra_transaction_number(tr_transfer_1, tr_transfer_2);
+    gsb_data_transaction_set_contra_transaction_number(tr_transfer_2, tr_transfer_1);
+
+    forecast = bet_forecast_new_for_partial_balance(partial_number, date_min, date_max);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(forecast);
+    CU_ASSERT_EQUAL(cur_number, forecast->currency_number);
+    CU_ASSERT_FATAL(forecast->events->len > 0);
+
+    /* the first event is the initial balance : -50.00 + 100.00 */
+    event = &g_array_index(forecast->events, BetForecastEvent, 0);
+    CU_ASSERT_EQUAL(SPP_ORIGIN_SOLDE, event->origin);
+    CU_ASSERT_EQUAL(BET_FORECAST_BALANCE_START, event->number);
+    expected.mantissa = 5000;
+    CU_ASSERT_EQUAL(0, gsb_real_cmp(expected, event->balance));
+
+    for (i = 0; i < forecast->events->len; i++)
+    {
+        event = &g_array_index(forecast->events, BetForecastEvent, i);
+        if (event->origin != SPP_ORIGIN_TRANSACTION)
+            continue;
+
+        nb_transactions++;
+        CU_ASSERT_NOT_EQUAL(tr_transfer_1, event->number);
+        CU_ASSERT_NOT_EQUAL(tr_transfer_2, event->number);
+    }
+    CU_ASSERT_EQUAL(2, nb_transactions);
+
+    /* 50.00 - 30.00 + 10.00 */
+    expected.mantissa = 3000;
+    CU_ASSERT_EQUAL(0, gsb_real_cmp(expected, bet_forecast_get_balance_at_date(forecast, date_max)));
+
+    bet_forecast_free(forecast);
+    gsb_data_account_delete(account_1);
+    gsb_data_account_delete(account_2);
+    g_date_free(value_date);
+    g_date_free(date_max);
+    g_date_free(date_min);
+}
+
+CU_pSuite bet_forecast_cunit_create_suite(void)
+{
+    CU_pSuite pSuite = CU_add_suite("bet_forecast",
+                                    bet_forecast_cunit_init_suite,
+                                    bet_forecast_cunit_clean_suite);
+    if(NULL == pSuite)
+        return NULL;
+
+    if((NULL == CU_add_test(pSuite, "of bet_forecast_new_for_partial_balance()", bet_forecast_cunit__bet_forecast_new_for_partial_balance))
+       )
+        return NULL;
+
+    return pSuite;
+}
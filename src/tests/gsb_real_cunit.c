@@ -42,12 +42,14 @@
 
 /* START_STATIC */
 static void gsb_real_cunit__gsb_real_add ( void );
+static void gsb_real_cunit__gsb_real_add__exponent ( void );
 static void gsb_real_cunit__gsb_real_mul( void );
 static void gsb_real_cunit__gsb_real_normalize( void );
 static void gsb_real_cunit__gsb_real_raw_format_string ( void );
 static void gsb_real_cunit__gsb_real_raw_get_from_string( void );
 static void gsb_real_cunit__gsb_real_raw_get_from_string__locale( void );
 static void gsb_real_cunit__gsb_real_sub( void );
+static void gsb_real_cunit__gsb_real_sum_mantissas ( void );
 static void gsb_real_cunit__gsb_real_adjust_exponent ( void );
 static int gsb_real_cunit_clean_suite ( void );
 static int gsb_real_cunit_init_suite ( void );
@@ -489,6 +491,69 @@ void gsb_real_cunit__gsb_real_add ( void )
     r = gsb_real_add(a, b);
     CU_ASSERT_EQUAL(G_MININT64, r.mantissa);
     CU_ASSERT_EQUAL(0, r.exponent);
+
+    a.mantissa = 1050;
+    a.exponent = 2;
+    b.mantissa = -250;
+    b.exponent = 2;
+    r = gsb_real_add(a, b);
+    CU_ASSERT_EQUAL(800, r.mantissa);
+    CU_ASSERT_EQUAL(2, r.exponent);
+
+    a.mantissa = G_GINT64_CONSTANT(9223372036854775805);
+    a.exponent = 2;
+    b.mantissa = G_GINT64_CONSTANT(9223372036854775805);
+    b.exponent = 2;
+    r = gsb_real_add(a, b);
+    CU_ASSERT_EQUAL(G_GINT64_CONSTANT(1844674407370955161), r.mantissa);
+    CU_ASSERT_EQUAL(1, r.exponent);
+
+    a.mantissa = G_MAXINT64;
+    a.exponent = 2;
+    b.mantissa = G_MAXINT64;
+    b.exponent = 2;
+    r = gsb_real_add(a, b);
+    CU_ASSERT_EQUAL(G_MININT64, r.mantissa);
+
+    a.mantissa = G_MAXINT64;
+    a.exponent = 0;
+    b.mantissa = 1;
+    b.exponent = 0;
+    r = gsb_real_add(a, b);
+    CU_ASSERT_EQUAL(G_MININT64, r.mantissa);
+    CU_ASSERT_EQUAL(0, r.exponent);
+}
+
+void gsb_real_cunit__gsb_real_add__exponent ( void )
+{
+    GsbReal a = { 150, 2 };
+    GsbReal b = { 250, 2 };
+    GsbReal r;
+    gchar *s;
+
+    /* the numbers of the same exponent are added without normalizing them */
+    r = gsb_real_add ( a, b );
+    CU_ASSERT_EQUAL ( 400, r.mantissa );
+    CU_ASSERT_EQUAL ( 2, r.exponent );
+
+    s = gsb_real_safe_real_to_string ( r, -1 );
+    CU_ASSERT_STRING_EQUAL ( "4.00", s );
+    g_free ( s );
+
+    a.mantissa = 40;
+    a.exponent = 1;
+    CU_ASSERT_EQUAL ( 0, gsb_real_cmp ( r, a ) );
+    a.mantissa = 4;
+    a.exponent = 0;
+    CU_ASSERT_EQUAL ( 0, gsb_real_cmp ( a, r ) );
+    a.mantissa = 401;
+    a.exponent = 2;
+    CU_ASSERT_EQUAL ( 1, gsb_real_cmp ( a, r ) );
+    CU_ASSERT_EQUAL ( -1, gsb_real_cmp ( r, a ) );
+
+    r = gsb_real_sub ( b, r );
+    CU_ASSERT_EQUAL ( -150, r.mantissa );
+    CU_ASSERT_EQUAL ( 2, r.exponent );
 }
 
 void gsb_real_cunit__gsb_real_sub( void )
@@ -583,6 +648,50 @@ void gsb_real_cunit__gsb_real_mul( void )
 }
 
 
+void gsb_real_cunit__gsb_real_sum_mantissas ( void )
+{
+    gint64 mantissas[2048];
+    gint64 total = 0;
+    GArray *array;
+    GsbReal a = { 15, 1 };
+    GsbReal b = { -325, 2 };
+    GsbReal r;
+    gsize i;
+
+    for ( i = 0; i < 2048; i++ )
+    {
+        mantissas[i] = ( i % 3 ) ? ( gint64 ) i * 125 : -( gint64 ) i * 37;
+        total += mantissas[i];
+    }
+    r = gsb_real_sum_mantissas ( mantissas, 2048, 2 );
+    CU_ASSERT_EQUAL ( total, r.mantissa );
+    CU_ASSERT_EQUAL ( 2, r.exponent );
+
+    r = gsb_real_sum_mantissas ( mantissas, 0, 2 );
+    CU_ASSERT_EQUAL ( 0, r.mantissa );
+
+    mantissas[10] = G_MAXINT64;
+    mantissas[11] = G_MAXINT64;
+    r = gsb_real_sum_mantissas ( mantissas, 12, 2 );
+    CU_ASSERT_EQUAL ( G_MININT64, r.mantissa );
+
+    mantissas[10] = G_MININT64;
+    r = gsb_real_sum_mantissas ( mantissas, 2048, 2 );
+    CU_ASSERT_EQUAL ( G_MININT64, r.mantissa );
+
+    array = g_array_new ( FALSE, FALSE, sizeof ( gint64 ) );
+    gsb_real_append_mantissa ( array, a, 2 );
+    gsb_real_append_mantissa ( array, b, 2 );
+    r = gsb_real_sum_mantissas ( ( gint64 * ) array -> data, array -> len, 2 );
+    CU_ASSERT_EQUAL ( -175, r.mantissa );
+    CU_ASSERT_EQUAL ( 2, r.exponent );
+
+    gsb_real_append_mantissa ( array, error_real, 2 );
+    r = gsb_real_sum_mantissas ( ( gint64 * ) array -> data, array -> len, 2 );
+    CU_ASSERT_EQUAL ( G_MININT64, r.mantissa );
+    g_array_free ( array, TRUE );
+}
+
 void gsb_real_cunit__gsb_real_adjust_exponent ( void )
 {
     GsbReal a = {1, 0};
@@ -613,8 +722,10 @@ CU_pSuite gsb_real_cunit_create_suite ( void )
       || ( NULL == CU_add_test( pSuite, "of gsb_real_raw_format_string()",   gsb_real_cunit__gsb_real_raw_format_string ) )
       || ( NULL == CU_add_test( pSuite, "of gsb_real_gsb_real_normalize()",  gsb_real_cunit__gsb_real_normalize ) )
       || ( NULL == CU_add_test( pSuite, "of gsb_real_add()",                 gsb_real_cunit__gsb_real_add ) )
+      || ( NULL == CU_add_test( pSuite, "of gsb_real_add() exponent",        gsb_real_cunit__gsb_real_add__exponent ) )
       || ( NULL == CU_add_test( pSuite, "of gsb_real_sub()",                 gsb_real_cunit__gsb_real_sub ) )
       || ( NULL == CU_add_test( pSuite, "of gsb_real_mul()",                 gsb_real_cunit__gsb_real_mul ) )
+      || ( NULL == CU_add_test( pSuite, "of gsb_real_sum_mantissas()",       gsb_real_cunit__gsb_real_sum_mantissas ) )
       || ( NULL == CU_add_test( pSuite, "of gsb_real_adjust_exponent()",     gsb_real_cunit__gsb_real_adjust_exponent ) )
        )
         return NULL;
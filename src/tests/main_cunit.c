@@ -39,6 +39,7 @@
 #include <CUnit/Automated.h>
 #include <CUnit/Basic.h>
 #include <gtk/gtk.h>
+#include "bet_forecast_cunit.h"
 #include "gsb_data_account_cunit.h"
 #include "gsb_real_cunit.h"
 #include "utils_dates_cunit.h"
@@ -76,6 +77,7 @@ int main(int argc, char** argv)
 	utils_dates_cunit_create_suite();
 	gsb_data_account_cunit_create_suite();
 	gsb_real_cunit_create_suite();
+	bet_forecast_cunit_create_suite();
 
 	CU_basic_run_tests();
 
@@ -49,6 +49,7 @@
 #include "gsb_data_transaction.h"
 #include "gsb_real.h"
 #include "gsb_rgba.h"
+#include "gsb_trace.h"
 #include "gsb_transactions_list.h"
 #include "gsb_transactions_list_sort.h"
 #include "navigation.h"
@@ -90,22 +91,14 @@ static CustomRecord *transaction_list_create_record (gint transaction_number,
 {
     CustomRecord *newrecord;
 	GrisbiAppConf *a_conf;
-    gint column;
 
 	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
 
     /* create the new record */
     newrecord = g_malloc0 (sizeof (CustomRecord));
 
-    /* fill the row with the visibles columns */
-    for (column = 0 ; column < CUSTOM_MODEL_VISIBLE_COLUMNS ; column++)
-	{
-		gint element_number;
-
-		element_number = gsb_transactions_list_get_element_tab_affichage_ope (line_in_transaction, column);
-		newrecord->visible_col[column] = gsb_transactions_list_grep_cell_content (transaction_number,
-																					element_number);
-	}
+    /* the visibles columns will be filled when the view asks for them */
+    newrecord->lazy_cells = TRUE;
 
     if (a_conf->custom_fonte_listes)
 	    newrecord->font = a_conf->font_string;
@@ -167,19 +160,16 @@ static gboolean transaction_list_update_white_child (CustomRecord *white_record)
 														   TRUE);
 
     /* show the variance and sub-total only if different of the transaction */
-	if (white_record->visible_col[2])
-		g_free (white_record->visible_col[2]);
-
 	if (variance.mantissa)
     {
-		white_record->visible_col[2] = g_strdup_printf (_("Total: %s (variance : %s)"),
-														amount_string,
-														variance_string);
+		custom_list_set_cell_text (white_record, 2, g_strdup_printf (_("Total: %s (variance : %s)"),
+																	 amount_string,
+																	 variance_string));
 		mother_text_color = gsb_rgba_get_couleur ("text_unfinished_split");
     }
     else
     {
-		white_record->visible_col[2] = NULL;
+		custom_list_set_cell_text (white_record, 2, NULL);
 		mother_text_color = gsb_rgba_get_couleur_with_indice ("text_color", 0);
     }
 
@@ -405,6 +395,191 @@ static gint transaction_list_find_element_col_split (gint element_number)
     return -1;
 }
 
+/**
+ * get the account of a mother row of the list
+ *
+ * \param record
+ *
+ * \return the account number, -1 for the white line
+ **/
+static gint transaction_list_get_record_account (CustomRecord *record)
+{
+    if (record->what_is_line == IS_ARCHIVE)
+        return gsb_data_archive_store_get_account_number (gsb_data_archive_store_get_number (
+                        record->transaction_pointer));
+
+    return gsb_data_transaction_get_account_number (gsb_data_transaction_get_transaction_number (
+                        record->transaction_pointer));
+}
+
+/**
+ * append a mother row at the end of the rows of its account
+ * do nothing if the account rows are not made yet
+ *
+ * \param custom_list
+ * \param record
+ *
+ * \return
+ **/
+static void transaction_list_account_rows_append (CustomList *custom_list,
+                        CustomRecord *record)
+{
+    GPtrArray *account_rows;
+
+    if (!custom_list->account_rows)
+        return;
+
+    record->account_number = transaction_list_get_record_account (record);
+
+    account_rows = g_hash_table_lookup (custom_list->account_rows,
+                        GINT_TO_POINTER (record->account_number));
+    if (!account_rows)
+    {
+        account_rows = g_ptr_array_new ();
+        g_hash_table_insert (custom_list->account_rows,
+                        GINT_TO_POINTER (record->account_number),
+                        account_rows);
+    }
+    g_ptr_array_add (account_rows, record);
+}
+
+/**
+ * remove a mother row from the rows of its account
+ *
+ * \param custom_list
+ * \param record
+ *
+ * \return
+ **/
+static void transaction_list_account_rows_remove (CustomList *custom_list,
+                        CustomRecord *record)
+{
+    GPtrArray *account_rows;
+
+    if (!custom_list->account_rows)
+        return;
+
+    account_rows = g_hash_table_lookup (custom_list->account_rows,
+                        GINT_TO_POINTER (record->account_number));
+    if (account_rows)
+        g_ptr_array_remove (account_rows, record);
+}
+
+/**
+ * insert a mother row in the rows of its account, at the place of its
+ * position in the rows of the list
+ * do nothing if the account rows are not made yet
+ *
+ * \param custom_list
+ * \param record
+ *
+ * \return
+ **/
+static void transaction_list_account_rows_insert (CustomList *custom_list,
+                        CustomRecord *record)
+{
+    GPtrArray *account_rows;
+    guint low = 0;
+    guint high;
+
+    if (!custom_list->account_rows)
+        return;
+
+    transaction_list_account_rows_append (custom_list, record);
+
+    /* the record is at the end, move it to its place */
+    account_rows = g_hash_table_lookup (custom_list->account_rows,
+                        GINT_TO_POINTER (record->account_number));
+    high = account_rows->len - 1;
+    while (low < high)
+    {
+        guint middle = (low + high) / 2;
+
+        if (((CustomRecord *) g_ptr_array_index (account_rows, middle))->pos < record->pos)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    if (low < account_rows->len - 1)
+    {
+        memmove (&account_rows->pdata[low + 1],
+                        &account_rows->pdata[low],
+                        (account_rows->len - 1 - low) * sizeof (gpointer));
+        account_rows->pdata[low] = record;
+    }
+}
+
+/**
+ * make the rows of all the accounts with one pass on the rows of the list
+ *
+ * \param custom_list
+ *
+ * \return
+ **/
+static void transaction_list_account_rows_fill (CustomList *custom_list)
+{
+    gint i;
+
+    custom_list->account_rows = g_hash_table_new_full (g_direct_hash,
+                        g_direct_equal,
+                        NULL,
+                        (GDestroyNotify) g_ptr_array_unref);
+
+    for (i = 0 ; i < custom_list->num_rows ; i++)
+        transaction_list_account_rows_append (custom_list, custom_list->rows[i]);
+}
+
+/**
+ * get the rows which can be visible for the account, ie the rows of the account
+ * and the white line, sorted by position in the rows of the list
+ *
+ * \param custom_list
+ * \param account_number
+ *
+ * \return a newly allocated GPtrArray
+ **/
+static GPtrArray *transaction_list_account_rows_get (CustomList *custom_list,
+                        gint account_number)
+{
+    GPtrArray *account_rows;
+    GPtrArray *white_rows;
+    GPtrArray *rows;
+    guint i = 0;
+    guint j = 0;
+
+    if (!custom_list->account_rows)
+        transaction_list_account_rows_fill (custom_list);
+
+    account_rows = g_hash_table_lookup (custom_list->account_rows, GINT_TO_POINTER (account_number));
+    white_rows = g_hash_table_lookup (custom_list->account_rows, GINT_TO_POINTER (-1));
+
+    rows = g_ptr_array_sized_new ((account_rows ? account_rows->len : 0)
+                        + (white_rows ? white_rows->len : 0));
+
+    /* merge the 2 arrays to keep the order of the list */
+    while ((account_rows && i < account_rows->len)
+           ||
+           (white_rows && j < white_rows->len))
+    {
+        CustomRecord *record;
+
+        if (!white_rows || j >= white_rows->len)
+            record = g_ptr_array_index (account_rows, i++);
+        else if (!account_rows || i >= account_rows->len)
+            record = g_ptr_array_index (white_rows, j++);
+        else if (((CustomRecord *) g_ptr_array_index (account_rows, i))->pos
+                 < ((CustomRecord *) g_ptr_array_index (white_rows, j))->pos)
+            record = g_ptr_array_index (account_rows, i++);
+        else
+            record = g_ptr_array_index (white_rows, j++);
+
+        g_ptr_array_add (rows, record);
+    }
+
+    return rows;
+}
+
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
@@ -530,6 +705,7 @@ void transaction_list_append_transaction (gint transaction_number)
 	custom_list->rows[pos] = newrecord[i];
 	/* and the pos (number) of the row */
 	newrecord[i]->pos = pos;
+	transaction_list_account_rows_append (custom_list, newrecord[i]);
 
 	/* set the checkbox is the transaction is marked */
 	if (line_p == i)
@@ -686,6 +862,7 @@ void transaction_list_append_archive (gint archive_store_number)
     custom_list->rows[pos] = newrecord;
     /* and the pos (number) of the row */
     newrecord->pos = pos;
+    transaction_list_account_rows_append (custom_list, newrecord);
 }
 
 
@@ -739,6 +916,7 @@ gboolean transaction_list_remove_transaction (gint transaction_number)
     for (i=0 ; i<CUSTOM_MODEL_VISIBLE_COLUMNS ; i++)
 	if (record->visible_col[i])
 	    g_free (record->visible_col[i]);
+    custom_list_forget_record (custom_list, record);
 
     if (record->mother_row)
     {
@@ -827,6 +1005,8 @@ gboolean transaction_list_remove_transaction (gint transaction_number)
 	    gtk_tree_model_row_deleted (GTK_TREE_MODEL(custom_list), path);
 	    gtk_tree_path_free(path);
 	}
+	transaction_list_account_rows_remove (custom_list, record->transaction_records[i-1]);
+	custom_list_forget_record (custom_list, record->transaction_records[i-1]);
 	g_free (record->transaction_records[i-1]);
     }
 
@@ -877,6 +1057,7 @@ gboolean transaction_list_remove_archive (gint archive_number)
         for (j=0 ; j<CUSTOM_MODEL_VISIBLE_COLUMNS ; j++)
             if (record->visible_col[j])
                 g_free (record->visible_col[j]);
+        transaction_list_account_rows_remove (custom_list, record);
 
         /* remove the row. I decrement "i" because the next line of model is shifted
          * and has  "i" for index. Otherwise we do not test. */
@@ -935,7 +1116,8 @@ gboolean transaction_list_remove_archive (gint archive_number)
  * */
 void transaction_list_filter (gint account_number)
 {
-    gint current_pos_general_list;
+    GPtrArray *account_rows;
+    guint current_pos_account_rows;
     gint current_pos_filtered_list = 0;
     GtkTreePath  *path;
     gint previous_visible_rows;
@@ -943,6 +1125,7 @@ void transaction_list_filter (gint account_number)
     gint i;
     gint *neworder;
     CustomList *custom_list;
+    gint64 trace_start;
 	GrisbiAppConf *a_conf;
 
 	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
@@ -953,6 +1136,8 @@ void transaction_list_filter (gint account_number)
     g_return_if_fail (custom_list != NULL);
     g_return_if_fail (custom_list->num_rows != 0);
 
+    trace_start = gsb_trace_begin ();
+
     /* there is a bug, i think in gtk, which when we re-filter the list with opened split, and when
      * there is less lines in the list that the window, gtk close the split opened without
      * informing the tree view so tree view errors laters... i didn't find anything here
@@ -972,9 +1157,26 @@ void transaction_list_filter (gint account_number)
     /* save the lenght of the current list */
     previous_visible_rows = custom_list->num_visibles_rows;
 
+    /* only the rows of the account can be shown, the rows of the other accounts
+     * are hidden already, except the rows showed before, so hide them now */
+    account_rows = transaction_list_account_rows_get (custom_list, account_number);
+
+    for (i=0 ; i < previous_visible_rows ; i++)
+    {
+        CustomRecord *record;
+
+        record = custom_list->visibles_rows[i];
+        if (record->account_number == account_number || record->account_number == -1)
+            continue;
+
+        record->line_visible = FALSE;
+        record->filtered_pos = -1;
+        record->has_expander = FALSE;
+    }
+
     path = gtk_tree_path_new_first ();
 
-    for (current_pos_general_list=0 ; current_pos_general_list<custom_list->num_rows ; current_pos_general_list++)
+    for (current_pos_account_rows=0 ; current_pos_account_rows < account_rows->len ; current_pos_account_rows++)
     {
         CustomRecord *record;
         gboolean shown;
@@ -982,7 +1184,7 @@ void transaction_list_filter (gint account_number)
         gint last_pos_filtered_list;
 
         /* get the current record to check */
-        record = custom_list->rows[current_pos_general_list];
+        record = g_ptr_array_index (account_rows, current_pos_account_rows);
 
         /* was the line visible before ? */
         previous_shown = record->line_visible;
@@ -1109,17 +1311,17 @@ void transaction_list_filter (gint account_number)
 	}
 
     gtk_tree_path_free(path);
+    g_ptr_array_free (account_rows, TRUE);
 
 	/* initialise les options de tri */
 	gsb_transactions_list_set_primary_sort (a_conf->transactions_list_primary_sorting);
 	gsb_transactions_list_set_secondary_sort (a_conf->transactions_list_secondary_sorting);
 
+    gsb_trace_count ("transactions_list_visible_rows", custom_list->num_visibles_rows);
+    gsb_trace_end ("transactions_list_filter", trace_start);
+
     /* initial sort of the list */
-    g_qsort_with_data (custom_list->visibles_rows,
-                        custom_list->num_visibles_rows,
-                        sizeof(CustomRecord*),
-                        (GCompareDataFunc) gsb_transactions_list_sort_initial,
-                        custom_list);
+    gsb_transactions_list_sort_rows (custom_list, TRUE);
 
     /* let other objects know about the new order */
     neworder = g_new0(gint, custom_list->num_visibles_rows);
@@ -1139,6 +1341,43 @@ void transaction_list_filter (gint account_number)
 }
 
 
+/**
+ * move the rows of a transaction from the rows of its old account
+ * to the rows of its new account
+ * called when a transaction is moved to another account
+ *
+ * \param transaction_number
+ *
+ * \return
+ * */
+void transaction_list_move_account_rows (gint transaction_number)
+{
+    CustomList *custom_list;
+    CustomRecord *record;
+    GtkTreeIter iter;
+    gint i;
+
+    custom_list = transaction_model_get_model ();
+
+    if (custom_list == NULL || custom_list->account_rows == NULL)
+        return;
+
+    if (!transaction_model_get_transaction_iter (&iter, transaction_number, 0))
+        return;
+
+    /* the rows of a transaction follow its first row */
+    record = iter.user_data;
+    for (i = 0 ; i < TRANSACTION_LIST_ROWS_NB ; i++)
+    {
+        CustomRecord *line_record;
+
+        line_record = custom_list->rows[record->pos + i];
+        transaction_list_account_rows_remove (custom_list, line_record);
+        transaction_list_account_rows_insert (custom_list, line_record);
+    }
+}
+
+
 /**
  * colorize transactions in the model
  *
@@ -1229,6 +1468,7 @@ void transaction_list_set_balances (void)
     GtkTreeIter iter;
     GtkTreePath *path;
     gpointer last_transaction_pointer = NULL;
+    gint64 trace_start;
     CustomList *custom_list;
 
     custom_list = transaction_model_get_model ();
@@ -1261,6 +1501,7 @@ void transaction_list_set_balances (void)
     floating_point = gsb_data_currency_get_floating_point (currency_number);
 
     /* get the beginning balance */
+    trace_start = gsb_trace_begin ();
     current_total = gsb_transactions_list_get_solde_debut_affichage (account_number, floating_point);
 
     for (i=0 ; i < custom_list->num_visibles_rows ; i++)
@@ -1297,8 +1538,9 @@ void transaction_list_set_balances (void)
 
         /* calculate the new balance */
         current_total = gsb_real_add (current_total, amount);
-        record->visible_col[column_balance] = utils_real_get_string_with_currency (current_total,
-                                                 currency_number , TRUE);
+        custom_list_set_cell_text (record,
+                                   column_balance,
+                                   utils_real_get_string_with_currency (current_total, currency_number, TRUE));
         if (current_total.mantissa >= 0)
             record->amount_color = gsb_rgba_get_couleur_with_indice_to_str ("text_color", 0);
         else
@@ -1313,6 +1555,8 @@ void transaction_list_set_balances (void)
         gtk_tree_path_free(path);
     }
 
+    gsb_trace_end ("transactions_list_balances", trace_start);
+
     /* update the headings balance */
     gsb_data_account_colorize_current_balance (account_number);
 }
@@ -1425,8 +1669,6 @@ gboolean transaction_list_update_transaction (gint transaction_number)
     /* now we can save the new rows */
     for (i=0 ; i<nb_rows ; i++)
     {
-        CustomRecord *tmp_record;
-
         /* get the good line in the record */
         if (!record->mother_row)
             record = record->transaction_records[i];
@@ -1438,17 +1680,10 @@ gboolean transaction_list_update_transaction (gint transaction_number)
             return FALSE;
 		}
 
-        /* the tmp record will contain the new gchars of columns */
-        tmp_record = transaction_list_create_record (transaction_number, i);
-
+        /* the cells will be made again when the view asks for them */
+        record->lazy_cells = TRUE;
         for (j=0 ; j<CUSTOM_MODEL_VISIBLE_COLUMNS ; j++)
-        {
-            if (record->visible_col[j])
-                g_free (record->visible_col[j]);
-            record->visible_col[j] = tmp_record->visible_col[j];
-        }
-
-        g_free (tmp_record);
+            custom_list_invalidate_cell (record, j);
 
         /* set the white line if necessary */
         if (children_rows)
@@ -1730,13 +1965,9 @@ gboolean transaction_list_update_cell (gint cell_col,
 	if (transaction_number == -1)
 	    continue;
 
-	/* now, we are on the good row of the transaction, update the element */
-	if (record->visible_col[cell_col])
-	    g_free (record->visible_col[cell_col]);
-	if (element_number)
-	    record->visible_col[cell_col] = gsb_transactions_list_grep_cell_content (transaction_number, element_number);
-	else
-	    record->visible_col[cell_col] = NULL;
+	/* now, we are on the good row of the transaction, the element
+	 * will be made again when the view asks for it */
+	custom_list_invalidate_cell (record, cell_col);
 
 	/* inform the tree view we changed the row, only if visible */
 	if (record->filtered_pos != -1)
@@ -1765,9 +1996,7 @@ gboolean transaction_list_update_cell (gint cell_col,
 		    continue;
 
 		/* update the element */
-		if (child_record->visible_col[column_element_split])
-		    g_free (child_record->visible_col[column_element_split]);
-		child_record->visible_col[column_element_split] = gsb_transactions_list_grep_cell_content (transaction_number, element_number);
+		custom_list_invalidate_cell (child_record, column_element_split);
 
 		/* inform the tree view we changed the row, only if visible
 		 * we check the mother because the children are alway visible */
@@ -1914,7 +2143,7 @@ void transaction_list_set (GtkTreeIter *iter, ...)
 	    case CUSTOM_MODEL_COL_4:
 	    case CUSTOM_MODEL_COL_5:
 	    case CUSTOM_MODEL_COL_6:
-		record->visible_col[column] = va_arg (var_args, gchar *);
+		custom_list_set_cell_text (record, column, va_arg (var_args, gchar *));
 		break;
 	    case CUSTOM_MODEL_BACKGROUND:
 		record->row_bg = va_arg (var_args, GdkRGBA *);
@@ -2290,6 +2519,7 @@ gboolean transaction_list_remove_archive_line (gint archive_number,
         for (j=0 ; j<CUSTOM_MODEL_VISIBLE_COLUMNS ; j++)
             if (record->visible_col[j])
                 g_free (record->visible_col[j]);
+        transaction_list_account_rows_remove (custom_list, record);
 
         /* remove the row. I decrement "i" because the next line of model is shifted
          * and has  "i" for index. Otherwise we do not test. */
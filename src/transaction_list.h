@@ -17,6 +17,7 @@ void		transaction_list_filter					(gint account_number);
 gint		transaction_list_get_last_line			(gint nb_rows);
 gint		transaction_list_get_n_children			(gint transaction_number);
 gboolean	transaction_list_get_variance			(gint transaction_number);
+void		transaction_list_move_account_rows		(gint transaction_number);
 gboolean	transaction_list_redraw					(void);
 gboolean	transaction_list_remove_archive			(gint archive_number);
 gboolean	transaction_list_remove_archive_line	(gint archive_number,
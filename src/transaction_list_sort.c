@@ -105,11 +105,7 @@ void transaction_list_sort (void)
 		gsb_transactions_list_set_secondary_sort (a_conf->transactions_list_secondary_sorting);
 
 		/* sort of the list */
-		g_qsort_with_data (custom_list->visibles_rows,
-                        custom_list->num_visibles_rows,
-                        sizeof(CustomRecord*),
-                        (GCompareDataFunc) gsb_transactions_list_sort,
-                        custom_list);
+		gsb_transactions_list_sort_rows (custom_list, FALSE);
 	}
 
 	/* fixes bug 1875 */
@@ -594,20 +594,34 @@ gchar *gsb_format_gdate (const GDate *date)
  **/
 gchar *gsb_format_gdate_safe (const GDate *date)
 {
-    gchar retour_str[SIZEOF_FORMATTED_STRING_DATE];
-    gsize longueur;
+    gchar retour_str[SIZEOF_FORMATTED_STRING_DATE_SAFE];
+
+    return g_strdup (gsb_format_gdate_safe_to_buffer (date, retour_str));
+}
 
+/**
+ * Same as gsb_format_gdate_safe () but the date is written in the buffer
+ * given, without allocation. The buffer is an empty string if date is not valid.
+ *
+ * \param date		A GDate structure containing the date to represent.
+ * \param buffer		A buffer of SIZEOF_FORMATTED_STRING_DATE_SAFE chars.
+ *
+ * \return		buffer
+ **/
+gchar *gsb_format_gdate_safe_to_buffer (const GDate *date,
+										gchar *buffer)
+{
     if (!date || !g_date_valid (date))
     {
-        return g_strdup ("");
+        buffer[0] = '\0';
+        return buffer;
     }
 
-    longueur = g_date_strftime (retour_str, SIZEOF_FORMATTED_STRING_DATE, "%m/%d/%Y", date);
+    /* same as "%m/%d/%Y" with g_date_strftime () */
+    g_snprintf (buffer, SIZEOF_FORMATTED_STRING_DATE_SAFE, "%02d/%02d/%d",
+                g_date_get_month (date), g_date_get_day (date), g_date_get_year (date));
 
-    if (longueur == 0)
-        return NULL;
-    else
-        return g_strndup (retour_str, longueur);
+    return buffer;
 }
 
 /**
@@ -3,6 +3,9 @@
 
 #include <gtk/gtk.h>
 
+/* size of the buffer of gsb_format_gdate_safe_to_buffer () */
+#define SIZEOF_FORMATTED_STRING_DATE_SAFE 16
+
 /* START_INCLUDE_H */
 /* END_INCLUDE_H */
 
@@ -37,6 +40,8 @@ gchar *		gsb_format_date								(gint day,
 														 gint year);
 gchar *		gsb_format_gdate							(const GDate *date);
 gchar *		gsb_format_gdate_safe						(const GDate *date);
+gchar *		gsb_format_gdate_safe_to_buffer				(const GDate *date,
+														 gchar *buffer);
 GDate *		gsb_parse_import_date_string				(const gchar *date_string);
 GDate *		gsb_parse_date_string						(const gchar *date_string);
 GDate *		gsb_parse_date_string_safe					(const gchar *date_string);
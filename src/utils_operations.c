@@ -103,7 +103,6 @@ void update_transaction_in_categ_tree ( gint transaction_number )
     MetatreeInterface *category_interface;
 
     category_interface = category_get_metatree_interface ( );
-    /* FIXME: Kludgeish, we should maintain a state. */
     gsb_data_category_update_counters ( );
     update_transaction_in_tree ( category_interface,
                                  GTK_TREE_MODEL ( categories_get_tree_store ( ) ),
@@ -121,7 +120,6 @@ void update_transaction_in_budgetary_line_tree ( gint transaction_number )
     MetatreeInterface *budgetary_interface;
 
     budgetary_interface = budgetary_line_get_metatree_interface ( );
-    /* FIXME: Kludgeish, we should maintain a state. */
     gsb_data_budget_update_counters ( );
     update_transaction_in_tree ( budgetary_interface,
                         GTK_TREE_MODEL ( budgetary_lines_get_tree_store ( ) ),
@@ -139,7 +137,6 @@ void update_transaction_in_payee_tree ( gint transaction_number )
     MetatreeInterface *payee_interface;
 
     payee_interface = payee_get_metatree_interface ( );
-    /* FIXME: Kludgeish, we should maintain a state. */
     gsb_data_payee_update_counters ();
     update_transaction_in_tree ( payee_interface,
                         GTK_TREE_MODEL ( payees_get_tree_store ( ) ),
@@ -155,7 +152,6 @@ void delete_transaction_in_categ_tree ( gint transaction_number )
     MetatreeInterface *category_interface;
 
     category_interface = category_get_metatree_interface ( );
-    gsb_data_category_remove_transaction_from_category (transaction_number);
     metatree_remove_transaction ( GTK_TREE_VIEW ( categories_get_tree_view ( ) ),
                                   category_interface,
                                   transaction_number,
@@ -173,7 +169,6 @@ void delete_transaction_in_budgetary_line_tree ( gint transaction_number )
     MetatreeInterface *budgetary_interface;
 
     budgetary_interface = budgetary_line_get_metatree_interface ( );
-    gsb_data_budget_remove_transaction_from_budget (transaction_number);
     metatree_remove_transaction ( GTK_TREE_VIEW ( budgetary_lines_get_tree_view ( ) ),
                         budgetary_interface,
                         transaction_number,
@@ -191,7 +186,6 @@ void delete_transaction_in_payee_tree ( gint transaction_number )
     MetatreeInterface *payee_interface;
 
     payee_interface = payee_get_metatree_interface ( );
-    gsb_data_payee_remove_transaction_from_payee (transaction_number);
     metatree_remove_transaction ( GTK_TREE_VIEW ( payees_get_tree_view ( ) ),
                         payee_interface,
                         transaction_number,
@@ -778,7 +778,20 @@ gboolean gsb_string_is_trouve (const gchar *payee_name,
 {
 	if (use_regex)
 	{
-		dialogue_warning ("Function not available");
+		GRegex *regex;
+		gboolean trouve;
+
+		if (!payee_name || !needle)
+			return FALSE;
+
+		regex = g_regex_new (needle, ignore_case ? G_REGEX_CASELESS : 0, 0, NULL);
+		if (!regex)
+			return FALSE;
+
+		trouve = g_regex_match (regex, payee_name, 0, NULL);
+		g_regex_unref (regex);
+
+		return trouve;
 	}
 	else
 	{
@@ -1469,6 +1482,140 @@ gchar *utils_str_break_form_name_field (const gchar *text,
 	return tmp_str;
 }
 
+/**
+ * return the key of a name in the indexes of names, two names have the
+ * same key if my_strcasecmp says they are the same
+ *
+ * \param name
+ *
+ * \return a newly allocated key
+ **/
+static gchar *utils_str_name_index_get_key (const gchar *name)
+{
+	gchar *key;
+
+	if (g_utf8_validate (name, -1, NULL))
+	{
+		gchar *tmp_str;
+
+		tmp_str = g_utf8_casefold (name, -1);
+		key = g_utf8_collate_key (tmp_str, -1);
+		g_free (tmp_str);
+	}
+	else
+		key = g_ascii_strdown (name, -1);
+
+	return key;
+}
+
+/**
+ * add an object to an index of names
+ *
+ * \param index the index made by utils_str_name_index_new
+ * \param name the name of the object, nothing is done if NULL
+ * \param data the object
+ *
+ * \return
+ **/
+void utils_str_name_index_add (GHashTable *index,
+							   const gchar *name,
+							   gpointer data)
+{
+	GSList *list;
+	gchar *key;
+
+	if (!name)
+		return;
+
+	key = utils_str_name_index_get_key (name);
+	list = g_hash_table_lookup (index, key);
+	if (list)
+	{
+		/* the list is already in the index, the first link doesn't change */
+		list = g_slist_append (list, data);
+		g_free (key);
+	}
+	else
+		g_hash_table_insert (index, key, g_slist_append (NULL, data));
+}
+
+/**
+ * return the objects which have the name in an index of names,
+ * with a case insensitive comparison as my_strcasecmp
+ *
+ * \param index
+ * \param name
+ *
+ * \return the list of the objects in the order they were added, don't free it
+ **/
+GSList *utils_str_name_index_lookup (GHashTable *index,
+									 const gchar *name)
+{
+	GSList *list;
+	gchar *key;
+
+	if (!name)
+		return NULL;
+
+	key = utils_str_name_index_get_key (name);
+	list = g_hash_table_lookup (index, key);
+	g_free (key);
+
+	return list;
+}
+
+/**
+ * create an index of objects by their names, the objects are
+ * found with a case insensitive comparison as my_strcasecmp
+ *
+ * \param
+ *
+ * \return a new GHashTable to free with g_hash_table_destroy
+ **/
+GHashTable *utils_str_name_index_new (void)
+{
+	return g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_slist_free);
+}
+
+/**
+ * remove an object from an index of names, to do before the name is changed
+ *
+ * \param index
+ * \param name the name of the object when it was added
+ * \param data the object
+ *
+ * \return
+ **/
+void utils_str_name_index_remove (GHashTable *index,
+								  const gchar *name,
+								  gpointer data)
+{
+	gpointer orig_key;
+	gpointer value;
+	gchar *key;
+
+	if (!name)
+		return;
+
+	key = utils_str_name_index_get_key (name);
+	if (g_hash_table_lookup_extended (index, key, &orig_key, &value))
+	{
+		GSList *list;
+
+		/* if the first link is removed, the list is set again in the index */
+		list = g_slist_remove (value, data);
+		if (list != value)
+		{
+			g_hash_table_steal (index, key);
+			if (list)
+				g_hash_table_insert (index, orig_key, list);
+			else
+				g_free (orig_key);
+		}
+	}
+	g_free (key);
+}
+
 /**
  *
  *
@@ -56,6 +56,15 @@ gchar *		utils_str_dtostr 										(gdouble number,
 gchar *		utils_str_incremente_number_from_str 					(const gchar *str_number,
 																	 gint increment);
 gchar *		utils_str_localise_decimal_point_from_string 			(const gchar *string);
+void		utils_str_name_index_add 								(GHashTable *index,
+																	 const gchar *name,
+																	 gpointer data);
+GSList *	utils_str_name_index_lookup 							(GHashTable *index,
+																	 const gchar *name);
+GHashTable *utils_str_name_index_new 								(void);
+void		utils_str_name_index_remove 							(GHashTable *index,
+																	 const gchar *name,
+																	 gpointer data);
 gchar *		utils_str_my_case_strstr 								(const gchar *haystack,
 								 									 const gchar *needle);
 gchar *		utils_str_protect_unprotect_multilines_text 			(const gchar *text,
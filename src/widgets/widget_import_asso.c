@@ -596,6 +596,7 @@ static void widget_import_asso_update_assoc (const gchar *rule,
 				assoc->search_str = g_strdup (rule);
 				assoc->ignore_case = w_run->import_asso_case_insensitive;
 				assoc->use_regex = w_run->import_asso_use_regex;
+				gsb_import_associations_invalidate_matcher ();
 				break;
 			}
 	        list_tmp = list_tmp->next;